@@ -0,0 +1,147 @@
+// Have to match `AUTO_EXPOSURE_BINS`, `AUTO_EXPOSURE_GROUP_SIZE`, `AUTO_EXPOSURE_BLOCK_SIZE` and
+// `AUTO_EXPOSURE_MIDDLE_GREY`.
+#define AUTO_EXPOSURE_BINS 256
+#define AUTO_EXPOSURE_GROUP_SIZE 16
+#define AUTO_EXPOSURE_BLOCK_SIZE 2
+#define AUTO_EXPOSURE_MIDDLE_GREY 0.18
+
+// See `AutoExposurePass::Constants` and `AutoExposureParams`.
+cbuffer Constants : register(b0)
+{
+	uint input_idx;
+	uint input_width;
+	uint input_height;
+	float min_log_luminance;
+	float max_log_luminance;
+	float low_percentile;
+	float high_percentile;
+	float brightening_speed;
+	float darkening_speed;
+	float delta_time;
+	float compensation;
+	// Jumps straight to the measured luminance instead of adapting to it.
+	uint reset;
+}
+
+// One counter per bin, cleared again once it has been read.
+RWByteAddressBuffer histogram : register(u0);
+// Adapted log2 luminance followed by the exposure, see `AutoExposurePass::Exposure`.
+RWByteAddressBuffer exposure : register(u1);
+
+groupshared uint group_histogram[AUTO_EXPOSURE_BINS];
+groupshared float group_prefix[AUTO_EXPOSURE_BINS];
+groupshared float group_weighted_sum[AUTO_EXPOSURE_BINS];
+groupshared float group_weight[AUTO_EXPOSURE_BINS];
+
+float luminance(float3 color)
+{
+	return dot(color, float3(0.2126, 0.7152, 0.0722));
+}
+
+// Same as `luminance_bin`.
+uint luminance_bin(float lum)
+{
+	if (!(lum >= exp2(min_log_luminance)))
+	{
+		return 0;
+	}
+	float range = max_log_luminance - min_log_luminance;
+	float t = saturate((log2(lum) - min_log_luminance) / range);
+	return 1 + min(uint(t * (AUTO_EXPOSURE_BINS - 2)), AUTO_EXPOSURE_BINS - 2);
+}
+
+// Same as `bin_log_luminance`.
+float bin_log_luminance(uint bin)
+{
+	float range = max_log_luminance - min_log_luminance;
+	return min_log_luminance + (float(bin) - 0.5) / (AUTO_EXPOSURE_BINS - 2) * range;
+}
+
+// Every thread measures one block of pixels, see `build_luminance_histogram`. The group counts
+// into shared memory first, so the global histogram only sees one atomic per bin and group.
+[numthreads(AUTO_EXPOSURE_GROUP_SIZE, AUTO_EXPOSURE_GROUP_SIZE, 1)]
+void cs_histogram(uint2 block : SV_DispatchThreadID, uint thread_idx : SV_GroupIndex)
+{
+	group_histogram[thread_idx] = 0;
+	GroupMemoryBarrierWithGroupSync();
+
+	uint2 pixel = block * AUTO_EXPOSURE_BLOCK_SIZE;
+	uint2 input_size = uint2(input_width, input_height);
+	if (all(pixel < input_size))
+	{
+		Texture2D<float4> t_input = ResourceDescriptorHeap[input_idx];
+		float sum = 0.0;
+		for (uint y = 0; y < AUTO_EXPOSURE_BLOCK_SIZE; ++y)
+		{
+			for (uint x = 0; x < AUTO_EXPOSURE_BLOCK_SIZE; ++x)
+			{
+				uint2 texel = min(pixel + uint2(x, y), input_size - 1);
+				sum += luminance(t_input.Load(int3(texel, 0)).rgb);
+			}
+		}
+		uint bin = luminance_bin(sum / (AUTO_EXPOSURE_BLOCK_SIZE * AUTO_EXPOSURE_BLOCK_SIZE));
+		InterlockedAdd(group_histogram[bin], 1);
+	}
+	GroupMemoryBarrierWithGroupSync();
+
+	uint count = group_histogram[thread_idx];
+	if (count > 0)
+	{
+		histogram.InterlockedAdd(thread_idx * 4, count);
+	}
+}
+
+// One group with a thread per bin. Averages the histogram between the percentiles like
+// `histogram_log_luminance`, adapts towards it like `adapt_log_luminance` and clears the
+// histogram for the next frame.
+[numthreads(AUTO_EXPOSURE_BINS, 1, 1)]
+void cs_adapt(uint bin : SV_GroupIndex)
+{
+	// The first bin holds the pixels too dark to be measured.
+	float count = bin == 0 ? 0.0 : float(histogram.Load(bin * 4));
+	histogram.Store(bin * 4, 0);
+
+	// Inclusive prefix sum of the counts.
+	group_prefix[bin] = count;
+	GroupMemoryBarrierWithGroupSync();
+	for (uint offset = 1; offset < AUTO_EXPOSURE_BINS; offset *= 2)
+	{
+		float value = bin >= offset ? group_prefix[bin - offset] : 0.0;
+		GroupMemoryBarrierWithGroupSync();
+		group_prefix[bin] += value;
+		GroupMemoryBarrierWithGroupSync();
+	}
+
+	float total = group_prefix[AUTO_EXPOSURE_BINS - 1];
+	float low = total * low_percentile;
+	float high = total * high_percentile;
+	float end = group_prefix[bin];
+	float clipped = clamp(end, low, high) - clamp(end - count, low, high);
+	group_weighted_sum[bin] = clipped * bin_log_luminance(bin);
+	group_weight[bin] = clipped;
+	GroupMemoryBarrierWithGroupSync();
+	for (uint stride = AUTO_EXPOSURE_BINS / 2; stride > 0; stride /= 2)
+	{
+		if (bin < stride)
+		{
+			group_weighted_sum[bin] += group_weighted_sum[bin + stride];
+			group_weight[bin] += group_weight[bin + stride];
+		}
+		GroupMemoryBarrierWithGroupSync();
+	}
+
+	if (bin != 0)
+	{
+		return;
+	}
+	// Without anything to measure the exposure stays where it is.
+	float adapted = asfloat(exposure.Load(0));
+	if (group_weight[0] > 0.0)
+	{
+		float measured = group_weighted_sum[0] / group_weight[0];
+		float speed = measured > adapted ? brightening_speed : darkening_speed;
+		adapted = reset != 0 ? measured : adapted + (measured - adapted) * (1.0 - exp(-delta_time * speed));
+	}
+	float scale = AUTO_EXPOSURE_MIDDLE_GREY * exp2(compensation - adapted);
+	exposure.Store2(0, asuint(float2(adapted, scale)));
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+// See `sphere_outside_frustum`.
+bool sphere_outside_frustum(float4x4 clip_from_object, float3 center, float radius)
+{
+	float4x4 m = clip_from_object;
+	float4 planes[6] = {
+		m[3] + m[0],
+		m[3] - m[0],
+		m[3] + m[1],
+		m[3] - m[1],
+		m[2],
+		m[3] - m[2],
+	};
+	for (uint i = 0; i < 6; ++i)
+	{
+		if (dot(planes[i].xyz, center) + planes[i].w < -radius * length(planes[i].xyz))
+		{
+			return true;
+		}
+	}
+	return false;
+}
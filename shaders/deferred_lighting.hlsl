@@ -0,0 +1,174 @@
+#include "lighting.hlsli"
+#include "octahedral.hlsli"
+
+// Has to match `DEFERRED_TILE_SIZE`.
+#define DEFERRED_TILE_SIZE 16
+// Every light can overlap a tile, so none of them are ever dropped.
+#define MAX_TILE_LIGHTS MAX_POINT_LIGHTS
+
+// See `DeferredLightingPass::Constants`.
+cbuffer Constants : register(b0)
+{
+	float4x4 inv_proj_view;
+	float4x4 light_proj_view;
+	float3 eye;
+	float ambient;
+	float3 sun_dir;
+	uint viewport_width;
+	float3 sun_color;
+	uint viewport_height;
+	float3 camera_forward;
+	uint depth_idx;
+	uint base_color_idx;
+	uint normal_idx;
+	uint metalness_roughness_idx;
+	uint shadow_map_idx;
+	uint lights_buffer_idx;
+	uint output_idx;
+	uint ibl_idx;
+}
+
+SamplerState s_sampler : register(s0);
+
+// Depths are positive, so their bits order the same way as their values.
+groupshared uint tile_min_depth;
+groupshared uint tile_max_depth;
+groupshared uint tile_light_count;
+groupshared uint tile_lights[MAX_TILE_LIGHTS];
+
+float2 pixel_to_ndc(float2 pixel)
+{
+	return float2(
+		pixel.x / viewport_width * 2.0 - 1.0,
+		1.0 - pixel.y / viewport_height * 2.0
+	);
+}
+
+float3 unproject(float2 ndc, float depth)
+{
+	float4 world_position = mul(inv_proj_view, float4(ndc, depth, 1.0));
+	return world_position.xyz / world_position.w;
+}
+
+// Normal of the plane through the eye, `a` and `b`, facing towards `inside`.
+float3 side_plane(float3 a, float3 b, float3 inside)
+{
+	float3 n = normalize(cross(a - eye, b - eye));
+	return dot(n, inside - eye) < 0.0 ? -n : n;
+}
+
+// One group per tile. The group first finds the depth range of its tile and the point lights
+// whose range overlaps the frustum around it, then every thread shades its pixel from the
+// G-buffer with only those lights. Pixels the G-buffer passes left empty are left to the skybox.
+[numthreads(DEFERRED_TILE_SIZE, DEFERRED_TILE_SIZE, 1)]
+void cs_main(uint2 pixel : SV_DispatchThreadID, uint2 tile : SV_GroupID, uint thread_idx : SV_GroupIndex)
+{
+	if (thread_idx == 0)
+	{
+		tile_min_depth = asuint(1.0);
+		tile_max_depth = 0;
+		tile_light_count = 0;
+	}
+	GroupMemoryBarrierWithGroupSync();
+
+	Texture2D<float> t_depth = ResourceDescriptorHeap[depth_idx];
+	bool on_screen = pixel.x < viewport_width && pixel.y < viewport_height;
+	float depth = on_screen ? t_depth.Load(int3(pixel, 0)) : 1.0;
+	bool covered = depth < 1.0;
+	if (covered)
+	{
+		InterlockedMin(tile_min_depth, asuint(depth));
+		InterlockedMax(tile_max_depth, asuint(depth));
+	}
+	GroupMemoryBarrierWithGroupSync();
+
+	// Nothing was drawn in this tile.
+	if (tile_min_depth > tile_max_depth)
+	{
+		return;
+	}
+
+	// Frustum around the tile, bounded by the nearest and farthest depth within it. The view
+	// depth of a pixel only depends on its depth, so both are measured at the tile center.
+	float2 tile_min = float2(tile * DEFERRED_TILE_SIZE);
+	float2 tile_max = min(tile_min + DEFERRED_TILE_SIZE, float2(viewport_width, viewport_height));
+	float2 ndc_min = pixel_to_ndc(float2(tile_min.x, tile_max.y));
+	float2 ndc_max = pixel_to_ndc(float2(tile_max.x, tile_min.y));
+	float2 ndc_center = (ndc_min + ndc_max) * 0.5;
+	float max_depth = asfloat(tile_max_depth);
+
+	float3 left_bottom = unproject(ndc_min, max_depth);
+	float3 left_top = unproject(float2(ndc_min.x, ndc_max.y), max_depth);
+	float3 right_bottom = unproject(float2(ndc_max.x, ndc_min.y), max_depth);
+	float3 right_top = unproject(ndc_max, max_depth);
+	float3 far_center = unproject(ndc_center, max_depth);
+	float3 planes[4] = {
+		side_plane(left_bottom, left_top, far_center),
+		side_plane(right_bottom, right_top, far_center),
+		side_plane(left_bottom, right_bottom, far_center),
+		side_plane(left_top, right_top, far_center),
+	};
+	float near_dist = dot(unproject(ndc_center, asfloat(tile_min_depth)) - eye, camera_forward);
+	float far_dist = dot(far_center - eye, camera_forward);
+
+	ConstantBuffer<Lights> point_lights = ResourceDescriptorHeap[lights_buffer_idx];
+	for (uint i = thread_idx; i < point_lights.len; i += DEFERRED_TILE_SIZE * DEFERRED_TILE_SIZE)
+	{
+		PointLight light = point_lights.lights[i];
+		float range = point_light_range(light);
+		float3 to_light = light.position - eye;
+		float dist = dot(to_light, camera_forward);
+		bool overlaps = dist + range >= near_dist && dist - range <= far_dist;
+		for (uint plane = 0; plane < 4; ++plane)
+		{
+			overlaps = overlaps && dot(planes[plane], to_light) >= -range;
+		}
+		if (overlaps)
+		{
+			uint slot;
+			InterlockedAdd(tile_light_count, 1, slot);
+			if (slot < MAX_TILE_LIGHTS)
+			{
+				tile_lights[slot] = i;
+			}
+		}
+	}
+	GroupMemoryBarrierWithGroupSync();
+
+	if (!covered)
+	{
+		return;
+	}
+
+	Texture2D<float4> t_base_color = ResourceDescriptorHeap[base_color_idx];
+	Texture2D<float2> t_normal = ResourceDescriptorHeap[normal_idx];
+	Texture2D<float2> t_metalness_roughness = ResourceDescriptorHeap[metalness_roughness_idx];
+	float3 base_color = t_base_color.Load(int3(pixel, 0)).rgb;
+	float3 n = octahedral_decode(t_normal.Load(int3(pixel, 0)));
+	float2 metalness_roughness = t_metalness_roughness.Load(int3(pixel, 0));
+	float metalness = metalness_roughness.x;
+	float roughness = metalness_roughness.y;
+
+	float3 world_position = unproject(pixel_to_ndc(float2(pixel) + 0.5), depth);
+	float3 wo = normalize(eye - world_position);
+	float3 Lo = float3(0.0, 0.0, 0.0);
+
+	// Same as `ps_main` in `forward.hlsl`.
+	Texture2D<float4> t_shadow_map = ResourceDescriptorHeap[shadow_map_idx];
+	float4 light_space_position = mul(light_proj_view, float4(world_position, 1.0));
+	float shadow = calculate_shadow(t_shadow_map, s_sampler, light_space_position);
+	Lo += (1.0 - shadow) * calculate_outgoing_radiance(n, wo, -sun_dir, sun_color, base_color, metalness, roughness);
+
+	uint light_count = min(tile_light_count, MAX_TILE_LIGHTS);
+	for (uint j = 0; j < light_count; ++j)
+	{
+		float3 wi;
+		float3 radiance = point_light_radiance(point_lights.lights[tile_lights[j]], world_position, wi);
+		Lo += (1.0 - shadow) * calculate_outgoing_radiance(n, wo, wi, radiance, base_color, metalness, roughness);
+	}
+
+	Lo += ambient * calculate_ambient_radiance(ibl_idx, s_sampler, n, wo, base_color, metalness, roughness);
+
+	RWTexture2D<float4> output = ResourceDescriptorHeap[output_idx];
+	output[pixel] = float4(Lo, 1.0);
+}
@@ -4,6 +4,7 @@ cbuffer Constants : register(b0)
 	float4x4 proj_view;
 }
 
+// Quantized positions are mapped back to the bounds of the mesh by the model matrix.
 float4 main(float3 position : POSITION) : SV_POSITION
 {
 	return mul(proj_view, mul(model, float4(position, 1.0)));
@@ -0,0 +1,38 @@
+#include "meshlet.hlsli"
+
+// See `depth.hlsl`.
+cbuffer Constants : register(b0)
+{
+	float4x4 model;
+	float4x4 proj_view;
+}
+
+struct MSOut
+{
+	float4 position : SV_POSITION;
+};
+
+[outputtopology("triangle")]
+[numthreads(128, 1, 1)]
+void ms_main(
+	uint thread_idx : SV_GroupIndex,
+	uint group_idx : SV_GroupID,
+	in payload Payload payload,
+	out indices uint3 out_triangles[MESHLET_MAX_TRIANGLES],
+	out vertices MSOut out_vertices[MESHLET_MAX_VERTICES]
+)
+{
+	Meshlet meshlet = load_meshlet(payload.meshlet_indices[group_idx]);
+	SetMeshOutputCounts(meshlet.vertex_count, meshlet.triangle_count);
+
+	if (thread_idx < meshlet.triangle_count)
+	{
+		out_triangles[thread_idx] = load_meshlet_triangle(meshlet, thread_idx);
+	}
+
+	if (thread_idx < meshlet.vertex_count)
+	{
+		float3 position = load_position(load_meshlet_vertex(meshlet, thread_idx));
+		out_vertices[thread_idx].position = mul(proj_view, mul(model, float4(position, 1.0)));
+	}
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "lighting.hlsli"
+#include "octahedral.hlsli"
+
+cbuffer Scene : register(b0)
+{
+	float3 eye;
+	float4x4 model;
+	float4x4 proj_view;
+	float4x4 light_proj_view;
+	float3 sun_dir;
+	float ambient;
+	float3 sun_color;
+	uint shadow_map_idx;
+	uint ibl_idx;
+	uint material_offset;
+	uint lights_buffer_idx;
+}
+
+SamplerState s_sampler : register(s0);
+
+struct VSOut
+{
+	float4 clip_position : SV_POSITION;
+	float2 tex_coords : TEXCOORD;
+	float3x3 tbn : NORMAL;
+	float3 world_position : POSITION0;
+	float4 light_space_position : POSITION1;
+};
+
+// Shared by the vertex shader and the mesh shader in `forward_meshlet.hlsl`.
+VSOut transform_vertex(float3 position, float2 normal, uint packed_tangent, float2 tex_coords)
+{
+	float4 world_pos = mul(model, float4(position, 1.0));
+
+	float2 tangent = float2(packed_tangent & 0x7fff, (packed_tangent >> 16) & 0x7fff) / 32767.0 * 2.0 - 1.0;
+	float bitangent_sign = (packed_tangent >> 31) != 0 ? -1.0 : 1.0;
+
+	float3 t = octahedral_decode(tangent);
+	float3 n = octahedral_decode(normal);
+	float3 b = cross(n, t) * bitangent_sign;
+
+	VSOut vs_out;
+	vs_out.clip_position = mul(proj_view, world_pos);
+	vs_out.tex_coords = tex_coords;
+	vs_out.tbn = transpose(float3x3(t, b, n));
+	vs_out.world_position = world_pos.xyz;
+	vs_out.light_space_position = mul(light_proj_view, world_pos);
+
+	return vs_out;
+}
+
+float3 get_base_color(float2 tex_coords)
+{
+	Texture2D<float4> t_diffuse = ResourceDescriptorHeap[material_offset + 0];
+	return t_diffuse.Sample(s_sampler, tex_coords).rgb;
+}
+
+float3 get_normal(float2 tex_coords, float3x3 tbn)
+{
+	Texture2D<float4> t_normal = ResourceDescriptorHeap[material_offset + 1];
+	// Only x and y are read so BC5 compressed normal maps work, z is reconstructed.
+	float2 xy = t_normal.Sample(s_sampler, tex_coords).rg * 2.0 - 1.0;
+	xy.y = -xy.y;
+	float3 normal = float3(xy, sqrt(saturate(1.0 - dot(xy, xy))));
+	normal = normalize(mul(tbn, normal));
+	return normal;
+}
+
+float get_metalness(float2 tex_coords)
+{
+	Texture2D<float4> t_metalness = ResourceDescriptorHeap[material_offset + 2];
+	return t_metalness.Sample(s_sampler, tex_coords).b;
+}
+
+float get_roughness(float2 tex_coords)
+{
+	Texture2D<float4> t_roughness = ResourceDescriptorHeap[material_offset + 2];
+	return t_roughness.Sample(s_sampler, tex_coords).g;
+}
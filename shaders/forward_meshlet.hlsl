@@ -0,0 +1,38 @@
+#include "forward_common.hlsli"
+#include "meshlet.hlsli"
+
+// One meshlet per group, shaded by `ps_main` in `forward.hlsl` or written into the G-buffer by
+// `ps_main` in `gbuffer.hlsl`.
+[outputtopology("triangle")]
+[numthreads(128, 1, 1)]
+void ms_main(
+	uint thread_idx : SV_GroupIndex,
+	uint group_idx : SV_GroupID,
+	in payload Payload payload,
+	out indices uint3 out_triangles[MESHLET_MAX_TRIANGLES],
+	out vertices VSOut out_vertices[MESHLET_MAX_VERTICES]
+)
+{
+	Meshlet meshlet = load_meshlet(payload.meshlet_indices[group_idx]);
+	SetMeshOutputCounts(meshlet.vertex_count, meshlet.triangle_count);
+
+	if (thread_idx < meshlet.triangle_count)
+	{
+		out_triangles[thread_idx] = load_meshlet_triangle(meshlet, thread_idx);
+	}
+
+	if (thread_idx < meshlet.vertex_count)
+	{
+		uint vertex_idx = load_meshlet_vertex(meshlet, thread_idx);
+
+		// `PackedVertexAttributes`: snorm16 normal, packed tangent and half float tex coords.
+		ByteAddressBuffer attributes = ResourceDescriptorHeap[attributes_idx];
+		uint3 packed = attributes.Load3(vertex_idx * 12);
+		int2 normal_snorm = int2(int(packed.x << 16) >> 16, int(packed.x) >> 16);
+		float2 normal = max(float2(normal_snorm) / 32767.0, -1.0);
+		float2 tex_coords = f16tof32(uint2(packed.z & 0xffff, packed.z >> 16));
+
+		float3 position = load_position(vertex_idx);
+		out_vertices[thread_idx] = transform_vertex(position, normal, packed.y, tex_coords);
+	}
+}
@@ -0,0 +1,20 @@
+#include "forward_common.hlsli"
+
+// Written in the formats of `GBUFFER_FORMATS` and read by `deferred_lighting.hlsl`. Vertices come
+// from `vs_main` in `forward.hlsl` or `ms_main` in `forward_meshlet.hlsl`.
+struct GBuffer
+{
+	float4 base_color : SV_TARGET0;
+	// Octahedral encoding of the shading normal.
+	float2 normal : SV_TARGET1;
+	float2 metalness_roughness : SV_TARGET2;
+};
+
+GBuffer ps_main(VSOut vs_out)
+{
+	GBuffer gbuffer;
+	gbuffer.base_color = float4(get_base_color(vs_out.tex_coords), 1.0);
+	gbuffer.normal = octahedral_encode(get_normal(vs_out.tex_coords, vs_out.tbn));
+	gbuffer.metalness_roughness = float2(get_metalness(vs_out.tex_coords), get_roughness(vs_out.tex_coords));
+	return gbuffer;
+}
@@ -0,0 +1,61 @@
+// Has to match `HIZ_GROUP_SIZE`.
+#define HIZ_GROUP_SIZE 8
+
+// See `OcclusionCullPass::HizConstants`.
+cbuffer Constants : register(b0)
+{
+	uint input_idx;
+	uint output_idx;
+	// The first level reads the depth buffer, all others the level before them.
+	uint input_is_depth;
+	uint padding0;
+	uint2 input_size;
+	uint2 output_size;
+}
+
+float load_input(uint2 texel)
+{
+	texel = min(texel, input_size - 1);
+	if (input_is_depth)
+	{
+		Texture2D<float> depth = ResourceDescriptorHeap[input_idx];
+		return depth.Load(int3(texel, 0));
+	}
+	RWTexture2D<float> input = ResourceDescriptorHeap[input_idx];
+	return input[texel];
+}
+
+// Every texel holds the farthest depth of the 2x2 texels below it. Levels are half the size of
+// the one below rounded down, so the last texel of a row or column also takes the odd texel of
+// the level below. Texel `t` of level `k` thereby covers the pixels `t << (k + 1)` up to the next
+// texel, and the last one everything up to the edge of the screen.
+[numthreads(HIZ_GROUP_SIZE, HIZ_GROUP_SIZE, 1)]
+void cs_main(uint2 texel : SV_DispatchThreadID)
+{
+	if (any(texel >= output_size))
+	{
+		return;
+	}
+
+	uint2 extent = uint2(2, 2);
+	if ((input_size.x & 1) != 0 && texel.x == output_size.x - 1)
+	{
+		extent.x = 3;
+	}
+	if ((input_size.y & 1) != 0 && texel.y == output_size.y - 1)
+	{
+		extent.y = 3;
+	}
+
+	float depth = 0.0;
+	for (uint y = 0; y < extent.y; ++y)
+	{
+		for (uint x = 0; x < extent.x; ++x)
+		{
+			depth = max(depth, load_input(texel * 2 + uint2(x, y)));
+		}
+	}
+
+	RWTexture2D<float> output = ResourceDescriptorHeap[output_idx];
+	output[texel] = depth;
+}
@@ -0,0 +1,197 @@
+#pragma once
+
+// Lighting shared by the forward pass and the lighting pass of the deferred path.
+
+#define PI 3.14159265
+
+// Has to match `Renderer::MAX_NUM_POINT_LIGHTS`.
+#define MAX_POINT_LIGHTS 1024
+
+// Radiance below which a point light no longer reaches a surface. Bounds the range of every light
+// so the deferred path can cull them per tile.
+#define POINT_LIGHT_CUTOFF 0.01
+
+// Has to match `IBL_BRDF_LUT_SIZE`.
+#define IBL_BRDF_LUT_SIZE 64
+
+struct PointLight
+{
+	float3 position;
+	float3 color;
+};
+
+struct Lights
+{
+	uint len;
+	PointLight lights[MAX_POINT_LIGHTS];
+};
+
+// See `Renderer::IblBuffer`.
+struct Ibl
+{
+	float4 irradiance_sh[9];
+	uint specular_idx;
+	uint brdf_lut_idx;
+	float specular_max_level;
+};
+
+float point_light_range(PointLight light)
+{
+	return sqrt(max(light.color.r, max(light.color.g, light.color.b)) / POINT_LIGHT_CUTOFF);
+}
+
+// Inverse square falloff, windowed so it reaches zero at the range of the light.
+float3 point_light_radiance(PointLight light, float3 position, out float3 wi)
+{
+	float3 light_dir = light.position - position;
+	float dist = length(light_dir);
+	wi = light_dir / dist;
+
+	float range = point_light_range(light);
+	float ratio = dist / range;
+	float ratio2 = ratio * ratio;
+	float window = saturate(1.0 - ratio2 * ratio2);
+	return light.color / (dist * dist) * (window * window);
+}
+
+float calculate_shadow(Texture2D<float4> shadow_map, SamplerState s, float4 light_space_position)
+{
+	float3 proj_coords = light_space_position.xyz / light_space_position.w;
+	proj_coords.xy = proj_coords.xy * 0.5 + 0.5;
+	proj_coords.y = 1.0 - proj_coords.y;
+
+	if (proj_coords.z > 1.0 || proj_coords.x < 0.0 || proj_coords.y < 0.0 || proj_coords.x > 1.0 || proj_coords.y > 1.0)
+	{
+		return 0.0;
+	}
+
+	float bias = 0.0; // max(0.05 * (1.0 - dot(normal, sun_dir)), 0.005);
+	float current_depth = proj_coords.z;
+	float shadow = 0.0;
+	for (int i = -2; i <= 2; ++i)
+	{
+		for (int j = -2; j <= 2; ++j)
+		{
+			float2 offset = float2(i * 0.0001, j * 0.0001);
+			float closest_depth = shadow_map.SampleLevel(s, proj_coords.xy + offset, 0).r;
+			shadow += (current_depth - bias) > closest_depth ? 1.0 : 0.0;
+		}
+	}
+	shadow /= 25.0;
+
+	return shadow;
+}
+
+float3 fresnel_schlick(float3 cos_theta, float3 F0)
+{
+	return F0 + (1.0 - F0) * pow(clamp(1.0 - cos_theta, 0.0, 1.0), 5.0);
+}
+
+float distribution_ggx(float3 n, float3 h, float roughness)
+{
+	float a = roughness * roughness;
+	float a2 = a * a;
+	float n_dot_h = max(dot(n, h), 0.0);
+	float n_dot_h2 = n_dot_h * n_dot_h;
+
+	float num = a2;
+	float denom = n_dot_h2 * (a2 - 1.0) + 1.0;
+	denom = PI * denom * denom;
+
+	return num / denom;
+}
+
+float geometry_schlick_ggx(float n_dot_wo, float roughness)
+{
+	float r = (roughness + 1.0);
+	float k = (r * r) / 8.0;
+
+	float num = n_dot_wo;
+	float denom = n_dot_wo * (1.0 - k) + k;
+
+	return num / denom;
+}
+
+float geometry_smith(float3 n, float3 wo, float3 wi, float roughness)
+{
+	float n_dot_wo = max(dot(n, wo), 0.0);
+	float n_dot_wi = max(dot(n, wi), 0.0);
+	float ggx1 = geometry_schlick_ggx(n_dot_wo, roughness);
+	float ggx2 = geometry_schlick_ggx(n_dot_wi, roughness);
+	return ggx1 * ggx2;
+}
+
+float3 brdf_cook_torrance(float3 n, float3 h, float3 wo, float3 wi, float roughness, float3 F)
+{
+	float NDF = distribution_ggx(n, h, roughness);
+	float G = geometry_smith(n, wo, wi, roughness);
+
+	float3 num = NDF * G * F;
+	// add 0.0001 to avoid div by 0
+	float denom = 4.0 * max(dot(n, wo), 0.0) * max(dot(n, wi), 0.0) + 0.0001;
+
+	return num / denom;
+}
+
+float3 calculate_outgoing_radiance(float3 n, float3 wo, float3 wi, float3 ingoing_radiance, float3 base_color, float metalness, float roughness)
+{
+	float3 h = normalize(wo + wi);
+
+	float3 F0 = float3(0.04, 0.04, 0.04);
+	F0 = lerp(F0, base_color, metalness);
+	float3 F = fresnel_schlick(max(dot(h, wo), 0.0), F0);
+
+	float3 specular = brdf_cook_torrance(n, h, wo, wi, roughness, F);
+
+	float3 kS = F;
+	float3 kD = 1.0 - kS;
+	kD *= 1.0 - metalness;
+
+	float n_dot_wi = max(dot(n, wi), 0.0);
+	return (kD * base_color / PI + specular) * ingoing_radiance * n_dot_wi;
+}
+
+float3 fresnel_schlick_roughness(float cos_theta, float3 F0, float roughness)
+{
+	return F0 + (max(1.0 - roughness, F0) - F0) * pow(saturate(1.0 - cos_theta), 5.0);
+}
+
+// Same basis as `project_irradiance_sh`.
+float3 evaluate_irradiance_sh(float4 sh[9], float3 n)
+{
+	float3 result = sh[0].rgb * 0.282095;
+	result += sh[1].rgb * 0.488603 * n.y;
+	result += sh[2].rgb * 0.488603 * n.z;
+	result += sh[3].rgb * 0.488603 * n.x;
+	result += sh[4].rgb * 1.092548 * n.x * n.y;
+	result += sh[5].rgb * 1.092548 * n.y * n.z;
+	result += sh[6].rgb * 0.315392 * (3.0 * n.z * n.z - 1.0);
+	result += sh[7].rgb * 1.092548 * n.x * n.z;
+	result += sh[8].rgb * 0.546274 * (n.x * n.x - n.y * n.y);
+	return max(result, 0.0);
+}
+
+// Light reflected from the environment, with the diffuse part from the irradiance SH and the
+// specular part from the split sum approximation.
+float3 calculate_ambient_radiance(uint ibl_idx, SamplerState s, float3 n, float3 wo, float3 base_color, float metalness, float roughness)
+{
+	ConstantBuffer<Ibl> ibl = ResourceDescriptorHeap[ibl_idx];
+	TextureCube<float4> t_specular = ResourceDescriptorHeap[ibl.specular_idx];
+	Texture2D<float2> t_brdf_lut = ResourceDescriptorHeap[ibl.brdf_lut_idx];
+
+	float n_dot_wo = saturate(dot(n, wo));
+	float3 F0 = float3(0.04, 0.04, 0.04);
+	F0 = lerp(F0, base_color, metalness);
+	float3 F = fresnel_schlick_roughness(n_dot_wo, F0, roughness);
+
+	float3 kD = (1.0 - F) * (1.0 - metalness);
+	float3 diffuse = kD * base_color * evaluate_irradiance_sh(ibl.irradiance_sh, n);
+
+	float3 prefiltered = t_specular.SampleLevel(s, reflect(-wo, n), roughness * ibl.specular_max_level).rgb;
+	// Kept half a texel away from the edges, the sampler wraps around.
+	float2 lut_uv = clamp(float2(n_dot_wo, roughness), 0.5 / IBL_BRDF_LUT_SIZE, 1.0 - 0.5 / IBL_BRDF_LUT_SIZE);
+	float2 scale_bias = t_brdf_lut.SampleLevel(s, lut_uv, 0).rg;
+	float3 specular = prefiltered * (F0 * scale_bias.x + scale_bias.y);
+
+	return diffuse + specular;
+}
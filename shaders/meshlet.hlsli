@@ -0,0 +1,89 @@
+#pragma once
+
+#include "culling.hlsli"
+
+// Have to match `MESHLET_MAX_VERTICES`, `MESHLET_MAX_TRIANGLES` and `MESHLET_CULL_GROUP_SIZE`.
+#define MESHLET_MAX_VERTICES 64
+#define MESHLET_MAX_TRIANGLES 124
+#define MESHLET_CULL_GROUP_SIZE 32
+
+// Values of `VertexPositionFormat`.
+#define POSITION_FORMAT_FLOAT 0
+#define POSITION_FORMAT_UNORM16 1
+
+// See `MeshletConstants`.
+cbuffer MeshletConstants : register(b1)
+{
+	float4x4 cull_clip_from_object;
+	float4 cull_view;
+	uint positions_idx;
+	uint attributes_idx;
+	uint meshlets_idx;
+	uint first_meshlet;
+	uint meshlet_count;
+	uint position_format;
+	uint cone_culling;
+}
+
+// See `PackedMeshlet`.
+struct Meshlet
+{
+	uint vertex_offset;
+	uint triangle_offset;
+	uint vertex_count;
+	uint triangle_count;
+	float3 center;
+	float radius;
+	float3 cone_axis;
+	float cone_cutoff;
+};
+
+// Indices of the meshlets that survived culling, from the amplification shader to the mesh
+// shader groups it launches.
+struct Payload
+{
+	uint meshlet_indices[MESHLET_CULL_GROUP_SIZE];
+};
+
+Meshlet load_meshlet(uint meshlet_idx)
+{
+	ByteAddressBuffer meshlets = ResourceDescriptorHeap[meshlets_idx];
+	return meshlets.Load<Meshlet>(meshlet_idx * 48);
+}
+
+// Index of the `local_idx`th vertex of a meshlet in the vertex buffers.
+uint load_meshlet_vertex(Meshlet meshlet, uint local_idx)
+{
+	ByteAddressBuffer meshlets = ResourceDescriptorHeap[meshlets_idx];
+	return meshlets.Load(meshlet.vertex_offset + local_idx * 4);
+}
+
+uint3 load_meshlet_triangle(Meshlet meshlet, uint triangle_idx)
+{
+	ByteAddressBuffer meshlets = ResourceDescriptorHeap[meshlets_idx];
+	uint packed = meshlets.Load(meshlet.triangle_offset + triangle_idx * 4);
+	return uint3(packed & 0xff, (packed >> 8) & 0xff, (packed >> 16) & 0xff);
+}
+
+// Reads a position the way the input assembler does in the vertex shader path.
+float3 load_position(uint vertex_idx)
+{
+	ByteAddressBuffer positions = ResourceDescriptorHeap[positions_idx];
+	if (position_format == POSITION_FORMAT_UNORM16)
+	{
+		uint2 packed = positions.Load2(vertex_idx * 8);
+		return float3(packed.x & 0xffff, packed.x >> 16, packed.y & 0xffff) / 65535.0;
+	}
+	return asfloat(positions.Load3(vertex_idx * 12));
+}
+
+// See `meshlet_cone_culled` and `meshlet_cone_culled_directional`.
+bool cone_culled(Meshlet meshlet)
+{
+	if (cull_view.w == 0.0)
+	{
+		return dot(normalize(cull_view.xyz), meshlet.cone_axis) >= meshlet.cone_cutoff;
+	}
+	float3 view = meshlet.center - cull_view.xyz;
+	return dot(view, meshlet.cone_axis) >= meshlet.cone_cutoff * length(view) + meshlet.radius;
+}
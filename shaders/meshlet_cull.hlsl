@@ -0,0 +1,32 @@
+#include "meshlet.hlsli"
+
+groupshared Payload s_payload;
+groupshared uint s_visible_count;
+
+// Culls one meshlet per thread against the frustum and its normal cone and launches a mesh
+// shader group for each one that is left.
+[numthreads(MESHLET_CULL_GROUP_SIZE, 1, 1)]
+void as_main(uint thread_idx : SV_GroupIndex, uint dispatch_thread_idx : SV_DispatchThreadID)
+{
+	if (thread_idx == 0)
+	{
+		s_visible_count = 0;
+	}
+	GroupMemoryBarrierWithGroupSync();
+
+	if (dispatch_thread_idx < meshlet_count)
+	{
+		uint meshlet_idx = first_meshlet + dispatch_thread_idx;
+		Meshlet meshlet = load_meshlet(meshlet_idx);
+		if (!sphere_outside_frustum(cull_clip_from_object, meshlet.center, meshlet.radius) &&
+			(cone_culling == 0 || !cone_culled(meshlet)))
+		{
+			uint payload_idx;
+			InterlockedAdd(s_visible_count, 1, payload_idx);
+			s_payload.meshlet_indices[payload_idx] = meshlet_idx;
+		}
+	}
+	GroupMemoryBarrierWithGroupSync();
+
+	DispatchMesh(s_visible_count, 1, 1, s_payload);
+}
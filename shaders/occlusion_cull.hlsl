@@ -0,0 +1,126 @@
+#include "culling.hlsli"
+
+// Has to match `OCCLUSION_CULL_GROUP_SIZE`.
+#define OCCLUSION_CULL_GROUP_SIZE 64
+
+// Byte offsets of the counters in `OcclusionStats`.
+#define STATS_FRUSTUM_CULLED 0
+#define STATS_OCCLUDED 4
+#define STATS_LATE_DRAWS 8
+
+// See `OcclusionCullPass::CullConstants`.
+cbuffer Constants : register(b0)
+{
+	float4x4 proj_view;
+	float2 viewport_size;
+	uint hiz_idx;
+	uint hiz_mip_count;
+	uint2 hiz_size;
+	uint draw_count;
+	uint late_predicates_offset;
+}
+
+// See `OcclusionCullPass::CullDraw`.
+struct CullDraw
+{
+	// World space bounding sphere.
+	float4 bounds;
+	uint object_idx;
+	uint3 padding;
+};
+
+StructuredBuffer<CullDraw> draws : register(t0);
+// One 64 bit predicate per object for each phase, see `OcclusionCullPass`.
+RWByteAddressBuffer predicates : register(u0);
+RWByteAddressBuffer stats : register(u1);
+
+// Tests the screen rectangle of the box around a sphere against the level of the depth pyramid
+// where it covers at most 2x2 texels.
+bool sphere_occluded(float3 center, float radius)
+{
+	float2 ndc_min = float2(1.0, 1.0);
+	float2 ndc_max = float2(-1.0, -1.0);
+	float depth_min = 1.0;
+	for (uint i = 0; i < 8; ++i)
+	{
+		float3 corner = center + radius * float3(
+			(i & 1) != 0 ? 1.0 : -1.0,
+			(i & 2) != 0 ? 1.0 : -1.0,
+			(i & 4) != 0 ? 1.0 : -1.0
+		);
+		float4 clip = mul(proj_view, float4(corner, 1.0));
+		// Spheres reaching behind the camera are always drawn.
+		if (clip.w <= 0.0)
+		{
+			return false;
+		}
+		float3 ndc = clip.xyz / clip.w;
+		ndc_min = min(ndc_min, ndc.xy);
+		ndc_max = max(ndc_max, ndc.xy);
+		depth_min = min(depth_min, ndc.z);
+	}
+
+	// Pixel coordinates grow downwards, unlike normalized device coordinates.
+	float2 uv_min = float2(ndc_min.x, -ndc_max.y) * 0.5 + 0.5;
+	float2 uv_max = float2(ndc_max.x, -ndc_min.y) * 0.5 + 0.5;
+	uint2 pixel_min = uint2(clamp(uv_min * viewport_size, 0.0, viewport_size - 1.0));
+	uint2 pixel_max = uint2(clamp(uv_max * viewport_size, 0.0, viewport_size - 1.0));
+
+	uint level = 0;
+	uint2 texel_min = uint2(0, 0);
+	uint2 texel_max = uint2(0, 0);
+	for (; level < hiz_mip_count; ++level)
+	{
+		uint2 level_size = max(hiz_size >> level, uint2(1, 1));
+		texel_min = min(pixel_min >> (level + 1), level_size - 1);
+		texel_max = min(pixel_max >> (level + 1), level_size - 1);
+		if (all(texel_max - texel_min <= 1))
+		{
+			break;
+		}
+	}
+
+	Texture2D<float> hiz = ResourceDescriptorHeap[hiz_idx];
+	float depth = max(
+		max(hiz.Load(int3(texel_min, level)), hiz.Load(int3(texel_max.x, texel_min.y, level))),
+		max(hiz.Load(int3(texel_min.x, texel_max.y, level)), hiz.Load(int3(texel_max, level)))
+	);
+	return depth_min > depth;
+}
+
+// Decides which draws are visible against the depth pyramid of the early draws. The early
+// predicates of the next frame are the visible draws, the late predicates of this frame the
+// visible draws that were not drawn early.
+[numthreads(OCCLUSION_CULL_GROUP_SIZE, 1, 1)]
+void cs_main(uint draw_idx : SV_DispatchThreadID)
+{
+	bool frustum_culled = false;
+	bool occluded = false;
+	bool late = false;
+	if (draw_idx < draw_count)
+	{
+		CullDraw draw = draws[draw_idx];
+		float4 sphere = draw.bounds;
+		uint predicate_offset = draw.object_idx * 8;
+		bool was_visible = predicates.Load(predicate_offset) != 0;
+
+		frustum_culled = sphere_outside_frustum(proj_view, sphere.xyz, sphere.w);
+		occluded = !frustum_culled && sphere_occluded(sphere.xyz, sphere.w);
+		bool visible = !frustum_culled && !occluded;
+		late = visible && !was_visible;
+
+		predicates.Store2(predicate_offset, uint2(visible ? 1 : 0, 0));
+		predicates.Store2(late_predicates_offset + predicate_offset, uint2(late ? 1 : 0, 0));
+	}
+
+	// One atomic per wave instead of one per draw.
+	uint frustum_culled_count = WaveActiveCountBits(frustum_culled);
+	uint occluded_count = WaveActiveCountBits(occluded);
+	uint late_count = WaveActiveCountBits(late);
+	if (WaveIsFirstLane())
+	{
+		stats.InterlockedAdd(STATS_FRUSTUM_CULLED, frustum_culled_count);
+		stats.InterlockedAdd(STATS_OCCLUDED, occluded_count);
+		stats.InterlockedAdd(STATS_LATE_DRAWS, late_count);
+	}
+}
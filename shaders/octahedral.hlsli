@@ -0,0 +1,21 @@
+#pragma once
+
+float3 octahedral_decode(float2 e)
+{
+	float3 n = float3(e.xy, 1.0 - abs(e.x) - abs(e.y));
+	float t = saturate(-n.z);
+	n.x += n.x >= 0.0 ? -t : t;
+	n.y += n.y >= 0.0 ? -t : t;
+	return normalize(n);
+}
+
+float2 octahedral_encode(float3 n)
+{
+	n /= abs(n.x) + abs(n.y) + abs(n.z);
+	float2 e = n.xy;
+	if (n.z < 0.0)
+	{
+		e = (1.0 - abs(n.yx)) * float2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+	}
+	return e;
+}
@@ -5,13 +5,16 @@
 cbuffer Settings : register(b0)
 {
 	uint input_idx;
-	uint output_idx;
 
 	float gamma;
 	uint tm_method;
 	float exposure;
+	uint auto_exposure;
 }
 
+// Adapted log2 luminance followed by the exposure, see `AutoExposurePass::Exposure`.
+ByteAddressBuffer auto_exposure_buffer : register(t0);
+
 static float3x3 ACES_INPUT_MAT = float3x3(
 	0.59719, 0.35458, 0.04823,
 	0.07600, 0.90834, 0.01566,
@@ -43,7 +46,7 @@ float3 tm_reinhard(float3 color)
 
 float3 tm_exposure(float3 color)
 {
-	return float3(1.0, 1.0, 1.0) - exp(-color * exposure);
+	return float3(1.0, 1.0, 1.0) - exp(-color);
 }
 
 // Credits to: https://x.com/self_shadow
@@ -56,22 +59,38 @@ float3 tm_aces(float3 color)
 	return color;
 }
 
-[numthreads(16, 16, 1)] void main(uint3 thread_id : SV_DISPATCHTHREADID)
+struct VSOut
+{
+	float4 clip_position : SV_POSITION;
+};
+
+// Single triangle covering the whole screen, no vertex buffer required.
+VSOut vs_main(uint id : SV_VERTEXID)
 {
-	RWTexture2D<float4> t_input = ResourceDescriptorHeap[input_idx];
-	RWTexture2D<float4> t_output = ResourceDescriptorHeap[output_idx];
+	float2 uv = float2((id << 1) & 2, id & 2);
+
+	VSOut vs_out;
+	vs_out.clip_position = float4(uv * float2(2.0, -2.0) + float2(-1.0, 1.0), 0.0, 1.0);
+
+	return vs_out;
+}
 
-	uint width, height;
-	t_input.GetDimensions(width, height);
+float4 ps_main(VSOut vs_out) : SV_TARGET
+{
+	Texture2D<float4> t_input = ResourceDescriptorHeap[input_idx];
 
-	uint2 coord = thread_id.xy;
+	uint2 coord = uint2(vs_out.clip_position.xy);
+	float3 color = t_input.Load(uint3(coord, 0)).rgb;
 
-	if (coord.x >= width || coord.y >= height)
+	// The automatic exposure applies to every tone mapping, the manual one only to its own.
+	if (auto_exposure != 0)
 	{
-		return;
+		color *= asfloat(auto_exposure_buffer.Load(4));
+	}
+	else if (tm_method == TM_EXPOSURE)
+	{
+		color *= exposure;
 	}
-
-	float3 color = t_input[coord].rgb;
 
 	switch (tm_method)
 	{
@@ -89,5 +108,5 @@ float3 tm_aces(float3 color)
 
 	color = correct_gamma(color);
 
-	t_output[coord] = float4(color, 1.0);
+	return float4(color, 1.0);
 }
@@ -42,8 +42,6 @@ static const float3 CUBE_VERTICES[] = {
 	float3( 1.0f, -1.0f,  1.0f)
 };
 
-static const float2 INV_ATAN = float2(0.1591, 0.3183);
-
 cbuffer Constants : register(b0)
 {
 	uint environment_idx;
@@ -71,20 +69,8 @@ VSOut vs_main(uint id : SV_VERTEXID)
 	return vs_out;
 }
 
-float3 sample_environment(float3 dir)
-{
-	Texture2D t_environment = ResourceDescriptorHeap[environment_idx];
-
-	dir = normalize(dir);
-	float2 uv = float2(atan2(dir.z, dir.x), asin(dir.y));
-	uv *= INV_ATAN;
-	uv += 0.5;
-	uv.y = -uv.y;
-
-	return t_environment.Sample(s_sampler, uv).rgb;
-}
-
 float4 ps_main(VSOut vs_out) : SV_TARGET
 {
-	return float4(sample_environment(vs_out.tex_coords), 1.0);
+	TextureCube<float4> t_environment = ResourceDescriptorHeap[environment_idx];
+	return float4(t_environment.Sample(s_sampler, vs_out.tex_coords).rgb, 1.0);
 }
@@ -1,8 +1,10 @@
 #include "app.hpp"
 
+#include <algorithm>
 #include <chrono>
 #include <cstddef>
 #include <tuple>
+#include <utility>
 
 #include <spdlog/spdlog.h>
 
@@ -12,6 +14,8 @@
 #include <assimp/postprocess.h>
 #include <assimp/scene.h>
 
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
 #include "imgui.h"
@@ -21,11 +25,33 @@
 
 #include "stb_image.h"
 
+#include "renderer/dds.hpp"
+#include "renderer/ktx2.hpp"
+#include "renderer/mesh_optimizer.hpp"
+#include "renderer/mesh_simplifier.hpp"
+
 namespace Arctic
 {
 
 glm::mat4 assimp_to_mat4(const aiMatrix4x4 &mat);
 
+// Loads the KTX2 or DDS file next to `path` if there is one, e.g. created by the texture
+// compressor. Otherwise loads the image at `path` and generates its mip chain.
+[[nodiscard]] bool load_material_texture(
+    const std::filesystem::path &path, Renderer::MipColorSpace color_space,
+    Renderer::TextureImage &out_image
+);
+
+// Warns when a container stores `image` in a different colour space than it is used in. Such
+// textures are sampled the way they were written, e.g. a diffuse map stored as linear data skips
+// the sRGB decode.
+void warn_on_color_space_mismatch(
+    const std::filesystem::path &path, Renderer::MipColorSpace color_space,
+    const Renderer::TextureImage &image
+);
+
+InputEvent input_event_from_sdl(const SDL_Event &event);
+
 [[nodiscard]] bool App::init()
 {
     if (!m_renderer.init())
@@ -33,6 +59,7 @@ glm::mat4 assimp_to_mat4(const aiMatrix4x4 &mat);
         spdlog::error("App::init: failed to initialize renderer");
         return false;
     }
+    m_settings.mesh_shaders = m_settings.mesh_shaders && m_renderer.mesh_shaders_supported();
 
     if (!load_scene(m_scene_path, m_scene))
     {
@@ -40,6 +67,43 @@ glm::mat4 assimp_to_mat4(const aiMatrix4x4 &mat);
         return false;
     }
 
+    m_simulation.set_camera(CameraState{
+        .eye = m_scene.camera.eye,
+        .rotation = m_scene.camera.rotation,
+    });
+
+    if (m_benchmark_options.has_value())
+    {
+        if (!CameraPath::load(m_benchmark_options->camera_path, m_benchmark_camera_path))
+        {
+            spdlog::error("App::init: failed to load benchmark camera path");
+            return false;
+        }
+
+        // Measure how fast frames can be produced, not the refresh rate of the display.
+        Renderer::FramePacingSettings pacing = m_renderer.frame_pacer().settings();
+        pacing.vsync = Renderer::VsyncMode::Off;
+        pacing.fps_cap = 0.0f;
+        if (!m_renderer.frame_pacer().set_settings(pacing))
+        {
+            spdlog::error("App::init: failed to disable vsync for benchmark");
+            return false;
+        }
+
+        m_settings.deferred_shading = m_benchmark_options->deferred_shading;
+        scatter_point_lights(m_benchmark_options->point_lights);
+
+        spdlog::info(
+            "App::init: benchmarking {} frames (+{} warmup) along `{}`, {} shading with {} point "
+            "lights",
+            m_benchmark_options->num_frames,
+            m_benchmark_options->warmup_frames,
+            m_benchmark_options->camera_path.string(),
+            m_settings.deferred_shading ? "deferred" : "forward",
+            m_scene.point_lights.size()
+        );
+    }
+
     return true;
 }
 
@@ -51,6 +115,8 @@ void App::run()
     {
         ZoneScopedN("Main Loop");
 
+        m_renderer.wait_for_next_frame();
+
         std::chrono::high_resolution_clock::time_point now =
             std::chrono::high_resolution_clock::now();
         m_delta_time =
@@ -66,25 +132,41 @@ void App::run()
             m_frame_time_history.pop_front();
         }
 
-        SDL_Event event;
-        if (SDL_PollEvent(&event))
-        {
-            if (event.type == SDL_EVENT_QUIT)
-            {
-                break;
-            }
-            else if (event.type == SDL_EVENT_WINDOW_RESIZED)
-            {
-                if (!handle_resize())
+        // Drain every pending event so input that arrived during the previous frame is not
+        // spread out over several frames.
+        bool quit = false;
+        m_events_this_frame = m_input.drain(
+            [&](InputEvent &out_event) {
+                SDL_Event event;
+                if (quit || !SDL_PollEvent(&event))
                 {
-                    spdlog::error("App::run: resize was requested but failed");
-                    break;
-                };
-            }
+                    return false;
+                }
 
-            handle_event(event);
-
-            ImGui_ImplSDL3_ProcessEvent(&event);
+                if (event.type == SDL_EVENT_QUIT)
+                {
+                    quit = true;
+                    return false;
+                }
+                else if (event.type == SDL_EVENT_WINDOW_RESIZED)
+                {
+                    if (!handle_resize())
+                    {
+                        spdlog::error("App::run: resize was requested but failed");
+                        quit = true;
+                        return false;
+                    };
+                }
+
+                ImGui_ImplSDL3_ProcessEvent(&event);
+                out_event = input_event_from_sdl(event);
+                return true;
+            },
+            m_simulation
+        );
+        if (quit)
+        {
+            break;
         }
 
         update();
@@ -94,6 +176,19 @@ void App::run()
             spdlog::error("App::run: render_frame failed");
             break;
         }
+
+        if (m_benchmark_options.has_value())
+        {
+            // Rendering the frame includes waiting for the GPU to release the frame's resources.
+            std::chrono::duration<float, std::milli> frame_cpu_time =
+                std::chrono::high_resolution_clock::now() - now;
+            float cpu_ms =
+                frame_cpu_time.count() - m_renderer.frame_pacer().stats().gpu_wait_ms;
+            if (!record_benchmark_frame(cpu_ms))
+            {
+                break;
+            }
+        }
     }
     spdlog::trace("App::run: exited loop");
 
@@ -106,61 +201,75 @@ void App::run()
     m_renderer.cleanup();
 }
 
-void App::handle_event(SDL_Event &event)
+InputEvent input_event_from_sdl(const SDL_Event &event)
 {
+    InputEvent input{};
     if (event.type == SDL_EVENT_KEY_DOWN || event.type == SDL_EVENT_KEY_UP)
     {
-        bool pressed = event.type == SDL_EVENT_KEY_DOWN;
-        switch (event.key.scancode)
+        static constexpr std::pair<SDL_Scancode, InputKey> KEYS[] = {
+            {SDL_SCANCODE_W, InputKey::W},
+            {SDL_SCANCODE_A, InputKey::A},
+            {SDL_SCANCODE_S, InputKey::S},
+            {SDL_SCANCODE_D, InputKey::D},
+            {SDL_SCANCODE_SPACE, InputKey::Space},
+            {SDL_SCANCODE_LCTRL, InputKey::LeftCtrl},
+        };
+        for (auto [scancode, key] : KEYS)
         {
-            case SDL_SCANCODE_W:
-                m_input.w = pressed;
-                break;
-            case SDL_SCANCODE_A:
-                m_input.a = pressed;
-                break;
-            case SDL_SCANCODE_S:
-                m_input.s = pressed;
-                break;
-            case SDL_SCANCODE_D:
-                m_input.d = pressed;
-                break;
-            case SDL_SCANCODE_SPACE:
-                m_input.space = pressed;
-                break;
-            case SDL_SCANCODE_LCTRL:
-                m_input.ctrl = pressed;
+            if (event.key.scancode == scancode)
+            {
+                input.type = InputEvent::Type::Key;
+                input.pressed = event.key.down;
+                input.key = key;
                 break;
+            }
         }
     }
     else if (event.type == SDL_EVENT_MOUSE_BUTTON_DOWN || event.type == SDL_EVENT_MOUSE_BUTTON_UP)
     {
-        if (event.button.button == 3)
+        if (event.button.button >= SDL_BUTTON_LEFT && event.button.button <= SDL_BUTTON_RIGHT)
         {
-            m_input.rmb = event.button.down;
+            input.type = InputEvent::Type::MouseButton;
+            input.pressed = event.button.down;
+            input.button = static_cast<MouseButton>(event.button.button - SDL_BUTTON_LEFT);
         }
     }
-    else if (event.type == SDL_EVENT_MOUSE_MOTION && m_input.rmb)
+    else if (event.type == SDL_EVENT_MOUSE_MOTION)
     {
-        m_scene.camera.rotation.y += event.motion.xrel * m_mouse_sensitivity;
-        m_scene.camera.rotation.x -= event.motion.yrel * m_mouse_sensitivity;
+        input.type = InputEvent::Type::MouseMotion;
+        input.motion = glm::vec2(event.motion.xrel, event.motion.yrel);
     }
+    return input;
 }
 
 void App::update()
 {
-    float fwd_input = static_cast<float>(m_input.w) - static_cast<float>(m_input.s);
-    float right_input = static_cast<float>(m_input.d) - static_cast<float>(m_input.a);
-    float up_input = static_cast<float>(m_input.space) - static_cast<float>(m_input.ctrl);
+    ZoneScoped;
 
-    glm::vec3 forward = m_scene.camera.forward();
-    glm::vec3 up = m_scene.camera.up();
-    glm::vec3 right = glm::cross(forward, up);
+    if (m_benchmark_options.has_value())
+    {
+        // The camera follows the path at a fixed rate per frame, independent of the frame time.
+        float time = static_cast<float>(m_benchmark_frame) * m_benchmark_options->time_step;
+        CameraState camera = m_benchmark_camera_path.sample(time);
+        m_scene.camera.eye = camera.eye;
+        m_scene.camera.rotation = camera.rotation;
+    }
+    else
+    {
+        m_simulation_steps_this_frame =
+            m_simulation.advance(m_delta_time, m_input.state(), m_camera_speed);
+        m_simulation.apply_to(m_scene.camera);
+    }
 
-    glm::vec3 &eye = m_scene.camera.eye;
-    eye += m_camera_speed * m_delta_time * fwd_input * forward;
-    eye += m_camera_speed * m_delta_time * up_input * up;
-    eye += m_camera_speed * m_delta_time * right_input * right;
+    if (m_recording_camera_path)
+    {
+        m_recording_time += m_delta_time;
+        m_recorded_camera_path.add_keyframe(CameraKeyframe{
+            .time = m_recording_time,
+            .eye = m_scene.camera.eye,
+            .rotation = m_scene.camera.rotation,
+        });
+    }
 
     if (m_update_lights)
     {
@@ -170,6 +279,35 @@ void App::update()
     }
 }
 
+bool App::record_benchmark_frame(float cpu_ms)
+{
+    const BenchmarkOptions &options = *m_benchmark_options;
+
+    if (m_benchmark_frame >= options.warmup_frames)
+    {
+        m_benchmark_recorder.record_frame(
+            m_delta_time * 1000.0f,
+            cpu_ms,
+            m_renderer.gpu_frame_ms(),
+            m_renderer.frame_pacer().stats(),
+            m_renderer.memory_stats(),
+            m_renderer.pass_timings()
+        );
+    }
+    ++m_benchmark_frame;
+
+    if (m_benchmark_frame < options.warmup_frames + options.num_frames)
+    {
+        return true;
+    }
+
+    if (!m_benchmark_recorder.write_results(options.output_path))
+    {
+        spdlog::error("App::record_benchmark_frame: failed to write benchmark results");
+    }
+    return false;
+}
+
 bool App::load_scene(const std::filesystem::path &path, Renderer::Scene &out_scene)
 {
     Assimp::Importer importer;
@@ -244,51 +382,22 @@ bool App::load_scene(const std::filesystem::path &path, Renderer::Scene &out_sce
             metalness_roughness_path = "./assets/white.png";
         }
 
-        int diffuse_width, diffuse_height;
-        uint8_t *diffuse_image_data =
-            stbi_load(diffuse_path.string().c_str(), &diffuse_width, &diffuse_height, nullptr, 4);
-        if (!diffuse_image_data)
-        {
-            spdlog::error("App::load_scene: failed to load image file `{}`", diffuse_path.string());
-            return false;
-        }
-
-        int normal_width, normal_height;
-        uint8_t *normal_image_data =
-            stbi_load(normal_path.string().c_str(), &normal_width, &normal_height, nullptr, 4);
-        if (!normal_image_data)
-        {
-            spdlog::error("App::load_scene: failed to load image file `{}`", normal_path.string());
-            return false;
-        }
-
-        int metalness_roughness_width, metalness_roughness_height;
-        uint8_t *metalness_roughness_image_data = stbi_load(
-            metalness_roughness_path.string().c_str(),
-            &metalness_roughness_width,
-            &metalness_roughness_height,
-            nullptr,
-            4
-        );
-        if (!metalness_roughness_image_data)
+        Renderer::TextureImage diffuse, normal, metalness_roughness;
+        if (!load_material_texture(diffuse_path, Renderer::MipColorSpace::Srgb, diffuse) ||
+            !load_material_texture(normal_path, Renderer::MipColorSpace::Linear, normal) ||
+            !load_material_texture(
+                metalness_roughness_path,
+                Renderer::MipColorSpace::Linear,
+                metalness_roughness
+            ))
         {
-            spdlog::error(
-                "App::load_scene: failed to load image file `{}`",
-                metalness_roughness_path.string()
-            );
             return false;
         }
 
         if (!m_renderer.create_material(
-                diffuse_image_data,
-                diffuse_width,
-                diffuse_height,
-                normal_image_data,
-                normal_width,
-                normal_height,
-                metalness_roughness_image_data,
-                metalness_roughness_width,
-                metalness_roughness_height
+                std::move(diffuse),
+                std::move(normal),
+                std::move(metalness_roughness)
             ))
         {
             spdlog::error("App::load_scene: failed to create material #{}", mat_idx);
@@ -348,13 +457,43 @@ bool App::load_scene(const std::filesystem::path &path, Renderer::Scene &out_sce
             }
         }
 
-        if (!m_renderer.create_mesh(vertices, indices, ai_mesh->mMaterialIndex))
+        Renderer::MeshOptimizationStats optimization = Renderer::optimize_mesh(vertices, indices);
+        spdlog::info(
+            "App::load_scene: optimized mesh #{}: ACMR {:.3f} -> {:.3f}, ATVR {:.3f} -> {:.3f}",
+            mesh_idx,
+            optimization.before.acmr,
+            optimization.after.acmr,
+            optimization.before.atvr,
+            optimization.after.atvr
+        );
+
+        std::vector<Renderer::MeshLod> lods;
+        Renderer::generate_lod_chain(vertices, indices, lods);
+        spdlog::info(
+            "App::load_scene: generated {} levels of detail for mesh #{}, {} -> {} triangles",
+            lods.size(),
+            mesh_idx,
+            lods.front().index_count / 3,
+            lods.back().index_count / 3
+        );
+
+        if (!m_renderer.create_mesh(vertices, indices, lods, ai_mesh->mMaterialIndex))
         {
             spdlog::error("App::load_scene: failed to create mesh #{}", mesh_idx);
             return false;
         }
     }
 
+    const Renderer::VertexMemoryStats &vertex_stats = m_renderer.vertex_memory_stats();
+    spdlog::info(
+        "App::load_scene: compressed vertices to {:.1f} MiB from {:.1f} MiB, {} of {} meshes "
+        "with quantized positions",
+        static_cast<double>(vertex_stats.compressed_size) / (1024.0 * 1024.0),
+        static_cast<double>(vertex_stats.uncompressed_size) / (1024.0 * 1024.0),
+        vertex_stats.quantized_mesh_count,
+        vertex_stats.mesh_count
+    );
+
     std::vector nodes_to_process{
         std::make_pair(scene->mRootNode, glm::mat4(1.0f)),
     };
@@ -384,6 +523,40 @@ bool App::load_scene(const std::filesystem::path &path, Renderer::Scene &out_sce
     return true;
 }
 
+void App::scatter_point_lights(uint32_t count)
+{
+    if (m_scene.objects.empty())
+    {
+        return;
+    }
+
+    glm::vec3 bounds_min, bounds_max;
+    Renderer::scene_bounds(m_scene.objects, m_renderer.mesh_draw_infos(), bounds_min, bounds_max);
+    float range = glm::length(bounds_max - bounds_min) / 10.0f;
+    float intensity = Renderer::Renderer::POINT_LIGHT_CUTOFF * range * range;
+
+    std::uniform_real_distribution<float> unit_dist(0.0f, 1.0f);
+    size_t free_lights = Renderer::Renderer::MAX_NUM_POINT_LIGHTS - m_scene.point_lights.size();
+    for (size_t i = 0; i < std::min(static_cast<size_t>(count), free_lights); ++i)
+    {
+        // Braces evaluate the draws in order, so every run scatters the same lights.
+        glm::vec3 t{unit_dist(m_light_rng), unit_dist(m_light_rng), unit_dist(m_light_rng)};
+        glm::vec3 position = bounds_min + (bounds_max - bounds_min) * t;
+        // Fully saturated color of a random hue.
+        float hue = unit_dist(m_light_rng) * 6.0f;
+        glm::vec3 color = glm::clamp(
+            glm::abs(glm::mod(glm::vec3(hue) + glm::vec3(0.0f, 4.0f, 2.0f), 6.0f) - 3.0f) - 1.0f,
+            0.0f,
+            1.0f
+        );
+        m_scene.point_lights.emplace_back(Renderer::PointLight{
+            .position = position,
+            .color = color * intensity,
+        });
+    }
+    m_update_lights = true;
+}
+
 bool App::render_frame()
 {
     ZoneScoped;
@@ -406,6 +579,151 @@ void App::build_ui()
         ImGui::Text("Frame Time: %.2f ms", m_delta_time * 1000.0f);
         ImGui::Text("FPS: %u", static_cast<uint32_t>(1.0f / m_delta_time));
 
+        const Renderer::FramePacingStats &pacing_stats = m_renderer.frame_pacer().stats();
+        ImGui::Text("CPU Wait: %.2f ms", pacing_stats.cpu_wait_ms);
+        ImGui::Text("GPU Wait: %.2f ms", pacing_stats.gpu_wait_ms);
+        ImGui::Text("Est. Latency: %.2f ms", pacing_stats.estimated_latency_ms);
+        ImGui::Text("Events: %u", m_events_this_frame);
+        ImGui::Text(
+            "Simulation Steps: %u (alpha %.2f)",
+            m_simulation_steps_this_frame,
+            m_simulation.interpolation_alpha()
+        );
+
+        const Renderer::TransientMemoryStats &transient_stats =
+            m_renderer.transient_memory_stats();
+        ImGui::Text(
+            "Transient RTs: %.1f MiB (%.1f MiB unaliased)",
+            static_cast<double>(transient_stats.heap_size) / (1024.0 * 1024.0),
+            static_cast<double>(transient_stats.unaliased_size) / (1024.0 * 1024.0)
+        );
+
+        const Renderer::VertexMemoryStats &vertex_stats = m_renderer.vertex_memory_stats();
+        ImGui::Text(
+            "Vertices: %.1f MiB (%.1f MiB uncompressed)",
+            static_cast<double>(vertex_stats.compressed_size) / (1024.0 * 1024.0),
+            static_cast<double>(vertex_stats.uncompressed_size) / (1024.0 * 1024.0)
+        );
+
+        if (m_settings.occlusion_culling)
+        {
+            const Renderer::OcclusionStats &occlusion_stats = m_renderer.occlusion_stats();
+            ImGui::Text(
+                "Draws: %u (%u outside frustum, %u occluded, %u drawn late)",
+                occlusion_stats.draw_count,
+                occlusion_stats.frustum_culled,
+                occlusion_stats.occluded,
+                occlusion_stats.late_draws
+            );
+        }
+
+        if (m_settings.software_occlusion)
+        {
+            const Renderer::SoftwareOcclusionStats &software_stats =
+                m_renderer.software_occlusion_stats();
+            ImGui::Text(
+                "Software: %u occluders (%u tris), %u outside frustum, %u occluded, %.2f ms",
+                software_stats.occluder_count,
+                software_stats.triangle_count,
+                software_stats.frustum_culled,
+                software_stats.occluded,
+                static_cast<double>(
+                    software_stats.setup_ms + software_stats.raster_ms + software_stats.test_ms
+                )
+            );
+        }
+
+        ImGui::Text("GPU Time: %.2f ms", m_renderer.gpu_frame_ms());
+        if (ImGui::BeginTable("Passes", 3, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
+        {
+            ImGui::TableSetupColumn("Pass");
+            ImGui::TableSetupColumn("CPU (ms)");
+            ImGui::TableSetupColumn("GPU (ms)");
+            ImGui::TableHeadersRow();
+            for (const Renderer::PassTiming &timing : m_renderer.pass_timings())
+            {
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::TextUnformatted(timing.name.c_str());
+                ImGui::TableNextColumn();
+                ImGui::Text("%.3f", timing.cpu_ms);
+                ImGui::TableNextColumn();
+                if (timing.gpu_ms.has_value())
+                {
+                    ImGui::Text("%.3f", *timing.gpu_ms);
+                }
+                else
+                {
+                    ImGui::TextUnformatted("-");
+                }
+            }
+            ImGui::EndTable();
+        }
+
+        if (ImGui::CollapsingHeader("Memory"))
+        {
+            constexpr double MIB = 1024.0 * 1024.0;
+            Renderer::MemoryStats memory_stats = m_renderer.memory_stats();
+            if (m_renderer.is_near_memory_budget())
+            {
+                ImGui::TextColored(
+                    ImVec4(1.0f, 0.3f, 0.3f, 1.0f),
+                    "Video memory usage is close to the budget!"
+                );
+            }
+            ImGui::Text(
+                "Local: %.0f / %.0f MiB",
+                static_cast<double>(memory_stats.local_usage) / MIB,
+                static_cast<double>(memory_stats.local_budget) / MIB
+            );
+            ImGui::Text(
+                "Non-Local: %.0f / %.0f MiB",
+                static_cast<double>(memory_stats.non_local_usage) / MIB,
+                static_cast<double>(memory_stats.non_local_budget) / MIB
+            );
+            ImGui::Text(
+                "Tracked: %.1f MiB (peak %.1f MiB)",
+                static_cast<double>(memory_stats.total_live_bytes) / MIB,
+                static_cast<double>(memory_stats.total_peak_bytes) / MIB
+            );
+
+            Renderer::TextureStreamingStats streaming_stats = m_renderer.texture_streaming_stats();
+            ImGui::Text(
+                "Streamed Textures: %.1f / %.0f MiB (allocated %.1f MiB, wanted %.1f MiB, %u in "
+                "flight)",
+                static_cast<double>(streaming_stats.resident_bytes) / MIB,
+                static_cast<double>(streaming_stats.budget) / MIB,
+                static_cast<double>(streaming_stats.allocated_bytes) / MIB,
+                static_cast<double>(streaming_stats.wanted_bytes) / MIB,
+                streaming_stats.requests_in_flight
+            );
+
+            if (ImGui::BeginTable("Memory", 4, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
+            {
+                ImGui::TableSetupColumn("Category");
+                ImGui::TableSetupColumn("Live (MiB)");
+                ImGui::TableSetupColumn("Peak (MiB)");
+                ImGui::TableSetupColumn("Count");
+                ImGui::TableHeadersRow();
+                for (size_t category = 0; category < memory_stats.categories.size(); ++category)
+                {
+                    const Renderer::MemoryCategoryStats &stats = memory_stats.categories[category];
+                    ImGui::TableNextRow();
+                    ImGui::TableNextColumn();
+                    ImGui::TextUnformatted(Renderer::memory_category_name(
+                        static_cast<Renderer::MemoryCategory>(category)
+                    ));
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%.1f", static_cast<double>(stats.live_bytes) / MIB);
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%.1f", static_cast<double>(stats.peak_bytes) / MIB);
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%u", stats.live_allocations);
+                }
+                ImGui::EndTable();
+            }
+        }
+
         ImGui::Checkbox("Show FPS graph", &m_show_fps_graph);
 
         if (ImPlot::BeginPlot("FPS"))
@@ -455,19 +773,49 @@ void App::build_ui()
     {
         ImGui::SeparatorText("Camera");
         ImGui::SliderFloat("Speed", &m_camera_speed, 0.1f, 5000.0f);
-        ImGui::SliderFloat("Sensitivity", &m_mouse_sensitivity, 0.01f, 2.0f);
-        ImGui::DragFloat3("Position", glm::value_ptr(m_scene.camera.eye), 0.1f);
-        ImGui::DragFloat2(
+        ImGui::SliderFloat("Sensitivity", &m_input.mouse_sensitivity, 0.01f, 2.0f);
+        CameraState camera_state{
+            .eye = m_scene.camera.eye,
+            .rotation = m_scene.camera.rotation,
+        };
+        bool camera_changed =
+            ImGui::DragFloat3("Position", glm::value_ptr(camera_state.eye), 0.1f);
+        camera_changed |= ImGui::DragFloat2(
             "Rotation",
-            glm::value_ptr(m_scene.camera.rotation),
+            glm::value_ptr(camera_state.rotation),
             0.1f,
             -360.0f,
             360.0f
         );
+        if (camera_changed)
+        {
+            m_simulation.set_camera(camera_state);
+        }
         ImGui::DragFloat2("Z Near/Far", m_scene.camera.z_near_far.data(), 0.01f, 0.001f, 10000.0f);
 
+        if (!m_recording_camera_path && ImGui::Button("Record Camera Path"))
+        {
+            m_recorded_camera_path.clear();
+            m_recording_time = 0.0f;
+            m_recording_camera_path = true;
+        }
+        else if (m_recording_camera_path && ImGui::Button("Stop Recording"))
+        {
+            m_recording_camera_path = false;
+            if (!m_recorded_camera_path.save("camera_path.txt"))
+            {
+                spdlog::error("App::build_ui: failed to save camera path");
+            }
+        }
+        if (m_recording_camera_path)
+        {
+            ImGui::SameLine();
+            ImGui::Text("%zu keyframes", m_recorded_camera_path.size());
+        }
+
         ImGui::SeparatorText("Light");
-        ImGui::SliderFloat("Ambient", &m_scene.ambient, 0.0f, 1.0f);
+        ImGui::Checkbox("Tiled Deferred Shading", &m_settings.deferred_shading);
+        ImGui::SliderFloat("Ambient", &m_scene.ambient, 0.0f, 2.0f);
         ImGui::DragFloat3("Sun Position", glm::value_ptr(m_scene.sun.position));
         ImGui::DragFloat2(
             "Sun Rotation",
@@ -482,10 +830,52 @@ void App::build_ui()
             ImGuiColorEditFlags_HDR | ImGuiColorEditFlags_Float | ImGuiColorEditFlags_PickerHueWheel
         );
 
+        ImGui::SeparatorText("Frame Pacing");
+        Renderer::FramePacingSettings pacing = m_renderer.frame_pacer().settings();
+        int vsync = static_cast<int>(pacing.vsync);
+        int max_frame_latency = static_cast<int>(pacing.max_frame_latency);
+        bool pacing_changed = ImGui::Combo("VSync", &vsync, "Off\0On\0Half\0");
+        pacing_changed |= ImGui::SliderInt(
+            "Max Frame Latency",
+            &max_frame_latency,
+            1,
+            static_cast<int>(Renderer::RHI::NUM_FRAMES)
+        );
+        pacing_changed |=
+            ImGui::DragFloat("FPS Cap", &pacing.fps_cap, 1.0f, 0.0f, 1000.0f, "%.0f (0 = off)");
+        if (pacing_changed)
+        {
+            pacing.vsync = static_cast<Renderer::VsyncMode>(vsync);
+            pacing.max_frame_latency = static_cast<uint32_t>(max_frame_latency);
+            if (!m_renderer.frame_pacer().set_settings(pacing))
+            {
+                spdlog::error("App::build_ui: failed to apply frame pacing settings");
+            }
+        }
+
+        ImGui::SeparatorText("Geometry");
+        ImGui::BeginDisabled(!m_renderer.mesh_shaders_supported());
+        ImGui::Checkbox("Mesh Shaders", &m_settings.mesh_shaders);
+        ImGui::EndDisabled();
+        ImGui::Checkbox("Occlusion Culling", &m_settings.occlusion_culling);
+        ImGui::Checkbox("Software Occlusion Culling", &m_settings.software_occlusion);
+
         ImGui::SeparatorText("Post Processing");
         ImGui::DragFloat("Gamma", &m_settings.gamma, 0.01f, 0.1f, 5.0f);
         ImGui::Combo("Tone Mapping", &m_settings.tm_method, "Reinhard\0Exposure\0ACES\0");
-        if (m_settings.tm_method == 1)
+        ImGui::Checkbox("Auto Exposure", &m_settings.auto_exposure);
+        if (m_settings.auto_exposure)
+        {
+            ImGui::DragFloat(
+                "Exposure Compensation",
+                &m_settings.exposure_compensation,
+                0.05f,
+                -5.0f,
+                5.0f,
+                "%.2f EV"
+            );
+        }
+        else if (m_settings.tm_method == 1)
         {
             ImGui::DragFloat("Exposure", &m_settings.exposure, 0.1f, 0.0f, 10.0f);
         }
@@ -494,18 +884,24 @@ void App::build_ui()
 
     if (ImGui::Begin("Lights", nullptr, ImGuiWindowFlags_AlwaysAutoResize))
     {
-        for (Renderer::PointLight &light : m_scene.point_lights)
-        {
-            ImGui::PushID(&light);
-            ImGui::Separator();
-            m_update_lights |= ImGui::DragFloat3("Position", glm::value_ptr(light.position), 0.1f);
-            m_update_lights |= ImGui::ColorEdit3(
-                "Color",
-                glm::value_ptr(light.color),
-                ImGuiColorEditFlags_HDR | ImGuiColorEditFlags_Float |
-                    ImGuiColorEditFlags_PickerHueWheel
-            );
-            ImGui::PopID();
+        ImGui::SetNextItemOpen(true, ImGuiCond_Once);
+        if (ImGui::TreeNode("Point Lights", "%zu Point Lights", m_scene.point_lights.size()))
+        {
+            for (Renderer::PointLight &light : m_scene.point_lights)
+            {
+                ImGui::PushID(&light);
+                ImGui::Separator();
+                m_update_lights |=
+                    ImGui::DragFloat3("Position", glm::value_ptr(light.position), 0.1f);
+                m_update_lights |= ImGui::ColorEdit3(
+                    "Color",
+                    glm::value_ptr(light.color),
+                    ImGuiColorEditFlags_HDR | ImGuiColorEditFlags_Float |
+                        ImGuiColorEditFlags_PickerHueWheel
+                );
+                ImGui::PopID();
+            }
+            ImGui::TreePop();
         }
 
         if (m_scene.point_lights.size() < Renderer::Renderer::MAX_NUM_POINT_LIGHTS)
@@ -518,6 +914,20 @@ void App::build_ui()
                 });
                 m_update_lights = true;
             }
+            ImGui::SameLine();
+            if (ImGui::Button("Scatter 64"))
+            {
+                scatter_point_lights(64);
+            }
+        }
+        if (!m_scene.point_lights.empty())
+        {
+            ImGui::SameLine();
+            if (ImGui::Button("Clear"))
+            {
+                m_scene.point_lights.clear();
+                m_update_lights = true;
+            }
         }
     }
     ImGui::End();
@@ -563,4 +973,72 @@ glm::mat4 assimp_to_mat4(const aiMatrix4x4 &mat)
     return out;
 }
 
+bool load_material_texture(
+    const std::filesystem::path &path, Renderer::MipColorSpace color_space,
+    Renderer::TextureImage &out_image
+)
+{
+    std::filesystem::path ktx2_path = path;
+    ktx2_path.replace_extension(".ktx2");
+    if (std::filesystem::exists(ktx2_path))
+    {
+        if (!Renderer::load_ktx2(ktx2_path, out_image))
+        {
+            return false;
+        }
+        warn_on_color_space_mismatch(ktx2_path, color_space, out_image);
+        return true;
+    }
+
+    std::filesystem::path dds_path = path;
+    dds_path.replace_extension(".dds");
+    if (std::filesystem::exists(dds_path))
+    {
+        if (!Renderer::load_dds(dds_path, color_space, out_image))
+        {
+            return false;
+        }
+        warn_on_color_space_mismatch(dds_path, color_space, out_image);
+        return true;
+    }
+
+    int width, height;
+    uint8_t *image_data = stbi_load(path.string().c_str(), &width, &height, nullptr, 4);
+    if (!image_data)
+    {
+        spdlog::error("load_material_texture: failed to load image file `{}`", path.string());
+        return false;
+    }
+
+    Renderer::MipChain mip_chain;
+    Renderer::generate_mip_chain(
+        image_data,
+        static_cast<uint32_t>(width),
+        static_cast<uint32_t>(height),
+        color_space,
+        mip_chain
+    );
+    stbi_image_free(image_data);
+
+    Renderer::texture_image_from_mip_chain(std::move(mip_chain), color_space, out_image);
+
+    return true;
+}
+
+void warn_on_color_space_mismatch(
+    const std::filesystem::path &path, Renderer::MipColorSpace color_space,
+    const Renderer::TextureImage &image
+)
+{
+    if (Renderer::format_in_color_space(image.format, color_space) != image.format)
+    {
+        spdlog::warn(
+            "load_material_texture: `{}` is stored as {} but holds {} data",
+            path.string(),
+            Renderer::texture_format_name(image.format),
+            color_space == Renderer::MipColorSpace::Srgb ? "sRGB" : "linear"
+        );
+    }
+}
+
 } // namespace Arctic
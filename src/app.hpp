@@ -4,12 +4,16 @@
 #include <chrono>
 #include <deque>
 #include <filesystem>
+#include <optional>
+#include <random>
 
 #include <SDL3/SDL_events.h>
 #include <SDL3/SDL_video.h>
 
+#include "benchmark.hpp"
 #include "renderer/renderer.hpp"
 #include "renderer/scene.hpp"
+#include "simulation.hpp"
 
 namespace Arctic
 {
@@ -30,15 +34,16 @@ class App
     std::deque<float> m_frame_time_history;
     bool m_show_fps_graph{false};
 
-    struct
-    {
-        bool w, a, s, d, space, ctrl, rmb;
-    } m_input{};
+    InputHandler m_input;
+    Simulation m_simulation;
+    uint32_t m_events_this_frame{0};
+    uint32_t m_simulation_steps_this_frame{0};
     float m_camera_speed{10.0f};
-    float m_mouse_sensitivity{0.5f};
 
     std::filesystem::path m_scene_path;
     bool m_update_lights{true};
+    // Seeded the same in every run, so benchmarks scatter the same lights.
+    std::mt19937 m_light_rng{0};
     Renderer::Scene m_scene{
         .camera{
             .eye = {0.0f, 5.0f, 0.0f},
@@ -47,7 +52,7 @@ class App
             .fov_y = 45.0f,
             .z_near_far = {0.1f, 1000.0f},
         },
-        .ambient = 0.1f,
+        .ambient = 1.0f,
         .sun{
             .position = {-10.0f, 32.0f, -2.48f},
             .rotation = {-70.0f, 12.0f},
@@ -62,9 +67,22 @@ class App
     };
     Renderer::Settings m_settings;
 
+    std::optional<BenchmarkOptions> m_benchmark_options;
+    CameraPath m_benchmark_camera_path;
+    BenchmarkRecorder m_benchmark_recorder;
+    uint32_t m_benchmark_frame{0};
+
+    CameraPath m_recorded_camera_path;
+    bool m_recording_camera_path{false};
+    float m_recording_time{0.0f};
+
   public:
-    explicit App(SDL_Window *window, const std::filesystem::path &scene_path)
-        : m_renderer(window, WINDOW_WIDTH, WINDOW_HEIGHT), m_scene_path(scene_path)
+    explicit App(
+        SDL_Window *window, const std::filesystem::path &scene_path,
+        std::optional<BenchmarkOptions> benchmark_options = std::nullopt
+    )
+        : m_renderer(window, WINDOW_WIDTH, WINDOW_HEIGHT), m_scene_path(scene_path),
+          m_benchmark_options(std::move(benchmark_options))
     {
     }
 
@@ -73,12 +91,18 @@ class App
     void run();
 
   private:
-    void handle_event(SDL_Event &event);
-
     void update();
 
+    // Records the timings of the frame that was just rendered. Returns false once all benchmark
+    // frames have been rendered.
+    [[nodiscard]] bool record_benchmark_frame(float cpu_ms);
+
     [[nodiscard]] bool load_scene(const std::filesystem::path &path, Renderer::Scene &out_scene);
 
+    // Adds up to `count` point lights of random colors at random positions within the bounds of
+    // the scene, each reaching a tenth of its size.
+    void scatter_point_lights(uint32_t count);
+
     [[nodiscard]] bool render_frame();
 
     void build_ui();
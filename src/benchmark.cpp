@@ -0,0 +1,458 @@
+#include "benchmark.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+
+#include <spdlog/spdlog.h>
+
+namespace Arctic
+{
+
+struct MetricSummary
+{
+    size_t count;
+    float mean, min, max, p50, p95, p99;
+};
+
+static float percentile(const std::vector<float> &sorted_values, float p)
+{
+    if (sorted_values.empty())
+    {
+        return 0.0f;
+    }
+
+    // Nearest-rank percentile.
+    float count = static_cast<float>(sorted_values.size());
+    size_t rank = static_cast<size_t>(std::ceil(p / 100.0f * count));
+    return sorted_values[std::clamp<size_t>(rank, 1, sorted_values.size()) - 1];
+}
+
+static MetricSummary summarize(std::vector<float> values)
+{
+    if (values.empty())
+    {
+        return MetricSummary{};
+    }
+
+    std::sort(values.begin(), values.end());
+
+    double sum = 0.0;
+    for (float value : values)
+    {
+        sum += static_cast<double>(value);
+    }
+
+    return MetricSummary{
+        .count = values.size(),
+        .mean = static_cast<float>(sum / static_cast<double>(values.size())),
+        .min = values.front(),
+        .max = values.back(),
+        .p50 = percentile(values, 50.0f),
+        .p95 = percentile(values, 95.0f),
+        .p99 = percentile(values, 99.0f),
+    };
+}
+
+// Escapes quotes, backslashes and control characters, which JSON does not allow unescaped in
+// strings.
+static std::string json_escape(const std::string &str)
+{
+    static constexpr char HEX_DIGITS[] = "0123456789abcdef";
+
+    std::string out;
+    out.reserve(str.size());
+    for (char c : str)
+    {
+        auto byte = static_cast<unsigned char>(c);
+        if (c == '"' || c == '\\')
+        {
+            out.push_back('\\');
+            out.push_back(c);
+        }
+        else if (c == '\n')
+        {
+            out += "\\n";
+        }
+        else if (c == '\r')
+        {
+            out += "\\r";
+        }
+        else if (c == '\t')
+        {
+            out += "\\t";
+        }
+        else if (byte < 0x20)
+        {
+            out += "\\u00";
+            out.push_back(HEX_DIGITS[byte >> 4]);
+            out.push_back(HEX_DIGITS[byte & 0xf]);
+        }
+        else
+        {
+            out.push_back(c);
+        }
+    }
+    return out;
+}
+
+// Value of a pass in a frame, empty if the pass was not recorded in it. Frames recorded before a
+// pass first showed up have fewer entries.
+static std::optional<float> pass_value(const std::vector<std::optional<float>> &values, size_t idx)
+{
+    return idx < values.size() ? values[idx] : std::nullopt;
+}
+
+// Quotes a CSV field as described in RFC 4180, doubling any quotes it contains, so pass names
+// with commas, quotes or line breaks stay a single field.
+static std::string csv_quote(const std::string &str)
+{
+    std::string out;
+    out.reserve(str.size() + 2);
+    out.push_back('"');
+    for (char c : str)
+    {
+        if (c == '"')
+        {
+            out.push_back('"');
+        }
+        out.push_back(c);
+    }
+    out.push_back('"');
+    return out;
+}
+
+bool CameraPath::load(const std::filesystem::path &path, CameraPath &out_path)
+{
+    std::ifstream file(path);
+    if (!file)
+    {
+        spdlog::error("CameraPath::load: failed to open `{}`", path.string());
+        return false;
+    }
+
+    out_path.clear();
+
+    std::string line;
+    size_t line_number = 0;
+    while (std::getline(file, line))
+    {
+        ++line_number;
+        if (line.empty() || line[0] == '#')
+        {
+            continue;
+        }
+
+        std::istringstream stream(line);
+        CameraKeyframe keyframe{};
+        stream >> keyframe.time >> keyframe.eye.x >> keyframe.eye.y >> keyframe.eye.z >>
+            keyframe.rotation.x >> keyframe.rotation.y;
+        if (!stream)
+        {
+            spdlog::error("CameraPath::load: malformed keyframe in line {}", line_number);
+            return false;
+        }
+
+        if (!out_path.m_keyframes.empty() && keyframe.time < out_path.m_keyframes.back().time)
+        {
+            spdlog::error("CameraPath::load: keyframe in line {} is out of order", line_number);
+            return false;
+        }
+
+        out_path.m_keyframes.emplace_back(keyframe);
+    }
+
+    if (out_path.empty())
+    {
+        spdlog::error("CameraPath::load: `{}` contains no keyframes", path.string());
+        return false;
+    }
+
+    return true;
+}
+
+bool CameraPath::save(const std::filesystem::path &path) const
+{
+    std::ofstream file(path);
+    if (!file)
+    {
+        spdlog::error("CameraPath::save: failed to open `{}`", path.string());
+        return false;
+    }
+
+    file << "# time eye_x eye_y eye_z pitch yaw\n";
+    for (const CameraKeyframe &keyframe : m_keyframes)
+    {
+        file << keyframe.time << ' ' << keyframe.eye.x << ' ' << keyframe.eye.y << ' '
+             << keyframe.eye.z << ' ' << keyframe.rotation.x << ' ' << keyframe.rotation.y
+             << '\n';
+    }
+
+    return static_cast<bool>(file);
+}
+
+CameraState CameraPath::sample(float time) const
+{
+    if (m_keyframes.empty())
+    {
+        return CameraState{};
+    }
+
+    auto next = std::upper_bound(
+        m_keyframes.begin(),
+        m_keyframes.end(),
+        time,
+        [](float t, const CameraKeyframe &keyframe) { return t < keyframe.time; }
+    );
+    if (next == m_keyframes.begin())
+    {
+        return CameraState{.eye = next->eye, .rotation = next->rotation};
+    }
+    if (next == m_keyframes.end())
+    {
+        const CameraKeyframe &last = m_keyframes.back();
+        return CameraState{.eye = last.eye, .rotation = last.rotation};
+    }
+
+    const CameraKeyframe &prev = *(next - 1);
+    float span = next->time - prev.time;
+    float alpha = span > 0.0f ? (time - prev.time) / span : 1.0f;
+    return CameraState{
+        .eye = prev.eye + (next->eye - prev.eye) * alpha,
+        .rotation = prev.rotation + (next->rotation - prev.rotation) * alpha,
+    };
+}
+
+void BenchmarkRecorder::record_frame(
+    float frame_ms, float cpu_ms, float gpu_ms, const Renderer::FramePacingStats &pacing_stats,
+    const Renderer::MemoryStats &memory_stats, std::span<const Renderer::PassTiming> pass_timings
+)
+{
+    m_memory_stats = memory_stats;
+
+    BenchmarkFrame frame{
+        .frame_ms = frame_ms,
+        .cpu_ms = cpu_ms,
+        .cpu_wait_ms = pacing_stats.cpu_wait_ms,
+        .gpu_wait_ms = pacing_stats.gpu_wait_ms,
+        .gpu_ms = gpu_ms,
+        .local_memory_mb = static_cast<float>(memory_stats.local_usage) / (1024.0f * 1024.0f),
+        .pass_cpu_ms = std::vector<std::optional<float>>(m_pass_names.size()),
+        .pass_gpu_ms = std::vector<std::optional<float>>(m_pass_names.size()),
+    };
+
+    // Passes are matched by name so a pass that is only added in some frames does not shift the
+    // columns of the others.
+    for (const Renderer::PassTiming &timing : pass_timings)
+    {
+        auto it = std::find(m_pass_names.begin(), m_pass_names.end(), timing.name);
+        size_t pass_idx = static_cast<size_t>(it - m_pass_names.begin());
+        if (it == m_pass_names.end())
+        {
+            m_pass_names.emplace_back(timing.name);
+            frame.pass_cpu_ms.resize(m_pass_names.size());
+            frame.pass_gpu_ms.resize(m_pass_names.size());
+        }
+        frame.pass_cpu_ms[pass_idx] = timing.cpu_ms;
+        frame.pass_gpu_ms[pass_idx] = timing.gpu_ms;
+    }
+
+    m_frames.emplace_back(std::move(frame));
+}
+
+bool BenchmarkRecorder::write_results(const std::filesystem::path &output_path) const
+{
+    std::filesystem::path csv_path = output_path;
+    csv_path.replace_extension(".csv");
+    if (!write_csv(csv_path))
+    {
+        spdlog::error("BenchmarkRecorder::write_results: failed to write csv");
+        return false;
+    }
+
+    std::filesystem::path json_path = output_path;
+    json_path.replace_extension(".json");
+    if (!write_json(json_path))
+    {
+        spdlog::error("BenchmarkRecorder::write_results: failed to write json");
+        return false;
+    }
+
+    spdlog::info(
+        "BenchmarkRecorder::write_results: wrote {} frames to `{}` and `{}`",
+        m_frames.size(),
+        csv_path.string(),
+        json_path.string()
+    );
+
+    return true;
+}
+
+bool BenchmarkRecorder::write_csv(const std::filesystem::path &path) const
+{
+    std::ofstream file(path);
+    if (!file)
+    {
+        spdlog::error("BenchmarkRecorder::write_csv: failed to open `{}`", path.string());
+        return false;
+    }
+
+    file << "frame,frame_ms,cpu_ms,cpu_wait_ms,gpu_wait_ms,gpu_ms,local_memory_mb";
+    for (const std::string &name : m_pass_names)
+    {
+        file << ',' << csv_quote(name + " cpu_ms") << ',' << csv_quote(name + " gpu_ms");
+    }
+    file << '\n';
+
+    for (size_t frame_idx = 0; frame_idx < m_frames.size(); ++frame_idx)
+    {
+        const BenchmarkFrame &frame = m_frames[frame_idx];
+        file << frame_idx << ',' << frame.frame_ms << ',' << frame.cpu_ms << ','
+             << frame.cpu_wait_ms << ',' << frame.gpu_wait_ms << ',' << frame.gpu_ms << ','
+             << frame.local_memory_mb;
+        // Passes missing from the frame leave their cells empty.
+        for (size_t pass_idx = 0; pass_idx < m_pass_names.size(); ++pass_idx)
+        {
+            file << ',';
+            if (std::optional<float> cpu_ms = pass_value(frame.pass_cpu_ms, pass_idx))
+            {
+                file << *cpu_ms;
+            }
+            file << ',';
+            if (std::optional<float> gpu_ms = pass_value(frame.pass_gpu_ms, pass_idx))
+            {
+                file << *gpu_ms;
+            }
+        }
+        file << '\n';
+    }
+
+    return static_cast<bool>(file);
+}
+
+bool BenchmarkRecorder::write_json(const std::filesystem::path &path) const
+{
+    std::ofstream file(path);
+    if (!file)
+    {
+        spdlog::error("BenchmarkRecorder::write_json: failed to open `{}`", path.string());
+        return false;
+    }
+
+    auto collect = [&](auto &&get) {
+        std::vector<float> values;
+        values.reserve(m_frames.size());
+        for (const BenchmarkFrame &frame : m_frames)
+        {
+            values.emplace_back(get(frame));
+        }
+        return values;
+    };
+
+    // Only frames a pass was recorded in count towards its summary.
+    auto collect_pass = [&](size_t pass_idx, auto BenchmarkFrame::*member) {
+        std::vector<float> values;
+        for (const BenchmarkFrame &frame : m_frames)
+        {
+            if (std::optional<float> value = pass_value(frame.*member, pass_idx))
+            {
+                values.emplace_back(*value);
+            }
+        }
+        return values;
+    };
+
+    auto write_summary = [&](const MetricSummary &summary) {
+        file << "{\"count\": " << summary.count << ", \"mean\": " << summary.mean
+             << ", \"min\": " << summary.min << ", \"max\": " << summary.max
+             << ", \"p50\": " << summary.p50 << ", \"p95\": " << summary.p95
+             << ", \"p99\": " << summary.p99 << '}';
+    };
+
+    file << "{\n";
+    file << "  \"frame_count\": " << m_frames.size() << ",\n";
+
+    file << "  \"summary\": {\n";
+    file << "    \"frame_ms\": ";
+    write_summary(summarize(collect([](const BenchmarkFrame &f) { return f.frame_ms; })));
+    file << ",\n    \"cpu_ms\": ";
+    write_summary(summarize(collect([](const BenchmarkFrame &f) { return f.cpu_ms; })));
+    file << ",\n    \"cpu_wait_ms\": ";
+    write_summary(summarize(collect([](const BenchmarkFrame &f) { return f.cpu_wait_ms; })));
+    file << ",\n    \"gpu_wait_ms\": ";
+    write_summary(summarize(collect([](const BenchmarkFrame &f) { return f.gpu_wait_ms; })));
+    file << ",\n    \"gpu_ms\": ";
+    write_summary(summarize(collect([](const BenchmarkFrame &f) { return f.gpu_ms; })));
+    file << ",\n    \"local_memory_mb\": ";
+    write_summary(summarize(collect([](const BenchmarkFrame &f) { return f.local_memory_mb; })));
+    file << "\n  },\n";
+
+    auto to_mb = [](uint64_t bytes) { return static_cast<double>(bytes) / (1024.0 * 1024.0); };
+    file << "  \"memory\": {\n";
+    file << "    \"local_budget_mb\": " << to_mb(m_memory_stats.local_budget) << ",\n";
+    file << "    \"non_local_budget_mb\": " << to_mb(m_memory_stats.non_local_budget) << ",\n";
+    file << "    \"tracked_live_mb\": " << to_mb(m_memory_stats.total_live_bytes) << ",\n";
+    file << "    \"tracked_peak_mb\": " << to_mb(m_memory_stats.total_peak_bytes) << ",\n";
+    file << "    \"categories\": {";
+    for (size_t category = 0; category < m_memory_stats.categories.size(); ++category)
+    {
+        const Renderer::MemoryCategoryStats &stats = m_memory_stats.categories[category];
+        file << (category == 0 ? "\n" : ",\n");
+        file << "      \""
+             << Renderer::memory_category_name(static_cast<Renderer::MemoryCategory>(category))
+             << "\": {\"live_mb\": " << to_mb(stats.live_bytes)
+             << ", \"peak_mb\": " << to_mb(stats.peak_bytes)
+             << ", \"allocations\": " << stats.live_allocations << '}';
+    }
+    file << "\n    }\n";
+    file << "  },\n";
+
+    file << "  \"passes\": [";
+    for (size_t pass_idx = 0; pass_idx < m_pass_names.size(); ++pass_idx)
+    {
+        file << (pass_idx == 0 ? "\n" : ",\n");
+        file << "    {\"name\": \"" << json_escape(m_pass_names[pass_idx]) << "\", \"cpu_ms\": ";
+        write_summary(summarize(collect_pass(pass_idx, &BenchmarkFrame::pass_cpu_ms)));
+        file << ", \"gpu_ms\": ";
+        write_summary(summarize(collect_pass(pass_idx, &BenchmarkFrame::pass_gpu_ms)));
+        file << '}';
+    }
+    file << "\n  ],\n";
+
+    auto write_pass_values = [&](const std::vector<std::optional<float>> &values) {
+        for (size_t pass_idx = 0; pass_idx < values.size(); ++pass_idx)
+        {
+            file << (pass_idx == 0 ? "" : ", ");
+            if (values[pass_idx].has_value())
+            {
+                file << *values[pass_idx];
+            }
+            else
+            {
+                file << "null";
+            }
+        }
+    };
+
+    file << "  \"frames\": [";
+    for (size_t frame_idx = 0; frame_idx < m_frames.size(); ++frame_idx)
+    {
+        const BenchmarkFrame &frame = m_frames[frame_idx];
+        file << (frame_idx == 0 ? "\n" : ",\n");
+        file << "    {\"frame_ms\": " << frame.frame_ms << ", \"cpu_ms\": " << frame.cpu_ms
+             << ", \"cpu_wait_ms\": " << frame.cpu_wait_ms
+             << ", \"gpu_wait_ms\": " << frame.gpu_wait_ms << ", \"gpu_ms\": " << frame.gpu_ms
+             << ", \"local_memory_mb\": " << frame.local_memory_mb << ", \"pass_cpu_ms\": [";
+        write_pass_values(frame.pass_cpu_ms);
+        file << "], \"pass_gpu_ms\": [";
+        write_pass_values(frame.pass_gpu_ms);
+        file << "]}";
+    }
+    file << "\n  ]\n";
+    file << "}\n";
+
+    return static_cast<bool>(file);
+}
+
+} // namespace Arctic
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+
+#include "renderer/frame_stats.hpp"
+#include "simulation.hpp"
+
+namespace Arctic
+{
+
+struct CameraKeyframe
+{
+    float time;
+    glm::vec3 eye;
+    glm::vec2 rotation;
+};
+
+// A camera path stored as a text file with one keyframe per line in the form
+// `time eye_x eye_y eye_z pitch yaw`. Empty lines and lines starting with `#` are ignored.
+class CameraPath
+{
+    std::vector<CameraKeyframe> m_keyframes;
+
+  public:
+    CameraPath() = default;
+
+    [[nodiscard]] static bool load(const std::filesystem::path &path, CameraPath &out_path);
+
+    [[nodiscard]] bool save(const std::filesystem::path &path) const;
+
+    // Keyframes have to be added in order of increasing time.
+    void add_keyframe(const CameraKeyframe &keyframe)
+    {
+        m_keyframes.emplace_back(keyframe);
+    }
+
+    void clear()
+    {
+        m_keyframes.clear();
+    }
+
+    [[nodiscard]] bool empty() const
+    {
+        return m_keyframes.empty();
+    }
+
+    [[nodiscard]] size_t size() const
+    {
+        return m_keyframes.size();
+    }
+
+    // Linearly interpolates between the two keyframes around `time`. Times outside of the path
+    // are clamped to the first or last keyframe.
+    [[nodiscard]] CameraState sample(float time) const;
+};
+
+struct BenchmarkOptions
+{
+    std::filesystem::path camera_path;
+    // Results are written to this path with the extensions `.json` and `.csv`.
+    std::filesystem::path output_path{"benchmark"};
+    uint32_t num_frames{1000};
+    // Frames rendered before recording starts, to let caches, pipelines and the driver settle.
+    uint32_t warmup_frames{60};
+    // Time the camera path advances per frame. Using a fixed step instead of the measured frame
+    // time makes every run render the exact same sequence of views.
+    float time_step{1.0f / 60.0f};
+    // Shading path and number of point lights scattered over the scene in addition to its own,
+    // to compare both paths with many lights.
+    bool deferred_shading{false};
+    uint32_t point_lights{0};
+};
+
+struct BenchmarkFrame
+{
+    // Time between the start of this and the previous frame.
+    float frame_ms;
+    // Time spent on the CPU for the frame, excluding waiting for the swapchain or the GPU.
+    float cpu_ms;
+    float cpu_wait_ms;
+    float gpu_wait_ms;
+    // GPU time of the most recent frame whose timestamps were available, usually the previous one.
+    float gpu_ms;
+    // Video memory used by the process as reported by the OS.
+    float local_memory_mb;
+    // Indexed by pass, empty for passes that did not run in this frame or whose GPU time was not
+    // available yet, so they do not count as zero in the summaries.
+    std::vector<std::optional<float>> pass_cpu_ms;
+    std::vector<std::optional<float>> pass_gpu_ms;
+};
+
+class BenchmarkRecorder
+{
+    std::vector<std::string> m_pass_names;
+    std::vector<BenchmarkFrame> m_frames;
+    // Memory stats of the last recorded frame, which include the peak values of the whole run.
+    Renderer::MemoryStats m_memory_stats;
+
+  public:
+    BenchmarkRecorder() = default;
+
+    void record_frame(
+        float frame_ms, float cpu_ms, float gpu_ms, const Renderer::FramePacingStats &pacing_stats,
+        const Renderer::MemoryStats &memory_stats,
+        std::span<const Renderer::PassTiming> pass_timings
+    );
+
+    [[nodiscard]] size_t frame_count() const
+    {
+        return m_frames.size();
+    }
+
+    // Writes every recorded frame as CSV and a summary with percentiles of every metric plus the
+    // per-frame data as JSON.
+    [[nodiscard]] bool write_results(const std::filesystem::path &output_path) const;
+
+  private:
+    [[nodiscard]] bool write_csv(const std::filesystem::path &path) const;
+
+    [[nodiscard]] bool write_json(const std::filesystem::path &path) const;
+};
+
+} // namespace Arctic
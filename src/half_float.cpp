@@ -0,0 +1,229 @@
+#include "half_float.hpp"
+
+#include <array>
+#include <cmath>
+#include <cstring>
+
+#if defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define ARCTIC_HALF_FLOAT_SSE2
+#endif
+
+#if defined(_M_X64) || defined(__x86_64__)
+#include <immintrin.h>
+#define ARCTIC_HALF_FLOAT_F16C
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+// MSVC compiles F16C intrinsics without any flags, the CPU is checked at runtime instead.
+#define ARCTIC_TARGET_F16C
+#else
+#define ARCTIC_TARGET_F16C __attribute__((target("avx,f16c")))
+#endif
+#endif
+
+namespace Arctic
+{
+
+// Bit patterns of floats marking where the half float ranges start.
+static constexpr uint32_t F32_INFINITY = 255u << 23;
+static constexpr uint32_t F16_OVERFLOW = (127u + 16u) << 23;
+static constexpr uint32_t F16_MIN_NORMAL = (127u - 14u) << 23;
+// Adding this float to a value smaller than the smallest normal half float shifts its mantissa
+// into the position of a subnormal half float, rounding it in the process.
+static constexpr uint32_t F16_SUBNORMAL_MAGIC = ((127u - 15u) + (23u - 10u) + 1u) << 23;
+// Rebiases the exponent of normal values and rounds the dropped mantissa bits down at one half.
+static constexpr uint32_t F16_NORMAL_BIAS = 0xfffu - ((127u - 15u) << 23);
+
+static uint32_t float_bits(float value)
+{
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+static float bits_float(uint32_t bits)
+{
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+uint16_t float_to_half(float value)
+{
+    uint32_t bits = float_bits(value);
+    uint32_t sign = bits & 0x80000000u;
+    bits ^= sign;
+
+    uint32_t half;
+    if (bits >= F16_OVERFLOW)
+    {
+        half = bits > F32_INFINITY ? 0x7e00u : 0x7c00u;
+    }
+    else if (bits < F16_MIN_NORMAL)
+    {
+        float shifted = bits_float(bits) + bits_float(F16_SUBNORMAL_MAGIC);
+        half = float_bits(shifted) - F16_SUBNORMAL_MAGIC;
+    }
+    else
+    {
+        // Ties are rounded up only if the mantissa is odd.
+        uint32_t mantissa_odd = (bits >> 13) & 1u;
+        half = (bits + F16_NORMAL_BIAS + mantissa_odd) >> 13;
+    }
+
+    return static_cast<uint16_t>(half | (sign >> 16));
+}
+
+float half_to_float(uint16_t value)
+{
+    uint32_t sign = static_cast<uint32_t>(value & 0x8000u) << 16;
+    uint32_t exponent = (value >> 10) & 0x1fu;
+    uint32_t mantissa = value & 0x3ffu;
+
+    if (exponent == 0)
+    {
+        float magnitude = std::ldexp(static_cast<float>(mantissa), -24);
+        return bits_float(float_bits(magnitude) | sign);
+    }
+    if (exponent == 31)
+    {
+        return bits_float(sign | F32_INFINITY | (mantissa << 13));
+    }
+    return bits_float(sign | ((exponent + 127u - 15u) << 23) | (mantissa << 13));
+}
+
+#ifdef ARCTIC_HALF_FLOAT_SSE2
+
+// Same steps as `float_to_half` for four values at once, with the halves in the low 16 bits of
+// each lane and the sign extended into the high bits.
+static __m128i float_to_half_sse2(__m128 value)
+{
+    __m128 sign = _mm_and_ps(value, _mm_set1_ps(-0.0f));
+    __m128 abs = _mm_xor_ps(value, sign);
+    __m128i abs_bits = _mm_castps_si128(abs);
+
+    __m128i is_nan = _mm_castps_si128(_mm_cmpunord_ps(abs, abs));
+    __m128i overflow = _mm_set1_epi32(static_cast<int>(F16_OVERFLOW));
+    __m128i min_normal = _mm_set1_epi32(static_cast<int>(F16_MIN_NORMAL));
+    __m128i subnormal_magic = _mm_set1_epi32(static_cast<int>(F16_SUBNORMAL_MAGIC));
+    __m128i normal_bias = _mm_set1_epi32(static_cast<int>(F16_NORMAL_BIAS));
+
+    __m128i inf_or_nan = _mm_or_si128(
+        _mm_and_si128(is_nan, _mm_set1_epi32(0x200)), _mm_set1_epi32(0x7c00)
+    );
+    __m128i is_finite = _mm_cmpgt_epi32(overflow, abs_bits);
+    __m128i is_subnormal = _mm_cmpgt_epi32(min_normal, abs_bits);
+
+    __m128i subnormal = _mm_sub_epi32(
+        _mm_castps_si128(_mm_add_ps(abs, _mm_castsi128_ps(subnormal_magic))), subnormal_magic
+    );
+
+    // All ones for odd mantissas, which subtracts one where `float_to_half` adds one.
+    __m128i mantissa_odd = _mm_srai_epi32(_mm_slli_epi32(abs_bits, 31 - 13), 31);
+    __m128i normal = _mm_srli_epi32(
+        _mm_sub_epi32(_mm_add_epi32(abs_bits, normal_bias), mantissa_odd), 13
+    );
+
+    __m128i finite = _mm_or_si128(
+        _mm_and_si128(is_subnormal, subnormal), _mm_andnot_si128(is_subnormal, normal)
+    );
+    __m128i half =
+        _mm_or_si128(_mm_and_si128(is_finite, finite), _mm_andnot_si128(is_finite, inf_or_nan));
+    return _mm_or_si128(half, _mm_srai_epi32(_mm_castps_si128(sign), 16));
+}
+
+#endif
+
+#ifdef ARCTIC_HALF_FLOAT_F16C
+
+// Converts the first multiple of 16 elements and returns how many that were. The hardware keeps
+// the payload of NaNs, which `float_to_half` does not, so those are replaced afterwards.
+ARCTIC_TARGET_F16C static size_t
+floats_to_halves_f16c(std::span<const float> values, std::span<uint16_t> out_halves)
+{
+    __m128i abs_mask = _mm_set1_epi16(0x7fff);
+    __m128i infinity = _mm_set1_epi16(0x7c00);
+    __m128i quiet_nan = _mm_set1_epi16(0x7e00);
+
+    size_t i = 0;
+    for (; i + 16 <= values.size(); i += 16)
+    {
+        for (size_t j = i; j < i + 16; j += 8)
+        {
+            __m128i half =
+                _mm256_cvtps_ph(_mm256_loadu_ps(values.data() + j), _MM_FROUND_TO_NEAREST_INT);
+            __m128i abs = _mm_and_si128(half, abs_mask);
+            __m128i is_nan = _mm_cmpgt_epi16(abs, infinity);
+            __m128i nan = _mm_or_si128(_mm_andnot_si128(abs_mask, half), quiet_nan);
+            half = _mm_or_si128(_mm_andnot_si128(is_nan, half), _mm_and_si128(is_nan, nan));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(out_halves.data() + j), half);
+        }
+    }
+    return i;
+}
+
+#endif
+
+HalfConversion best_half_conversion()
+{
+    static const HalfConversion best = [] {
+#if defined(ARCTIC_HALF_FLOAT_F16C) && defined(_MSC_VER) && !defined(__clang__)
+        std::array<int, 4> info;
+        __cpuid(info.data(), 1);
+        // The OS has to save the AVX registers as well.
+        bool avx = (info[2] & (1 << 27)) != 0 && (info[2] & (1 << 28)) != 0;
+        bool f16c = (info[2] & (1 << 29)) != 0;
+        if (avx && f16c && (_xgetbv(0) & 0x6) == 0x6)
+        {
+            return HalfConversion::F16c;
+        }
+#elif defined(ARCTIC_HALF_FLOAT_F16C)
+        if (__builtin_cpu_supports("avx") && __builtin_cpu_supports("f16c"))
+        {
+            return HalfConversion::F16c;
+        }
+#endif
+#ifdef ARCTIC_HALF_FLOAT_SSE2
+        return HalfConversion::Sse2;
+#else
+        return HalfConversion::Scalar;
+#endif
+    }();
+    return best;
+}
+
+void floats_to_halves(
+    std::span<const float> values, std::span<uint16_t> out_halves, HalfConversion conversion
+)
+{
+    if (conversion == HalfConversion::F16c && best_half_conversion() != HalfConversion::F16c)
+    {
+        conversion = HalfConversion::Sse2;
+    }
+
+    size_t i = 0;
+#ifdef ARCTIC_HALF_FLOAT_F16C
+    if (conversion == HalfConversion::F16c)
+    {
+        i = floats_to_halves_f16c(values, out_halves);
+    }
+#endif
+#ifdef ARCTIC_HALF_FLOAT_SSE2
+    for (; conversion != HalfConversion::Scalar && i + 8 <= values.size(); i += 8)
+    {
+        __m128i lo = float_to_half_sse2(_mm_loadu_ps(values.data() + i));
+        __m128i hi = float_to_half_sse2(_mm_loadu_ps(values.data() + i + 4));
+        // Every lane is a sign extended 16 bit value, so packing with signed saturation keeps
+        // the bits intact.
+        _mm_storeu_si128(
+            reinterpret_cast<__m128i *>(out_halves.data() + i), _mm_packs_epi32(lo, hi)
+        );
+    }
+#endif
+    for (; i < values.size(); ++i)
+    {
+        out_halves[i] = float_to_half(values[i]);
+    }
+}
+
+} // namespace Arctic
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+
+namespace Arctic
+{
+
+// Converts to an IEEE 754 half float, rounding to the nearest value with ties to even. Values
+// too large for a half float become infinity and NaNs stay NaNs.
+[[nodiscard]] uint16_t float_to_half(float value);
+
+[[nodiscard]] float half_to_float(uint16_t value);
+
+// Instruction sets `floats_to_halves` can convert with. All of them produce identical results.
+enum class HalfConversion : uint8_t
+{
+    Scalar,
+    Sse2,
+    // AVX with the F16C extension, which converts eight floats in one instruction.
+    F16c,
+};
+
+// Fastest conversion the CPU supports. F16C is detected at runtime, once.
+[[nodiscard]] HalfConversion best_half_conversion();
+
+// Converts every element of `values` like `float_to_half`, with `conversion` if the CPU supports
+// it and the next slower one otherwise. `out_halves` has to be at least as large as `values`.
+void floats_to_halves(
+    std::span<const float> values, std::span<uint16_t> out_halves,
+    HalfConversion conversion = best_half_conversion()
+);
+
+} // namespace Arctic
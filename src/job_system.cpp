@@ -0,0 +1,101 @@
+#include "job_system.hpp"
+
+#include <algorithm>
+
+namespace Arctic
+{
+
+JobSystem::JobSystem(uint32_t num_threads)
+{
+    if (num_threads == 0)
+    {
+        num_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    for (uint32_t i = 1; i < num_threads; ++i)
+    {
+        m_workers.emplace_back([this] { worker_loop(); });
+    }
+}
+
+JobSystem::~JobSystem()
+{
+    {
+        std::lock_guard lock(m_mutex);
+        m_stop = true;
+    }
+    m_work_available.notify_all();
+
+    for (std::thread &worker : m_workers)
+    {
+        worker.join();
+    }
+}
+
+void JobSystem::parallel_for(size_t count, const std::function<void(size_t)> &job)
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    {
+        std::lock_guard lock(m_mutex);
+        m_job = &job;
+        m_job_count = count;
+        m_next_idx = 0;
+        m_generation += 1;
+    }
+    m_work_available.notify_all();
+
+    run_indices(job, count);
+
+    // Once all indices are handed out no further workers may join, the ones still running
+    // have to finish before `job` goes out of scope.
+    std::unique_lock lock(m_mutex);
+    m_job = nullptr;
+    m_work_done.wait(lock, [this] { return m_busy_workers == 0; });
+}
+
+void JobSystem::worker_loop()
+{
+    uint64_t seen_generation = 0;
+    while (true)
+    {
+        const std::function<void(size_t)> *job;
+        size_t count;
+        {
+            std::unique_lock lock(m_mutex);
+            m_work_available.wait(lock, [&] {
+                return m_stop || (m_job != nullptr && m_generation != seen_generation);
+            });
+            if (m_stop)
+            {
+                return;
+            }
+
+            seen_generation = m_generation;
+            job = m_job;
+            count = m_job_count;
+            m_busy_workers += 1;
+        }
+
+        run_indices(*job, count);
+
+        {
+            std::lock_guard lock(m_mutex);
+            m_busy_workers -= 1;
+        }
+        m_work_done.notify_one();
+    }
+}
+
+void JobSystem::run_indices(const std::function<void(size_t)> &job, size_t count)
+{
+    for (size_t idx = m_next_idx.fetch_add(1); idx < count; idx = m_next_idx.fetch_add(1))
+    {
+        job(idx);
+    }
+}
+
+} // namespace Arctic
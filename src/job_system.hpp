@@ -0,0 +1,59 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Arctic
+{
+
+// A fixed pool of worker threads that runs data parallel loops.
+class JobSystem
+{
+    std::vector<std::thread> m_workers;
+
+    std::mutex m_mutex;
+    std::condition_variable m_work_available;
+    std::condition_variable m_work_done;
+
+    // The loop currently being run. Workers only join while `m_job` is set, which happens for
+    // the duration of one `parallel_for` call.
+    const std::function<void(size_t)> *m_job{nullptr};
+    size_t m_job_count{0};
+    std::atomic<size_t> m_next_idx{0};
+    uint64_t m_generation{0};
+    uint32_t m_busy_workers{0};
+    bool m_stop{false};
+
+    JobSystem(const JobSystem &) = delete;
+    JobSystem &operator=(const JobSystem &) = delete;
+    JobSystem(JobSystem &&) = delete;
+    JobSystem &operator=(JobSystem &&) = delete;
+
+  public:
+    // Spawns `num_threads - 1` workers, the thread calling `parallel_for` is the remaining one.
+    // Uses one thread per hardware thread if `num_threads` is 0.
+    explicit JobSystem(uint32_t num_threads = 0);
+
+    ~JobSystem();
+
+    [[nodiscard]] uint32_t thread_count() const
+    {
+        return static_cast<uint32_t>(m_workers.size()) + 1;
+    }
+
+    // Calls `job` once for every index in `[0, count)` and returns when all calls are done.
+    // Indices are handed out one at a time, so a call should do a reasonable amount of work.
+    void parallel_for(size_t count, const std::function<void(size_t)> &job);
+
+  private:
+    void worker_loop();
+
+    void run_indices(const std::function<void(size_t)> &job, size_t count);
+};
+
+} // namespace Arctic
@@ -1,3 +1,7 @@
+#include <charconv>
+#include <optional>
+#include <string_view>
+
 #include <SDL3/SDL_init.h>
 #include <SDL3/SDL_video.h>
 
@@ -5,6 +9,88 @@
 
 #include "app.hpp"
 
+static constexpr const char *USAGE =
+    "usage: arctic <scene> [--benchmark <camera path> [--frames <n>] [--warmup <n>] "
+    "[--output <path>] [--shading <forward|deferred>] [--lights <n>]]";
+
+static bool parse_uint(std::string_view str, uint32_t &out)
+{
+    auto [ptr, ec] = std::from_chars(str.data(), str.data() + str.size(), out);
+    return ec == std::errc() && ptr == str.data() + str.size();
+}
+
+static bool parse_benchmark_options(
+    int argc, char **argv, std::optional<Arctic::BenchmarkOptions> &out_options
+)
+{
+    Arctic::BenchmarkOptions options;
+    bool benchmark = false;
+    for (int i = 2; i < argc; ++i)
+    {
+        std::string_view arg = argv[i];
+        if (i + 1 >= argc)
+        {
+            spdlog::error("main: missing value for `{}`", arg);
+            return false;
+        }
+        std::string_view value = argv[++i];
+
+        if (arg == "--benchmark")
+        {
+            benchmark = true;
+            options.camera_path = value;
+        }
+        else if (arg == "--frames")
+        {
+            if (!parse_uint(value, options.num_frames) || options.num_frames == 0)
+            {
+                spdlog::error("main: invalid frame count `{}`", value);
+                return false;
+            }
+        }
+        else if (arg == "--warmup")
+        {
+            if (!parse_uint(value, options.warmup_frames))
+            {
+                spdlog::error("main: invalid warmup frame count `{}`", value);
+                return false;
+            }
+        }
+        else if (arg == "--output")
+        {
+            options.output_path = value;
+        }
+        else if (arg == "--shading")
+        {
+            if (value != "forward" && value != "deferred")
+            {
+                spdlog::error("main: invalid shading path `{}`", value);
+                return false;
+            }
+            options.deferred_shading = value == "deferred";
+        }
+        else if (arg == "--lights")
+        {
+            if (!parse_uint(value, options.point_lights))
+            {
+                spdlog::error("main: invalid point light count `{}`", value);
+                return false;
+            }
+        }
+        else
+        {
+            spdlog::error("main: unknown argument `{}`", arg);
+            return false;
+        }
+    }
+
+    if (benchmark)
+    {
+        out_options = std::move(options);
+    }
+    return true;
+}
+
 int main(int argc, char **argv)
 {
     spdlog::set_level(spdlog::level::trace);
@@ -15,10 +101,11 @@ int main(int argc, char **argv)
     spdlog::debug("main: tracy disabled");
 #endif
 
-    if (argc != 2)
+    std::optional<Arctic::BenchmarkOptions> benchmark_options;
+    if (argc < 2 || !parse_benchmark_options(argc, argv, benchmark_options))
     {
-        spdlog::error("main: usage: arctic <scene>");
-        return false;
+        spdlog::error("main: {}", USAGE);
+        return 1;
     }
 
     SDL_SetAppMetadata("Arctic", "0.1", nullptr);
@@ -42,7 +129,7 @@ int main(int argc, char **argv)
 
     try
     {
-        Arctic::App app(window, argv[1]);
+        Arctic::App app(window, argv[1], std::move(benchmark_options));
         if (app.init())
         {
             spdlog::trace("main: initialized app");
@@ -0,0 +1,158 @@
+#include "mapped_file.hpp"
+
+#include <spdlog/spdlog.h>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Arctic
+{
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+#ifdef _WIN32
+
+bool MappedFile::open(const std::filesystem::path &path)
+{
+    close();
+
+    HANDLE file = CreateFileW(
+        path.c_str(),
+        GENERIC_READ,
+        FILE_SHARE_READ,
+        nullptr,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+        nullptr
+    );
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        spdlog::error("MappedFile::open: failed to open `{}`", path.string());
+        return false;
+    }
+    m_file = file;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size))
+    {
+        spdlog::error("MappedFile::open: failed to get size of `{}`", path.string());
+        close();
+        return false;
+    }
+    m_size = static_cast<size_t>(size.QuadPart);
+    if (m_size == 0)
+    {
+        return true;
+    }
+
+    m_mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!m_mapping)
+    {
+        spdlog::error("MappedFile::open: failed to create mapping of `{}`", path.string());
+        close();
+        return false;
+    }
+
+    m_data = static_cast<const uint8_t *>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+    if (!m_data)
+    {
+        spdlog::error("MappedFile::open: failed to map `{}`", path.string());
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (m_data)
+    {
+        UnmapViewOfFile(m_data);
+    }
+    if (m_mapping)
+    {
+        CloseHandle(m_mapping);
+    }
+    if (m_file)
+    {
+        CloseHandle(m_file);
+    }
+    m_data = nullptr;
+    m_mapping = nullptr;
+    m_file = nullptr;
+    m_size = 0;
+}
+
+#else
+
+bool MappedFile::open(const std::filesystem::path &path)
+{
+    close();
+
+    m_fd = ::open(path.c_str(), O_RDONLY);
+    if (m_fd < 0)
+    {
+        spdlog::error("MappedFile::open: failed to open `{}`", path.string());
+        return false;
+    }
+
+    struct stat file_stat;
+    if (fstat(m_fd, &file_stat) != 0)
+    {
+        spdlog::error("MappedFile::open: failed to get size of `{}`", path.string());
+        close();
+        return false;
+    }
+    m_size = static_cast<size_t>(file_stat.st_size);
+    if (m_size == 0)
+    {
+        return true;
+    }
+
+    void *data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, m_fd, 0);
+    if (data == MAP_FAILED)
+    {
+        spdlog::error("MappedFile::open: failed to map `{}`", path.string());
+        close();
+        return false;
+    }
+    m_data = static_cast<const uint8_t *>(data);
+    madvise(data, m_size, MADV_SEQUENTIAL);
+
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (m_data)
+    {
+        munmap(const_cast<uint8_t *>(m_data), m_size);
+    }
+    if (m_fd >= 0)
+    {
+        ::close(m_fd);
+    }
+    m_data = nullptr;
+    m_fd = -1;
+    m_size = 0;
+}
+
+#endif
+
+} // namespace Arctic
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+
+namespace Arctic
+{
+
+// A read-only memory mapping of a whole file. Pages are only read from disk when they are
+// touched, so data can be copied straight from the file into its destination.
+class MappedFile
+{
+    const uint8_t *m_data{nullptr};
+    size_t m_size{0};
+#ifdef _WIN32
+    void *m_file{nullptr};
+    void *m_mapping{nullptr};
+#else
+    int m_fd{-1};
+#endif
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+    MappedFile(MappedFile &&) = delete;
+    MappedFile &operator=(MappedFile &&) = delete;
+
+  public:
+    MappedFile() = default;
+
+    ~MappedFile();
+
+    [[nodiscard]] bool open(const std::filesystem::path &path);
+
+    void close();
+
+    [[nodiscard]] std::span<const uint8_t> bytes() const
+    {
+        return {m_data, m_size};
+    }
+
+    [[nodiscard]] size_t size() const
+    {
+        return m_size;
+    }
+};
+
+} // namespace Arctic
@@ -0,0 +1,104 @@
+#include "auto_exposure.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace Arctic::Renderer
+{
+
+static float luminance(const float *pixel)
+{
+    return 0.2126f * pixel[0] + 0.7152f * pixel[1] + 0.0722f * pixel[2];
+}
+
+uint32_t luminance_bin(float luminance, const AutoExposureParams &params)
+{
+    // Also catches zero, negative and NaN luminance.
+    if (!(luminance >= std::exp2(params.min_log_luminance)))
+    {
+        return 0;
+    }
+    float range = params.max_log_luminance - params.min_log_luminance;
+    float t = std::clamp((std::log2(luminance) - params.min_log_luminance) / range, 0.0f, 1.0f);
+    auto bin = static_cast<uint32_t>(t * static_cast<float>(AUTO_EXPOSURE_BINS - 2));
+    return 1 + std::min(bin, AUTO_EXPOSURE_BINS - 2);
+}
+
+float bin_log_luminance(uint32_t bin, const AutoExposureParams &params)
+{
+    float range = params.max_log_luminance - params.min_log_luminance;
+    float t = (static_cast<float>(bin - 1) + 0.5f) / static_cast<float>(AUTO_EXPOSURE_BINS - 2);
+    return params.min_log_luminance + t * range;
+}
+
+void build_luminance_histogram(
+    std::span<const float> pixels, uint32_t width, uint32_t height,
+    const AutoExposureParams &params, LuminanceHistogram &out_histogram
+)
+{
+    out_histogram.fill(0);
+    for (uint32_t y = 0; y < height; y += AUTO_EXPOSURE_BLOCK_SIZE)
+    {
+        for (uint32_t x = 0; x < width; x += AUTO_EXPOSURE_BLOCK_SIZE)
+        {
+            float sum = 0.0f;
+            for (uint32_t dy = 0; dy < AUTO_EXPOSURE_BLOCK_SIZE; ++dy)
+            {
+                for (uint32_t dx = 0; dx < AUTO_EXPOSURE_BLOCK_SIZE; ++dx)
+                {
+                    size_t px = std::min(x + dx, width - 1);
+                    size_t py = std::min(y + dy, height - 1);
+                    sum += luminance(pixels.data() + 4 * (py * width + px));
+                }
+            }
+            float average = sum / static_cast<float>(AUTO_EXPOSURE_BLOCK_SIZE *
+                                                     AUTO_EXPOSURE_BLOCK_SIZE);
+            out_histogram[luminance_bin(average, params)] += 1;
+        }
+    }
+}
+
+std::optional<float>
+histogram_log_luminance(const LuminanceHistogram &histogram, const AutoExposureParams &params)
+{
+    float total = 0.0f;
+    for (uint32_t bin = 1; bin < AUTO_EXPOSURE_BINS; ++bin)
+    {
+        total += static_cast<float>(histogram[bin]);
+    }
+    float low = total * params.low_percentile;
+    float high = total * params.high_percentile;
+
+    // Only the part of every bin between the two percentiles counts.
+    float begin = 0.0f;
+    float weighted_sum = 0.0f;
+    float weight = 0.0f;
+    for (uint32_t bin = 1; bin < AUTO_EXPOSURE_BINS; ++bin)
+    {
+        float end = begin + static_cast<float>(histogram[bin]);
+        float count = std::clamp(end, low, high) - std::clamp(begin, low, high);
+        weighted_sum += count * bin_log_luminance(bin, params);
+        weight += count;
+        begin = end;
+    }
+    if (weight <= 0.0f)
+    {
+        return std::nullopt;
+    }
+    return weighted_sum / weight;
+}
+
+float adapt_log_luminance(
+    float adapted, float measured, float delta_time, const AutoExposureParams &params
+)
+{
+    float speed = measured > adapted ? params.brightening_speed : params.darkening_speed;
+    return adapted + (measured - adapted) * (1.0f - std::exp(-delta_time * speed));
+}
+
+float exposure_from_log_luminance(float log_luminance, float compensation)
+{
+    return AUTO_EXPOSURE_MIDDLE_GREY * std::exp2(compensation - log_luminance);
+}
+
+} // namespace Arctic::Renderer
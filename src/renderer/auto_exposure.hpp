@@ -0,0 +1,68 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <span>
+
+namespace Arctic::Renderer
+{
+
+// Have to match `AUTO_EXPOSURE_BINS` and `AUTO_EXPOSURE_GROUP_SIZE` in `auto_exposure.hlsl`.
+static constexpr uint32_t AUTO_EXPOSURE_BINS = 256;
+static constexpr uint32_t AUTO_EXPOSURE_GROUP_SIZE = 16;
+// Pixels are measured in blocks of this many pixels squared, see `build_luminance_histogram`.
+static constexpr uint32_t AUTO_EXPOSURE_BLOCK_SIZE = 2;
+// Luminance the average of the image is exposed to.
+static constexpr float AUTO_EXPOSURE_MIDDLE_GREY = 0.18f;
+
+using LuminanceHistogram = std::array<uint32_t, AUTO_EXPOSURE_BINS>;
+
+// Everything the measurement and the adaptation depend on, shared by the compute shaders and the
+// reference implementation below.
+struct AutoExposureParams
+{
+    // Range of log2 luminance spread over the histogram. Darker pixels land in the first bin and
+    // are ignored, brighter ones are clamped into the last bin.
+    float min_log_luminance{-10.0f};
+    float max_log_luminance{6.0f};
+    // Fractions of the measured pixels below and above which the histogram is ignored, so small
+    // highlights and deep shadows do not pull the exposure around.
+    float low_percentile{0.5f};
+    float high_percentile{0.95f};
+    // Rates at which the adapted luminance approaches the measured one, per second, when the
+    // image gets brighter and darker. Eyes adapt to light faster than to darkness.
+    float brightening_speed{3.0f};
+    float darkening_speed{1.0f};
+};
+
+// Bin of a luminance: zero for pixels darker than `min_log_luminance`, otherwise one of the
+// others spread evenly over the range of log2 luminance.
+[[nodiscard]] uint32_t luminance_bin(float luminance, const AutoExposureParams &params);
+
+// Log2 luminance at the center of `bin`, which must not be zero.
+[[nodiscard]] float bin_log_luminance(uint32_t bin, const AutoExposureParams &params);
+
+// Counts the luminance of every block of `AUTO_EXPOSURE_BLOCK_SIZE` squared pixels of an RGBA
+// float image, averaged over the pixels of the block and clamped to the edge of the image. This
+// is what the histogram pass does on the GPU.
+void build_luminance_histogram(
+    std::span<const float> pixels, uint32_t width, uint32_t height,
+    const AutoExposureParams &params, LuminanceHistogram &out_histogram
+);
+
+// Average log2 luminance of the pixels between the percentiles, with every bin at its center.
+// Has no value if no pixel is bright enough to be measured.
+[[nodiscard]] std::optional<float>
+histogram_log_luminance(const LuminanceHistogram &histogram, const AutoExposureParams &params);
+
+// Moves the adapted log2 luminance towards the measured one, exponentially over time.
+[[nodiscard]] float adapt_log_luminance(
+    float adapted, float measured, float delta_time, const AutoExposureParams &params
+);
+
+// Scale applied to the image before tone mapping to bring the adapted luminance to middle grey,
+// shifted by `compensation` stops.
+[[nodiscard]] float exposure_from_log_luminance(float log_luminance, float compensation);
+
+} // namespace Arctic::Renderer
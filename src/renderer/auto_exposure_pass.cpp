@@ -0,0 +1,196 @@
+#include "auto_exposure_pass.hpp"
+
+#include <array>
+#include <cmath>
+#include <vector>
+
+#include <directx/d3dx12.h>
+
+#include <spdlog/spdlog.h>
+
+#include "tracy/Tracy.hpp"
+#include "tracy/TracyD3D12.hpp"
+
+#include "dxerr.hpp"
+
+#define CONSTANTS_SIZE(ty) ((sizeof(ty) + 3) / 4)
+
+namespace Arctic::Renderer
+{
+
+// The adapt shader clears the histogram with one thread per bin, the histogram shader with one
+// thread of a group per bin.
+static_assert(AUTO_EXPOSURE_GROUP_SIZE * AUTO_EXPOSURE_GROUP_SIZE == AUTO_EXPOSURE_BINS);
+
+bool AutoExposurePass::init()
+{
+    std::vector<uint8_t> histogram_code, adapt_code;
+    if (!m_rhi->compiler().compile_shader(
+            L"./shaders/auto_exposure.hlsl",
+            L"cs_histogram",
+            L"cs_6_6",
+            histogram_code
+        ))
+    {
+        spdlog::error("AutoExposurePass::init: failed to compile histogram shader");
+        return false;
+    }
+    if (!m_rhi->compiler()
+             .compile_shader(L"./shaders/auto_exposure.hlsl", L"cs_adapt", L"cs_6_6", adapt_code))
+    {
+        spdlog::error("AutoExposurePass::init: failed to compile adapt shader");
+        return false;
+    }
+
+    ComPtr<ID3DBlob> root_signature;
+
+    // Both shaders share the root signature, the buffers are bound as root descriptors.
+    std::array<CD3DX12_ROOT_PARAMETER, 3> root_parameters{};
+    root_parameters[0].InitAsConstants(CONSTANTS_SIZE(Constants), 0);
+    root_parameters[1].InitAsUnorderedAccessView(0);
+    root_parameters[2].InitAsUnorderedAccessView(1);
+
+    CD3DX12_ROOT_SIGNATURE_DESC root_signature_desc;
+    root_signature_desc.Init(
+        static_cast<UINT>(root_parameters.size()),
+        root_parameters.data(),
+        0,
+        nullptr,
+        D3D12_ROOT_SIGNATURE_FLAG_CBV_SRV_UAV_HEAP_DIRECTLY_INDEXED
+    );
+    DXERR(
+        D3D12SerializeRootSignature(
+            &root_signature_desc,
+            D3D_ROOT_SIGNATURE_VERSION_1,
+            &root_signature,
+            nullptr
+        ),
+        "AutoExposurePass::init: failed to serialize root signature"
+    );
+    DXERR(
+        m_rhi->device()->CreateRootSignature(
+            0,
+            root_signature->GetBufferPointer(),
+            root_signature->GetBufferSize(),
+            IID_PPV_ARGS(&m_root_signature)
+        ),
+        "AutoExposurePass::init: failed to create root signature"
+    );
+
+    D3D12_COMPUTE_PIPELINE_STATE_DESC pipeline_desc{};
+    pipeline_desc.pRootSignature = m_root_signature.Get();
+    pipeline_desc.CS = CD3DX12_SHADER_BYTECODE(histogram_code.data(), histogram_code.size());
+    DXERR(
+        m_rhi->device()->CreateComputePipelineState(
+            &pipeline_desc,
+            IID_PPV_ARGS(&m_histogram_pipeline)
+        ),
+        "AutoExposurePass::init: failed to create histogram pipeline state"
+    );
+    pipeline_desc.CS = CD3DX12_SHADER_BYTECODE(adapt_code.data(), adapt_code.size());
+    DXERR(
+        m_rhi->device()->CreateComputePipelineState(
+            &pipeline_desc,
+            IID_PPV_ARGS(&m_adapt_pipeline)
+        ),
+        "AutoExposurePass::init: failed to create adapt pipeline state"
+    );
+    spdlog::trace("AutoExposurePass::init: created pipeline states");
+
+    LuminanceHistogram zero_histogram{};
+    if (!m_rhi->create_buffer(
+            sizeof(LuminanceHistogram),
+            D3D12_RESOURCE_STATE_UNORDERED_ACCESS,
+            D3D12_HEAP_TYPE_DEFAULT,
+            MemoryCategory::Constants,
+            m_histogram,
+            D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS
+        ) ||
+        !m_rhi->upload_to_buffer(
+            m_histogram.Get(),
+            D3D12_RESOURCE_STATE_UNORDERED_ACCESS,
+            zero_histogram.data(),
+            sizeof(LuminanceHistogram)
+        ))
+    {
+        spdlog::error("AutoExposurePass::init: failed to create histogram buffer");
+        return false;
+    }
+    m_histogram->SetName(L"luminance histogram");
+
+    // Starts out at middle grey, which is an exposure of one.
+    Exposure initial_exposure{
+        .adapted_log_luminance = std::log2(AUTO_EXPOSURE_MIDDLE_GREY),
+        .exposure = 1.0f,
+    };
+    if (!m_rhi->create_buffer(
+            sizeof(Exposure),
+            D3D12_RESOURCE_STATE_UNORDERED_ACCESS,
+            D3D12_HEAP_TYPE_DEFAULT,
+            MemoryCategory::Constants,
+            m_exposure,
+            D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS
+        ) ||
+        !m_rhi->upload_to_buffer(
+            m_exposure.Get(),
+            D3D12_RESOURCE_STATE_UNORDERED_ACCESS,
+            &initial_exposure,
+            sizeof(Exposure)
+        ))
+    {
+        spdlog::error("AutoExposurePass::init: failed to create exposure buffer");
+        return false;
+    }
+    m_exposure->SetName(L"exposure");
+
+    return true;
+}
+
+void AutoExposurePass::run(ID3D12GraphicsCommandList *cmd_list, const RunData &run_data)
+{
+    ZoneScoped;
+    TracyD3D12Zone(m_rhi->tracy_ctx(), cmd_list, "Auto Exposure Pass");
+
+    Clock::time_point now = Clock::now();
+    float delta_time =
+        m_reset ? 0.0f : std::chrono::duration<float>(now - m_last_run).count();
+    m_last_run = now;
+
+    Constants constants{
+        .input_idx = run_data.color_target_srv_idx,
+        .input_width = run_data.viewport_width,
+        .input_height = run_data.viewport_height,
+        .min_log_luminance = m_params.min_log_luminance,
+        .max_log_luminance = m_params.max_log_luminance,
+        .low_percentile = m_params.low_percentile,
+        .high_percentile = m_params.high_percentile,
+        .brightening_speed = m_params.brightening_speed,
+        .darkening_speed = m_params.darkening_speed,
+        .delta_time = delta_time,
+        .compensation = run_data.compensation,
+        .reset = m_reset,
+    };
+    m_reset = false;
+
+    cmd_list->SetComputeRootSignature(m_root_signature.Get());
+    cmd_list->SetComputeRoot32BitConstants(0, CONSTANTS_SIZE(Constants), &constants, 0);
+    cmd_list->SetComputeRootUnorderedAccessView(1, m_histogram->GetGPUVirtualAddress());
+    cmd_list->SetComputeRootUnorderedAccessView(2, m_exposure->GetGPUVirtualAddress());
+
+    static constexpr uint32_t GROUP_PIXELS = AUTO_EXPOSURE_GROUP_SIZE * AUTO_EXPOSURE_BLOCK_SIZE;
+    cmd_list->SetPipelineState(m_histogram_pipeline.Get());
+    cmd_list->Dispatch(
+        (run_data.viewport_width + GROUP_PIXELS - 1) / GROUP_PIXELS,
+        (run_data.viewport_height + GROUP_PIXELS - 1) / GROUP_PIXELS,
+        1
+    );
+
+    // The exposure buffer is synchronized by the render graph.
+    CD3DX12_RESOURCE_BARRIER barrier = CD3DX12_RESOURCE_BARRIER::UAV(m_histogram.Get());
+    cmd_list->ResourceBarrier(1, &barrier);
+
+    cmd_list->SetPipelineState(m_adapt_pipeline.Get());
+    cmd_list->Dispatch(1, 1, 1);
+}
+
+} // namespace Arctic::Renderer
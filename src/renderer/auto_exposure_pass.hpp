@@ -0,0 +1,99 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+#include <d3d12.h>
+
+#include "auto_exposure.hpp"
+#include "comptr.hpp"
+#include "rhi.hpp"
+
+namespace Arctic::Renderer
+{
+
+// Measures the luminance of the color target in a histogram and adapts the exposure of the
+// tone mapping towards it over time. Both happen on the GPU, the exposure never leaves it:
+// `PostProcessPass` reads it straight from `exposure()`. See `auto_exposure.hpp` for the math.
+class AutoExposurePass
+{
+    // See `auto_exposure.hlsl`.
+    struct Constants
+    {
+        uint32_t input_idx;
+        uint32_t input_width;
+        uint32_t input_height;
+        float min_log_luminance;
+        float max_log_luminance;
+        float low_percentile;
+        float high_percentile;
+        float brightening_speed;
+        float darkening_speed;
+        float delta_time;
+        float compensation;
+        uint32_t reset;
+    };
+
+  public:
+    // Contents of the exposure buffer.
+    struct Exposure
+    {
+        float adapted_log_luminance;
+        float exposure;
+    };
+
+    struct RunData
+    {
+        uint32_t color_target_srv_idx;
+        uint32_t viewport_width;
+        uint32_t viewport_height;
+        // Shifts the exposure, in stops.
+        float compensation;
+    };
+
+  private:
+    using Clock = std::chrono::steady_clock;
+
+    RHI *m_rhi;
+
+    ComPtr<ID3D12RootSignature> m_root_signature;
+    ComPtr<ID3D12PipelineState> m_histogram_pipeline;
+    ComPtr<ID3D12PipelineState> m_adapt_pipeline;
+
+    ComPtr<ID3D12Resource> m_histogram;
+    ComPtr<ID3D12Resource> m_exposure;
+
+    AutoExposureParams m_params;
+    Clock::time_point m_last_run;
+    bool m_reset{true};
+
+    AutoExposurePass() = delete;
+    AutoExposurePass(const AutoExposurePass &) = delete;
+    AutoExposurePass &operator=(const AutoExposurePass &) = delete;
+    AutoExposurePass(AutoExposurePass &&) = delete;
+    AutoExposurePass &operator=(AutoExposurePass &&) = delete;
+
+  public:
+    explicit AutoExposurePass(RHI *rhi) : m_rhi(rhi)
+    {
+    }
+
+    [[nodiscard]] bool init();
+
+    // Adapts over the time since the previous run.
+    void run(ID3D12GraphicsCommandList *cmd_list, const RunData &run_data);
+
+    // Makes the next run take the measured luminance as is, e.g. after not running for a while.
+    void reset()
+    {
+        m_reset = true;
+    }
+
+    // Buffer holding `Exposure`, left in the unordered access state by `run`.
+    [[nodiscard]] ID3D12Resource *exposure() const
+    {
+        return m_exposure.Get();
+    }
+};
+
+} // namespace Arctic::Renderer
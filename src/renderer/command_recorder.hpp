@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "render_graph.hpp"
+
+namespace Arctic::Renderer
+{
+
+// Receives the commands a render graph issues while it is executed. The D3D12 renderer translates
+// them into native commands, the null backend records them into a log.
+class CommandRecorder
+{
+  public:
+    virtual ~CommandRecorder() = default;
+
+    // Called before the barriers of a pass are submitted.
+    virtual void begin_pass(uint32_t pass_idx)
+    {
+        (void)pass_idx;
+    }
+
+    // Called once per non-empty batch of barriers.
+    virtual void barriers(const std::vector<Barrier> &barriers) = 0;
+
+    // Called after the work of a pass has been recorded.
+    virtual void end_pass(uint32_t pass_idx)
+    {
+        (void)pass_idx;
+    }
+};
+
+} // namespace Arctic::Renderer
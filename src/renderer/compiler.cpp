@@ -17,7 +17,10 @@ bool Compiler::init()
         "Compiler::init: failed to create compiler"
     );
 
-    // m_utils->CreateDefaultIncludeHandler(&m_include_handler);
+    DXERR(
+        m_utils->CreateDefaultIncludeHandler(&m_include_handler),
+        "Compiler::init: failed to create include handler"
+    );
 
     return true;
 }
@@ -43,6 +46,8 @@ bool Compiler::compile_shader(
         entry_point,
         L"-T",
         target,
+        L"-I",
+        L"./shaders",
         // L"-HV",
         // L"2021"
         // L"-Zi", // enable debug info
@@ -53,7 +58,7 @@ bool Compiler::compile_shader(
         &source_code,
         compiler_args,
         _countof(compiler_args),
-        nullptr,
+        m_include_handler.Get(),
         IID_PPV_ARGS(&results)
     );
 
@@ -0,0 +1,260 @@
+#include "dds.hpp"
+
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <utility>
+
+#include <spdlog/spdlog.h>
+
+namespace Arctic::Renderer
+{
+
+static constexpr uint32_t make_four_cc(char a, char b, char c, char d)
+{
+    return static_cast<uint32_t>(a) | (static_cast<uint32_t>(b) << 8) |
+           (static_cast<uint32_t>(c) << 16) | (static_cast<uint32_t>(d) << 24);
+}
+
+static constexpr uint32_t DDS_MAGIC = make_four_cc('D', 'D', 'S', ' ');
+
+static constexpr uint32_t DDSD_CAPS = 0x1;
+static constexpr uint32_t DDSD_HEIGHT = 0x2;
+static constexpr uint32_t DDSD_WIDTH = 0x4;
+static constexpr uint32_t DDSD_PIXELFORMAT = 0x1000;
+static constexpr uint32_t DDSD_MIPMAPCOUNT = 0x20000;
+static constexpr uint32_t DDSD_LINEARSIZE = 0x80000;
+static constexpr uint32_t DDPF_FOURCC = 0x4;
+static constexpr uint32_t DDSCAPS_COMPLEX = 0x8;
+static constexpr uint32_t DDSCAPS_TEXTURE = 0x1000;
+static constexpr uint32_t DDSCAPS_MIPMAP = 0x400000;
+static constexpr uint32_t DDS_DIMENSION_TEXTURE2D = 3;
+
+struct DdsPixelFormat
+{
+    uint32_t size;
+    uint32_t flags;
+    uint32_t four_cc;
+    uint32_t rgb_bit_count;
+    std::array<uint32_t, 4> bit_masks;
+};
+
+struct DdsHeader
+{
+    uint32_t size;
+    uint32_t flags;
+    uint32_t height;
+    uint32_t width;
+    uint32_t pitch_or_linear_size;
+    uint32_t depth;
+    uint32_t mip_map_count;
+    std::array<uint32_t, 11> reserved1;
+    DdsPixelFormat pixel_format;
+    std::array<uint32_t, 4> caps;
+    uint32_t reserved2;
+};
+
+struct DdsHeaderDx10
+{
+    uint32_t dxgi_format;
+    uint32_t resource_dimension;
+    uint32_t misc_flag;
+    uint32_t array_size;
+    uint32_t misc_flags2;
+};
+
+static_assert(sizeof(DdsPixelFormat) == 32);
+static_assert(sizeof(DdsHeader) == 124);
+static_assert(sizeof(DdsHeaderDx10) == 20);
+
+static TextureFormat format_from_four_cc(uint32_t four_cc)
+{
+    switch (four_cc)
+    {
+        case make_four_cc('D', 'X', 'T', '1'):
+            return TextureFormat::BC1Unorm;
+        case make_four_cc('D', 'X', 'T', '5'):
+            return TextureFormat::BC3Unorm;
+        case make_four_cc('A', 'T', 'I', '1'):
+        case make_four_cc('B', 'C', '4', 'U'):
+            return TextureFormat::BC4Unorm;
+        case make_four_cc('A', 'T', 'I', '2'):
+        case make_four_cc('B', 'C', '5', 'U'):
+            return TextureFormat::BC5Unorm;
+        default:
+            return TextureFormat::Unknown;
+    }
+}
+
+bool load_dds(
+    const std::filesystem::path &path, MipColorSpace color_space, TextureImage &out_image
+)
+{
+    auto file = std::make_shared<MappedFile>();
+    if (!file->open(path))
+    {
+        spdlog::error("load_dds: failed to map `{}`", path.string());
+        return false;
+    }
+    std::span<const uint8_t> bytes = file->bytes();
+
+    uint32_t magic = 0;
+    DdsHeader header{};
+    if (bytes.size() < sizeof(magic) + sizeof(header))
+    {
+        spdlog::error("load_dds: `{}` is not a DDS file", path.string());
+        return false;
+    }
+    std::memcpy(&magic, bytes.data(), sizeof(magic));
+    std::memcpy(&header, bytes.data() + sizeof(magic), sizeof(header));
+    uint64_t data_offset = sizeof(magic) + sizeof(header);
+    if (magic != DDS_MAGIC || header.size != sizeof(DdsHeader))
+    {
+        spdlog::error("load_dds: `{}` is not a DDS file", path.string());
+        return false;
+    }
+
+    if (header.width == 0 || header.height == 0)
+    {
+        spdlog::error("load_dds: `{}` has no texels", path.string());
+        return false;
+    }
+
+    if ((header.pixel_format.flags & DDPF_FOURCC) == 0)
+    {
+        spdlog::error("load_dds: `{}` has an unsupported pixel format", path.string());
+        return false;
+    }
+
+    TextureFormat format;
+    if (header.pixel_format.four_cc == make_four_cc('D', 'X', '1', '0'))
+    {
+        DdsHeaderDx10 header_dx10{};
+        if (bytes.size() < data_offset + sizeof(header_dx10))
+        {
+            spdlog::error("load_dds: `{}` is truncated", path.string());
+            return false;
+        }
+        std::memcpy(&header_dx10, bytes.data() + data_offset, sizeof(header_dx10));
+        data_offset += sizeof(header_dx10);
+        if (header_dx10.resource_dimension != DDS_DIMENSION_TEXTURE2D ||
+            header_dx10.array_size > 1)
+        {
+            spdlog::error("load_dds: `{}` is not a single 2D texture", path.string());
+            return false;
+        }
+        format = static_cast<TextureFormat>(header_dx10.dxgi_format);
+    }
+    else
+    {
+        format = format_in_color_space(
+            format_from_four_cc(header.pixel_format.four_cc), color_space
+        );
+    }
+
+    if (format_element_size(format) == 0)
+    {
+        spdlog::error(
+            "load_dds: `{}` has unsupported format {}",
+            path.string(),
+            static_cast<uint32_t>(format)
+        );
+        return false;
+    }
+
+    uint32_t mip_levels = (header.flags & DDSD_MIPMAPCOUNT) ? header.mip_map_count : 1;
+    if (mip_levels == 0 || mip_levels > mip_count(header.width, header.height))
+    {
+        spdlog::error("load_dds: `{}` has an invalid number of mip levels", path.string());
+        return false;
+    }
+
+    // The levels are read from the mapping in place, without copying them out of the file.
+    out_image.format = format;
+    out_image.width = header.width;
+    out_image.height = header.height;
+    out_image.data.clear();
+    uint64_t data_size = compute_texture_levels(
+        format,
+        header.width,
+        header.height,
+        mip_levels,
+        data_offset,
+        out_image.levels
+    );
+    if (bytes.size() < data_offset + data_size)
+    {
+        spdlog::error("load_dds: `{}` is truncated", path.string());
+        return false;
+    }
+    out_image.file = std::move(file);
+
+    return true;
+}
+
+bool save_dds(const std::filesystem::path &path, const TextureImage &image)
+{
+    std::ofstream file(path, std::ios::binary);
+    if (!file)
+    {
+        spdlog::error("save_dds: failed to open `{}`", path.string());
+        return false;
+    }
+
+    uint32_t caps = DDSCAPS_TEXTURE;
+    if (image.levels.size() > 1)
+    {
+        caps |= DDSCAPS_COMPLEX | DDSCAPS_MIPMAP;
+    }
+
+    DdsHeader header{
+        .size = sizeof(DdsHeader),
+        .flags = DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PIXELFORMAT | DDSD_MIPMAPCOUNT |
+                 DDSD_LINEARSIZE,
+        .height = image.height,
+        .width = image.width,
+        .pitch_or_linear_size = static_cast<uint32_t>(image.levels[0].size),
+        .depth = 0,
+        .mip_map_count = static_cast<uint32_t>(image.levels.size()),
+        .reserved1 = {},
+        .pixel_format =
+            DdsPixelFormat{
+                .size = sizeof(DdsPixelFormat),
+                .flags = DDPF_FOURCC,
+                .four_cc = make_four_cc('D', 'X', '1', '0'),
+                .rgb_bit_count = 0,
+                .bit_masks = {},
+            },
+        .caps = {caps, 0, 0, 0},
+        .reserved2 = 0,
+    };
+    DdsHeaderDx10 header_dx10{
+        .dxgi_format = static_cast<uint32_t>(image.format),
+        .resource_dimension = DDS_DIMENSION_TEXTURE2D,
+        .misc_flag = 0,
+        .array_size = 1,
+        .misc_flags2 = 0,
+    };
+
+    file.write(reinterpret_cast<const char *>(&DDS_MAGIC), sizeof(DDS_MAGIC));
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char *>(&header_dx10), sizeof(header_dx10));
+    for (size_t level = 0; level < image.levels.size(); ++level)
+    {
+        std::span<const uint8_t> level_data = image.level_data(level);
+        file.write(
+            reinterpret_cast<const char *>(level_data.data()),
+            static_cast<std::streamsize>(level_data.size())
+        );
+    }
+    if (!file)
+    {
+        spdlog::error("save_dds: failed to write `{}`", path.string());
+        return false;
+    }
+
+    return true;
+}
+
+} // namespace Arctic::Renderer
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <filesystem>
+
+#include "texture_image.hpp"
+
+namespace Arctic::Renderer
+{
+
+// Loads a 2D texture with all of its mip levels from a DDS file. Files with the DX10 extension
+// header and the legacy DXT1, DXT5, ATI1 and ATI2 codes are supported. The file is mapped into
+// memory and the image references its levels in place. The legacy codes carry no colour space,
+// so their texels are taken to be in `color_space`. DX10 files keep the format they store.
+[[nodiscard]] bool load_dds(
+    const std::filesystem::path &path, MipColorSpace color_space, TextureImage &out_image
+);
+
+// Saves a 2D texture with all of its mip levels as a DDS file with the DX10 extension header.
+[[nodiscard]] bool save_dds(const std::filesystem::path &path, const TextureImage &image);
+
+} // namespace Arctic::Renderer
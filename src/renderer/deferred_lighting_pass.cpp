@@ -0,0 +1,124 @@
+#include "deferred_lighting_pass.hpp"
+
+#include <vector>
+
+#include <directx/d3dx12.h>
+
+#include <glm/matrix.hpp>
+
+#include <spdlog/spdlog.h>
+
+#include "tracy/Tracy.hpp"
+#include "tracy/TracyD3D12.hpp"
+
+#include "dxerr.hpp"
+
+#define CONSTANTS_SIZE(ty) ((sizeof(ty) + 3) / 4)
+
+namespace Arctic::Renderer
+{
+
+bool DeferredLightingPass::init()
+{
+    std::vector<uint8_t> cs_code;
+    if (!m_rhi->compiler()
+             .compile_shader(L"./shaders/deferred_lighting.hlsl", L"cs_main", L"cs_6_6", cs_code))
+    {
+        spdlog::error("DeferredLightingPass::init: failed to compile compute shader");
+        return false;
+    }
+
+    ComPtr<ID3DBlob> root_signature;
+
+    std::array<CD3DX12_ROOT_PARAMETER, 1> root_parameters{};
+    root_parameters[0].InitAsConstants(CONSTANTS_SIZE(Constants), 0);
+
+    // Same filtering as the shadow map lookups of the forward pass.
+    D3D12_STATIC_SAMPLER_DESC sampler{};
+    sampler.Filter = D3D12_FILTER_MIN_MAG_MIP_LINEAR;
+    sampler.AddressU = D3D12_TEXTURE_ADDRESS_MODE_WRAP;
+    sampler.AddressV = D3D12_TEXTURE_ADDRESS_MODE_WRAP;
+    sampler.AddressW = D3D12_TEXTURE_ADDRESS_MODE_WRAP;
+    sampler.ComparisonFunc = D3D12_COMPARISON_FUNC_NEVER;
+    sampler.BorderColor = D3D12_STATIC_BORDER_COLOR_TRANSPARENT_BLACK;
+    sampler.MaxLOD = D3D12_FLOAT32_MAX;
+    sampler.ShaderRegister = 0;
+    sampler.RegisterSpace = 0;
+    sampler.ShaderVisibility = D3D12_SHADER_VISIBILITY_ALL;
+
+    CD3DX12_ROOT_SIGNATURE_DESC root_signature_desc;
+    root_signature_desc.Init(
+        static_cast<UINT>(root_parameters.size()),
+        root_parameters.data(),
+        1,
+        &sampler,
+        D3D12_ROOT_SIGNATURE_FLAG_CBV_SRV_UAV_HEAP_DIRECTLY_INDEXED
+    );
+    DXERR(
+        D3D12SerializeRootSignature(
+            &root_signature_desc,
+            D3D_ROOT_SIGNATURE_VERSION_1,
+            &root_signature,
+            nullptr
+        ),
+        "DeferredLightingPass::init: failed to serialize root signature"
+    );
+    DXERR(
+        m_rhi->device()->CreateRootSignature(
+            0,
+            root_signature->GetBufferPointer(),
+            root_signature->GetBufferSize(),
+            IID_PPV_ARGS(&m_root_signature)
+        ),
+        "DeferredLightingPass::init: failed to create root signature"
+    );
+
+    D3D12_COMPUTE_PIPELINE_STATE_DESC pipeline_desc{};
+    pipeline_desc.pRootSignature = m_root_signature.Get();
+    pipeline_desc.CS = CD3DX12_SHADER_BYTECODE(cs_code.data(), cs_code.size());
+    DXERR(
+        m_rhi->device()->CreateComputePipelineState(&pipeline_desc, IID_PPV_ARGS(&m_pipeline)),
+        "DeferredLightingPass::init: failed to create pipeline state"
+    );
+    spdlog::trace("DeferredLightingPass::init: created pipeline state");
+
+    return true;
+}
+
+void DeferredLightingPass::run(ID3D12GraphicsCommandList *cmd_list, const RunData &run_data)
+{
+    ZoneScoped;
+    TracyD3D12Zone(m_rhi->tracy_ctx(), cmd_list, "Deferred Lighting Pass");
+
+    const Scene &scene = run_data.scene;
+    Constants constants{
+        .inv_proj_view = glm::inverse(scene.camera.proj_view_matrix()),
+        .light_proj_view = scene.sun.proj_view_matrix(),
+        .eye = scene.camera.eye,
+        .ambient = scene.ambient,
+        .sun_dir = scene.sun.direction(),
+        .viewport_width = run_data.viewport_width,
+        .sun_color = scene.sun.color,
+        .viewport_height = run_data.viewport_height,
+        .camera_forward = scene.camera.forward(),
+        .depth_idx = run_data.depth_srv_idx,
+        .base_color_idx = run_data.gbuffer_srv_idxs[0],
+        .normal_idx = run_data.gbuffer_srv_idxs[1],
+        .metalness_roughness_idx = run_data.gbuffer_srv_idxs[2],
+        .shadow_map_idx = run_data.shadow_map_srv_idx,
+        .lights_buffer_idx = run_data.lights_buffer_cbv_idx,
+        .output_idx = run_data.color_target_uav_idx,
+        .ibl_idx = run_data.ibl_cbv_idx,
+    };
+
+    cmd_list->SetComputeRootSignature(m_root_signature.Get());
+    cmd_list->SetPipelineState(m_pipeline.Get());
+    cmd_list->SetComputeRoot32BitConstants(0, CONSTANTS_SIZE(Constants), &constants, 0);
+    cmd_list->Dispatch(
+        (run_data.viewport_width + DEFERRED_TILE_SIZE - 1) / DEFERRED_TILE_SIZE,
+        (run_data.viewport_height + DEFERRED_TILE_SIZE - 1) / DEFERRED_TILE_SIZE,
+        1
+    );
+}
+
+} // namespace Arctic::Renderer
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#include <d3d12.h>
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+
+#include "comptr.hpp"
+#include "rhi.hpp"
+#include "scene.hpp"
+
+namespace Arctic::Renderer
+{
+
+// Has to match the group size in `deferred_lighting.hlsl`.
+static constexpr uint32_t DEFERRED_TILE_SIZE = 16;
+
+// Targets of the G-buffer, in the order of the render targets of `gbuffer.hlsl`: base color,
+// octahedral normal and metalness with roughness.
+static constexpr std::array GBUFFER_FORMATS{
+    DXGI_FORMAT_R8G8B8A8_UNORM_SRGB,
+    DXGI_FORMAT_R16G16_SNORM,
+    DXGI_FORMAT_R8G8_UNORM,
+};
+
+// Shades the G-buffer written by `ForwardPass` in one compute dispatch. Every 16x16 tile culls
+// the point lights against the frustum spanned by its depth range, so the cost of a pixel only
+// grows with the lights that actually reach its tile.
+class DeferredLightingPass
+{
+    // See `deferred_lighting.hlsl`.
+    struct Constants
+    {
+        glm::mat4 inv_proj_view;
+        glm::mat4 light_proj_view;
+        glm::vec3 eye;
+        float ambient;
+        glm::vec3 sun_dir;
+        uint32_t viewport_width;
+        glm::vec3 sun_color;
+        uint32_t viewport_height;
+        glm::vec3 camera_forward;
+        uint32_t depth_idx;
+        uint32_t base_color_idx;
+        uint32_t normal_idx;
+        uint32_t metalness_roughness_idx;
+        uint32_t shadow_map_idx;
+        uint32_t lights_buffer_idx;
+        uint32_t output_idx;
+        uint32_t ibl_idx;
+    };
+
+  public:
+    struct RunData
+    {
+        // Shader resource views of the depth target and the G-buffer targets, in the order of
+        // `GBUFFER_FORMATS`.
+        uint32_t depth_srv_idx;
+        std::array<uint32_t, GBUFFER_FORMATS.size()> gbuffer_srv_idxs;
+        uint32_t shadow_map_srv_idx;
+        uint32_t lights_buffer_cbv_idx;
+        uint32_t ibl_cbv_idx;
+        uint32_t color_target_uav_idx;
+        uint32_t viewport_width;
+        uint32_t viewport_height;
+        const Scene &scene;
+    };
+
+  private:
+    RHI *m_rhi;
+
+    ComPtr<ID3D12RootSignature> m_root_signature;
+    ComPtr<ID3D12PipelineState> m_pipeline;
+
+    DeferredLightingPass() = delete;
+    DeferredLightingPass(const DeferredLightingPass &) = delete;
+    DeferredLightingPass &operator=(const DeferredLightingPass &) = delete;
+    DeferredLightingPass(DeferredLightingPass &&) = delete;
+    DeferredLightingPass &operator=(DeferredLightingPass &&) = delete;
+
+  public:
+    explicit DeferredLightingPass(RHI *rhi) : m_rhi(rhi)
+    {
+    }
+
+    [[nodiscard]] bool init();
+
+    // Writes every pixel covered by the G-buffer into the color target. The others are left
+    // untouched for the skybox.
+    void run(ID3D12GraphicsCommandList *cmd_list, const RunData &run_data);
+};
+
+} // namespace Arctic::Renderer
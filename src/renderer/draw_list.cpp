@@ -0,0 +1,111 @@
+#include "draw_list.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+#include <glm/trigonometric.hpp>
+#include <glm/vec4.hpp>
+
+namespace Arctic::Renderer
+{
+
+LodSelection lod_selection(const Camera &camera, uint32_t viewport_height, float max_pixel_error)
+{
+    return LodSelection{
+        .eye = camera.eye,
+        .pixels_per_unit = static_cast<float>(viewport_height) /
+                           (2.0f * std::tan(glm::radians(camera.fov_y) / 2.0f)),
+        .max_pixel_error = max_pixel_error,
+    };
+}
+
+static const MeshLod &select_lod(
+    const MeshDrawInfo &mesh, const glm::vec3 &center, float radius, float scale,
+    const LodSelection &lod
+)
+{
+    // Distance to the closest point of the bounding sphere, which is where the error would show
+    // the most.
+    float distance = glm::length(center - lod.eye) - radius;
+    if (distance <= 0.0f)
+    {
+        return mesh.lods.front();
+    }
+
+    float max_error = lod.max_pixel_error * distance / (lod.pixels_per_unit * scale);
+    size_t selected = 0;
+    while (selected + 1 < mesh.lods.size() && mesh.lods[selected + 1].error <= max_error)
+    {
+        ++selected;
+    }
+    return mesh.lods[selected];
+}
+
+void build_draw_list(
+    std::span<const Object> objects, std::span<const MeshDrawInfo> meshes,
+    const LodSelection &lod, std::vector<DrawItem> &out_draws, std::span<const uint8_t> visible
+)
+{
+    out_draws.clear();
+    out_draws.reserve(objects.size());
+    for (size_t i = 0; i < objects.size(); ++i)
+    {
+        if (!visible.empty() && visible[i] == 0)
+        {
+            continue;
+        }
+
+        const Object &object = objects[i];
+        const MeshDrawInfo &mesh = meshes[object.mesh_idx];
+        const glm::mat4 &model = object.trs;
+        glm::vec3 center = glm::vec3(model * glm::vec4(mesh.bounds_center, 1.0f));
+        float scale = std::max(
+            {glm::length(glm::vec3(model[0])),
+             glm::length(glm::vec3(model[1])),
+             glm::length(glm::vec3(model[2]))}
+        );
+        float radius = mesh.bounds_radius * scale;
+        const MeshLod &selected = select_lod(mesh, center, radius, scale, lod);
+        out_draws.emplace_back(DrawItem{
+            .model = object.trs,
+            .mesh_idx = object.mesh_idx,
+            .material_idx = mesh.material_idx,
+            .first_index = selected.first_index,
+            .index_count = selected.index_count,
+            .first_meshlet = selected.first_meshlet,
+            .meshlet_count = selected.meshlet_count,
+            .bounds_center = center,
+            .bounds_radius = radius,
+            .object_idx = static_cast<uint32_t>(i),
+        });
+    }
+}
+
+void scene_bounds(
+    std::span<const Object> objects, std::span<const MeshDrawInfo> meshes, glm::vec3 &out_min,
+    glm::vec3 &out_max
+)
+{
+    out_min = glm::vec3(std::numeric_limits<float>::max());
+    out_max = glm::vec3(std::numeric_limits<float>::lowest());
+    for (const Object &object : objects)
+    {
+        const MeshDrawInfo &mesh = meshes[object.mesh_idx];
+        for (uint32_t corner_idx = 0; corner_idx < 8; ++corner_idx)
+        {
+            glm::vec3 corner(
+                (corner_idx & 1) != 0 ? mesh.bounds_max.x : mesh.bounds_min.x,
+                (corner_idx & 2) != 0 ? mesh.bounds_max.y : mesh.bounds_min.y,
+                (corner_idx & 4) != 0 ? mesh.bounds_max.z : mesh.bounds_min.z
+            );
+            glm::vec3 world = glm::vec3(object.trs * glm::vec4(corner, 1.0f));
+            out_min = glm::min(out_min, world);
+            out_max = glm::max(out_max, world);
+        }
+    }
+}
+
+} // namespace Arctic::Renderer
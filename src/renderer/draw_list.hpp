@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+
+#include "scene.hpp"
+
+namespace Arctic::Renderer
+{
+
+// Largest simplification error, in pixels, the draws of the forward and shadow passes may show.
+// Shadows are blurred and seen only indirectly, so they get away with coarser levels of detail.
+static constexpr float LOD_PIXEL_ERROR = 1.0f;
+static constexpr float SHADOW_LOD_PIXEL_ERROR = 4.0f;
+
+// A range of the index buffer of a mesh that draws it at one level of detail.
+struct MeshLod
+{
+    uint32_t first_index;
+    uint32_t index_count;
+    // Largest distance, in object space units, of the vertices of the original mesh to the
+    // surface of this level.
+    float error;
+    // The same triangles split into meshlets, for the mesh shader path.
+    uint32_t first_meshlet{0};
+    uint32_t meshlet_count{0};
+};
+
+// The parts of a mesh that are needed to decide what to draw, without any GPU resources.
+struct MeshDrawInfo
+{
+    // Levels of detail from the original mesh to the coarsest one, with increasing errors.
+    std::vector<MeshLod> lods;
+    MaterialIdx material_idx;
+    // Bounding box in object space.
+    glm::vec3 bounds_min;
+    glm::vec3 bounds_max;
+    // Bounding sphere in object space.
+    glm::vec3 bounds_center;
+    float bounds_radius;
+};
+
+struct DrawItem
+{
+    glm::mat4 model;
+    MeshIdx mesh_idx;
+    MaterialIdx material_idx;
+    uint32_t first_index;
+    uint32_t index_count;
+    uint32_t first_meshlet;
+    uint32_t meshlet_count;
+    // Bounding sphere in world space.
+    glm::vec3 bounds_center;
+    float bounds_radius;
+    // Index of the object in the scene, which unlike the index of the draw does not change when
+    // objects before it are skipped. Keys state kept between frames, like occlusion predicates.
+    uint32_t object_idx;
+};
+
+struct LodSelection
+{
+    glm::vec3 eye;
+    // Pixels per unit of size at a distance of one unit from the camera.
+    float pixels_per_unit;
+    float max_pixel_error;
+};
+
+[[nodiscard]] LodSelection
+lod_selection(const Camera &camera, uint32_t viewport_height, float max_pixel_error);
+
+// Collects the draws of all objects of a scene. Passes record exactly the draws in the list, so
+// any selection of what gets drawn happens here. Every object is drawn at the coarsest level of
+// detail whose error, projected to the screen, stays within `lod.max_pixel_error`. Objects whose
+// entry in `visible` is zero are skipped, an empty span draws all of them.
+void build_draw_list(
+    std::span<const Object> objects, std::span<const MeshDrawInfo> meshes,
+    const LodSelection &lod, std::vector<DrawItem> &out_draws,
+    std::span<const uint8_t> visible = {}
+);
+
+// World space box around the bounding boxes of all objects of a scene.
+void scene_bounds(
+    std::span<const Object> objects, std::span<const MeshDrawInfo> meshes, glm::vec3 &out_min,
+    glm::vec3 &out_max
+);
+
+} // namespace Arctic::Renderer
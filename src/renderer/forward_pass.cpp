@@ -1,20 +1,59 @@
 #include "forward_pass.hpp"
 
+#include <algorithm>
+#include <cstring>
+
 #include <d3d12.h>
 #include <directx/d3dx12.h>
 
 #include <spdlog/spdlog.h>
 
 #include "dxerr.hpp"
+#include "meshlet.hpp"
 
 #define CONSTANTS_SIZE(ty) ((sizeof(ty) + 3) / 4)
 
 namespace Arctic::Renderer
 {
 
-bool ForwardPass::init()
+static D3D12_STATIC_SAMPLER_DESC linear_wrap_sampler()
+{
+    D3D12_STATIC_SAMPLER_DESC sampler{};
+    sampler.Filter = D3D12_FILTER_MIN_MAG_MIP_LINEAR;
+    sampler.AddressU = D3D12_TEXTURE_ADDRESS_MODE_WRAP;
+    sampler.AddressV = D3D12_TEXTURE_ADDRESS_MODE_WRAP;
+    sampler.AddressW = D3D12_TEXTURE_ADDRESS_MODE_WRAP;
+    sampler.MipLODBias = 0;
+    sampler.MaxAnisotropy = 0;
+    sampler.ComparisonFunc = D3D12_COMPARISON_FUNC_NEVER;
+    sampler.BorderColor = D3D12_STATIC_BORDER_COLOR_TRANSPARENT_BLACK;
+    sampler.MinLOD = 0.0f;
+    sampler.MaxLOD = D3D12_FLOAT32_MAX;
+    sampler.ShaderRegister = 0;
+    sampler.RegisterSpace = 0;
+    sampler.ShaderVisibility = D3D12_SHADER_VISIBILITY_PIXEL;
+    return sampler;
+}
+
+// Subobjects of the mesh shader pipeline, see `ID3D12Device2::CreatePipelineState`.
+struct MeshletPipelineStream
+{
+    CD3DX12_PIPELINE_STATE_STREAM_ROOT_SIGNATURE root_signature;
+    CD3DX12_PIPELINE_STATE_STREAM_AS as;
+    CD3DX12_PIPELINE_STATE_STREAM_MS ms;
+    CD3DX12_PIPELINE_STATE_STREAM_PS ps;
+    CD3DX12_PIPELINE_STATE_STREAM_RASTERIZER rasterizer;
+    CD3DX12_PIPELINE_STATE_STREAM_DEPTH_STENCIL depth_stencil;
+    CD3DX12_PIPELINE_STATE_STREAM_RENDER_TARGET_FORMATS render_target_formats;
+    CD3DX12_PIPELINE_STATE_STREAM_DEPTH_STENCIL_FORMAT depth_stencil_format;
+};
+
+// The forward pass shades into a single HDR color target.
+static constexpr std::array COLOR_TARGET_FORMATS{DXGI_FORMAT_R16G16B16A16_FLOAT};
+
+bool ForwardPass::init(bool mesh_shaders)
 {
-    std::vector<uint8_t> vs_code, ps_code;
+    std::vector<uint8_t> vs_code, ps_code, gbuffer_ps_code;
     if (!m_rhi->compiler()
              .compile_shader(L"./shaders/forward.hlsl", L"vs_main", L"vs_6_6", vs_code))
     {
@@ -27,6 +66,12 @@ bool ForwardPass::init()
         spdlog::error("ForwardPass::init: failed to compile pixel shader");
         return false;
     }
+    if (!m_rhi->compiler()
+             .compile_shader(L"./shaders/gbuffer.hlsl", L"ps_main", L"ps_6_6", gbuffer_ps_code))
+    {
+        spdlog::error("ForwardPass::init: failed to compile G-buffer pixel shader");
+        return false;
+    }
     spdlog::trace("ForwardPass::init: compiled forward shaders");
 
     ComPtr<ID3DBlob> root_signature;
@@ -35,20 +80,7 @@ bool ForwardPass::init()
     std::array<CD3DX12_ROOT_PARAMETER, 1> root_parameters{};
     root_parameters[0].InitAsConstants(CONSTANTS_SIZE(ConstantBuffer), 0);
 
-    D3D12_STATIC_SAMPLER_DESC sampler{};
-    sampler.Filter = D3D12_FILTER_MIN_MAG_MIP_LINEAR;
-    sampler.AddressU = D3D12_TEXTURE_ADDRESS_MODE_WRAP;
-    sampler.AddressV = D3D12_TEXTURE_ADDRESS_MODE_WRAP;
-    sampler.AddressW = D3D12_TEXTURE_ADDRESS_MODE_WRAP;
-    sampler.MipLODBias = 0;
-    sampler.MaxAnisotropy = 0;
-    sampler.ComparisonFunc = D3D12_COMPARISON_FUNC_NEVER;
-    sampler.BorderColor = D3D12_STATIC_BORDER_COLOR_TRANSPARENT_BLACK;
-    sampler.MinLOD = 0.0f;
-    sampler.MaxLOD = D3D12_FLOAT32_MAX;
-    sampler.ShaderRegister = 0;
-    sampler.RegisterSpace = 0;
-    sampler.ShaderVisibility = D3D12_SHADER_VISIBILITY_PIXEL;
+    D3D12_STATIC_SAMPLER_DESC sampler = linear_wrap_sampler();
 
     CD3DX12_ROOT_SIGNATURE_DESC root_signature_desc;
     root_signature_desc.Init(
@@ -83,81 +115,330 @@ bool ForwardPass::init()
     );
     spdlog::trace("ForwardPass::init: created root signature");
 
-    // ------------
-    // Create graphics pipeline state
-    // -------
-    std::array vertex_layout{
-        D3D12_INPUT_ELEMENT_DESC{
-            .SemanticName = "POSITION",
-            .SemanticIndex = 0,
-            .Format = DXGI_FORMAT_R32G32B32_FLOAT,
-            .InputSlot = 0,
-            .AlignedByteOffset = offsetof(Vertex, position),
-            .InputSlotClass = D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA,
-            .InstanceDataStepRate = 0,
-        },
-        D3D12_INPUT_ELEMENT_DESC{
-            .SemanticName = "NORMAL",
-            .SemanticIndex = 0,
-            .Format = DXGI_FORMAT_R32G32B32_FLOAT,
-            .InputSlot = 0,
-            .AlignedByteOffset = offsetof(Vertex, normal),
-            .InputSlotClass = D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA,
-            .InstanceDataStepRate = 0,
-        },
-        D3D12_INPUT_ELEMENT_DESC{
-            .SemanticName = "TANGENT",
-            .SemanticIndex = 0,
-            .Format = DXGI_FORMAT_R32G32B32_FLOAT,
-            .InputSlot = 0,
-            .AlignedByteOffset = offsetof(Vertex, tangent),
-            .InputSlotClass = D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA,
-            .InstanceDataStepRate = 0,
-        },
-        D3D12_INPUT_ELEMENT_DESC{
-            .SemanticName = "BITANGENT",
-            .SemanticIndex = 0,
-            .Format = DXGI_FORMAT_R32G32B32_FLOAT,
-            .InputSlot = 0,
-            .AlignedByteOffset = offsetof(Vertex, bitangent),
-            .InputSlotClass = D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA,
-            .InstanceDataStepRate = 0,
-        },
-        D3D12_INPUT_ELEMENT_DESC{
-            .SemanticName = "TEXCOORD",
-            .SemanticIndex = 0,
-            .Format = DXGI_FORMAT_R32G32_FLOAT,
-            .InputSlot = 0,
-            .AlignedByteOffset = offsetof(Vertex, tex_coords),
-            .InputSlotClass = D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA,
-            .InstanceDataStepRate = 0,
-        },
+    if (!init_pipelines(vs_code, ps_code, COLOR_TARGET_FORMATS, m_pipelines) ||
+        !init_pipelines(vs_code, gbuffer_ps_code, GBUFFER_FORMATS, m_gbuffer_pipelines))
+    {
+        spdlog::error("ForwardPass::init: failed to create pipeline states");
+        return false;
+    }
+    spdlog::trace("ForwardPass::init: created pipeline states");
+
+    return !mesh_shaders || init_meshlet_pipelines(ps_code, gbuffer_ps_code);
+}
+
+bool ForwardPass::init_pipelines(
+    std::span<const uint8_t> vs_code, std::span<const uint8_t> ps_code,
+    std::span<const DXGI_FORMAT> render_target_formats, Pipelines &out_pipelines
+)
+{
+    for (VertexPositionFormat position_format : VERTEX_POSITION_FORMATS)
+    {
+        std::array vertex_layout{
+            D3D12_INPUT_ELEMENT_DESC{
+                .SemanticName = "POSITION",
+                .SemanticIndex = 0,
+                .Format = vertex_position_dxgi_format(position_format),
+                .InputSlot = 0,
+                .AlignedByteOffset = 0,
+                .InputSlotClass = D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA,
+                .InstanceDataStepRate = 0,
+            },
+            D3D12_INPUT_ELEMENT_DESC{
+                .SemanticName = "NORMAL",
+                .SemanticIndex = 0,
+                .Format = DXGI_FORMAT_R16G16_SNORM,
+                .InputSlot = 1,
+                .AlignedByteOffset = offsetof(PackedVertexAttributes, normal),
+                .InputSlotClass = D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA,
+                .InstanceDataStepRate = 0,
+            },
+            D3D12_INPUT_ELEMENT_DESC{
+                .SemanticName = "TANGENT",
+                .SemanticIndex = 0,
+                .Format = DXGI_FORMAT_R32_UINT,
+                .InputSlot = 1,
+                .AlignedByteOffset = offsetof(PackedVertexAttributes, tangent),
+                .InputSlotClass = D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA,
+                .InstanceDataStepRate = 0,
+            },
+            D3D12_INPUT_ELEMENT_DESC{
+                .SemanticName = "TEXCOORD",
+                .SemanticIndex = 0,
+                .Format = DXGI_FORMAT_R16G16_FLOAT,
+                .InputSlot = 1,
+                .AlignedByteOffset = offsetof(PackedVertexAttributes, tex_coords),
+                .InputSlotClass = D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA,
+                .InstanceDataStepRate = 0,
+            },
+        };
+
+        D3D12_GRAPHICS_PIPELINE_STATE_DESC pipeline_desc{};
+        pipeline_desc.pRootSignature = m_root_signature.Get();
+        pipeline_desc.VS = {vs_code.data(), vs_code.size()};
+        pipeline_desc.PS = {ps_code.data(), ps_code.size()};
+        pipeline_desc.BlendState = CD3DX12_BLEND_DESC(CD3DX12_DEFAULT());
+        pipeline_desc.SampleMask = ~0u;
+        pipeline_desc.RasterizerState = CD3DX12_RASTERIZER_DESC(CD3DX12_DEFAULT());
+        pipeline_desc.RasterizerState.FrontCounterClockwise = TRUE;
+        pipeline_desc.DepthStencilState = CD3DX12_DEPTH_STENCIL_DESC(CD3DX12_DEFAULT());
+        pipeline_desc.InputLayout = {vertex_layout.data(), static_cast<UINT>(vertex_layout.size())};
+        pipeline_desc.PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;
+        pipeline_desc.NumRenderTargets = static_cast<UINT>(render_target_formats.size());
+        std::copy(
+            render_target_formats.begin(),
+            render_target_formats.end(),
+            pipeline_desc.RTVFormats
+        );
+        pipeline_desc.DSVFormat = DXGI_FORMAT_D32_FLOAT;
+        pipeline_desc.SampleDesc = {1, 0};
+        DXERR(
+            m_rhi->device()->CreateGraphicsPipelineState(
+                &pipeline_desc,
+                IID_PPV_ARGS(&out_pipelines[static_cast<size_t>(position_format)])
+            ),
+            "ForwardPass::init_pipelines: failed to create pipeline state"
+        );
+    }
+
+    return true;
+}
+
+bool ForwardPass::init_meshlet_pipelines(
+    std::span<const uint8_t> ps_code, std::span<const uint8_t> gbuffer_ps_code
+)
+{
+    std::vector<uint8_t> as_code, ms_code;
+    if (!m_rhi->compiler()
+             .compile_shader(L"./shaders/meshlet_cull.hlsl", L"as_main", L"as_6_6", as_code))
+    {
+        spdlog::error(
+            "ForwardPass::init_meshlet_pipelines: failed to compile amplification shader"
+        );
+        return false;
+    }
+    if (!m_rhi->compiler()
+             .compile_shader(L"./shaders/forward_meshlet.hlsl", L"ms_main", L"ms_6_6", ms_code))
+    {
+        spdlog::error("ForwardPass::init_meshlet_pipelines: failed to compile mesh shader");
+        return false;
+    }
+
+    ComPtr<ID3DBlob> root_signature;
+    ComPtr<ID3DBlob> error;
+
+    std::array<CD3DX12_ROOT_PARAMETER, 2> root_parameters{};
+    root_parameters[0].InitAsConstantBufferView(0);
+    root_parameters[1].InitAsConstants(CONSTANTS_SIZE(MeshletConstants), 1);
+
+    D3D12_STATIC_SAMPLER_DESC sampler = linear_wrap_sampler();
+
+    CD3DX12_ROOT_SIGNATURE_DESC root_signature_desc;
+    root_signature_desc.Init(
+        static_cast<UINT>(root_parameters.size()),
+        root_parameters.data(),
+        1,
+        &sampler,
+        D3D12_ROOT_SIGNATURE_FLAG_CBV_SRV_UAV_HEAP_DIRECTLY_INDEXED
+    );
+    if (FAILED(D3D12SerializeRootSignature(
+            &root_signature_desc,
+            D3D_ROOT_SIGNATURE_VERSION_1,
+            &root_signature,
+            &error
+        )))
+    {
+        spdlog::error(
+            "ForwardPass::init_meshlet_pipelines: failed to serialize root signature: {}",
+            static_cast<char *>(error->GetBufferPointer())
+        );
+        return false;
+    }
+    DXERR(
+        m_rhi->device()->CreateRootSignature(
+            0,
+            root_signature->GetBufferPointer(),
+            root_signature->GetBufferSize(),
+            IID_PPV_ARGS(&m_meshlet_root_signature)
+        ),
+        "ForwardPass::init_meshlet_pipelines: failed to create root signature"
+    );
+
+    if (!create_meshlet_pipeline(
+            as_code,
+            ms_code,
+            ps_code,
+            COLOR_TARGET_FORMATS,
+            m_meshlet_pipeline
+        ) ||
+        !create_meshlet_pipeline(
+            as_code,
+            ms_code,
+            gbuffer_ps_code,
+            GBUFFER_FORMATS,
+            m_gbuffer_meshlet_pipeline
+        ))
+    {
+        spdlog::error("ForwardPass::init_meshlet_pipelines: failed to create pipeline states");
+        return false;
+    }
+    spdlog::trace("ForwardPass::init_meshlet_pipelines: created pipeline states");
+
+    return true;
+}
+
+bool ForwardPass::create_meshlet_pipeline(
+    std::span<const uint8_t> as_code, std::span<const uint8_t> ms_code,
+    std::span<const uint8_t> ps_code, std::span<const DXGI_FORMAT> render_target_formats,
+    ComPtr<ID3D12PipelineState> &out_pipeline
+)
+{
+    // Same state as the input assembler pipelines.
+    CD3DX12_RASTERIZER_DESC rasterizer(CD3DX12_DEFAULT{});
+    rasterizer.FrontCounterClockwise = TRUE;
+    D3D12_RT_FORMAT_ARRAY rt_formats{};
+    rt_formats.NumRenderTargets = static_cast<UINT>(render_target_formats.size());
+    std::copy(render_target_formats.begin(), render_target_formats.end(), rt_formats.RTFormats);
+
+    MeshletPipelineStream stream{};
+    stream.root_signature = m_meshlet_root_signature.Get();
+    stream.as = CD3DX12_SHADER_BYTECODE(as_code.data(), as_code.size());
+    stream.ms = CD3DX12_SHADER_BYTECODE(ms_code.data(), ms_code.size());
+    stream.ps = CD3DX12_SHADER_BYTECODE(ps_code.data(), ps_code.size());
+    stream.rasterizer = rasterizer;
+    stream.depth_stencil = CD3DX12_DEPTH_STENCIL_DESC(CD3DX12_DEFAULT{});
+    stream.render_target_formats = rt_formats;
+    stream.depth_stencil_format = DXGI_FORMAT_D32_FLOAT;
+
+    D3D12_PIPELINE_STATE_STREAM_DESC stream_desc{
+        .SizeInBytes = sizeof(stream),
+        .pPipelineStateSubobjectStream = &stream,
     };
+    DXERR(
+        m_rhi->device()->CreatePipelineState(&stream_desc, IID_PPV_ARGS(&out_pipeline)),
+        "ForwardPass::create_meshlet_pipeline: failed to create pipeline state"
+    );
+
+    return true;
+}
 
-    D3D12_GRAPHICS_PIPELINE_STATE_DESC pipeline_desc{};
-    pipeline_desc.pRootSignature = m_root_signature.Get();
-    pipeline_desc.VS = {vs_code.data(), vs_code.size()};
-    pipeline_desc.PS = {ps_code.data(), ps_code.size()};
-    pipeline_desc.BlendState = CD3DX12_BLEND_DESC(CD3DX12_DEFAULT());
-    pipeline_desc.SampleMask = ~0u;
-    pipeline_desc.RasterizerState = CD3DX12_RASTERIZER_DESC(CD3DX12_DEFAULT());
-    pipeline_desc.RasterizerState.FrontCounterClockwise = TRUE;
-    pipeline_desc.DepthStencilState = CD3DX12_DEPTH_STENCIL_DESC(CD3DX12_DEFAULT());
-    pipeline_desc.InputLayout = {vertex_layout.data(), static_cast<UINT>(vertex_layout.size())};
-    pipeline_desc.PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;
-    pipeline_desc.NumRenderTargets = 1;
-    pipeline_desc.RTVFormats[0] = DXGI_FORMAT_R16G16B16A16_FLOAT;
-    pipeline_desc.DSVFormat = DXGI_FORMAT_D32_FLOAT;
-    pipeline_desc.SampleDesc = {1, 0};
+bool ForwardPass::reserve_draw_constants(size_t draw_count)
+{
+    UINT frame = m_rhi->current_frame_index();
+    if (m_draw_constants_capacity[frame] >= draw_count)
+    {
+        return true;
+    }
+
+    // The GPU is done with the buffer of this frame, so it can be replaced right away.
+    size_t capacity = std::max(draw_count, 2 * m_draw_constants_capacity[frame]);
+    m_draw_constants[frame].Reset();
+    m_mapped_draw_constants[frame] = nullptr;
+    m_draw_constants_capacity[frame] = 0;
+    if (!m_rhi->create_buffer(
+            capacity * DRAW_CONSTANTS_STRIDE,
+            D3D12_RESOURCE_STATE_GENERIC_READ,
+            D3D12_HEAP_TYPE_UPLOAD,
+            MemoryCategory::Constants,
+            m_draw_constants[frame]
+        ))
+    {
+        spdlog::error("ForwardPass::reserve_draw_constants: failed to create buffer");
+        return false;
+    }
+    m_draw_constants[frame]->SetName(L"forward draw constants");
+
+    // Upload heaps stay mapped for their whole lifetime, the CPU never reads from them.
+    D3D12_RANGE read_range{.Begin = 0, .End = 0};
     DXERR(
-        m_rhi->device()->CreateGraphicsPipelineState(&pipeline_desc, IID_PPV_ARGS(&m_pipeline)),
-        "ForwardPass::init: failed to create pipeline state"
+        m_draw_constants[frame]->Map(
+            0,
+            &read_range,
+            reinterpret_cast<void **>(&m_mapped_draw_constants[frame])
+        ),
+        "ForwardPass::reserve_draw_constants: failed to map buffer"
     );
-    spdlog::trace("ForwardPass::init: created pipeline state");
+    m_draw_constants_capacity[frame] = capacity;
 
     return true;
 }
 
+void ForwardPass::set_predicate(
+    ID3D12GraphicsCommandList *cmd_list, const RunData &run_data, const DrawItem &draw
+)
+{
+    if (run_data.predicates)
+    {
+        cmd_list->SetPredication(
+            run_data.predicates,
+            run_data.predicates_offset + draw.object_idx * sizeof(uint64_t),
+            D3D12_PREDICATION_OP_EQUAL_ZERO
+        );
+    }
+}
+
+void ForwardPass::draw_meshlets(
+    ID3D12GraphicsCommandList *cmd_list, const RunData &run_data, ConstantBuffer &constants
+)
+{
+    if (run_data.draws.empty())
+    {
+        return;
+    }
+    if (!reserve_draw_constants(run_data.draws.size()))
+    {
+        spdlog::error("ForwardPass::draw_meshlets: failed to reserve draw constants");
+        return;
+    }
+    ComPtr<ID3D12GraphicsCommandList6> mesh_cmd_list;
+    if (FAILED(cmd_list->QueryInterface(IID_PPV_ARGS(&mesh_cmd_list))))
+    {
+        spdlog::error("ForwardPass::draw_meshlets: command list does not support mesh shaders");
+        return;
+    }
+
+    UINT frame = m_rhi->current_frame_index();
+    D3D12_GPU_VIRTUAL_ADDRESS draw_constants_address =
+        m_draw_constants[frame]->GetGPUVirtualAddress();
+
+    cmd_list->SetGraphicsRootSignature(m_meshlet_root_signature.Get());
+    cmd_list->SetPipelineState(
+        run_data.write_gbuffer ? m_gbuffer_meshlet_pipeline.Get() : m_meshlet_pipeline.Get()
+    );
+
+    for (size_t draw_idx = 0; draw_idx < run_data.draws.size(); ++draw_idx)
+    {
+        const DrawItem &draw = run_data.draws[draw_idx];
+        if (draw.meshlet_count == 0)
+        {
+            continue;
+        }
+        const Mesh &mesh = run_data.meshes[draw.mesh_idx];
+        const Material &material = run_data.materials[draw.material_idx];
+
+        constants.model = draw.model * mesh.position_transform;
+        constants.material_offset = material.srv_offset;
+        std::memcpy(
+            m_mapped_draw_constants[frame] + draw_idx * DRAW_CONSTANTS_STRIDE,
+            &constants,
+            sizeof(constants)
+        );
+        cmd_list->SetGraphicsRootConstantBufferView(
+            0, draw_constants_address + draw_idx * DRAW_CONSTANTS_STRIDE
+        );
+
+        MeshletConstants meshlet_constants_data = meshlet_constants(
+            mesh, draw, constants.proj_view, glm::vec4(constants.eye, 1.0f)
+        );
+        cmd_list->SetGraphicsRoot32BitConstants(
+            1, CONSTANTS_SIZE(MeshletConstants), &meshlet_constants_data, 0
+        );
+        set_predicate(cmd_list, run_data, draw);
+        mesh_cmd_list->DispatchMesh(
+            (draw.meshlet_count + MESHLET_CULL_GROUP_SIZE - 1) / MESHLET_CULL_GROUP_SIZE, 1, 1
+        );
+    }
+}
+
 void ForwardPass::run(ID3D12GraphicsCommandList *cmd_list, const RunData &run_data)
 {
     ZoneScoped;
@@ -172,23 +453,40 @@ void ForwardPass::run(ID3D12GraphicsCommandList *cmd_list, const RunData &run_da
         .sun_color = run_data.scene.sun.color,
 
         .shadow_map_idx = run_data.shadow_map_srv_idx,
-        .environment_idx = run_data.environment_srv_idx,
+        .ibl_idx = run_data.ibl_cbv_idx,
         .lights_buffer_idx = run_data.lights_buffer_cbv_idx,
     };
 
-    cmd_list->ClearDepthStencilView(
-        run_data.depth_target_dsv,
-        D3D12_CLEAR_FLAG_DEPTH,
-        1.0f,
-        0,
-        0,
-        nullptr
-    );
+    if (run_data.clear_targets)
+    {
+        cmd_list->ClearDepthStencilView(
+            run_data.depth_target_dsv,
+            D3D12_CLEAR_FLAG_DEPTH,
+            1.0f,
+            0,
+            0,
+            nullptr
+        );
+    }
 
-    cmd_list->SetGraphicsRootSignature(m_root_signature.Get());
-    cmd_list->SetPipelineState(m_pipeline.Get());
-    cmd_list->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-    cmd_list->OMSetRenderTargets(1, &run_data.color_target_rtv, FALSE, &run_data.depth_target_dsv);
+    if (run_data.write_gbuffer)
+    {
+        cmd_list->OMSetRenderTargets(
+            static_cast<UINT>(run_data.gbuffer_rtvs.size()),
+            run_data.gbuffer_rtvs.data(),
+            FALSE,
+            &run_data.depth_target_dsv
+        );
+    }
+    else
+    {
+        cmd_list->OMSetRenderTargets(
+            1,
+            &run_data.color_target_rtv,
+            FALSE,
+            &run_data.depth_target_dsv
+        );
+    }
 
     D3D12_VIEWPORT viewport{
         .TopLeftX = 0.0f,
@@ -207,22 +505,57 @@ void ForwardPass::run(ID3D12GraphicsCommandList *cmd_list, const RunData &run_da
     };
     cmd_list->RSSetScissorRects(1, &scissor);
 
+    if (run_data.use_mesh_shaders)
+    {
+        ZoneScopedN("Meshlet Draw Loop");
+        draw_meshlets(cmd_list, run_data, constants);
+    }
+    else
     {
         ZoneScopedN("Draw Loop");
-        for (const Object &obj : run_data.scene.objects)
+        cmd_list->SetGraphicsRootSignature(m_root_signature.Get());
+        cmd_list->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+
+        const Pipelines &pipelines = run_data.write_gbuffer ? m_gbuffer_pipelines : m_pipelines;
+        ID3D12PipelineState *bound_pipeline = nullptr;
+        for (size_t draw_idx = 0; draw_idx < run_data.draws.size(); ++draw_idx)
         {
-            const Mesh &mesh = run_data.meshes[obj.mesh_idx];
-            const Material &material = run_data.materials[mesh.material_idx];
-            constants.model = obj.trs;
+            const DrawItem &draw = run_data.draws[draw_idx];
+            const Mesh &mesh = run_data.meshes[draw.mesh_idx];
+            const Material &material = run_data.materials[draw.material_idx];
+            ID3D12PipelineState *pipeline =
+                pipelines[static_cast<size_t>(mesh.position_format)].Get();
+            if (pipeline != bound_pipeline)
+            {
+                cmd_list->SetPipelineState(pipeline);
+                bound_pipeline = pipeline;
+            }
+
+            constants.model = draw.model * mesh.position_transform;
             constants.material_offset = material.srv_offset;
 
             cmd_list
                 ->SetGraphicsRoot32BitConstants(0, CONSTANTS_SIZE(ConstantBuffer), &constants, 0);
-            cmd_list->IASetVertexBuffers(0, 1, &mesh.vertex_buffer_view);
+            std::array vertex_buffer_views{
+                mesh.position_buffer_view,
+                mesh.attribute_buffer_view,
+            };
+            cmd_list->IASetVertexBuffers(
+                0,
+                static_cast<UINT>(vertex_buffer_views.size()),
+                vertex_buffer_views.data()
+            );
             cmd_list->IASetIndexBuffer(&mesh.index_buffer_view);
-            cmd_list->DrawIndexedInstanced(mesh.index_count, 1, 0, 0, 0);
+            set_predicate(cmd_list, run_data, draw);
+            cmd_list->DrawIndexedInstanced(draw.index_count, 1, draw.first_index, 0, 0);
         }
     }
+
+    // Predication also applies to clears and copies of the passes after this one.
+    if (run_data.predicates)
+    {
+        cmd_list->SetPredication(nullptr, 0, D3D12_PREDICATION_OP_EQUAL_ZERO);
+    }
 }
 
 } // namespace Arctic::Renderer
@@ -1,16 +1,22 @@
 #pragma once
 
+#include <array>
 #include <span>
 
 #include <d3d12.h>
 
 #include "comptr.hpp"
+#include "deferred_lighting_pass.hpp"
+#include "draw_list.hpp"
+#include "mesh.hpp"
 #include "rhi.hpp"
 #include "scene.hpp"
 
 namespace Arctic::Renderer
 {
 
+// Draws the scene, either shading every pixel with all lights or, for the deferred path, writing
+// the surface attributes into the G-buffer for `DeferredLightingPass`.
 class ForwardPass
 {
     struct ConstantBuffer
@@ -26,7 +32,7 @@ class ForwardPass
         glm::vec3 sun_color;
 
         uint32_t shadow_map_idx;
-        uint32_t environment_idx;
+        uint32_t ibl_idx;
         uint32_t material_offset;
         uint32_t lights_buffer_idx;
 
@@ -38,26 +44,58 @@ class ForwardPass
         "Size of ForwardPass::ConstantBuffer is not a multiple of 4"
     );
 
+    // Distance between the constants of two draws in the mesh shader path.
+    static constexpr size_t DRAW_CONSTANTS_STRIDE =
+        (sizeof(ConstantBuffer) + D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT - 1) /
+        D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT *
+        D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT;
+
   public:
     struct RunData
     {
         D3D12_CPU_DESCRIPTOR_HANDLE color_target_rtv;
+        // Written instead of the color target if `write_gbuffer` is set, in the order of
+        // `GBUFFER_FORMATS`.
+        std::array<D3D12_CPU_DESCRIPTOR_HANDLE, GBUFFER_FORMATS.size()> gbuffer_rtvs;
         D3D12_CPU_DESCRIPTOR_HANDLE depth_target_dsv;
         uint32_t viewport_width;
         uint32_t viewport_height;
         uint32_t shadow_map_srv_idx;
-        uint32_t environment_srv_idx;
+        uint32_t ibl_cbv_idx;
         uint32_t lights_buffer_cbv_idx;
         std::span<Mesh> meshes;
         std::span<Material> materials;
+        std::span<const DrawItem> draws;
         const Scene &scene;
+        bool use_mesh_shaders;
+        bool write_gbuffer;
+        // The late phase of occlusion culling draws on top of the early one.
+        bool clear_targets;
+        // If set, every draw is skipped when the 64 bit value of its object at
+        // `predicates_offset` is zero.
+        ID3D12Resource *predicates;
+        uint64_t predicates_offset;
     };
 
   private:
     RHI *m_rhi;
 
+    using Pipelines = std::array<ComPtr<ID3D12PipelineState>, VERTEX_POSITION_FORMATS.size()>;
+
     ComPtr<ID3D12RootSignature> m_root_signature;
-    ComPtr<ID3D12PipelineState> m_pipeline;
+    // One for each vertex position format.
+    Pipelines m_pipelines;
+    Pipelines m_gbuffer_pipelines;
+
+    // The mesh shader path reads the scene constants through a root constant buffer view, since
+    // they do not fit into root constants next to `MeshletConstants`. Every draw gets its own copy
+    // in an upload buffer, one per frame in flight.
+    ComPtr<ID3D12RootSignature> m_meshlet_root_signature;
+    ComPtr<ID3D12PipelineState> m_meshlet_pipeline;
+    ComPtr<ID3D12PipelineState> m_gbuffer_meshlet_pipeline;
+    std::array<ComPtr<ID3D12Resource>, RHI::NUM_FRAMES> m_draw_constants;
+    std::array<uint8_t *, RHI::NUM_FRAMES> m_mapped_draw_constants{};
+    std::array<size_t, RHI::NUM_FRAMES> m_draw_constants_capacity{};
 
     ForwardPass() = delete;
     ForwardPass(const ForwardPass &) = delete;
@@ -70,9 +108,38 @@ class ForwardPass
     {
     }
 
-    [[nodiscard]] bool init();
+    // The mesh shader pipelines are only created if `mesh_shaders` is set, and `use_mesh_shaders`
+    // may only be set if they were.
+    [[nodiscard]] bool init(bool mesh_shaders);
 
     void run(ID3D12GraphicsCommandList *cmd_list, const RunData &run_data);
+
+  private:
+    [[nodiscard]] bool init_pipelines(
+        std::span<const uint8_t> vs_code, std::span<const uint8_t> ps_code,
+        std::span<const DXGI_FORMAT> render_target_formats, Pipelines &out_pipelines
+    );
+
+    [[nodiscard]] bool init_meshlet_pipelines(
+        std::span<const uint8_t> ps_code, std::span<const uint8_t> gbuffer_ps_code
+    );
+
+    [[nodiscard]] bool create_meshlet_pipeline(
+        std::span<const uint8_t> as_code, std::span<const uint8_t> ms_code,
+        std::span<const uint8_t> ps_code, std::span<const DXGI_FORMAT> render_target_formats,
+        ComPtr<ID3D12PipelineState> &out_pipeline
+    );
+
+    // Makes room for the constants of `draw_count` draws in the buffer of the current frame.
+    [[nodiscard]] bool reserve_draw_constants(size_t draw_count);
+
+    void draw_meshlets(
+        ID3D12GraphicsCommandList *cmd_list, const RunData &run_data, ConstantBuffer &constants
+    );
+
+    static void set_predicate(
+        ID3D12GraphicsCommandList *cmd_list, const RunData &run_data, const DrawItem &draw
+    );
 };
 
 } // namespace Arctic::Renderer
@@ -0,0 +1,123 @@
+#include "frame_graph.hpp"
+
+namespace Arctic::Renderer
+{
+
+FrameGraphHandles declare_frame_graph(
+    RenderGraph &graph, const FrameGraphResources &resources, FrameGraphPasses &&passes
+)
+{
+    FrameGraphHandles handles{
+        .sun_shadow_map = graph.import_resource(
+            "sun shadow map",
+            resources.sun_shadow_map,
+            ResourceState::DepthWrite
+        ),
+        .color_target = graph.create_transient("forward color target", resources.color_target),
+        .depth_target = graph.create_transient("forward depth target", resources.depth_target),
+        // Released after the occlusion cull pass, so on the deferred path the color target, which
+        // is first written by the lighting pass, shares its memory.
+        .hiz = graph.create_transient("hiz", resources.hiz),
+        // Recreated in the state it is left in at the end of a frame.
+        .occlusion_predicates = graph.import_resource(
+            "occlusion predicates",
+            resources.occlusion_predicates,
+            ResourceState::IndirectArgument
+        ),
+        // Never recreated, so the graph keeps track of its state after the first frame.
+        .exposure = graph.import_resource(
+            "exposure",
+            resources.exposure,
+            ResourceState::UnorderedAccess
+        ),
+        .backbuffer = graph.import_resource(
+            "backbuffer",
+            resources.backbuffer,
+            ResourceState::Present,
+            ResourceState::Present
+        ),
+        .gbuffer = std::nullopt,
+    };
+
+    if (resources.gbuffer)
+    {
+        handles.gbuffer = GBufferHandles{
+            .base_color =
+                graph.create_transient("gbuffer base color", resources.gbuffer->base_color),
+            .normal = graph.create_transient("gbuffer normal", resources.gbuffer->normal),
+            .metalness_roughness = graph.create_transient(
+                "gbuffer metalness roughness",
+                resources.gbuffer->metalness_roughness
+            ),
+        };
+    }
+
+    // The forward and deferred paths share the depth target and both phases of occlusion
+    // culling, they only differ in what the draws write and who shades them.
+    auto add_draw_pass = [&](const char *name, std::function<void()> &&fn) {
+        // Predicates are read in the indirect argument state, which is the predication state.
+        RenderGraph::PassBuilder pass = graph.add_pass(name, std::move(fn));
+        pass.read(handles.occlusion_predicates, ResourceState::IndirectArgument)
+            .write(handles.depth_target, ResourceState::DepthWrite);
+        if (handles.gbuffer)
+        {
+            pass.write(handles.gbuffer->base_color, ResourceState::RenderTarget)
+                .write(handles.gbuffer->normal, ResourceState::RenderTarget)
+                .write(handles.gbuffer->metalness_roughness, ResourceState::RenderTarget);
+        }
+        else
+        {
+            pass.read(handles.sun_shadow_map, ResourceState::PixelShaderResource)
+                .write(handles.color_target, ResourceState::RenderTarget);
+        }
+    };
+
+    graph.add_pass("shadow map", std::move(passes.shadow_map))
+        .write(handles.sun_shadow_map, ResourceState::DepthWrite);
+
+    add_draw_pass(handles.gbuffer ? "gbuffer" : "forward", std::move(passes.forward));
+
+    graph.add_pass("hiz", std::move(passes.hiz))
+        .read(handles.depth_target, ResourceState::NonPixelShaderResource)
+        .write(handles.hiz, ResourceState::UnorderedAccess);
+
+    graph.add_pass("occlusion cull", std::move(passes.occlusion_cull))
+        .read(handles.hiz, ResourceState::NonPixelShaderResource)
+        .write(handles.occlusion_predicates, ResourceState::UnorderedAccess);
+
+    add_draw_pass(
+        handles.gbuffer ? "gbuffer late" : "forward late",
+        std::move(passes.forward_late)
+    );
+
+    if (handles.gbuffer)
+    {
+        graph.add_pass("deferred lighting", std::move(passes.deferred_lighting))
+            .read(handles.gbuffer->base_color, ResourceState::NonPixelShaderResource)
+            .read(handles.gbuffer->normal, ResourceState::NonPixelShaderResource)
+            .read(handles.gbuffer->metalness_roughness, ResourceState::NonPixelShaderResource)
+            .read(handles.depth_target, ResourceState::NonPixelShaderResource)
+            .read(handles.sun_shadow_map, ResourceState::NonPixelShaderResource)
+            .write(handles.color_target, ResourceState::UnorderedAccess);
+    }
+
+    graph.add_pass("skybox", std::move(passes.skybox))
+        .write(handles.color_target, ResourceState::RenderTarget)
+        .write(handles.depth_target, ResourceState::DepthWrite);
+
+    graph.add_pass("auto exposure", std::move(passes.auto_exposure))
+        .read(handles.color_target, ResourceState::NonPixelShaderResource)
+        .write(handles.exposure, ResourceState::UnorderedAccess);
+
+    graph.add_pass("post process", std::move(passes.post_process))
+        .read(handles.color_target, ResourceState::PixelShaderResource)
+        .read(handles.exposure, ResourceState::PixelShaderResource)
+        .write(handles.backbuffer, ResourceState::RenderTarget);
+
+    graph.add_pass("imgui", std::move(passes.imgui))
+        .write(handles.backbuffer, ResourceState::RenderTarget);
+
+    return handles;
+}
+
+} // namespace Arctic::Renderer
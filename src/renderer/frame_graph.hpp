@@ -0,0 +1,77 @@
+#pragma once
+
+#include <functional>
+#include <optional>
+
+#include "render_graph.hpp"
+
+namespace Arctic::Renderer
+{
+
+// Targets the deferred path draws into instead of shading, see `GBUFFER_FORMATS`.
+struct GBufferDescs
+{
+    TransientDesc base_color;
+    TransientDesc normal;
+    TransientDesc metalness_roughness;
+};
+
+struct GBufferHandles
+{
+    ResourceHandle base_color;
+    ResourceHandle normal;
+    ResourceHandle metalness_roughness;
+};
+
+struct FrameGraphResources
+{
+    void *sun_shadow_map;
+    void *backbuffer;
+    void *occlusion_predicates;
+    void *exposure;
+    TransientDesc color_target;
+    TransientDesc depth_target;
+    // Depth pyramid of the depth target, only needed until the occlusion cull pass has read it.
+    TransientDesc hiz;
+    // Only set for the deferred path.
+    std::optional<GBufferDescs> gbuffer;
+};
+
+struct FrameGraphPasses
+{
+    std::function<void()> shadow_map;
+    // Draws what was visible in the previous frame, into the color target or, for the deferred
+    // path, into the G-buffer.
+    std::function<void()> forward;
+    std::function<void()> hiz;
+    std::function<void()> occlusion_cull;
+    // Draws what turned visible in this frame.
+    std::function<void()> forward_late;
+    // Shades the G-buffer into the color target. Only declared for the deferred path.
+    std::function<void()> deferred_lighting;
+    std::function<void()> skybox;
+    // Measures the finished color target and adapts the exposure the post process applies.
+    std::function<void()> auto_exposure;
+    std::function<void()> post_process;
+    std::function<void()> imgui;
+};
+
+struct FrameGraphHandles
+{
+    ResourceHandle sun_shadow_map;
+    ResourceHandle color_target;
+    ResourceHandle depth_target;
+    ResourceHandle hiz;
+    ResourceHandle occlusion_predicates;
+    ResourceHandle exposure;
+    ResourceHandle backbuffer;
+    std::optional<GBufferHandles> gbuffer;
+};
+
+// Declares the resources and passes of a frame. Shared by the D3D12 renderer and the null backend
+// so both produce the same barriers and transient layout; only the pass bodies differ.
+FrameGraphHandles declare_frame_graph(
+    RenderGraph &graph, const FrameGraphResources &resources, FrameGraphPasses &&passes
+);
+
+} // namespace Arctic::Renderer
@@ -0,0 +1,127 @@
+#include "frame_pacer.hpp"
+
+#include <algorithm>
+#include <thread>
+
+#include <spdlog/spdlog.h>
+
+#include "tracy/Tracy.hpp"
+
+#include "dxerr.hpp"
+
+namespace Arctic::Renderer
+{
+
+FramePacer::~FramePacer()
+{
+    if (m_waitable_object)
+    {
+        CloseHandle(m_waitable_object);
+    }
+}
+
+bool FramePacer::init(IDXGISwapChain2 *swapchain, bool allow_tearing)
+{
+    m_swapchain = swapchain;
+    m_allow_tearing = allow_tearing;
+
+    DXERR(
+        m_swapchain->SetMaximumFrameLatency(m_settings.max_frame_latency),
+        "FramePacer::init: failed to set maximum frame latency"
+    );
+
+    m_waitable_object = m_swapchain->GetFrameLatencyWaitableObject();
+    if (!m_waitable_object)
+    {
+        spdlog::error("FramePacer::init: failed to get frame latency waitable object");
+        return false;
+    }
+
+    m_frame_begin_time = Clock::now();
+    m_last_frame_begin_time = m_frame_begin_time;
+
+    return true;
+}
+
+bool FramePacer::set_settings(const FramePacingSettings &settings)
+{
+    FramePacingSettings new_settings = settings;
+    new_settings.max_frame_latency =
+        std::clamp(new_settings.max_frame_latency, 1u, static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT));
+    new_settings.fps_cap = std::max(new_settings.fps_cap, 0.0f);
+
+    if (new_settings.max_frame_latency != m_settings.max_frame_latency)
+    {
+        DXERR(
+            m_swapchain->SetMaximumFrameLatency(new_settings.max_frame_latency),
+            "FramePacer::set_settings: failed to set maximum frame latency"
+        );
+    }
+
+    m_settings = new_settings;
+    return true;
+}
+
+void FramePacer::wait_for_next_frame()
+{
+    ZoneScoped;
+
+    Clock::time_point wait_begin = Clock::now();
+
+    {
+        ZoneScopedN("Wait For Swapchain");
+        WaitForSingleObjectEx(m_waitable_object, 1000, TRUE);
+    }
+
+    if (m_settings.fps_cap > 0.0f)
+    {
+        ZoneScopedN("Frame Rate Limit");
+
+        auto frame_duration = std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<float>(1.0f / m_settings.fps_cap)
+        );
+        Clock::time_point target = m_last_frame_begin_time + frame_duration;
+
+        // Sleeping is too coarse to hit the target exactly, so sleep until shortly before it and
+        // spin for the remainder.
+        constexpr auto SPIN_THRESHOLD = std::chrono::milliseconds(2);
+        if (target - Clock::now() > SPIN_THRESHOLD)
+        {
+            std::this_thread::sleep_for(target - Clock::now() - SPIN_THRESHOLD);
+        }
+        while (Clock::now() < target)
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    m_frame_begin_time = Clock::now();
+    m_stats.cpu_wait_ms =
+        std::chrono::duration<float, std::milli>(m_frame_begin_time - wait_begin).count();
+    m_last_frame_begin_time = m_frame_begin_time;
+}
+
+void FramePacer::frame_submitted(size_t frame_idx, uint64_t fence_value)
+{
+    m_in_flight[frame_idx % MAX_FRAMES_IN_FLIGHT] = InFlightFrame{
+        .begin_time = m_frame_begin_time,
+        .fence_value = fence_value,
+        .pending = true,
+    };
+}
+
+void FramePacer::poll_completed_frames(uint64_t completed_fence_value)
+{
+    Clock::time_point now = Clock::now();
+    for (InFlightFrame &frame : m_in_flight)
+    {
+        if (frame.pending && frame.fence_value <= completed_fence_value)
+        {
+            m_stats.estimated_latency_ms =
+                std::chrono::duration<float, std::milli>(now - frame.begin_time).count();
+            frame.pending = false;
+        }
+    }
+}
+
+} // namespace Arctic::Renderer
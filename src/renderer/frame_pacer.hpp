@@ -0,0 +1,109 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+#include <dxgi1_6.h>
+
+#include "frame_stats.hpp"
+
+namespace Arctic::Renderer
+{
+
+enum class VsyncMode : int
+{
+    Off = 0,
+    On = 1,
+    // Present every second vertical blank, i.e. half the refresh rate.
+    Half = 2,
+};
+
+struct FramePacingSettings
+{
+    VsyncMode vsync{VsyncMode::Off};
+    // Maximum number of frames the CPU may queue ahead of the display.
+    uint32_t max_frame_latency{2};
+    // Frame rate limit in frames per second, 0 means unlimited.
+    float fps_cap{0.0f};
+};
+
+class FramePacer
+{
+    using Clock = std::chrono::high_resolution_clock;
+
+    static constexpr size_t MAX_FRAMES_IN_FLIGHT = 3;
+
+    struct InFlightFrame
+    {
+        Clock::time_point begin_time;
+        uint64_t fence_value{0};
+        bool pending{false};
+    };
+
+    IDXGISwapChain2 *m_swapchain{nullptr};
+    HANDLE m_waitable_object{nullptr};
+    bool m_allow_tearing{false};
+
+    FramePacingSettings m_settings;
+    FramePacingStats m_stats;
+
+    Clock::time_point m_frame_begin_time;
+    Clock::time_point m_last_frame_begin_time;
+
+    std::array<InFlightFrame, MAX_FRAMES_IN_FLIGHT> m_in_flight{};
+
+    FramePacer(const FramePacer &) = delete;
+    FramePacer &operator=(const FramePacer &) = delete;
+    FramePacer(FramePacer &&) = delete;
+    FramePacer &operator=(FramePacer &&) = delete;
+
+  public:
+    FramePacer() = default;
+
+    ~FramePacer();
+
+    [[nodiscard]] bool init(IDXGISwapChain2 *swapchain, bool allow_tearing);
+
+    // Blocks until the swapchain is ready to accept a new frame and the frame rate limit allows
+    // starting the next one. Should be called before input is processed for the frame.
+    void wait_for_next_frame();
+
+    void record_gpu_wait(std::chrono::duration<float, std::milli> duration)
+    {
+        m_stats.gpu_wait_ms = duration.count();
+    }
+
+    // Remembers which fence value signals the completion of the frame started by the last call to
+    // `wait_for_next_frame`.
+    void frame_submitted(size_t frame_idx, uint64_t fence_value);
+
+    // Updates the latency estimate for all frames whose fence value has been reached.
+    void poll_completed_frames(uint64_t completed_fence_value);
+
+    [[nodiscard]] UINT sync_interval() const
+    {
+        return static_cast<UINT>(m_settings.vsync);
+    }
+
+    [[nodiscard]] UINT present_flags() const
+    {
+        // Tearing is only allowed with a sync interval of 0.
+        return m_allow_tearing && m_settings.vsync == VsyncMode::Off ? DXGI_PRESENT_ALLOW_TEARING
+                                                                     : 0;
+    }
+
+    [[nodiscard]] const FramePacingSettings &settings() const
+    {
+        return m_settings;
+    }
+
+    [[nodiscard]] bool set_settings(const FramePacingSettings &settings);
+
+    [[nodiscard]] const FramePacingStats &stats() const
+    {
+        return m_stats;
+    }
+};
+
+} // namespace Arctic::Renderer
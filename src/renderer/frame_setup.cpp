@@ -0,0 +1,61 @@
+#include "frame_setup.hpp"
+
+namespace Arctic::Renderer
+{
+
+void setup_frame(
+    const Scene &scene, const Settings &settings, uint32_t viewport_height,
+    std::span<const MeshDrawInfo> meshes, size_t material_count,
+    std::span<const StreamedTextureDesc> textures, SoftwareOcclusionCuller &software_occlusion,
+    TextureStreamingPolicy &texture_streaming, FrameSetup &out_frame
+)
+{
+    out_frame.software_visibility.clear();
+    if (settings.software_occlusion)
+    {
+        software_occlusion.cull(
+            scene.objects, meshes, scene.camera, out_frame.software_visibility
+        );
+    }
+    build_draw_list(
+        scene.objects,
+        meshes,
+        lod_selection(scene.camera, viewport_height, LOD_PIXEL_ERROR),
+        out_frame.draws,
+        out_frame.software_visibility
+    );
+    // The shadow map is rendered from the sun, but its texels end up on the screen, so its
+    // levels of detail are selected from the camera as well. Objects hidden from the camera
+    // still cast shadows, so none of them are culled.
+    build_draw_list(
+        scene.objects,
+        meshes,
+        lod_selection(scene.camera, viewport_height, SHADOW_LOD_PIXEL_ERROR),
+        out_frame.shadow_draws
+    );
+
+    compute_material_screen_sizes(
+        out_frame.draws,
+        meshes,
+        scene.camera,
+        viewport_height,
+        material_count,
+        out_frame.material_screen_sizes
+    );
+    for (const StreamedTextureDesc &texture : textures)
+    {
+        texture_streaming.request(
+            texture.streaming_idx,
+            required_mip(
+                texture.size,
+                out_frame.material_screen_sizes[texture.material_idx],
+                texture.mip_count
+            )
+        );
+    }
+
+    out_frame.streaming_requests.clear();
+    texture_streaming.update(out_frame.streaming_requests);
+}
+
+} // namespace Arctic::Renderer
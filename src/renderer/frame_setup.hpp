@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "draw_list.hpp"
+#include "scene.hpp"
+#include "software_occlusion.hpp"
+#include "texture_streaming.hpp"
+
+namespace Arctic::Renderer
+{
+
+// A texture registered with the streaming policy, as far as picking its mip levels goes.
+struct StreamedTextureDesc
+{
+    MaterialIdx material_idx;
+    uint32_t streaming_idx;
+    // Larger side of the most detailed level, in texels.
+    uint32_t size;
+    uint32_t mip_count;
+};
+
+// What the device-free part of a frame produces. Kept from frame to frame, so the vectors keep
+// their capacity.
+struct FrameSetup
+{
+    // One entry per object, see `SoftwareOcclusionCuller::cull`. Empty if the software occlusion
+    // culling is off.
+    std::vector<uint8_t> software_visibility;
+    std::vector<DrawItem> draws;
+    std::vector<DrawItem> shadow_draws;
+    std::vector<float> material_screen_sizes;
+    // Residency changes the backend has to carry out by uploading the requested levels.
+    std::vector<StreamingRequest> streaming_requests;
+};
+
+// Runs the part of a frame that needs no device, shared by `Renderer` and `NullRenderer`: culls
+// the objects against the occluders rasterized on the CPU if `settings` ask for it, builds the
+// draw lists for a viewport `viewport_height` pixels high and requests the mip levels the drawn
+// materials need from `texture_streaming`.
+void setup_frame(
+    const Scene &scene, const Settings &settings, uint32_t viewport_height,
+    std::span<const MeshDrawInfo> meshes, size_t material_count,
+    std::span<const StreamedTextureDesc> textures, SoftwareOcclusionCuller &software_occlusion,
+    TextureStreamingPolicy &texture_streaming, FrameSetup &out_frame
+);
+
+} // namespace Arctic::Renderer
@@ -0,0 +1,28 @@
+#include "frame_stats.hpp"
+
+namespace Arctic::Renderer
+{
+
+const char *memory_category_name(MemoryCategory category)
+{
+    switch (category)
+    {
+        case MemoryCategory::Mesh:
+            return "Mesh";
+        case MemoryCategory::MaterialTexture:
+            return "Material Texture";
+        case MemoryCategory::Environment:
+            return "Environment";
+        case MemoryCategory::RenderTarget:
+            return "Render Target";
+        case MemoryCategory::Staging:
+            return "Staging";
+        case MemoryCategory::Constants:
+            return "Constants";
+        case MemoryCategory::Count:
+            break;
+    }
+    return "Unknown";
+}
+
+} // namespace Arctic::Renderer
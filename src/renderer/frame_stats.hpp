@@ -0,0 +1,73 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+namespace Arctic::Renderer
+{
+
+// Statistics the renderer reports every frame. Kept free of any D3D12 types so tools that only
+// record or format them, like the benchmark recorder, build without a device.
+
+enum class MemoryCategory : uint32_t
+{
+    Mesh,
+    MaterialTexture,
+    Environment,
+    RenderTarget,
+    Staging,
+    Constants,
+    Count,
+};
+
+[[nodiscard]] const char *memory_category_name(MemoryCategory category);
+
+struct MemoryCategoryStats
+{
+    uint64_t live_bytes{0};
+    uint64_t peak_bytes{0};
+    uint32_t live_allocations{0};
+};
+
+struct MemoryStats
+{
+    std::array<MemoryCategoryStats, static_cast<size_t>(MemoryCategory::Count)> categories{};
+    uint64_t total_live_bytes{0};
+    uint64_t total_peak_bytes{0};
+
+    // Budget and usage of video memory as reported by the OS for this process, including
+    // allocations that are not tracked, e.g. by the driver or the swapchain.
+    uint64_t local_budget{0};
+    uint64_t local_usage{0};
+    uint64_t non_local_budget{0};
+    uint64_t non_local_usage{0};
+
+    [[nodiscard]] const MemoryCategoryStats &operator[](MemoryCategory category) const
+    {
+        return categories[static_cast<size_t>(category)];
+    }
+};
+
+struct FramePacingStats
+{
+    // Time spent waiting on the swapchain's latency waitable object and the frame rate limiter.
+    float cpu_wait_ms{0.0f};
+    // Time spent waiting for the GPU to release the resources of the next frame.
+    float gpu_wait_ms{0.0f};
+    // Time from the start of a frame, when input is sampled, until the GPU finished rendering it.
+    float estimated_latency_ms{0.0f};
+};
+
+struct PassTiming
+{
+    std::string name;
+    // Time spent recording the commands of the pass, including its barriers.
+    float cpu_ms{0.0f};
+    // Time the GPU spent on the pass. Taken from the most recent frame whose timestamps have been
+    // read back, which is usually the previous one. Empty until the pass has been read back once.
+    std::optional<float> gpu_ms;
+};
+
+} // namespace Arctic::Renderer
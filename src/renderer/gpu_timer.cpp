@@ -0,0 +1,167 @@
+#include "gpu_timer.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include "dxerr.hpp"
+#include "rhi.hpp"
+
+namespace Arctic::Renderer
+{
+
+bool GpuTimer::init(RHI &rhi, ID3D12CommandQueue *queue)
+{
+    D3D12_QUERY_HEAP_DESC query_heap_desc{
+        .Type = D3D12_QUERY_HEAP_TYPE_TIMESTAMP,
+        .Count = QUERIES_PER_FRAME * MAX_FRAMES_IN_FLIGHT,
+        .NodeMask = 0,
+    };
+    DXERR(
+        rhi.device()->CreateQueryHeap(&query_heap_desc, IID_PPV_ARGS(&m_query_heap)),
+        "GpuTimer::init: failed to create query heap"
+    );
+    m_query_heap->SetName(L"timestamp query heap");
+
+    if (!rhi.create_buffer(
+            sizeof(uint64_t) * query_heap_desc.Count,
+            D3D12_RESOURCE_STATE_COPY_DEST,
+            D3D12_HEAP_TYPE_READBACK,
+            MemoryCategory::Staging,
+            m_readback_buffer
+        ))
+    {
+        spdlog::error("GpuTimer::init: failed to create readback buffer");
+        return false;
+    }
+    m_readback_buffer->SetName(L"timestamp readback buffer");
+
+    DXERR(
+        queue->GetTimestampFrequency(&m_timestamp_frequency),
+        "GpuTimer::init: failed to get timestamp frequency"
+    );
+
+    return true;
+}
+
+bool GpuTimer::collect(uint64_t completed_fence_value)
+{
+    // Only the newest completed frame is of interest, older ones are skipped.
+    FrameQueries *newest = nullptr;
+    size_t newest_idx = 0;
+    for (size_t frame_idx = 0; frame_idx < MAX_FRAMES_IN_FLIGHT; ++frame_idx)
+    {
+        FrameQueries &frame = m_frames[frame_idx];
+        if (!frame.pending || frame.fence_value > completed_fence_value)
+        {
+            continue;
+        }
+
+        frame.pending = false;
+        if (frame.fence_value > m_last_read_fence_value)
+        {
+            newest = &frame;
+            newest_idx = frame_idx;
+            m_last_read_fence_value = frame.fence_value;
+        }
+    }
+    if (!newest)
+    {
+        return true;
+    }
+
+    size_t num_queries = 2 * newest->scope_names.size();
+    D3D12_RANGE read_range{
+        .Begin = sizeof(uint64_t) * QUERIES_PER_FRAME * newest_idx,
+        .End = sizeof(uint64_t) * (QUERIES_PER_FRAME * newest_idx + num_queries),
+    };
+    void *mapped;
+    DXERR(
+        m_readback_buffer->Map(0, &read_range, &mapped),
+        "GpuTimer::collect: failed to map readback buffer"
+    );
+    const uint64_t *timestamps =
+        static_cast<const uint64_t *>(mapped) + QUERIES_PER_FRAME * newest_idx;
+
+    auto to_ms = [&](uint32_t scope) {
+        uint64_t begin = timestamps[2 * scope];
+        uint64_t end = timestamps[2 * scope + 1];
+        uint64_t ticks = end > begin ? end - begin : 0;
+        return static_cast<float>(
+            static_cast<double>(ticks) * 1000.0 / static_cast<double>(m_timestamp_frequency)
+        );
+    };
+
+    // Scope 0 is the frame scope.
+    m_frame_ms = to_ms(0);
+    m_results.clear();
+    for (uint32_t scope = 1; scope < newest->scope_names.size(); ++scope)
+    {
+        m_results.emplace_back(GpuTiming{
+            .name = newest->scope_names[scope],
+            .ms = to_ms(scope),
+        });
+    }
+
+    D3D12_RANGE write_range{.Begin = 0, .End = 0};
+    m_readback_buffer->Unmap(0, &write_range);
+
+    return true;
+}
+
+void GpuTimer::begin_frame(ID3D12GraphicsCommandList *cmd_list, size_t frame_idx)
+{
+    m_current_frame = frame_idx % MAX_FRAMES_IN_FLIGHT;
+    m_frames[m_current_frame].scope_names.clear();
+    m_frames[m_current_frame].pending = false;
+
+    begin_scope(cmd_list, "frame");
+}
+
+uint32_t GpuTimer::begin_scope(ID3D12GraphicsCommandList *cmd_list, std::string name)
+{
+    FrameQueries &frame = m_frames[m_current_frame];
+    if (frame.scope_names.size() >= MAX_SCOPES_PER_FRAME)
+    {
+        return UINT32_MAX;
+    }
+
+    uint32_t scope = static_cast<uint32_t>(frame.scope_names.size());
+    frame.scope_names.emplace_back(std::move(name));
+    cmd_list->EndQuery(
+        m_query_heap.Get(),
+        D3D12_QUERY_TYPE_TIMESTAMP,
+        QUERIES_PER_FRAME * static_cast<uint32_t>(m_current_frame) + 2 * scope
+    );
+    return scope;
+}
+
+void GpuTimer::end_scope(ID3D12GraphicsCommandList *cmd_list, uint32_t scope)
+{
+    if (scope == UINT32_MAX)
+    {
+        return;
+    }
+
+    cmd_list->EndQuery(
+        m_query_heap.Get(),
+        D3D12_QUERY_TYPE_TIMESTAMP,
+        QUERIES_PER_FRAME * static_cast<uint32_t>(m_current_frame) + 2 * scope + 1
+    );
+}
+
+void GpuTimer::end_frame(ID3D12GraphicsCommandList *cmd_list)
+{
+    end_scope(cmd_list, 0);
+
+    const FrameQueries &frame = m_frames[m_current_frame];
+    uint32_t first_query = QUERIES_PER_FRAME * static_cast<uint32_t>(m_current_frame);
+    cmd_list->ResolveQueryData(
+        m_query_heap.Get(),
+        D3D12_QUERY_TYPE_TIMESTAMP,
+        first_query,
+        2 * static_cast<uint32_t>(frame.scope_names.size()),
+        m_readback_buffer.Get(),
+        sizeof(uint64_t) * first_query
+    );
+}
+
+} // namespace Arctic::Renderer
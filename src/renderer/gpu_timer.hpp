@@ -0,0 +1,100 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <d3d12.h>
+
+#include "comptr.hpp"
+
+namespace Arctic::Renderer
+{
+
+class RHI;
+
+struct GpuTiming
+{
+    std::string name;
+    float ms{0.0f};
+};
+
+// Measures GPU durations of named scopes with timestamp queries. Every frame in flight has its own
+// range in the query heap and in a readback buffer the queries are resolved into. Results are
+// read back once the fence of a frame has been reached, which is usually one frame later.
+class GpuTimer
+{
+  public:
+    static constexpr size_t MAX_FRAMES_IN_FLIGHT = 3;
+    // Including the scope spanning the entire frame.
+    static constexpr uint32_t MAX_SCOPES_PER_FRAME = 32;
+
+  private:
+    static constexpr uint32_t QUERIES_PER_FRAME = 2 * MAX_SCOPES_PER_FRAME;
+
+    struct FrameQueries
+    {
+        std::vector<std::string> scope_names;
+        uint64_t fence_value{0};
+        bool pending{false};
+    };
+
+    ComPtr<ID3D12QueryHeap> m_query_heap;
+    ComPtr<ID3D12Resource> m_readback_buffer;
+    uint64_t m_timestamp_frequency{1};
+
+    std::array<FrameQueries, MAX_FRAMES_IN_FLIGHT> m_frames;
+    size_t m_current_frame{0};
+    uint64_t m_last_read_fence_value{0};
+
+    std::vector<GpuTiming> m_results;
+    float m_frame_ms{0.0f};
+
+    GpuTimer(const GpuTimer &) = delete;
+    GpuTimer &operator=(const GpuTimer &) = delete;
+    GpuTimer(GpuTimer &&) = delete;
+    GpuTimer &operator=(GpuTimer &&) = delete;
+
+  public:
+    GpuTimer() = default;
+
+    // The readback buffer is created through `rhi`, so it counts towards the staging memory.
+    [[nodiscard]] bool init(RHI &rhi, ID3D12CommandQueue *queue);
+
+    // Reads back the results of the most recently completed frame, if there is one that has not
+    // been read yet.
+    [[nodiscard]] bool collect(uint64_t completed_fence_value);
+
+    // Starts recording queries for the frame using the resources of `frame_idx`. The resources
+    // must not be in use by the GPU anymore.
+    void begin_frame(ID3D12GraphicsCommandList *cmd_list, size_t frame_idx);
+
+    // Returns the index of the new scope, or `UINT32_MAX` if the frame has no scopes left.
+    uint32_t begin_scope(ID3D12GraphicsCommandList *cmd_list, std::string name);
+
+    void end_scope(ID3D12GraphicsCommandList *cmd_list, uint32_t scope);
+
+    // Ends the frame scope and resolves all queries of the frame into the readback buffer.
+    void end_frame(ID3D12GraphicsCommandList *cmd_list);
+
+    void frame_submitted(uint64_t fence_value)
+    {
+        m_frames[m_current_frame].fence_value = fence_value;
+        m_frames[m_current_frame].pending = true;
+    }
+
+    // Durations of all scopes of the last frame that has been read back, except the frame scope.
+    [[nodiscard]] const std::vector<GpuTiming> &results() const
+    {
+        return m_results;
+    }
+
+    // Duration of the last frame that has been read back.
+    [[nodiscard]] float frame_ms() const
+    {
+        return m_frame_ms;
+    }
+};
+
+} // namespace Arctic::Renderer
@@ -0,0 +1,874 @@
+#include "ibl.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+
+#include <glm/geometric.hpp>
+#include <glm/vec2.hpp>
+#include <spdlog/spdlog.h>
+
+#include "../half_float.hpp"
+#include "../mapped_file.hpp"
+
+#if defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define ARCTIC_IBL_SSE2
+#endif
+
+namespace Arctic::Renderer
+{
+
+static constexpr float PI = 3.14159265f;
+
+// Texels of the source cubemap are processed in chunks of this many, each summed on its own and
+// the sums added in order, so the result does not depend on the number of threads.
+static constexpr size_t SH_CHUNK_SIZE = 1024;
+
+// Bump whenever the precomputation or the layout of the cache changes.
+static constexpr uint32_t IBL_CACHE_VERSION = 2;
+static constexpr uint32_t IBL_CACHE_MAGIC = 0x4c424941; // "AIBL"
+
+struct IblCacheHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint64_t key;
+    uint32_t specular_size;
+    uint32_t specular_levels;
+    uint32_t brdf_lut_size;
+    uint32_t padding0;
+    float irradiance_sh[27];
+    uint32_t padding1;
+};
+
+// Texels of one level of a cubemap as separate arrays, padded to a multiple of four texels with
+// zero weights so the SIMD loops need no remainder.
+struct SourceTexels
+{
+    std::vector<float> x, y, z;
+    // Solid angle of the texel.
+    std::vector<float> weight;
+    std::vector<float> r, g, b;
+
+    [[nodiscard]] size_t size() const
+    {
+        return weight.size();
+    }
+};
+
+size_t CubeMap::offset(uint32_t face, uint32_t level) const
+{
+    size_t face_texels = 0;
+    size_t level_offset = 0;
+    for (uint32_t i = 0; i < level_count; ++i)
+    {
+        size_t texels = size_t{level_size(i)} * level_size(i);
+        if (i < level)
+        {
+            level_offset += texels;
+        }
+        face_texels += texels;
+    }
+    return 4 * (face * face_texels + level_offset);
+}
+
+uint32_t CubeMap::level_at_least(uint32_t min_size) const
+{
+    uint32_t level = 0;
+    while (level + 1 < level_count && level_size(level + 1) >= min_size)
+    {
+        level += 1;
+    }
+    return level;
+}
+
+uint32_t environment_cube_size(uint32_t width)
+{
+    uint32_t size = IBL_SPECULAR_SIZE;
+    while (size * 2 <= width / 4 && size * 2 <= ENVIRONMENT_MAX_SIZE)
+    {
+        size *= 2;
+    }
+    return size;
+}
+
+glm::vec3 cube_direction(uint32_t face, float u, float v)
+{
+    switch (face)
+    {
+    case 0:
+        return glm::vec3(1.0f, -v, -u);
+    case 1:
+        return glm::vec3(-1.0f, -v, u);
+    case 2:
+        return glm::vec3(u, 1.0f, v);
+    case 3:
+        return glm::vec3(u, -1.0f, -v);
+    case 4:
+        return glm::vec3(u, -v, 1.0f);
+    default:
+        return glm::vec3(-u, -v, -1.0f);
+    }
+}
+
+// Coordinate of the center of texel `i` of a face `size` texels wide, in [-1, 1].
+static float texel_center(uint32_t i, uint32_t size)
+{
+    return (2.0f * static_cast<float>(i) + 1.0f) / static_cast<float>(size) - 1.0f;
+}
+
+// Bilinear sample, wrapping around horizontally and clamped at the poles. Uses the same mapping
+// as the skybox.
+static void sample_equirect(
+    std::span<const float> equirect, uint32_t width, uint32_t height, glm::vec3 dir, float *out
+)
+{
+    dir = glm::normalize(dir);
+    float u = std::atan2(dir.z, dir.x) * (0.5f / PI) + 0.5f;
+    float v = 0.5f - std::asin(std::clamp(dir.y, -1.0f, 1.0f)) / PI;
+    float x = u * static_cast<float>(width) - 0.5f;
+    float y = v * static_cast<float>(height) - 0.5f;
+    float x_floor = std::floor(x);
+    float y_floor = std::floor(y);
+    float fx = x - x_floor;
+    float fy = y - y_floor;
+
+    auto w = static_cast<int64_t>(width);
+    auto x0 = static_cast<int64_t>(x_floor);
+    auto y0 = static_cast<int64_t>(y_floor);
+    std::array<size_t, 2> columns{
+        static_cast<size_t>(((x0 % w) + w) % w),
+        static_cast<size_t>((((x0 + 1) % w) + w) % w),
+    };
+    std::array<size_t, 2> rows{
+        static_cast<size_t>(std::clamp<int64_t>(y0, 0, height - 1)),
+        static_cast<size_t>(std::clamp<int64_t>(y0 + 1, 0, height - 1)),
+    };
+    std::array<float, 4> weights{
+        (1.0f - fx) * (1.0f - fy),
+        fx * (1.0f - fy),
+        (1.0f - fx) * fy,
+        fx * fy,
+    };
+
+    for (uint32_t c = 0; c < 4; ++c)
+    {
+        out[c] = 0.0f;
+    }
+    for (size_t i = 0; i < 4; ++i)
+    {
+        const float *texel = equirect.data() + 4 * (rows[i / 2] * width + columns[i % 2]);
+        for (uint32_t c = 0; c < 3; ++c)
+        {
+            out[c] += weights[i] * texel[c];
+        }
+    }
+    out[3] = 1.0f;
+}
+
+void equirect_to_cube(
+    std::span<const float> equirect, uint32_t width, uint32_t height, uint32_t size,
+    JobSystem &jobs, CubeMap &out_cube
+)
+{
+    out_cube.size = size;
+    out_cube.level_count = 1;
+    for (uint32_t s = size; s > 1; s /= 2)
+    {
+        out_cube.level_count += 1;
+    }
+    out_cube.texels.resize(out_cube.offset(CUBE_FACE_COUNT, 0));
+
+    // Every texel averages a grid of bilinear samples, one per equirect texel it covers at the
+    // horizon.
+    uint32_t samples = std::max(width / (4 * size), 1u);
+    uint32_t sample_size = size * samples;
+    float sample_weight = 1.0f / static_cast<float>(samples * samples);
+    jobs.parallel_for(CUBE_FACE_COUNT * size, [&](size_t job) {
+        auto face = static_cast<uint32_t>(job / size);
+        auto y = static_cast<uint32_t>(job % size);
+        float *row = out_cube.texels.data() + out_cube.offset(face, 0) + 4 * size_t{y} * size;
+        for (uint32_t x = 0; x < size; ++x)
+        {
+            if (samples == 1)
+            {
+                glm::vec3 dir =
+                    cube_direction(face, texel_center(x, size), texel_center(y, size));
+                sample_equirect(equirect, width, height, dir, row + 4 * x);
+                continue;
+            }
+            std::array<float, 4> sum{};
+            for (uint32_t sy = y * samples; sy < (y + 1) * samples; ++sy)
+            {
+                for (uint32_t sx = x * samples; sx < (x + 1) * samples; ++sx)
+                {
+                    glm::vec3 dir = cube_direction(
+                        face, texel_center(sx, sample_size), texel_center(sy, sample_size)
+                    );
+                    std::array<float, 4> sample;
+                    sample_equirect(equirect, width, height, dir, sample.data());
+                    for (uint32_t c = 0; c < 4; ++c)
+                    {
+                        sum[c] += sample[c];
+                    }
+                }
+            }
+            for (uint32_t c = 0; c < 4; ++c)
+            {
+                row[4 * x + c] = sum[c] * sample_weight;
+            }
+        }
+    });
+
+    // Every level is a 2x2 box filter of the one above it.
+    for (uint32_t level = 1; level < out_cube.level_count; ++level)
+    {
+        uint32_t src_size = out_cube.level_size(level - 1);
+        uint32_t dst_size = out_cube.level_size(level);
+        jobs.parallel_for(CUBE_FACE_COUNT * dst_size, [&](size_t job) {
+            auto face = static_cast<uint32_t>(job / dst_size);
+            auto y = static_cast<uint32_t>(job % dst_size);
+            const float *src = out_cube.texels.data() + out_cube.offset(face, level - 1);
+            float *dst = out_cube.texels.data() + out_cube.offset(face, level) +
+                         4 * size_t{y} * dst_size;
+            for (uint32_t x = 0; x < dst_size; ++x)
+            {
+                const float *p00 = src + 4 * ((2 * size_t{y}) * src_size + 2 * x);
+                const float *p01 = p00 + 4;
+                const float *p10 = p00 + 4 * size_t{src_size};
+                const float *p11 = p10 + 4;
+                for (uint32_t c = 0; c < 4; ++c)
+                {
+                    dst[4 * x + c] = ((p00[c] + p01[c]) + (p10[c] + p11[c])) * 0.25f;
+                }
+            }
+        });
+    }
+}
+
+static void gather_source_texels(const CubeMap &cube, uint32_t level, SourceTexels &out)
+{
+    uint32_t size = cube.level_size(level);
+    size_t count = size_t{CUBE_FACE_COUNT} * size * size;
+    size_t padded = (count + 3) / 4 * 4;
+    for (std::vector<float> *array :
+         {&out.x, &out.y, &out.z, &out.weight, &out.r, &out.g, &out.b})
+    {
+        array->assign(padded, 0.0f);
+    }
+
+    // The solid angle of a texel is approximated from the area it projects to on the unit
+    // sphere, then all of them are scaled so they add up to the whole sphere.
+    float texel_area = 4.0f / static_cast<float>(size * size);
+    float total_weight = 0.0f;
+    size_t i = 0;
+    for (uint32_t face = 0; face < CUBE_FACE_COUNT; ++face)
+    {
+        const float *texels = cube.texels.data() + cube.offset(face, level);
+        for (uint32_t y = 0; y < size; ++y)
+        {
+            for (uint32_t x = 0; x < size; ++x, ++i)
+            {
+                glm::vec3 dir =
+                    cube_direction(face, texel_center(x, size), texel_center(y, size));
+                float length2 = glm::dot(dir, dir);
+                dir /= std::sqrt(length2);
+                out.x[i] = dir.x;
+                out.y[i] = dir.y;
+                out.z[i] = dir.z;
+                out.weight[i] = texel_area / (length2 * std::sqrt(length2));
+                total_weight += out.weight[i];
+                const float *texel = texels + 4 * (size_t{y} * size + x);
+                out.r[i] = texel[0];
+                out.g[i] = texel[1];
+                out.b[i] = texel[2];
+            }
+        }
+    }
+    float scale = 4.0f * PI / total_weight;
+    for (float &weight : out.weight)
+    {
+        weight *= scale;
+    }
+}
+
+// Sums of one chunk of texels, kept apart per SIMD lane: `[coefficient][channel][lane]`.
+using ShChunkSums = std::array<std::array<std::array<float, 4>, 3>, 9>;
+
+static void project_sh_chunk_scalar(
+    const SourceTexels &src, size_t begin, size_t end, ShChunkSums &out
+)
+{
+    out = {};
+    for (size_t i = begin; i < end; i += 4)
+    {
+        for (size_t lane = 0; lane < 4; ++lane)
+        {
+            size_t t = i + lane;
+            float x = src.x[t];
+            float y = src.y[t];
+            float z = src.z[t];
+            std::array<float, 9> basis{
+                0.282095f,
+                0.488603f * y,
+                0.488603f * z,
+                0.488603f * x,
+                1.092548f * (x * y),
+                1.092548f * (y * z),
+                0.315392f * ((3.0f * z) * z - 1.0f),
+                1.092548f * (x * z),
+                0.546274f * (x * x - y * y),
+            };
+            std::array<float, 3> radiance{
+                src.r[t] * src.weight[t],
+                src.g[t] * src.weight[t],
+                src.b[t] * src.weight[t],
+            };
+            for (size_t k = 0; k < 9; ++k)
+            {
+                for (size_t c = 0; c < 3; ++c)
+                {
+                    out[k][c][lane] += basis[k] * radiance[c];
+                }
+            }
+        }
+    }
+}
+
+#ifdef ARCTIC_IBL_SSE2
+
+static void project_sh_chunk_sse2(
+    const SourceTexels &src, size_t begin, size_t end, ShChunkSums &out
+)
+{
+    __m128 sums[9][3];
+    for (size_t k = 0; k < 9; ++k)
+    {
+        for (size_t c = 0; c < 3; ++c)
+        {
+            sums[k][c] = _mm_setzero_ps();
+        }
+    }
+
+    for (size_t i = begin; i < end; i += 4)
+    {
+        __m128 x = _mm_loadu_ps(src.x.data() + i);
+        __m128 y = _mm_loadu_ps(src.y.data() + i);
+        __m128 z = _mm_loadu_ps(src.z.data() + i);
+        __m128 weight = _mm_loadu_ps(src.weight.data() + i);
+        __m128 basis[9] = {
+            _mm_set1_ps(0.282095f),
+            _mm_mul_ps(_mm_set1_ps(0.488603f), y),
+            _mm_mul_ps(_mm_set1_ps(0.488603f), z),
+            _mm_mul_ps(_mm_set1_ps(0.488603f), x),
+            _mm_mul_ps(_mm_set1_ps(1.092548f), _mm_mul_ps(x, y)),
+            _mm_mul_ps(_mm_set1_ps(1.092548f), _mm_mul_ps(y, z)),
+            _mm_mul_ps(
+                _mm_set1_ps(0.315392f),
+                _mm_sub_ps(_mm_mul_ps(_mm_mul_ps(_mm_set1_ps(3.0f), z), z), _mm_set1_ps(1.0f))
+            ),
+            _mm_mul_ps(_mm_set1_ps(1.092548f), _mm_mul_ps(x, z)),
+            _mm_mul_ps(_mm_set1_ps(0.546274f), _mm_sub_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y))),
+        };
+        __m128 radiance[3] = {
+            _mm_mul_ps(_mm_loadu_ps(src.r.data() + i), weight),
+            _mm_mul_ps(_mm_loadu_ps(src.g.data() + i), weight),
+            _mm_mul_ps(_mm_loadu_ps(src.b.data() + i), weight),
+        };
+        for (size_t k = 0; k < 9; ++k)
+        {
+            for (size_t c = 0; c < 3; ++c)
+            {
+                sums[k][c] = _mm_add_ps(sums[k][c], _mm_mul_ps(basis[k], radiance[c]));
+            }
+        }
+    }
+
+    for (size_t k = 0; k < 9; ++k)
+    {
+        for (size_t c = 0; c < 3; ++c)
+        {
+            _mm_storeu_ps(out[k][c].data(), sums[k][c]);
+        }
+    }
+}
+
+#endif
+
+void project_irradiance_sh(
+    const CubeMap &cube, uint32_t level, JobSystem &jobs, std::array<glm::vec3, 9> &out_sh,
+    bool use_simd
+)
+{
+    SourceTexels src;
+    gather_source_texels(cube, level, src);
+
+    size_t chunk_count = (src.size() + SH_CHUNK_SIZE - 1) / SH_CHUNK_SIZE;
+    std::vector<ShChunkSums> chunk_sums(chunk_count);
+    jobs.parallel_for(chunk_count, [&](size_t chunk) {
+        size_t begin = chunk * SH_CHUNK_SIZE;
+        size_t end = std::min(src.size(), begin + SH_CHUNK_SIZE);
+#ifdef ARCTIC_IBL_SSE2
+        if (use_simd)
+        {
+            project_sh_chunk_sse2(src, begin, end, chunk_sums[chunk]);
+            return;
+        }
+#endif
+        project_sh_chunk_scalar(src, begin, end, chunk_sums[chunk]);
+    });
+    static_cast<void>(use_simd);
+
+    // Convolution with the clamped cosine scales each band by pi, 2 pi / 3 and pi / 4, which
+    // become 1, 2 / 3 and 1 / 4 after dividing by pi.
+    static constexpr std::array<float, 9> BAND_SCALES{
+        1.0f,
+        2.0f / 3.0f,
+        2.0f / 3.0f,
+        2.0f / 3.0f,
+        0.25f,
+        0.25f,
+        0.25f,
+        0.25f,
+        0.25f,
+    };
+    for (size_t k = 0; k < 9; ++k)
+    {
+        for (size_t c = 0; c < 3; ++c)
+        {
+            float sum = 0.0f;
+            for (const ShChunkSums &sums : chunk_sums)
+            {
+                const std::array<float, 4> &lanes = sums[k][c];
+                sum += (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+            }
+            out_sh[k][static_cast<glm::length_t>(c)] = sum * BAND_SCALES[k];
+        }
+    }
+}
+
+// Weighted sum of `src` under the GGX lobe around `n`, with `k` being alpha squared minus one.
+// With the view direction equal to the normal, the half vector makes half the angle with `n`,
+// so the distribution only depends on `dot(n, l)` and needs no square root. Its constant factor
+// cancels out in the normalization. Only the faces in `face_mask` are visited, each of them
+// `face_texels` long. Writes the sums of red, green, blue and the weights.
+static void convolve_ggx_scalar(
+    const SourceTexels &src, uint32_t face_mask, size_t face_texels, glm::vec3 n, float k,
+    float *out
+)
+{
+    std::array<std::array<float, 4>, 4> sums{};
+    for (uint32_t face = 0; face < CUBE_FACE_COUNT; ++face)
+    {
+        if ((face_mask & (1u << face)) == 0)
+        {
+            continue;
+        }
+        for (size_t i = face * face_texels; i < (face + 1) * face_texels; i += 4)
+        {
+            for (size_t lane = 0; lane < 4; ++lane)
+            {
+                size_t t = i + lane;
+                float n_dot_l = (n.x * src.x[t] + n.y * src.y[t]) + n.z * src.z[t];
+                float d = (n_dot_l * 0.5f + 0.5f) * k + 1.0f;
+                float weight = (std::max(n_dot_l, 0.0f) * src.weight[t]) / (d * d);
+                sums[0][lane] += weight * src.r[t];
+                sums[1][lane] += weight * src.g[t];
+                sums[2][lane] += weight * src.b[t];
+                sums[3][lane] += weight;
+            }
+        }
+    }
+    for (size_t c = 0; c < 4; ++c)
+    {
+        out[c] = (sums[c][0] + sums[c][1]) + (sums[c][2] + sums[c][3]);
+    }
+}
+
+#ifdef ARCTIC_IBL_SSE2
+
+static void convolve_ggx_sse2(
+    const SourceTexels &src, uint32_t face_mask, size_t face_texels, glm::vec3 n, float k,
+    float *out
+)
+{
+    __m128 nx = _mm_set1_ps(n.x);
+    __m128 ny = _mm_set1_ps(n.y);
+    __m128 nz = _mm_set1_ps(n.z);
+    __m128 k4 = _mm_set1_ps(k);
+    __m128 half = _mm_set1_ps(0.5f);
+    __m128 one = _mm_set1_ps(1.0f);
+    __m128 sums[4] = {_mm_setzero_ps(), _mm_setzero_ps(), _mm_setzero_ps(), _mm_setzero_ps()};
+    for (uint32_t face = 0; face < CUBE_FACE_COUNT; ++face)
+    {
+        if ((face_mask & (1u << face)) == 0)
+        {
+            continue;
+        }
+        for (size_t i = face * face_texels; i < (face + 1) * face_texels; i += 4)
+        {
+            __m128 n_dot_l = _mm_add_ps(
+                _mm_add_ps(
+                    _mm_mul_ps(nx, _mm_loadu_ps(src.x.data() + i)),
+                    _mm_mul_ps(ny, _mm_loadu_ps(src.y.data() + i))
+                ),
+                _mm_mul_ps(nz, _mm_loadu_ps(src.z.data() + i))
+            );
+            __m128 d =
+                _mm_add_ps(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(n_dot_l, half), half), k4), one);
+            __m128 weight = _mm_div_ps(
+                _mm_mul_ps(
+                    _mm_max_ps(n_dot_l, _mm_setzero_ps()),
+                    _mm_loadu_ps(src.weight.data() + i)
+                ),
+                _mm_mul_ps(d, d)
+            );
+            sums[0] = _mm_add_ps(sums[0], _mm_mul_ps(weight, _mm_loadu_ps(src.r.data() + i)));
+            sums[1] = _mm_add_ps(sums[1], _mm_mul_ps(weight, _mm_loadu_ps(src.g.data() + i)));
+            sums[2] = _mm_add_ps(sums[2], _mm_mul_ps(weight, _mm_loadu_ps(src.b.data() + i)));
+            sums[3] = _mm_add_ps(sums[3], weight);
+        }
+    }
+    for (size_t c = 0; c < 4; ++c)
+    {
+        std::array<float, 4> lanes;
+        _mm_storeu_ps(lanes.data(), sums[c]);
+        out[c] = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+    }
+}
+
+#endif
+
+void prefilter_specular(
+    const CubeMap &cube, JobSystem &jobs, std::vector<float> &out_texels, bool use_simd
+)
+{
+    CubeMap layout{.size = IBL_SPECULAR_SIZE, .level_count = IBL_SPECULAR_LEVELS, .texels = {}};
+    out_texels.resize(layout.offset(CUBE_FACE_COUNT, 0));
+
+    // The mirror-like top level is the environment itself.
+    uint32_t top_level = cube.level_at_least(IBL_SPECULAR_SIZE);
+    for (uint32_t face = 0; face < CUBE_FACE_COUNT; ++face)
+    {
+        const float *src = cube.texels.data() + cube.offset(face, top_level);
+        uint32_t src_size = cube.level_size(top_level);
+        float *dst = out_texels.data() + layout.offset(face, 0);
+        uint32_t step = src_size / IBL_SPECULAR_SIZE;
+        for (uint32_t y = 0; y < IBL_SPECULAR_SIZE; ++y)
+        {
+            for (uint32_t x = 0; x < IBL_SPECULAR_SIZE; ++x)
+            {
+                const float *texel = src + 4 * (size_t{y} * step * src_size + size_t{x} * step);
+                std::copy(texel, texel + 4, dst + 4 * (size_t{y} * IBL_SPECULAR_SIZE + x));
+            }
+        }
+    }
+
+    // Every other level is convolved from the source level of the same resolution. Faces that lie
+    // completely behind the normal are skipped, which is the case if all their corners are.
+    std::array<std::array<glm::vec3, 4>, CUBE_FACE_COUNT> face_corners;
+    for (uint32_t face = 0; face < CUBE_FACE_COUNT; ++face)
+    {
+        face_corners[face] = {
+            cube_direction(face, -1.0f, -1.0f),
+            cube_direction(face, 1.0f, -1.0f),
+            cube_direction(face, -1.0f, 1.0f),
+            cube_direction(face, 1.0f, 1.0f),
+        };
+    }
+    SourceTexels src;
+    for (uint32_t level = 1; level < IBL_SPECULAR_LEVELS; ++level)
+    {
+        uint32_t size = layout.level_size(level);
+        uint32_t src_level = cube.level_at_least(size);
+        gather_source_texels(cube, src_level, src);
+        size_t face_texels = size_t{cube.level_size(src_level)} * cube.level_size(src_level);
+
+        float roughness = static_cast<float>(level) / static_cast<float>(IBL_SPECULAR_LEVELS - 1);
+        float alpha = roughness * roughness;
+        float k = alpha * alpha - 1.0f;
+
+        jobs.parallel_for(CUBE_FACE_COUNT * size, [&](size_t job) {
+            auto face = static_cast<uint32_t>(job / size);
+            auto y = static_cast<uint32_t>(job % size);
+            float *row = out_texels.data() + layout.offset(face, level) + 4 * size_t{y} * size;
+            for (uint32_t x = 0; x < size; ++x)
+            {
+                glm::vec3 n = glm::normalize(
+                    cube_direction(face, texel_center(x, size), texel_center(y, size))
+                );
+                uint32_t face_mask = 0;
+                for (uint32_t face = 0; face < CUBE_FACE_COUNT; ++face)
+                {
+                    for (const glm::vec3 &corner : face_corners[face])
+                    {
+                        if (glm::dot(n, corner) > 0.0f)
+                        {
+                            face_mask |= 1u << face;
+                        }
+                    }
+                }
+                std::array<float, 4> sums;
+#ifdef ARCTIC_IBL_SSE2
+                if (use_simd)
+                {
+                    convolve_ggx_sse2(src, face_mask, face_texels, n, k, sums.data());
+                }
+                else
+#endif
+                {
+                    convolve_ggx_scalar(src, face_mask, face_texels, n, k, sums.data());
+                }
+                float *texel = row + 4 * x;
+                for (uint32_t c = 0; c < 3; ++c)
+                {
+                    texel[c] = sums[c] / sums[3];
+                }
+                texel[3] = 1.0f;
+            }
+        });
+    }
+    static_cast<void>(use_simd);
+}
+
+// Van der Corput sequence in base 2 for the second coordinate of a Hammersley point.
+static float radical_inverse(uint32_t bits)
+{
+    bits = (bits << 16u) | (bits >> 16u);
+    bits = ((bits & 0x55555555u) << 1u) | ((bits & 0xaaaaaaaau) >> 1u);
+    bits = ((bits & 0x33333333u) << 2u) | ((bits & 0xccccccccu) >> 2u);
+    bits = ((bits & 0x0f0f0f0fu) << 4u) | ((bits & 0xf0f0f0f0u) >> 4u);
+    bits = ((bits & 0x00ff00ffu) << 8u) | ((bits & 0xff00ff00u) >> 8u);
+    return static_cast<float>(bits) * 2.3283064365386963e-10f;
+}
+
+// Karis, "Real Shading in Unreal Engine 4", with `k = alpha / 2` for the geometry term.
+static glm::vec2 integrate_brdf(float n_dot_v, float roughness)
+{
+    glm::vec3 v(std::sqrt(1.0f - n_dot_v * n_dot_v), 0.0f, n_dot_v);
+    float alpha = roughness * roughness;
+    float k = alpha / 2.0f;
+    auto geometry = [k](float n_dot_x) { return n_dot_x / (n_dot_x * (1.0f - k) + k); };
+
+    glm::vec2 sum(0.0f);
+    for (uint32_t i = 0; i < IBL_BRDF_LUT_SAMPLES; ++i)
+    {
+        float phi = 2.0f * PI * static_cast<float>(i) / static_cast<float>(IBL_BRDF_LUT_SAMPLES);
+        float xi = radical_inverse(i);
+        float cos_theta = std::sqrt((1.0f - xi) / (1.0f + (alpha * alpha - 1.0f) * xi));
+        float sin_theta = std::sqrt(1.0f - cos_theta * cos_theta);
+        glm::vec3 h(sin_theta * std::cos(phi), sin_theta * std::sin(phi), cos_theta);
+        float v_dot_h = glm::dot(v, h);
+        glm::vec3 l = 2.0f * v_dot_h * h - v;
+
+        float n_dot_l = l.z;
+        if (n_dot_l <= 0.0f)
+        {
+            continue;
+        }
+        v_dot_h = std::max(v_dot_h, 0.0f);
+        float g_vis = geometry(n_dot_v) * geometry(n_dot_l) * v_dot_h / (h.z * n_dot_v);
+        float fc = std::pow(1.0f - v_dot_h, 5.0f);
+        sum = sum + glm::vec2((1.0f - fc) * g_vis, fc * g_vis);
+    }
+    return sum / static_cast<float>(IBL_BRDF_LUT_SAMPLES);
+}
+
+void integrate_brdf_lut(JobSystem &jobs, std::vector<float> &out_texels)
+{
+    out_texels.resize(2 * size_t{IBL_BRDF_LUT_SIZE} * IBL_BRDF_LUT_SIZE);
+    jobs.parallel_for(IBL_BRDF_LUT_SIZE, [&](size_t y) {
+        float roughness = (static_cast<float>(y) + 0.5f) / static_cast<float>(IBL_BRDF_LUT_SIZE);
+        for (uint32_t x = 0; x < IBL_BRDF_LUT_SIZE; ++x)
+        {
+            float n_dot_v = (static_cast<float>(x) + 0.5f) / static_cast<float>(IBL_BRDF_LUT_SIZE);
+            glm::vec2 scale_bias = integrate_brdf(n_dot_v, roughness);
+            float *texel = out_texels.data() + 2 * (y * IBL_BRDF_LUT_SIZE + x);
+            texel[0] = scale_bias.x;
+            texel[1] = scale_bias.y;
+        }
+    });
+}
+
+void compute_ibl(
+    const CubeMap &environment, JobSystem &jobs, IblData &out_data, IblStats &out_stats,
+    bool use_simd
+)
+{
+    using Clock = std::chrono::steady_clock;
+    auto elapsed_ms = [](Clock::time_point begin) {
+        return std::chrono::duration<float, std::milli>(Clock::now() - begin).count();
+    };
+
+    // Irradiance is smooth enough that a coarse level captures it completely.
+    Clock::time_point begin = Clock::now();
+    project_irradiance_sh(
+        environment,
+        environment.level_at_least(64),
+        jobs,
+        out_data.irradiance_sh,
+        use_simd
+    );
+    out_stats.irradiance_ms = elapsed_ms(begin);
+
+    begin = Clock::now();
+    std::vector<float> texels;
+    prefilter_specular(environment, jobs, texels, use_simd);
+    out_data.specular.resize(texels.size());
+    floats_to_halves(texels, out_data.specular);
+    out_stats.specular_ms = elapsed_ms(begin);
+
+    begin = Clock::now();
+    integrate_brdf_lut(jobs, texels);
+    out_data.brdf_lut.resize(texels.size());
+    floats_to_halves(texels, out_data.brdf_lut);
+    out_stats.brdf_lut_ms = elapsed_ms(begin);
+}
+
+uint64_t ibl_cache_key(std::span<const float> equirect, uint32_t width, uint32_t height)
+{
+    // FNV-1a over 64 bit words.
+    uint64_t hash = 0xcbf29ce484222325ull;
+    auto add = [&hash](uint64_t word) {
+        hash ^= word;
+        hash *= 0x100000001b3ull;
+    };
+    add(IBL_CACHE_VERSION);
+    add((uint64_t{width} << 32) | height);
+    add((uint64_t{environment_cube_size(width)} << 32) | IBL_SPECULAR_SIZE);
+    add((uint64_t{IBL_SPECULAR_LEVELS} << 32) | IBL_BRDF_LUT_SIZE);
+    add(IBL_BRDF_LUT_SAMPLES);
+
+    size_t word_count = equirect.size_bytes() / sizeof(uint64_t);
+    const auto *bytes = reinterpret_cast<const uint8_t *>(equirect.data());
+    for (size_t i = 0; i < word_count; ++i)
+    {
+        uint64_t word;
+        std::memcpy(&word, bytes + i * sizeof(word), sizeof(word));
+        add(word);
+    }
+    for (size_t i = word_count * sizeof(uint64_t); i < equirect.size_bytes(); ++i)
+    {
+        add(bytes[i]);
+    }
+    return hash;
+}
+
+// Sizes of the texture data of a cache written with the current constants.
+static size_t ibl_specular_half_count()
+{
+    CubeMap layout{.size = IBL_SPECULAR_SIZE, .level_count = IBL_SPECULAR_LEVELS, .texels = {}};
+    return layout.offset(CUBE_FACE_COUNT, 0);
+}
+
+static constexpr size_t IBL_BRDF_LUT_HALF_COUNT = 2 * size_t{IBL_BRDF_LUT_SIZE} * IBL_BRDF_LUT_SIZE;
+
+bool load_ibl_cache(const std::filesystem::path &path, uint64_t key, IblData &out_data)
+{
+    MappedFile file;
+    if (!file.open(path))
+    {
+        return false;
+    }
+    std::span<const uint8_t> bytes = file.bytes();
+
+    IblCacheHeader header{};
+    if (bytes.size() < sizeof(header))
+    {
+        spdlog::error("load_ibl_cache: `{}` is truncated", path.string());
+        return false;
+    }
+    std::memcpy(&header, bytes.data(), sizeof(header));
+    if (header.magic != IBL_CACHE_MAGIC || header.version != IBL_CACHE_VERSION ||
+        header.key != key || header.specular_size != IBL_SPECULAR_SIZE ||
+        header.specular_levels != IBL_SPECULAR_LEVELS || header.brdf_lut_size != IBL_BRDF_LUT_SIZE)
+    {
+        return false;
+    }
+
+    size_t specular_count = ibl_specular_half_count();
+    size_t specular_bytes = specular_count * sizeof(uint16_t);
+    size_t brdf_lut_bytes = IBL_BRDF_LUT_HALF_COUNT * sizeof(uint16_t);
+    if (bytes.size() != sizeof(header) + specular_bytes + brdf_lut_bytes)
+    {
+        spdlog::error("load_ibl_cache: `{}` has an unexpected size", path.string());
+        return false;
+    }
+
+    for (size_t k = 0; k < 9; ++k)
+    {
+        out_data.irradiance_sh[k] = glm::vec3(
+            header.irradiance_sh[3 * k],
+            header.irradiance_sh[3 * k + 1],
+            header.irradiance_sh[3 * k + 2]
+        );
+    }
+    out_data.specular.resize(specular_count);
+    std::memcpy(out_data.specular.data(), bytes.data() + sizeof(header), specular_bytes);
+    out_data.brdf_lut.resize(IBL_BRDF_LUT_HALF_COUNT);
+    std::memcpy(
+        out_data.brdf_lut.data(),
+        bytes.data() + sizeof(header) + specular_bytes,
+        brdf_lut_bytes
+    );
+
+    return true;
+}
+
+bool save_ibl_cache(const std::filesystem::path &path, uint64_t key, const IblData &data)
+{
+    if (data.specular.size() != ibl_specular_half_count() ||
+        data.brdf_lut.size() != IBL_BRDF_LUT_HALF_COUNT)
+    {
+        spdlog::error("save_ibl_cache: data does not match the current layout");
+        return false;
+    }
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file)
+    {
+        spdlog::error("save_ibl_cache: failed to open `{}`", path.string());
+        return false;
+    }
+
+    IblCacheHeader header{
+        .magic = IBL_CACHE_MAGIC,
+        .version = IBL_CACHE_VERSION,
+        .key = key,
+        .specular_size = IBL_SPECULAR_SIZE,
+        .specular_levels = IBL_SPECULAR_LEVELS,
+        .brdf_lut_size = IBL_BRDF_LUT_SIZE,
+        .padding0 = 0,
+        .irradiance_sh = {},
+        .padding1 = 0,
+    };
+    for (size_t k = 0; k < 9; ++k)
+    {
+        for (size_t c = 0; c < 3; ++c)
+        {
+            header.irradiance_sh[3 * k + c] = data.irradiance_sh[k][static_cast<glm::length_t>(c)];
+        }
+    }
+
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(
+        reinterpret_cast<const char *>(data.specular.data()),
+        static_cast<std::streamsize>(data.specular.size() * sizeof(uint16_t))
+    );
+    file.write(
+        reinterpret_cast<const char *>(data.brdf_lut.data()),
+        static_cast<std::streamsize>(data.brdf_lut.size() * sizeof(uint16_t))
+    );
+    if (!file)
+    {
+        spdlog::error("save_ibl_cache: failed to write `{}`", path.string());
+        return false;
+    }
+
+    return true;
+}
+
+} // namespace Arctic::Renderer
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <vector>
+
+#include <glm/vec3.hpp>
+
+#include "../job_system.hpp"
+
+namespace Arctic::Renderer
+{
+
+// Faces of a cubemap in the order of the array slices of a D3D12 cube texture: +x, -x, +y, -y,
+// +z, -z.
+static constexpr uint32_t CUBE_FACE_COUNT = 6;
+
+// Face size of the top level of the prefiltered specular cubemap.
+static constexpr uint32_t IBL_SPECULAR_SIZE = 128;
+// Level `i` of the prefiltered cubemap is filtered for roughness `i / (IBL_SPECULAR_LEVELS - 1)`.
+static constexpr uint32_t IBL_SPECULAR_LEVELS = 6;
+// Largest face size of the environment cubemap. As RGBA half floats with mips it takes 64 MiB of
+// video memory, which 4K and 8K environments are resampled down to.
+static constexpr uint32_t ENVIRONMENT_MAX_SIZE = 1024;
+// Has to match `IBL_BRDF_LUT_SIZE` in `lighting.hlsli`.
+static constexpr uint32_t IBL_BRDF_LUT_SIZE = 64;
+static constexpr uint32_t IBL_BRDF_LUT_SAMPLES = 512;
+
+// A cubemap of RGBA float texels with its full mip chain. Faces are stored one after another,
+// each with all of its levels, which is the order of the subresources of a D3D12 cube texture.
+struct CubeMap
+{
+    uint32_t size{0};
+    uint32_t level_count{0};
+    std::vector<float> texels;
+
+    // Index of the first float of `level` of `face` in `texels`.
+    [[nodiscard]] size_t offset(uint32_t face, uint32_t level) const;
+
+    [[nodiscard]] uint32_t level_size(uint32_t level) const
+    {
+        return std::max(size >> level, 1u);
+    }
+
+    // Smallest level whose faces are at least `min_size` texels wide, or the top level.
+    [[nodiscard]] uint32_t level_at_least(uint32_t min_size) const;
+};
+
+// Direction from the center of a cube through the point `u`, `v` of `face`, with both
+// coordinates in [-1, 1] and `v` pointing down the face. Not normalized.
+[[nodiscard]] glm::vec3 cube_direction(uint32_t face, float u, float v);
+
+// Face size of the cubemap an equirectangular image `width` texels wide is resampled into. A
+// quarter of the width keeps the texel density at the horizon, rounded down to a power of two so
+// every level of the mip chain halves evenly, clamped to `IBL_SPECULAR_SIZE` and
+// `ENVIRONMENT_MAX_SIZE`.
+[[nodiscard]] uint32_t environment_cube_size(uint32_t width);
+
+// Resamples an equirectangular RGBA float image, with +y at the top row, into a cubemap with
+// faces of `size` texels and generates its mip chain with a box filter. Images denser than the
+// cube are supersampled. Spread across the job system.
+void equirect_to_cube(
+    std::span<const float> equirect, uint32_t width, uint32_t height, uint32_t size,
+    JobSystem &jobs, CubeMap &out_cube
+);
+
+// Everything image based lighting needs from an environment, see `compute_ibl`.
+struct IblData
+{
+    // Radiance of the environment projected onto the first three bands of real spherical
+    // harmonics and convolved with the clamped cosine, divided by pi. Evaluated for a normal,
+    // they give the outgoing radiance of a white Lambertian surface.
+    std::array<glm::vec3, 9> irradiance_sh{};
+    // Prefiltered specular cubemap as RGBA half floats, faces one after another, each with all
+    // `IBL_SPECULAR_LEVELS` levels of `IBL_SPECULAR_SIZE >> level` texels squared.
+    std::vector<uint16_t> specular;
+    // Scale and bias of F0 of the split sum approximation as RG half floats, with n dot v along
+    // the rows and roughness down the columns, sampled at texel centers.
+    std::vector<uint16_t> brdf_lut;
+};
+
+struct IblStats
+{
+    float irradiance_ms{0.0f};
+    float specular_ms{0.0f};
+    float brdf_lut_ms{0.0f};
+};
+
+// Projects the radiance of `level` of `cube` onto spherical harmonics, see
+// `IblData::irradiance_sh`. Uses SSE2 where available, unless `use_simd` is false. The scalar
+// reference produces identical results.
+void project_irradiance_sh(
+    const CubeMap &cube, uint32_t level, JobSystem &jobs, std::array<glm::vec3, 9> &out_sh,
+    bool use_simd = true
+);
+
+// Convolves `cube` with the GGX lobe of every level of the specular cubemap, assuming the view
+// direction equals the normal, and writes the RGBA float texels in the layout of
+// `IblData::specular`. Uses SSE2 where available, unless `use_simd` is false. The scalar
+// reference produces identical results.
+void prefilter_specular(
+    const CubeMap &cube, JobSystem &jobs, std::vector<float> &out_texels, bool use_simd = true
+);
+
+// Integrates the GGX BRDF over the hemisphere for the split sum approximation, see
+// `IblData::brdf_lut`, as RG float texels.
+void integrate_brdf_lut(JobSystem &jobs, std::vector<float> &out_texels);
+
+// Precomputes the irradiance, the prefiltered specular cubemap and the BRDF lookup table from
+// an environment made by `equirect_to_cube`, spread across the job system. Its faces have to be
+// at least `IBL_SPECULAR_SIZE` texels wide.
+void compute_ibl(
+    const CubeMap &environment, JobSystem &jobs, IblData &out_data, IblStats &out_stats,
+    bool use_simd = true
+);
+
+// Identifies an environment together with the parameters of the precomputation, so a cache made
+// from a different image or by a different version is never loaded.
+[[nodiscard]] uint64_t
+ibl_cache_key(std::span<const float> equirect, uint32_t width, uint32_t height);
+
+// Fails if the file does not exist, was written for a different key or is damaged.
+[[nodiscard]] bool
+load_ibl_cache(const std::filesystem::path &path, uint64_t key, IblData &out_data);
+
+[[nodiscard]] bool
+save_ibl_cache(const std::filesystem::path &path, uint64_t key, const IblData &data);
+
+} // namespace Arctic::Renderer
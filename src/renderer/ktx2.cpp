@@ -0,0 +1,202 @@
+#include "ktx2.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <memory>
+#include <utility>
+
+#include <spdlog/spdlog.h>
+
+namespace Arctic::Renderer
+{
+
+static constexpr std::array<uint8_t, 12> KTX2_IDENTIFIER{
+    0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n',
+};
+
+struct Ktx2Header
+{
+    uint32_t vk_format;
+    uint32_t type_size;
+    uint32_t pixel_width;
+    uint32_t pixel_height;
+    uint32_t pixel_depth;
+    uint32_t layer_count;
+    uint32_t face_count;
+    uint32_t level_count;
+    uint32_t supercompression_scheme;
+};
+
+struct Ktx2Index
+{
+    uint32_t dfd_byte_offset;
+    uint32_t dfd_byte_length;
+    uint32_t kvd_byte_offset;
+    uint32_t kvd_byte_length;
+    uint64_t sgd_byte_offset;
+    uint64_t sgd_byte_length;
+};
+
+struct Ktx2LevelIndex
+{
+    uint64_t byte_offset;
+    uint64_t byte_length;
+    uint64_t uncompressed_byte_length;
+};
+
+static_assert(sizeof(Ktx2Header) == 36);
+static_assert(sizeof(Ktx2Index) == 32);
+static_assert(sizeof(Ktx2LevelIndex) == 24);
+
+// Maps the VkFormat values of the formats in `TextureFormat`.
+static TextureFormat format_from_vk_format(uint32_t vk_format)
+{
+    switch (vk_format)
+    {
+        case 37: // VK_FORMAT_R8G8B8A8_UNORM
+            return TextureFormat::R8G8B8A8Unorm;
+        case 43: // VK_FORMAT_R8G8B8A8_SRGB
+            return TextureFormat::R8G8B8A8UnormSrgb;
+        case 131: // VK_FORMAT_BC1_RGB_UNORM_BLOCK
+        case 133: // VK_FORMAT_BC1_RGBA_UNORM_BLOCK
+            return TextureFormat::BC1Unorm;
+        case 132: // VK_FORMAT_BC1_RGB_SRGB_BLOCK
+        case 134: // VK_FORMAT_BC1_RGBA_SRGB_BLOCK
+            return TextureFormat::BC1UnormSrgb;
+        case 137: // VK_FORMAT_BC3_UNORM_BLOCK
+            return TextureFormat::BC3Unorm;
+        case 138: // VK_FORMAT_BC3_SRGB_BLOCK
+            return TextureFormat::BC3UnormSrgb;
+        case 139: // VK_FORMAT_BC4_UNORM_BLOCK
+            return TextureFormat::BC4Unorm;
+        case 141: // VK_FORMAT_BC5_UNORM_BLOCK
+            return TextureFormat::BC5Unorm;
+        default:
+            return TextureFormat::Unknown;
+    }
+}
+
+bool load_ktx2(const std::filesystem::path &path, TextureImage &out_image)
+{
+    auto file = std::make_shared<MappedFile>();
+    if (!file->open(path))
+    {
+        spdlog::error("load_ktx2: failed to map `{}`", path.string());
+        return false;
+    }
+    std::span<const uint8_t> bytes = file->bytes();
+
+    Ktx2Header header{};
+    Ktx2Index index{};
+    uint64_t header_size = KTX2_IDENTIFIER.size() + sizeof(header) + sizeof(index);
+    if (bytes.size() < header_size ||
+        std::memcmp(bytes.data(), KTX2_IDENTIFIER.data(), KTX2_IDENTIFIER.size()) != 0)
+    {
+        spdlog::error("load_ktx2: `{}` is not a KTX2 file", path.string());
+        return false;
+    }
+    std::memcpy(&header, bytes.data() + KTX2_IDENTIFIER.size(), sizeof(header));
+    std::memcpy(&index, bytes.data() + KTX2_IDENTIFIER.size() + sizeof(header), sizeof(index));
+
+    if (header.supercompression_scheme != 0)
+    {
+        spdlog::error("load_ktx2: `{}` uses supercompression", path.string());
+        return false;
+    }
+
+    if (header.pixel_width == 0 || header.pixel_height == 0 || header.pixel_depth > 1 ||
+        header.layer_count > 1 || header.face_count != 1)
+    {
+        spdlog::error("load_ktx2: `{}` is not a single 2D texture", path.string());
+        return false;
+    }
+
+    TextureFormat format = format_from_vk_format(header.vk_format);
+    if (format == TextureFormat::Unknown)
+    {
+        spdlog::error(
+            "load_ktx2: `{}` has unsupported format {}",
+            path.string(),
+            header.vk_format
+        );
+        return false;
+    }
+
+    // A level count of zero asks the loader to generate the mip chain, only the base level is
+    // stored in the file then. Block compressed levels can not be downsampled.
+    bool generate_mips = header.level_count == 0;
+    if (generate_mips && is_block_compressed(format))
+    {
+        spdlog::error(
+            "load_ktx2: `{}` asks for generated mip levels of the block compressed format {}",
+            path.string(),
+            texture_format_name(format)
+        );
+        return false;
+    }
+    uint32_t mip_levels = std::max(header.level_count, 1u);
+    if (mip_levels > mip_count(header.pixel_width, header.pixel_height) ||
+        bytes.size() < header_size + mip_levels * sizeof(Ktx2LevelIndex))
+    {
+        spdlog::error("load_ktx2: `{}` has an invalid number of mip levels", path.string());
+        return false;
+    }
+
+    // Levels are not necessarily stored in order or tightly packed, so only the dimensions and
+    // pitches are taken from the computed layout and the placement comes from the level index.
+    std::vector<TextureLevel> levels;
+    compute_texture_levels(
+        format,
+        header.pixel_width,
+        header.pixel_height,
+        mip_levels,
+        0,
+        levels
+    );
+    for (uint32_t level = 0; level < mip_levels; ++level)
+    {
+        Ktx2LevelIndex level_index{};
+        std::memcpy(
+            &level_index,
+            bytes.data() + header_size + level * sizeof(Ktx2LevelIndex),
+            sizeof(level_index)
+        );
+        if (level_index.byte_length < levels[level].size ||
+            level_index.byte_offset > bytes.size() ||
+            bytes.size() - level_index.byte_offset < levels[level].size)
+        {
+            spdlog::error("load_ktx2: `{}` has an invalid mip level #{}", path.string(), level);
+            return false;
+        }
+        levels[level].offset = level_index.byte_offset;
+    }
+
+    if (generate_mips)
+    {
+        MipColorSpace color_space = format == TextureFormat::R8G8B8A8UnormSrgb
+                                        ? MipColorSpace::Srgb
+                                        : MipColorSpace::Linear;
+        MipChain chain;
+        generate_mip_chain(
+            bytes.data() + levels[0].offset,
+            header.pixel_width,
+            header.pixel_height,
+            color_space,
+            chain
+        );
+        texture_image_from_mip_chain(std::move(chain), color_space, out_image);
+        return true;
+    }
+
+    out_image.format = format;
+    out_image.width = header.pixel_width;
+    out_image.height = header.pixel_height;
+    out_image.levels = std::move(levels);
+    out_image.data.clear();
+    out_image.file = std::move(file);
+
+    return true;
+}
+
+} // namespace Arctic::Renderer
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <filesystem>
+
+#include "texture_image.hpp"
+
+namespace Arctic::Renderer
+{
+
+// Loads a 2D texture with all of its mip levels from a KTX2 file. Only files without
+// supercompression that hold a single layer and face are supported. Like with `load_dds` the
+// file is mapped into memory and the image references its levels in place. Files that leave the
+// mip levels to the loader get their chain generated like images without one, which is only
+// supported for uncompressed formats.
+[[nodiscard]] bool load_ktx2(const std::filesystem::path &path, TextureImage &out_image);
+
+} // namespace Arctic::Renderer
@@ -0,0 +1,146 @@
+#include "memory_tracker.hpp"
+
+#include <algorithm>
+#include <atomic>
+
+#include <spdlog/spdlog.h>
+
+#include "dxerr.hpp"
+
+namespace Arctic::Renderer
+{
+
+// {6F1F3C1A-8B0E-4C55-9A4B-2D7C8E5B3A10}
+static constexpr GUID ALLOCATION_GUARD_GUID =
+    {0x6f1f3c1a, 0x8b0e, 0x4c55, {0x9a, 0x4b, 0x2d, 0x7c, 0x8e, 0x5b, 0x3a, 0x10}};
+
+// Attached to every tracked D3D12 object. D3D12 releases private data interfaces when the object
+// they are attached to is destroyed, at which point the allocation is removed from the tracker.
+class AllocationGuard final : public IUnknown
+{
+    std::atomic<ULONG> m_ref_count{1};
+    MemoryTracker *m_tracker;
+    MemoryCategory m_category;
+    uint64_t m_size;
+
+  public:
+    AllocationGuard(MemoryTracker *tracker, MemoryCategory category, uint64_t size)
+        : m_tracker(tracker), m_category(category), m_size(size)
+    {
+    }
+
+    HRESULT STDMETHODCALLTYPE QueryInterface(REFIID riid, void **object) override
+    {
+        if (riid == __uuidof(IUnknown))
+        {
+            *object = static_cast<IUnknown *>(this);
+            AddRef();
+            return S_OK;
+        }
+        *object = nullptr;
+        return E_NOINTERFACE;
+    }
+
+    ULONG STDMETHODCALLTYPE AddRef() override
+    {
+        return ++m_ref_count;
+    }
+
+    ULONG STDMETHODCALLTYPE Release() override
+    {
+        ULONG ref_count = --m_ref_count;
+        if (ref_count == 0)
+        {
+            m_tracker->untrack(m_category, m_size);
+            delete this;
+        }
+        return ref_count;
+    }
+};
+
+bool MemoryTracker::init(IDXGIAdapter3 *adapter)
+{
+    m_adapter = adapter;
+    if (!poll_budget())
+    {
+        spdlog::error("MemoryTracker::init: failed to query video memory info");
+        return false;
+    }
+
+    spdlog::info(
+        "MemoryTracker::init: local budget {:.0f} MiB, non-local budget {:.0f} MiB",
+        static_cast<double>(m_stats.local_budget) / (1024.0 * 1024.0),
+        static_cast<double>(m_stats.non_local_budget) / (1024.0 * 1024.0)
+    );
+
+    return true;
+}
+
+bool MemoryTracker::track(ID3D12Object *object, MemoryCategory category, uint64_t size)
+{
+    auto *guard = new AllocationGuard(this, category, size);
+    {
+        std::lock_guard lock(m_mutex);
+        MemoryCategoryStats &stats = m_stats.categories[static_cast<size_t>(category)];
+        stats.live_bytes += size;
+        stats.peak_bytes = std::max(stats.peak_bytes, stats.live_bytes);
+        stats.live_allocations += 1;
+        m_stats.total_live_bytes += size;
+        m_stats.total_peak_bytes = std::max(m_stats.total_peak_bytes, m_stats.total_live_bytes);
+    }
+
+    // The object holds its own reference to the guard from here on. If attaching fails the guard
+    // is released right away, which also undoes the accounting.
+    HRESULT hr = object->SetPrivateDataInterface(ALLOCATION_GUARD_GUID, guard);
+    guard->Release();
+    DXERR(hr, "MemoryTracker::track: failed to attach allocation guard");
+
+    return true;
+}
+
+void MemoryTracker::untrack(MemoryCategory category, uint64_t size)
+{
+    std::lock_guard lock(m_mutex);
+    MemoryCategoryStats &stats = m_stats.categories[static_cast<size_t>(category)];
+    stats.live_bytes -= size;
+    stats.live_allocations -= 1;
+    m_stats.total_live_bytes -= size;
+}
+
+bool MemoryTracker::poll_budget()
+{
+    DXGI_QUERY_VIDEO_MEMORY_INFO local{}, non_local{};
+    DXERR(
+        m_adapter->QueryVideoMemoryInfo(0, DXGI_MEMORY_SEGMENT_GROUP_LOCAL, &local),
+        "MemoryTracker::poll_budget: failed to query local memory info"
+    );
+    DXERR(
+        m_adapter->QueryVideoMemoryInfo(0, DXGI_MEMORY_SEGMENT_GROUP_NON_LOCAL, &non_local),
+        "MemoryTracker::poll_budget: failed to query non-local memory info"
+    );
+
+    {
+        std::lock_guard lock(m_mutex);
+        m_stats.local_budget = local.Budget;
+        m_stats.local_usage = local.CurrentUsage;
+        m_stats.non_local_budget = non_local.Budget;
+        m_stats.non_local_usage = non_local.CurrentUsage;
+    }
+
+    // Only warn once when crossing the threshold instead of every frame.
+    bool near_budget = is_near_budget();
+    if (near_budget && !m_warned_about_budget)
+    {
+        spdlog::warn(
+            "MemoryTracker::poll_budget: video memory usage {:.0f} MiB is close to the budget of "
+            "{:.0f} MiB",
+            static_cast<double>(local.CurrentUsage) / (1024.0 * 1024.0),
+            static_cast<double>(local.Budget) / (1024.0 * 1024.0)
+        );
+    }
+    m_warned_about_budget = near_budget;
+
+    return true;
+}
+
+} // namespace Arctic::Renderer
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+
+#include <d3d12.h>
+#include <dxgi1_6.h>
+
+#include "comptr.hpp"
+#include "frame_stats.hpp"
+
+namespace Arctic::Renderer
+{
+
+// Keeps track of the memory of all resources and heaps the renderer allocates. The size of an
+// allocation is subtracted again when the D3D12 object is destroyed, which is detected through
+// an object attached with `SetPrivateDataInterface` that is released together with it.
+class MemoryTracker
+{
+  public:
+    // Fraction of the local budget above which usage is considered to be close to the budget.
+    static constexpr float BUDGET_WARNING_THRESHOLD = 0.9f;
+
+  private:
+    ComPtr<IDXGIAdapter3> m_adapter;
+
+    mutable std::mutex m_mutex;
+    MemoryStats m_stats;
+    bool m_warned_about_budget{false};
+
+    MemoryTracker(const MemoryTracker &) = delete;
+    MemoryTracker &operator=(const MemoryTracker &) = delete;
+    MemoryTracker(MemoryTracker &&) = delete;
+    MemoryTracker &operator=(MemoryTracker &&) = delete;
+
+  public:
+    MemoryTracker() = default;
+
+    [[nodiscard]] bool init(IDXGIAdapter3 *adapter);
+
+    // Accounts `size` bytes to `category` for as long as `object` is alive.
+    [[nodiscard]] bool track(ID3D12Object *object, MemoryCategory category, uint64_t size);
+
+    void untrack(MemoryCategory category, uint64_t size);
+
+    // Queries the current budget and usage from the OS. Cheap enough to be called every frame.
+    [[nodiscard]] bool poll_budget();
+
+    [[nodiscard]] MemoryStats stats() const
+    {
+        std::lock_guard lock(m_mutex);
+        return m_stats;
+    }
+
+    [[nodiscard]] bool is_near_budget() const
+    {
+        std::lock_guard lock(m_mutex);
+        return m_stats.local_budget > 0 &&
+               static_cast<float>(m_stats.local_usage) >
+                   BUDGET_WARNING_THRESHOLD * static_cast<float>(m_stats.local_budget);
+    }
+};
+
+} // namespace Arctic::Renderer
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#include <d3d12.h>
+
+#include <glm/mat4x4.hpp>
+#include <glm/matrix.hpp>
+#include <glm/vec4.hpp>
+
+#include "comptr.hpp"
+#include "draw_list.hpp"
+#include "meshlet.hpp"
+#include "scene.hpp"
+#include "vertex_format.hpp"
+
+namespace Arctic::Renderer
+{
+
+struct Mesh
+{
+    // Vertices are split into two streams, bound to input slots 0 and 1. Passes that only need
+    // depth bind nothing but the positions.
+    ComPtr<ID3D12Resource> position_buffer;
+    D3D12_VERTEX_BUFFER_VIEW position_buffer_view;
+    VertexPositionFormat position_format;
+    // Has to be applied to the positions in the position buffer before the model matrix.
+    glm::mat4 position_transform;
+
+    ComPtr<ID3D12Resource> attribute_buffer;
+    D3D12_VERTEX_BUFFER_VIEW attribute_buffer_view;
+
+    ComPtr<ID3D12Resource> index_buffer;
+    D3D12_INDEX_BUFFER_VIEW index_buffer_view;
+
+    uint32_t index_count;
+
+    // Meshlets of all levels of detail, laid out by `pack_meshlets`. The mesh shaders read it and
+    // the vertex streams through raw views.
+    ComPtr<ID3D12Resource> meshlet_buffer;
+    uint32_t meshlet_buffer_srv_idx;
+    uint32_t position_buffer_srv_idx;
+    uint32_t attribute_buffer_srv_idx;
+
+    MaterialIdx material_idx;
+};
+
+struct Material
+{
+    static constexpr uint32_t NUM_TEXTURES = 3;
+
+    // Diffuse, normal and metalness/roughness, in the order of their views.
+    std::array<ComPtr<ID3D12Resource>, NUM_TEXTURES> textures;
+
+    uint32_t srv_offset;
+};
+
+// Root constants of the meshlet culling and mesh shaders, see `meshlet.hlsli`.
+struct MeshletConstants
+{
+    // From the object space of the meshlet bounds to clip space, without the position transform.
+    glm::mat4 cull_clip_from_object;
+    // Object space eye position with w = 1, or view direction with w = 0 for orthographic views.
+    glm::vec4 cull_view;
+    uint32_t positions_idx;
+    uint32_t attributes_idx;
+    uint32_t meshlets_idx;
+    uint32_t first_meshlet;
+    uint32_t meshlet_count;
+    uint32_t position_format;
+    // 1 if the draw may be cone culled, see `meshlet_cone_culling_allowed`.
+    uint32_t cone_culling;
+};
+
+inline MeshletConstants meshlet_constants(
+    const Mesh &mesh, const DrawItem &draw, const glm::mat4 &proj_view, const glm::vec4 &view
+)
+{
+    return MeshletConstants{
+        .cull_clip_from_object = proj_view * draw.model,
+        .cull_view = glm::inverse(draw.model) * view,
+        .positions_idx = mesh.position_buffer_srv_idx,
+        .attributes_idx = mesh.attribute_buffer_srv_idx,
+        .meshlets_idx = mesh.meshlet_buffer_srv_idx,
+        .first_meshlet = draw.first_meshlet,
+        .meshlet_count = draw.meshlet_count,
+        .position_format = static_cast<uint32_t>(mesh.position_format),
+        .cone_culling = meshlet_cone_culling_allowed(draw.model) ? 1u : 0u,
+    };
+}
+
+inline DXGI_FORMAT vertex_position_dxgi_format(VertexPositionFormat format)
+{
+    switch (format)
+    {
+        case VertexPositionFormat::Float:
+            return DXGI_FORMAT_R32G32B32_FLOAT;
+        case VertexPositionFormat::Unorm16:
+            return DXGI_FORMAT_R16G16B16A16_UNORM;
+    }
+    return DXGI_FORMAT_UNKNOWN;
+}
+
+} // namespace Arctic::Renderer
@@ -0,0 +1,441 @@
+#include "mesh_optimizer.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+
+#include <glm/geometric.hpp>
+
+namespace Arctic::Renderer
+{
+
+// Size of the LRU cache the Forsyth scores are based on. It is only a heuristic, the order it
+// produces works well for smaller FIFO caches too.
+static constexpr uint32_t FORSYTH_CACHE_SIZE = 32;
+static constexpr float FORSYTH_CACHE_DECAY_POWER = 1.5f;
+static constexpr float FORSYTH_LAST_TRIANGLE_SCORE = 0.75f;
+static constexpr float FORSYTH_VALENCE_BOOST_SCALE = 2.0f;
+static constexpr float FORSYTH_VALENCE_BOOST_POWER = 0.5f;
+// Valences above this share the score of this one, which is close to zero anyway.
+static constexpr uint32_t FORSYTH_MAX_VALENCE = 64;
+
+static constexpr uint32_t INVALID_INDEX = std::numeric_limits<uint32_t>::max();
+
+// FIFO post-transform cache, without tracking which vertices are evicted. A vertex is in the
+// cache if fewer than `size` misses happened since it was last transformed.
+class VertexCacheSimulator
+{
+    std::vector<uint32_t> m_timestamps;
+    uint32_t m_size;
+    uint32_t m_timestamp;
+
+  public:
+    VertexCacheSimulator(uint32_t vertex_count, uint32_t size)
+        : m_timestamps(vertex_count, 0), m_size(size), m_timestamp(size + 1)
+    {
+    }
+
+    // Returns the number of misses for the triangle.
+    uint32_t process(uint32_t a, uint32_t b, uint32_t c)
+    {
+        uint32_t misses = 0;
+        for (uint32_t v : {a, b, c})
+        {
+            if (m_timestamp - m_timestamps[v] > m_size)
+            {
+                m_timestamps[v] = m_timestamp++;
+                ++misses;
+            }
+        }
+        return misses;
+    }
+
+    void clear()
+    {
+        m_timestamp += m_size + 1;
+    }
+};
+
+VertexCacheStats analyze_vertex_cache(
+    std::span<const uint32_t> indices, uint32_t vertex_count, uint32_t cache_size
+)
+{
+    VertexCacheSimulator cache(vertex_count, cache_size);
+    std::vector<bool> referenced(vertex_count, false);
+    uint32_t misses = 0;
+    for (size_t i = 0; i + 2 < indices.size(); i += 3)
+    {
+        misses += cache.process(indices[i], indices[i + 1], indices[i + 2]);
+    }
+
+    uint32_t referenced_count = 0;
+    for (uint32_t index : indices)
+    {
+        if (!referenced[index])
+        {
+            referenced[index] = true;
+            ++referenced_count;
+        }
+    }
+
+    size_t triangle_count = indices.size() / 3;
+    return VertexCacheStats{
+        .acmr = triangle_count > 0
+                    ? static_cast<float>(misses) / static_cast<float>(triangle_count)
+                    : 0.0f,
+        .atvr = referenced_count > 0
+                    ? static_cast<float>(misses) / static_cast<float>(referenced_count)
+                    : 0.0f,
+    };
+}
+
+struct ForsythScores
+{
+    std::array<float, FORSYTH_CACHE_SIZE> cache_position;
+    std::array<float, FORSYTH_MAX_VALENCE + 1> valence;
+
+    ForsythScores()
+    {
+        for (uint32_t i = 0; i < FORSYTH_CACHE_SIZE; ++i)
+        {
+            if (i < 3)
+            {
+                // The vertices of the last triangle get a fixed score, so that the next triangle
+                // does not depend on the order they were emitted in.
+                cache_position[i] = FORSYTH_LAST_TRIANGLE_SCORE;
+            }
+            else
+            {
+                float scale = 1.0f / static_cast<float>(FORSYTH_CACHE_SIZE - 3);
+                float score = 1.0f - static_cast<float>(i - 3) * scale;
+                cache_position[i] = std::pow(score, FORSYTH_CACHE_DECAY_POWER);
+            }
+        }
+
+        valence[0] = 0.0f;
+        for (uint32_t i = 1; i <= FORSYTH_MAX_VALENCE; ++i)
+        {
+            // Boosts vertices with few triangles left, to get rid of lone triangles early.
+            valence[i] = FORSYTH_VALENCE_BOOST_SCALE *
+                         std::pow(static_cast<float>(i), -FORSYTH_VALENCE_BOOST_POWER);
+        }
+    }
+
+    [[nodiscard]] float vertex(int32_t cache_position_idx, uint32_t remaining) const
+    {
+        if (remaining == 0)
+        {
+            return -1.0f;
+        }
+        float score = valence[std::min(remaining, FORSYTH_MAX_VALENCE)];
+        if (cache_position_idx >= 0)
+        {
+            score += cache_position[static_cast<size_t>(cache_position_idx)];
+        }
+        return score;
+    }
+};
+
+void optimize_vertex_cache(std::span<uint32_t> indices, uint32_t vertex_count)
+{
+    static const ForsythScores scores;
+
+    uint32_t triangle_count = static_cast<uint32_t>(indices.size() / 3);
+    if (triangle_count == 0)
+    {
+        return;
+    }
+
+    // Triangles of every vertex. The first `remaining[v]` entries of each range are the ones that
+    // have not been emitted yet.
+    std::vector<uint32_t> remaining(vertex_count, 0);
+    for (size_t i = 0; i < 3ull * triangle_count; ++i)
+    {
+        ++remaining[indices[i]];
+    }
+    std::vector<uint32_t> offsets(vertex_count + 1, 0);
+    for (uint32_t v = 0; v < vertex_count; ++v)
+    {
+        offsets[v + 1] = offsets[v] + remaining[v];
+    }
+    std::vector<uint32_t> adjacency(offsets[vertex_count]);
+    {
+        std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+        for (uint32_t t = 0; t < triangle_count; ++t)
+        {
+            for (uint32_t k = 0; k < 3; ++k)
+            {
+                adjacency[fill[indices[3 * t + k]]++] = t;
+            }
+        }
+    }
+
+    std::vector<int32_t> cache_position(vertex_count, -1);
+    std::vector<float> vertex_score(vertex_count);
+    for (uint32_t v = 0; v < vertex_count; ++v)
+    {
+        vertex_score[v] = scores.vertex(-1, remaining[v]);
+    }
+
+    std::vector<float> triangle_score(triangle_count);
+    std::vector<bool> emitted(triangle_count, false);
+    uint32_t best_triangle = 0;
+    for (uint32_t t = 0; t < triangle_count; ++t)
+    {
+        triangle_score[t] = vertex_score[indices[3 * t]] + vertex_score[indices[3 * t + 1]] +
+                            vertex_score[indices[3 * t + 2]];
+        if (triangle_score[t] > triangle_score[best_triangle])
+        {
+            best_triangle = t;
+        }
+    }
+
+    std::vector<uint32_t> result;
+    result.reserve(3ull * triangle_count);
+    std::vector<uint32_t> cache;
+    std::vector<uint32_t> next_cache;
+    cache.reserve(FORSYTH_CACHE_SIZE + 3);
+    next_cache.reserve(FORSYTH_CACHE_SIZE + 3);
+    // Falls back to the first triangle that is left whenever none in the cache is.
+    uint32_t next_unemitted = 0;
+
+    for (uint32_t n = 0; n < triangle_count; ++n)
+    {
+        if (best_triangle == INVALID_INDEX)
+        {
+            while (emitted[next_unemitted])
+            {
+                ++next_unemitted;
+            }
+            best_triangle = next_unemitted;
+        }
+
+        emitted[best_triangle] = true;
+        next_cache.clear();
+        for (uint32_t k = 0; k < 3; ++k)
+        {
+            uint32_t v = indices[3 * best_triangle + k];
+            result.emplace_back(v);
+
+            // Moves the triangle out of the part of the range that is left.
+            uint32_t *triangles = adjacency.data() + offsets[v];
+            uint32_t *last = triangles + remaining[v] - 1;
+            *std::find(triangles, last + 1, best_triangle) = *last;
+            *last = best_triangle;
+            --remaining[v];
+
+            if (std::find(next_cache.begin(), next_cache.end(), v) == next_cache.end())
+            {
+                next_cache.emplace_back(v);
+            }
+        }
+        for (uint32_t v : cache)
+        {
+            if (std::find(next_cache.begin(), next_cache.end(), v) == next_cache.end())
+            {
+                next_cache.emplace_back(v);
+            }
+        }
+
+        // Vertices falling out of the cache lose their cache score.
+        for (size_t i = FORSYTH_CACHE_SIZE; i < next_cache.size(); ++i)
+        {
+            uint32_t v = next_cache[i];
+            cache_position[v] = -1;
+            vertex_score[v] = scores.vertex(-1, remaining[v]);
+        }
+        next_cache.resize(std::min<size_t>(next_cache.size(), FORSYTH_CACHE_SIZE));
+        for (size_t i = 0; i < next_cache.size(); ++i)
+        {
+            uint32_t v = next_cache[i];
+            cache_position[v] = static_cast<int32_t>(i);
+            vertex_score[v] = scores.vertex(cache_position[v], remaining[v]);
+        }
+        std::swap(cache, next_cache);
+
+        // Only triangles touching the cache can have changed their score.
+        best_triangle = INVALID_INDEX;
+        float best_score = -1.0f;
+        for (uint32_t v : cache)
+        {
+            for (uint32_t i = offsets[v]; i < offsets[v] + remaining[v]; ++i)
+            {
+                uint32_t t = adjacency[i];
+                triangle_score[t] = vertex_score[indices[3 * t]] +
+                                    vertex_score[indices[3 * t + 1]] +
+                                    vertex_score[indices[3 * t + 2]];
+                if (triangle_score[t] > best_score)
+                {
+                    best_score = triangle_score[t];
+                    best_triangle = t;
+                }
+            }
+        }
+    }
+
+    std::copy(result.begin(), result.end(), indices.begin());
+}
+
+void optimize_overdraw(
+    std::span<uint32_t> indices, std::span<const Vertex> vertices, float threshold
+)
+{
+    uint32_t vertex_count = static_cast<uint32_t>(vertices.size());
+    size_t triangle_count = indices.size() / 3;
+    if (triangle_count == 0)
+    {
+        return;
+    }
+
+    VertexCacheSimulator cache(vertex_count, VERTEX_CACHE_SIZE);
+
+    // A triangle whose vertices all miss the cache usually starts a new patch of the mesh, so
+    // those patches can be reordered without hurting the cache much.
+    std::vector<size_t> patches;
+    for (size_t t = 0; t < triangle_count; ++t)
+    {
+        if (cache.process(indices[3 * t], indices[3 * t + 1], indices[3 * t + 2]) == 3)
+        {
+            patches.emplace_back(t);
+        }
+    }
+    patches.emplace_back(triangle_count);
+
+    // Patches are split further into clusters that are as small as possible while keeping their
+    // ACMR within the threshold of the one of the patch.
+    std::vector<size_t> clusters;
+    for (size_t p = 0; p + 1 < patches.size(); ++p)
+    {
+        size_t begin = patches[p];
+        size_t end = patches[p + 1];
+
+        cache.clear();
+        uint32_t patch_misses = 0;
+        for (size_t t = begin; t < end; ++t)
+        {
+            patch_misses += cache.process(indices[3 * t], indices[3 * t + 1], indices[3 * t + 2]);
+        }
+        float max_acmr =
+            threshold * static_cast<float>(patch_misses) / static_cast<float>(end - begin);
+
+        clusters.emplace_back(begin);
+        cache.clear();
+        uint32_t misses = 0;
+        uint32_t triangles = 0;
+        for (size_t t = begin; t < end; ++t)
+        {
+            misses += cache.process(indices[3 * t], indices[3 * t + 1], indices[3 * t + 2]);
+            ++triangles;
+            if (static_cast<float>(misses) / static_cast<float>(triangles) <= max_acmr)
+            {
+                clusters.emplace_back(t + 1);
+                cache.clear();
+                misses = 0;
+                triangles = 0;
+            }
+        }
+
+        // The last cluster gets whatever is left, which tends to have a bad ACMR on its own, so it
+        // is merged with the one before. This also removes a boundary at the end of the patch.
+        if (clusters.back() != begin)
+        {
+            clusters.pop_back();
+        }
+    }
+    clusters.emplace_back(triangle_count);
+
+    glm::vec3 mesh_center(0.0f);
+    for (const Vertex &vertex : vertices)
+    {
+        mesh_center += vertex.position;
+    }
+    mesh_center /= static_cast<float>(std::max<size_t>(vertices.size(), 1));
+
+    // Clusters far out along the direction they are facing are likely to occlude others, so they
+    // are drawn first.
+    std::vector<float> sort_keys(clusters.size() - 1);
+    for (size_t c = 0; c + 1 < clusters.size(); ++c)
+    {
+        glm::vec3 weighted_center(0.0f);
+        glm::vec3 normal(0.0f);
+        float area = 0.0f;
+        for (size_t t = clusters[c]; t < clusters[c + 1]; ++t)
+        {
+            const glm::vec3 &p0 = vertices[indices[3 * t]].position;
+            const glm::vec3 &p1 = vertices[indices[3 * t + 1]].position;
+            const glm::vec3 &p2 = vertices[indices[3 * t + 2]].position;
+            // Twice the area, in the direction of the normal.
+            glm::vec3 area_normal = glm::cross(p1 - p0, p2 - p0);
+            float triangle_area = glm::length(area_normal);
+
+            weighted_center += (p0 + p1 + p2) * (triangle_area / 3.0f);
+            normal += area_normal;
+            area += triangle_area;
+        }
+
+        float normal_length = glm::length(normal);
+        if (area == 0.0f || normal_length == 0.0f)
+        {
+            sort_keys[c] = 0.0f;
+            continue;
+        }
+        glm::vec3 center = weighted_center / area;
+        sort_keys[c] = glm::dot(center - mesh_center, normal / normal_length);
+    }
+
+    std::vector<size_t> order(sort_keys.size());
+    for (size_t c = 0; c < order.size(); ++c)
+    {
+        order[c] = c;
+    }
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return sort_keys[a] > sort_keys[b];
+    });
+
+    std::vector<uint32_t> result;
+    result.reserve(indices.size());
+    for (size_t c : order)
+    {
+        result.insert(
+            result.end(),
+            indices.begin() + static_cast<ptrdiff_t>(3 * clusters[c]),
+            indices.begin() + static_cast<ptrdiff_t>(3 * clusters[c + 1])
+        );
+    }
+    std::copy(result.begin(), result.end(), indices.begin());
+}
+
+void optimize_vertex_fetch(std::span<uint32_t> indices, std::vector<Vertex> &vertices)
+{
+    std::vector<uint32_t> remap(vertices.size(), INVALID_INDEX);
+    std::vector<Vertex> result;
+    result.reserve(vertices.size());
+    for (uint32_t &index : indices)
+    {
+        if (remap[index] == INVALID_INDEX)
+        {
+            remap[index] = static_cast<uint32_t>(result.size());
+            result.emplace_back(vertices[index]);
+        }
+        index = remap[index];
+    }
+    vertices = std::move(result);
+}
+
+MeshOptimizationStats optimize_mesh(std::vector<Vertex> &vertices, std::span<uint32_t> indices)
+{
+    MeshOptimizationStats stats;
+    uint32_t vertex_count = static_cast<uint32_t>(vertices.size());
+    stats.before = analyze_vertex_cache(indices, vertex_count, VERTEX_CACHE_SIZE);
+
+    optimize_vertex_cache(indices, vertex_count);
+    optimize_overdraw(indices, vertices, OVERDRAW_ACMR_THRESHOLD);
+    optimize_vertex_fetch(indices, vertices);
+
+    stats.after =
+        analyze_vertex_cache(indices, static_cast<uint32_t>(vertices.size()), VERTEX_CACHE_SIZE);
+    return stats;
+}
+
+} // namespace Arctic::Renderer
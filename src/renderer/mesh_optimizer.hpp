@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "scene.hpp"
+
+namespace Arctic::Renderer
+{
+
+// Size of the FIFO post-transform cache that is simulated to evaluate index orders. Most GPUs
+// have caches at least this large, a smaller simulated cache keeps the estimates conservative.
+static constexpr uint32_t VERTEX_CACHE_SIZE = 16;
+
+// Clusters may be drawn in any order as long as the ACMR grows by at most this factor.
+static constexpr float OVERDRAW_ACMR_THRESHOLD = 1.05f;
+
+struct VertexCacheStats
+{
+    // Average cache misses per triangle, between 0.5 for an ideal grid and 3.
+    float acmr{0.0f};
+    // Average transforms per vertex, 1 being ideal.
+    float atvr{0.0f};
+};
+
+// Runs the indices of a triangle list through a simulated FIFO cache of `cache_size` entries.
+[[nodiscard]] VertexCacheStats analyze_vertex_cache(
+    std::span<const uint32_t> indices, uint32_t vertex_count, uint32_t cache_size
+);
+
+// Reorders the triangles to reduce post-transform cache misses, using Tom Forsyth's "Linear-Speed
+// Vertex Cache Optimisation".
+void optimize_vertex_cache(std::span<uint32_t> indices, uint32_t vertex_count);
+
+// Reorders clusters of triangles so that the ones likely to occlude others are drawn first. The
+// clusters are split off the cache optimized order wherever that keeps the ACMR of the result
+// within `threshold` times the original one, so it has to run after `optimize_vertex_cache`.
+void optimize_overdraw(
+    std::span<uint32_t> indices, std::span<const Vertex> vertices, float threshold
+);
+
+// Reorders the vertices in the order they are first referenced and drops unreferenced ones, so
+// that vertex fetches walk through memory linearly.
+void optimize_vertex_fetch(std::span<uint32_t> indices, std::vector<Vertex> &vertices);
+
+struct MeshOptimizationStats
+{
+    VertexCacheStats before;
+    VertexCacheStats after;
+};
+
+// Runs all of the optimizations above, in order.
+[[nodiscard]] MeshOptimizationStats
+optimize_mesh(std::vector<Vertex> &vertices, std::span<uint32_t> indices);
+
+} // namespace Arctic::Renderer
@@ -0,0 +1,564 @@
+#include "mesh_simplifier.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <unordered_map>
+
+#include <glm/geometric.hpp>
+
+#include "mesh_optimizer.hpp"
+
+namespace Arctic::Renderer
+{
+
+// Every level of detail aims for this fraction of the triangles of the one before.
+static constexpr float LOD_REDUCTION = 0.5f;
+// The chain ends once a level keeps more than this fraction of the triangles of the one before.
+static constexpr float LOD_MIN_REDUCTION = 0.8f;
+static constexpr size_t MAX_LODS = 6;
+// Upper limit for the error of a single level of detail, relative to the size of the mesh.
+static constexpr float LOD_MAX_RELATIVE_ERROR = 0.05f;
+
+// Sum of the squared distances to a set of planes, each weighted by the area of its triangle.
+struct Quadric
+{
+    // Upper triangle of the symmetric matrix n * n^T.
+    double a00{0.0}, a01{0.0}, a02{0.0}, a11{0.0}, a12{0.0}, a22{0.0};
+    // n * d
+    double b0{0.0}, b1{0.0}, b2{0.0};
+    // d * d
+    double c{0.0};
+    double weight{0.0};
+
+    static Quadric from_triangle(const glm::vec3 &p0, const glm::vec3 &p1, const glm::vec3 &p2)
+    {
+        glm::vec3 area_normal = glm::cross(p1 - p0, p2 - p0);
+        float length = glm::length(area_normal);
+        if (length == 0.0f)
+        {
+            return Quadric{};
+        }
+
+        double area = 0.5 * length;
+        double nx = area_normal.x / length;
+        double ny = area_normal.y / length;
+        double nz = area_normal.z / length;
+        double d = -(nx * p0.x + ny * p0.y + nz * p0.z);
+        return Quadric{
+            .a00 = area * nx * nx,
+            .a01 = area * nx * ny,
+            .a02 = area * nx * nz,
+            .a11 = area * ny * ny,
+            .a12 = area * ny * nz,
+            .a22 = area * nz * nz,
+            .b0 = area * nx * d,
+            .b1 = area * ny * d,
+            .b2 = area * nz * d,
+            .c = area * d * d,
+            .weight = area,
+        };
+    }
+
+    void add(const Quadric &other)
+    {
+        a00 += other.a00;
+        a01 += other.a01;
+        a02 += other.a02;
+        a11 += other.a11;
+        a12 += other.a12;
+        a22 += other.a22;
+        b0 += other.b0;
+        b1 += other.b1;
+        b2 += other.b2;
+        c += other.c;
+        weight += other.weight;
+    }
+
+    // Weighted mean of the squared distances of `p` to the planes.
+    [[nodiscard]] double error(const glm::vec3 &p) const
+    {
+        if (weight == 0.0)
+        {
+            return 0.0;
+        }
+        double x = p.x, y = p.y, z = p.z;
+        double squared = a00 * x * x + a11 * y * y + a22 * z * z +
+                         2.0 * (a01 * x * y + a02 * x * z + a12 * y * z) +
+                         2.0 * (b0 * x + b1 * y + b2 * z) + c;
+        return std::max(squared, 0.0) / weight;
+    }
+};
+
+// Collapses may not rotate a triangle by more than about 75 degrees.
+static constexpr float MAX_TRIANGLE_ROTATION_COS = 0.25f;
+
+static constexpr double INFINITE_ERROR = std::numeric_limits<double>::infinity();
+
+struct Collapse
+{
+    uint32_t from;
+    uint32_t to;
+    double error;
+};
+
+// Marks vertices that must not move: ones sharing their position with other vertices, which sit
+// on attribute seams, and ones on edges that do not have exactly two triangles.
+static std::vector<bool>
+find_locked_vertices(std::span<const Vertex> vertices, std::span<const uint32_t> indices)
+{
+    struct PositionHash
+    {
+        size_t operator()(const std::array<uint32_t, 3> &p) const
+        {
+            return (p[0] * 73856093u) ^ (p[1] * 19349663u) ^ (p[2] * 83492791u);
+        }
+    };
+
+    std::vector<bool> locked(vertices.size(), false);
+
+    // Representative vertex of every position.
+    std::vector<uint32_t> position_ids(vertices.size());
+    std::unordered_map<std::array<uint32_t, 3>, uint32_t, PositionHash> positions;
+    positions.reserve(vertices.size());
+    for (uint32_t v = 0; v < vertices.size(); ++v)
+    {
+        std::array<uint32_t, 3> key;
+        std::memcpy(key.data(), &vertices[v].position, sizeof(key));
+        auto [it, inserted] = positions.emplace(key, v);
+        position_ids[v] = it->second;
+        if (!inserted)
+        {
+            locked[v] = true;
+            locked[it->second] = true;
+        }
+    }
+
+    // Counts the triangles of every edge, identified by the positions of its ends.
+    std::unordered_map<uint64_t, uint32_t> edge_triangles;
+    edge_triangles.reserve(indices.size());
+    auto edge_key = [&](uint32_t a, uint32_t b) {
+        uint64_t pa = position_ids[a];
+        uint64_t pb = position_ids[b];
+        return pa < pb ? (pa << 32) | pb : (pb << 32) | pa;
+    };
+    for (size_t i = 0; i + 2 < indices.size(); i += 3)
+    {
+        for (size_t k = 0; k < 3; ++k)
+        {
+            ++edge_triangles[edge_key(indices[i + k], indices[i + (k + 1) % 3])];
+        }
+    }
+    for (size_t i = 0; i + 2 < indices.size(); i += 3)
+    {
+        for (size_t k = 0; k < 3; ++k)
+        {
+            uint32_t a = indices[i + k];
+            uint32_t b = indices[i + (k + 1) % 3];
+            if (edge_triangles[edge_key(a, b)] != 2)
+            {
+                locked[a] = true;
+                locked[b] = true;
+            }
+        }
+    }
+
+    return locked;
+}
+
+// Removes triangles that lost an edge to a collapse.
+static void remove_degenerate_triangles(std::vector<uint32_t> &indices)
+{
+    size_t write = 0;
+    for (size_t i = 0; i + 2 < indices.size(); i += 3)
+    {
+        uint32_t a = indices[i], b = indices[i + 1], c = indices[i + 2];
+        if (a != b && b != c && a != c)
+        {
+            indices[write++] = a;
+            indices[write++] = b;
+            indices[write++] = c;
+        }
+    }
+    indices.resize(write);
+}
+
+// Distance of `p` to the closest point of a triangle.
+static float distance_to_triangle(
+    const glm::vec3 &p, const glm::vec3 &a, const glm::vec3 &b, const glm::vec3 &c
+)
+{
+    glm::vec3 ab = b - a;
+    glm::vec3 ac = c - a;
+    glm::vec3 ap = p - a;
+    float d1 = glm::dot(ab, ap);
+    float d2 = glm::dot(ac, ap);
+    if (d1 <= 0.0f && d2 <= 0.0f)
+    {
+        return glm::length(ap);
+    }
+
+    glm::vec3 bp = p - b;
+    float d3 = glm::dot(ab, bp);
+    float d4 = glm::dot(ac, bp);
+    if (d3 >= 0.0f && d4 <= d3)
+    {
+        return glm::length(bp);
+    }
+
+    float vc = d1 * d4 - d3 * d2;
+    if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f)
+    {
+        return glm::length(ap - ab * (d1 / (d1 - d3)));
+    }
+
+    glm::vec3 cp = p - c;
+    float d5 = glm::dot(ab, cp);
+    float d6 = glm::dot(ac, cp);
+    if (d6 >= 0.0f && d5 <= d6)
+    {
+        return glm::length(cp);
+    }
+
+    float vb = d5 * d2 - d1 * d6;
+    if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f)
+    {
+        return glm::length(ap - ac * (d2 / (d2 - d6)));
+    }
+
+    float va = d3 * d6 - d5 * d4;
+    if (va <= 0.0f && d4 - d3 >= 0.0f && d5 - d6 >= 0.0f)
+    {
+        return glm::length(bp - (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6))));
+    }
+
+    float denominator = va + vb + vc;
+    if (denominator == 0.0f)
+    {
+        // Degenerate triangles only have their corners to go by.
+        return std::min({glm::length(ap), glm::length(bp), glm::length(cp)});
+    }
+    glm::vec3 closest = a + ab * (vb / denominator) + ac * (vc / denominator);
+    return glm::length(p - closest);
+}
+
+// Largest distance of `source_vertices` to the surface of a level of detail. Every vertex is
+// measured against the triangles around the vertex it was collapsed onto, which the surface can
+// only be closer than, so the result never underestimates the distance.
+static float max_vertex_distance(
+    std::span<const Vertex> vertices, std::span<const uint32_t> source_vertices,
+    std::span<const uint32_t> representatives, std::span<const uint32_t> level_indices
+)
+{
+    std::vector<uint32_t> offsets(vertices.size() + 1, 0);
+    for (uint32_t index : level_indices)
+    {
+        ++offsets[index + 1];
+    }
+    for (size_t v = 0; v < vertices.size(); ++v)
+    {
+        offsets[v + 1] += offsets[v];
+    }
+    std::vector<uint32_t> adjacency(level_indices.size());
+    std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+    for (size_t i = 0; i < level_indices.size(); ++i)
+    {
+        adjacency[fill[level_indices[i]]++] = static_cast<uint32_t>(i / 3);
+    }
+
+    float max_distance = 0.0f;
+    for (uint32_t v : source_vertices)
+    {
+        uint32_t representative = representatives[v];
+        const glm::vec3 &p = vertices[v].position;
+        float distance = std::numeric_limits<float>::max();
+        for (uint32_t i = offsets[representative]; i < offsets[representative + 1]; ++i)
+        {
+            const uint32_t *triangle = level_indices.data() + 3ull * adjacency[i];
+            distance = std::min(
+                distance,
+                distance_to_triangle(
+                    p,
+                    vertices[triangle[0]].position,
+                    vertices[triangle[1]].position,
+                    vertices[triangle[2]].position
+                )
+            );
+        }
+        // Vertices whose triangles all collapsed away have nothing left to be measured against.
+        if (distance != std::numeric_limits<float>::max())
+        {
+            max_distance = std::max(max_distance, distance);
+        }
+    }
+    return max_distance;
+}
+
+float simplify_mesh(
+    std::span<const Vertex> vertices, std::span<const uint32_t> indices,
+    size_t target_index_count, float max_error, std::vector<uint32_t> &out_indices,
+    std::vector<uint32_t> &out_remap
+)
+{
+    uint32_t vertex_count = static_cast<uint32_t>(vertices.size());
+    out_indices.assign(indices.begin(), indices.end());
+    out_remap.resize(vertex_count);
+    for (uint32_t v = 0; v < vertex_count; ++v)
+    {
+        out_remap[v] = v;
+    }
+    remove_degenerate_triangles(out_indices);
+
+    std::vector<bool> locked = find_locked_vertices(vertices, out_indices);
+
+    std::vector<Quadric> quadrics(vertex_count);
+    for (size_t i = 0; i + 2 < out_indices.size(); i += 3)
+    {
+        Quadric quadric = Quadric::from_triangle(
+            vertices[out_indices[i]].position,
+            vertices[out_indices[i + 1]].position,
+            vertices[out_indices[i + 2]].position
+        );
+        for (size_t k = 0; k < 3; ++k)
+        {
+            quadrics[out_indices[i + k]].add(quadric);
+        }
+    }
+
+    double max_squared_error = static_cast<double>(max_error) * static_cast<double>(max_error);
+    double largest_error = 0.0;
+
+    std::vector<uint32_t> offsets(vertex_count + 1);
+    std::vector<uint32_t> adjacency;
+    std::vector<Collapse> collapses;
+    std::vector<uint32_t> remap(vertex_count);
+    std::vector<bool> touched(vertex_count);
+
+    // Every pass collapses as many edges as possible without any of them affecting each other,
+    // cheapest first, and then rebuilds the adjacency.
+    while (out_indices.size() > target_index_count)
+    {
+        // Triangles around every vertex.
+        std::fill(offsets.begin(), offsets.end(), 0);
+        for (uint32_t index : out_indices)
+        {
+            ++offsets[index + 1];
+        }
+        for (uint32_t v = 0; v < vertex_count; ++v)
+        {
+            offsets[v + 1] += offsets[v];
+        }
+        adjacency.resize(out_indices.size());
+        {
+            std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+            for (size_t i = 0; i < out_indices.size(); ++i)
+            {
+                adjacency[fill[out_indices[i]]++] = static_cast<uint32_t>(i / 3);
+            }
+        }
+
+        // Every edge is seen once from each of its triangles, so each one is only taken from the
+        // triangle where it runs from the lower to the higher index.
+        collapses.clear();
+        for (size_t i = 0; i < out_indices.size(); i += 3)
+        {
+            for (size_t k = 0; k < 3; ++k)
+            {
+                uint32_t a = out_indices[i + k];
+                uint32_t b = out_indices[i + (k + 1) % 3];
+                if (a > b || (locked[a] && locked[b]))
+                {
+                    continue;
+                }
+
+                const glm::vec3 &pa = vertices[a].position;
+                const glm::vec3 &pb = vertices[b].position;
+                double a_to_b = locked[a] ? INFINITE_ERROR : quadrics[a].error(pb);
+                double b_to_a = locked[b] ? INFINITE_ERROR : quadrics[b].error(pa);
+                Collapse collapse = a_to_b <= b_to_a
+                                        ? Collapse{.from = a, .to = b, .error = a_to_b}
+                                        : Collapse{.from = b, .to = a, .error = b_to_a};
+                if (collapse.error <= max_squared_error)
+                {
+                    collapses.emplace_back(collapse);
+                }
+            }
+        }
+        std::sort(collapses.begin(), collapses.end(), [](const Collapse &a, const Collapse &b) {
+            return a.error < b.error;
+        });
+
+        for (uint32_t v = 0; v < vertex_count; ++v)
+        {
+            remap[v] = v;
+        }
+        std::fill(touched.begin(), touched.end(), false);
+
+        size_t triangles_to_remove = (out_indices.size() - target_index_count + 2) / 3;
+        size_t removed = 0;
+        for (const Collapse &collapse : collapses)
+        {
+            if (removed >= triangles_to_remove)
+            {
+                break;
+            }
+            if (touched[collapse.from] || touched[collapse.to])
+            {
+                continue;
+            }
+
+            // Rejects collapses that flip any of the triangles that are left, or turn them far
+            // enough to fold the surface over.
+            const glm::vec3 &target = vertices[collapse.to].position;
+            bool flips = false;
+            size_t collapsed_triangles = 0;
+            for (uint32_t i = offsets[collapse.from]; i < offsets[collapse.from + 1]; ++i)
+            {
+                const uint32_t *triangle = out_indices.data() + 3ull * adjacency[i];
+                if (triangle[0] == collapse.to || triangle[1] == collapse.to ||
+                    triangle[2] == collapse.to)
+                {
+                    ++collapsed_triangles;
+                    continue;
+                }
+
+                std::array<glm::vec3, 3> p{
+                    vertices[triangle[0]].position,
+                    vertices[triangle[1]].position,
+                    vertices[triangle[2]].position,
+                };
+                glm::vec3 before = glm::cross(p[1] - p[0], p[2] - p[0]);
+                for (size_t k = 0; k < 3; ++k)
+                {
+                    if (triangle[k] == collapse.from)
+                    {
+                        p[k] = target;
+                    }
+                }
+                glm::vec3 after = glm::cross(p[1] - p[0], p[2] - p[0]);
+                if (glm::dot(before, after) <=
+                    MAX_TRIANGLE_ROTATION_COS * glm::length(before) * glm::length(after))
+                {
+                    flips = true;
+                    break;
+                }
+            }
+            if (flips)
+            {
+                continue;
+            }
+
+            remap[collapse.from] = collapse.to;
+            quadrics[collapse.to].add(quadrics[collapse.from]);
+            largest_error = std::max(largest_error, collapse.error);
+            removed += collapsed_triangles;
+
+            // Collapses around the changed triangles have to wait for the next pass.
+            for (uint32_t i = offsets[collapse.from]; i < offsets[collapse.from + 1]; ++i)
+            {
+                const uint32_t *triangle = out_indices.data() + 3ull * adjacency[i];
+                touched[triangle[0]] = true;
+                touched[triangle[1]] = true;
+                touched[triangle[2]] = true;
+            }
+        }
+
+        if (removed == 0)
+        {
+            break;
+        }
+
+        for (uint32_t &index : out_indices)
+        {
+            index = remap[index];
+        }
+        for (uint32_t &target : out_remap)
+        {
+            target = remap[target];
+        }
+        remove_degenerate_triangles(out_indices);
+    }
+
+    return static_cast<float>(std::sqrt(largest_error));
+}
+
+void generate_lod_chain(
+    std::span<const Vertex> vertices, std::vector<uint32_t> &indices,
+    std::vector<MeshLod> &out_lods
+)
+{
+    out_lods.clear();
+    out_lods.emplace_back(MeshLod{
+        .first_index = 0,
+        .index_count = static_cast<uint32_t>(indices.size()),
+        .error = 0.0f,
+    });
+    if (vertices.empty())
+    {
+        return;
+    }
+
+    glm::vec3 bounds_min = vertices.front().position;
+    glm::vec3 bounds_max = vertices.front().position;
+    for (const Vertex &vertex : vertices)
+    {
+        bounds_min = glm::min(bounds_min, vertex.position);
+        bounds_max = glm::max(bounds_max, vertex.position);
+    }
+    float max_error = LOD_MAX_RELATIVE_ERROR * glm::length(bounds_max - bounds_min);
+
+    // Vertices of the original mesh, and the vertex each of them is collapsed onto in the last
+    // level.
+    std::vector<uint32_t> source_vertices;
+    std::vector<uint32_t> representatives(vertices.size());
+    {
+        std::vector<bool> used(vertices.size(), false);
+        for (uint32_t index : indices)
+        {
+            if (!used[index])
+            {
+                used[index] = true;
+                source_vertices.emplace_back(index);
+            }
+        }
+        for (uint32_t v = 0; v < representatives.size(); ++v)
+        {
+            representatives[v] = v;
+        }
+    }
+
+    std::vector<uint32_t> previous(indices.begin(), indices.end());
+    std::vector<uint32_t> simplified;
+    std::vector<uint32_t> remap;
+    while (out_lods.size() < MAX_LODS)
+    {
+        size_t target_index_count =
+            3 * static_cast<size_t>(static_cast<float>(previous.size() / 3) * LOD_REDUCTION);
+        (void)simplify_mesh(vertices, previous, target_index_count, max_error, simplified, remap);
+        if (simplified.empty() || static_cast<float>(simplified.size()) >
+                                      LOD_MIN_REDUCTION * static_cast<float>(previous.size()))
+        {
+            break;
+        }
+
+        for (uint32_t &representative : representatives)
+        {
+            representative = remap[representative];
+        }
+        // Measured against the original mesh rather than the level before, so errors do not
+        // have to be added up. Kept from decreasing so levels stay ordered by their error.
+        float error = max_vertex_distance(vertices, source_vertices, representatives, simplified);
+        optimize_vertex_cache(simplified, static_cast<uint32_t>(vertices.size()));
+        out_lods.emplace_back(MeshLod{
+            .first_index = static_cast<uint32_t>(indices.size()),
+            .index_count = static_cast<uint32_t>(simplified.size()),
+            .error = std::max(out_lods.back().error, error),
+        });
+        indices.insert(indices.end(), simplified.begin(), simplified.end());
+        std::swap(previous, simplified);
+    }
+}
+
+} // namespace Arctic::Renderer
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "draw_list.hpp"
+#include "scene.hpp"
+
+namespace Arctic::Renderer
+{
+
+// Simplifies a triangle list by collapsing edges in the order of their quadric error, the area
+// weighted mean squared distance of the moved vertex to the planes of the triangles it stands
+// for. Vertices are only ever moved onto other vertices, so the result indexes the same vertex
+// buffer. Vertices on open borders and attribute seams are never moved.
+//
+// Stops once the result has at most `target_index_count` indices or every collapse that is left
+// has a quadric error above `max_error` squared. Returns the square root of the largest quadric
+// error of all collapses, in object space units. That is a root mean square distance over the
+// planes of a vertex, which individual planes may exceed, so it is no bound for the distance
+// between the surfaces. `out_remap` receives the vertex every vertex was collapsed onto, itself
+// if it was kept.
+float simplify_mesh(
+    std::span<const Vertex> vertices, std::span<const uint32_t> indices,
+    size_t target_index_count, float max_error, std::vector<uint32_t> &out_indices,
+    std::vector<uint32_t> &out_remap
+);
+
+// Appends coarser levels of detail of a mesh to its indices, each one simplified from the one
+// before, and describes all of them in `out_lods`, starting with the original mesh. Each level
+// is optimized for the vertex cache. The error of a level is the largest distance of the vertices
+// of the original mesh to its surface.
+void generate_lod_chain(
+    std::span<const Vertex> vertices, std::vector<uint32_t> &indices,
+    std::vector<MeshLod> &out_lods
+);
+
+} // namespace Arctic::Renderer
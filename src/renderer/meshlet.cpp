@@ -0,0 +1,249 @@
+#include "meshlet.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+
+#include <glm/geometric.hpp>
+#include <glm/vec4.hpp>
+
+namespace Arctic::Renderer
+{
+
+// Normals this close to perpendicular to the cone axis make the cone useless for culling.
+static constexpr float MIN_CONE_DOT = 0.1f;
+
+static constexpr uint32_t NO_LOCAL_INDEX = ~0u;
+
+static MeshletBounds compute_meshlet_bounds(
+    std::span<const Vertex> vertices, const MeshletData &data, const Meshlet &meshlet
+)
+{
+    std::span<const uint32_t> meshlet_vertices(
+        data.vertices.data() + meshlet.vertex_offset, meshlet.vertex_count
+    );
+
+    glm::vec3 bounds_min = vertices[meshlet_vertices.front()].position;
+    glm::vec3 bounds_max = bounds_min;
+    for (uint32_t vertex : meshlet_vertices)
+    {
+        bounds_min = glm::min(bounds_min, vertices[vertex].position);
+        bounds_max = glm::max(bounds_max, vertices[vertex].position);
+    }
+    glm::vec3 center = (bounds_min + bounds_max) * 0.5f;
+    float radius = 0.0f;
+    for (uint32_t vertex : meshlet_vertices)
+    {
+        radius = std::max(radius, glm::length(vertices[vertex].position - center));
+    }
+
+    std::vector<glm::vec3> normals;
+    normals.reserve(meshlet.triangle_count);
+    for (uint32_t i = 0; i < meshlet.triangle_count; ++i)
+    {
+        uint32_t triangle = data.triangles[meshlet.triangle_offset + i];
+        const glm::vec3 &p0 = vertices[meshlet_vertices[triangle & 0xff]].position;
+        const glm::vec3 &p1 = vertices[meshlet_vertices[(triangle >> 8) & 0xff]].position;
+        const glm::vec3 &p2 = vertices[meshlet_vertices[(triangle >> 16) & 0xff]].position;
+        glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+        float length = glm::length(normal);
+        // Degenerate triangles are never rasterized, so they do not constrain the cone.
+        if (length > 0.0f)
+        {
+            normals.emplace_back(normal / length);
+        }
+    }
+
+    glm::vec3 axis(0.0f);
+    for (const glm::vec3 &normal : normals)
+    {
+        axis += normal;
+    }
+    float axis_length = glm::length(axis);
+    if (normals.empty() || axis_length == 0.0f)
+    {
+        return MeshletBounds{
+            .center = center,
+            .radius = radius,
+            .cone_axis = glm::vec3(0.0f, 0.0f, 1.0f),
+            .cone_cutoff = 1.0f,
+        };
+    }
+    axis /= axis_length;
+
+    float min_dot = 1.0f;
+    for (const glm::vec3 &normal : normals)
+    {
+        min_dot = std::min(min_dot, glm::dot(normal, axis));
+    }
+
+    return MeshletBounds{
+        .center = center,
+        .radius = radius,
+        .cone_axis = axis,
+        .cone_cutoff = min_dot <= MIN_CONE_DOT ? 1.0f : std::sqrt(1.0f - min_dot * min_dot),
+    };
+}
+
+uint32_t build_meshlets(
+    std::span<const Vertex> vertices, std::span<const uint32_t> indices, MeshletData &out_data
+)
+{
+    uint32_t first_meshlet = static_cast<uint32_t>(out_data.meshlets.size());
+
+    // Index of every mesh vertex within the current meshlet.
+    std::vector<uint32_t> local_indices(vertices.size(), NO_LOCAL_INDEX);
+
+    Meshlet meshlet{
+        .vertex_offset = static_cast<uint32_t>(out_data.vertices.size()),
+        .triangle_offset = static_cast<uint32_t>(out_data.triangles.size()),
+        .vertex_count = 0,
+        .triangle_count = 0,
+    };
+    auto finish_meshlet = [&] {
+        if (meshlet.triangle_count == 0)
+        {
+            return;
+        }
+        out_data.meshlets.emplace_back(meshlet);
+        out_data.bounds.emplace_back(compute_meshlet_bounds(vertices, out_data, meshlet));
+        for (uint32_t i = 0; i < meshlet.vertex_count; ++i)
+        {
+            local_indices[out_data.vertices[meshlet.vertex_offset + i]] = NO_LOCAL_INDEX;
+        }
+        meshlet = Meshlet{
+            .vertex_offset = static_cast<uint32_t>(out_data.vertices.size()),
+            .triangle_offset = static_cast<uint32_t>(out_data.triangles.size()),
+            .vertex_count = 0,
+            .triangle_count = 0,
+        };
+    };
+
+    for (size_t i = 0; i + 2 < indices.size(); i += 3)
+    {
+        std::array<uint32_t, 3> triangle{indices[i], indices[i + 1], indices[i + 2]};
+        uint32_t new_vertices = 0;
+        for (size_t k = 0; k < 3; ++k)
+        {
+            bool seen_in_triangle = std::find(
+                                        triangle.begin(), triangle.begin() + k, triangle[k]
+                                    ) != triangle.begin() + k;
+            new_vertices += local_indices[triangle[k]] == NO_LOCAL_INDEX && !seen_in_triangle;
+        }
+        if (meshlet.vertex_count + new_vertices > MESHLET_MAX_VERTICES ||
+            meshlet.triangle_count == MESHLET_MAX_TRIANGLES)
+        {
+            finish_meshlet();
+        }
+
+        uint32_t packed = 0;
+        for (size_t k = 0; k < 3; ++k)
+        {
+            uint32_t &local_index = local_indices[triangle[k]];
+            if (local_index == NO_LOCAL_INDEX)
+            {
+                local_index = meshlet.vertex_count++;
+                out_data.vertices.emplace_back(triangle[k]);
+            }
+            packed |= local_index << (8 * k);
+        }
+        out_data.triangles.emplace_back(packed);
+        ++meshlet.triangle_count;
+    }
+    finish_meshlet();
+
+    return first_meshlet;
+}
+
+void pack_meshlets(const MeshletData &data, std::vector<uint8_t> &out_buffer)
+{
+    size_t meshlets_size = data.meshlets.size() * sizeof(PackedMeshlet);
+    size_t vertices_size = data.vertices.size() * sizeof(uint32_t);
+    size_t triangles_size = data.triangles.size() * sizeof(uint32_t);
+    out_buffer.resize(meshlets_size + vertices_size + triangles_size);
+
+    for (size_t i = 0; i < data.meshlets.size(); ++i)
+    {
+        const Meshlet &meshlet = data.meshlets[i];
+        PackedMeshlet packed{
+            .vertex_offset = static_cast<uint32_t>(
+                meshlets_size + meshlet.vertex_offset * sizeof(uint32_t)
+            ),
+            .triangle_offset = static_cast<uint32_t>(
+                meshlets_size + vertices_size + meshlet.triangle_offset * sizeof(uint32_t)
+            ),
+            .vertex_count = meshlet.vertex_count,
+            .triangle_count = meshlet.triangle_count,
+            .bounds = data.bounds[i],
+        };
+        std::memcpy(out_buffer.data() + i * sizeof(PackedMeshlet), &packed, sizeof(packed));
+    }
+    std::memcpy(out_buffer.data() + meshlets_size, data.vertices.data(), vertices_size);
+    std::memcpy(
+        out_buffer.data() + meshlets_size + vertices_size, data.triangles.data(), triangles_size
+    );
+}
+
+bool meshlet_cone_culled(const MeshletBounds &bounds, const glm::vec3 &eye)
+{
+    glm::vec3 view = bounds.center - eye;
+    return glm::dot(view, bounds.cone_axis) >=
+           bounds.cone_cutoff * glm::length(view) + bounds.radius;
+}
+
+bool meshlet_cone_culled_directional(const MeshletBounds &bounds, const glm::vec3 &direction)
+{
+    return glm::dot(glm::normalize(direction), bounds.cone_axis) >= bounds.cone_cutoff;
+}
+
+bool meshlet_cone_culling_allowed(const glm::mat4 &model)
+{
+    // Relative difference of the axis lengths and their cosines that still counts as uniform.
+    static constexpr float TOLERANCE = 1.0e-3f;
+
+    glm::vec3 x(model[0]);
+    glm::vec3 y(model[1]);
+    glm::vec3 z(model[2]);
+    float scale = (glm::dot(x, x) + glm::dot(y, y) + glm::dot(z, z)) / 3.0f;
+    float tolerance = TOLERANCE * scale;
+    return scale > 0.0f && std::abs(glm::dot(x, x) - scale) <= tolerance &&
+           std::abs(glm::dot(y, y) - scale) <= tolerance &&
+           std::abs(glm::dot(z, z) - scale) <= tolerance && std::abs(glm::dot(x, y)) <= tolerance &&
+           std::abs(glm::dot(x, z)) <= tolerance && std::abs(glm::dot(y, z)) <= tolerance &&
+           glm::dot(glm::cross(x, y), z) > 0.0f;
+}
+
+bool sphere_outside_frustum(
+    const glm::mat4 &clip_from_object, const glm::vec3 &center, float radius
+)
+{
+    auto row = [&](int i) {
+        return glm::vec4(
+            clip_from_object[0][i],
+            clip_from_object[1][i],
+            clip_from_object[2][i],
+            clip_from_object[3][i]
+        );
+    };
+    // Left, right, bottom, top, near and far, all pointing inwards.
+    std::array planes{
+        row(3) + row(0),
+        row(3) - row(0),
+        row(3) + row(1),
+        row(3) - row(1),
+        row(2),
+        row(3) - row(2),
+    };
+    for (const glm::vec4 &plane : planes)
+    {
+        glm::vec3 normal(plane);
+        if (glm::dot(normal, center) + plane.w < -radius * glm::length(normal))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace Arctic::Renderer
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+
+#include "scene.hpp"
+
+namespace Arctic::Renderer
+{
+
+// Limits of a single meshlet, matching the outputs of the mesh shaders. 124 instead of 128
+// triangles keeps the primitive data of a meshlet within what NVIDIA hardware outputs at once.
+static constexpr uint32_t MESHLET_MAX_VERTICES = 64;
+static constexpr uint32_t MESHLET_MAX_TRIANGLES = 124;
+// Meshlets culled by one amplification shader thread group.
+static constexpr uint32_t MESHLET_CULL_GROUP_SIZE = 32;
+
+struct Meshlet
+{
+    // First entry in `MeshletData::vertices`.
+    uint32_t vertex_offset;
+    // First entry in `MeshletData::triangles`.
+    uint32_t triangle_offset;
+    uint32_t vertex_count;
+    uint32_t triangle_count;
+};
+
+// Object space bounds of a meshlet, used to cull it as a whole.
+struct MeshletBounds
+{
+    glm::vec3 center;
+    float radius;
+    // Normalized average of the triangle normals.
+    glm::vec3 cone_axis;
+    // Sine of the angle between the axis and the normal furthest from it, 1 if the normals are
+    // too far apart for the cone to ever cull the meshlet.
+    float cone_cutoff;
+};
+
+struct MeshletData
+{
+    std::vector<Meshlet> meshlets;
+    std::vector<MeshletBounds> bounds;
+    // Indices into the vertex buffer of the mesh.
+    std::vector<uint32_t> vertices;
+    // One triangle per entry, as three 8 bit indices into the vertices of its meshlet.
+    std::vector<uint32_t> triangles;
+};
+
+// A meshlet as the shaders read it, see `meshlet.hlsli`.
+struct PackedMeshlet
+{
+    // Byte offsets of the first vertex and triangle of the meshlet in the packed buffer.
+    uint32_t vertex_offset;
+    uint32_t triangle_offset;
+    uint32_t vertex_count;
+    uint32_t triangle_count;
+    MeshletBounds bounds;
+};
+
+static_assert(sizeof(PackedMeshlet) == 48, "PackedMeshlet does not match meshlet.hlsli");
+
+// Splits a triangle list into meshlets in the order of its triangles and appends them to
+// `out_data`, so the indices should be optimized for the vertex cache first. Returns the index of
+// the first meshlet that was added.
+uint32_t build_meshlets(
+    std::span<const Vertex> vertices, std::span<const uint32_t> indices, MeshletData &out_data
+);
+
+// Lays out the meshlets, followed by their vertices and triangles, in a single buffer.
+void pack_meshlets(const MeshletData &data, std::vector<uint8_t> &out_buffer);
+
+// Whether all triangles of a meshlet face away from a camera at `eye`. The cone is centered on
+// the bounding sphere rather than its apex, which culls a little less but needs no apex.
+[[nodiscard]] bool meshlet_cone_culled(const MeshletBounds &bounds, const glm::vec3 &eye);
+
+// Whether all triangles of a meshlet face away from an orthographic view along `direction`.
+[[nodiscard]] bool
+meshlet_cone_culled_directional(const MeshletBounds &bounds, const glm::vec3 &direction);
+
+// Whether the cone tests can be done in the object space of `model`, which needs it to keep angles
+// and the facing of triangles: a rotation, uniform scale and translation. Other transforms change
+// the angles between normals that the cones are made of.
+[[nodiscard]] bool meshlet_cone_culling_allowed(const glm::mat4 &model);
+
+// Whether a sphere is completely outside the frustum of `clip_from_object`, with a depth range
+// of [0, 1].
+[[nodiscard]] bool
+sphere_outside_frustum(const glm::mat4 &clip_from_object, const glm::vec3 &center, float radius);
+
+} // namespace Arctic::Renderer
@@ -0,0 +1,277 @@
+#include "mip_chain.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+
+#if defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define ARCTIC_MIP_CHAIN_SSE2
+#endif
+
+namespace Arctic::Renderer
+{
+
+// Linear values are quantized to this many steps before being converted back to 8 bits. It is
+// fine enough that the error stays below half a step of the sRGB curve near black.
+static constexpr uint32_t LINEAR_STEPS = 16384;
+
+struct ConversionTables
+{
+    std::array<float, 256> srgb_to_linear;
+    std::array<float, 256> unorm_to_float;
+    std::array<uint8_t, LINEAR_STEPS> linear_to_srgb;
+    std::array<uint8_t, LINEAR_STEPS> float_to_unorm;
+
+    ConversionTables()
+    {
+        for (uint32_t i = 0; i < 256; ++i)
+        {
+            float c = static_cast<float>(i) / 255.0f;
+            srgb_to_linear[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+            unorm_to_float[i] = c;
+        }
+
+        for (uint32_t i = 0; i < LINEAR_STEPS; ++i)
+        {
+            float l = static_cast<float>(i) / static_cast<float>(LINEAR_STEPS - 1);
+            float s = l <= 0.0031308f ? l * 12.92f : 1.055f * std::pow(l, 1.0f / 2.4f) - 0.055f;
+            linear_to_srgb[i] =
+                static_cast<uint8_t>(std::lround(std::clamp(s, 0.0f, 1.0f) * 255.0f));
+            float_to_unorm[i] = static_cast<uint8_t>(std::lround(l * 255.0f));
+        }
+    }
+};
+
+static const ConversionTables &conversion_tables()
+{
+    static const ConversionTables tables;
+    return tables;
+}
+
+uint32_t mip_count(uint32_t width, uint32_t height)
+{
+    uint32_t count = 1;
+    for (uint32_t size = std::max(width, height); size > 1; size /= 2)
+    {
+        count += 1;
+    }
+    return count;
+}
+
+// Averages the four texels at `p00`, `p01`, `p10` and `p11` in linear space.
+static void average_srgb_scalar(
+    const ConversionTables &tables, const uint8_t *p00, const uint8_t *p01, const uint8_t *p10,
+    const uint8_t *p11, uint8_t *dst
+)
+{
+    static constexpr float LINEAR_MAX = static_cast<float>(LINEAR_STEPS - 1);
+    for (uint32_t c = 0; c < 4; ++c)
+    {
+        const std::array<float, 256> &to_float =
+            c < 3 ? tables.srgb_to_linear : tables.unorm_to_float;
+        float sum = (to_float[p00[c]] + to_float[p01[c]]) + (to_float[p10[c]] + to_float[p11[c]]);
+        float value = std::clamp(sum * 0.25f, 0.0f, 1.0f);
+        auto idx = static_cast<uint32_t>(std::lrint(value * LINEAR_MAX));
+        dst[c] = c < 3 ? tables.linear_to_srgb[idx] : tables.float_to_unorm[idx];
+    }
+}
+
+static void average_linear_scalar(
+    const uint8_t *p00, const uint8_t *p01, const uint8_t *p10, const uint8_t *p11, uint8_t *dst
+)
+{
+    for (uint32_t c = 0; c < 4; ++c)
+    {
+        uint32_t sum = uint32_t{p00[c]} + p01[c] + p10[c] + p11[c];
+        dst[c] = static_cast<uint8_t>((sum + 2) / 4);
+    }
+}
+
+// Downsamples the destination texels `[begin_x, end_x)` of one row with the scalar kernels.
+static void downsample_row_scalar(
+    const uint8_t *row0, const uint8_t *row1, uint32_t src_width, uint8_t *dst, uint32_t begin_x,
+    uint32_t end_x, MipColorSpace color_space
+)
+{
+    const ConversionTables &tables = conversion_tables();
+    for (uint32_t x = begin_x; x < end_x; ++x)
+    {
+        uint32_t x0 = std::min(2 * x, src_width - 1);
+        uint32_t x1 = std::min(2 * x + 1, src_width - 1);
+        if (color_space == MipColorSpace::Srgb)
+        {
+            average_srgb_scalar(
+                tables,
+                row0 + 4 * x0,
+                row0 + 4 * x1,
+                row1 + 4 * x0,
+                row1 + 4 * x1,
+                dst + 4 * x
+            );
+        }
+        else
+        {
+            average_linear_scalar(
+                row0 + 4 * x0,
+                row0 + 4 * x1,
+                row1 + 4 * x0,
+                row1 + 4 * x1,
+                dst + 4 * x
+            );
+        }
+    }
+}
+
+void downsample_rgba8_scalar(
+    const uint8_t *src, uint32_t src_width, uint32_t src_height, uint8_t *dst,
+    MipColorSpace color_space
+)
+{
+    uint32_t dst_width = std::max(1u, src_width / 2);
+    uint32_t dst_height = std::max(1u, src_height / 2);
+    for (uint32_t y = 0; y < dst_height; ++y)
+    {
+        const uint8_t *row0 = src + 4ull * src_width * std::min(2 * y, src_height - 1);
+        const uint8_t *row1 = src + 4ull * src_width * std::min(2 * y + 1, src_height - 1);
+        uint8_t *dst_row = dst + 4ull * dst_width * y;
+        downsample_row_scalar(row0, row1, src_width, dst_row, 0, dst_width, color_space);
+    }
+}
+
+#ifdef ARCTIC_MIP_CHAIN_SSE2
+
+// Produces two destination texels from four texels of each source row.
+static void downsample_linear_sse2(const uint8_t *row0, const uint8_t *row1, uint8_t *dst)
+{
+    __m128i zero = _mm_setzero_si128();
+    __m128i r0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row0));
+    __m128i r1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row1));
+
+    // Vertical sums of texels 0 and 1, and of texels 2 and 3, widened to 16 bits.
+    __m128i sum_lo = _mm_add_epi16(_mm_unpacklo_epi8(r0, zero), _mm_unpacklo_epi8(r1, zero));
+    __m128i sum_hi = _mm_add_epi16(_mm_unpackhi_epi8(r0, zero), _mm_unpackhi_epi8(r1, zero));
+
+    // Horizontal sums end up in the low 64 bits of each register.
+    sum_lo = _mm_add_epi16(sum_lo, _mm_srli_si128(sum_lo, 8));
+    sum_hi = _mm_add_epi16(sum_hi, _mm_srli_si128(sum_hi, 8));
+
+    __m128i sum = _mm_unpacklo_epi64(sum_lo, sum_hi);
+    __m128i avg = _mm_srli_epi16(_mm_add_epi16(sum, _mm_set1_epi16(2)), 2);
+    _mm_storel_epi64(reinterpret_cast<__m128i *>(dst), _mm_packus_epi16(avg, zero));
+}
+
+static __m128 load_srgb_sse2(const ConversionTables &tables, const uint8_t *texel)
+{
+    return _mm_setr_ps(
+        tables.srgb_to_linear[texel[0]],
+        tables.srgb_to_linear[texel[1]],
+        tables.srgb_to_linear[texel[2]],
+        tables.unorm_to_float[texel[3]]
+    );
+}
+
+// Produces one destination texel. The table lookups stay scalar, the conversion arithmetic is
+// done for all four channels at once.
+static void downsample_srgb_sse2(
+    const ConversionTables &tables, const uint8_t *row0, const uint8_t *row1, uint8_t *dst
+)
+{
+    __m128 sum = _mm_add_ps(
+        _mm_add_ps(load_srgb_sse2(tables, row0), load_srgb_sse2(tables, row0 + 4)),
+        _mm_add_ps(load_srgb_sse2(tables, row1), load_srgb_sse2(tables, row1 + 4))
+    );
+    __m128 value = _mm_mul_ps(sum, _mm_set1_ps(0.25f));
+    value = _mm_min_ps(_mm_max_ps(value, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+    __m128i idx =
+        _mm_cvtps_epi32(_mm_mul_ps(value, _mm_set1_ps(static_cast<float>(LINEAR_STEPS - 1))));
+
+    alignas(16) std::array<int32_t, 4> indices;
+    _mm_store_si128(reinterpret_cast<__m128i *>(indices.data()), idx);
+    dst[0] = tables.linear_to_srgb[indices[0]];
+    dst[1] = tables.linear_to_srgb[indices[1]];
+    dst[2] = tables.linear_to_srgb[indices[2]];
+    dst[3] = tables.float_to_unorm[indices[3]];
+}
+
+#endif
+
+void downsample_rgba8(
+    const uint8_t *src, uint32_t src_width, uint32_t src_height, uint8_t *dst,
+    MipColorSpace color_space
+)
+{
+#ifdef ARCTIC_MIP_CHAIN_SSE2
+    const ConversionTables &tables = conversion_tables();
+    uint32_t dst_width = std::max(1u, src_width / 2);
+    uint32_t dst_height = std::max(1u, src_height / 2);
+    for (uint32_t y = 0; y < dst_height; ++y)
+    {
+        const uint8_t *row0 = src + 4ull * src_width * std::min(2 * y, src_height - 1);
+        const uint8_t *row1 = src + 4ull * src_width * std::min(2 * y + 1, src_height - 1);
+        uint8_t *dst_row = dst + 4ull * dst_width * y;
+
+        // The SIMD kernels read pairs of source texels, so only texels whose footprint lies fully
+        // inside the row are handled by them.
+        uint32_t x = 0;
+        if (color_space == MipColorSpace::Linear)
+        {
+            for (; 2 * x + 4 <= src_width && x + 2 <= dst_width; x += 2)
+            {
+                downsample_linear_sse2(row0 + 8ull * x, row1 + 8ull * x, dst_row + 4ull * x);
+            }
+        }
+        else
+        {
+            for (; 2 * x + 2 <= src_width && x < dst_width; ++x)
+            {
+                downsample_srgb_sse2(tables, row0 + 8ull * x, row1 + 8ull * x, dst_row + 4ull * x);
+            }
+        }
+        downsample_row_scalar(row0, row1, src_width, dst_row, x, dst_width, color_space);
+    }
+#else
+    downsample_rgba8_scalar(src, src_width, src_height, dst, color_space);
+#endif
+}
+
+void generate_mip_chain(
+    const uint8_t *src, uint32_t width, uint32_t height, MipColorSpace color_space,
+    MipChain &out_chain
+)
+{
+    out_chain.levels.clear();
+
+    uint64_t size = 0;
+    uint32_t level_width = width;
+    uint32_t level_height = height;
+    uint32_t count = mip_count(width, height);
+    for (uint32_t level = 0; level < count; ++level)
+    {
+        out_chain.levels.emplace_back(MipLevel{
+            .width = level_width,
+            .height = level_height,
+            .offset = size,
+        });
+        size += 4ull * level_width * level_height;
+        level_width = std::max(1u, level_width / 2);
+        level_height = std::max(1u, level_height / 2);
+    }
+
+    out_chain.data.resize(size);
+    std::memcpy(out_chain.data.data(), src, 4ull * width * height);
+    for (uint32_t level = 1; level < count; ++level)
+    {
+        const MipLevel &prev = out_chain.levels[level - 1];
+        downsample_rgba8(
+            out_chain.data.data() + prev.offset,
+            prev.width,
+            prev.height,
+            out_chain.data.data() + out_chain.levels[level].offset,
+            color_space
+        );
+    }
+}
+
+} // namespace Arctic::Renderer
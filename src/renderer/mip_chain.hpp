@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace Arctic::Renderer
+{
+
+enum class MipColorSpace
+{
+    // Channels are averaged as stored, e.g. normal maps and metalness/roughness.
+    Linear,
+    // Color channels are converted to linear space before averaging and back afterwards, alpha is
+    // averaged as stored.
+    Srgb,
+};
+
+struct MipLevel
+{
+    uint32_t width;
+    uint32_t height;
+    // Byte offset of the level in `MipChain::data`.
+    uint64_t offset;
+};
+
+// All mip levels of an RGBA8 texture, from the full resolution image down to 1x1, tightly packed
+// one after another.
+struct MipChain
+{
+    std::vector<MipLevel> levels;
+    std::vector<uint8_t> data;
+
+    [[nodiscard]] std::span<const uint8_t> level_data(size_t level) const
+    {
+        const MipLevel &mip = levels[level];
+        return std::span(data).subspan(mip.offset, 4ull * mip.width * mip.height);
+    }
+};
+
+[[nodiscard]] uint32_t mip_count(uint32_t width, uint32_t height);
+
+// Halves an RGBA8 image with a 2x2 box filter. The destination is `max(1, width / 2)` by
+// `max(1, height / 2)` texels. Uses SSE2 where available.
+void downsample_rgba8(
+    const uint8_t *src, uint32_t src_width, uint32_t src_height, uint8_t *dst,
+    MipColorSpace color_space
+);
+
+// Reference implementation of `downsample_rgba8` without SIMD. Produces identical results.
+void downsample_rgba8_scalar(
+    const uint8_t *src, uint32_t src_width, uint32_t src_height, uint8_t *dst,
+    MipColorSpace color_space
+);
+
+// Generates the full mip chain of an RGBA8 image, each level downsampled from the previous one.
+void generate_mip_chain(
+    const uint8_t *src, uint32_t width, uint32_t height, MipColorSpace color_space,
+    MipChain &out_chain
+);
+
+} // namespace Arctic::Renderer
@@ -0,0 +1,260 @@
+#include "null_backend.hpp"
+
+#include <algorithm>
+#include <array>
+#include <optional>
+#include <sstream>
+#include <utility>
+
+#include "frame_graph.hpp"
+#include "mip_chain.hpp"
+#include "procedural_mesh.hpp"
+#include "texture_image.hpp"
+
+namespace Arctic::Renderer
+{
+
+static std::string resource_state_name(ResourceState state)
+{
+    static constexpr std::array<std::pair<ResourceState, const char *>, 11> NAMES{{
+        {ResourceState::VertexAndConstantBuffer, "VertexAndConstantBuffer"},
+        {ResourceState::IndexBuffer, "IndexBuffer"},
+        {ResourceState::RenderTarget, "RenderTarget"},
+        {ResourceState::UnorderedAccess, "UnorderedAccess"},
+        {ResourceState::DepthWrite, "DepthWrite"},
+        {ResourceState::DepthRead, "DepthRead"},
+        {ResourceState::NonPixelShaderResource, "NonPixelShaderResource"},
+        {ResourceState::PixelShaderResource, "PixelShaderResource"},
+        {ResourceState::IndirectArgument, "IndirectArgument"},
+        {ResourceState::CopyDest, "CopyDest"},
+        {ResourceState::CopySource, "CopySource"},
+    }};
+
+    if (state == ResourceState::Common)
+    {
+        return "Common";
+    }
+
+    std::string name;
+    for (const auto &[flag, flag_name] : NAMES)
+    {
+        if ((state & flag) == flag)
+        {
+            if (!name.empty())
+            {
+                name += "|";
+            }
+            name += flag_name;
+        }
+    }
+    return name;
+}
+
+void RecordingCommandRecorder::begin_pass(uint32_t pass_idx)
+{
+    m_log.emplace_back("begin_pass " + m_graph->pass_name(pass_idx));
+}
+
+void RecordingCommandRecorder::barriers(const std::vector<Barrier> &barriers)
+{
+    for (const Barrier &barrier : barriers)
+    {
+        const std::string &resource = m_graph->resource_name(barrier.resource);
+        switch (barrier.type)
+        {
+            case Barrier::Type::Transition:
+                m_log.emplace_back(
+                    "transition " + resource + " " + resource_state_name(barrier.before) + " -> " +
+                    resource_state_name(barrier.after)
+                );
+                break;
+            case Barrier::Type::Uav:
+                m_log.emplace_back("uav " + resource);
+                break;
+            case Barrier::Type::Aliasing:
+                m_log.emplace_back(
+                    "aliasing " + resource + " " + resource_state_name(barrier.after)
+                );
+                break;
+        }
+    }
+}
+
+void RecordingCommandRecorder::end_pass(uint32_t pass_idx)
+{
+    m_log.emplace_back("end_pass " + m_graph->pass_name(pass_idx));
+}
+
+void RecordingCommandRecorder::draw_indexed(const DrawItem &draw)
+{
+    std::ostringstream line;
+    line << "draw_indexed mesh=" << draw.mesh_idx << " material=" << draw.material_idx
+         << " first_index=" << draw.first_index << " indices=" << draw.index_count;
+    m_log.emplace_back(line.str());
+}
+
+void RecordingCommandRecorder::upload_texture(const StreamingRequest &request)
+{
+    std::ostringstream line;
+    line << "upload_texture texture=" << request.texture << " mip=" << request.mip;
+    m_log.emplace_back(line.str());
+}
+
+std::string RecordingCommandRecorder::to_string() const
+{
+    std::string out;
+    for (const std::string &line : m_log)
+    {
+        out += line;
+        out += '\n';
+    }
+    return out;
+}
+
+MeshIdx NullRenderer::create_mesh(uint32_t index_count, MaterialIdx material_idx)
+{
+    m_meshes.emplace_back(MeshDrawInfo{
+        .lods = {MeshLod{.first_index = 0, .index_count = index_count, .error = 0.0f}},
+        .material_idx = material_idx,
+        .bounds_min = glm::vec3(-1.0f),
+        .bounds_max = glm::vec3(1.0f),
+        .bounds_center = glm::vec3(0.0f),
+        .bounds_radius = 1.0f,
+    });
+
+    // The culler reads the indices of every level of detail, so a box filling the bounds is
+    // padded with degenerate triangles up to as many indices as the mesh is said to have.
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+    generate_box(1, 2.0f, vertices, indices);
+    indices.resize(std::max<size_t>(indices.size(), index_count), 0);
+    m_software_occlusion.add_mesh(vertices, indices);
+
+    return m_meshes.size() - 1;
+}
+
+MaterialIdx NullRenderer::create_material(uint32_t texture_size)
+{
+    // Diffuse, normal and metalness/roughness, like `Material::textures`.
+    static constexpr uint32_t NUM_TEXTURES = 3;
+
+    std::vector<TextureLevel> levels;
+    compute_texture_levels(
+        TextureFormat::BC1Unorm,
+        texture_size,
+        texture_size,
+        mip_count(texture_size, texture_size),
+        0,
+        levels
+    );
+    std::vector<uint64_t> level_sizes;
+    for (const TextureLevel &level : levels)
+    {
+        level_sizes.emplace_back(level.size);
+    }
+
+    MaterialIdx material_idx = m_material_count++;
+    for (uint32_t i = 0; i < NUM_TEXTURES; ++i)
+    {
+        m_streamed_textures.emplace_back(StreamedTextureDesc{
+            .material_idx = material_idx,
+            .streaming_idx =
+                m_texture_streaming.add_texture(texture_size, texture_size, level_sizes, 4),
+            .size = texture_size,
+            .mip_count = static_cast<uint32_t>(level_sizes.size()),
+        });
+    }
+    return material_idx;
+}
+
+void NullRenderer::render_frame(const Scene &scene, const Settings &settings)
+{
+    // Matches the placement alignment of D3D12 render targets and depth buffers.
+    static constexpr uint64_t TRANSIENT_ALIGNMENT = 64 * 1024;
+
+    m_recorder.clear();
+
+    setup_frame(
+        scene,
+        settings,
+        m_height,
+        m_meshes,
+        m_material_count,
+        m_streamed_textures,
+        m_software_occlusion,
+        m_texture_streaming,
+        m_frame
+    );
+    for (const StreamingRequest &request : m_frame.streaming_requests)
+    {
+        m_recorder.upload_texture(request);
+        m_texture_streaming.complete(request.texture);
+        m_texture_streaming.release(request.texture);
+    }
+
+    uint64_t pixel_count = static_cast<uint64_t>(m_width) * m_height;
+    auto record_draws = [&](const std::vector<DrawItem> &draws) {
+        for (const DrawItem &draw : draws)
+        {
+            m_recorder.draw_indexed(draw);
+        }
+    };
+
+    auto transient = [&](uint64_t bytes_per_pixel, ResourceState initial_state) {
+        return TransientDesc{
+            .size = pixel_count * bytes_per_pixel,
+            .alignment = TRANSIENT_ALIGNMENT,
+            .initial_state = initial_state,
+        };
+    };
+    // R8G8B8A8_UNORM_SRGB, R16G16_SNORM and R8G8_UNORM.
+    std::optional<GBufferDescs> gbuffer;
+    if (settings.deferred_shading)
+    {
+        gbuffer = GBufferDescs{
+            .base_color = transient(4, ResourceState::RenderTarget),
+            .normal = transient(4, ResourceState::RenderTarget),
+            .metalness_roughness = transient(2, ResourceState::RenderTarget),
+        };
+    }
+
+    m_render_graph.reset();
+    declare_frame_graph(
+        m_render_graph,
+        FrameGraphResources{
+            .sun_shadow_map = nullptr,
+            .backbuffer = nullptr,
+            .occlusion_predicates = nullptr,
+            .exposure = nullptr,
+            // R16G16B16A16_FLOAT and D32_FLOAT.
+            .color_target = transient(8, ResourceState::RenderTarget),
+            .depth_target = transient(4, ResourceState::DepthWrite),
+            // R32_FLOAT at half the resolution, plus a third for the smaller levels.
+            .hiz =
+                TransientDesc{
+                    .size = pixel_count * 4 / 3,
+                    .alignment = TRANSIENT_ALIGNMENT,
+                    .initial_state = ResourceState::UnorderedAccess,
+                },
+            .gbuffer = gbuffer,
+        },
+        FrameGraphPasses{
+            .shadow_map = [&] { record_draws(m_frame.shadow_draws); },
+            .forward = [&] { record_draws(m_frame.draws); },
+            // Occlusion culling happens on the GPU, so every draw is recorded in the early phase.
+            .hiz = [] {},
+            .occlusion_cull = [] {},
+            .forward_late = [] {},
+            .deferred_lighting = [] {},
+            .skybox = [] {},
+            .auto_exposure = [] {},
+            .post_process = [] {},
+            .imgui = [] {},
+        }
+    );
+
+    m_compiled = m_render_graph.compile();
+    m_render_graph.execute(m_compiled, m_recorder);
+}
+
+} // namespace Arctic::Renderer
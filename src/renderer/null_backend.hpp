@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "../job_system.hpp"
+#include "command_recorder.hpp"
+#include "draw_list.hpp"
+#include "frame_setup.hpp"
+#include "render_graph.hpp"
+#include "scene.hpp"
+#include "software_occlusion.hpp"
+#include "texture_streaming.hpp"
+
+namespace Arctic::Renderer
+{
+
+// Records everything a frame would submit to the GPU as one line of text per command. Two logs
+// can be compared line by line to find where the command streams of two frames diverge.
+class RecordingCommandRecorder final : public CommandRecorder
+{
+    const RenderGraph *m_graph;
+    std::vector<std::string> m_log;
+
+  public:
+    explicit RecordingCommandRecorder(const RenderGraph &graph) : m_graph(&graph)
+    {
+    }
+
+    void begin_pass(uint32_t pass_idx) override;
+
+    void barriers(const std::vector<Barrier> &barriers) override;
+
+    void end_pass(uint32_t pass_idx) override;
+
+    void draw_indexed(const DrawItem &draw);
+
+    void upload_texture(const StreamingRequest &request);
+
+    void clear()
+    {
+        m_log.clear();
+    }
+
+    [[nodiscard]] const std::vector<std::string> &log() const
+    {
+        return m_log;
+    }
+
+    [[nodiscard]] std::string to_string() const;
+};
+
+// Runs the CPU side of `Renderer::render_frame` without a device: the same `setup_frame` with
+// software occlusion culling, draw list building and texture streaming decisions, then frame
+// graph declaration and compilation, transient placement and barrier sequencing. Meshes are boxes
+// filling their bounds, materials only carry the sizes of their textures and transient sizes are
+// estimated from the texture dimensions.
+class NullRenderer
+{
+    static constexpr uint64_t TEXTURE_STREAMING_BUDGET = 512ull * 1024 * 1024;
+
+    uint32_t m_width;
+    uint32_t m_height;
+
+    JobSystem m_jobs;
+    SoftwareOcclusionCuller m_software_occlusion;
+    TextureStreamingPolicy m_texture_streaming;
+
+    std::vector<MeshDrawInfo> m_meshes;
+    size_t m_material_count{0};
+    std::vector<StreamedTextureDesc> m_streamed_textures;
+    FrameSetup m_frame;
+
+    RenderGraph m_render_graph;
+    RecordingCommandRecorder m_recorder;
+    CompiledGraph m_compiled;
+
+  public:
+    NullRenderer(uint32_t width, uint32_t height)
+        : m_width(width), m_height(height), m_software_occlusion(&m_jobs),
+          m_texture_streaming(TextureStreamingConfig{.budget = TEXTURE_STREAMING_BUDGET}),
+          m_recorder(m_render_graph)
+    {
+    }
+
+    MeshIdx create_mesh(uint32_t index_count, MaterialIdx material_idx);
+
+    // Creates a material with block compressed textures of `texture_size` squared texels, as
+    // many as `Renderer` materials have, and registers them for streaming.
+    MaterialIdx create_material(uint32_t texture_size);
+
+    // Records the commands of one frame, including the uploads of streamed textures. Uploads
+    // complete right away, as there are no frames in flight. The log of the previous frame is
+    // discarded.
+    void render_frame(const Scene &scene, const Settings &settings);
+
+    [[nodiscard]] const RecordingCommandRecorder &recorder() const
+    {
+        return m_recorder;
+    }
+
+    [[nodiscard]] const CompiledGraph &compiled_graph() const
+    {
+        return m_compiled;
+    }
+};
+
+} // namespace Arctic::Renderer
@@ -0,0 +1,429 @@
+#include "occlusion_cull_pass.hpp"
+
+#include <vector>
+
+#include <directx/d3dx12.h>
+
+#include <spdlog/spdlog.h>
+
+#include "tracy/Tracy.hpp"
+#include "tracy/TracyD3D12.hpp"
+
+#include "dxerr.hpp"
+
+#define CONSTANTS_SIZE(ty) ((sizeof(ty) + 3) / 4)
+
+namespace Arctic::Renderer
+{
+
+bool OcclusionCullPass::init()
+{
+    if (!init_hiz_pipeline())
+    {
+        spdlog::error("OcclusionCullPass::init: failed to initialize hiz pipeline");
+        return false;
+    }
+    if (!init_cull_pipeline())
+    {
+        spdlog::error("OcclusionCullPass::init: failed to initialize cull pipeline");
+        return false;
+    }
+
+    if (!m_rhi->create_buffer(
+            sizeof(GpuStats),
+            D3D12_RESOURCE_STATE_COPY_DEST,
+            D3D12_HEAP_TYPE_DEFAULT,
+            MemoryCategory::Constants,
+            m_gpu_stats,
+            D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS
+        ))
+    {
+        spdlog::error("OcclusionCullPass::init: failed to create stats buffer");
+        return false;
+    }
+    m_gpu_stats->SetName(L"occlusion stats");
+
+    GpuStats zero_stats{};
+    if (!m_rhi->create_buffer(
+            sizeof(GpuStats),
+            D3D12_RESOURCE_STATE_COPY_SOURCE,
+            D3D12_HEAP_TYPE_DEFAULT,
+            MemoryCategory::Constants,
+            m_zero_stats
+        ) ||
+        !m_rhi->upload_to_buffer(
+            m_zero_stats.Get(),
+            D3D12_RESOURCE_STATE_COPY_SOURCE,
+            &zero_stats,
+            sizeof(zero_stats)
+        ))
+    {
+        spdlog::error("OcclusionCullPass::init: failed to create zeroed stats buffer");
+        return false;
+    }
+    m_zero_stats->SetName(L"occlusion stats zero");
+
+    if (!m_rhi->create_buffer(
+            RHI::NUM_FRAMES * sizeof(GpuStats),
+            D3D12_RESOURCE_STATE_COPY_DEST,
+            D3D12_HEAP_TYPE_READBACK,
+            MemoryCategory::Staging,
+            m_stats_readback
+        ))
+    {
+        spdlog::error("OcclusionCullPass::init: failed to create stats readback buffer");
+        return false;
+    }
+    m_stats_readback->SetName(L"occlusion stats readback");
+    // Readback heaps may stay mapped, every slot is only read once its frame has completed.
+    DXERR(
+        m_stats_readback->Map(0, nullptr, reinterpret_cast<void **>(&m_mapped_stats_readback)),
+        "OcclusionCullPass::init: failed to map stats readback buffer"
+    );
+
+    return true;
+}
+
+bool OcclusionCullPass::init_hiz_pipeline()
+{
+    std::vector<uint8_t> cs_code;
+    if (!m_rhi->compiler().compile_shader(L"./shaders/hiz.hlsl", L"cs_main", L"cs_6_6", cs_code))
+    {
+        spdlog::error("OcclusionCullPass::init_hiz_pipeline: failed to compile compute shader");
+        return false;
+    }
+
+    ComPtr<ID3DBlob> root_signature;
+
+    std::array<CD3DX12_ROOT_PARAMETER, 1> root_parameters{};
+    root_parameters[0].InitAsConstants(CONSTANTS_SIZE(HizConstants), 0);
+
+    CD3DX12_ROOT_SIGNATURE_DESC root_signature_desc;
+    root_signature_desc.Init(
+        static_cast<UINT>(root_parameters.size()),
+        root_parameters.data(),
+        0,
+        nullptr,
+        D3D12_ROOT_SIGNATURE_FLAG_CBV_SRV_UAV_HEAP_DIRECTLY_INDEXED
+    );
+    DXERR(
+        D3D12SerializeRootSignature(
+            &root_signature_desc,
+            D3D_ROOT_SIGNATURE_VERSION_1,
+            &root_signature,
+            nullptr
+        ),
+        "OcclusionCullPass::init_hiz_pipeline: failed to serialize root signature"
+    );
+    DXERR(
+        m_rhi->device()->CreateRootSignature(
+            0,
+            root_signature->GetBufferPointer(),
+            root_signature->GetBufferSize(),
+            IID_PPV_ARGS(&m_hiz_root_signature)
+        ),
+        "OcclusionCullPass::init_hiz_pipeline: failed to create root signature"
+    );
+
+    D3D12_COMPUTE_PIPELINE_STATE_DESC pipeline_desc{};
+    pipeline_desc.pRootSignature = m_hiz_root_signature.Get();
+    pipeline_desc.CS = CD3DX12_SHADER_BYTECODE(cs_code.data(), cs_code.size());
+    DXERR(
+        m_rhi->device()->CreateComputePipelineState(&pipeline_desc, IID_PPV_ARGS(&m_hiz_pipeline)),
+        "OcclusionCullPass::init_hiz_pipeline: failed to create pipeline state"
+    );
+    spdlog::trace("OcclusionCullPass::init_hiz_pipeline: created pipeline state");
+
+    return true;
+}
+
+bool OcclusionCullPass::init_cull_pipeline()
+{
+    std::vector<uint8_t> cs_code;
+    if (!m_rhi->compiler()
+             .compile_shader(L"./shaders/occlusion_cull.hlsl", L"cs_main", L"cs_6_6", cs_code))
+    {
+        spdlog::error("OcclusionCullPass::init_cull_pipeline: failed to compile compute shader");
+        return false;
+    }
+
+    ComPtr<ID3DBlob> root_signature;
+
+    // The buffers are bound as root descriptors, only the depth pyramid needs a view.
+    std::array<CD3DX12_ROOT_PARAMETER, 4> root_parameters{};
+    root_parameters[0].InitAsConstants(CONSTANTS_SIZE(CullConstants), 0);
+    root_parameters[1].InitAsShaderResourceView(0);
+    root_parameters[2].InitAsUnorderedAccessView(0);
+    root_parameters[3].InitAsUnorderedAccessView(1);
+
+    CD3DX12_ROOT_SIGNATURE_DESC root_signature_desc;
+    root_signature_desc.Init(
+        static_cast<UINT>(root_parameters.size()),
+        root_parameters.data(),
+        0,
+        nullptr,
+        D3D12_ROOT_SIGNATURE_FLAG_CBV_SRV_UAV_HEAP_DIRECTLY_INDEXED
+    );
+    DXERR(
+        D3D12SerializeRootSignature(
+            &root_signature_desc,
+            D3D_ROOT_SIGNATURE_VERSION_1,
+            &root_signature,
+            nullptr
+        ),
+        "OcclusionCullPass::init_cull_pipeline: failed to serialize root signature"
+    );
+    DXERR(
+        m_rhi->device()->CreateRootSignature(
+            0,
+            root_signature->GetBufferPointer(),
+            root_signature->GetBufferSize(),
+            IID_PPV_ARGS(&m_cull_root_signature)
+        ),
+        "OcclusionCullPass::init_cull_pipeline: failed to create root signature"
+    );
+
+    D3D12_COMPUTE_PIPELINE_STATE_DESC pipeline_desc{};
+    pipeline_desc.pRootSignature = m_cull_root_signature.Get();
+    pipeline_desc.CS = CD3DX12_SHADER_BYTECODE(cs_code.data(), cs_code.size());
+    DXERR(
+        m_rhi->device()->CreateComputePipelineState(
+            &pipeline_desc,
+            IID_PPV_ARGS(&m_cull_pipeline)
+        ),
+        "OcclusionCullPass::init_cull_pipeline: failed to create pipeline state"
+    );
+    spdlog::trace("OcclusionCullPass::init_cull_pipeline: created pipeline state");
+
+    return true;
+}
+
+bool OcclusionCullPass::reserve_predicates(size_t object_count)
+{
+    if (m_predicates_capacity >= object_count)
+    {
+        return true;
+    }
+
+    // Frames in flight may still read the old predicates.
+    if (!m_rhi->flush())
+    {
+        spdlog::error("OcclusionCullPass::reserve_predicates: failed to flush");
+        return false;
+    }
+
+    size_t capacity = std::max(object_count, 2 * m_predicates_capacity);
+    m_predicates.Reset();
+    m_predicates_capacity = 0;
+    // The graph keeps the predicates in the predication state between frames, so the buffer is
+    // created in it as well.
+    if (!m_rhi->create_buffer(
+            2 * capacity * sizeof(uint64_t),
+            D3D12_RESOURCE_STATE_PREDICATION,
+            D3D12_HEAP_TYPE_DEFAULT,
+            MemoryCategory::Constants,
+            m_predicates,
+            D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS
+        ))
+    {
+        spdlog::error("OcclusionCullPass::reserve_predicates: failed to create buffer");
+        return false;
+    }
+    m_predicates->SetName(L"occlusion predicates");
+
+    // Nothing is known about the visibility of the new objects, so the early phase draws all of
+    // them.
+    std::vector<uint64_t> visible(2 * capacity, 1);
+    if (!m_rhi->upload_to_buffer(
+            m_predicates.Get(),
+            D3D12_RESOURCE_STATE_PREDICATION,
+            visible.data(),
+            visible.size() * sizeof(uint64_t)
+        ))
+    {
+        spdlog::error("OcclusionCullPass::reserve_predicates: failed to initialize buffer");
+        return false;
+    }
+    m_predicates_capacity = capacity;
+
+    return true;
+}
+
+bool OcclusionCullPass::reserve_cull_draws(size_t draw_count)
+{
+    UINT frame = m_rhi->current_frame_index();
+    if (m_cull_draws_capacity[frame] >= draw_count)
+    {
+        return true;
+    }
+
+    // The GPU is done with the buffer of this frame, so it can be replaced right away.
+    size_t capacity = std::max(draw_count, 2 * m_cull_draws_capacity[frame]);
+    m_cull_draws[frame].Reset();
+    m_mapped_cull_draws[frame] = nullptr;
+    m_cull_draws_capacity[frame] = 0;
+    if (!m_rhi->create_buffer(
+            capacity * sizeof(CullDraw),
+            D3D12_RESOURCE_STATE_GENERIC_READ,
+            D3D12_HEAP_TYPE_UPLOAD,
+            MemoryCategory::Constants,
+            m_cull_draws[frame]
+        ))
+    {
+        spdlog::error("OcclusionCullPass::reserve_cull_draws: failed to create buffer");
+        return false;
+    }
+    m_cull_draws[frame]->SetName(L"occlusion cull draws");
+
+    D3D12_RANGE read_range{.Begin = 0, .End = 0};
+    DXERR(
+        m_cull_draws[frame]->Map(
+            0, &read_range, reinterpret_cast<void **>(&m_mapped_cull_draws[frame])
+        ),
+        "OcclusionCullPass::reserve_cull_draws: failed to map buffer"
+    );
+    m_cull_draws_capacity[frame] = capacity;
+
+    return true;
+}
+
+void OcclusionCullPass::run_hiz(ID3D12GraphicsCommandList *cmd_list, const HizRunData &run_data)
+{
+    ZoneScoped;
+    TracyD3D12Zone(m_rhi->tracy_ctx(), cmd_list, "HiZ Pass");
+
+    cmd_list->SetComputeRootSignature(m_hiz_root_signature.Get());
+    cmd_list->SetPipelineState(m_hiz_pipeline.Get());
+
+    uint32_t mip_count = hiz_mip_count(run_data.viewport_width, run_data.viewport_height);
+    uint32_t input_width = run_data.viewport_width;
+    uint32_t input_height = run_data.viewport_height;
+    for (uint32_t mip = 0; mip < mip_count; ++mip)
+    {
+        HizConstants constants{
+            .input_idx = mip == 0 ? run_data.depth_srv_idx : run_data.hiz_first_uav_idx + mip - 1,
+            .output_idx = run_data.hiz_first_uav_idx + mip,
+            .input_is_depth = mip == 0,
+            .input_width = input_width,
+            .input_height = input_height,
+            .output_width = hiz_extent(input_width),
+            .output_height = hiz_extent(input_height),
+        };
+        cmd_list->SetComputeRoot32BitConstants(0, CONSTANTS_SIZE(HizConstants), &constants, 0);
+        cmd_list->Dispatch(
+            (constants.output_width + HIZ_GROUP_SIZE - 1) / HIZ_GROUP_SIZE,
+            (constants.output_height + HIZ_GROUP_SIZE - 1) / HIZ_GROUP_SIZE,
+            1
+        );
+
+        // Every level reads the one before it. The last one is synchronized by the render graph.
+        if (mip + 1 < mip_count)
+        {
+            CD3DX12_RESOURCE_BARRIER barrier = CD3DX12_RESOURCE_BARRIER::UAV(run_data.hiz);
+            cmd_list->ResourceBarrier(1, &barrier);
+        }
+
+        input_width = constants.output_width;
+        input_height = constants.output_height;
+    }
+}
+
+void OcclusionCullPass::run_cull(ID3D12GraphicsCommandList *cmd_list, const CullRunData &run_data)
+{
+    ZoneScoped;
+    TracyD3D12Zone(m_rhi->tracy_ctx(), cmd_list, "Occlusion Cull Pass");
+
+    // The previous frame with this index has completed, so its counters can be read.
+    UINT frame = m_rhi->current_frame_index();
+    if (m_stats_pending[frame])
+    {
+        const GpuStats &gpu_stats = m_mapped_stats_readback[frame];
+        m_stats = OcclusionStats{
+            .draw_count = m_stats_draw_counts[frame],
+            .frustum_culled = gpu_stats.frustum_culled,
+            .occluded = gpu_stats.occluded,
+            .late_draws = gpu_stats.late_draws,
+        };
+        m_stats_pending[frame] = false;
+    }
+
+    if (run_data.draws.empty())
+    {
+        return;
+    }
+    if (!reserve_cull_draws(run_data.draws.size()))
+    {
+        spdlog::error("OcclusionCullPass::run_cull: failed to reserve draws");
+        return;
+    }
+    for (size_t i = 0; i < run_data.draws.size(); ++i)
+    {
+        const DrawItem &draw = run_data.draws[i];
+        if (draw.object_idx >= m_predicates_capacity)
+        {
+            spdlog::error("OcclusionCullPass::run_cull: predicates have not been reserved");
+            return;
+        }
+        m_mapped_cull_draws[frame][i] = CullDraw{
+            .bounds = glm::vec4(draw.bounds_center, draw.bounds_radius),
+            .object_idx = draw.object_idx,
+        };
+    }
+
+    cmd_list->CopyResource(m_gpu_stats.Get(), m_zero_stats.Get());
+    CD3DX12_RESOURCE_BARRIER barrier = CD3DX12_RESOURCE_BARRIER::Transition(
+        m_gpu_stats.Get(),
+        D3D12_RESOURCE_STATE_COPY_DEST,
+        D3D12_RESOURCE_STATE_UNORDERED_ACCESS
+    );
+    cmd_list->ResourceBarrier(1, &barrier);
+
+    CullConstants constants{
+        .proj_view = run_data.proj_view,
+        .viewport_width = static_cast<float>(run_data.viewport_width),
+        .viewport_height = static_cast<float>(run_data.viewport_height),
+        .hiz_idx = run_data.hiz_srv_idx,
+        .hiz_mip_count = hiz_mip_count(run_data.viewport_width, run_data.viewport_height),
+        .hiz_width = hiz_extent(run_data.viewport_width),
+        .hiz_height = hiz_extent(run_data.viewport_height),
+        .draw_count = static_cast<uint32_t>(run_data.draws.size()),
+        .late_predicates_offset = static_cast<uint32_t>(late_predicates_offset()),
+    };
+
+    cmd_list->SetComputeRootSignature(m_cull_root_signature.Get());
+    cmd_list->SetPipelineState(m_cull_pipeline.Get());
+    cmd_list->SetComputeRoot32BitConstants(0, CONSTANTS_SIZE(CullConstants), &constants, 0);
+    cmd_list->SetComputeRootShaderResourceView(1, m_cull_draws[frame]->GetGPUVirtualAddress());
+    cmd_list->SetComputeRootUnorderedAccessView(2, m_predicates->GetGPUVirtualAddress());
+    cmd_list->SetComputeRootUnorderedAccessView(3, m_gpu_stats->GetGPUVirtualAddress());
+    cmd_list->Dispatch(
+        (constants.draw_count + OCCLUSION_CULL_GROUP_SIZE - 1) / OCCLUSION_CULL_GROUP_SIZE,
+        1,
+        1
+    );
+
+    barrier = CD3DX12_RESOURCE_BARRIER::Transition(
+        m_gpu_stats.Get(),
+        D3D12_RESOURCE_STATE_UNORDERED_ACCESS,
+        D3D12_RESOURCE_STATE_COPY_SOURCE
+    );
+    cmd_list->ResourceBarrier(1, &barrier);
+    cmd_list->CopyBufferRegion(
+        m_stats_readback.Get(),
+        frame * sizeof(GpuStats),
+        m_gpu_stats.Get(),
+        0,
+        sizeof(GpuStats)
+    );
+    barrier = CD3DX12_RESOURCE_BARRIER::Transition(
+        m_gpu_stats.Get(),
+        D3D12_RESOURCE_STATE_COPY_SOURCE,
+        D3D12_RESOURCE_STATE_COPY_DEST
+    );
+    cmd_list->ResourceBarrier(1, &barrier);
+
+    m_stats_draw_counts[frame] = constants.draw_count;
+    m_stats_pending[frame] = true;
+}
+
+} // namespace Arctic::Renderer
@@ -0,0 +1,215 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <span>
+
+#include <d3d12.h>
+
+#include <glm/mat4x4.hpp>
+
+#include "comptr.hpp"
+#include "draw_list.hpp"
+#include "rhi.hpp"
+
+namespace Arctic::Renderer
+{
+
+// Has to match the group sizes in `hiz.hlsl` and `occlusion_cull.hlsl`.
+static constexpr uint32_t HIZ_GROUP_SIZE = 8;
+static constexpr uint32_t OCCLUSION_CULL_GROUP_SIZE = 64;
+
+// Enough levels for a 65536 pixel wide depth buffer.
+static constexpr uint32_t MAX_HIZ_MIPS = 16;
+
+struct OcclusionStats
+{
+    uint32_t draw_count{0};
+    uint32_t frustum_culled{0};
+    // Draws inside the frustum that are hidden behind the depth of the early draws.
+    uint32_t occluded{0};
+    // Draws that were not visible in the previous frame but are in this one.
+    uint32_t late_draws{0};
+};
+
+// Two phase occlusion culling against a hierarchical depth buffer. The forward pass first draws
+// everything that was visible in the previous frame. A depth pyramid is built from the resulting
+// depth buffer, every draw is tested against it and the draws that turned visible are drawn in a
+// second forward pass.
+//
+// Draws are skipped with predication, so the draw list stays the same for both phases and both
+// the input assembler and the mesh shader path. The predicate buffer holds one 64 bit value per
+// object of the scene for each phase: the early predicates are written by the culling of the
+// previous frame, the late ones by the culling of the current frame. They are indexed by object
+// rather than by draw, since objects culled on the CPU are left out of the draw list and shift
+// the draws after them. Objects left out keep the visibility they last had.
+class OcclusionCullPass
+{
+    // See `hiz.hlsl`.
+    struct HizConstants
+    {
+        uint32_t input_idx;
+        uint32_t output_idx;
+        uint32_t input_is_depth;
+        uint32_t padding0{0};
+        uint32_t input_width;
+        uint32_t input_height;
+        uint32_t output_width;
+        uint32_t output_height;
+    };
+
+    // See `occlusion_cull.hlsl`.
+    struct CullConstants
+    {
+        glm::mat4 proj_view;
+        float viewport_width;
+        float viewport_height;
+        uint32_t hiz_idx;
+        uint32_t hiz_mip_count;
+        uint32_t hiz_width;
+        uint32_t hiz_height;
+        uint32_t draw_count;
+        uint32_t late_predicates_offset;
+    };
+
+    // See `occlusion_cull.hlsl`.
+    struct CullDraw
+    {
+        // World space bounding sphere.
+        glm::vec4 bounds;
+        uint32_t object_idx;
+        uint32_t padding0{0};
+        uint32_t padding1{0};
+        uint32_t padding2{0};
+    };
+
+    // Counters written by the culling shader, in the order of `OcclusionStats`.
+    struct GpuStats
+    {
+        uint32_t frustum_culled;
+        uint32_t occluded;
+        uint32_t late_draws;
+        uint32_t padding0;
+    };
+
+  public:
+    struct HizRunData
+    {
+        ID3D12Resource *hiz;
+        uint32_t depth_srv_idx;
+        // Views of every level of the pyramid, in consecutive descriptors.
+        uint32_t hiz_first_uav_idx;
+        uint32_t viewport_width;
+        uint32_t viewport_height;
+    };
+
+    struct CullRunData
+    {
+        uint32_t hiz_srv_idx;
+        uint32_t viewport_width;
+        uint32_t viewport_height;
+        std::span<const DrawItem> draws;
+        const glm::mat4 &proj_view;
+    };
+
+  private:
+    RHI *m_rhi;
+
+    ComPtr<ID3D12RootSignature> m_hiz_root_signature;
+    ComPtr<ID3D12PipelineState> m_hiz_pipeline;
+
+    ComPtr<ID3D12RootSignature> m_cull_root_signature;
+    ComPtr<ID3D12PipelineState> m_cull_pipeline;
+
+    ComPtr<ID3D12Resource> m_predicates;
+    size_t m_predicates_capacity{0};
+
+    // The draws to test, one upload buffer per frame in flight.
+    std::array<ComPtr<ID3D12Resource>, RHI::NUM_FRAMES> m_cull_draws;
+    std::array<CullDraw *, RHI::NUM_FRAMES> m_mapped_cull_draws{};
+    std::array<size_t, RHI::NUM_FRAMES> m_cull_draws_capacity{};
+
+    // The counters are reset by copying from a zeroed buffer and copied into the slot of their
+    // frame in the readback buffer, which is read once the frame slot comes around again.
+    ComPtr<ID3D12Resource> m_gpu_stats;
+    ComPtr<ID3D12Resource> m_zero_stats;
+    ComPtr<ID3D12Resource> m_stats_readback;
+    GpuStats *m_mapped_stats_readback{nullptr};
+    std::array<uint32_t, RHI::NUM_FRAMES> m_stats_draw_counts{};
+    std::array<bool, RHI::NUM_FRAMES> m_stats_pending{};
+    OcclusionStats m_stats;
+
+    OcclusionCullPass() = delete;
+    OcclusionCullPass(const OcclusionCullPass &) = delete;
+    OcclusionCullPass &operator=(const OcclusionCullPass &) = delete;
+    OcclusionCullPass(OcclusionCullPass &&) = delete;
+    OcclusionCullPass &operator=(OcclusionCullPass &&) = delete;
+
+  public:
+    explicit OcclusionCullPass(RHI *rhi) : m_rhi(rhi)
+    {
+    }
+
+    // The first level of the pyramid is half the size of the depth buffer, every other level
+    // half the size of the one before, rounded down like the mip levels of a texture.
+    [[nodiscard]] static uint32_t hiz_extent(uint32_t viewport_extent)
+    {
+        return std::max(1u, viewport_extent / 2);
+    }
+
+    [[nodiscard]] static uint32_t hiz_mip_count(uint32_t viewport_width, uint32_t viewport_height)
+    {
+        uint32_t extent = std::max(hiz_extent(viewport_width), hiz_extent(viewport_height));
+        uint32_t mip_count = 1;
+        while (extent > 1 && mip_count < MAX_HIZ_MIPS)
+        {
+            extent /= 2;
+            ++mip_count;
+        }
+        return mip_count;
+    }
+
+    [[nodiscard]] bool init();
+
+    // Makes room for the predicates of `object_count` objects. Growing the buffer waits for the
+    // GPU, and all objects are treated as visible in the previous frame afterwards.
+    [[nodiscard]] bool reserve_predicates(size_t object_count);
+
+    // Builds the depth pyramid from the depth buffer of the early draws.
+    void run_hiz(ID3D12GraphicsCommandList *cmd_list, const HizRunData &run_data);
+
+    // Tests every draw against the depth pyramid and writes the predicates.
+    void run_cull(ID3D12GraphicsCommandList *cmd_list, const CullRunData &run_data);
+
+    [[nodiscard]] ID3D12Resource *predicates() const
+    {
+        return m_predicates.Get();
+    }
+
+    [[nodiscard]] uint64_t early_predicates_offset() const
+    {
+        return 0;
+    }
+
+    [[nodiscard]] uint64_t late_predicates_offset() const
+    {
+        return m_predicates_capacity * sizeof(uint64_t);
+    }
+
+    // Counts of the most recent frame whose culling results have been read back.
+    [[nodiscard]] const OcclusionStats &stats() const
+    {
+        return m_stats;
+    }
+
+  private:
+    [[nodiscard]] bool init_hiz_pipeline();
+
+    [[nodiscard]] bool init_cull_pipeline();
+
+    // Makes room for `draw_count` draws in the buffer of the current frame.
+    [[nodiscard]] bool reserve_cull_draws(size_t draw_count);
+};
+
+} // namespace Arctic::Renderer
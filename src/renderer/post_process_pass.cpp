@@ -14,17 +14,24 @@ namespace Arctic::Renderer
 
 bool PostProcessPass::init()
 {
-    std::vector<uint8_t> cs_code;
+    std::vector<uint8_t> vs_code, ps_code;
     if (!m_rhi->compiler()
-             .compile_shader(L"./shaders/post_process.hlsl", L"main", L"cs_6_6", cs_code))
+             .compile_shader(L"./shaders/post_process.hlsl", L"vs_main", L"vs_6_6", vs_code))
     {
-        spdlog::error("PostProcessPass::init: failed to compile shader");
+        spdlog::error("PostProcessPass::init: failed to compile vertex shader");
         return false;
     }
-    spdlog::trace("PostProcessPass::init: compiled shader");
+    if (!m_rhi->compiler()
+             .compile_shader(L"./shaders/post_process.hlsl", L"ps_main", L"ps_6_6", ps_code))
+    {
+        spdlog::error("PostProcessPass::init: failed to compile pixel shader");
+        return false;
+    }
+    spdlog::trace("PostProcessPass::init: compiled shaders");
 
-    std::array<CD3DX12_ROOT_PARAMETER, 1> root_parameters{};
+    std::array<CD3DX12_ROOT_PARAMETER, 2> root_parameters{};
     root_parameters[0].InitAsConstants(CONSTANTS_SIZE(ConstantBuffer), 0);
+    root_parameters[1].InitAsShaderResourceView(0, 0, D3D12_SHADER_VISIBILITY_PIXEL);
 
     CD3DX12_ROOT_SIGNATURE_DESC root_signature_desc;
     root_signature_desc.Init(
@@ -59,11 +66,24 @@ bool PostProcessPass::init()
     );
     spdlog::trace("PostProcessPass::init: created root signature");
 
-    D3D12_COMPUTE_PIPELINE_STATE_DESC pipeline_desc{};
+    // The tonemapped image is written straight into the swapchain image, which cannot be bound
+    // as a UAV, hence a full screen triangle instead of a compute shader.
+    D3D12_GRAPHICS_PIPELINE_STATE_DESC pipeline_desc{};
     pipeline_desc.pRootSignature = m_root_signature.Get();
-    pipeline_desc.CS = {cs_code.data(), cs_code.size()};
+    pipeline_desc.VS = {vs_code.data(), vs_code.size()};
+    pipeline_desc.PS = {ps_code.data(), ps_code.size()};
+    pipeline_desc.BlendState = CD3DX12_BLEND_DESC(CD3DX12_DEFAULT());
+    pipeline_desc.SampleMask = ~0u;
+    pipeline_desc.RasterizerState = CD3DX12_RASTERIZER_DESC(CD3DX12_DEFAULT());
+    pipeline_desc.RasterizerState.CullMode = D3D12_CULL_MODE_NONE;
+    pipeline_desc.DepthStencilState = CD3DX12_DEPTH_STENCIL_DESC(CD3DX12_DEFAULT());
+    pipeline_desc.DepthStencilState.DepthEnable = FALSE;
+    pipeline_desc.PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;
+    pipeline_desc.NumRenderTargets = 1;
+    pipeline_desc.RTVFormats[0] = m_rhi->swapchain_format();
+    pipeline_desc.SampleDesc = {1, 0};
     DXERR(
-        m_rhi->device()->CreateComputePipelineState(&pipeline_desc, IID_PPV_ARGS(&m_pipeline)),
+        m_rhi->device()->CreateGraphicsPipelineState(&pipeline_desc, IID_PPV_ARGS(&m_pipeline)),
         "PostProcessPass::init: failed to create pipeline state"
     );
 
@@ -76,22 +96,42 @@ void PostProcessPass::run(ID3D12GraphicsCommandList *cmd_list, const RunData &ru
     TracyD3D12Zone(m_rhi->tracy_ctx(), cmd_list, "Post Process Pass");
 
     ConstantBuffer constants{
-        .input_idx = run_data.input_uav_idx,
-        .output_idx = run_data.output_uav_idx,
+        .input_idx = run_data.input_srv_idx,
 
         .gamma = run_data.gamma,
         .tm_method = run_data.tm_method,
         .exposure = run_data.exposure,
+        .auto_exposure = run_data.auto_exposure,
     };
 
-    cmd_list->SetComputeRootSignature(m_root_signature.Get());
+    cmd_list->SetGraphicsRootSignature(m_root_signature.Get());
     cmd_list->SetPipelineState(m_pipeline.Get());
-    cmd_list->SetComputeRoot32BitConstants(0, CONSTANTS_SIZE(ConstantBuffer), &constants, 0);
-    cmd_list->Dispatch(
-        (run_data.viewport_width + GROUP_WIDTH - 1) / GROUP_WIDTH,
-        (run_data.viewport_height + GROUP_HEIGHT - 1) / GROUP_HEIGHT,
-        1
+    cmd_list->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+    cmd_list->OMSetRenderTargets(1, &run_data.output_rtv, FALSE, nullptr);
+
+    D3D12_VIEWPORT viewport{
+        .TopLeftX = 0.0f,
+        .TopLeftY = 0.0f,
+        .Width = static_cast<float>(run_data.viewport_width),
+        .Height = static_cast<float>(run_data.viewport_height),
+        .MinDepth = 0.0f,
+        .MaxDepth = 1.0f,
+    };
+    cmd_list->RSSetViewports(1, &viewport);
+    D3D12_RECT scissor{
+        .left = 0,
+        .top = 0,
+        .right = static_cast<long>(run_data.viewport_width),
+        .bottom = static_cast<long>(run_data.viewport_height),
+    };
+    cmd_list->RSSetScissorRects(1, &scissor);
+
+    cmd_list->SetGraphicsRoot32BitConstants(0, CONSTANTS_SIZE(ConstantBuffer), &constants, 0);
+    cmd_list->SetGraphicsRootShaderResourceView(
+        1,
+        run_data.auto_exposure_buffer->GetGPUVirtualAddress()
     );
+    cmd_list->DrawInstanced(3, 1, 0, 0);
 }
 
 } // namespace Arctic::Renderer
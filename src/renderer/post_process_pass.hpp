@@ -15,30 +15,31 @@ class PostProcessPass
     struct ConstantBuffer
     {
         uint32_t input_idx;
-        uint32_t output_idx;
 
         float gamma;
         uint32_t tm_method;
         float exposure;
+        uint32_t auto_exposure;
     };
 
   public:
     struct RunData
     {
-        uint32_t input_uav_idx;
-        uint32_t output_uav_idx;
+        uint32_t input_srv_idx;
+        D3D12_CPU_DESCRIPTOR_HANDLE output_rtv;
         uint32_t viewport_width;
         uint32_t viewport_height;
 
         uint32_t tm_method;
         float gamma;
         float exposure;
+        // Scales the image by the exposure `AutoExposurePass` wrote into `auto_exposure_buffer`
+        // before any tone mapping, instead of using `exposure`.
+        bool auto_exposure;
+        ID3D12Resource *auto_exposure_buffer;
     };
 
   private:
-    static constexpr uint32_t GROUP_WIDTH = 16;
-    static constexpr uint32_t GROUP_HEIGHT = 16;
-
     RHI *m_rhi;
 
     ComPtr<ID3D12RootSignature> m_root_signature;
@@ -0,0 +1,88 @@
+#include "procedural_mesh.hpp"
+
+#include <cmath>
+
+#include <glm/geometric.hpp>
+
+namespace Arctic::Renderer
+{
+
+void generate_box(
+    uint32_t subdivisions, float size, std::vector<Vertex> &out_vertices,
+    std::vector<uint32_t> &out_indices
+)
+{
+    for (uint32_t axis = 0; axis < 3; ++axis)
+    {
+        for (float sign : {-1.0f, 1.0f})
+        {
+            glm::vec3 normal(0.0f);
+            normal[static_cast<glm::length_t>(axis)] = sign;
+            glm::vec3 u(0.0f);
+            u[static_cast<glm::length_t>((axis + 1) % 3)] = 1.0f;
+            glm::vec3 v = glm::cross(normal, u);
+
+            uint32_t first_vertex = static_cast<uint32_t>(out_vertices.size());
+            for (uint32_t j = 0; j <= subdivisions; ++j)
+            {
+                for (uint32_t i = 0; i <= subdivisions; ++i)
+                {
+                    float s = static_cast<float>(i) / static_cast<float>(subdivisions) - 0.5f;
+                    float t = static_cast<float>(j) / static_cast<float>(subdivisions) - 0.5f;
+                    Vertex vertex{};
+                    vertex.position = (normal * 0.5f + u * s + v * t) * size;
+                    vertex.normal = normal;
+                    out_vertices.emplace_back(vertex);
+                }
+            }
+            for (uint32_t j = 0; j < subdivisions; ++j)
+            {
+                for (uint32_t i = 0; i < subdivisions; ++i)
+                {
+                    uint32_t a = first_vertex + j * (subdivisions + 1) + i;
+                    uint32_t b = a + 1;
+                    uint32_t c = a + subdivisions + 1;
+                    uint32_t d = c + 1;
+                    out_indices.insert(out_indices.end(), {a, b, d, a, d, c});
+                }
+            }
+        }
+    }
+}
+
+void generate_torus(
+    uint32_t rings, uint32_t sides, float major_radius, float minor_radius,
+    std::vector<Vertex> &out_vertices, std::vector<uint32_t> &out_indices
+)
+{
+    static constexpr float TAU = 6.28318530718f;
+
+    uint32_t first_vertex = static_cast<uint32_t>(out_vertices.size());
+    for (uint32_t ring = 0; ring < rings; ++ring)
+    {
+        float u = TAU * static_cast<float>(ring) / static_cast<float>(rings);
+        for (uint32_t side = 0; side < sides; ++side)
+        {
+            float v = TAU * static_cast<float>(side) / static_cast<float>(sides);
+            glm::vec3 normal(std::cos(u) * std::cos(v), std::sin(v), std::sin(u) * std::cos(v));
+            glm::vec3 center(std::cos(u) * major_radius, 0.0f, std::sin(u) * major_radius);
+            Vertex vertex{};
+            vertex.position = center + normal * minor_radius;
+            vertex.normal = normal;
+            out_vertices.emplace_back(vertex);
+        }
+    }
+    for (uint32_t ring = 0; ring < rings; ++ring)
+    {
+        for (uint32_t side = 0; side < sides; ++side)
+        {
+            uint32_t a = first_vertex + ring * sides + side;
+            uint32_t b = first_vertex + ((ring + 1) % rings) * sides + side;
+            uint32_t c = first_vertex + ((ring + 1) % rings) * sides + (side + 1) % sides;
+            uint32_t d = first_vertex + ring * sides + (side + 1) % sides;
+            out_indices.insert(out_indices.end(), {a, d, b, b, d, c});
+        }
+    }
+}
+
+} // namespace Arctic::Renderer
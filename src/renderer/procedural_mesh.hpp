@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "scene.hpp"
+
+namespace Arctic::Renderer
+{
+
+// Cube of edge length `size` around the origin with every face split into `subdivisions` squared
+// quads, with counter-clockwise, outward facing triangles. Appends to the outputs.
+void generate_box(
+    uint32_t subdivisions, float size, std::vector<Vertex> &out_vertices,
+    std::vector<uint32_t> &out_indices
+);
+
+// Closed torus around the y axis with `rings` segments around the axis and `sides` around the
+// tube, with counter-clockwise, outward facing triangles. Appends to the outputs.
+void generate_torus(
+    uint32_t rings, uint32_t sides, float major_radius, float minor_radius,
+    std::vector<Vertex> &out_vertices, std::vector<uint32_t> &out_indices
+);
+
+} // namespace Arctic::Renderer
@@ -0,0 +1,409 @@
+#include "render_graph.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+#include <spdlog/spdlog.h>
+
+#include "command_recorder.hpp"
+
+namespace Arctic::Renderer
+{
+
+static constexpr ResourceState WRITE_STATES = ResourceState::RenderTarget |
+                                              ResourceState::UnorderedAccess |
+                                              ResourceState::DepthWrite | ResourceState::CopyDest;
+
+bool is_write_state(ResourceState state)
+{
+    return (state & WRITE_STATES) != ResourceState::Common;
+}
+
+static uint64_t align_up(uint64_t value, uint64_t alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+RenderGraph::PassBuilder &
+RenderGraph::PassBuilder::read(ResourceHandle resource, ResourceState state)
+{
+    assert(!is_write_state(state));
+    m_graph->m_passes[m_pass_idx].accesses.emplace_back(Access{resource, state});
+    return *this;
+}
+
+RenderGraph::PassBuilder &
+RenderGraph::PassBuilder::write(ResourceHandle resource, ResourceState state)
+{
+    assert(is_write_state(state));
+
+    // A resource can only be in one state while a pass writes it, and write states can not be
+    // combined, e.g. a render target that is also an unordered access view is invalid.
+    Pass &pass = m_graph->m_passes[m_pass_idx];
+    for (const Access &access : pass.accesses)
+    {
+        if (access.resource.idx == resource.idx && is_write_state(access.state) &&
+            access.state != state)
+        {
+            spdlog::error(
+                "RenderGraph::PassBuilder::write: pass {} writes {} in conflicting states",
+                pass.name,
+                m_graph->m_resources[resource.idx].name
+            );
+            return *this;
+        }
+    }
+
+    pass.accesses.emplace_back(Access{resource, state});
+    return *this;
+}
+
+void RenderGraph::reset()
+{
+    m_resources.clear();
+    m_passes.clear();
+}
+
+ResourceHandle RenderGraph::import_resource(
+    std::string name, void *native_resource, ResourceState initial_state,
+    std::optional<ResourceState> final_state
+)
+{
+    auto it = m_persistent_states.find(name);
+    if (it != m_persistent_states.end())
+    {
+        initial_state = it->second;
+    }
+
+    ResourceHandle handle{static_cast<uint32_t>(m_resources.size())};
+    m_resources.emplace_back(Resource{
+        .name = std::move(name),
+        .native_resource = native_resource,
+        .initial_state = initial_state,
+        .final_state = final_state,
+        .transient = std::nullopt,
+    });
+    return handle;
+}
+
+ResourceHandle RenderGraph::create_transient(std::string name, const TransientDesc &desc)
+{
+    ResourceHandle handle = import_resource(std::move(name), nullptr, desc.initial_state);
+    m_resources[handle.idx].transient = desc;
+    return handle;
+}
+
+RenderGraph::PassBuilder RenderGraph::add_pass(std::string name, std::function<void()> &&execute)
+{
+    uint32_t pass_idx = static_cast<uint32_t>(m_passes.size());
+    m_passes.emplace_back(Pass{
+        .name = std::move(name),
+        .execute = std::move(execute),
+        .accesses = {},
+    });
+    return PassBuilder(this, pass_idx);
+}
+
+CompiledGraph RenderGraph::compile()
+{
+    const size_t num_resources = m_resources.size();
+    const size_t num_passes = m_passes.size();
+
+    // The state every pass needs each resource in, or `std::nullopt` if the pass does not touch
+    // the resource. Multiple accesses of one resource within a pass are combined: read states are
+    // merged, a write state supersedes any reads since all write states imply read access. There
+    // is at most one write state per resource and pass, see `PassBuilder::write`.
+    std::vector<std::vector<std::optional<ResourceState>>> required(
+        num_passes,
+        std::vector<std::optional<ResourceState>>(num_resources)
+    );
+    for (size_t pass_idx = 0; pass_idx < num_passes; ++pass_idx)
+    {
+        for (const Access &access : m_passes[pass_idx].accesses)
+        {
+            std::optional<ResourceState> &state = required[pass_idx][access.resource.idx];
+            if (!state.has_value())
+            {
+                state = access.state;
+            }
+            else if (is_write_state(access.state))
+            {
+                state = access.state;
+            }
+            else if (!is_write_state(*state))
+            {
+                state = *state | access.state;
+            }
+        }
+    }
+
+    std::vector<ResourceState> current(num_resources);
+    std::vector<bool> last_access_was_uav_write(num_resources, false);
+    for (size_t res_idx = 0; res_idx < num_resources; ++res_idx)
+    {
+        current[res_idx] = m_resources[res_idx].initial_state;
+    }
+
+    CompiledGraph compiled;
+    compiled.passes.reserve(num_passes);
+    for (size_t pass_idx = 0; pass_idx < num_passes; ++pass_idx)
+    {
+        CompiledPass compiled_pass{.pass_idx = static_cast<uint32_t>(pass_idx), .barriers = {}};
+
+        for (size_t res_idx = 0; res_idx < num_resources; ++res_idx)
+        {
+            if (!required[pass_idx][res_idx].has_value())
+            {
+                continue;
+            }
+
+            ResourceState needed = *required[pass_idx][res_idx];
+            ResourceHandle handle{static_cast<uint32_t>(res_idx)};
+
+            if (is_write_state(needed))
+            {
+                if (current[res_idx] != needed)
+                {
+                    compiled_pass.barriers.emplace_back(Barrier{
+                        .type = Barrier::Type::Transition,
+                        .resource = handle,
+                        .before = current[res_idx],
+                        .after = needed,
+                    });
+                    current[res_idx] = needed;
+                }
+                else if (needed == ResourceState::UnorderedAccess &&
+                         last_access_was_uav_write[res_idx])
+                {
+                    compiled_pass.barriers.emplace_back(Barrier{
+                        .type = Barrier::Type::Uav,
+                        .resource = handle,
+                        .before = needed,
+                        .after = needed,
+                    });
+                }
+                last_access_was_uav_write[res_idx] = needed == ResourceState::UnorderedAccess;
+                continue;
+            }
+
+            last_access_was_uav_write[res_idx] = false;
+
+            // A read-only state that already contains everything this pass needs can be reused
+            // as is, since no write happened in between.
+            bool current_is_read = !is_write_state(current[res_idx]) &&
+                                   current[res_idx] != ResourceState::Common;
+            if (current_is_read && (current[res_idx] & needed) == needed)
+            {
+                continue;
+            }
+
+            // Look ahead to all following reads up to the next write and transition into the
+            // union of their states once, instead of once per differing read.
+            ResourceState combined = needed;
+            for (size_t next_idx = pass_idx + 1; next_idx < num_passes; ++next_idx)
+            {
+                const std::optional<ResourceState> &next = required[next_idx][res_idx];
+                if (!next.has_value())
+                {
+                    continue;
+                }
+                if (is_write_state(*next))
+                {
+                    break;
+                }
+                combined = combined | *next;
+            }
+
+            compiled_pass.barriers.emplace_back(Barrier{
+                .type = Barrier::Type::Transition,
+                .resource = handle,
+                .before = current[res_idx],
+                .after = combined,
+            });
+            current[res_idx] = combined;
+        }
+
+        compiled.passes.emplace_back(std::move(compiled_pass));
+    }
+
+    // Every transient resource that shares memory with another one, either within this frame or
+    // across frames, has to be activated with an aliasing barrier before its first use.
+    allocate_transients(compiled);
+    for (TransientAllocation &allocation : compiled.transients)
+    {
+        allocation.aliased = std::any_of(
+            compiled.transients.begin(),
+            compiled.transients.end(),
+            [&](const TransientAllocation &other) {
+                return other.resource.idx != allocation.resource.idx &&
+                       other.offset < allocation.offset + allocation.size &&
+                       allocation.offset < other.offset + other.size;
+            }
+        );
+        if (!allocation.aliased)
+        {
+            continue;
+        }
+
+        // `after` is the state the resource is in once all barriers of the pass have been
+        // issued, so backends know which initialization (clear or discard) is valid.
+        std::vector<Barrier> &barriers = compiled.passes[allocation.first_pass].barriers;
+        ResourceState state_at_first_use = allocation.initial_state;
+        for (const Barrier &barrier : barriers)
+        {
+            if (barrier.resource.idx == allocation.resource.idx)
+            {
+                state_at_first_use = barrier.after;
+            }
+        }
+        barriers.insert(
+            barriers.begin(),
+            Barrier{
+                .type = Barrier::Type::Aliasing,
+                .resource = allocation.resource,
+                .before = allocation.initial_state,
+                .after = state_at_first_use,
+            }
+        );
+    }
+
+    for (size_t res_idx = 0; res_idx < num_resources; ++res_idx)
+    {
+        const Resource &resource = m_resources[res_idx];
+        if (resource.final_state.has_value() && current[res_idx] != *resource.final_state)
+        {
+            compiled.final_barriers.emplace_back(Barrier{
+                .type = Barrier::Type::Transition,
+                .resource = ResourceHandle{static_cast<uint32_t>(res_idx)},
+                .before = current[res_idx],
+                .after = *resource.final_state,
+            });
+            current[res_idx] = *resource.final_state;
+        }
+
+        m_persistent_states[resource.name] = current[res_idx];
+    }
+
+    return compiled;
+}
+
+void RenderGraph::allocate_transients(CompiledGraph &compiled) const
+{
+    for (size_t res_idx = 0; res_idx < m_resources.size(); ++res_idx)
+    {
+        const Resource &resource = m_resources[res_idx];
+        if (!resource.transient.has_value())
+        {
+            continue;
+        }
+
+        std::optional<uint32_t> first_pass, last_pass;
+        for (uint32_t position = 0; position < compiled.passes.size(); ++position)
+        {
+            const Pass &pass = m_passes[compiled.passes[position].pass_idx];
+            bool accessed = std::any_of(
+                pass.accesses.begin(),
+                pass.accesses.end(),
+                [&](const Access &access) { return access.resource.idx == res_idx; }
+            );
+            if (accessed)
+            {
+                if (!first_pass.has_value())
+                {
+                    first_pass = position;
+                }
+                last_pass = position;
+            }
+        }
+
+        // Transient resources no pass uses do not need any memory.
+        if (!first_pass.has_value())
+        {
+            continue;
+        }
+
+        compiled.transients.emplace_back(TransientAllocation{
+            .resource = ResourceHandle{static_cast<uint32_t>(res_idx)},
+            .offset = 0,
+            .size = resource.transient->size,
+            .initial_state = resource.initial_state,
+            .first_pass = *first_pass,
+            .last_pass = *last_pass,
+            .aliased = false,
+        });
+        compiled.transient_unaliased_size +=
+            align_up(resource.transient->size, resource.transient->alignment);
+    }
+
+    // Place the largest resources first, each at the lowest offset that does not collide with an
+    // already placed resource whose lifetime overlaps.
+    std::vector<size_t> order(compiled.transients.size());
+    for (size_t i = 0; i < order.size(); ++i)
+    {
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return compiled.transients[a].size > compiled.transients[b].size;
+    });
+
+    std::vector<const TransientAllocation *> placed;
+    std::vector<const TransientAllocation *> conflicts;
+    for (size_t idx : order)
+    {
+        TransientAllocation &allocation = compiled.transients[idx];
+        uint64_t alignment = m_resources[allocation.resource.idx].transient->alignment;
+
+        conflicts.clear();
+        for (const TransientAllocation *other : placed)
+        {
+            if (other->first_pass <= allocation.last_pass &&
+                allocation.first_pass <= other->last_pass)
+            {
+                conflicts.emplace_back(other);
+            }
+        }
+        std::sort(
+            conflicts.begin(),
+            conflicts.end(),
+            [](const TransientAllocation *a, const TransientAllocation *b) {
+                return a->offset < b->offset;
+            }
+        );
+
+        uint64_t offset = 0;
+        for (const TransientAllocation *conflict : conflicts)
+        {
+            if (align_up(offset, alignment) + allocation.size <= conflict->offset)
+            {
+                break;
+            }
+            offset = std::max(offset, conflict->offset + conflict->size);
+        }
+        allocation.offset = align_up(offset, alignment);
+
+        compiled.transient_heap_size =
+            std::max(compiled.transient_heap_size, allocation.offset + allocation.size);
+        placed.emplace_back(&allocation);
+    }
+}
+
+void RenderGraph::execute(const CompiledGraph &compiled, CommandRecorder &recorder) const
+{
+    for (const CompiledPass &compiled_pass : compiled.passes)
+    {
+        recorder.begin_pass(compiled_pass.pass_idx);
+        if (!compiled_pass.barriers.empty())
+        {
+            recorder.barriers(compiled_pass.barriers);
+        }
+        m_passes[compiled_pass.pass_idx].execute();
+        recorder.end_pass(compiled_pass.pass_idx);
+    }
+
+    if (!compiled.final_barriers.empty())
+    {
+        recorder.barriers(compiled.final_barriers);
+    }
+}
+
+} // namespace Arctic::Renderer
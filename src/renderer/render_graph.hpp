@@ -0,0 +1,227 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Arctic::Renderer
+{
+
+class CommandRecorder;
+
+// Mirrors the bit values of D3D12_RESOURCE_STATES so the render graph can be compiled without
+// including any D3D12 headers, while still converting to native states with a plain cast.
+enum class ResourceState : uint32_t
+{
+    Common = 0,
+    Present = 0,
+    VertexAndConstantBuffer = 0x1,
+    IndexBuffer = 0x2,
+    RenderTarget = 0x4,
+    UnorderedAccess = 0x8,
+    DepthWrite = 0x10,
+    DepthRead = 0x20,
+    NonPixelShaderResource = 0x40,
+    PixelShaderResource = 0x80,
+    IndirectArgument = 0x200,
+    CopyDest = 0x400,
+    CopySource = 0x800,
+};
+
+[[nodiscard]] constexpr ResourceState operator|(ResourceState a, ResourceState b)
+{
+    return static_cast<ResourceState>(static_cast<uint32_t>(a) | static_cast<uint32_t>(b));
+}
+
+[[nodiscard]] constexpr ResourceState operator&(ResourceState a, ResourceState b)
+{
+    return static_cast<ResourceState>(static_cast<uint32_t>(a) & static_cast<uint32_t>(b));
+}
+
+[[nodiscard]] bool is_write_state(ResourceState state);
+
+struct ResourceHandle
+{
+    uint32_t idx;
+};
+
+struct Barrier
+{
+    enum class Type
+    {
+        Transition,
+        Uav,
+        // Activates a transient resource whose memory is shared with other transient resources.
+        // The resource contents are undefined afterwards.
+        Aliasing,
+    };
+
+    Type type;
+    ResourceHandle resource;
+    ResourceState before;
+    ResourceState after;
+};
+
+struct TransientDesc
+{
+    // Size and alignment of the resource as reported by the device for its resource description.
+    uint64_t size;
+    uint64_t alignment;
+    // The state the resource should be created in. Only used if the graph does not know the
+    // resource from a previous frame.
+    ResourceState initial_state;
+};
+
+struct TransientAllocation
+{
+    ResourceHandle resource;
+    // Byte offset into the shared transient heap.
+    uint64_t offset;
+    uint64_t size;
+    // The state the resource is expected to be in at the beginning of the frame, i.e. the state
+    // it has to be created in if the physical resource does not exist yet.
+    ResourceState initial_state;
+    uint32_t first_pass;
+    uint32_t last_pass;
+    // Whether the memory is shared with another transient resource, in which case the resource is
+    // activated with an aliasing barrier before its first use in every frame.
+    bool aliased;
+};
+
+struct CompiledPass
+{
+    uint32_t pass_idx;
+    // All barriers that have to be issued before the pass is executed. They are meant to be
+    // submitted with a single ResourceBarrier call.
+    std::vector<Barrier> barriers;
+};
+
+struct CompiledGraph
+{
+    std::vector<CompiledPass> passes;
+    // Barriers that bring resources with a required final state back into that state after the
+    // last pass, e.g. the backbuffer which has to be in the present state.
+    std::vector<Barrier> final_barriers;
+
+    std::vector<TransientAllocation> transients;
+    // Size of the heap required to place all transient resources at their aliased offsets.
+    uint64_t transient_heap_size{0};
+    // Memory that would be required if every transient resource had its own allocation.
+    uint64_t transient_unaliased_size{0};
+};
+
+class RenderGraph
+{
+    struct Resource
+    {
+        std::string name;
+        void *native_resource;
+        ResourceState initial_state;
+        std::optional<ResourceState> final_state;
+        std::optional<TransientDesc> transient;
+    };
+
+    struct Access
+    {
+        ResourceHandle resource;
+        ResourceState state;
+    };
+
+    struct Pass
+    {
+        std::string name;
+        std::function<void()> execute;
+        std::vector<Access> accesses;
+    };
+
+    std::vector<Resource> m_resources;
+    std::vector<Pass> m_passes;
+
+    // The state every resource was left in at the end of the last compiled frame, keyed by the
+    // resource name. Importing a resource again starts from this state instead of requiring
+    // passes to transition it back at the end of every frame.
+    std::unordered_map<std::string, ResourceState> m_persistent_states;
+
+    void allocate_transients(CompiledGraph &compiled) const;
+
+  public:
+    class PassBuilder
+    {
+        RenderGraph *m_graph;
+        uint32_t m_pass_idx;
+
+      public:
+        PassBuilder(RenderGraph *graph, uint32_t pass_idx) : m_graph(graph), m_pass_idx(pass_idx)
+        {
+        }
+
+        PassBuilder &read(ResourceHandle resource, ResourceState state);
+
+        // Writing a resource that the pass already writes in a different state is an error and
+        // is ignored.
+        PassBuilder &write(ResourceHandle resource, ResourceState state);
+    };
+
+    RenderGraph() = default;
+
+    // Removes all passes and resources of the previous frame. Resource states are kept.
+    void reset();
+
+    // Makes an externally owned resource known to the graph. `initial_state` is only used the
+    // first time a resource with this name is imported, afterwards the state the graph left it in
+    // is used. If `final_state` is set the resource is transitioned into it after the last pass.
+    ResourceHandle import_resource(
+        std::string name, void *native_resource, ResourceState initial_state,
+        std::optional<ResourceState> final_state = std::nullopt
+    );
+
+    // Declares a resource that only lives for the duration of the frame. Transient resources
+    // whose lifetimes do not overlap are assigned overlapping offsets in a shared heap; the
+    // native resource has to be set with `set_native_resource` after compiling.
+    ResourceHandle create_transient(std::string name, const TransientDesc &desc);
+
+    void set_native_resource(ResourceHandle resource, void *native_resource)
+    {
+        m_resources[resource.idx].native_resource = native_resource;
+    }
+
+    PassBuilder add_pass(std::string name, std::function<void()> &&execute);
+
+    // Computes the barriers required before every pass. Consecutive reads of a resource in
+    // different read-only states are merged into a single transition into the combined state.
+    // Also computes the lifetimes and heap offsets of all transient resources.
+    [[nodiscard]] CompiledGraph compile();
+
+    // Runs the passes of a compiled graph in order and hands their barriers to `recorder`.
+    void execute(const CompiledGraph &compiled, CommandRecorder &recorder) const;
+
+    [[nodiscard]] void *native_resource(ResourceHandle resource) const
+    {
+        return m_resources[resource.idx].native_resource;
+    }
+
+    [[nodiscard]] const std::string &resource_name(ResourceHandle resource) const
+    {
+        return m_resources[resource.idx].name;
+    }
+
+    [[nodiscard]] bool is_transient(ResourceHandle resource) const
+    {
+        return m_resources[resource.idx].transient.has_value();
+    }
+
+    [[nodiscard]] const std::string &pass_name(uint32_t pass_idx) const
+    {
+        return m_passes[pass_idx].name;
+    }
+
+    [[nodiscard]] size_t pass_count() const
+    {
+        return m_passes.size();
+    }
+};
+
+} // namespace Arctic::Renderer
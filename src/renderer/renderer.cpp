@@ -1,7 +1,16 @@
 #include "renderer.hpp"
 
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <limits>
+#include <optional>
+
 #include <directx/d3dx12.h>
 
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+
 #include <spdlog/spdlog.h>
 
 #include "tracy/Tracy.hpp"
@@ -14,11 +23,52 @@
 
 #include "stb_image.h"
 
+#include "../half_float.hpp"
 #include "../util.hpp"
+#include "frame_graph.hpp"
+#include "meshlet.hpp"
+#include "vertex_format.hpp"
 
 namespace Arctic::Renderer
 {
 
+static_assert(
+    static_cast<uint32_t>(ResourceState::RenderTarget) == D3D12_RESOURCE_STATE_RENDER_TARGET &&
+        static_cast<uint32_t>(ResourceState::UnorderedAccess) ==
+            D3D12_RESOURCE_STATE_UNORDERED_ACCESS &&
+        static_cast<uint32_t>(ResourceState::DepthWrite) == D3D12_RESOURCE_STATE_DEPTH_WRITE &&
+        static_cast<uint32_t>(ResourceState::PixelShaderResource) ==
+            D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE &&
+        static_cast<uint32_t>(ResourceState::CopyDest) == D3D12_RESOURCE_STATE_COPY_DEST &&
+        static_cast<uint32_t>(ResourceState::CopySource) == D3D12_RESOURCE_STATE_COPY_SOURCE,
+    "ResourceState values must match D3D12_RESOURCE_STATES"
+);
+
+// Faces with all their levels one after another, like the subresources of a cube texture.
+static std::vector<D3D12_SUBRESOURCE_DATA> cube_subresources(
+    const uint16_t *texels, uint32_t size, uint32_t level_count, uint32_t channels
+)
+{
+    std::vector<D3D12_SUBRESOURCE_DATA> subresources;
+    subresources.reserve(size_t{CUBE_FACE_COUNT} * level_count);
+    size_t offset = 0;
+    for (uint32_t face = 0; face < CUBE_FACE_COUNT; ++face)
+    {
+        for (uint32_t level = 0; level < level_count; ++level)
+        {
+            size_t level_size = std::max(size >> level, 1u);
+            subresources.emplace_back(D3D12_SUBRESOURCE_DATA{
+                .pData = texels + offset,
+                .RowPitch = static_cast<LONG_PTR>(level_size * channels * sizeof(uint16_t)),
+                .SlicePitch =
+                    static_cast<LONG_PTR>(level_size * level_size * channels * sizeof(uint16_t)),
+            });
+            offset += level_size * level_size * channels;
+        }
+    }
+    return subresources;
+}
+
 bool Renderer::init()
 {
     if (!m_rhi.init(m_window, m_window_size.width, m_window_size.height))
@@ -27,6 +77,45 @@ bool Renderer::init()
         return false;
     }
 
+    // Heaps holding render targets and depth buffers next to other resources need resource heap
+    // tier 2. On tier 1 the transient heap is limited to render and depth targets, which is all
+    // the frame graph places in it.
+    D3D12_FEATURE_DATA_D3D12_OPTIONS options{};
+    if (FAILED(m_rhi.device()->CheckFeatureSupport(
+            D3D12_FEATURE_D3D12_OPTIONS,
+            &options,
+            sizeof(options)
+        )))
+    {
+        spdlog::error("Renderer::init: failed to query d3d12 options");
+        return false;
+    }
+    m_transient_heap_flags = options.ResourceHeapTier >= D3D12_RESOURCE_HEAP_TIER_2
+                                 ? D3D12_HEAP_FLAG_ALLOW_ALL_BUFFERS_AND_TEXTURES
+                                 : D3D12_HEAP_FLAG_ALLOW_ONLY_RT_DS_TEXTURES;
+    spdlog::debug(
+        "Renderer::init: resource heap tier {}",
+        static_cast<int>(options.ResourceHeapTier)
+    );
+
+    // Without mesh shaders the meshlet pipelines are not created and every draw goes through the
+    // input assembler.
+    D3D12_FEATURE_DATA_D3D12_OPTIONS7 options7{};
+    if (FAILED(m_rhi.device()->CheckFeatureSupport(
+            D3D12_FEATURE_D3D12_OPTIONS7,
+            &options7,
+            sizeof(options7)
+        )))
+    {
+        spdlog::error("Renderer::init: failed to query d3d12 options 7");
+        return false;
+    }
+    m_mesh_shaders_supported = options7.MeshShaderTier != D3D12_MESH_SHADER_TIER_NOT_SUPPORTED;
+    if (!m_mesh_shaders_supported)
+    {
+        spdlog::warn("Renderer::init: mesh shaders are not supported");
+    }
+
     if (!m_rhi.create_descriptor_heap(
             D3D12_DESCRIPTOR_HEAP_TYPE_RTV,
             256,
@@ -53,9 +142,12 @@ bool Renderer::init()
     m_dsv_descriptor_size =
         m_rhi.device()->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_DSV);
 
+    // Streamed textures get new views whenever their residency changes, the old ones are reused
+    // once no frame in flight uses them anymore. Every mesh takes three views for the mesh
+    // shaders.
     if (!m_rhi.create_descriptor_heap(
             D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV,
-            256,
+            4096,
             D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE,
             m_cbv_srv_uav_heap
         ))
@@ -71,8 +163,9 @@ bool Renderer::init()
                 sizeof(LightsBuffer),
                 D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT
             ),
-            D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE,
+            D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER,
             D3D12_HEAP_TYPE_DEFAULT,
+            MemoryCategory::Constants,
             m_lights_buffer
         ))
     {
@@ -82,7 +175,7 @@ bool Renderer::init()
     m_lights_buffer->SetName(L"lights buffer");
     if (!m_rhi.upload_to_buffer(
             m_lights_buffer.Get(),
-            D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE,
+            D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER,
             &m_lights_buffer_data,
             sizeof(LightsBuffer)
         ))
@@ -90,13 +183,14 @@ bool Renderer::init()
         spdlog::error("Renderer::init: failed to initialize point lights buffer");
         return false;
     }
-    m_lights_buffer_cbv_idx = create_cbv(m_lights_buffer.Get());
+    m_lights_buffer_cbv_idx = create_cbv(m_lights_buffer.Get(), sizeof(LightsBuffer));
 
     if (!m_rhi.create_texture(
             ShadowMapPass::SIZE,
             ShadowMapPass::SIZE,
             DXGI_FORMAT_R32_TYPELESS,
             D3D12_RESOURCE_STATE_DEPTH_WRITE,
+            MemoryCategory::RenderTarget,
             m_sun_shadow_map,
             D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL
         ))
@@ -108,73 +202,168 @@ bool Renderer::init()
     m_sun_shadow_map_dsv = create_dsv(m_sun_shadow_map.Get());
     m_sun_shadow_map_srv_idx = create_srv(m_sun_shadow_map.Get(), DXGI_FORMAT_R32_FLOAT);
 
+    const char *hdri_path = "./assets/dreifaltigkeitsberg_2k.hdr";
     int hdri_width, hdri_height;
-    float *hdri_data =
-        stbi_loadf("./assets/dreifaltigkeitsberg_2k.hdr", &hdri_width, &hdri_height, nullptr, 4);
+    float *hdri_data = stbi_loadf(hdri_path, &hdri_width, &hdri_height, nullptr, 4);
     if (!hdri_data)
     {
         spdlog::error("Renderer::init: failed to load hdri");
         return false;
     }
-    if (!create_hdri(hdri_data, hdri_width, hdri_height))
+    std::span<const float> hdri_pixels(hdri_data, 4ull * hdri_width * hdri_height);
+    uint64_t ibl_key = ibl_cache_key(hdri_pixels, hdri_width, hdri_height);
+
+    // The skybox and the image based lighting both sample the environment as a cubemap, so the
+    // float image, 512 MiB for an 8K environment, is only kept until it has been resampled.
+    using Clock = std::chrono::steady_clock;
+    Clock::time_point environment_begin = Clock::now();
+    CubeMap environment;
+    equirect_to_cube(
+        hdri_pixels,
+        hdri_width,
+        hdri_height,
+        environment_cube_size(hdri_width),
+        m_jobs,
+        environment
+    );
+    stbi_image_free(hdri_data);
+    spdlog::info(
+        "Renderer::init: converted environment to a {}x{} cubemap in {:.1f} ms",
+        environment.size,
+        environment.size,
+        std::chrono::duration<float, std::milli>(Clock::now() - environment_begin).count()
+    );
+    if (!create_environment(environment))
     {
         spdlog::error("Renderer::init: failed to create environment texture");
         return false;
     }
-    m_skybox_environment->SetName(L"environment hdri texture");
-    m_skybox_environment_srv_idx =
-        create_srv(m_skybox_environment.Get(), DXGI_FORMAT_R32G32B32A32_FLOAT);
 
-    if (!m_rhi.create_texture(
-            m_window_size.width,
-            m_window_size.height,
-            DXGI_FORMAT_R16G16B16A16_FLOAT,
-            D3D12_RESOURCE_STATE_RENDER_TARGET,
-            m_forward_color_target,
-            D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET | D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS
-        ))
+    // Image based lighting is precomputed once per environment and cached next to it.
+    std::filesystem::path ibl_cache_path =
+        std::filesystem::path(hdri_path).replace_extension(".ibl");
+    IblData ibl;
+    if (!load_ibl_cache(ibl_cache_path, ibl_key, ibl))
+    {
+        IblStats ibl_stats;
+        compute_ibl(environment, m_jobs, ibl, ibl_stats);
+        spdlog::info(
+            "Renderer::init: precomputed image based lighting in {:.1f} ms",
+            ibl_stats.irradiance_ms + ibl_stats.specular_ms + ibl_stats.brdf_lut_ms
+        );
+        if (!save_ibl_cache(ibl_cache_path, ibl_key, ibl))
+        {
+            spdlog::warn("Renderer::init: failed to cache image based lighting");
+        }
+    }
+    if (!create_ibl(ibl))
     {
-        spdlog::error("Renderer::init: failed to create forward pass color target texture");
+        spdlog::error("Renderer::init: failed to create image based lighting");
         return false;
     }
-    m_forward_color_target->SetName(L"forward color target texture");
-    m_forward_color_target_rtv =
-        create_rtv(m_forward_color_target.Get(), DXGI_FORMAT_R16G16B16A16_FLOAT);
-    m_forward_color_target_uav_idx =
-        create_uav(m_forward_color_target.Get(), DXGI_FORMAT_R16G16B16A16_FLOAT);
 
-    if (!m_rhi.create_texture(
+    // The full resolution render targets are transient resources of the render graph. They are
+    // placed into a shared heap on the first frame, so only their descriptors are reserved here.
+    m_forward_color_target = TransientTexture{
+        .name = "forward color target",
+        .desc = CD3DX12_RESOURCE_DESC::Tex2D(
+            DXGI_FORMAT_R16G16B16A16_FLOAT,
             m_window_size.width,
             m_window_size.height,
-            DXGI_FORMAT_D32_FLOAT,
-            D3D12_RESOURCE_STATE_DEPTH_WRITE,
-            m_forward_depth_target,
+            1,
+            1,
+            1,
+            0,
+            D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET | D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS
+        ),
+        .allocation_info = {},
+        .initial_state = ResourceState::RenderTarget,
+        .handle = {},
+        .resource = nullptr,
+    };
+    m_forward_color_target_rtv = create_rtv(nullptr, DXGI_FORMAT_R16G16B16A16_FLOAT);
+    m_forward_color_target_srv_idx = create_srv(nullptr, DXGI_FORMAT_R16G16B16A16_FLOAT);
+    m_forward_color_target_uav_idx = create_uav(nullptr, DXGI_FORMAT_R16G16B16A16_FLOAT);
+
+    m_forward_depth_target = TransientTexture{
+        .name = "forward depth target",
+        // Typeless, so the depth pyramid can read it through a shader resource view.
+        .desc = CD3DX12_RESOURCE_DESC::Tex2D(
+            DXGI_FORMAT_R32_TYPELESS,
+            m_window_size.width,
+            m_window_size.height,
+            1,
+            1,
+            1,
+            0,
             D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL
-        ))
+        ),
+        .allocation_info = {},
+        .initial_state = ResourceState::DepthWrite,
+        .handle = {},
+        .resource = nullptr,
+    };
+    m_forward_depth_target_dsv = create_dsv(nullptr);
+    m_forward_depth_target_srv_idx = create_srv(nullptr, DXGI_FORMAT_R32_FLOAT);
+
+    std::array<const char *, GBUFFER_FORMATS.size()> gbuffer_names{
+        "gbuffer base color",
+        "gbuffer normal",
+        "gbuffer metalness roughness",
+    };
+    for (size_t i = 0; i < GBUFFER_FORMATS.size(); ++i)
     {
-        spdlog::error("Renderer::init: failed to create forward pass depth target texture");
-        return false;
+        m_gbuffer_targets[i] = TransientTexture{
+            .name = gbuffer_names[i],
+            .desc = CD3DX12_RESOURCE_DESC::Tex2D(
+                GBUFFER_FORMATS[i],
+                m_window_size.width,
+                m_window_size.height,
+                1,
+                1,
+                1,
+                0,
+                D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET
+            ),
+            .allocation_info = {},
+            .initial_state = ResourceState::RenderTarget,
+            .handle = {},
+            .resource = nullptr,
+        };
+        m_gbuffer_rtvs[i] = create_rtv(nullptr, GBUFFER_FORMATS[i]);
+        m_gbuffer_srv_idxs[i] = create_srv(nullptr, GBUFFER_FORMATS[i]);
     }
-    m_forward_depth_target->SetName(L"forward depth target texture");
-    m_forward_depth_target_dsv = create_dsv(m_forward_depth_target.Get());
 
-    if (!m_rhi.create_texture(
-            m_window_size.width,
-            m_window_size.height,
-            DXGI_FORMAT_R8G8B8A8_UNORM,
-            D3D12_RESOURCE_STATE_UNORDERED_ACCESS,
-            m_post_process_output,
-            D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS
-        ))
+    // Also a render target, only so that resource heap tier 1 can place it in the transient heap
+    // next to the render targets whose memory it shares. Size and levels follow the window, see
+    // `update_transient_descs`.
+    m_hiz = TransientTexture{
+        .name = "hiz",
+        .desc = CD3DX12_RESOURCE_DESC::Tex2D(
+            DXGI_FORMAT_R32_FLOAT,
+            1,
+            1,
+            1,
+            1,
+            1,
+            0,
+            D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET | D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS
+        ),
+        .allocation_info = {},
+        .initial_state = ResourceState::UnorderedAccess,
+        .handle = {},
+        .resource = nullptr,
+    };
+    m_hiz_srv_idx = create_srv(nullptr, DXGI_FORMAT_R32_FLOAT);
+    m_hiz_first_uav_idx = create_uav(nullptr, DXGI_FORMAT_R32_FLOAT);
+    for (uint32_t mip = 1; mip < MAX_HIZ_MIPS; ++mip)
     {
-        spdlog::error("Renderer::init: failed to create post processing pass output texture");
-        return false;
+        static_cast<void>(create_uav(nullptr, DXGI_FORMAT_R32_FLOAT));
     }
-    m_post_process_output->SetName(L"post process output texture");
-    m_post_process_output_uav_idx =
-        create_uav(m_post_process_output.Get(), DXGI_FORMAT_R8G8B8A8_UNORM);
 
-    if (!m_shadow_map_pass.init())
+    update_transient_descs();
+
+    if (!m_shadow_map_pass.init(m_mesh_shaders_supported))
     {
         spdlog::error("Renderer::init: failed to initialize forward pass");
         return false;
@@ -186,12 +375,30 @@ bool Renderer::init()
         return false;
     }
 
-    if (!m_forward_pass.init())
+    if (!m_forward_pass.init(m_mesh_shaders_supported))
     {
         spdlog::error("Renderer::init: failed to initialize forward pass");
         return false;
     }
 
+    if (!m_deferred_lighting_pass.init())
+    {
+        spdlog::error("Renderer::init: failed to initialize deferred lighting pass");
+        return false;
+    }
+
+    if (!m_occlusion_cull_pass.init())
+    {
+        spdlog::error("Renderer::init: failed to initialize occlusion cull pass");
+        return false;
+    }
+
+    if (!m_auto_exposure_pass.init())
+    {
+        spdlog::error("Renderer::init: failed to initialize auto exposure pass");
+        return false;
+    }
+
     if (!m_post_process_pass.init())
     {
         spdlog::error("Renderer::init: failed to initialize post process pass");
@@ -265,6 +472,8 @@ bool Renderer::resize(uint32_t &out_width, uint32_t &out_height)
         return false;
     }
 
+    update_transient_descs();
+
     out_width = static_cast<uint32_t>(window_width);
     out_height = static_cast<uint32_t>(window_height);
 
@@ -282,157 +491,685 @@ bool Renderer::render_frame(
     ImGui::NewFrame();
     build_ui();
 
-    bool res = m_rhi.render_frame([&](ID3D12GraphicsCommandList *cmd_list,
-                                      ID3D12Resource *target,
-                                      D3D12_CPU_DESCRIPTOR_HANDLE rtv_handle) {
-        cmd_list->SetDescriptorHeaps(1, m_cbv_srv_uav_heap.GetAddressOf());
-
-        // m_shadow_map_pass.run(cmd_list, m_sun_shadow_map_dsv, scene);
-        m_shadow_map_pass.run(
-            cmd_list,
-            ShadowMapPass::RunData{
-                .shadow_map_dsv = m_sun_shadow_map_dsv,
-                .meshes = m_meshes,
-                .scene = scene,
-            }
+    retire_streamed_textures();
+    {
+        ZoneScopedN("Set Up Frame");
+        setup_frame(
+            scene,
+            settings,
+            m_window_size.height,
+            m_mesh_draw_infos,
+            m_materials.size(),
+            m_streamed_texture_descs,
+            m_software_occlusion,
+            m_texture_streaming,
+            m_frame
         );
+    }
+    if (!upload_streamed_textures())
+    {
+        spdlog::error("Renderer::render_frame: failed to upload streamed textures");
+        return false;
+    }
 
-        CD3DX12_RESOURCE_BARRIER barrier = CD3DX12_RESOURCE_BARRIER::Transition(
-            m_sun_shadow_map.Get(),
-            D3D12_RESOURCE_STATE_DEPTH_WRITE,
-            D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE
-        );
-        cmd_list->ResourceBarrier(1, &barrier);
+    if (!m_occlusion_cull_pass.reserve_predicates(scene.objects.size()))
+    {
+        spdlog::error("Renderer::render_frame: failed to reserve occlusion predicates");
+        return false;
+    }
+    ID3D12Resource *predicates =
+        settings.occlusion_culling ? m_occlusion_cull_pass.predicates() : nullptr;
+    glm::mat4 proj_view = scene.camera.proj_view_matrix();
+    bool use_mesh_shaders = settings.mesh_shaders && m_mesh_shaders_supported;
+    auto run_forward_pass = [&](ID3D12GraphicsCommandList *cmd_list,
+                                bool clear_targets,
+                                uint64_t predicates_offset) {
         m_forward_pass.run(
             cmd_list,
             ForwardPass::RunData{
                 .color_target_rtv = m_forward_color_target_rtv,
+                .gbuffer_rtvs = m_gbuffer_rtvs,
                 .depth_target_dsv = m_forward_depth_target_dsv,
                 .viewport_width = m_window_size.width,
                 .viewport_height = m_window_size.height,
                 .shadow_map_srv_idx = m_sun_shadow_map_srv_idx,
-                .environment_srv_idx = m_skybox_environment_srv_idx,
+                .ibl_cbv_idx = m_ibl_buffer_cbv_idx,
                 .lights_buffer_cbv_idx = m_lights_buffer_cbv_idx,
                 .meshes = m_meshes,
                 .materials = m_materials,
+                .draws = m_frame.draws,
                 .scene = scene,
+                .use_mesh_shaders = use_mesh_shaders,
+                .write_gbuffer = settings.deferred_shading,
+                .clear_targets = clear_targets,
+                .predicates = predicates,
+                .predicates_offset = predicates_offset,
             }
         );
-        m_skybox_pass.run(
-            cmd_list,
-            SkyboxPass::RunData{
-                .color_target_rtv = m_forward_color_target_rtv,
-                .depth_target_rtv = m_forward_depth_target_dsv,
-                .environment_srv_idx = m_skybox_environment_srv_idx,
-                .viewport_width = m_window_size.width,
-                .viewport_height = m_window_size.height,
-                .camera = scene.camera,
-            }
-        );
-        barrier = CD3DX12_RESOURCE_BARRIER::Transition(
-            m_sun_shadow_map.Get(),
-            D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE,
-            D3D12_RESOURCE_STATE_DEPTH_WRITE
-        );
-        cmd_list->ResourceBarrier(1, &barrier);
+    };
 
-        barrier = CD3DX12_RESOURCE_BARRIER::Transition(
-            m_forward_color_target.Get(),
-            D3D12_RESOURCE_STATE_RENDER_TARGET,
-            D3D12_RESOURCE_STATE_UNORDERED_ACCESS
-        );
-        cmd_list->ResourceBarrier(1, &barrier);
+    std::optional<GBufferDescs> gbuffer_descs;
+    if (settings.deferred_shading)
+    {
+        gbuffer_descs = GBufferDescs{
+            .base_color = transient_desc(m_gbuffer_targets[0]),
+            .normal = transient_desc(m_gbuffer_targets[1]),
+            .metalness_roughness = transient_desc(m_gbuffer_targets[2]),
+        };
+    }
 
-        m_post_process_pass.run(
-            cmd_list,
-            PostProcessPass::RunData{
-                .input_uav_idx = m_forward_color_target_uav_idx,
-                .output_uav_idx = m_post_process_output_uav_idx,
-                .viewport_width = m_window_size.width,
-                .viewport_height = m_window_size.height,
-                .tm_method = static_cast<uint32_t>(settings.tm_method),
-                .gamma = settings.gamma,
-                .exposure = settings.exposure,
+    bool transients_placed = true;
+    bool res = m_rhi.render_frame([&](ID3D12GraphicsCommandList *cmd_list,
+                                      ID3D12Resource *target,
+                                      D3D12_CPU_DESCRIPTOR_HANDLE rtv_handle) {
+        m_render_graph.reset();
+
+        FrameGraphHandles handles = declare_frame_graph(
+            m_render_graph,
+            FrameGraphResources{
+                .sun_shadow_map = m_sun_shadow_map.Get(),
+                .backbuffer = target,
+                .occlusion_predicates = m_occlusion_cull_pass.predicates(),
+                .exposure = m_auto_exposure_pass.exposure(),
+                .color_target = transient_desc(m_forward_color_target),
+                .depth_target = transient_desc(m_forward_depth_target),
+                .hiz = transient_desc(m_hiz),
+                .gbuffer = gbuffer_descs,
+            },
+            FrameGraphPasses{
+                .shadow_map =
+                    [&] {
+                        m_shadow_map_pass.run(
+                            cmd_list,
+                            ShadowMapPass::RunData{
+                                .shadow_map_dsv = m_sun_shadow_map_dsv,
+                                .meshes = m_meshes,
+                                .draws = m_frame.shadow_draws,
+                                .scene = scene,
+                                .use_mesh_shaders = use_mesh_shaders,
+                            }
+                        );
+                    },
+                .forward =
+                    [&] {
+                        run_forward_pass(
+                            cmd_list,
+                            true,
+                            m_occlusion_cull_pass.early_predicates_offset()
+                        );
+                    },
+                // Without occlusion culling the early phase draws everything.
+                .hiz =
+                    [&] {
+                        if (!settings.occlusion_culling)
+                        {
+                            return;
+                        }
+                        m_occlusion_cull_pass.run_hiz(
+                            cmd_list,
+                            OcclusionCullPass::HizRunData{
+                                .hiz = m_hiz.resource.Get(),
+                                .depth_srv_idx = m_forward_depth_target_srv_idx,
+                                .hiz_first_uav_idx = m_hiz_first_uav_idx,
+                                .viewport_width = m_window_size.width,
+                                .viewport_height = m_window_size.height,
+                            }
+                        );
+                    },
+                .occlusion_cull =
+                    [&] {
+                        if (!settings.occlusion_culling)
+                        {
+                            return;
+                        }
+                        m_occlusion_cull_pass.run_cull(
+                            cmd_list,
+                            OcclusionCullPass::CullRunData{
+                                .hiz_srv_idx = m_hiz_srv_idx,
+                                .viewport_width = m_window_size.width,
+                                .viewport_height = m_window_size.height,
+                                .draws = m_frame.draws,
+                                .proj_view = proj_view,
+                            }
+                        );
+                    },
+                .forward_late =
+                    [&] {
+                        if (!settings.occlusion_culling)
+                        {
+                            return;
+                        }
+                        run_forward_pass(
+                            cmd_list,
+                            false,
+                            m_occlusion_cull_pass.late_predicates_offset()
+                        );
+                    },
+                .deferred_lighting =
+                    [&] {
+                        m_deferred_lighting_pass.run(
+                            cmd_list,
+                            DeferredLightingPass::RunData{
+                                .depth_srv_idx = m_forward_depth_target_srv_idx,
+                                .gbuffer_srv_idxs = m_gbuffer_srv_idxs,
+                                .shadow_map_srv_idx = m_sun_shadow_map_srv_idx,
+                                .lights_buffer_cbv_idx = m_lights_buffer_cbv_idx,
+                                .ibl_cbv_idx = m_ibl_buffer_cbv_idx,
+                                .color_target_uav_idx = m_forward_color_target_uav_idx,
+                                .viewport_width = m_window_size.width,
+                                .viewport_height = m_window_size.height,
+                                .scene = scene,
+                            }
+                        );
+                    },
+                .skybox =
+                    [&] {
+                        m_skybox_pass.run(
+                            cmd_list,
+                            SkyboxPass::RunData{
+                                .color_target_rtv = m_forward_color_target_rtv,
+                                .depth_target_rtv = m_forward_depth_target_dsv,
+                                .environment_srv_idx = m_skybox_environment_srv_idx,
+                                .viewport_width = m_window_size.width,
+                                .viewport_height = m_window_size.height,
+                                .camera = scene.camera,
+                            }
+                        );
+                    },
+                // Adapts from scratch once it is turned back on.
+                .auto_exposure =
+                    [&] {
+                        if (!settings.auto_exposure)
+                        {
+                            m_auto_exposure_pass.reset();
+                            return;
+                        }
+                        m_auto_exposure_pass.run(
+                            cmd_list,
+                            AutoExposurePass::RunData{
+                                .color_target_srv_idx = m_forward_color_target_srv_idx,
+                                .viewport_width = m_window_size.width,
+                                .viewport_height = m_window_size.height,
+                                .compensation = settings.exposure_compensation,
+                            }
+                        );
+                    },
+                .post_process =
+                    [&] {
+                        m_post_process_pass.run(
+                            cmd_list,
+                            PostProcessPass::RunData{
+                                .input_srv_idx = m_forward_color_target_srv_idx,
+                                .output_rtv = rtv_handle,
+                                .viewport_width = m_window_size.width,
+                                .viewport_height = m_window_size.height,
+                                .tm_method = static_cast<uint32_t>(settings.tm_method),
+                                .gamma = settings.gamma,
+                                .exposure = settings.exposure,
+                                .auto_exposure = settings.auto_exposure,
+                                .auto_exposure_buffer = m_auto_exposure_pass.exposure(),
+                            }
+                        );
+                    },
+                .imgui =
+                    [&] {
+                        ImGui::Render();
+                        std::array descriptor_heaps{m_imgui_cbv_srv_heap.Get()};
+                        cmd_list->SetDescriptorHeaps(1, descriptor_heaps.data());
+                        cmd_list->OMSetRenderTargets(1, &rtv_handle, FALSE, nullptr);
+                        ImGui_ImplDX12_RenderDrawData(ImGui::GetDrawData(), cmd_list);
+                    },
             }
         );
+        m_forward_color_target.handle = handles.color_target;
+        m_forward_depth_target.handle = handles.depth_target;
+        m_hiz.handle = handles.hiz;
+        std::vector<TransientTexture *> transients{
+            &m_forward_color_target,
+            &m_forward_depth_target,
+            &m_hiz,
+        };
+        if (handles.gbuffer)
+        {
+            m_gbuffer_targets[0].handle = handles.gbuffer->base_color;
+            m_gbuffer_targets[1].handle = handles.gbuffer->normal;
+            m_gbuffer_targets[2].handle = handles.gbuffer->metalness_roughness;
+            for (TransientTexture &texture : m_gbuffer_targets)
+            {
+                transients.emplace_back(&texture);
+            }
+        }
 
-        barrier = CD3DX12_RESOURCE_BARRIER::Transition(
-            m_forward_color_target.Get(),
-            D3D12_RESOURCE_STATE_UNORDERED_ACCESS,
-            D3D12_RESOURCE_STATE_RENDER_TARGET
-        );
-        cmd_list->ResourceBarrier(1, &barrier);
+        CompiledGraph compiled = m_render_graph.compile();
+        if (!place_transients(cmd_list, compiled, transients))
+        {
+            transients_placed = false;
+            return;
+        }
 
-        barrier = CD3DX12_RESOURCE_BARRIER::Transition(
-            m_post_process_output.Get(),
-            D3D12_RESOURCE_STATE_UNORDERED_ACCESS,
-            D3D12_RESOURCE_STATE_COPY_SOURCE
-        );
-        cmd_list->ResourceBarrier(1, &barrier);
+        cmd_list->SetDescriptorHeaps(1, m_cbv_srv_uav_heap.GetAddressOf());
+        execute_render_graph(cmd_list, compiled);
+    });
+    if (!transients_placed)
+    {
+        spdlog::error("Renderer::render_frame: failed to place transient resources");
+        return false;
+    }
+    if (!res)
+    {
+        spdlog::error("App::render_frame: failed to render frame");
+        return false;
+    }
 
-        barrier = CD3DX12_RESOURCE_BARRIER::Transition(
-            target,
-            D3D12_RESOURCE_STATE_PRESENT,
-            D3D12_RESOURCE_STATE_COPY_DEST
-        );
-        cmd_list->ResourceBarrier(1, &barrier);
+    return true;
+}
+
+void Renderer::update_transient_descs()
+{
+    std::array textures{
+        &m_forward_color_target,
+        &m_forward_depth_target,
+        &m_gbuffer_targets[0],
+        &m_gbuffer_targets[1],
+        &m_gbuffer_targets[2],
+    };
+    for (TransientTexture *texture : textures)
+    {
+        texture->desc.Width = m_window_size.width;
+        texture->desc.Height = m_window_size.height;
+        texture->allocation_info = m_rhi.device()->GetResourceAllocationInfo(0, 1, &texture->desc);
+    }
+
+    m_hiz.desc.Width = OcclusionCullPass::hiz_extent(m_window_size.width);
+    m_hiz.desc.Height = OcclusionCullPass::hiz_extent(m_window_size.height);
+    m_hiz.desc.MipLevels = static_cast<uint16_t>(
+        OcclusionCullPass::hiz_mip_count(m_window_size.width, m_window_size.height)
+    );
+    m_hiz.allocation_info = m_rhi.device()->GetResourceAllocationInfo(0, 1, &m_hiz.desc);
+}
+
+TransientDesc Renderer::transient_desc(const TransientTexture &texture)
+{
+    return TransientDesc{
+        .size = texture.allocation_info.SizeInBytes,
+        .alignment = texture.allocation_info.Alignment,
+        .initial_state = texture.initial_state,
+    };
+}
+
+bool Renderer::place_transients(
+    ID3D12GraphicsCommandList *cmd_list, const CompiledGraph &compiled,
+    std::span<TransientTexture *const> transients
+)
+{
+    TransientLayout layout{.heap_size = compiled.transient_heap_size, .offsets = {}, .sizes = {}};
+    for (const TransientAllocation &allocation : compiled.transients)
+    {
+        layout.offsets.emplace_back(allocation.offset);
+        layout.sizes.emplace_back(allocation.size);
+    }
+
+    // The layout only changes on the first frame and after a resize, in all other frames the
+    // previously placed resources are reused.
+    if (layout != m_transient_layout)
+    {
+        if (!m_rhi.flush())
+        {
+            spdlog::error("Renderer::place_transients: failed to flush");
+            return false;
+        }
+
+        m_forward_color_target.resource.Reset();
+        m_forward_depth_target.resource.Reset();
+        m_hiz.resource.Reset();
+        for (TransientTexture &texture : m_gbuffer_targets)
+        {
+            texture.resource.Reset();
+        }
+        m_transient_heap.Reset();
+
+        if (m_transient_heap_flags == D3D12_HEAP_FLAG_ALLOW_ONLY_RT_DS_TEXTURES)
+        {
+            for (const TransientTexture *texture : transients)
+            {
+                if (!(texture->desc.Flags & (D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET |
+                                             D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL)))
+                {
+                    spdlog::error(
+                        "Renderer::place_transients: `{}` is neither a render nor a depth "
+                        "target, which resource heap tier 1 can not place in the transient heap",
+                        texture->name
+                    );
+                    return false;
+                }
+            }
+        }
+
+        if (!m_rhi.create_heap(
+                layout.heap_size,
+                D3D12_HEAP_TYPE_DEFAULT,
+                m_transient_heap_flags,
+                MemoryCategory::RenderTarget,
+                m_transient_heap
+            ))
+        {
+            spdlog::error("Renderer::place_transients: failed to create transient heap");
+            return false;
+        }
+        m_transient_heap->SetName(L"transient heap");
+
+        // New resources are created in the state the graph expects them in at the beginning of
+        // the frame, which after the first frame is the state they were left in at its end.
+        std::vector<CD3DX12_RESOURCE_BARRIER> to_initial_states;
+        std::vector<CD3DX12_RESOURCE_BARRIER> from_initial_states;
+        std::vector<ID3D12Resource *> to_discard;
+        for (const TransientAllocation &allocation : compiled.transients)
+        {
+            for (TransientTexture *texture : transients)
+            {
+                if (texture->handle.idx != allocation.resource.idx)
+                {
+                    continue;
+                }
+
+                if (!m_rhi.create_placed_texture(
+                        m_transient_heap.Get(),
+                        allocation.offset,
+                        texture->desc,
+                        static_cast<D3D12_RESOURCE_STATES>(allocation.initial_state),
+                        texture->resource
+                    ))
+                {
+                    spdlog::error(
+                        "Renderer::place_transients: failed to place `{}`",
+                        texture->name
+                    );
+                    return false;
+                }
+
+                // Placed render and depth targets have to be initialized before their first use.
+                // Aliased ones are discarded after their aliasing barrier in every frame, all
+                // others are discarded here, which is only valid in the render target or depth
+                // write state.
+                D3D12_RESOURCE_STATES discard_state;
+                if (texture->desc.Flags & D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL)
+                {
+                    discard_state = D3D12_RESOURCE_STATE_DEPTH_WRITE;
+                }
+                else if (texture->desc.Flags & D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET)
+                {
+                    discard_state = D3D12_RESOURCE_STATE_RENDER_TARGET;
+                }
+                else
+                {
+                    continue;
+                }
+                if (allocation.aliased)
+                {
+                    continue;
+                }
+
+                auto initial_state = static_cast<D3D12_RESOURCE_STATES>(allocation.initial_state);
+                if (initial_state != discard_state)
+                {
+                    to_initial_states.emplace_back(CD3DX12_RESOURCE_BARRIER::Transition(
+                        texture->resource.Get(),
+                        initial_state,
+                        discard_state
+                    ));
+                    from_initial_states.emplace_back(CD3DX12_RESOURCE_BARRIER::Transition(
+                        texture->resource.Get(),
+                        discard_state,
+                        initial_state
+                    ));
+                }
+                to_discard.emplace_back(texture->resource.Get());
+            }
+        }
 
-        cmd_list->CopyResource(target, m_post_process_output.Get());
+        if (!to_initial_states.empty())
+        {
+            cmd_list->ResourceBarrier(
+                static_cast<UINT>(to_initial_states.size()),
+                to_initial_states.data()
+            );
+        }
+        for (ID3D12Resource *resource : to_discard)
+        {
+            cmd_list->DiscardResource(resource, nullptr);
+        }
+        if (!from_initial_states.empty())
+        {
+            cmd_list->ResourceBarrier(
+                static_cast<UINT>(from_initial_states.size()),
+                from_initial_states.data()
+            );
+        }
 
-        barrier = CD3DX12_RESOURCE_BARRIER::Transition(
-            target,
-            D3D12_RESOURCE_STATE_COPY_DEST,
-            D3D12_RESOURCE_STATE_RENDER_TARGET
+        write_rtv(
+            m_forward_color_target_rtv,
+            m_forward_color_target.resource.Get(),
+            DXGI_FORMAT_R16G16B16A16_FLOAT
         );
-        cmd_list->ResourceBarrier(1, &barrier);
-        barrier = CD3DX12_RESOURCE_BARRIER::Transition(
-            m_post_process_output.Get(),
-            D3D12_RESOURCE_STATE_COPY_SOURCE,
-            D3D12_RESOURCE_STATE_UNORDERED_ACCESS
+        write_srv(
+            m_forward_color_target_srv_idx,
+            m_forward_color_target.resource.Get(),
+            DXGI_FORMAT_R16G16B16A16_FLOAT
         );
-        cmd_list->ResourceBarrier(1, &barrier);
-
-        ImGui::Render();
-        std::array descriptor_heaps{m_imgui_cbv_srv_heap.Get()};
-        cmd_list->SetDescriptorHeaps(1, descriptor_heaps.data());
-        cmd_list->OMSetRenderTargets(1, &rtv_handle, FALSE, nullptr);
-        ImGui_ImplDX12_RenderDrawData(ImGui::GetDrawData(), cmd_list);
-
-        barrier = CD3DX12_RESOURCE_BARRIER::Transition(
-            target,
-            D3D12_RESOURCE_STATE_RENDER_TARGET,
-            D3D12_RESOURCE_STATE_PRESENT
+        write_uav(
+            m_forward_color_target_uav_idx,
+            m_forward_color_target.resource.Get(),
+            DXGI_FORMAT_R16G16B16A16_FLOAT
         );
-        cmd_list->ResourceBarrier(1, &barrier);
-    });
-    if (!res)
+        write_dsv(m_forward_depth_target_dsv, m_forward_depth_target.resource.Get());
+        write_srv(
+            m_forward_depth_target_srv_idx,
+            m_forward_depth_target.resource.Get(),
+            DXGI_FORMAT_R32_FLOAT
+        );
+        write_srv(m_hiz_srv_idx, m_hiz.resource.Get(), DXGI_FORMAT_R32_FLOAT);
+        for (uint32_t mip = 0; mip < m_hiz.desc.MipLevels; ++mip)
+        {
+            write_uav(
+                m_hiz_first_uav_idx + mip,
+                m_hiz.resource.Get(),
+                DXGI_FORMAT_R32_FLOAT,
+                mip
+            );
+        }
+        // Views of G-buffer targets that were not placed in this layout point at nothing.
+        for (size_t i = 0; i < m_gbuffer_targets.size(); ++i)
+        {
+            write_rtv(m_gbuffer_rtvs[i], m_gbuffer_targets[i].resource.Get(), GBUFFER_FORMATS[i]);
+            write_srv(
+                m_gbuffer_srv_idxs[i],
+                m_gbuffer_targets[i].resource.Get(),
+                GBUFFER_FORMATS[i]
+            );
+        }
+
+        m_transient_layout = std::move(layout);
+        m_transient_memory_stats = TransientMemoryStats{
+            .heap_size = compiled.transient_heap_size,
+            .unaliased_size = compiled.transient_unaliased_size,
+        };
+        spdlog::info(
+            "Renderer::place_transients: {:.2f} MiB transient heap, {:.2f} MiB without aliasing",
+            static_cast<double>(compiled.transient_heap_size) / (1024.0 * 1024.0),
+            static_cast<double>(compiled.transient_unaliased_size) / (1024.0 * 1024.0)
+        );
+    }
+
+    for (TransientTexture *texture : transients)
     {
-        spdlog::error("App::render_frame: failed to render frame");
-        return false;
+        m_render_graph.set_native_resource(texture->handle, texture->resource.Get());
     }
 
     return true;
 }
 
+// Translates render graph commands into D3D12 commands and measures every pass on the CPU and GPU.
+class NativeCommandRecorder final : public CommandRecorder
+{
+    using Clock = std::chrono::high_resolution_clock;
+
+    ID3D12GraphicsCommandList *m_cmd_list;
+    const RenderGraph &m_graph;
+    GpuTimer &m_gpu_timer;
+    std::vector<PassTiming> &m_pass_timings;
+
+    std::vector<CD3DX12_RESOURCE_BARRIER> m_native_barriers;
+    std::vector<ID3D12Resource *> m_to_discard;
+    Clock::time_point m_pass_begin;
+    uint32_t m_gpu_scope{0};
+
+  public:
+    NativeCommandRecorder(
+        ID3D12GraphicsCommandList *cmd_list, const RenderGraph &graph, GpuTimer &gpu_timer,
+        std::vector<PassTiming> &pass_timings
+    )
+        : m_cmd_list(cmd_list), m_graph(graph), m_gpu_timer(gpu_timer),
+          m_pass_timings(pass_timings)
+    {
+    }
+
+    void begin_pass(uint32_t pass_idx) override
+    {
+        m_pass_begin = Clock::now();
+        m_gpu_scope = m_gpu_timer.begin_scope(m_cmd_list, m_graph.pass_name(pass_idx));
+    }
+
+    void barriers(const std::vector<Barrier> &barriers) override
+    {
+        m_native_barriers.clear();
+        m_to_discard.clear();
+        for (const Barrier &barrier : barriers)
+        {
+            auto resource =
+                static_cast<ID3D12Resource *>(m_graph.native_resource(barrier.resource));
+            if (barrier.type == Barrier::Type::Uav)
+            {
+                m_native_barriers.emplace_back(CD3DX12_RESOURCE_BARRIER::UAV(resource));
+            }
+            else if (barrier.type == Barrier::Type::Aliasing)
+            {
+                m_native_barriers.emplace_back(
+                    CD3DX12_RESOURCE_BARRIER::Aliasing(nullptr, resource)
+                );
+
+                // Aliased render targets and depth buffers must be initialized before use, which
+                // includes render targets the deferred path first writes as unordered access.
+                if (barrier.after == ResourceState::RenderTarget ||
+                    barrier.after == ResourceState::DepthWrite ||
+                    barrier.after == ResourceState::UnorderedAccess)
+                {
+                    m_to_discard.emplace_back(resource);
+                }
+            }
+            else
+            {
+                m_native_barriers.emplace_back(CD3DX12_RESOURCE_BARRIER::Transition(
+                    resource,
+                    static_cast<D3D12_RESOURCE_STATES>(barrier.before),
+                    static_cast<D3D12_RESOURCE_STATES>(barrier.after)
+                ));
+            }
+        }
+        m_cmd_list->ResourceBarrier(
+            static_cast<UINT>(m_native_barriers.size()),
+            m_native_barriers.data()
+        );
+
+        for (ID3D12Resource *resource : m_to_discard)
+        {
+            m_cmd_list->DiscardResource(resource, nullptr);
+        }
+    }
+
+    void end_pass(uint32_t pass_idx) override
+    {
+        m_gpu_timer.end_scope(m_cmd_list, m_gpu_scope);
+        m_pass_timings.emplace_back(PassTiming{
+            .name = m_graph.pass_name(pass_idx),
+            .cpu_ms =
+                std::chrono::duration<float, std::milli>(Clock::now() - m_pass_begin).count(),
+            .gpu_ms = std::nullopt,
+        });
+    }
+};
+
+void Renderer::execute_render_graph(
+    ID3D12GraphicsCommandList *cmd_list, const CompiledGraph &compiled
+)
+{
+    m_pass_timings.clear();
+    NativeCommandRecorder recorder(cmd_list, m_render_graph, m_rhi.gpu_timer(), m_pass_timings);
+    m_render_graph.execute(compiled, recorder);
+
+    // GPU timings lag behind, so they are matched to the passes of this frame by name.
+    for (const GpuTiming &gpu_timing : m_rhi.gpu_timer().results())
+    {
+        for (PassTiming &timing : m_pass_timings)
+        {
+            if (timing.name == gpu_timing.name)
+            {
+                timing.gpu_ms = gpu_timing.ms;
+                break;
+            }
+        }
+    }
+}
+
 bool Renderer::create_mesh(
-    std::span<Vertex> vertices, std::span<uint32_t> indices, MaterialIdx material_idx
+    std::span<Vertex> vertices, std::span<uint32_t> indices, std::span<const MeshLod> lods,
+    MaterialIdx material_idx
 )
 {
+    // The vertex streams are read by the input assembler and by the mesh shaders.
+    const D3D12_RESOURCE_STATES vertex_stream_state =
+        D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER |
+        D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE;
+
     Mesh mesh;
 
-    uint64_t vertex_buffer_size = vertices.size() * sizeof(Vertex);
+    CompressedVertices compressed;
+    compress_vertices(
+        vertices,
+        choose_vertex_position_format(vertices, VERTEX_POSITION_TOLERANCE),
+        compressed
+    );
+
+    uint64_t position_buffer_size = compressed.positions.size();
     bool res = m_rhi.create_buffer(
-        vertex_buffer_size,
-        D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER,
+        position_buffer_size,
+        vertex_stream_state,
+        D3D12_HEAP_TYPE_DEFAULT,
+        MemoryCategory::Mesh,
+        mesh.position_buffer
+    );
+
+    res &= m_rhi.upload_to_buffer(
+        mesh.position_buffer.Get(),
+        vertex_stream_state,
+        compressed.positions.data(),
+        position_buffer_size
+    );
+
+    uint64_t attribute_buffer_size =
+        compressed.attributes.size() * sizeof(PackedVertexAttributes);
+    res &= m_rhi.create_buffer(
+        attribute_buffer_size,
+        vertex_stream_state,
         D3D12_HEAP_TYPE_DEFAULT,
-        mesh.vertex_buffer
+        MemoryCategory::Mesh,
+        mesh.attribute_buffer
     );
 
     res &= m_rhi.upload_to_buffer(
-        mesh.vertex_buffer.Get(),
-        D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER,
-        vertices.data(),
-        vertex_buffer_size
+        mesh.attribute_buffer.Get(),
+        vertex_stream_state,
+        compressed.attributes.data(),
+        attribute_buffer_size
     );
 
     uint64_t index_buffer_size = indices.size() * sizeof(uint32_t);
@@ -440,6 +1177,7 @@ bool Renderer::create_mesh(
         index_buffer_size,
         D3D12_RESOURCE_STATE_INDEX_BUFFER,
         D3D12_HEAP_TYPE_DEFAULT,
+        MemoryCategory::Mesh,
         mesh.index_buffer
     );
 
@@ -450,14 +1188,64 @@ bool Renderer::create_mesh(
         index_buffer_size
     );
 
+    // Every level of detail is split into its own meshlets.
+    std::vector<MeshLod> mesh_lods(lods.begin(), lods.end());
+    MeshletData meshlets;
+    for (MeshLod &lod : mesh_lods)
+    {
+        lod.first_meshlet = build_meshlets(
+            vertices, indices.subspan(lod.first_index, lod.index_count), meshlets
+        );
+        lod.meshlet_count = static_cast<uint32_t>(meshlets.meshlets.size()) - lod.first_meshlet;
+    }
+    std::vector<uint8_t> meshlet_buffer_data;
+    pack_meshlets(meshlets, meshlet_buffer_data);
+
+    uint64_t meshlet_buffer_size = meshlet_buffer_data.size();
+    res &= m_rhi.create_buffer(
+        meshlet_buffer_size,
+        D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE,
+        D3D12_HEAP_TYPE_DEFAULT,
+        MemoryCategory::Mesh,
+        mesh.meshlet_buffer
+    );
+
+    res &= m_rhi.upload_to_buffer(
+        mesh.meshlet_buffer.Get(),
+        D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE,
+        meshlet_buffer_data.data(),
+        meshlet_buffer_size
+    );
+
     if (!res)
     {
         spdlog::error("Renderer::create_mesh: failed to create vertex and/or index buffers");
     }
 
-    mesh.vertex_buffer_view.BufferLocation = mesh.vertex_buffer->GetGPUVirtualAddress();
-    mesh.vertex_buffer_view.StrideInBytes = sizeof(Vertex);
-    mesh.vertex_buffer_view.SizeInBytes = static_cast<UINT>(vertex_buffer_size);
+    mesh.meshlet_buffer_srv_idx =
+        create_raw_buffer_srv(mesh.meshlet_buffer.Get(), meshlet_buffer_size);
+    mesh.position_buffer_srv_idx =
+        create_raw_buffer_srv(mesh.position_buffer.Get(), position_buffer_size);
+    mesh.attribute_buffer_srv_idx =
+        create_raw_buffer_srv(mesh.attribute_buffer.Get(), attribute_buffer_size);
+
+    mesh.position_buffer_view.BufferLocation = mesh.position_buffer->GetGPUVirtualAddress();
+    mesh.position_buffer_view.StrideInBytes = vertex_position_size(compressed.position_format);
+    mesh.position_buffer_view.SizeInBytes = static_cast<UINT>(position_buffer_size);
+    mesh.position_format = compressed.position_format;
+    mesh.position_transform = compressed.position_transform;
+
+    mesh.attribute_buffer_view.BufferLocation = mesh.attribute_buffer->GetGPUVirtualAddress();
+    mesh.attribute_buffer_view.StrideInBytes = sizeof(PackedVertexAttributes);
+    mesh.attribute_buffer_view.SizeInBytes = static_cast<UINT>(attribute_buffer_size);
+
+    m_vertex_memory_stats.compressed_size += position_buffer_size + attribute_buffer_size;
+    m_vertex_memory_stats.uncompressed_size += vertices.size() * sizeof(Vertex);
+    m_vertex_memory_stats.mesh_count += 1;
+    if (compressed.position_format == VertexPositionFormat::Unorm16)
+    {
+        m_vertex_memory_stats.quantized_mesh_count += 1;
+    }
 
     mesh.index_buffer_view.BufferLocation = mesh.index_buffer->GetGPUVirtualAddress();
     mesh.index_buffer_view.Format = DXGI_FORMAT_R32_UINT;
@@ -467,117 +1255,411 @@ bool Renderer::create_mesh(
 
     mesh.material_idx = material_idx;
 
+    glm::vec3 bounds_min(std::numeric_limits<float>::max());
+    glm::vec3 bounds_max(std::numeric_limits<float>::lowest());
+    for (const Vertex &vertex : vertices)
+    {
+        bounds_min = glm::min(bounds_min, vertex.position);
+        bounds_max = glm::max(bounds_max, vertex.position);
+    }
+    glm::vec3 bounds_center = (bounds_min + bounds_max) * 0.5f;
+    float bounds_radius = 0.0f;
+    for (const Vertex &vertex : vertices)
+    {
+        bounds_radius = std::max(bounds_radius, glm::distance(bounds_center, vertex.position));
+    }
+
+    m_mesh_draw_infos.emplace_back(MeshDrawInfo{
+        .lods = std::move(mesh_lods),
+        .material_idx = mesh.material_idx,
+        .bounds_min = bounds_min,
+        .bounds_max = bounds_max,
+        .bounds_center = bounds_center,
+        .bounds_radius = bounds_radius,
+    });
     m_meshes.emplace_back(mesh);
+    m_software_occlusion.add_mesh(vertices, indices);
 
     return true;
 }
 
 bool Renderer::create_material(
-    void *diffuse_data, uint32_t diffuse_width, uint32_t diffuse_height, void *normal_data,
-    uint32_t normal_width, uint32_t normal_height, void *metalness_roughness_data,
-    uint32_t metalness_roughness_width, uint32_t metalness_roughness_height
+    TextureImage &&diffuse, TextureImage &&normal, TextureImage &&metalness_roughness
 )
 {
+    ZoneScoped;
+
     Material material;
+    std::array<StreamedTexture, Material::NUM_TEXTURES> streamed{
+        StreamedTexture{.image = std::move(diffuse)},
+        StreamedTexture{.image = std::move(normal)},
+        StreamedTexture{.image = std::move(metalness_roughness)},
+    };
+    static constexpr std::array<const char *, 3> NAMES{"diffuse", "normal", "metalness/roughness"};
+
+    std::array<std::vector<D3D12_SUBRESOURCE_DATA>, Material::NUM_TEXTURES> subresources;
+    std::array<TextureUpload, Material::NUM_TEXTURES> uploads;
+    for (size_t i = 0; i < streamed.size(); ++i)
+    {
+        const TextureImage &image = streamed[i].image;
+        std::vector<uint64_t> level_sizes;
+        for (const TextureLevel &level : image.levels)
+        {
+            level_sizes.emplace_back(level.size);
+        }
+        // The most detailed level of a block compressed texture has to be a multiple of the
+        // block size, which limits the levels a copy can start at.
+        streamed[i].streaming_idx = m_texture_streaming.add_texture(
+            image.width,
+            image.height,
+            level_sizes,
+            is_block_compressed(image.format) ? 4 : 1
+        );
 
-    bool res = m_rhi.create_texture(
-        diffuse_width,
-        diffuse_height,
-        DXGI_FORMAT_R8G8B8A8_UNORM_SRGB,
-        D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE,
-        material.diffuse
-    );
-    res &= m_rhi.upload_to_texture(
-        material.diffuse.Get(),
-        D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE,
-        diffuse_data,
-        diffuse_width,
-        diffuse_height,
-        4
-    );
-    if (!res)
+        if (!create_streamed_texture(
+                image,
+                m_texture_streaming.tail_mip(streamed[i].streaming_idx),
+                material.textures[i],
+                subresources[i]
+            ))
+        {
+            spdlog::error("Renderer::create_material: failed to create {} texture", NAMES[i]);
+            return false;
+        }
+        uploads[i] = TextureUpload{
+            .texture = material.textures[i].Get(),
+            .subresources = subresources[i],
+        };
+    }
+
+    if (!m_rhi.upload_to_textures(uploads, D3D12_RESOURCE_STATE_COMMON))
     {
-        spdlog::error("Renderer::create_material: failed to create diffuse texture");
+        spdlog::error("Renderer::create_material: failed to upload textures");
         return false;
     }
 
-    res = m_rhi.create_texture(
-        normal_width,
-        normal_height,
-        DXGI_FORMAT_R8G8B8A8_UNORM,
-        D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE,
-        material.normal
-    );
-    res &= m_rhi.upload_to_texture(
-        material.normal.Get(),
-        D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE,
-        normal_data,
-        normal_width,
-        normal_height,
-        4
-    );
-    if (!res)
+    for (const StreamedTexture &texture : streamed)
+    {
+        m_streamed_texture_descs.emplace_back(StreamedTextureDesc{
+            .material_idx = m_materials.size(),
+            .streaming_idx = texture.streaming_idx,
+            .size = std::max(texture.image.width, texture.image.height),
+            .mip_count = static_cast<uint32_t>(texture.image.levels.size()),
+        });
+    }
+    m_materials.emplace_back(material);
+    m_streamed_textures.emplace_back(std::move(streamed));
+    m_materials.back().srv_offset = create_material_views(m_materials.size() - 1);
+
+    return true;
+}
+
+bool Renderer::create_streamed_texture(
+    const TextureImage &image, uint32_t first_mip, ComPtr<ID3D12Resource> &out_texture,
+    std::vector<D3D12_SUBRESOURCE_DATA> &out_subresources
+)
+{
+    // Streamed textures stay in the common state, so they can be written on the copy queue and
+    // read by shaders through implicit state promotion without any barriers.
+    if (!m_rhi.create_texture(
+            image.levels[first_mip].width,
+            image.levels[first_mip].height,
+            static_cast<DXGI_FORMAT>(image.format),
+            D3D12_RESOURCE_STATE_COMMON,
+            MemoryCategory::MaterialTexture,
+            out_texture,
+            D3D12_RESOURCE_FLAG_NONE,
+            static_cast<uint16_t>(image.levels.size() - first_mip)
+        ))
     {
-        spdlog::error("Renderer::create_material: failed to create normal texture");
+        spdlog::error("Renderer::create_streamed_texture: failed to create texture");
         return false;
     }
 
-    res = m_rhi.create_texture(
-        metalness_roughness_width,
-        metalness_roughness_height,
-        DXGI_FORMAT_R8G8B8A8_UNORM,
-        D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE,
-        material.metalness_roughness
-    );
-    res &= m_rhi.upload_to_texture(
-        material.metalness_roughness.Get(),
-        D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE,
-        metalness_roughness_data,
-        metalness_roughness_width,
-        metalness_roughness_height,
-        4
+    out_subresources.clear();
+    for (size_t level = first_mip; level < image.levels.size(); ++level)
+    {
+        out_subresources.emplace_back(D3D12_SUBRESOURCE_DATA{
+            .pData = image.level_data(level).data(),
+            .RowPitch = static_cast<LONG_PTR>(image.levels[level].row_pitch),
+            .SlicePitch = static_cast<LONG_PTR>(image.levels[level].size),
+        });
+    }
+
+    return true;
+}
+
+uint32_t Renderer::create_material_views(MaterialIdx material_idx)
+{
+    uint32_t srv_offset = m_cbv_srv_uav_count;
+    if (m_free_material_srv_offsets.empty())
+    {
+        m_cbv_srv_uav_count += Material::NUM_TEXTURES;
+    }
+    else
+    {
+        srv_offset = m_free_material_srv_offsets.back();
+        m_free_material_srv_offsets.pop_back();
+    }
+
+    const Material &material = m_materials[material_idx];
+    for (size_t i = 0; i < Material::NUM_TEXTURES; ++i)
+    {
+        write_srv(
+            srv_offset + static_cast<uint32_t>(i),
+            material.textures[i].Get(),
+            static_cast<DXGI_FORMAT>(m_streamed_textures[material_idx][i].image.format)
+        );
+    }
+
+    return srv_offset;
+}
+
+void Renderer::retire_streamed_textures()
+{
+    ZoneScoped;
+
+    uint64_t completed_frame = m_rhi.completed_frame_fence_value();
+    std::erase_if(m_retired_material_views, [&](const RetiredMaterialViews &retired) {
+        if (retired.frame_fence_value > completed_frame)
+        {
+            return false;
+        }
+        m_free_material_srv_offsets.emplace_back(retired.srv_offset);
+        for (uint32_t streaming_idx : retired.replaced_streaming_idxs)
+        {
+            m_texture_streaming.release(streaming_idx);
+        }
+        return true;
+    });
+
+    // Frames that are already submitted keep using the old views and textures, so they are
+    // replaced with new ones instead of being overwritten.
+    uint64_t completed_upload = m_rhi.completed_async_upload_value();
+    for (MaterialIdx material_idx = 0; material_idx < m_materials.size(); ++material_idx)
+    {
+        auto is_complete = [&](const StreamedTexture &streamed) {
+            return streamed.pending_texture && streamed.pending_fence_value <= completed_upload;
+        };
+        if (std::none_of(
+                m_streamed_textures[material_idx].begin(),
+                m_streamed_textures[material_idx].end(),
+                is_complete
+            ))
+        {
+            continue;
+        }
+
+        Material &material = m_materials[material_idx];
+        RetiredMaterialViews &retired = m_retired_material_views.emplace_back(RetiredMaterialViews{
+            .srv_offset = material.srv_offset,
+            .textures = material.textures,
+            .replaced_streaming_idxs = {},
+            .frame_fence_value = m_rhi.submitted_frame_fence_value(),
+        });
+        for (size_t i = 0; i < Material::NUM_TEXTURES; ++i)
+        {
+            StreamedTexture &streamed = m_streamed_textures[material_idx][i];
+            if (is_complete(streamed))
+            {
+                material.textures[i] = std::move(streamed.pending_texture);
+                m_texture_streaming.complete(streamed.streaming_idx);
+                retired.replaced_streaming_idxs.emplace_back(streamed.streaming_idx);
+            }
+        }
+        material.srv_offset = create_material_views(material_idx);
+    }
+}
+
+bool Renderer::upload_streamed_textures()
+{
+    ZoneScoped;
+
+    if (m_frame.streaming_requests.empty())
+    {
+        return true;
+    }
+
+    // Textures are registered with the policy in order, three per material.
+    std::vector<std::vector<D3D12_SUBRESOURCE_DATA>> subresources(
+        m_frame.streaming_requests.size()
     );
-    if (!res)
+    std::vector<TextureUpload> uploads;
+    std::vector<StreamedTexture *> targets;
+    for (size_t i = 0; i < m_frame.streaming_requests.size(); ++i)
+    {
+        const StreamingRequest &request = m_frame.streaming_requests[i];
+        StreamedTexture &streamed = m_streamed_textures[request.texture / Material::NUM_TEXTURES]
+                                                       [request.texture % Material::NUM_TEXTURES];
+        if (!create_streamed_texture(
+                streamed.image,
+                request.mip,
+                streamed.pending_texture,
+                subresources[i]
+            ))
+        {
+            spdlog::error("Renderer::upload_streamed_textures: failed to create texture");
+            return false;
+        }
+        uploads.emplace_back(TextureUpload{
+            .texture = streamed.pending_texture.Get(),
+            .subresources = subresources[i],
+        });
+        targets.emplace_back(&streamed);
+    }
+
+    uint64_t fence_value;
+    if (!m_rhi.async_upload_to_textures(uploads, fence_value))
     {
-        spdlog::error("Renderer::create_material: failed to create metalness/roughness texture");
+        spdlog::error("Renderer::upload_streamed_textures: failed to upload textures");
         return false;
     }
+    for (StreamedTexture *streamed : targets)
+    {
+        streamed->pending_fence_value = fence_value;
+    }
 
-    material.srv_offset = create_srv(material.diffuse.Get(), DXGI_FORMAT_R8G8B8A8_UNORM_SRGB);
-    create_srv(material.normal.Get(), DXGI_FORMAT_R8G8B8A8_UNORM);
-    create_srv(material.metalness_roughness.Get(), DXGI_FORMAT_R8G8B8A8_UNORM);
+    return true;
+}
 
-    m_materials.emplace_back(material);
+bool Renderer::create_environment(const CubeMap &environment)
+{
+    if (!m_rhi.create_texture(
+            environment.size,
+            environment.size,
+            DXGI_FORMAT_R16G16B16A16_FLOAT,
+            D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE,
+            MemoryCategory::Environment,
+            m_skybox_environment,
+            D3D12_RESOURCE_FLAG_NONE,
+            environment.level_count,
+            CUBE_FACE_COUNT
+        ))
+    {
+        spdlog::error("Renderer::create_environment: failed to create texture");
+        return false;
+    }
+    m_skybox_environment->SetName(L"environment texture");
+
+    // Converted in chunks across the job system, a 1024 texel cube has 34 million floats.
+    static constexpr size_t CONVERSION_CHUNK_SIZE = 1 << 20;
+    std::span<const float> texels = environment.texels;
+    std::vector<uint16_t> halves(texels.size());
+    m_jobs.parallel_for(
+        (texels.size() + CONVERSION_CHUNK_SIZE - 1) / CONVERSION_CHUNK_SIZE,
+        [&](size_t chunk) {
+            size_t begin = chunk * CONVERSION_CHUNK_SIZE;
+            size_t count = std::min(CONVERSION_CHUNK_SIZE, texels.size() - begin);
+            floats_to_halves(
+                texels.subspan(begin, count), std::span(halves).subspan(begin, count)
+            );
+        }
+    );
+    std::vector<D3D12_SUBRESOURCE_DATA> subresources =
+        cube_subresources(halves.data(), environment.size, environment.level_count, 4);
+    std::array uploads{
+        TextureUpload{.texture = m_skybox_environment.Get(), .subresources = subresources},
+    };
+    if (!m_rhi.upload_to_textures(uploads, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE))
+    {
+        spdlog::error("Renderer::create_environment: failed to upload data");
+        return false;
+    }
+    m_skybox_environment_srv_idx =
+        create_cube_srv(m_skybox_environment.Get(), DXGI_FORMAT_R16G16B16A16_FLOAT);
 
     return true;
 }
 
-bool Renderer::create_hdri(float *data, uint32_t width, uint32_t height)
+bool Renderer::create_ibl(const IblData &ibl)
 {
     if (!m_rhi.create_texture(
-            width,
-            height,
-            DXGI_FORMAT_R32G32B32A32_FLOAT,
+            IBL_SPECULAR_SIZE,
+            IBL_SPECULAR_SIZE,
+            DXGI_FORMAT_R16G16B16A16_FLOAT,
             D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE,
-            m_skybox_environment
+            MemoryCategory::Environment,
+            m_ibl_specular,
+            D3D12_RESOURCE_FLAG_NONE,
+            IBL_SPECULAR_LEVELS,
+            CUBE_FACE_COUNT
         ))
     {
-        spdlog::error("Renderer::create_hdri: failed to create texture");
+        spdlog::error("Renderer::create_ibl: failed to create specular texture");
         return false;
     }
+    m_ibl_specular->SetName(L"ibl specular texture");
 
-    if (!m_rhi.upload_to_texture(
-            m_skybox_environment.Get(),
+    if (!m_rhi.create_texture(
+            IBL_BRDF_LUT_SIZE,
+            IBL_BRDF_LUT_SIZE,
+            DXGI_FORMAT_R16G16_FLOAT,
             D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE,
-            data,
-            width,
-            height,
-            4 * sizeof(float)
+            MemoryCategory::Environment,
+            m_ibl_brdf_lut
+        ))
+    {
+        spdlog::error("Renderer::create_ibl: failed to create brdf lut texture");
+        return false;
+    }
+    m_ibl_brdf_lut->SetName(L"ibl brdf lut texture");
+
+    std::vector<D3D12_SUBRESOURCE_DATA> specular_subresources =
+        cube_subresources(ibl.specular.data(), IBL_SPECULAR_SIZE, IBL_SPECULAR_LEVELS, 4);
+    D3D12_SUBRESOURCE_DATA brdf_lut_subresource{
+        .pData = ibl.brdf_lut.data(),
+        .RowPitch = static_cast<LONG_PTR>(IBL_BRDF_LUT_SIZE * 2 * sizeof(uint16_t)),
+        .SlicePitch =
+            static_cast<LONG_PTR>(IBL_BRDF_LUT_SIZE * IBL_BRDF_LUT_SIZE * 2 * sizeof(uint16_t)),
+    };
+    std::array uploads{
+        TextureUpload{.texture = m_ibl_specular.Get(), .subresources = specular_subresources},
+        TextureUpload{
+            .texture = m_ibl_brdf_lut.Get(),
+            .subresources = std::span(&brdf_lut_subresource, 1),
+        },
+    };
+    if (!m_rhi.upload_to_textures(uploads, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE))
+    {
+        spdlog::error("Renderer::create_ibl: failed to upload textures");
+        return false;
+    }
+    m_ibl_specular_srv_idx = create_cube_srv(m_ibl_specular.Get(), DXGI_FORMAT_R16G16B16A16_FLOAT);
+    m_ibl_brdf_lut_srv_idx = create_srv(m_ibl_brdf_lut.Get(), DXGI_FORMAT_R16G16_FLOAT);
+
+    IblBuffer ibl_buffer_data{
+        .irradiance_sh = {},
+        .specular_srv_idx = m_ibl_specular_srv_idx,
+        .brdf_lut_srv_idx = m_ibl_brdf_lut_srv_idx,
+        .specular_max_level = static_cast<float>(IBL_SPECULAR_LEVELS - 1),
+    };
+    for (size_t i = 0; i < ibl.irradiance_sh.size(); ++i)
+    {
+        ibl_buffer_data.irradiance_sh[i] = glm::vec4(ibl.irradiance_sh[i], 0.0f);
+    }
+    if (!m_rhi.create_buffer(
+            next_multiple_of_k(sizeof(IblBuffer), D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT),
+            D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER,
+            D3D12_HEAP_TYPE_DEFAULT,
+            MemoryCategory::Constants,
+            m_ibl_buffer
         ))
     {
-        spdlog::error("Renderer::create_hdri: failed to upload data");
+        spdlog::error("Renderer::create_ibl: failed to create buffer");
         return false;
     }
+    m_ibl_buffer->SetName(L"ibl buffer");
+    if (!m_rhi.upload_to_buffer(
+            m_ibl_buffer.Get(),
+            D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER,
+            &ibl_buffer_data,
+            sizeof(IblBuffer)
+        ))
+    {
+        spdlog::error("Renderer::create_ibl: failed to upload buffer");
+        return false;
+    }
+    m_ibl_buffer_cbv_idx = create_cbv(m_ibl_buffer.Get(), sizeof(IblBuffer));
 
     return true;
 }
@@ -593,7 +1675,7 @@ void Renderer::update_lights(std::span<PointLight> point_lights)
 
     if (!m_rhi.upload_to_buffer(
             m_lights_buffer.Get(),
-            D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE,
+            D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER,
             &m_lights_buffer_data,
             sizeof(LightsBuffer)
         ))
@@ -610,16 +1692,23 @@ Renderer::create_rtv(ID3D12Resource *resource, DXGI_FORMAT format)
         m_rtv_count,
         m_rtv_descriptor_size
     );
+    write_rtv(handle, resource, format);
+
+    ++m_rtv_count;
+
+    return handle;
+}
+
+void Renderer::write_rtv(
+    D3D12_CPU_DESCRIPTOR_HANDLE handle, ID3D12Resource *resource, DXGI_FORMAT format
+)
+{
     D3D12_RENDER_TARGET_VIEW_DESC desc{};
     desc.Format = format;
     desc.ViewDimension = D3D12_RTV_DIMENSION_TEXTURE2D;
     desc.Texture2D.MipSlice = 0;
     desc.Texture2D.PlaneSlice = 0;
     m_rhi.device()->CreateRenderTargetView(resource, &desc, handle);
-
-    ++m_rtv_count;
-
-    return handle;
 }
 
 D3D12_CPU_DESCRIPTOR_HANDLE
@@ -630,55 +1719,112 @@ Renderer::create_dsv(ID3D12Resource *resource)
         m_dsv_count,
         m_dsv_descriptor_size
     );
+    write_dsv(handle, resource);
+
+    ++m_dsv_count;
+
+    return handle;
+}
+
+void Renderer::write_dsv(D3D12_CPU_DESCRIPTOR_HANDLE handle, ID3D12Resource *resource)
+{
     D3D12_DEPTH_STENCIL_VIEW_DESC desc{};
     desc.Format = DXGI_FORMAT_D32_FLOAT;
     desc.ViewDimension = D3D12_DSV_DIMENSION_TEXTURE2D;
     desc.Texture2D.MipSlice = 0;
     m_rhi.device()->CreateDepthStencilView(resource, &desc, handle);
+}
 
-    ++m_dsv_count;
+uint32_t Renderer::create_srv(ID3D12Resource *resource, DXGI_FORMAT format)
+{
+    write_srv(m_cbv_srv_uav_count, resource, format);
 
-    return handle;
+    return m_cbv_srv_uav_count++;
 }
 
-uint32_t Renderer::create_srv(ID3D12Resource *resource, DXGI_FORMAT format)
+void Renderer::write_srv(uint32_t idx, ID3D12Resource *resource, DXGI_FORMAT format)
 {
     CD3DX12_CPU_DESCRIPTOR_HANDLE handle(
         m_cbv_srv_uav_heap->GetCPUDescriptorHandleForHeapStart(),
-        m_cbv_srv_uav_count,
+        idx,
         m_cbv_srv_uav_descriptor_size
     );
     D3D12_SHADER_RESOURCE_VIEW_DESC desc{};
     desc.Format = format;
     desc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
     desc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
-    desc.Texture2D.MipLevels = 1;
+    // Views cover every mip level the resource has.
+    desc.Texture2D.MipLevels = UINT32_MAX;
     desc.Texture2D.MostDetailedMip = 0;
     desc.Texture2D.PlaneSlice = 0;
     desc.Texture2D.ResourceMinLODClamp = 0.0f;
     m_rhi.device()->CreateShaderResourceView(resource, &desc, handle);
+}
+
+uint32_t Renderer::create_cube_srv(ID3D12Resource *resource, DXGI_FORMAT format)
+{
+    CD3DX12_CPU_DESCRIPTOR_HANDLE handle(
+        m_cbv_srv_uav_heap->GetCPUDescriptorHandleForHeapStart(),
+        m_cbv_srv_uav_count,
+        m_cbv_srv_uav_descriptor_size
+    );
+    D3D12_SHADER_RESOURCE_VIEW_DESC desc{};
+    desc.Format = format;
+    desc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURECUBE;
+    desc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+    desc.TextureCube.MipLevels = UINT32_MAX;
+    desc.TextureCube.MostDetailedMip = 0;
+    desc.TextureCube.ResourceMinLODClamp = 0.0f;
+    m_rhi.device()->CreateShaderResourceView(resource, &desc, handle);
 
     return m_cbv_srv_uav_count++;
 }
 
 uint32_t Renderer::create_uav(ID3D12Resource *resource, DXGI_FORMAT format)
+{
+    write_uav(m_cbv_srv_uav_count, resource, format);
+
+    return m_cbv_srv_uav_count++;
+}
+
+void Renderer::write_uav(
+    uint32_t idx, ID3D12Resource *resource, DXGI_FORMAT format, uint32_t mip_slice
+)
 {
     CD3DX12_CPU_DESCRIPTOR_HANDLE handle(
         m_cbv_srv_uav_heap->GetCPUDescriptorHandleForHeapStart(),
-        m_cbv_srv_uav_count,
+        idx,
         m_cbv_srv_uav_descriptor_size
     );
     D3D12_UNORDERED_ACCESS_VIEW_DESC desc{};
     desc.Format = format;
     desc.ViewDimension = D3D12_UAV_DIMENSION_TEXTURE2D;
-    desc.Texture2D.MipSlice = 0;
+    desc.Texture2D.MipSlice = mip_slice;
     desc.Texture2D.PlaneSlice = 0;
     m_rhi.device()->CreateUnorderedAccessView(resource, nullptr, &desc, handle);
+}
+
+uint32_t Renderer::create_raw_buffer_srv(ID3D12Resource *resource, uint64_t size)
+{
+    CD3DX12_CPU_DESCRIPTOR_HANDLE handle(
+        m_cbv_srv_uav_heap->GetCPUDescriptorHandleForHeapStart(),
+        m_cbv_srv_uav_count,
+        m_cbv_srv_uav_descriptor_size
+    );
+    D3D12_SHADER_RESOURCE_VIEW_DESC desc{};
+    desc.Format = DXGI_FORMAT_R32_TYPELESS;
+    desc.ViewDimension = D3D12_SRV_DIMENSION_BUFFER;
+    desc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+    desc.Buffer.FirstElement = 0;
+    desc.Buffer.NumElements = static_cast<UINT>(size / 4);
+    desc.Buffer.StructureByteStride = 0;
+    desc.Buffer.Flags = D3D12_BUFFER_SRV_FLAG_RAW;
+    m_rhi.device()->CreateShaderResourceView(resource, &desc, handle);
 
     return m_cbv_srv_uav_count++;
 }
 
-uint32_t Renderer::create_cbv(ID3D12Resource *resource)
+uint32_t Renderer::create_cbv(ID3D12Resource *resource, uint64_t size)
 {
     CD3DX12_CPU_DESCRIPTOR_HANDLE handle(
         m_cbv_srv_uav_heap->GetCPUDescriptorHandleForHeapStart(),
@@ -687,8 +1833,9 @@ uint32_t Renderer::create_cbv(ID3D12Resource *resource)
     );
     D3D12_CONSTANT_BUFFER_VIEW_DESC desc{};
     desc.BufferLocation = resource->GetGPUVirtualAddress();
-    desc.SizeInBytes =
-        next_multiple_of_k(sizeof(LightsBuffer), D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT);
+    desc.SizeInBytes = static_cast<UINT>(
+        next_multiple_of_k(size, D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT)
+    );
     m_rhi.device()->CreateConstantBufferView(&desc, handle);
 
     return m_cbv_srv_uav_count++;
@@ -1,25 +1,70 @@
 #pragma once
 
+#include <array>
 #include <cstdint>
 #include <span>
+#include <string>
+#include <vector>
 
 #include <d3d12.h>
 
 #include <SDL3/SDL_video.h>
 
+#include "auto_exposure_pass.hpp"
+#include "deferred_lighting_pass.hpp"
+#include "draw_list.hpp"
 #include "forward_pass.hpp"
+#include "frame_setup.hpp"
+#include "frame_stats.hpp"
+#include "ibl.hpp"
+#include "mesh.hpp"
+#include "occlusion_cull_pass.hpp"
 #include "post_process_pass.hpp"
+#include "render_graph.hpp"
 #include "scene.hpp"
 #include "shadow_map_pass.hpp"
 #include "skybox_pass.hpp"
+#include "software_occlusion.hpp"
+#include "texture_image.hpp"
+#include "texture_streaming.hpp"
 
 namespace Arctic::Renderer
 {
 
+struct TransientMemoryStats
+{
+    // Size of the heap all transient render targets are placed in.
+    uint64_t heap_size{0};
+    // Memory the same render targets would need as individual committed resources.
+    uint64_t unaliased_size{0};
+};
+
+struct VertexMemoryStats
+{
+    // Size of the vertex buffers of all meshes.
+    uint64_t compressed_size{0};
+    // Size the same vertices have in the format they are loaded in.
+    uint64_t uncompressed_size{0};
+    uint32_t mesh_count{0};
+    // Meshes whose positions are quantized to 16 bits.
+    uint32_t quantized_mesh_count{0};
+};
+
 class Renderer
 {
   public:
-    static constexpr size_t MAX_NUM_POINT_LIGHTS = 16;
+    // Has to match `MAX_POINT_LIGHTS` in `lighting.hlsli`. The lights of both paths live in one
+    // constant buffer, which holds at most 64 KiB.
+    static constexpr size_t MAX_NUM_POINT_LIGHTS = 1024;
+    // Has to match `POINT_LIGHT_CUTOFF` in `lighting.hlsli`. A point light reaches as far as its
+    // radiance stays above this value.
+    static constexpr float POINT_LIGHT_CUTOFF = 0.01f;
+
+    // Memory available to the mip levels of all material textures.
+    static constexpr uint64_t TEXTURE_STREAMING_BUDGET = 512ull * 1024 * 1024;
+
+    // Largest distance, in scene units, vertex positions may move when they are quantized.
+    static constexpr float VERTEX_POSITION_TOLERANCE = 0.0005f;
 
   private:
     struct LightsBuffer
@@ -29,6 +74,57 @@ class Renderer
         PointLight point_lights[Renderer::MAX_NUM_POINT_LIGHTS];
     };
 
+    // See `Ibl` in `lighting.hlsli`.
+    struct IblBuffer
+    {
+        glm::vec4 irradiance_sh[9];
+        uint32_t specular_srv_idx;
+        uint32_t brdf_lut_srv_idx;
+        float specular_max_level;
+    };
+
+    struct TransientTexture
+    {
+        std::string name;
+        D3D12_RESOURCE_DESC desc;
+        D3D12_RESOURCE_ALLOCATION_INFO allocation_info;
+        ResourceState initial_state;
+        ResourceHandle handle;
+        ComPtr<ID3D12Resource> resource;
+    };
+
+    struct StreamedTexture
+    {
+        // Holds every level of the texture, resident or not, e.g. in the mapping of the file it
+        // was loaded from.
+        TextureImage image;
+        uint32_t streaming_idx{0};
+        // Copy of the texture with a different set of resident levels, which replaces it once
+        // its upload is complete.
+        ComPtr<ID3D12Resource> pending_texture;
+        uint64_t pending_fence_value{0};
+    };
+
+    // Views and textures of a material that frames in flight may still be using.
+    struct RetiredMaterialViews
+    {
+        uint32_t srv_offset;
+        std::array<ComPtr<ID3D12Resource>, Material::NUM_TEXTURES> textures;
+        // Streaming indices of the textures that were replaced, whose old copies the streaming
+        // policy accounts for until they are released.
+        std::vector<uint32_t> replaced_streaming_idxs;
+        uint64_t frame_fence_value;
+    };
+
+    struct TransientLayout
+    {
+        uint64_t heap_size{0};
+        std::vector<uint64_t> offsets;
+        std::vector<uint64_t> sizes;
+
+        bool operator==(const TransientLayout &) const = default;
+    };
+
     SDL_Window *m_window;
 
     struct
@@ -63,15 +159,43 @@ class Renderer
     ComPtr<ID3D12Resource> m_skybox_environment;
     uint32_t m_skybox_environment_srv_idx;
 
-    ComPtr<ID3D12Resource> m_forward_color_target;
+    // Image based lighting of the environment, see `IblData`.
+    ComPtr<ID3D12Resource> m_ibl_specular;
+    uint32_t m_ibl_specular_srv_idx;
+    ComPtr<ID3D12Resource> m_ibl_brdf_lut;
+    uint32_t m_ibl_brdf_lut_srv_idx;
+    ComPtr<ID3D12Resource> m_ibl_buffer;
+    uint32_t m_ibl_buffer_cbv_idx;
+
+    ComPtr<ID3D12Heap> m_transient_heap;
+    // Depends on the resource heap tier, see `init`.
+    D3D12_HEAP_FLAGS m_transient_heap_flags{D3D12_HEAP_FLAG_ALLOW_ALL_BUFFERS_AND_TEXTURES};
+    TransientLayout m_transient_layout;
+    // Whether the device supports mesh shaders, see `init`.
+    bool m_mesh_shaders_supported{true};
+    TransientMemoryStats m_transient_memory_stats;
+    VertexMemoryStats m_vertex_memory_stats;
+
+    TransientTexture m_forward_color_target;
     D3D12_CPU_DESCRIPTOR_HANDLE m_forward_color_target_rtv;
+    uint32_t m_forward_color_target_srv_idx;
+    // Written by the lighting pass of the deferred path.
     uint32_t m_forward_color_target_uav_idx;
 
-    ComPtr<ID3D12Resource> m_forward_depth_target;
+    TransientTexture m_forward_depth_target;
     D3D12_CPU_DESCRIPTOR_HANDLE m_forward_depth_target_dsv;
+    uint32_t m_forward_depth_target_srv_idx;
+
+    // Only declared in frames that take the deferred path, in the order of `GBUFFER_FORMATS`.
+    std::array<TransientTexture, GBUFFER_FORMATS.size()> m_gbuffer_targets;
+    std::array<D3D12_CPU_DESCRIPTOR_HANDLE, GBUFFER_FORMATS.size()> m_gbuffer_rtvs;
+    std::array<uint32_t, GBUFFER_FORMATS.size()> m_gbuffer_srv_idxs;
 
-    ComPtr<ID3D12Resource> m_post_process_output;
-    uint32_t m_post_process_output_uav_idx;
+    // Depth pyramid of the forward depth target, half its size.
+    TransientTexture m_hiz;
+    uint32_t m_hiz_srv_idx;
+    // `MAX_HIZ_MIPS` consecutive views, one for each level.
+    uint32_t m_hiz_first_uav_idx;
 
     ShadowMapPass m_shadow_map_pass;
 
@@ -79,11 +203,35 @@ class Renderer
 
     ForwardPass m_forward_pass;
 
+    DeferredLightingPass m_deferred_lighting_pass;
+
+    OcclusionCullPass m_occlusion_cull_pass;
+
+    JobSystem m_jobs;
+    SoftwareOcclusionCuller m_software_occlusion;
+
+    AutoExposurePass m_auto_exposure_pass;
+
     PostProcessPass m_post_process_pass;
 
+    RenderGraph m_render_graph;
+    std::vector<PassTiming> m_pass_timings;
+
     std::vector<Mesh> m_meshes;
+    std::vector<MeshDrawInfo> m_mesh_draw_infos;
     std::vector<Material> m_materials;
 
+    TextureStreamingPolicy m_texture_streaming{
+        TextureStreamingConfig{.budget = TEXTURE_STREAMING_BUDGET}
+    };
+    // Indexed by material, then by texture in the same order as `Material::textures`.
+    std::vector<std::array<StreamedTexture, Material::NUM_TEXTURES>> m_streamed_textures;
+    std::vector<StreamedTextureDesc> m_streamed_texture_descs;
+    std::vector<RetiredMaterialViews> m_retired_material_views;
+    std::vector<uint32_t> m_free_material_srv_offsets;
+
+    FrameSetup m_frame;
+
     Renderer() = delete;
     Renderer(const Renderer &) = delete;
     Renderer &operator=(const Renderer &) = delete;
@@ -93,7 +241,9 @@ class Renderer
   public:
     Renderer(SDL_Window *window, uint32_t initial_width, uint32_t initial_height)
         : m_window(window), m_window_size{initial_width, initial_height}, m_shadow_map_pass(&m_rhi),
-          m_skybox_pass(&m_rhi), m_forward_pass(&m_rhi), m_post_process_pass(&m_rhi)
+          m_skybox_pass(&m_rhi), m_forward_pass(&m_rhi), m_deferred_lighting_pass(&m_rhi),
+          m_occlusion_cull_pass(&m_rhi), m_software_occlusion(&m_jobs),
+          m_auto_exposure_pass(&m_rhi), m_post_process_pass(&m_rhi)
     {
     }
 
@@ -106,16 +256,24 @@ class Renderer
     [[nodiscard]] bool
     render_frame(const Scene &scene, const Settings &settings, std::function<void()> &&build_ui);
 
-    [[nodiscard]] bool
-    create_mesh(std::span<Vertex> vertices, std::span<uint32_t> indices, MaterialIdx material_idx);
+    // `indices` holds all levels of detail of the mesh, `lods` the ranges of each of them.
+    [[nodiscard]] bool create_mesh(
+        std::span<Vertex> vertices, std::span<uint32_t> indices, std::span<const MeshLod> lods,
+        MaterialIdx material_idx
+    );
 
+    // The images may be uncompressed or block compressed. Only their smallest mip levels are
+    // uploaded up front, the others are streamed in once they are needed, so the renderer keeps
+    // the images.
     [[nodiscard]] bool create_material(
-        void *diffuse_data, uint32_t diffuse_width, uint32_t diffuse_height, void *normal_data,
-        uint32_t normal_width, uint32_t normal_height, void *metalness_roughness_data,
-        uint32_t metalness_roughness_width, uint32_t metalness_roughness_height
+        TextureImage &&diffuse, TextureImage &&normal, TextureImage &&metalness_roughness
     );
 
-    [[nodiscard]] bool create_hdri(float *data, uint32_t width, uint32_t height);
+    // Uploads the environment as a half float cubemap with its mip chain for the skybox.
+    [[nodiscard]] bool create_environment(const CubeMap &environment);
+
+    // Uploads the precomputed lighting of the environment the scene is lit by.
+    [[nodiscard]] bool create_ibl(const IblData &ibl);
 
     void update_lights(std::span<PointLight> point_lights);
 
@@ -124,17 +282,134 @@ class Renderer
         return m_rhi.flush();
     }
 
+    void wait_for_next_frame()
+    {
+        m_rhi.wait_for_next_frame();
+    }
+
+    [[nodiscard]] FramePacer &frame_pacer()
+    {
+        return m_rhi.frame_pacer();
+    }
+
+    // Without mesh shader support `Settings::mesh_shaders` is ignored.
+    [[nodiscard]] bool mesh_shaders_supported() const
+    {
+        return m_mesh_shaders_supported;
+    }
+
+    [[nodiscard]] const TransientMemoryStats &transient_memory_stats() const
+    {
+        return m_transient_memory_stats;
+    }
+
+    [[nodiscard]] const VertexMemoryStats &vertex_memory_stats() const
+    {
+        return m_vertex_memory_stats;
+    }
+
+    [[nodiscard]] std::span<const MeshDrawInfo> mesh_draw_infos() const
+    {
+        return m_mesh_draw_infos;
+    }
+
+    [[nodiscard]] MemoryStats memory_stats()
+    {
+        return m_rhi.memory_tracker().stats();
+    }
+
+    [[nodiscard]] bool is_near_memory_budget()
+    {
+        return m_rhi.memory_tracker().is_near_budget();
+    }
+
+    // GPU time of the most recent frame whose timestamps have been read back.
+    [[nodiscard]] float gpu_frame_ms()
+    {
+        return m_rhi.gpu_timer().frame_ms();
+    }
+
+    [[nodiscard]] TextureStreamingStats texture_streaming_stats() const
+    {
+        return m_texture_streaming.stats();
+    }
+
+    // Read back from the GPU, so usually a few frames old.
+    [[nodiscard]] const OcclusionStats &occlusion_stats() const
+    {
+        return m_occlusion_cull_pass.stats();
+    }
+
+    // Of the current frame, if software occlusion culling is enabled.
+    [[nodiscard]] const SoftwareOcclusionStats &software_occlusion_stats() const
+    {
+        return m_software_occlusion.stats();
+    }
+
+    // Timings of every render graph pass of the last recorded frame, in execution order.
+    [[nodiscard]] const std::vector<PassTiming> &pass_timings() const
+    {
+        return m_pass_timings;
+    }
+
   private:
+    void update_transient_descs();
+
+    [[nodiscard]] static TransientDesc transient_desc(const TransientTexture &texture);
+
+    // Places `transients`, the transient textures declared in this frame, whenever the layout
+    // changes and initializes them on `cmd_list`. All others are released.
+    [[nodiscard]] bool place_transients(
+        ID3D12GraphicsCommandList *cmd_list, const CompiledGraph &compiled,
+        std::span<TransientTexture *const> transients
+    );
+
+    void execute_render_graph(ID3D12GraphicsCommandList *cmd_list, const CompiledGraph &compiled);
+
+    // Swaps in streamed textures whose upload is complete and releases the ones they replaced
+    // once no frame in flight uses them anymore.
+    void retire_streamed_textures();
+
+    // Starts uploads for the residency changes `setup_frame` requested.
+    [[nodiscard]] bool upload_streamed_textures();
+
+    // Creates a texture holding the levels of `image` starting at `first_mip` and describes the
+    // data to upload into it.
+    [[nodiscard]] bool create_streamed_texture(
+        const TextureImage &image, uint32_t first_mip, ComPtr<ID3D12Resource> &out_texture,
+        std::vector<D3D12_SUBRESOURCE_DATA> &out_subresources
+    );
+
+    // Writes the views of all textures of a material to a free range of the descriptor heap and
+    // returns its offset.
+    uint32_t create_material_views(MaterialIdx material_idx);
+
     [[nodiscard]] D3D12_CPU_DESCRIPTOR_HANDLE
     create_rtv(ID3D12Resource *resource, DXGI_FORMAT format);
 
     [[nodiscard]] D3D12_CPU_DESCRIPTOR_HANDLE create_dsv(ID3D12Resource *resource);
 
+    void
+    write_rtv(D3D12_CPU_DESCRIPTOR_HANDLE handle, ID3D12Resource *resource, DXGI_FORMAT format);
+
+    void write_dsv(D3D12_CPU_DESCRIPTOR_HANDLE handle, ID3D12Resource *resource);
+
     uint32_t create_srv(ID3D12Resource *resource, DXGI_FORMAT format);
 
+    // View of a texture with six array slices as a `TextureCube`.
+    uint32_t create_cube_srv(ID3D12Resource *resource, DXGI_FORMAT format);
+
+    void write_srv(uint32_t idx, ID3D12Resource *resource, DXGI_FORMAT format);
+
     uint32_t create_uav(ID3D12Resource *resource, DXGI_FORMAT format);
 
-    uint32_t create_cbv(ID3D12Resource *resource);
+    void
+    write_uav(uint32_t idx, ID3D12Resource *resource, DXGI_FORMAT format, uint32_t mip_slice = 0);
+
+    // Raw view of a whole buffer, read as a `ByteAddressBuffer`.
+    uint32_t create_raw_buffer_srv(ID3D12Resource *resource, uint64_t size);
+
+    uint32_t create_cbv(ID3D12Resource *resource, uint64_t size);
 };
 
 } // namespace Arctic::Renderer
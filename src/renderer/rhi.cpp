@@ -1,5 +1,8 @@
 #include "rhi.hpp"
 
+#include <utility>
+#include <vector>
+
 #include <d3d12.h>
 #include <d3dcompiler.h>
 #include <directx/d3dx12.h>
@@ -75,6 +78,16 @@ bool RHI::init(SDL_Window *window, uint64_t width, uint32_t height)
     );
     spdlog::trace("RHI::init: created device");
 
+    // ------------
+    // Set up memory tracking
+    // -------
+    if (!m_memory_tracker.init(dxgi_adapter4.Get()))
+    {
+        spdlog::error("RHI::init: failed to initialize memory tracker");
+        return false;
+    }
+    spdlog::trace("RHI::init: initialized memory tracker");
+
 #if defined(_DEBUG)
     // ------------
     // Filter debug messages
@@ -161,7 +174,8 @@ bool RHI::init(SDL_Window *window, uint64_t width, uint32_t height)
         .Scaling = DXGI_SCALING_STRETCH,
         .SwapEffect = DXGI_SWAP_EFFECT_FLIP_DISCARD,
         .AlphaMode = DXGI_ALPHA_MODE_UNSPECIFIED,
-        .Flags = m_allow_tearing ? DXGI_SWAP_CHAIN_FLAG_ALLOW_TEARING : 0u,
+        .Flags = DXGI_SWAP_CHAIN_FLAG_FRAME_LATENCY_WAITABLE_OBJECT |
+                 (m_allow_tearing ? DXGI_SWAP_CHAIN_FLAG_ALLOW_TEARING : 0u),
     };
     {
         HWND hwnd = static_cast<HWND>(SDL_GetPointerProperty(
@@ -192,6 +206,16 @@ bool RHI::init(SDL_Window *window, uint64_t width, uint32_t height)
         m_current_backbuffer_index = m_swapchain->GetCurrentBackBufferIndex();
     }
 
+    // ------------
+    // Set up frame pacing
+    // -------
+    if (!m_frame_pacer.init(m_swapchain.Get(), m_allow_tearing))
+    {
+        spdlog::error("RHI::init: failed to initialize frame pacer");
+        return false;
+    }
+    spdlog::trace("RHI::init: initialized frame pacer");
+
     // ------------
     // Create RTV descriptor heap
     // -------
@@ -307,6 +331,46 @@ bool RHI::init(SDL_Window *window, uint64_t width, uint32_t height)
         spdlog::trace("RHI::init: created immediate submit objects");
     }
 
+    // ------------
+    // Create objects for async uploads
+    // -------
+    {
+        D3D12_COMMAND_QUEUE_DESC desc{};
+        desc.Type = D3D12_COMMAND_LIST_TYPE_COPY;
+        desc.Priority = D3D12_COMMAND_QUEUE_PRIORITY_NORMAL;
+        desc.Flags = D3D12_COMMAND_QUEUE_FLAG_NONE;
+        desc.NodeMask = 0;
+        DXERR(
+            m_device->CreateCommandQueue(&desc, IID_PPV_ARGS(&m_async_upload.queue)),
+            "RHI::init: failed to create copy queue"
+        );
+        m_async_upload.queue->SetName(L"async upload copy queue");
+
+        DXERR(
+            m_device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&m_async_upload.fence)),
+            "RHI::init: failed to create fence for async uploads"
+        );
+        m_async_upload.fence->SetName(L"async upload fence");
+        m_async_upload.fence_event = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+        if (!m_async_upload.fence_event)
+        {
+            spdlog::error("RHI::init: failed to create fence event for async uploads");
+            return false;
+        }
+
+        spdlog::trace("RHI::init: created async upload objects");
+    }
+
+    // ------------
+    // Create timestamp queries
+    // -------
+    if (!m_gpu_timer.init(*this, m_command_queue.Get()))
+    {
+        spdlog::error("RHI::init: failed to initialize gpu timer");
+        return false;
+    }
+    spdlog::trace("RHI::init: initialized gpu timer");
+
     if (!m_compiler.init())
     {
         spdlog::error("RHI::init: failed to initialize shader compiler");
@@ -394,6 +458,7 @@ bool RHI::render_frame(
     {
         ZoneScopedN("Wait For Fence");
         ZoneValue(m_current_backbuffer_index);
+        auto wait_begin = std::chrono::high_resolution_clock::now();
         DXERR(
             wait_for_fence_value(
                 m_fence.Get(),
@@ -402,6 +467,20 @@ bool RHI::render_frame(
             ),
             "RHI::render_frame: failed to wait for fence"
         );
+        m_frame_pacer.record_gpu_wait(std::chrono::high_resolution_clock::now() - wait_begin);
+        m_frame_pacer.poll_completed_frames(m_fence->GetCompletedValue());
+    }
+
+    if (!m_gpu_timer.collect(m_fence->GetCompletedValue()))
+    {
+        spdlog::error("RHI::render_frame: failed to collect gpu timings");
+        return false;
+    }
+
+    if (!m_memory_tracker.poll_budget())
+    {
+        spdlog::error("RHI::render_frame: failed to poll memory budget");
+        return false;
     }
 
     ComPtr<ID3D12CommandAllocator> cmd_allocator = m_command_allocators[m_current_backbuffer_index];
@@ -418,14 +497,15 @@ bool RHI::render_frame(
         m_current_backbuffer_index,
         m_rtv_descriptor_size
     );
+    m_gpu_timer.begin_frame(m_command_list.Get(), m_current_backbuffer_index);
     render_func(m_command_list.Get(), backbuffer.Get(), rtv_handle);
+    m_gpu_timer.end_frame(m_command_list.Get());
 
     DXERR(m_command_list->Close(), "RHI::render_frame: failed to close command list");
     std::array<ID3D12CommandList *const, 1> lists{m_command_list.Get()};
     m_command_queue->ExecuteCommandLists(static_cast<UINT>(lists.size()), lists.data());
 
-    UINT present_flags = m_allow_tearing ? DXGI_PRESENT_ALLOW_TEARING : 0;
-    m_swapchain->Present(0, present_flags);
+    m_swapchain->Present(m_frame_pacer.sync_interval(), m_frame_pacer.present_flags());
     DXERR(
         signal_fence(
             m_fence.Get(),
@@ -434,6 +514,11 @@ bool RHI::render_frame(
         ),
         "RHI::render_frame: failed to signal fence"
     );
+    m_frame_pacer.frame_submitted(
+        m_current_backbuffer_index,
+        m_frame_fence_values[m_current_backbuffer_index]
+    );
+    m_gpu_timer.frame_submitted(m_frame_fence_values[m_current_backbuffer_index]);
 
     TracyD3D12Collect(m_tracy_d3d12_ctx);
 
@@ -520,11 +605,11 @@ bool RHI::immediate_submit(std::function<void(ID3D12GraphicsCommandList *cmd_lis
 
 bool RHI::create_buffer(
     uint64_t size, D3D12_RESOURCE_STATES initial_state, D3D12_HEAP_TYPE heap_type,
-    ComPtr<ID3D12Resource> &out_buffer
+    MemoryCategory category, ComPtr<ID3D12Resource> &out_buffer, D3D12_RESOURCE_FLAGS flags
 )
 {
     CD3DX12_HEAP_PROPERTIES heap_props(heap_type);
-    CD3DX12_RESOURCE_DESC resource_desc = CD3DX12_RESOURCE_DESC::Buffer(size);
+    CD3DX12_RESOURCE_DESC resource_desc = CD3DX12_RESOURCE_DESC::Buffer(size, flags);
     DXERR(
         m_device->CreateCommittedResource(
             &heap_props,
@@ -536,18 +621,29 @@ bool RHI::create_buffer(
         ),
         "RHI::create_buffer: failed to create buffer"
     );
+
+    D3D12_RESOURCE_ALLOCATION_INFO allocation_info =
+        m_device->GetResourceAllocationInfo(0, 1, &resource_desc);
+    if (!m_memory_tracker.track(out_buffer.Get(), category, allocation_info.SizeInBytes))
+    {
+        spdlog::error("RHI::create_buffer: failed to track buffer memory");
+        return false;
+    }
+
     return true;
 }
 
 bool RHI::create_texture(
     uint64_t width, uint32_t height, DXGI_FORMAT format, D3D12_RESOURCE_STATES initial_state,
-    ComPtr<ID3D12Resource> &out_texture, D3D12_RESOURCE_FLAGS flags
+    MemoryCategory category, ComPtr<ID3D12Resource> &out_texture, D3D12_RESOURCE_FLAGS flags,
+    uint16_t mip_levels, uint16_t array_size
 )
 {
     CD3DX12_HEAP_PROPERTIES heap_props(D3D12_HEAP_TYPE_DEFAULT);
-    CD3DX12_RESOURCE_DESC resource_desc = CD3DX12_RESOURCE_DESC::Tex2D(format, width, height);
+    CD3DX12_RESOURCE_DESC resource_desc =
+        CD3DX12_RESOURCE_DESC::Tex2D(format, width, height, array_size);
     resource_desc.Flags = flags;
-    resource_desc.MipLevels = 1;
+    resource_desc.MipLevels = mip_levels;
     DXERR(
         m_device->CreateCommittedResource(
             &heap_props,
@@ -560,6 +656,53 @@ bool RHI::create_texture(
         "RHI::create_texture: failed to create texture"
     );
 
+    D3D12_RESOURCE_ALLOCATION_INFO allocation_info =
+        m_device->GetResourceAllocationInfo(0, 1, &resource_desc);
+    if (!m_memory_tracker.track(out_texture.Get(), category, allocation_info.SizeInBytes))
+    {
+        spdlog::error("RHI::create_texture: failed to track texture memory");
+        return false;
+    }
+
+    return true;
+}
+
+bool RHI::create_heap(
+    uint64_t size, D3D12_HEAP_TYPE heap_type, D3D12_HEAP_FLAGS flags, MemoryCategory category,
+    ComPtr<ID3D12Heap> &out_heap
+)
+{
+    CD3DX12_HEAP_DESC heap_desc(size, heap_type, 0, flags);
+    DXERR(
+        m_device->CreateHeap(&heap_desc, IID_PPV_ARGS(&out_heap)),
+        "RHI::create_heap: failed to create heap"
+    );
+
+    if (!m_memory_tracker.track(out_heap.Get(), category, size))
+    {
+        spdlog::error("RHI::create_heap: failed to track heap memory");
+        return false;
+    }
+
+    return true;
+}
+
+bool RHI::create_placed_texture(
+    ID3D12Heap *heap, uint64_t heap_offset, const D3D12_RESOURCE_DESC &desc,
+    D3D12_RESOURCE_STATES initial_state, ComPtr<ID3D12Resource> &out_texture
+)
+{
+    DXERR(
+        m_device->CreatePlacedResource(
+            heap,
+            heap_offset,
+            &desc,
+            initial_state,
+            nullptr,
+            IID_PPV_ARGS(&out_texture)
+        ),
+        "RHI::create_placed_texture: failed to create placed texture"
+    );
     return true;
 }
 
@@ -573,6 +716,7 @@ bool RHI::upload_to_buffer(
             GetRequiredIntermediateSize(dst_buffer, 0, 1),
             D3D12_RESOURCE_STATE_GENERIC_READ,
             D3D12_HEAP_TYPE_UPLOAD,
+            MemoryCategory::Staging,
             staging_buffer
         ))
     {
@@ -622,51 +766,198 @@ bool RHI::upload_to_texture(
     uint64_t width, uint64_t height, uint64_t channels
 )
 {
-    uint64_t src_data_size = width * height * channels;
+    D3D12_SUBRESOURCE_DATA data{
+        .pData = src_data,
+        .RowPitch = static_cast<LONG_PTR>(width * channels),
+        .SlicePitch = static_cast<LONG_PTR>(width * height * channels),
+    };
+    std::array uploads{TextureUpload{
+        .texture = dst_texture,
+        .subresources = std::span(&data, 1),
+    }};
+    return upload_to_textures(uploads, dst_texture_state);
+}
+
+// Gives every texture its own region of a staging buffer, with the placement alignment required
+// for texture copies. Returns the size of the staging buffer.
+static uint64_t
+staging_layout(std::span<const TextureUpload> uploads, std::vector<uint64_t> &out_offsets)
+{
+    out_offsets.clear();
+    out_offsets.reserve(uploads.size());
+    uint64_t staging_size = 0;
+    for (const TextureUpload &upload : uploads)
+    {
+        staging_size = (staging_size + D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT - 1) &
+                       ~uint64_t{D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT - 1};
+        out_offsets.emplace_back(staging_size);
+        staging_size += GetRequiredIntermediateSize(
+            upload.texture,
+            0,
+            static_cast<UINT>(upload.subresources.size())
+        );
+    }
+    return staging_size;
+}
+
+bool RHI::upload_to_textures(
+    std::span<const TextureUpload> uploads, D3D12_RESOURCE_STATES dst_texture_state
+)
+{
+    std::vector<uint64_t> staging_offsets;
+    uint64_t staging_size = staging_layout(uploads, staging_offsets);
+
     ComPtr<ID3D12Resource> staging_buffer;
     if (!create_buffer(
-            src_data_size,
+            staging_size,
             D3D12_RESOURCE_STATE_GENERIC_READ,
             D3D12_HEAP_TYPE_UPLOAD,
+            MemoryCategory::Staging,
             staging_buffer
         ))
     {
-        spdlog::error("RHI::upload_to_texture: failed to create staging buffer");
+        spdlog::error("RHI::upload_to_textures: failed to create staging buffer");
         return false;
     }
 
     bool res = immediate_submit([&](ID3D12GraphicsCommandList *cmd_list) {
-        CD3DX12_RESOURCE_BARRIER barrier = CD3DX12_RESOURCE_BARRIER::Transition(
-            dst_texture,
-            dst_texture_state,
-            D3D12_RESOURCE_STATE_COPY_DEST
-        );
-        cmd_list->ResourceBarrier(1, &barrier);
-
-        D3D12_SUBRESOURCE_DATA data{
-            .pData = src_data,
-            .RowPitch = static_cast<LONG_PTR>(width * channels),
-            .SlicePitch = static_cast<LONG_PTR>(width * height * channels),
-        };
-        UpdateSubresources(cmd_list, dst_texture, staging_buffer.Get(), 0, 0, 1, &data);
-
-        barrier = CD3DX12_RESOURCE_BARRIER::Transition(
-            dst_texture,
-            D3D12_RESOURCE_STATE_COPY_DEST,
-            dst_texture_state
-        );
-        cmd_list->ResourceBarrier(1, &barrier);
+        std::vector<CD3DX12_RESOURCE_BARRIER> barriers;
+        barriers.reserve(uploads.size());
+        for (const TextureUpload &upload : uploads)
+        {
+            barriers.emplace_back(CD3DX12_RESOURCE_BARRIER::Transition(
+                upload.texture,
+                dst_texture_state,
+                D3D12_RESOURCE_STATE_COPY_DEST
+            ));
+        }
+        cmd_list->ResourceBarrier(static_cast<UINT>(barriers.size()), barriers.data());
+
+        for (size_t i = 0; i < uploads.size(); ++i)
+        {
+            UpdateSubresources(
+                cmd_list,
+                uploads[i].texture,
+                staging_buffer.Get(),
+                staging_offsets[i],
+                0,
+                static_cast<UINT>(uploads[i].subresources.size()),
+                uploads[i].subresources.data()
+            );
+        }
+
+        for (CD3DX12_RESOURCE_BARRIER &barrier : barriers)
+        {
+            std::swap(barrier.Transition.StateBefore, barrier.Transition.StateAfter);
+        }
+        cmd_list->ResourceBarrier(static_cast<UINT>(barriers.size()), barriers.data());
     });
 
     if (!res)
     {
-        spdlog::error("RHI::upload_to_texture: immediate submit failed");
+        spdlog::error("RHI::upload_to_textures: immediate submit failed");
         return false;
     }
 
     return true;
 }
 
+bool RHI::async_upload_to_textures(
+    std::span<const TextureUpload> uploads, uint64_t &out_fence_value
+)
+{
+    ZoneScoped;
+
+    uint64_t completed_value = m_async_upload.fence->GetCompletedValue();
+    AsyncUpload *upload = nullptr;
+    for (AsyncUpload &candidate : m_async_upload.uploads)
+    {
+        if (candidate.fence_value <= completed_value)
+        {
+            upload = &candidate;
+            break;
+        }
+    }
+
+    if (upload)
+    {
+        DXERR(
+            upload->command_allocator->Reset(),
+            "RHI::async_upload_to_textures: failed to reset command allocator"
+        );
+        DXERR(
+            upload->command_list->Reset(upload->command_allocator.Get(), nullptr),
+            "RHI::async_upload_to_textures: failed to reset command list"
+        );
+    }
+    else
+    {
+        upload = &m_async_upload.uploads.emplace_back();
+        DXERR(
+            m_device->CreateCommandAllocator(
+                D3D12_COMMAND_LIST_TYPE_COPY,
+                IID_PPV_ARGS(&upload->command_allocator)
+            ),
+            "RHI::async_upload_to_textures: failed to create command allocator"
+        );
+        DXERR(
+            m_device->CreateCommandList(
+                0,
+                D3D12_COMMAND_LIST_TYPE_COPY,
+                upload->command_allocator.Get(),
+                nullptr,
+                IID_PPV_ARGS(&upload->command_list)
+            ),
+            "RHI::async_upload_to_textures: failed to create command list"
+        );
+    }
+
+    std::vector<uint64_t> staging_offsets;
+    uint64_t staging_size = staging_layout(uploads, staging_offsets);
+    if (!create_buffer(
+            staging_size,
+            D3D12_RESOURCE_STATE_GENERIC_READ,
+            D3D12_HEAP_TYPE_UPLOAD,
+            MemoryCategory::Staging,
+            upload->staging_buffer
+        ))
+    {
+        spdlog::error("RHI::async_upload_to_textures: failed to create staging buffer");
+        return false;
+    }
+
+    // Textures in the common state are promoted to the copy destination state implicitly and
+    // decay back once the copy queue is done with them, so no barriers are needed.
+    for (size_t i = 0; i < uploads.size(); ++i)
+    {
+        UpdateSubresources(
+            upload->command_list.Get(),
+            uploads[i].texture,
+            upload->staging_buffer.Get(),
+            staging_offsets[i],
+            0,
+            static_cast<UINT>(uploads[i].subresources.size()),
+            uploads[i].subresources.data()
+        );
+    }
+
+    DXERR(
+        upload->command_list->Close(),
+        "RHI::async_upload_to_textures: failed to close command list"
+    );
+    std::array<ID3D12CommandList *const, 1> lists{upload->command_list.Get()};
+    m_async_upload.queue->ExecuteCommandLists(static_cast<UINT>(lists.size()), lists.data());
+
+    out_fence_value = ++m_async_upload.fence_value;
+    DXERR(
+        m_async_upload.queue->Signal(m_async_upload.fence.Get(), out_fence_value),
+        "RHI::async_upload_to_textures: failed to signal fence"
+    );
+    upload->fence_value = out_fence_value;
+
+    return true;
+}
+
 bool RHI::signal_fence(ID3D12Fence *fence, uint64_t &fence_value, uint64_t &out_wait_value)
 {
     out_wait_value = ++fence_value;
@@ -702,6 +993,14 @@ bool RHI::flush()
         wait_for_fence_value(m_fence.Get(), m_fence_event, wait_value),
         "RHI::flush: failed to wait for fence"
     );
+    DXERR(
+        wait_for_fence_value(
+            m_async_upload.fence.Get(),
+            m_async_upload.fence_event,
+            m_async_upload.fence_value
+        ),
+        "RHI::flush: failed to wait for async uploads"
+    );
     return true;
 }
 
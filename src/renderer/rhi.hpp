@@ -2,6 +2,8 @@
 
 #include <array>
 #include <functional>
+#include <span>
+#include <vector>
 
 #include <d3d12.h>
 #include <dxgi1_6.h>
@@ -15,10 +17,20 @@
 
 #include "compiler.hpp"
 #include "comptr.hpp"
+#include "frame_pacer.hpp"
+#include "gpu_timer.hpp"
+#include "memory_tracker.hpp"
 
 namespace Arctic::Renderer
 {
 
+struct TextureUpload
+{
+    ID3D12Resource *texture;
+    // One entry per subresource, starting at subresource 0, e.g. one per mip level.
+    std::span<const D3D12_SUBRESOURCE_DATA> subresources;
+};
+
 class RHI
 {
   public:
@@ -28,6 +40,9 @@ class RHI
     ComPtr<ID3D12Device2> m_device;
     ComPtr<ID3D12CommandQueue> m_command_queue;
 
+    // Declared early so it outlives every tracked resource owned by the RHI.
+    MemoryTracker m_memory_tracker;
+
     tracy::D3D12QueueCtx *m_tracy_d3d12_ctx;
 
     bool m_allow_tearing{false};
@@ -35,6 +50,10 @@ class RHI
     DXGI_FORMAT m_swapchain_format{DXGI_FORMAT_R8G8B8A8_UINT};
     std::array<ComPtr<ID3D12Resource>, NUM_FRAMES> m_backbuffers;
 
+    FramePacer m_frame_pacer;
+
+    GpuTimer m_gpu_timer;
+
     ComPtr<ID3D12DescriptorHeap> m_rtv_heap;
     UINT m_rtv_descriptor_size{0};
 
@@ -56,6 +75,25 @@ class RHI
         uint64_t fence_value{0};
     } m_immediate_submit;
 
+    struct AsyncUpload
+    {
+        ComPtr<ID3D12CommandAllocator> command_allocator;
+        ComPtr<ID3D12GraphicsCommandList> command_list;
+        ComPtr<ID3D12Resource> staging_buffer;
+        uint64_t fence_value{0};
+    };
+
+    // Uploads on the copy queue that the CPU does not wait for. Command lists and staging buffers
+    // are reused once the copy queue is done with them.
+    struct
+    {
+        ComPtr<ID3D12CommandQueue> queue;
+        ComPtr<ID3D12Fence> fence;
+        HANDLE fence_event{nullptr};
+        uint64_t fence_value{0};
+        std::vector<AsyncUpload> uploads;
+    } m_async_upload;
+
     Compiler m_compiler;
 
     RHI(const RHI &) = delete;
@@ -75,6 +113,11 @@ class RHI
 
     [[nodiscard]] bool resize(uint32_t new_width, int32_t new_height);
 
+    void wait_for_next_frame()
+    {
+        m_frame_pacer.wait_for_next_frame();
+    }
+
     [[nodiscard]] bool
     render_frame(std::function<
                  void(ID3D12GraphicsCommandList *, ID3D12Resource *, D3D12_CPU_DESCRIPTOR_HANDLE)>
@@ -85,11 +128,33 @@ class RHI
         return m_device.Get();
     }
 
+    // Index of the frame being recorded, out of `NUM_FRAMES`. Per frame resources with this index
+    // are no longer used by the GPU once `render_frame` calls the render function.
+    [[nodiscard]] UINT current_frame_index() const
+    {
+        return m_current_backbuffer_index;
+    }
+
     [[nodiscard]] tracy::D3D12QueueCtx *tracy_ctx()
     {
         return m_tracy_d3d12_ctx;
     }
 
+    [[nodiscard]] FramePacer &frame_pacer()
+    {
+        return m_frame_pacer;
+    }
+
+    [[nodiscard]] MemoryTracker &memory_tracker()
+    {
+        return m_memory_tracker;
+    }
+
+    [[nodiscard]] GpuTimer &gpu_timer()
+    {
+        return m_gpu_timer;
+    }
+
     [[nodiscard]] DXGI_FORMAT swapchain_format()
     {
         return m_swapchain_format;
@@ -112,12 +177,26 @@ class RHI
 
     [[nodiscard]] bool create_buffer(
         uint64_t size, D3D12_RESOURCE_STATES initial_state, D3D12_HEAP_TYPE heap_type,
-        ComPtr<ID3D12Resource> &out_buffer
+        MemoryCategory category, ComPtr<ID3D12Resource> &out_buffer,
+        D3D12_RESOURCE_FLAGS flags = D3D12_RESOURCE_FLAG_NONE
     );
 
     [[nodiscard]] bool create_texture(
         uint64_t width, uint32_t height, DXGI_FORMAT format, D3D12_RESOURCE_STATES initial_state,
-        ComPtr<ID3D12Resource> &out_texture, D3D12_RESOURCE_FLAGS flags = D3D12_RESOURCE_FLAG_NONE
+        MemoryCategory category, ComPtr<ID3D12Resource> &out_texture,
+        D3D12_RESOURCE_FLAGS flags = D3D12_RESOURCE_FLAG_NONE, uint16_t mip_levels = 1,
+        uint16_t array_size = 1
+    );
+
+    [[nodiscard]] bool create_heap(
+        uint64_t size, D3D12_HEAP_TYPE heap_type, D3D12_HEAP_FLAGS flags, MemoryCategory category,
+        ComPtr<ID3D12Heap> &out_heap
+    );
+
+    // Placed resources are not accounted for individually, their memory is part of the heap.
+    [[nodiscard]] bool create_placed_texture(
+        ID3D12Heap *heap, uint64_t heap_offset, const D3D12_RESOURCE_DESC &desc,
+        D3D12_RESOURCE_STATES initial_state, ComPtr<ID3D12Resource> &out_texture
     );
 
     [[nodiscard]] bool upload_to_buffer(
@@ -130,6 +209,36 @@ class RHI
         uint64_t width, uint64_t height, uint64_t channels
     );
 
+    // Uploads the given subresources of several textures through a single staging buffer and
+    // command list submission. All textures have to be in `dst_texture_state`.
+    [[nodiscard]] bool upload_to_textures(
+        std::span<const TextureUpload> uploads, D3D12_RESOURCE_STATES dst_texture_state
+    );
+
+    // Like `upload_to_textures`, but records the copies on the copy queue and returns without
+    // waiting for them. The textures have to be in the common state and must not be used before
+    // `completed_async_upload_value` reaches `out_fence_value`.
+    [[nodiscard]] bool async_upload_to_textures(
+        std::span<const TextureUpload> uploads, uint64_t &out_fence_value
+    );
+
+    [[nodiscard]] uint64_t completed_async_upload_value()
+    {
+        return m_async_upload.fence->GetCompletedValue();
+    }
+
+    // Fence value signaled after the most recently submitted frame. Resources that frame used can
+    // be released once `completed_frame_fence_value` reaches it.
+    [[nodiscard]] uint64_t submitted_frame_fence_value() const
+    {
+        return m_fence_value;
+    }
+
+    [[nodiscard]] uint64_t completed_frame_fence_value()
+    {
+        return m_fence->GetCompletedValue();
+    }
+
     [[nodiscard]] bool
     signal_fence(ID3D12Fence *fence, uint64_t &fence_value, uint64_t &out_wait_value);
     [[nodiscard]] bool wait_for_fence_value(ID3D12Fence *fence, HANDLE fence_event, uint64_t value);
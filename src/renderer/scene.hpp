@@ -1,16 +1,14 @@
 #pragma once
 
 #include <array>
+#include <cstddef>
+#include <cstdint>
 #include <vector>
 
-#include <d3d12.h>
-
 #include <glm/mat4x4.hpp>
 #include <glm/vec2.hpp>
 #include <glm/vec3.hpp>
 
-#include "comptr.hpp"
-
 namespace Arctic::Renderer
 {
 
@@ -46,28 +44,6 @@ struct Vertex
     glm::vec2 tex_coords;
 };
 
-struct Mesh
-{
-    ComPtr<ID3D12Resource> vertex_buffer;
-    D3D12_VERTEX_BUFFER_VIEW vertex_buffer_view;
-
-    ComPtr<ID3D12Resource> index_buffer;
-    D3D12_INDEX_BUFFER_VIEW index_buffer_view;
-
-    uint32_t index_count;
-
-    MaterialIdx material_idx;
-};
-
-struct Material
-{
-    ComPtr<ID3D12Resource> diffuse;
-    ComPtr<ID3D12Resource> normal;
-    ComPtr<ID3D12Resource> metalness_roughness;
-
-    uint32_t srv_offset;
-};
-
 struct Object
 {
     glm::mat4 trs;
@@ -96,6 +72,7 @@ struct PointLight
 struct Scene
 {
     Camera camera;
+    // Scales the image based lighting from the environment.
     float ambient;
     DirectionalLight sun;
     std::vector<PointLight> point_lights;
@@ -107,6 +84,21 @@ struct Settings
     int tm_method{0};
     float gamma{2.2f};
     float exposure{1.0f};
+    // Exposes the image for its average luminance, measured every frame and adapted over time,
+    // instead of using `exposure`.
+    bool auto_exposure{true};
+    // Shifts the automatic exposure, in stops.
+    float exposure_compensation{0.0f};
+    // Draws meshlets with amplification and mesh shaders instead of using the input assembler.
+    bool mesh_shaders{true};
+    // Draws what was visible in the previous frame first and skips draws hidden behind it.
+    bool occlusion_culling{true};
+    // Skips objects hidden behind large occluders, rasterized on the CPU, before building the
+    // draw list.
+    bool software_occlusion{false};
+    // Writes the surfaces into a G-buffer and shades it in a compute pass that culls the point
+    // lights per screen tile, instead of shading every pixel with all lights while drawing.
+    bool deferred_shading{false};
 };
 
 } // namespace Arctic::Renderer
@@ -8,13 +8,26 @@
 #include <spdlog/spdlog.h>
 
 #include "dxerr.hpp"
+#include "meshlet.hpp"
 
 #define CONSTANTS_SIZE(ty) ((sizeof(ty) + 3) / 4)
 
 namespace Arctic::Renderer
 {
 
-bool ShadowMapPass::init()
+// Subobjects of the mesh shader pipeline, see `ID3D12Device2::CreatePipelineState`.
+struct DepthMeshletPipelineStream
+{
+    CD3DX12_PIPELINE_STATE_STREAM_ROOT_SIGNATURE root_signature;
+    CD3DX12_PIPELINE_STATE_STREAM_AS as;
+    CD3DX12_PIPELINE_STATE_STREAM_MS ms;
+    CD3DX12_PIPELINE_STATE_STREAM_RASTERIZER rasterizer;
+    CD3DX12_PIPELINE_STATE_STREAM_DEPTH_STENCIL depth_stencil;
+    CD3DX12_PIPELINE_STATE_STREAM_RENDER_TARGET_FORMATS render_target_formats;
+    CD3DX12_PIPELINE_STATE_STREAM_DEPTH_STENCIL_FORMAT depth_stencil_format;
+};
+
+bool ShadowMapPass::init(bool mesh_shaders)
 {
     std::vector<uint8_t> vs_code;
     if (!m_rhi->compiler().compile_shader(L"./shaders/depth.hlsl", L"main", L"vs_6_6", vs_code))
@@ -57,59 +70,166 @@ bool ShadowMapPass::init()
     );
     spdlog::trace("ShadowMapPass::init: created root signature");
 
-    std::array vertex_layout{
-        D3D12_INPUT_ELEMENT_DESC{
-            .SemanticName = "POSITION",
-            .SemanticIndex = 0,
-            .Format = DXGI_FORMAT_R32G32B32_FLOAT,
-            .InputSlot = 0,
-            .AlignedByteOffset = offsetof(Vertex, position),
-            .InputSlotClass = D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA,
-            .InstanceDataStepRate = 0,
-        },
-        D3D12_INPUT_ELEMENT_DESC{
-            .SemanticName = "NORMAL",
-            .SemanticIndex = 0,
-            .Format = DXGI_FORMAT_R32G32B32_FLOAT,
-            .InputSlot = 0,
-            .AlignedByteOffset = offsetof(Vertex, normal),
-            .InputSlotClass = D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA,
-            .InstanceDataStepRate = 0,
-        },
-        D3D12_INPUT_ELEMENT_DESC{
-            .SemanticName = "TEXCOORD",
-            .SemanticIndex = 0,
-            .Format = DXGI_FORMAT_R32G32_FLOAT,
-            .InputSlot = 0,
-            .AlignedByteOffset = offsetof(Vertex, tex_coords),
-            .InputSlotClass = D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA,
-            .InstanceDataStepRate = 0,
-        },
-    };
+    for (VertexPositionFormat position_format : VERTEX_POSITION_FORMATS)
+    {
+        // Only the position stream is bound, see `Mesh`.
+        std::array vertex_layout{
+            D3D12_INPUT_ELEMENT_DESC{
+                .SemanticName = "POSITION",
+                .SemanticIndex = 0,
+                .Format = vertex_position_dxgi_format(position_format),
+                .InputSlot = 0,
+                .AlignedByteOffset = 0,
+                .InputSlotClass = D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA,
+                .InstanceDataStepRate = 0,
+            },
+        };
+
+        D3D12_GRAPHICS_PIPELINE_STATE_DESC pipeline_desc{};
+        pipeline_desc.pRootSignature = m_root_signature.Get();
+        pipeline_desc.VS = {vs_code.data(), vs_code.size()};
+        pipeline_desc.BlendState = CD3DX12_BLEND_DESC(CD3DX12_DEFAULT());
+        pipeline_desc.SampleMask = ~0u;
+        pipeline_desc.RasterizerState = CD3DX12_RASTERIZER_DESC(CD3DX12_DEFAULT());
+        pipeline_desc.RasterizerState.FrontCounterClockwise = TRUE;
+        pipeline_desc.RasterizerState.CullMode = D3D12_CULL_MODE_FRONT;
+        pipeline_desc.DepthStencilState = CD3DX12_DEPTH_STENCIL_DESC(CD3DX12_DEFAULT());
+        pipeline_desc.InputLayout = {vertex_layout.data(), static_cast<UINT>(vertex_layout.size())};
+        pipeline_desc.PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;
+        pipeline_desc.NumRenderTargets = 0;
+        pipeline_desc.DSVFormat = DXGI_FORMAT_D32_FLOAT;
+        pipeline_desc.SampleDesc = {1, 0};
+        DXERR(
+            m_rhi->device()->CreateGraphicsPipelineState(
+                &pipeline_desc,
+                IID_PPV_ARGS(&m_pipelines[static_cast<size_t>(position_format)])
+            ),
+            "ShadowMapPass::init: failed to create pipeline state"
+        );
+    }
+    spdlog::trace("ShadowMapPass::init: created pipeline state");
+
+    return !mesh_shaders || init_meshlet_pipeline();
+}
 
-    D3D12_GRAPHICS_PIPELINE_STATE_DESC pipeline_desc{};
-    pipeline_desc.pRootSignature = m_root_signature.Get();
-    pipeline_desc.VS = {vs_code.data(), vs_code.size()};
-    pipeline_desc.BlendState = CD3DX12_BLEND_DESC(CD3DX12_DEFAULT());
-    pipeline_desc.SampleMask = ~0u;
-    pipeline_desc.RasterizerState = CD3DX12_RASTERIZER_DESC(CD3DX12_DEFAULT());
-    pipeline_desc.RasterizerState.FrontCounterClockwise = TRUE;
-    pipeline_desc.RasterizerState.CullMode = D3D12_CULL_MODE_FRONT;
-    pipeline_desc.DepthStencilState = CD3DX12_DEPTH_STENCIL_DESC(CD3DX12_DEFAULT());
-    pipeline_desc.InputLayout = {vertex_layout.data(), static_cast<UINT>(vertex_layout.size())};
-    pipeline_desc.PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;
-    pipeline_desc.NumRenderTargets = 0;
-    pipeline_desc.DSVFormat = DXGI_FORMAT_D32_FLOAT;
-    pipeline_desc.SampleDesc = {1, 0};
+bool ShadowMapPass::init_meshlet_pipeline()
+{
+    std::vector<uint8_t> as_code, ms_code;
+    if (!m_rhi->compiler()
+             .compile_shader(L"./shaders/meshlet_cull.hlsl", L"as_main", L"as_6_6", as_code))
+    {
+        spdlog::error(
+            "ShadowMapPass::init_meshlet_pipeline: failed to compile amplification shader"
+        );
+        return false;
+    }
+    if (!m_rhi->compiler()
+             .compile_shader(L"./shaders/depth_meshlet.hlsl", L"ms_main", L"ms_6_6", ms_code))
+    {
+        spdlog::error("ShadowMapPass::init_meshlet_pipeline: failed to compile mesh shader");
+        return false;
+    }
+
+    ComPtr<ID3DBlob> root_signature;
+
+    std::array<CD3DX12_ROOT_PARAMETER, 2> root_parameters{};
+    root_parameters[0].InitAsConstants(CONSTANTS_SIZE(ConstantBuffer), 0);
+    root_parameters[1].InitAsConstants(CONSTANTS_SIZE(MeshletConstants), 1);
+
+    CD3DX12_ROOT_SIGNATURE_DESC root_signature_desc;
+    root_signature_desc.Init(
+        static_cast<UINT>(root_parameters.size()),
+        root_parameters.data(),
+        0,
+        nullptr,
+        D3D12_ROOT_SIGNATURE_FLAG_CBV_SRV_UAV_HEAP_DIRECTLY_INDEXED
+    );
     DXERR(
-        m_rhi->device()->CreateGraphicsPipelineState(&pipeline_desc, IID_PPV_ARGS(&m_pipeline)),
-        "ShadowMapPass::init: failed to create pipeline state"
+        D3D12SerializeRootSignature(
+            &root_signature_desc,
+            D3D_ROOT_SIGNATURE_VERSION_1,
+            &root_signature,
+            nullptr
+        ),
+        "ShadowMapPass::init_meshlet_pipeline: failed to serialize root signature"
     );
-    spdlog::trace("ShadowMapPass::init: created pipeline state");
+    DXERR(
+        m_rhi->device()->CreateRootSignature(
+            0,
+            root_signature->GetBufferPointer(),
+            root_signature->GetBufferSize(),
+            IID_PPV_ARGS(&m_meshlet_root_signature)
+        ),
+        "ShadowMapPass::init_meshlet_pipeline: failed to create root signature"
+    );
+
+    // Same state as the input assembler pipelines.
+    CD3DX12_RASTERIZER_DESC rasterizer(CD3DX12_DEFAULT{});
+    rasterizer.FrontCounterClockwise = TRUE;
+    rasterizer.CullMode = D3D12_CULL_MODE_FRONT;
+
+    DepthMeshletPipelineStream stream{};
+    stream.root_signature = m_meshlet_root_signature.Get();
+    stream.as = CD3DX12_SHADER_BYTECODE(as_code.data(), as_code.size());
+    stream.ms = CD3DX12_SHADER_BYTECODE(ms_code.data(), ms_code.size());
+    stream.rasterizer = rasterizer;
+    stream.depth_stencil = CD3DX12_DEPTH_STENCIL_DESC(CD3DX12_DEFAULT{});
+    stream.render_target_formats = D3D12_RT_FORMAT_ARRAY{};
+    stream.depth_stencil_format = DXGI_FORMAT_D32_FLOAT;
+
+    D3D12_PIPELINE_STATE_STREAM_DESC stream_desc{
+        .SizeInBytes = sizeof(stream),
+        .pPipelineStateSubobjectStream = &stream,
+    };
+    DXERR(
+        m_rhi->device()->CreatePipelineState(&stream_desc, IID_PPV_ARGS(&m_meshlet_pipeline)),
+        "ShadowMapPass::init_meshlet_pipeline: failed to create pipeline state"
+    );
+    spdlog::trace("ShadowMapPass::init_meshlet_pipeline: created pipeline state");
 
     return true;
 }
 
+void ShadowMapPass::draw_meshlets(
+    ID3D12GraphicsCommandList *cmd_list, const RunData &run_data, ConstantBuffer &constants
+)
+{
+    ComPtr<ID3D12GraphicsCommandList6> mesh_cmd_list;
+    if (FAILED(cmd_list->QueryInterface(IID_PPV_ARGS(&mesh_cmd_list))))
+    {
+        spdlog::error("ShadowMapPass::draw_meshlets: command list does not support mesh shaders");
+        return;
+    }
+
+    cmd_list->SetGraphicsRootSignature(m_meshlet_root_signature.Get());
+    cmd_list->SetPipelineState(m_meshlet_pipeline.Get());
+
+    // The pass culls front faces, so meshlets facing the sun are the ones to cull, which is what
+    // the cone test culls when looking against the light direction.
+    glm::vec4 cull_view(-run_data.scene.sun.direction(), 0.0f);
+
+    for (const DrawItem &draw : run_data.draws)
+    {
+        if (draw.meshlet_count == 0)
+        {
+            continue;
+        }
+        const Mesh &mesh = run_data.meshes[draw.mesh_idx];
+
+        constants.model = draw.model * mesh.position_transform;
+        cmd_list->SetGraphicsRoot32BitConstants(0, CONSTANTS_SIZE(ConstantBuffer), &constants, 0);
+
+        MeshletConstants meshlet_constants_data =
+            meshlet_constants(mesh, draw, constants.proj_view, cull_view);
+        cmd_list->SetGraphicsRoot32BitConstants(
+            1, CONSTANTS_SIZE(MeshletConstants), &meshlet_constants_data, 0
+        );
+        mesh_cmd_list->DispatchMesh(
+            (draw.meshlet_count + MESHLET_CULL_GROUP_SIZE - 1) / MESHLET_CULL_GROUP_SIZE, 1, 1
+        );
+    }
+}
+
 void ShadowMapPass::run(ID3D12GraphicsCommandList *cmd_list, const RunData &run_data)
 {
     ZoneScoped;
@@ -128,11 +248,6 @@ void ShadowMapPass::run(ID3D12GraphicsCommandList *cmd_list, const RunData &run_
         nullptr
     );
 
-    cmd_list->SetGraphicsRootSignature(m_root_signature.Get());
-    cmd_list->SetPipelineState(m_pipeline.Get());
-
-    cmd_list->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-
     cmd_list->OMSetRenderTargets(0, nullptr, FALSE, &run_data.shadow_map_dsv);
 
     D3D12_VIEWPORT viewport{
@@ -152,18 +267,37 @@ void ShadowMapPass::run(ID3D12GraphicsCommandList *cmd_list, const RunData &run_
     };
     cmd_list->RSSetScissorRects(1, &scissor);
 
+    if (run_data.use_mesh_shaders)
+    {
+        ZoneScopedN("Meshlet Draw Loop");
+        draw_meshlets(cmd_list, run_data, constants);
+        return;
+    }
+
     {
         ZoneScopedN("Draw Loop");
-        for (const Object &obj : run_data.scene.objects)
+        cmd_list->SetGraphicsRootSignature(m_root_signature.Get());
+        cmd_list->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+
+        ID3D12PipelineState *bound_pipeline = nullptr;
+        for (const DrawItem &draw : run_data.draws)
         {
-            const Mesh &mesh = run_data.meshes[obj.mesh_idx];
-            constants.model = obj.trs;
+            const Mesh &mesh = run_data.meshes[draw.mesh_idx];
+            ID3D12PipelineState *pipeline =
+                m_pipelines[static_cast<size_t>(mesh.position_format)].Get();
+            if (pipeline != bound_pipeline)
+            {
+                cmd_list->SetPipelineState(pipeline);
+                bound_pipeline = pipeline;
+            }
+
+            constants.model = draw.model * mesh.position_transform;
 
             cmd_list
                 ->SetGraphicsRoot32BitConstants(0, CONSTANTS_SIZE(ConstantBuffer), &constants, 0);
-            cmd_list->IASetVertexBuffers(0, 1, &mesh.vertex_buffer_view);
+            cmd_list->IASetVertexBuffers(0, 1, &mesh.position_buffer_view);
             cmd_list->IASetIndexBuffer(&mesh.index_buffer_view);
-            cmd_list->DrawIndexedInstanced(mesh.index_count, 1, 0, 0, 0);
+            cmd_list->DrawIndexedInstanced(draw.index_count, 1, draw.first_index, 0, 0);
         }
     }
 }
@@ -1,10 +1,13 @@
 #pragma once
 
+#include <array>
 #include <span>
 
 #include <d3d12.h>
 
 #include "comptr.hpp"
+#include "draw_list.hpp"
+#include "mesh.hpp"
 #include "rhi.hpp"
 #include "scene.hpp"
 
@@ -26,14 +29,20 @@ class ShadowMapPass
     {
         D3D12_CPU_DESCRIPTOR_HANDLE shadow_map_dsv;
         std::span<Mesh> meshes;
+        std::span<const DrawItem> draws;
         const Scene &scene;
+        bool use_mesh_shaders;
     };
 
   private:
     RHI *m_rhi;
 
     ComPtr<ID3D12RootSignature> m_root_signature;
-    ComPtr<ID3D12PipelineState> m_pipeline;
+    // One for each vertex position format.
+    std::array<ComPtr<ID3D12PipelineState>, VERTEX_POSITION_FORMATS.size()> m_pipelines;
+
+    ComPtr<ID3D12RootSignature> m_meshlet_root_signature;
+    ComPtr<ID3D12PipelineState> m_meshlet_pipeline;
 
     ShadowMapPass() = delete;
     ShadowMapPass(const ShadowMapPass &) = delete;
@@ -46,9 +55,17 @@ class ShadowMapPass
     {
     }
 
-    [[nodiscard]] bool init();
+    // See `ForwardPass::init`.
+    [[nodiscard]] bool init(bool mesh_shaders);
 
     void run(ID3D12GraphicsCommandList *cmd_list, const RunData &run_data);
+
+  private:
+    [[nodiscard]] bool init_meshlet_pipeline();
+
+    void draw_meshlets(
+        ID3D12GraphicsCommandList *cmd_list, const RunData &run_data, ConstantBuffer &constants
+    );
 };
 
 } // namespace Arctic::Renderer
@@ -0,0 +1,650 @@
+#include "software_occlusion.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <limits>
+
+#include <glm/geometric.hpp>
+#include <glm/vec2.hpp>
+#include <glm/vec4.hpp>
+
+#include "meshlet.hpp"
+
+#if defined(_M_X64) || defined(__x86_64__)
+#include <immintrin.h>
+#define ARCTIC_SOFTWARE_OCCLUSION_AVX2
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+// MSVC compiles AVX2 intrinsics without any flags, the CPU is checked at runtime instead.
+#define ARCTIC_TARGET_AVX2
+#else
+#define ARCTIC_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace Arctic::Renderer
+{
+
+static constexpr uint32_t TILE_SIZE = SOFTWARE_OCCLUSION_TILE_SIZE;
+static constexpr uint32_t TILE_PIXELS = TILE_SIZE * TILE_SIZE;
+static constexpr uint32_t BIN_TILES = SOFTWARE_OCCLUSION_BIN_TILES;
+static constexpr uint32_t BIN_SIZE = TILE_SIZE * BIN_TILES;
+static constexpr float WIDTH = static_cast<float>(SOFTWARE_OCCLUSION_WIDTH);
+static constexpr float HEIGHT = static_cast<float>(SOFTWARE_OCCLUSION_HEIGHT);
+
+// Occluders set up and objects tested by one job.
+static constexpr size_t SETUP_CHUNK_SIZE = 8;
+static constexpr size_t TEST_CHUNK_SIZE = 64;
+
+// Relative error allowed for evaluating a plane equation in floats, with room for rounding the
+// coefficients and for the multiplications and additions of the evaluation itself.
+static constexpr double PLANE_EPSILON = 4.0 * FLT_EPSILON;
+
+using Triangle = SoftwareOcclusionCuller::Triangle;
+
+// Sets up a triangle given in pixel coordinates with its depth in z. Back faces are dropped
+// like in the forward pass: front faces are counterclockwise in normalized device coordinates,
+// which turns into clockwise with y pointing down.
+static bool setup_triangle(glm::vec3 v0, glm::vec3 v1, glm::vec3 v2, Triangle &out)
+{
+    double area = (static_cast<double>(v1.x) - v0.x) * (static_cast<double>(v2.y) - v0.y) -
+                  (static_cast<double>(v2.x) - v0.x) * (static_cast<double>(v1.y) - v0.y);
+    if (!(area < 0.0))
+    {
+        return false;
+    }
+    std::swap(v1, v2);
+    area = -area;
+
+    float min_x = std::min({v0.x, v1.x, v2.x});
+    float min_y = std::min({v0.y, v1.y, v2.y});
+    float max_x = std::max({v0.x, v1.x, v2.x});
+    float max_y = std::max({v0.y, v1.y, v2.y});
+    float min_depth = std::min({v0.z, v1.z, v2.z});
+    // Triangles beyond the far plane would never pass the depth test.
+    if (max_x < 0.0f || max_y < 0.0f || min_x >= WIDTH || min_y >= HEIGHT || min_depth >= 1.0f)
+    {
+        return false;
+    }
+
+    out.min_x = static_cast<uint16_t>(std::clamp(std::floor(min_x), 0.0f, WIDTH - 1.0f));
+    out.min_y = static_cast<uint16_t>(std::clamp(std::floor(min_y), 0.0f, HEIGHT - 1.0f));
+    out.max_x = static_cast<uint16_t>(std::clamp(std::floor(max_x), 0.0f, WIDTH - 1.0f));
+    out.max_y = static_cast<uint16_t>(std::clamp(std::floor(max_y), 0.0f, HEIGHT - 1.0f));
+
+    // The edge function of an edge is positive on the side of the remaining vertex. Moving it
+    // inwards by half the extent of a pixel along its normal leaves only pixels that are
+    // completely inside.
+    std::array<glm::vec3, 3> vertices{v0, v1, v2};
+    for (uint32_t i = 0; i < 3; ++i)
+    {
+        const glm::vec3 &from = vertices[i];
+        const glm::vec3 &to = vertices[(i + 1) % 3];
+        double a = static_cast<double>(from.y) - to.y;
+        double b = static_cast<double>(to.x) - from.x;
+        double c = static_cast<double>(from.x) * to.y - static_cast<double>(to.x) * from.y;
+        double error = PLANE_EPSILON * (std::abs(a) * WIDTH + std::abs(b) * HEIGHT + std::abs(c));
+        out.edge_a[i] = static_cast<float>(a);
+        out.edge_b[i] = static_cast<float>(b);
+        out.edge_c[i] = static_cast<float>(c - 0.5 * (std::abs(a) + std::abs(b)) - error);
+    }
+
+    // Moving the depth plane backwards by half its slope in both directions gives the farthest
+    // depth within the pixel.
+    double dz1 = static_cast<double>(v1.z) - v0.z;
+    double dz2 = static_cast<double>(v2.z) - v0.z;
+    double dx1 = static_cast<double>(v1.x) - v0.x;
+    double dx2 = static_cast<double>(v2.x) - v0.x;
+    double dy1 = static_cast<double>(v1.y) - v0.y;
+    double dy2 = static_cast<double>(v2.y) - v0.y;
+    double depth_a = (dz1 * dy2 - dz2 * dy1) / area;
+    double depth_b = (dz2 * dx1 - dz1 * dx2) / area;
+    double depth_c = v0.z - depth_a * v0.x - depth_b * v0.y;
+    double error = PLANE_EPSILON *
+                   (std::abs(depth_a) * WIDTH + std::abs(depth_b) * HEIGHT + std::abs(depth_c));
+    out.depth_a = static_cast<float>(depth_a);
+    out.depth_b = static_cast<float>(depth_b);
+    out.depth_c =
+        static_cast<float>(depth_c + 0.5 * (std::abs(depth_a) + std::abs(depth_b)) + error);
+    out.min_depth = min_depth;
+
+    return true;
+}
+
+// Clips a triangle in clip space against the near plane, which also keeps `w` positive, and sets
+// up the one or two triangles that are left. Returns how many were written to `out`.
+static uint32_t clip_and_setup_triangle(const std::array<glm::vec4, 3> &clip, Triangle *out)
+{
+    std::array<glm::vec4, 4> polygon;
+    uint32_t vertex_count = 0;
+    for (uint32_t i = 0; i < 3; ++i)
+    {
+        const glm::vec4 &from = clip[i];
+        const glm::vec4 &to = clip[(i + 1) % 3];
+        bool from_inside = from.z >= 0.0f;
+        bool to_inside = to.z >= 0.0f;
+        if (from_inside)
+        {
+            polygon[vertex_count++] = from;
+        }
+        if (from_inside != to_inside)
+        {
+            float t = from.z / (from.z - to.z);
+            polygon[vertex_count++] = from + (to - from) * t;
+        }
+    }
+    if (vertex_count < 3)
+    {
+        return 0;
+    }
+
+    std::array<glm::vec3, 4> screen;
+    for (uint32_t i = 0; i < vertex_count; ++i)
+    {
+        glm::vec3 ndc = glm::vec3(polygon[i]) / polygon[i].w;
+        screen[i] = glm::vec3(
+            (ndc.x * 0.5f + 0.5f) * WIDTH,
+            (0.5f - ndc.y * 0.5f) * HEIGHT,
+            ndc.z
+        );
+    }
+
+    uint32_t count = setup_triangle(screen[0], screen[1], screen[2], out[0]) ? 1 : 0;
+    if (vertex_count == 4 && setup_triangle(screen[0], screen[2], screen[3], out[count]))
+    {
+        ++count;
+    }
+    return count;
+}
+
+// Rasterizes rows `row_begin` to `row_end` of a tile at `x`, `y` and returns the farthest depth
+// in the tile afterwards.
+static float rasterize_tile_scalar(
+    const Triangle &tri, uint32_t x, uint32_t y, uint32_t row_begin, uint32_t row_end,
+    float *depth
+)
+{
+    for (uint32_t row = row_begin; row <= row_end; ++row)
+    {
+        float pixel_y = static_cast<float>(y + row) + 0.5f;
+        std::array<float, 3> edge_row;
+        for (uint32_t i = 0; i < 3; ++i)
+        {
+            edge_row[i] = tri.edge_b[i] * pixel_y + tri.edge_c[i];
+        }
+        float depth_row = tri.depth_b * pixel_y + tri.depth_c;
+
+        for (uint32_t lane = 0; lane < TILE_SIZE; ++lane)
+        {
+            float pixel_x = static_cast<float>(x + lane) + 0.5f;
+            bool covered = true;
+            for (uint32_t i = 0; i < 3; ++i)
+            {
+                covered &= tri.edge_a[i] * pixel_x + edge_row[i] >= 0.0f;
+            }
+            float z = tri.depth_a * pixel_x + depth_row;
+            float &pixel = depth[row * TILE_SIZE + lane];
+            if (covered && z < pixel)
+            {
+                pixel = z;
+            }
+        }
+    }
+
+    return *std::max_element(depth, depth + TILE_PIXELS);
+}
+
+// Whether every pixel of the inclusive rectangle within a tile is closer than `min_depth`. The
+// rectangle is given relative to the tile.
+static bool tile_occludes_scalar(
+    const float *depth, uint32_t x_begin, uint32_t x_end, uint32_t row_begin, uint32_t row_end,
+    float min_depth
+)
+{
+    for (uint32_t row = row_begin; row <= row_end; ++row)
+    {
+        for (uint32_t x = x_begin; x <= x_end; ++x)
+        {
+            if (depth[row * TILE_SIZE + x] >= min_depth)
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+#ifdef ARCTIC_SOFTWARE_OCCLUSION_AVX2
+
+ARCTIC_TARGET_AVX2 static float horizontal_max_avx2(__m256 value)
+{
+    __m128 max4 = _mm_max_ps(_mm256_castps256_ps128(value), _mm256_extractf128_ps(value, 1));
+    max4 = _mm_max_ps(max4, _mm_movehl_ps(max4, max4));
+    max4 = _mm_max_ss(max4, _mm_shuffle_ps(max4, max4, 1));
+    return _mm_cvtss_f32(max4);
+}
+
+// Same as `rasterize_tile_scalar` with one row of the tile per register. Multiplications and
+// additions happen in the same order, so both produce identical depths.
+ARCTIC_TARGET_AVX2 static float rasterize_tile_avx2(
+    const Triangle &tri, uint32_t x, uint32_t y, uint32_t row_begin, uint32_t row_end,
+    float *depth
+)
+{
+    __m256 pixel_x = _mm256_add_ps(
+        _mm256_set1_ps(static_cast<float>(x)),
+        _mm256_setr_ps(0.5f, 1.5f, 2.5f, 3.5f, 4.5f, 5.5f, 6.5f, 7.5f)
+    );
+    __m256 edge_x[3];
+    for (uint32_t i = 0; i < 3; ++i)
+    {
+        edge_x[i] = _mm256_mul_ps(_mm256_set1_ps(tri.edge_a[i]), pixel_x);
+    }
+    __m256 depth_x = _mm256_mul_ps(_mm256_set1_ps(tri.depth_a), pixel_x);
+    __m256 zero = _mm256_setzero_ps();
+
+    for (uint32_t row = row_begin; row <= row_end; ++row)
+    {
+        float pixel_y = static_cast<float>(y + row) + 0.5f;
+        __m256 covered = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (uint32_t i = 0; i < 3; ++i)
+        {
+            __m256 edge = _mm256_add_ps(
+                edge_x[i], _mm256_set1_ps(tri.edge_b[i] * pixel_y + tri.edge_c[i])
+            );
+            covered = _mm256_and_ps(covered, _mm256_cmp_ps(edge, zero, _CMP_GE_OQ));
+        }
+        __m256 z = _mm256_add_ps(depth_x, _mm256_set1_ps(tri.depth_b * pixel_y + tri.depth_c));
+
+        float *row_depth = depth + row * TILE_SIZE;
+        __m256 pixels = _mm256_loadu_ps(row_depth);
+        pixels = _mm256_blendv_ps(pixels, _mm256_min_ps(z, pixels), covered);
+        _mm256_storeu_ps(row_depth, pixels);
+    }
+
+    __m256 max = _mm256_loadu_ps(depth);
+    for (uint32_t row = 1; row < TILE_SIZE; ++row)
+    {
+        max = _mm256_max_ps(max, _mm256_loadu_ps(depth + row * TILE_SIZE));
+    }
+    return horizontal_max_avx2(max);
+}
+
+ARCTIC_TARGET_AVX2 static bool tile_occludes_avx2(
+    const float *depth, uint32_t x_begin, uint32_t x_end, uint32_t row_begin, uint32_t row_end,
+    float min_depth
+)
+{
+    __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    __m256i in_range = _mm256_and_si256(
+        _mm256_cmpgt_epi32(lanes, _mm256_set1_epi32(static_cast<int32_t>(x_begin) - 1)),
+        _mm256_cmpgt_epi32(_mm256_set1_epi32(static_cast<int32_t>(x_end) + 1), lanes)
+    );
+    __m256 min_depths = _mm256_set1_ps(min_depth);
+    for (uint32_t row = row_begin; row <= row_end; ++row)
+    {
+        __m256 behind =
+            _mm256_cmp_ps(_mm256_loadu_ps(depth + row * TILE_SIZE), min_depths, _CMP_GE_OQ);
+        if (_mm256_movemask_ps(_mm256_and_ps(behind, _mm256_castsi256_ps(in_range))) != 0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+#endif
+
+SoftwareOcclusionCuller::SoftwareOcclusionCuller(JobSystem *jobs)
+    : m_jobs(jobs), m_use_avx2(avx2_supported()), m_bins(BINS_X * BINS_Y),
+      m_depth(TILES_X * TILES_Y * TILE_PIXELS, 1.0f), m_tile_max_depth(TILES_X * TILES_Y, 1.0f)
+{
+}
+
+bool SoftwareOcclusionCuller::avx2_supported()
+{
+#if defined(ARCTIC_SOFTWARE_OCCLUSION_AVX2) && defined(_MSC_VER) && !defined(__clang__)
+    std::array<int, 4> info;
+    __cpuid(info.data(), 0);
+    if (info[0] < 7)
+    {
+        return false;
+    }
+    // The OS has to save the upper halves of the AVX registers as well.
+    __cpuid(info.data(), 1);
+    bool avx = (info[2] & (1 << 27)) != 0 && (info[2] & (1 << 28)) != 0;
+    if (!avx || (_xgetbv(0) & 0x6) != 0x6)
+    {
+        return false;
+    }
+    __cpuidex(info.data(), 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#elif defined(ARCTIC_SOFTWARE_OCCLUSION_AVX2)
+    return __builtin_cpu_supports("avx2");
+#else
+    return false;
+#endif
+}
+
+void SoftwareOcclusionCuller::add_mesh(
+    std::span<const Vertex> vertices, std::span<const uint32_t> indices
+)
+{
+    MeshGeometry &mesh = m_meshes.emplace_back();
+    mesh.positions.reserve(vertices.size());
+    for (const Vertex &vertex : vertices)
+    {
+        mesh.positions.push_back(vertex.position);
+    }
+    mesh.indices.assign(indices.begin(), indices.end());
+}
+
+void SoftwareOcclusionCuller::cull(
+    std::span<const Object> objects, std::span<const MeshDrawInfo> meshes, const Camera &camera,
+    std::vector<uint8_t> &out_visible
+)
+{
+    using Clock = std::chrono::steady_clock;
+    auto elapsed_ms = [](Clock::time_point begin) {
+        return std::chrono::duration<float, std::milli>(Clock::now() - begin).count();
+    };
+    Clock::time_point begin = Clock::now();
+    m_stats = SoftwareOcclusionStats{.object_count = static_cast<uint32_t>(objects.size())};
+
+    LodSelection lod = lod_selection(camera, SOFTWARE_OCCLUSION_HEIGHT, 0.0f);
+    build_draw_list(objects, meshes, lod, m_draws);
+    // Coarser levels of detail are not guaranteed to stay within the original mesh, which would
+    // let occluders hide objects that are visible.
+    for (DrawItem &draw : m_draws)
+    {
+        const MeshLod &original = meshes[draw.mesh_idx].lods.front();
+        draw.first_index = original.first_index;
+        draw.index_count = original.index_count;
+    }
+    glm::mat4 proj_view = camera.proj_view_matrix();
+
+    // Occluders are rasterized front to back, so the nearest ones fill the tiles first and the
+    // triangles behind them are rejected per tile.
+    auto distance = [&](uint32_t draw_idx) {
+        const DrawItem &draw = m_draws[draw_idx];
+        return glm::length(draw.bounds_center - camera.eye) - draw.bounds_radius;
+    };
+    m_occluders.clear();
+    for (uint32_t i = 0; i < m_draws.size(); ++i)
+    {
+        const DrawItem &draw = m_draws[i];
+        if (sphere_outside_frustum(proj_view, draw.bounds_center, draw.bounds_radius))
+        {
+            continue;
+        }
+        // Projected diameter of the bounding sphere, measured at its center.
+        float size =
+            2.0f * draw.bounds_radius * lod.pixels_per_unit / (distance(i) + draw.bounds_radius);
+        if (distance(i) <= 0.0f || size >= SOFTWARE_OCCLUSION_MIN_OCCLUDER_PIXELS)
+        {
+            m_occluders.push_back(i);
+        }
+    }
+    std::sort(m_occluders.begin(), m_occluders.end(), [&](uint32_t lhs, uint32_t rhs) {
+        return distance(lhs) < distance(rhs);
+    });
+    m_stats.occluder_count = static_cast<uint32_t>(m_occluders.size());
+
+    // Clipping against the near plane turns a triangle into at most two.
+    m_triangle_offsets.resize(m_occluders.size());
+    m_triangle_counts.assign(m_occluders.size(), 0);
+    size_t triangle_capacity = 0;
+    for (size_t i = 0; i < m_occluders.size(); ++i)
+    {
+        m_triangle_offsets[i] = triangle_capacity;
+        triangle_capacity += 2 * (m_draws[m_occluders[i]].index_count / 3);
+    }
+    m_triangles.resize(triangle_capacity);
+
+    m_jobs->parallel_for(
+        (m_occluders.size() + SETUP_CHUNK_SIZE - 1) / SETUP_CHUNK_SIZE,
+        [&](size_t chunk) {
+            size_t end = std::min(m_occluders.size(), (chunk + 1) * SETUP_CHUNK_SIZE);
+            for (size_t i = chunk * SETUP_CHUNK_SIZE; i < end; ++i)
+            {
+                setup_triangles(i, proj_view);
+            }
+        }
+    );
+
+    for (std::vector<uint32_t> &bin : m_bins)
+    {
+        bin.clear();
+    }
+    for (size_t i = 0; i < m_occluders.size(); ++i)
+    {
+        m_stats.triangle_count += m_triangle_counts[i];
+        for (uint32_t j = 0; j < m_triangle_counts[i]; ++j)
+        {
+            uint32_t triangle_idx = static_cast<uint32_t>(m_triangle_offsets[i] + j);
+            const Triangle &tri = m_triangles[triangle_idx];
+            for (uint32_t bin_y = tri.min_y / BIN_SIZE; bin_y <= tri.max_y / BIN_SIZE; ++bin_y)
+            {
+                for (uint32_t bin_x = tri.min_x / BIN_SIZE; bin_x <= tri.max_x / BIN_SIZE;
+                     ++bin_x)
+                {
+                    m_bins[bin_y * BINS_X + bin_x].push_back(triangle_idx);
+                }
+            }
+        }
+    }
+
+    m_stats.setup_ms = elapsed_ms(begin);
+
+    begin = Clock::now();
+    m_jobs->parallel_for(m_bins.size(), [&](size_t bin_idx) { rasterize_bin(bin_idx); });
+    m_stats.raster_ms = elapsed_ms(begin);
+
+    begin = Clock::now();
+    out_visible.resize(objects.size());
+    std::atomic<uint32_t> frustum_culled{0};
+    std::atomic<uint32_t> occluded{0};
+    m_jobs->parallel_for(
+        (m_draws.size() + TEST_CHUNK_SIZE - 1) / TEST_CHUNK_SIZE,
+        [&](size_t chunk) {
+            uint32_t chunk_frustum_culled = 0;
+            uint32_t chunk_occluded = 0;
+            size_t end = std::min(m_draws.size(), (chunk + 1) * TEST_CHUNK_SIZE);
+            for (size_t i = chunk * TEST_CHUNK_SIZE; i < end; ++i)
+            {
+                const DrawItem &draw = m_draws[i];
+                const MeshDrawInfo &mesh = meshes[draw.mesh_idx];
+                BoxVisibility visibility =
+                    test_box(proj_view * draw.model, mesh.bounds_min, mesh.bounds_max);
+                out_visible[i] = visibility == BoxVisibility::Visible;
+                chunk_frustum_culled += visibility == BoxVisibility::OutsideFrustum;
+                chunk_occluded += visibility == BoxVisibility::Occluded;
+            }
+            frustum_culled += chunk_frustum_culled;
+            occluded += chunk_occluded;
+        }
+    );
+    m_stats.frustum_culled = frustum_culled;
+    m_stats.occluded = occluded;
+    m_stats.test_ms = elapsed_ms(begin);
+}
+
+float SoftwareOcclusionCuller::depth(uint32_t x, uint32_t y) const
+{
+    uint32_t tile = (y / TILE_SIZE) * TILES_X + x / TILE_SIZE;
+    return m_depth[tile * TILE_PIXELS + (y % TILE_SIZE) * TILE_SIZE + x % TILE_SIZE];
+}
+
+void SoftwareOcclusionCuller::setup_triangles(size_t occluder_idx, const glm::mat4 &proj_view)
+{
+    const DrawItem &draw = m_draws[m_occluders[occluder_idx]];
+    const MeshGeometry &mesh = m_meshes[draw.mesh_idx];
+    glm::mat4 clip_from_object = proj_view * draw.model;
+
+    Triangle *out = m_triangles.data() + m_triangle_offsets[occluder_idx];
+    uint32_t count = 0;
+    uint32_t end = draw.first_index + draw.index_count / 3 * 3;
+    for (uint32_t i = draw.first_index; i < end; i += 3)
+    {
+        std::array<glm::vec4, 3> clip;
+        for (uint32_t j = 0; j < 3; ++j)
+        {
+            clip[j] = clip_from_object * glm::vec4(mesh.positions[mesh.indices[i + j]], 1.0f);
+        }
+        count += clip_and_setup_triangle(clip, out + count);
+    }
+    m_triangle_counts[occluder_idx] = count;
+}
+
+void SoftwareOcclusionCuller::rasterize_bin(size_t bin_idx)
+{
+    uint32_t first_tile_x = static_cast<uint32_t>(bin_idx % BINS_X) * BIN_TILES;
+    uint32_t first_tile_y = static_cast<uint32_t>(bin_idx / BINS_X) * BIN_TILES;
+    uint32_t last_tile_x = first_tile_x + BIN_TILES - 1;
+    uint32_t last_tile_y = first_tile_y + BIN_TILES - 1;
+
+    for (uint32_t tile_y = first_tile_y; tile_y <= last_tile_y; ++tile_y)
+    {
+        for (uint32_t tile_x = first_tile_x; tile_x <= last_tile_x; ++tile_x)
+        {
+            uint32_t tile = tile_y * TILES_X + tile_x;
+            std::fill_n(m_depth.begin() + tile * TILE_PIXELS, TILE_PIXELS, 1.0f);
+            m_tile_max_depth[tile] = 1.0f;
+        }
+    }
+
+    for (uint32_t triangle_idx : m_bins[bin_idx])
+    {
+        const Triangle &tri = m_triangles[triangle_idx];
+        uint32_t begin_x = std::max(first_tile_x, tri.min_x / TILE_SIZE);
+        uint32_t begin_y = std::max(first_tile_y, tri.min_y / TILE_SIZE);
+        uint32_t end_x = std::min(last_tile_x, tri.max_x / TILE_SIZE);
+        uint32_t end_y = std::min(last_tile_y, tri.max_y / TILE_SIZE);
+        for (uint32_t tile_y = begin_y; tile_y <= end_y; ++tile_y)
+        {
+            uint32_t y = tile_y * TILE_SIZE;
+            uint32_t row_begin = std::max<uint32_t>(tri.min_y, y) - y;
+            uint32_t row_end = std::min<uint32_t>(tri.max_y, y + TILE_SIZE - 1) - y;
+            for (uint32_t tile_x = begin_x; tile_x <= end_x; ++tile_x)
+            {
+                uint32_t tile = tile_y * TILES_X + tile_x;
+                // Nothing of the triangle is closer than what the tile already holds.
+                if (tri.min_depth >= m_tile_max_depth[tile])
+                {
+                    continue;
+                }
+
+                uint32_t x = tile_x * TILE_SIZE;
+                float *depth = m_depth.data() + tile * TILE_PIXELS;
+#ifdef ARCTIC_SOFTWARE_OCCLUSION_AVX2
+                if (m_use_avx2)
+                {
+                    m_tile_max_depth[tile] =
+                        rasterize_tile_avx2(tri, x, y, row_begin, row_end, depth);
+                    continue;
+                }
+#endif
+                m_tile_max_depth[tile] =
+                    rasterize_tile_scalar(tri, x, y, row_begin, row_end, depth);
+            }
+        }
+    }
+}
+
+SoftwareOcclusionCuller::BoxVisibility SoftwareOcclusionCuller::test_box(
+    const glm::mat4 &clip_from_object, const glm::vec3 &bounds_min, const glm::vec3 &bounds_max
+) const
+{
+    // Bits of the frustum planes every corner is outside of.
+    uint32_t outside_all = 0x3f;
+    bool crosses_near = false;
+    glm::vec2 ndc_min(std::numeric_limits<float>::max());
+    glm::vec2 ndc_max(std::numeric_limits<float>::lowest());
+    float min_depth = std::numeric_limits<float>::max();
+    for (uint32_t i = 0; i < 8; ++i)
+    {
+        glm::vec3 corner(
+            (i & 1) != 0 ? bounds_max.x : bounds_min.x,
+            (i & 2) != 0 ? bounds_max.y : bounds_min.y,
+            (i & 4) != 0 ? bounds_max.z : bounds_min.z
+        );
+        glm::vec4 clip = clip_from_object * glm::vec4(corner, 1.0f);
+        uint32_t outside = (clip.x < -clip.w ? 1u : 0u) | (clip.x > clip.w ? 2u : 0u) |
+                           (clip.y < -clip.w ? 4u : 0u) | (clip.y > clip.w ? 8u : 0u) |
+                           (clip.z < 0.0f ? 16u : 0u) | (clip.z > clip.w ? 32u : 0u);
+        outside_all &= outside;
+        if (clip.z < 0.0f)
+        {
+            crosses_near = true;
+            continue;
+        }
+
+        glm::vec3 ndc = glm::vec3(clip) / clip.w;
+        ndc_min = glm::min(ndc_min, glm::vec2(ndc));
+        ndc_max = glm::max(ndc_max, glm::vec2(ndc));
+        min_depth = std::min(min_depth, ndc.z);
+    }
+
+    if (outside_all != 0)
+    {
+        return BoxVisibility::OutsideFrustum;
+    }
+    // Boxes reaching in front of the near plane are always drawn.
+    if (crosses_near)
+    {
+        return BoxVisibility::Visible;
+    }
+
+    // Every pixel the rectangle touches, even partially, has to be hidden.
+    auto to_pixel = [](float value, float extent) {
+        return static_cast<uint32_t>(std::clamp(std::floor(value), 0.0f, extent - 1.0f));
+    };
+    uint32_t min_x = to_pixel((ndc_min.x * 0.5f + 0.5f) * WIDTH, WIDTH);
+    uint32_t max_x = to_pixel((ndc_max.x * 0.5f + 0.5f) * WIDTH, WIDTH);
+    uint32_t min_y = to_pixel((0.5f - ndc_max.y * 0.5f) * HEIGHT, HEIGHT);
+    uint32_t max_y = to_pixel((0.5f - ndc_min.y * 0.5f) * HEIGHT, HEIGHT);
+
+    for (uint32_t tile_y = min_y / TILE_SIZE; tile_y <= max_y / TILE_SIZE; ++tile_y)
+    {
+        uint32_t y = tile_y * TILE_SIZE;
+        uint32_t row_begin = std::max(min_y, y) - y;
+        uint32_t row_end = std::min(max_y, y + TILE_SIZE - 1) - y;
+        for (uint32_t tile_x = min_x / TILE_SIZE; tile_x <= max_x / TILE_SIZE; ++tile_x)
+        {
+            uint32_t tile = tile_y * TILES_X + tile_x;
+            if (m_tile_max_depth[tile] < min_depth)
+            {
+                continue;
+            }
+
+            uint32_t x = tile_x * TILE_SIZE;
+            uint32_t x_begin = std::max(min_x, x) - x;
+            uint32_t x_end = std::min(max_x, x + TILE_SIZE - 1) - x;
+            const float *depth = m_depth.data() + tile * TILE_PIXELS;
+            bool occludes;
+#ifdef ARCTIC_SOFTWARE_OCCLUSION_AVX2
+            if (m_use_avx2)
+            {
+                occludes =
+                    tile_occludes_avx2(depth, x_begin, x_end, row_begin, row_end, min_depth);
+            }
+            else
+#endif
+            {
+                occludes =
+                    tile_occludes_scalar(depth, x_begin, x_end, row_begin, row_end, min_depth);
+            }
+            if (!occludes)
+            {
+                return BoxVisibility::Visible;
+            }
+        }
+    }
+    return BoxVisibility::Occluded;
+}
+
+} // namespace Arctic::Renderer
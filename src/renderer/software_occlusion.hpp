@@ -0,0 +1,171 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+
+#include "../job_system.hpp"
+#include "draw_list.hpp"
+#include "scene.hpp"
+
+namespace Arctic::Renderer
+{
+
+// Size of the software depth buffer. It covers the whole view regardless of its aspect ratio.
+static constexpr uint32_t SOFTWARE_OCCLUSION_WIDTH = 320;
+static constexpr uint32_t SOFTWARE_OCCLUSION_HEIGHT = 192;
+// Pixels are stored in tiles of 8x8, one row of a tile fills one AVX2 register.
+static constexpr uint32_t SOFTWARE_OCCLUSION_TILE_SIZE = 8;
+// Tiles are rasterized in bins of 4x4 tiles, one bin per job.
+static constexpr uint32_t SOFTWARE_OCCLUSION_BIN_TILES = 4;
+
+// Objects whose bounding sphere is smaller than this many pixels of the software depth buffer
+// hide too little to be worth rasterizing.
+static constexpr float SOFTWARE_OCCLUSION_MIN_OCCLUDER_PIXELS = 8.0f;
+
+struct SoftwareOcclusionStats
+{
+    uint32_t object_count{0};
+    uint32_t occluder_count{0};
+    // Triangles left after clipping and backface culling.
+    uint32_t triangle_count{0};
+    uint32_t frustum_culled{0};
+    uint32_t occluded{0};
+    // Wall clock time of the steps of the last call to `cull`.
+    float setup_ms{0.0f};
+    float raster_ms{0.0f};
+    float test_ms{0.0f};
+};
+
+// Occlusion culling on the CPU, without waiting for anything from the GPU. Large objects are
+// rasterized into a small depth buffer and the bounding boxes of all objects are tested against
+// it before the draw list is built.
+//
+// Both sides are conservative: occluders are rasterized at their most detailed level, since
+// coarser ones may stick out of the real surface, and only write pixels they cover completely,
+// with the farthest depth of the triangle within the pixel. An object is only culled if every pixel
+// its screen rectangle touches is closer than the nearest corner of its bounding box. Triangle
+// setup, rasterization and testing are split across the job system. Rasterization and testing
+// use AVX2 where available.
+class SoftwareOcclusionCuller
+{
+  public:
+    static constexpr uint32_t TILES_X = SOFTWARE_OCCLUSION_WIDTH / SOFTWARE_OCCLUSION_TILE_SIZE;
+    static constexpr uint32_t TILES_Y = SOFTWARE_OCCLUSION_HEIGHT / SOFTWARE_OCCLUSION_TILE_SIZE;
+    static constexpr uint32_t BINS_X = TILES_X / SOFTWARE_OCCLUSION_BIN_TILES;
+    static constexpr uint32_t BINS_Y = TILES_Y / SOFTWARE_OCCLUSION_BIN_TILES;
+
+    static_assert(TILES_X % SOFTWARE_OCCLUSION_BIN_TILES == 0);
+    static_assert(TILES_Y % SOFTWARE_OCCLUSION_BIN_TILES == 0);
+
+    // A triangle in screen space, ready to be rasterized. The edge functions are biased so that
+    // they are positive at the center of a pixel only if the triangle covers the whole pixel,
+    // and the depth plane so that it gives the farthest depth of the triangle within the pixel.
+    struct Triangle
+    {
+        float edge_a[3];
+        float edge_b[3];
+        float edge_c[3];
+        float depth_a;
+        float depth_b;
+        float depth_c;
+        float min_depth;
+        // Inclusive pixel rectangle, already clamped to the depth buffer.
+        uint16_t min_x;
+        uint16_t min_y;
+        uint16_t max_x;
+        uint16_t max_y;
+    };
+
+  private:
+    enum class BoxVisibility
+    {
+        Visible,
+        OutsideFrustum,
+        Occluded,
+    };
+
+    // CPU copy of the geometry of a mesh, indexed by `MeshIdx` like `MeshDrawInfo`.
+    struct MeshGeometry
+    {
+        std::vector<glm::vec3> positions;
+        // All levels of detail, with the same ranges as `MeshDrawInfo::lods`.
+        std::vector<uint32_t> indices;
+    };
+
+    JobSystem *m_jobs;
+    bool m_use_avx2;
+
+    std::vector<MeshGeometry> m_meshes;
+
+    std::vector<DrawItem> m_draws;
+    std::vector<uint32_t> m_occluders;
+    // Every occluder sets up its triangles in its own range of `m_triangles`.
+    std::vector<size_t> m_triangle_offsets;
+    std::vector<uint32_t> m_triangle_counts;
+    std::vector<Triangle> m_triangles;
+    // Triangles overlapping each bin, in the front to back order of their occluders.
+    std::vector<std::vector<uint32_t>> m_bins;
+
+    // Tile after tile, rows of each tile after one another.
+    std::vector<float> m_depth;
+    std::vector<float> m_tile_max_depth;
+
+    SoftwareOcclusionStats m_stats;
+
+    SoftwareOcclusionCuller(const SoftwareOcclusionCuller &) = delete;
+    SoftwareOcclusionCuller &operator=(const SoftwareOcclusionCuller &) = delete;
+    SoftwareOcclusionCuller(SoftwareOcclusionCuller &&) = delete;
+    SoftwareOcclusionCuller &operator=(SoftwareOcclusionCuller &&) = delete;
+
+  public:
+    explicit SoftwareOcclusionCuller(JobSystem *jobs);
+
+    [[nodiscard]] static bool avx2_supported();
+
+    // Falls back to the scalar reference, which produces identical results. AVX2 is only used
+    // if the CPU supports it.
+    void set_use_avx2(bool use_avx2)
+    {
+        m_use_avx2 = use_avx2 && avx2_supported();
+    }
+
+    [[nodiscard]] bool uses_avx2() const
+    {
+        return m_use_avx2;
+    }
+
+    // Meshes have to be added in the order of their `MeshIdx`. `indices` holds all levels of
+    // detail of the mesh.
+    void add_mesh(std::span<const Vertex> vertices, std::span<const uint32_t> indices);
+
+    // Rasterizes the occluders among `objects` and tests all of them. `out_visible` receives one
+    // entry per object, zero for the ones that are outside the view or hidden.
+    void cull(
+        std::span<const Object> objects, std::span<const MeshDrawInfo> meshes,
+        const Camera &camera, std::vector<uint8_t> &out_visible
+    );
+
+    [[nodiscard]] const SoftwareOcclusionStats &stats() const
+    {
+        return m_stats;
+    }
+
+    // Depth of the pixel at `x`, `y` after the last call to `cull`.
+    [[nodiscard]] float depth(uint32_t x, uint32_t y) const;
+
+  private:
+    void setup_triangles(size_t occluder_idx, const glm::mat4 &proj_view);
+
+    void rasterize_bin(size_t bin_idx);
+
+    [[nodiscard]] BoxVisibility test_box(
+        const glm::mat4 &clip_from_object, const glm::vec3 &bounds_min,
+        const glm::vec3 &bounds_max
+    ) const;
+};
+
+} // namespace Arctic::Renderer
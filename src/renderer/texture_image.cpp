@@ -0,0 +1,171 @@
+#include "texture_image.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace Arctic::Renderer
+{
+
+bool is_block_compressed(TextureFormat format)
+{
+    switch (format)
+    {
+        case TextureFormat::BC1Unorm:
+        case TextureFormat::BC1UnormSrgb:
+        case TextureFormat::BC3Unorm:
+        case TextureFormat::BC3UnormSrgb:
+        case TextureFormat::BC4Unorm:
+        case TextureFormat::BC5Unorm:
+            return true;
+        default:
+            return false;
+    }
+}
+
+uint32_t format_element_size(TextureFormat format)
+{
+    switch (format)
+    {
+        case TextureFormat::R8G8B8A8Unorm:
+        case TextureFormat::R8G8B8A8UnormSrgb:
+            return 4;
+        case TextureFormat::BC1Unorm:
+        case TextureFormat::BC1UnormSrgb:
+        case TextureFormat::BC4Unorm:
+            return 8;
+        case TextureFormat::BC3Unorm:
+        case TextureFormat::BC3UnormSrgb:
+        case TextureFormat::BC5Unorm:
+            return 16;
+        case TextureFormat::Unknown:
+            break;
+    }
+    return 0;
+}
+
+const char *texture_format_name(TextureFormat format)
+{
+    switch (format)
+    {
+        case TextureFormat::R8G8B8A8Unorm:
+            return "R8G8B8A8_UNORM";
+        case TextureFormat::R8G8B8A8UnormSrgb:
+            return "R8G8B8A8_UNORM_SRGB";
+        case TextureFormat::BC1Unorm:
+            return "BC1_UNORM";
+        case TextureFormat::BC1UnormSrgb:
+            return "BC1_UNORM_SRGB";
+        case TextureFormat::BC3Unorm:
+            return "BC3_UNORM";
+        case TextureFormat::BC3UnormSrgb:
+            return "BC3_UNORM_SRGB";
+        case TextureFormat::BC4Unorm:
+            return "BC4_UNORM";
+        case TextureFormat::BC5Unorm:
+            return "BC5_UNORM";
+        case TextureFormat::Unknown:
+            break;
+    }
+    return "UNKNOWN";
+}
+
+bool is_srgb(TextureFormat format)
+{
+    switch (format)
+    {
+        case TextureFormat::R8G8B8A8UnormSrgb:
+        case TextureFormat::BC1UnormSrgb:
+        case TextureFormat::BC3UnormSrgb:
+            return true;
+        default:
+            return false;
+    }
+}
+
+TextureFormat format_in_color_space(TextureFormat format, MipColorSpace color_space)
+{
+    bool srgb = color_space == MipColorSpace::Srgb;
+    switch (format)
+    {
+        case TextureFormat::R8G8B8A8Unorm:
+        case TextureFormat::R8G8B8A8UnormSrgb:
+            return srgb ? TextureFormat::R8G8B8A8UnormSrgb : TextureFormat::R8G8B8A8Unorm;
+        case TextureFormat::BC1Unorm:
+        case TextureFormat::BC1UnormSrgb:
+            return srgb ? TextureFormat::BC1UnormSrgb : TextureFormat::BC1Unorm;
+        case TextureFormat::BC3Unorm:
+        case TextureFormat::BC3UnormSrgb:
+            return srgb ? TextureFormat::BC3UnormSrgb : TextureFormat::BC3Unorm;
+        default:
+            return format;
+    }
+}
+
+uint64_t compute_texture_levels(
+    TextureFormat format, uint32_t width, uint32_t height, uint32_t mip_levels,
+    uint64_t base_offset, std::vector<TextureLevel> &out_levels
+)
+{
+    out_levels.clear();
+
+    bool compressed = is_block_compressed(format);
+    uint32_t element_size = format_element_size(format);
+    uint64_t offset = base_offset;
+    for (uint32_t level = 0; level < mip_levels; ++level)
+    {
+        uint32_t level_width = std::max(1u, width >> level);
+        uint32_t level_height = std::max(1u, height >> level);
+        uint32_t columns = compressed ? (level_width + 3) / 4 : level_width;
+        uint32_t rows = compressed ? (level_height + 3) / 4 : level_height;
+
+        TextureLevel texture_level{
+            .width = level_width,
+            .height = level_height,
+            .offset = offset,
+            .row_pitch = columns * element_size,
+            .size = uint64_t{columns} * element_size * rows,
+        };
+        offset += texture_level.size;
+        out_levels.emplace_back(texture_level);
+    }
+    return offset - base_offset;
+}
+
+void allocate_texture_image(
+    TextureFormat format, uint32_t width, uint32_t height, uint32_t mip_levels,
+    TextureImage &out_image
+)
+{
+    out_image.format = format;
+    out_image.width = width;
+    out_image.height = height;
+    out_image.file = nullptr;
+    out_image.data.resize(
+        compute_texture_levels(format, width, height, mip_levels, 0, out_image.levels)
+    );
+}
+
+void texture_image_from_mip_chain(
+    MipChain &&chain, MipColorSpace color_space, TextureImage &out_image
+)
+{
+    out_image.format = color_space == MipColorSpace::Srgb ? TextureFormat::R8G8B8A8UnormSrgb
+                                                          : TextureFormat::R8G8B8A8Unorm;
+    out_image.width = chain.levels[0].width;
+    out_image.height = chain.levels[0].height;
+    out_image.levels.clear();
+    for (const MipLevel &mip : chain.levels)
+    {
+        out_image.levels.emplace_back(TextureLevel{
+            .width = mip.width,
+            .height = mip.height,
+            .offset = mip.offset,
+            .row_pitch = 4 * mip.width,
+            .size = 4ull * mip.width * mip.height,
+        });
+    }
+    out_image.data = std::move(chain.data);
+    out_image.file = nullptr;
+}
+
+} // namespace Arctic::Renderer
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+#include "../mapped_file.hpp"
+#include "mip_chain.hpp"
+
+namespace Arctic::Renderer
+{
+
+// Mirrors the values of DXGI_FORMAT so images can be loaded and compressed without including
+// any D3D12 headers, while still converting to native formats with a plain cast.
+enum class TextureFormat : uint32_t
+{
+    Unknown = 0,
+    R8G8B8A8Unorm = 28,
+    R8G8B8A8UnormSrgb = 29,
+    BC1Unorm = 71,
+    BC1UnormSrgb = 72,
+    BC3Unorm = 77,
+    BC3UnormSrgb = 78,
+    BC4Unorm = 80,
+    BC5Unorm = 83,
+};
+
+[[nodiscard]] bool is_block_compressed(TextureFormat format);
+
+// Size of a 4x4 block for block compressed formats, size of a texel otherwise.
+[[nodiscard]] uint32_t format_element_size(TextureFormat format);
+
+[[nodiscard]] const char *texture_format_name(TextureFormat format);
+
+// Whether sampling the format decodes its texels from sRGB.
+[[nodiscard]] bool is_srgb(TextureFormat format);
+
+// The variant of `format` that stores texels in `color_space`. Formats without an sRGB variant
+// are returned as they are.
+[[nodiscard]] TextureFormat format_in_color_space(TextureFormat format, MipColorSpace color_space);
+
+struct TextureLevel
+{
+    uint32_t width;
+    uint32_t height;
+    // Byte offset of the level in `TextureImage::data`, or in the mapped file.
+    uint64_t offset;
+    // Bytes per row of texels, or per row of blocks for block compressed formats.
+    uint32_t row_pitch;
+    uint64_t size;
+};
+
+// A texture with all of its mip levels tightly packed in the layout they are stored in on disk.
+struct TextureImage
+{
+    TextureFormat format{TextureFormat::Unknown};
+    uint32_t width{0};
+    uint32_t height{0};
+    std::vector<TextureLevel> levels;
+    // Texel data owned by the image. Empty for images that are backed by `file`.
+    std::vector<uint8_t> data;
+    // Set for images loaded from a container file, whose levels are read straight from the file
+    // mapping. Level offsets are relative to the start of the file then.
+    std::shared_ptr<const MappedFile> file;
+
+    [[nodiscard]] std::span<const uint8_t> level_data(size_t level) const
+    {
+        std::span<const uint8_t> bytes = file ? file->bytes() : std::span<const uint8_t>(data);
+        return bytes.subspan(levels[level].offset, levels[level].size);
+    }
+};
+
+// Computes the layout of `mip_levels` tightly packed levels of a texture, starting at
+// `base_offset`. Returns the total size of all levels.
+uint64_t compute_texture_levels(
+    TextureFormat format, uint32_t width, uint32_t height, uint32_t mip_levels,
+    uint64_t base_offset, std::vector<TextureLevel> &out_levels
+);
+
+// Computes the layout of `mip_levels` levels of a texture and resizes `data` to fit them.
+void allocate_texture_image(
+    TextureFormat format, uint32_t width, uint32_t height, uint32_t mip_levels,
+    TextureImage &out_image
+);
+
+// Wraps a mip chain as an uncompressed image, in the sRGB format if `color_space` is sRGB.
+void texture_image_from_mip_chain(
+    MipChain &&chain, MipColorSpace color_space, TextureImage &out_image
+);
+
+} // namespace Arctic::Renderer
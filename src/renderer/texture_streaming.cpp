@@ -0,0 +1,300 @@
+#include "texture_streaming.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <glm/geometric.hpp>
+#include <glm/trigonometric.hpp>
+#include <glm/vec4.hpp>
+
+namespace Arctic::Renderer
+{
+
+void compute_material_screen_sizes(
+    std::span<const DrawItem> draws, std::span<const MeshDrawInfo> meshes, const Camera &camera,
+    uint32_t viewport_height, size_t material_count, std::vector<float> &out_sizes
+)
+{
+    out_sizes.assign(material_count, 0.0f);
+
+    // Pixels per unit of size at a distance of one unit from the camera.
+    float pixels_per_unit =
+        static_cast<float>(viewport_height) / (2.0f * std::tan(glm::radians(camera.fov_y) / 2.0f));
+
+    for (const DrawItem &draw : draws)
+    {
+        const MeshDrawInfo &mesh = meshes[draw.mesh_idx];
+        glm::vec3 center = glm::vec3(draw.model * glm::vec4(mesh.bounds_center, 1.0f));
+        float scale = std::max(
+            {glm::length(glm::vec3(draw.model[0])),
+             glm::length(glm::vec3(draw.model[1])),
+             glm::length(glm::vec3(draw.model[2]))}
+        );
+        float radius = mesh.bounds_radius * scale;
+
+        float distance = glm::length(center - camera.eye);
+        float size = distance > radius ? pixels_per_unit * 2.0f * radius / distance
+                                       : std::numeric_limits<float>::max();
+        out_sizes[draw.material_idx] = std::max(out_sizes[draw.material_idx], size);
+    }
+}
+
+uint32_t required_mip(uint32_t size, float screen_size, uint32_t mip_count)
+{
+    if (screen_size <= 1.0f)
+    {
+        return mip_count - 1;
+    }
+    float mip = std::floor(std::log2(static_cast<float>(size) / screen_size));
+    return static_cast<uint32_t>(std::clamp(mip, 0.0f, static_cast<float>(mip_count - 1)));
+}
+
+uint32_t TextureStreamingPolicy::add_texture(
+    uint32_t width, uint32_t height, std::span<const uint64_t> level_sizes, uint32_t block_size
+)
+{
+    uint32_t mip_count = static_cast<uint32_t>(level_sizes.size());
+    auto is_aligned = [&](uint32_t mip) {
+        return std::max(width >> mip, 1u) % block_size == 0 &&
+               std::max(height >> mip, 1u) % block_size == 0;
+    };
+    // Deepest level down to which every level can be the most detailed one of a copy, e.g. a
+    // 1000x1000 block compressed texture can not start at its 125x125 level.
+    uint32_t max_first_mip = 0;
+    while (max_first_mip + 1 < mip_count && is_aligned(max_first_mip + 1))
+    {
+        ++max_first_mip;
+    }
+
+    uint32_t tail_mip = 0;
+    while (tail_mip < max_first_mip &&
+           std::max(width >> tail_mip, height >> tail_mip) > m_config.resident_tail_size)
+    {
+        ++tail_mip;
+    }
+
+    m_textures.emplace_back(Texture{
+        .level_sizes = std::vector(level_sizes.begin(), level_sizes.end()),
+        .tail_mip = tail_mip,
+        .resident_mip = tail_mip,
+        .target_mip = tail_mip,
+        .requested_mip = tail_mip,
+        .wanted_mip = tail_mip,
+        .last_used_frame = 0,
+        .retired_bytes = {},
+    });
+    return static_cast<uint32_t>(m_textures.size() - 1);
+}
+
+void TextureStreamingPolicy::request(uint32_t texture, uint32_t mip)
+{
+    Texture &tex = m_textures[texture];
+    tex.requested_mip = std::min(tex.requested_mip, mip);
+}
+
+void TextureStreamingPolicy::update(std::vector<StreamingRequest> &out_requests)
+{
+    ++m_frame;
+
+    uint32_t in_flight = 0;
+    uint64_t committed = 0;
+    // Memory that in flight requests and replaced copies are going to give back.
+    uint64_t freeing = 0;
+    std::vector<uint32_t> loads;
+    std::vector<uint32_t> unused;
+    for (uint32_t i = 0; i < m_textures.size(); ++i)
+    {
+        Texture &tex = m_textures[i];
+        tex.wanted_mip = tex.requested_mip;
+        tex.requested_mip = tex.tail_mip;
+        if (tex.wanted_mip <= tex.resident_mip)
+        {
+            tex.last_used_frame = m_frame;
+        }
+
+        committed += committed_bytes(tex);
+        freeing += freeing_bytes(tex);
+        if (tex.target_mip != tex.resident_mip)
+        {
+            ++in_flight;
+        }
+        else if (tex.wanted_mip < tex.resident_mip)
+        {
+            loads.emplace_back(i);
+        }
+        else if (tex.wanted_mip > tex.resident_mip)
+        {
+            unused.emplace_back(i);
+        }
+    }
+
+    std::sort(loads.begin(), loads.end(), [&](uint32_t a, uint32_t b) {
+        uint32_t missing_a = m_textures[a].resident_mip - m_textures[a].wanted_mip;
+        uint32_t missing_b = m_textures[b].resident_mip - m_textures[b].wanted_mip;
+        return missing_a != missing_b ? missing_a > missing_b : a < b;
+    });
+    std::sort(unused.begin(), unused.end(), [&](uint32_t a, uint32_t b) {
+        uint64_t used_a = m_textures[a].last_used_frame;
+        uint64_t used_b = m_textures[b].last_used_frame;
+        return used_a != used_b ? used_a < used_b : a < b;
+    });
+
+    // The new copy is allocated right away, the old one is given back once it is released.
+    auto issue = [&](uint32_t texture, uint32_t mip) {
+        Texture &tex = m_textures[texture];
+        committed += bytes_from(tex, mip);
+        freeing += bytes_from(tex, tex.resident_mip);
+        tex.target_mip = mip;
+        ++in_flight;
+        out_requests.emplace_back(StreamingRequest{.texture = texture, .mip = mip});
+    };
+
+    // Unused levels are evicted all at once, down to what is still wanted.
+    size_t next_unused = 0;
+    auto evict_unused = [&] {
+        uint32_t texture = unused[next_unused++];
+        issue(texture, m_textures[texture].wanted_mip);
+    };
+
+    // Get back under the budget if it shrank, giving up wanted levels of the textures with the
+    // largest resident levels once no unused ones are left. Evictions briefly need memory for the
+    // smaller copy too, which can not be avoided when already over the budget.
+    while (committed - freeing > m_config.budget && in_flight < m_config.max_requests_in_flight)
+    {
+        if (next_unused < unused.size())
+        {
+            evict_unused();
+            continue;
+        }
+
+        uint32_t victim = std::numeric_limits<uint32_t>::max();
+        for (uint32_t i = 0; i < m_textures.size(); ++i)
+        {
+            const Texture &tex = m_textures[i];
+            if (tex.target_mip == tex.resident_mip && tex.resident_mip < tex.tail_mip &&
+                (victim == std::numeric_limits<uint32_t>::max() ||
+                 tex.level_sizes[tex.resident_mip] >
+                     m_textures[victim].level_sizes[m_textures[victim].resident_mip]))
+            {
+                victim = i;
+            }
+        }
+        if (victim == std::numeric_limits<uint32_t>::max())
+        {
+            break;
+        }
+        issue(victim, m_textures[victim].resident_mip + 1);
+    }
+
+    for (uint32_t texture : loads)
+    {
+        if (in_flight >= m_config.max_requests_in_flight)
+        {
+            break;
+        }
+
+        // The new copy holds every level down to the tail, next to the old one.
+        const Texture &tex = m_textures[texture];
+        uint64_t cost = bytes_from(tex, tex.resident_mip - 1);
+        if (committed + cost <= m_config.budget)
+        {
+            issue(texture, tex.resident_mip - 1);
+            continue;
+        }
+
+        // Make room for the load, which is issued in a later frame once the evictions are
+        // complete and the replaced copies are released. Loads with a lower priority have to
+        // wait for it.
+        while (committed - freeing + cost > m_config.budget && next_unused < unused.size() &&
+               in_flight < m_config.max_requests_in_flight)
+        {
+            // The smaller copy of an eviction needs memory as well, wait for the memory that is
+            // being given back if that makes it fit.
+            const Texture &victim = m_textures[unused[next_unused]];
+            uint64_t eviction_cost = bytes_from(victim, victim.wanted_mip);
+            if (committed + eviction_cost > m_config.budget &&
+                committed - freeing + eviction_cost <= m_config.budget)
+            {
+                break;
+            }
+            evict_unused();
+        }
+        break;
+    }
+}
+
+void TextureStreamingPolicy::complete(uint32_t texture)
+{
+    Texture &tex = m_textures[texture];
+    if (tex.target_mip != tex.resident_mip)
+    {
+        tex.retired_bytes.emplace_back(bytes_from(tex, tex.resident_mip));
+    }
+    tex.resident_mip = tex.target_mip;
+}
+
+void TextureStreamingPolicy::release(uint32_t texture)
+{
+    std::vector<uint64_t> &retired_bytes = m_textures[texture].retired_bytes;
+    if (!retired_bytes.empty())
+    {
+        retired_bytes.erase(retired_bytes.begin());
+    }
+}
+
+TextureStreamingStats TextureStreamingPolicy::stats() const
+{
+    TextureStreamingStats stats{.budget = m_config.budget};
+    for (const Texture &tex : m_textures)
+    {
+        stats.resident_bytes += bytes_from(tex, tex.resident_mip);
+        stats.allocated_bytes += committed_bytes(tex);
+        stats.wanted_bytes += bytes_from(tex, tex.wanted_mip);
+        if (tex.target_mip != tex.resident_mip)
+        {
+            ++stats.requests_in_flight;
+        }
+    }
+    return stats;
+}
+
+uint64_t TextureStreamingPolicy::bytes_from(const Texture &texture, uint32_t mip) const
+{
+    uint64_t bytes = 0;
+    for (size_t level = mip; level < texture.level_sizes.size(); ++level)
+    {
+        bytes += texture.level_sizes[level];
+    }
+    return bytes;
+}
+
+uint64_t TextureStreamingPolicy::committed_bytes(const Texture &texture) const
+{
+    uint64_t bytes = bytes_from(texture, texture.resident_mip);
+    if (texture.target_mip != texture.resident_mip)
+    {
+        bytes += bytes_from(texture, texture.target_mip);
+    }
+    for (uint64_t retired : texture.retired_bytes)
+    {
+        bytes += retired;
+    }
+    return bytes;
+}
+
+uint64_t TextureStreamingPolicy::freeing_bytes(const Texture &texture) const
+{
+    uint64_t bytes = 0;
+    if (texture.target_mip != texture.resident_mip)
+    {
+        bytes += bytes_from(texture, texture.resident_mip);
+    }
+    for (uint64_t retired : texture.retired_bytes)
+    {
+        bytes += retired;
+    }
+    return bytes;
+}
+
+} // namespace Arctic::Renderer
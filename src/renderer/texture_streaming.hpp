@@ -0,0 +1,150 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "draw_list.hpp"
+#include "scene.hpp"
+
+namespace Arctic::Renderer
+{
+
+// Approximate size in pixels every material covers on screen, the largest over all draws using
+// it. Objects are approximated by the bounding spheres of their meshes. Materials that are not
+// drawn get a size of 0.
+void compute_material_screen_sizes(
+    std::span<const DrawItem> draws, std::span<const MeshDrawInfo> meshes, const Camera &camera,
+    uint32_t viewport_height, size_t material_count, std::vector<float> &out_sizes
+);
+
+// Most detailed mip level of a texture that is still needed when its larger side, `size` texels,
+// covers `screen_size` pixels, assuming the texture is mapped once across the object.
+[[nodiscard]] uint32_t required_mip(uint32_t size, float screen_size, uint32_t mip_count);
+
+struct TextureStreamingConfig
+{
+    // Upper limit for the bytes of all streamed textures, including the levels that are always
+    // resident, textures that are being loaded and replaced textures that are not released yet.
+    uint64_t budget;
+    // Mip levels whose larger side is at most this many texels are loaded up front and are never
+    // evicted.
+    uint32_t resident_tail_size{128};
+    // Upper limit for textures that are changing their residency at the same time.
+    uint32_t max_requests_in_flight{8};
+};
+
+// Changes the most detailed resident mip level of a texture to `mip`. Lower values load more
+// detailed levels, higher values evict them.
+struct StreamingRequest
+{
+    uint32_t texture;
+    uint32_t mip;
+};
+
+struct TextureStreamingStats
+{
+    uint64_t budget{0};
+    uint64_t resident_bytes{0};
+    // Bytes of every texture that exists, which includes textures that are being loaded and
+    // replaced ones that frames in flight may still use.
+    uint64_t allocated_bytes{0};
+    // Bytes the budget would need to fit every level that is currently wanted.
+    uint64_t wanted_bytes{0};
+    uint32_t requests_in_flight{0};
+};
+
+// Decides which mip levels of streamed textures are resident, without touching any GPU
+// resources. Every frame the renderer requests the mip levels it needs, calls `update` and
+// carries out the returned requests, reporting back with `complete` once a texture has changed
+// its residency.
+//
+// Levels are loaded one at a time, from coarse to fine, with the textures that are furthest
+// from their wanted level first. Levels that are no longer wanted stay resident until their
+// memory is needed for loads or the budget shrinks, at which point the least recently used ones
+// are evicted first.
+//
+// Residency changes by copying a texture into a new one with a different set of levels, so while
+// a request is in flight both copies exist, and the old one stays alive after `complete` until
+// `release`. Loads are only issued if both copies fit into the budget, and evictions wait for
+// replaced copies to be released if their smaller copy does not fit yet.
+class TextureStreamingPolicy
+{
+    struct Texture
+    {
+        std::vector<uint64_t> level_sizes;
+        // First mip level that is always resident.
+        uint32_t tail_mip;
+        uint32_t resident_mip;
+        // Differs from `resident_mip` while a request for the texture is in flight.
+        uint32_t target_mip;
+        // Most detailed level requested during the current frame.
+        uint32_t requested_mip;
+        // Most detailed level requested during the previous frame.
+        uint32_t wanted_mip;
+        uint64_t last_used_frame{0};
+        // Sizes of replaced copies of the texture that are not released yet, oldest first.
+        std::vector<uint64_t> retired_bytes;
+    };
+
+    TextureStreamingConfig m_config;
+    std::vector<Texture> m_textures;
+    uint64_t m_frame{0};
+
+  public:
+    explicit TextureStreamingPolicy(const TextureStreamingConfig &config) : m_config(config)
+    {
+    }
+
+    // Registers a texture whose levels have the given sizes, starting with the most detailed one,
+    // and returns its index. Only its tail is considered resident. Levels that can become the
+    // most detailed resident level have to be a multiple of `block_size` in both dimensions,
+    // e.g. 4 for block compressed formats, which may move the tail to a more detailed level.
+    uint32_t add_texture(
+        uint32_t width, uint32_t height, std::span<const uint64_t> level_sizes,
+        uint32_t block_size = 1
+    );
+
+    [[nodiscard]] uint32_t tail_mip(uint32_t texture) const
+    {
+        return m_textures[texture].tail_mip;
+    }
+
+    [[nodiscard]] uint32_t resident_mip(uint32_t texture) const
+    {
+        return m_textures[texture].resident_mip;
+    }
+
+    void set_budget(uint64_t budget)
+    {
+        m_config.budget = budget;
+    }
+
+    // Requests `mip` and all coarser levels of a texture for the current frame. Multiple requests
+    // for the same texture keep the most detailed one.
+    void request(uint32_t texture, uint32_t mip);
+
+    // Ends the current frame and appends the residency changes to carry out to `out_requests`.
+    void update(std::vector<StreamingRequest> &out_requests);
+
+    // Marks the request for `texture` as carried out. The copy it replaces is still accounted
+    // for until `release` is called.
+    void complete(uint32_t texture);
+
+    // Marks the oldest replaced copy of `texture` as destroyed.
+    void release(uint32_t texture);
+
+    [[nodiscard]] TextureStreamingStats stats() const;
+
+  private:
+    [[nodiscard]] uint64_t bytes_from(const Texture &texture, uint32_t mip) const;
+
+    // Memory a texture is accounted for, which covers both its current and its target copy while
+    // a request is in flight, and all replaced copies that are not released yet.
+    [[nodiscard]] uint64_t committed_bytes(const Texture &texture) const;
+
+    // Part of `committed_bytes` that is going to be given back without any further requests.
+    [[nodiscard]] uint64_t freeing_bytes(const Texture &texture) const;
+};
+
+} // namespace Arctic::Renderer
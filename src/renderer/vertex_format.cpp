@@ -0,0 +1,479 @@
+#include "vertex_format.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/vec2.hpp>
+#include <glm/vec4.hpp>
+
+#include "../half_float.hpp"
+
+#if defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define ARCTIC_VERTEX_FORMAT_SSE2
+#endif
+
+namespace Arctic::Renderer
+{
+
+static constexpr float SNORM16_MAX = 32767.0f;
+static constexpr float UNORM15_MAX = 32767.0f;
+static constexpr float UNORM16_MAX = 65535.0f;
+// Keeps the projection of zero vectors finite. They end up at the center of the octahedron map,
+// which decodes to +Z.
+static constexpr float MIN_L1_NORM = 1e-20f;
+
+uint32_t vertex_position_size(VertexPositionFormat format)
+{
+    switch (format)
+    {
+        case VertexPositionFormat::Float:
+            return 3 * sizeof(float);
+        case VertexPositionFormat::Unorm16:
+            return 4 * sizeof(uint16_t);
+    }
+    return 0;
+}
+
+struct PositionBounds
+{
+    glm::vec3 min;
+    glm::vec3 extent;
+};
+
+static PositionBounds position_bounds(std::span<const Vertex> vertices)
+{
+    if (vertices.empty())
+    {
+        return PositionBounds{.min = glm::vec3(0.0f), .extent = glm::vec3(0.0f)};
+    }
+
+    glm::vec3 min(std::numeric_limits<float>::max());
+    glm::vec3 max(std::numeric_limits<float>::lowest());
+    for (const Vertex &vertex : vertices)
+    {
+        min = glm::min(min, vertex.position);
+        max = glm::max(max, vertex.position);
+    }
+    return PositionBounds{.min = min, .extent = max - min};
+}
+
+VertexPositionFormat
+choose_vertex_position_format(std::span<const Vertex> vertices, float position_tolerance)
+{
+    PositionBounds bounds = position_bounds(vertices);
+    float max_extent = std::max({bounds.extent.x, bounds.extent.y, bounds.extent.z});
+    // Rounding moves a vertex by at most half a step along every axis.
+    float max_error = 0.5f * max_extent / UNORM16_MAX * std::sqrt(3.0f);
+    return max_error <= position_tolerance ? VertexPositionFormat::Unorm16
+                                           : VertexPositionFormat::Float;
+}
+
+// Maps positions to the range of 16 bit unorms.
+struct PositionQuantization
+{
+    glm::vec3 min;
+    glm::vec3 scale;
+};
+
+static PositionQuantization prepare_compression(
+    std::span<const Vertex> vertices, VertexPositionFormat position_format,
+    CompressedVertices &out_vertices
+)
+{
+    out_vertices.position_format = position_format;
+    out_vertices.positions.assign(vertices.size() * vertex_position_size(position_format), 0);
+    out_vertices.attributes.resize(vertices.size());
+    out_vertices.position_transform = glm::mat4(1.0f);
+
+    PositionQuantization quantization{.min = glm::vec3(0.0f), .scale = glm::vec3(0.0f)};
+    if (position_format == VertexPositionFormat::Unorm16)
+    {
+        PositionBounds bounds = position_bounds(vertices);
+        for (glm::length_t i = 0; i < 3; ++i)
+        {
+            float extent = bounds.extent[i];
+            quantization.scale[i] = extent > 0.0f ? UNORM16_MAX / extent : 0.0f;
+        }
+        quantization.min = bounds.min;
+
+        // The input assembler already divides by the largest unorm value.
+        out_vertices.position_transform =
+            glm::scale(glm::translate(glm::mat4(1.0f), bounds.min), bounds.extent);
+    }
+    return quantization;
+}
+
+static int32_t round_to_int(float value)
+{
+    // Rounds to the nearest integer with ties to even, like the SSE2 conversion.
+    return static_cast<int32_t>(std::lrint(value));
+}
+
+static glm::vec2 octahedral_project(const glm::vec3 &v)
+{
+    float inv_l1 = 1.0f / std::max(std::abs(v.x) + std::abs(v.y) + std::abs(v.z), MIN_L1_NORM);
+    float x = v.x * inv_l1;
+    float y = v.y * inv_l1;
+    if (v.z < 0.0f)
+    {
+        float folded_x = (1.0f - std::abs(y)) * (x < 0.0f ? -1.0f : 1.0f);
+        float folded_y = (1.0f - std::abs(x)) * (y < 0.0f ? -1.0f : 1.0f);
+        x = folded_x;
+        y = folded_y;
+    }
+    return glm::vec2(x, y);
+}
+
+static int16_t encode_snorm16(float value)
+{
+    return static_cast<int16_t>(round_to_int(std::clamp(value, -1.0f, 1.0f) * SNORM16_MAX));
+}
+
+// Maps [-1, 1] to a 15 bit unorm.
+static uint32_t encode_unorm15(float value)
+{
+    return static_cast<uint32_t>(
+        round_to_int((std::clamp(value, -1.0f, 1.0f) + 1.0f) * (UNORM15_MAX * 0.5f))
+    );
+}
+
+static uint16_t encode_unorm16(float value, float min, float scale)
+{
+    float scaled = std::clamp((value - min) * scale, 0.0f, UNORM16_MAX);
+    return static_cast<uint16_t>(round_to_int(scaled));
+}
+
+static bool bitangent_flipped(const Vertex &vertex)
+{
+    const glm::vec3 &n = vertex.normal;
+    const glm::vec3 &t = vertex.tangent;
+    const glm::vec3 &b = vertex.bitangent;
+    float cx = n.y * t.z - n.z * t.y;
+    float cy = n.z * t.x - n.x * t.z;
+    float cz = n.x * t.y - n.y * t.x;
+    return cx * b.x + cy * b.y + cz * b.z < 0.0f;
+}
+
+static void compress_range_scalar(
+    std::span<const Vertex> vertices, size_t first, const PositionQuantization &quantization,
+    CompressedVertices &out_vertices
+)
+{
+    uint32_t position_size = vertex_position_size(out_vertices.position_format);
+    for (size_t i = first; i < vertices.size(); ++i)
+    {
+        const Vertex &vertex = vertices[i];
+        uint8_t *dst = out_vertices.positions.data() + i * position_size;
+
+        if (out_vertices.position_format == VertexPositionFormat::Float)
+        {
+            std::array<float, 3> position{vertex.position.x, vertex.position.y, vertex.position.z};
+            std::memcpy(dst, position.data(), sizeof(position));
+        }
+        else
+        {
+            std::array<uint16_t, 4> position{
+                encode_unorm16(vertex.position.x, quantization.min.x, quantization.scale.x),
+                encode_unorm16(vertex.position.y, quantization.min.y, quantization.scale.y),
+                encode_unorm16(vertex.position.z, quantization.min.z, quantization.scale.z),
+                0,
+            };
+            std::memcpy(dst, position.data(), sizeof(position));
+        }
+
+        glm::vec2 normal = octahedral_project(vertex.normal);
+        glm::vec2 tangent = octahedral_project(vertex.tangent);
+        out_vertices.attributes[i] = PackedVertexAttributes{
+            .normal = {encode_snorm16(normal.x), encode_snorm16(normal.y)},
+            .tangent = encode_unorm15(tangent.x) | (encode_unorm15(tangent.y) << 16) |
+                       (bitangent_flipped(vertex) ? 1u << 31 : 0u),
+            .tex_coords = {float_to_half(vertex.tex_coords.x), float_to_half(vertex.tex_coords.y)},
+        };
+    }
+}
+
+void compress_vertices_scalar(
+    std::span<const Vertex> vertices, VertexPositionFormat position_format,
+    CompressedVertices &out_vertices
+)
+{
+    PositionQuantization quantization =
+        prepare_compression(vertices, position_format, out_vertices);
+    compress_range_scalar(vertices, 0, quantization, out_vertices);
+}
+
+#ifdef ARCTIC_VERTEX_FORMAT_SSE2
+
+// One component of a vector attribute of four consecutive vertices.
+static __m128 load_component_sse2(
+    const Vertex *v, glm::vec3 Vertex::*attribute, glm::length_t c
+)
+{
+    return _mm_setr_ps(
+        (v[0].*attribute)[c],
+        (v[1].*attribute)[c],
+        (v[2].*attribute)[c],
+        (v[3].*attribute)[c]
+    );
+}
+
+struct Vec3Sse2
+{
+    __m128 x, y, z;
+};
+
+static Vec3Sse2 load_vec3_sse2(const Vertex *v, glm::vec3 Vertex::*attribute)
+{
+    return Vec3Sse2{
+        .x = load_component_sse2(v, attribute, 0),
+        .y = load_component_sse2(v, attribute, 1),
+        .z = load_component_sse2(v, attribute, 2),
+    };
+}
+
+static __m128 select_sse2(__m128 mask, __m128 a, __m128 b)
+{
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+// Same steps as `octahedral_project`.
+static void octahedral_project_sse2(const Vec3Sse2 &v, __m128 &out_x, __m128 &out_y)
+{
+    __m128 zero = _mm_setzero_ps();
+    __m128 one = _mm_set1_ps(1.0f);
+    __m128 sign_mask = _mm_set1_ps(-0.0f);
+
+    __m128 l1 = _mm_add_ps(
+        _mm_add_ps(_mm_andnot_ps(sign_mask, v.x), _mm_andnot_ps(sign_mask, v.y)),
+        _mm_andnot_ps(sign_mask, v.z)
+    );
+    __m128 inv_l1 = _mm_div_ps(one, _mm_max_ps(l1, _mm_set1_ps(MIN_L1_NORM)));
+    __m128 x = _mm_mul_ps(v.x, inv_l1);
+    __m128 y = _mm_mul_ps(v.y, inv_l1);
+
+    // One with the sign bit set for negative values, keeping negative zero positive.
+    __m128 sign_x = _mm_or_ps(one, _mm_and_ps(_mm_cmplt_ps(x, zero), sign_mask));
+    __m128 sign_y = _mm_or_ps(one, _mm_and_ps(_mm_cmplt_ps(y, zero), sign_mask));
+    __m128 folded_x = _mm_mul_ps(_mm_sub_ps(one, _mm_andnot_ps(sign_mask, y)), sign_x);
+    __m128 folded_y = _mm_mul_ps(_mm_sub_ps(one, _mm_andnot_ps(sign_mask, x)), sign_y);
+
+    __m128 folded = _mm_cmplt_ps(v.z, zero);
+    out_x = select_sse2(folded, folded_x, x);
+    out_y = select_sse2(folded, folded_y, y);
+}
+
+static __m128i encode_snorm16_sse2(__m128 value)
+{
+    __m128 clamped = _mm_min_ps(_mm_max_ps(value, _mm_set1_ps(-1.0f)), _mm_set1_ps(1.0f));
+    return _mm_cvtps_epi32(_mm_mul_ps(clamped, _mm_set1_ps(SNORM16_MAX)));
+}
+
+static __m128i encode_unorm15_sse2(__m128 value)
+{
+    __m128 clamped = _mm_min_ps(_mm_max_ps(value, _mm_set1_ps(-1.0f)), _mm_set1_ps(1.0f));
+    return _mm_cvtps_epi32(
+        _mm_mul_ps(_mm_add_ps(clamped, _mm_set1_ps(1.0f)), _mm_set1_ps(UNORM15_MAX * 0.5f))
+    );
+}
+
+static __m128i encode_unorm16_sse2(__m128 value, float min, float scale)
+{
+    __m128 scaled = _mm_mul_ps(_mm_sub_ps(value, _mm_set1_ps(min)), _mm_set1_ps(scale));
+    __m128 clamped = _mm_min_ps(_mm_max_ps(scaled, _mm_setzero_ps()), _mm_set1_ps(UNORM16_MAX));
+    return _mm_cvtps_epi32(clamped);
+}
+
+// Same as `bitangent_flipped`, all ones for flipped bitangents.
+static __m128 bitangent_flipped_sse2(const Vec3Sse2 &n, const Vec3Sse2 &t, const Vec3Sse2 &b)
+{
+    __m128 cx = _mm_sub_ps(_mm_mul_ps(n.y, t.z), _mm_mul_ps(n.z, t.y));
+    __m128 cy = _mm_sub_ps(_mm_mul_ps(n.z, t.x), _mm_mul_ps(n.x, t.z));
+    __m128 cz = _mm_sub_ps(_mm_mul_ps(n.x, t.y), _mm_mul_ps(n.y, t.x));
+    __m128 dot = _mm_add_ps(
+        _mm_add_ps(_mm_mul_ps(cx, b.x), _mm_mul_ps(cy, b.y)), _mm_mul_ps(cz, b.z)
+    );
+    return _mm_cmplt_ps(dot, _mm_setzero_ps());
+}
+
+// Compresses four vertices at a time. The encoded attributes are stored to arrays first and then
+// copied to the vertices.
+static void compress_vertices_sse2(
+    std::span<const Vertex> vertices, const PositionQuantization &quantization,
+    CompressedVertices &out_vertices, size_t &out_compressed
+)
+{
+    uint32_t position_size = vertex_position_size(out_vertices.position_format);
+    bool quantize = out_vertices.position_format == VertexPositionFormat::Unorm16;
+
+    size_t i = 0;
+    for (; i + 4 <= vertices.size(); i += 4)
+    {
+        const Vertex *v = vertices.data() + i;
+
+        Vec3Sse2 normal = load_vec3_sse2(v, &Vertex::normal);
+        Vec3Sse2 tangent = load_vec3_sse2(v, &Vertex::tangent);
+        Vec3Sse2 bitangent = load_vec3_sse2(v, &Vertex::bitangent);
+
+        __m128 normal_x, normal_y, tangent_x, tangent_y;
+        octahedral_project_sse2(normal, normal_x, normal_y);
+        octahedral_project_sse2(tangent, tangent_x, tangent_y);
+
+        // Normals are interleaved to x and y pairs of 16 bit values.
+        __m128i snorm_x = encode_snorm16_sse2(normal_x);
+        __m128i snorm_y = encode_snorm16_sse2(normal_y);
+        alignas(16) std::array<int16_t, 8> normals;
+        _mm_store_si128(
+            reinterpret_cast<__m128i *>(normals.data()),
+            _mm_packs_epi32(
+                _mm_unpacklo_epi32(snorm_x, snorm_y), _mm_unpackhi_epi32(snorm_x, snorm_y)
+            )
+        );
+
+        __m128i flipped = _mm_castps_si128(bitangent_flipped_sse2(normal, tangent, bitangent));
+        alignas(16) std::array<uint32_t, 4> tangents;
+        _mm_store_si128(
+            reinterpret_cast<__m128i *>(tangents.data()),
+            _mm_or_si128(
+                _mm_or_si128(
+                    encode_unorm15_sse2(tangent_x),
+                    _mm_slli_epi32(encode_unorm15_sse2(tangent_y), 16)
+                ),
+                _mm_slli_epi32(flipped, 31)
+            )
+        );
+
+        std::array<float, 8> tex_coords;
+        for (size_t j = 0; j < 4; ++j)
+        {
+            tex_coords[2 * j] = v[j].tex_coords.x;
+            tex_coords[2 * j + 1] = v[j].tex_coords.y;
+        }
+        std::array<uint16_t, 8> halves;
+        floats_to_halves(tex_coords, halves);
+
+        alignas(16) std::array<std::array<int32_t, 4>, 3> positions;
+        if (quantize)
+        {
+            Vec3Sse2 position = load_vec3_sse2(v, &Vertex::position);
+            _mm_store_si128(
+                reinterpret_cast<__m128i *>(positions[0].data()),
+                encode_unorm16_sse2(position.x, quantization.min.x, quantization.scale.x)
+            );
+            _mm_store_si128(
+                reinterpret_cast<__m128i *>(positions[1].data()),
+                encode_unorm16_sse2(position.y, quantization.min.y, quantization.scale.y)
+            );
+            _mm_store_si128(
+                reinterpret_cast<__m128i *>(positions[2].data()),
+                encode_unorm16_sse2(position.z, quantization.min.z, quantization.scale.z)
+            );
+        }
+
+        for (size_t j = 0; j < 4; ++j)
+        {
+            uint8_t *dst = out_vertices.positions.data() + (i + j) * position_size;
+            if (quantize)
+            {
+                std::array<uint16_t, 4> position{
+                    static_cast<uint16_t>(positions[0][j]),
+                    static_cast<uint16_t>(positions[1][j]),
+                    static_cast<uint16_t>(positions[2][j]),
+                    0,
+                };
+                std::memcpy(dst, position.data(), sizeof(position));
+            }
+            else
+            {
+                std::array<float, 3> position{v[j].position.x, v[j].position.y, v[j].position.z};
+                std::memcpy(dst, position.data(), sizeof(position));
+            }
+
+            out_vertices.attributes[i + j] = PackedVertexAttributes{
+                .normal = {normals[2 * j], normals[2 * j + 1]},
+                .tangent = tangents[j],
+                .tex_coords = {halves[2 * j], halves[2 * j + 1]},
+            };
+        }
+    }
+    out_compressed = i;
+}
+
+#endif
+
+void compress_vertices(
+    std::span<const Vertex> vertices, VertexPositionFormat position_format,
+    CompressedVertices &out_vertices
+)
+{
+    PositionQuantization quantization =
+        prepare_compression(vertices, position_format, out_vertices);
+
+    size_t first = 0;
+#ifdef ARCTIC_VERTEX_FORMAT_SSE2
+    compress_vertices_sse2(vertices, quantization, out_vertices, first);
+#endif
+    compress_range_scalar(vertices, first, quantization, out_vertices);
+}
+
+static glm::vec3 octahedral_decode(glm::vec2 e)
+{
+    glm::vec3 n(e.x, e.y, 1.0f - std::abs(e.x) - std::abs(e.y));
+    float t = std::max(-n.z, 0.0f);
+    n.x += n.x >= 0.0f ? -t : t;
+    n.y += n.y >= 0.0f ? -t : t;
+    return glm::normalize(n);
+}
+
+Vertex decompress_vertex(const CompressedVertices &vertices, size_t idx)
+{
+    const uint8_t *src =
+        vertices.positions.data() + idx * vertex_position_size(vertices.position_format);
+
+    Vertex vertex;
+    if (vertices.position_format == VertexPositionFormat::Float)
+    {
+        std::array<float, 3> position;
+        std::memcpy(position.data(), src, sizeof(position));
+        vertex.position = glm::vec3(position[0], position[1], position[2]);
+    }
+    else
+    {
+        std::array<uint16_t, 4> position;
+        std::memcpy(position.data(), src, sizeof(position));
+        glm::vec4 unorm(
+            static_cast<float>(position[0]) / UNORM16_MAX,
+            static_cast<float>(position[1]) / UNORM16_MAX,
+            static_cast<float>(position[2]) / UNORM16_MAX,
+            1.0f
+        );
+        vertex.position = glm::vec3(vertices.position_transform * unorm);
+    }
+
+    const PackedVertexAttributes &attributes = vertices.attributes[idx];
+
+    glm::vec2 normal(
+        std::max(static_cast<float>(attributes.normal[0]) / SNORM16_MAX, -1.0f),
+        std::max(static_cast<float>(attributes.normal[1]) / SNORM16_MAX, -1.0f)
+    );
+    glm::vec2 tangent(
+        static_cast<float>(attributes.tangent & 0x7fffu) / UNORM15_MAX * 2.0f - 1.0f,
+        static_cast<float>((attributes.tangent >> 16) & 0x7fffu) / UNORM15_MAX * 2.0f - 1.0f
+    );
+    float bitangent_sign = (attributes.tangent >> 31) != 0 ? -1.0f : 1.0f;
+
+    vertex.normal = octahedral_decode(normal);
+    vertex.tangent = octahedral_decode(tangent);
+    vertex.bitangent = glm::cross(vertex.normal, vertex.tangent) * bitangent_sign;
+    vertex.tex_coords = glm::vec2(
+        half_to_float(attributes.tex_coords[0]), half_to_float(attributes.tex_coords[1])
+    );
+    return vertex;
+}
+
+} // namespace Arctic::Renderer
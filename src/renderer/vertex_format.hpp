@@ -0,0 +1,78 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <glm/mat4x4.hpp>
+
+#include "scene.hpp"
+
+namespace Arctic::Renderer
+{
+
+enum class VertexPositionFormat : uint32_t
+{
+    // Three 32 bit floats, as loaded.
+    Float,
+    // Four 16 bit unorms relative to the bounding box of the mesh, the fourth one is unused.
+    Unorm16,
+};
+
+inline constexpr std::array VERTEX_POSITION_FORMATS{
+    VertexPositionFormat::Float,
+    VertexPositionFormat::Unorm16,
+};
+
+// Everything but the position of a compressed vertex.
+struct PackedVertexAttributes
+{
+    // Octahedral encoded normal as two 16 bit snorms.
+    std::array<int16_t, 2> normal;
+    // Octahedral encoded tangent as two 15 bit unorms in bits 0-14 and 16-30. Bit 31 is set if
+    // the bitangent points in the direction opposite of `cross(normal, tangent)`.
+    uint32_t tangent;
+    // Texture coordinates as half floats.
+    std::array<uint16_t, 2> tex_coords;
+};
+
+static_assert(sizeof(PackedVertexAttributes) == 12);
+
+[[nodiscard]] uint32_t vertex_position_size(VertexPositionFormat format);
+
+// Vertices of a mesh in the compressed format, split into two tightly packed streams so that
+// depth only passes fetch nothing but the positions.
+struct CompressedVertices
+{
+    VertexPositionFormat position_format;
+    // Positions in `position_format`, `vertex_position_size(position_format)` bytes each.
+    std::vector<uint8_t> positions;
+    std::vector<PackedVertexAttributes> attributes;
+    // Maps decoded positions to the positions of the original vertices. The identity for float
+    // positions, otherwise the scale and translation of the bounding box.
+    glm::mat4 position_transform;
+};
+
+// Positions are quantized if doing so moves no vertex by more than `position_tolerance`.
+[[nodiscard]] VertexPositionFormat
+choose_vertex_position_format(std::span<const Vertex> vertices, float position_tolerance);
+
+// Converts vertices to the compressed format. Uses SSE2 where available.
+void compress_vertices(
+    std::span<const Vertex> vertices, VertexPositionFormat position_format,
+    CompressedVertices &out_vertices
+);
+
+// Reference implementation of `compress_vertices` without SIMD. Produces identical results.
+void compress_vertices_scalar(
+    std::span<const Vertex> vertices, VertexPositionFormat position_format,
+    CompressedVertices &out_vertices
+);
+
+// Decodes a vertex the same way the shaders do, except for the bitangent which is reconstructed
+// from the normal and tangent as given.
+[[nodiscard]] Vertex decompress_vertex(const CompressedVertices &vertices, size_t idx);
+
+} // namespace Arctic::Renderer
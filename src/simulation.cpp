@@ -0,0 +1,128 @@
+#include "simulation.hpp"
+
+#include <glm/geometric.hpp>
+
+namespace Arctic
+{
+
+void Simulation::rotate_camera(glm::vec2 delta)
+{
+    m_previous.rotation += delta;
+    m_current.rotation += delta;
+}
+
+uint32_t Simulation::advance(float delta_time, const InputState &input, float camera_speed)
+{
+    m_accumulator += delta_time;
+
+    uint32_t steps = 0;
+    while (m_accumulator >= TIMESTEP && steps < MAX_STEPS_PER_FRAME)
+    {
+        m_previous = m_current;
+
+        float fwd_input = static_cast<float>(input.w) - static_cast<float>(input.s);
+        float right_input = static_cast<float>(input.d) - static_cast<float>(input.a);
+        float up_input = static_cast<float>(input.space) - static_cast<float>(input.ctrl);
+
+        Renderer::Camera camera{
+            .eye = m_current.eye,
+            .rotation = m_current.rotation,
+            .aspect = 1.0f,
+            .fov_y = 0.0f,
+            .z_near_far = {0.0f, 0.0f},
+        };
+        glm::vec3 forward = camera.forward();
+        glm::vec3 up = camera.up();
+        glm::vec3 right = glm::cross(forward, up);
+
+        m_current.eye += camera_speed * TIMESTEP * fwd_input * forward;
+        m_current.eye += camera_speed * TIMESTEP * up_input * up;
+        m_current.eye += camera_speed * TIMESTEP * right_input * right;
+
+        m_accumulator -= TIMESTEP;
+        ++steps;
+    }
+
+    if (steps == MAX_STEPS_PER_FRAME && m_accumulator >= TIMESTEP)
+    {
+        m_accumulator = 0.0f;
+    }
+
+    return steps;
+}
+
+CameraState Simulation::interpolated_camera() const
+{
+    float alpha = interpolation_alpha();
+    return CameraState{
+        .eye = m_previous.eye + (m_current.eye - m_previous.eye) * alpha,
+        .rotation = m_current.rotation,
+    };
+}
+
+void Simulation::apply_to(Renderer::Camera &camera) const
+{
+    CameraState state = interpolated_camera();
+    camera.eye = state.eye;
+    camera.rotation = state.rotation;
+}
+
+uint32_t InputHandler::drain(const PollInputEvent &poll, Simulation &simulation)
+{
+    uint32_t count = 0;
+    InputEvent event;
+    while (poll(event))
+    {
+        handle(event, simulation);
+        ++count;
+    }
+    return count;
+}
+
+void InputHandler::handle(const InputEvent &event, Simulation &simulation)
+{
+    switch (event.type)
+    {
+        case InputEvent::Type::Key:
+            switch (event.key)
+            {
+                case InputKey::W:
+                    m_state.w = event.pressed;
+                    break;
+                case InputKey::A:
+                    m_state.a = event.pressed;
+                    break;
+                case InputKey::S:
+                    m_state.s = event.pressed;
+                    break;
+                case InputKey::D:
+                    m_state.d = event.pressed;
+                    break;
+                case InputKey::Space:
+                    m_state.space = event.pressed;
+                    break;
+                case InputKey::LeftCtrl:
+                    m_state.ctrl = event.pressed;
+                    break;
+            }
+            break;
+        case InputEvent::Type::MouseButton:
+            if (event.button == MouseButton::Right)
+            {
+                m_state.rmb = event.pressed;
+            }
+            break;
+        case InputEvent::Type::MouseMotion:
+            if (m_state.rmb)
+            {
+                simulation.rotate_camera(
+                    glm::vec2(-event.motion.y, event.motion.x) * mouse_sensitivity
+                );
+            }
+            break;
+        case InputEvent::Type::Other:
+            break;
+    }
+}
+
+} // namespace Arctic
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+
+#include "renderer/scene.hpp"
+
+namespace Arctic
+{
+
+struct InputState
+{
+    bool w, a, s, d, space, ctrl, rmb;
+};
+
+struct CameraState
+{
+    glm::vec3 eye;
+    glm::vec2 rotation;
+};
+
+enum class InputKey : uint8_t
+{
+    W,
+    A,
+    S,
+    D,
+    Space,
+    LeftCtrl,
+};
+
+enum class MouseButton : uint8_t
+{
+    Left,
+    Middle,
+    Right,
+};
+
+// The window events that drive the camera, independent of SDL so they can be synthesized without
+// a window. Events of type `Other` are counted but change nothing.
+struct InputEvent
+{
+    enum class Type : uint8_t
+    {
+        Other,
+        Key,
+        MouseButton,
+        MouseMotion,
+    };
+
+    Type type{Type::Other};
+    bool pressed{false};
+    InputKey key{InputKey::W};
+    MouseButton button{MouseButton::Left};
+    // Relative mouse motion in pixels.
+    glm::vec2 motion{0.0f};
+};
+
+// Writes the next pending event and returns true, or returns false once no events are left.
+using PollInputEvent = std::function<bool(InputEvent &)>;
+
+// Advances the camera at a fixed timestep independent of the frame rate. Rendering uses a state
+// interpolated between the last two simulation steps so movement stays smooth even if the frame
+// rate is not a multiple of the simulation rate.
+class Simulation
+{
+  public:
+    static constexpr float TIMESTEP = 1.0f / 120.0f;
+    // Upper bound on the number of steps per frame so a long stall does not cause an ever growing
+    // backlog of steps. Time beyond that is dropped.
+    static constexpr uint32_t MAX_STEPS_PER_FRAME = 8;
+
+  private:
+    CameraState m_previous{};
+    CameraState m_current{};
+    float m_accumulator{0.0f};
+
+  public:
+    Simulation() = default;
+
+    void set_camera(const CameraState &camera)
+    {
+        m_previous = camera;
+        m_current = camera;
+    }
+
+    // Mouse look is applied immediately instead of on the next step, so it is neither delayed nor
+    // smoothed by the interpolation.
+    void rotate_camera(glm::vec2 delta);
+
+    // Runs as many fixed steps as fit into the elapsed time and returns how many were run.
+    uint32_t advance(float delta_time, const InputState &input, float camera_speed);
+
+    // Accumulated time that has not been simulated yet, in multiples of the timestep.
+    [[nodiscard]] float interpolation_alpha() const
+    {
+        return m_accumulator / TIMESTEP;
+    }
+
+    [[nodiscard]] CameraState interpolated_camera() const;
+
+    void apply_to(Renderer::Camera &camera) const;
+};
+
+// Turns input events into the held keys the simulation steps with, and mouse motion into camera
+// rotation.
+class InputHandler
+{
+    InputState m_state{};
+
+  public:
+    // Degrees of rotation per pixel of mouse motion.
+    float mouse_sensitivity{0.5f};
+
+    // Handles events until `poll` runs out, so input that arrived faster than the frame rate is
+    // applied in one frame instead of being spread over the following ones. Returns the number of
+    // events handled.
+    uint32_t drain(const PollInputEvent &poll, Simulation &simulation);
+
+    void handle(const InputEvent &event, Simulation &simulation);
+
+    [[nodiscard]] const InputState &state() const
+    {
+        return m_state;
+    }
+};
+
+} // namespace Arctic
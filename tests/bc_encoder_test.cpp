@@ -0,0 +1,262 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <random>
+
+#include "bc_encoder.hpp"
+#include "check.hpp"
+
+using namespace Arctic;
+using Renderer::TextureFormat;
+
+namespace
+{
+
+RgbaBlock solid_block(uint8_t r, uint8_t g, uint8_t b, uint8_t a)
+{
+    RgbaBlock block;
+    for (size_t i = 0; i < 16; ++i)
+    {
+        block[4 * i + 0] = r;
+        block[4 * i + 1] = g;
+        block[4 * i + 2] = b;
+        block[4 * i + 3] = a;
+    }
+    return block;
+}
+
+// Expands 5 or 6 bit values the way the decoder does, so they survive the 565 endpoints as is.
+uint8_t expand_5(uint32_t value)
+{
+    return static_cast<uint8_t>((value << 3) | (value >> 2));
+}
+
+uint8_t expand_6(uint32_t value)
+{
+    return static_cast<uint8_t>((value << 2) | (value >> 4));
+}
+
+RgbaBlock round_trip(TextureFormat format, const RgbaBlock &block)
+{
+    std::array<uint8_t, 16> encoded{};
+    switch (format)
+    {
+        case TextureFormat::BC1Unorm:
+            encode_bc1_block(block, encoded.data());
+            break;
+        case TextureFormat::BC3Unorm:
+            encode_bc3_block(block, encoded.data());
+            break;
+        case TextureFormat::BC4Unorm:
+            encode_bc4_block(block, 0, encoded.data());
+            break;
+        case TextureFormat::BC5Unorm:
+            encode_bc5_block(block, encoded.data());
+            break;
+        default:
+            break;
+    }
+    // Channels the format does not store keep what was there before decoding.
+    RgbaBlock decoded = block;
+    decode_block(format, encoded.data(), decoded);
+    return decoded;
+}
+
+uint32_t max_channel_error(const RgbaBlock &a, const RgbaBlock &b, uint32_t channel)
+{
+    uint32_t max_error = 0;
+    for (size_t i = 0; i < 16; ++i)
+    {
+        max_error = std::max(
+            max_error, static_cast<uint32_t>(std::abs(a[4 * i + channel] - b[4 * i + channel]))
+        );
+    }
+    return max_error;
+}
+
+// Solid blocks whose color is representable as 565 decode exactly in BC1 and BC3, alpha and BC4
+// values always do. Other colors only lose what the 565 quantization takes.
+void test_solid_blocks(std::mt19937 &rng)
+{
+    std::uniform_int_distribution<uint32_t> dist(0, 255);
+    for (uint32_t iteration = 0; iteration < 64; ++iteration)
+    {
+        auto r = static_cast<uint8_t>(dist(rng));
+        auto g = static_cast<uint8_t>(dist(rng));
+        auto b = static_cast<uint8_t>(dist(rng));
+        auto a = static_cast<uint8_t>(dist(rng));
+
+        RgbaBlock exact = solid_block(expand_5(r >> 3), expand_6(g >> 2), expand_5(b >> 3), a);
+        CHECK(round_trip(TextureFormat::BC1Unorm, exact) == exact);
+        CHECK(round_trip(TextureFormat::BC3Unorm, exact) == exact);
+        CHECK(round_trip(TextureFormat::BC4Unorm, exact) == exact);
+        CHECK(round_trip(TextureFormat::BC5Unorm, exact) == exact);
+
+        RgbaBlock block = solid_block(r, g, b, a);
+        RgbaBlock decoded = round_trip(TextureFormat::BC3Unorm, block);
+        CHECK(max_channel_error(block, decoded, 0) <= 4);
+        CHECK(max_channel_error(block, decoded, 1) <= 2);
+        CHECK(max_channel_error(block, decoded, 2) <= 4);
+        CHECK(max_channel_error(block, decoded, 3) == 0);
+    }
+}
+
+// Blocks of two 565 colors end up with those colors as the endpoints and decode exactly, as do
+// blocks with two values in a channel for BC4 and BC5.
+void test_two_color_blocks(std::mt19937 &rng)
+{
+    std::uniform_int_distribution<uint32_t> dist(0, 255);
+    std::bernoulli_distribution pick;
+    for (uint32_t iteration = 0; iteration < 64; ++iteration)
+    {
+        std::array<RgbaBlock, 2> colors;
+        for (RgbaBlock &color : colors)
+        {
+            color = solid_block(
+                expand_5(dist(rng) >> 3),
+                expand_6(dist(rng) >> 2),
+                expand_5(dist(rng) >> 3),
+                static_cast<uint8_t>(dist(rng))
+            );
+        }
+
+        // Both colors show up at least once.
+        RgbaBlock block;
+        for (size_t i = 0; i < 16; ++i)
+        {
+            size_t color = i < 2 ? i : static_cast<size_t>(pick(rng));
+            std::copy_n(colors[color].begin() + 4 * i, 4, block.begin() + 4 * i);
+        }
+
+        CHECK(round_trip(TextureFormat::BC1Unorm, block) == block);
+        CHECK(round_trip(TextureFormat::BC3Unorm, block) == block);
+        CHECK(round_trip(TextureFormat::BC4Unorm, block) == block);
+        CHECK(round_trip(TextureFormat::BC5Unorm, block) == block);
+    }
+}
+
+// The values of a BC4 block are at most half a palette step away from the nearest entry, plus
+// the rounding of the decoder. BC1 blocks of smooth gradients stay within a bound on their mean
+// squared error.
+void test_error_bounds(std::mt19937 &rng)
+{
+    std::uniform_int_distribution<uint32_t> dist(0, 255);
+    for (uint32_t iteration = 0; iteration < 256; ++iteration)
+    {
+        RgbaBlock block;
+        for (uint8_t &value : block)
+        {
+            value = static_cast<uint8_t>(dist(rng));
+        }
+
+        RgbaBlock decoded = round_trip(TextureFormat::BC5Unorm, block);
+        for (uint32_t channel = 0; channel < 2; ++channel)
+        {
+            uint8_t min_value = 255;
+            uint8_t max_value = 0;
+            for (size_t i = 0; i < 16; ++i)
+            {
+                min_value = std::min(min_value, block[4 * i + channel]);
+                max_value = std::max(max_value, block[4 * i + channel]);
+            }
+            float bound = static_cast<float>(max_value - min_value) / 14.0f + 0.5f;
+            CHECK(static_cast<float>(max_channel_error(block, decoded, channel)) <= bound);
+        }
+    }
+
+    // Smooth gradients with a little noise, like most blocks of a diffuse map.
+    std::uniform_int_distribution<int32_t> noise(-4, 4);
+    for (uint32_t iteration = 0; iteration < 256; ++iteration)
+    {
+        std::array<int32_t, 3> base{};
+        std::array<int32_t, 3> step{};
+        for (size_t c = 0; c < 3; ++c)
+        {
+            base[c] = static_cast<int32_t>(dist(rng));
+            step[c] = static_cast<int32_t>(dist(rng) % 17) - 8;
+        }
+
+        RgbaBlock block;
+        for (size_t i = 0; i < 16; ++i)
+        {
+            auto t = static_cast<int32_t>(i % 4 + i / 4);
+            for (size_t c = 0; c < 3; ++c)
+            {
+                block[4 * i + c] =
+                    static_cast<uint8_t>(std::clamp(base[c] + step[c] * t + noise(rng), 0, 255));
+            }
+            block[4 * i + 3] = 255;
+        }
+
+        RgbaBlock decoded = round_trip(TextureFormat::BC1Unorm, block);
+        float squared_error = 0.0f;
+        for (size_t i = 0; i < 16; ++i)
+        {
+            for (size_t c = 0; c < 3; ++c)
+            {
+                float error = static_cast<float>(block[4 * i + c] - decoded[4 * i + c]);
+                squared_error += error * error;
+            }
+        }
+        CHECK(squared_error / 48.0f <= 32.0f);
+    }
+}
+
+// Normal maps keep x and y in red and green and the shaders reconstruct z from them, so the
+// normals they decode to point almost where the original ones did.
+void test_bc5_normals()
+{
+    float max_angle = 0.0f;
+    for (uint32_t block_y = 0; block_y < 16; ++block_y)
+    {
+        for (uint32_t block_x = 0; block_x < 16; ++block_x)
+        {
+            // A bumpy surface, normals tilt up to about 60 degrees.
+            RgbaBlock block;
+            std::array<std::array<float, 3>, 16> normals;
+            for (size_t i = 0; i < 16; ++i)
+            {
+                float x = static_cast<float>(4 * block_x + i % 4) * 0.1f;
+                float y = static_cast<float>(4 * block_y + i / 4) * 0.1f;
+                float dx = 1.5f * std::cos(x) * std::sin(0.7f * y);
+                float dy = 1.5f * std::sin(x) * std::cos(0.7f * y) * 0.7f;
+                float length = std::sqrt(dx * dx + dy * dy + 1.0f);
+                normals[i] = {-dx / length, -dy / length, 1.0f / length};
+                for (size_t c = 0; c < 3; ++c)
+                {
+                    block[4 * i + c] =
+                        static_cast<uint8_t>(std::lround((normals[i][c] * 0.5f + 0.5f) * 255.0f));
+                }
+                block[4 * i + 3] = 255;
+            }
+
+            RgbaBlock decoded = round_trip(TextureFormat::BC5Unorm, block);
+            for (size_t i = 0; i < 16; ++i)
+            {
+                float x = static_cast<float>(decoded[4 * i + 0]) / 255.0f * 2.0f - 1.0f;
+                float y = static_cast<float>(decoded[4 * i + 1]) / 255.0f * 2.0f - 1.0f;
+                float z = std::sqrt(std::clamp(1.0f - x * x - y * y, 0.0f, 1.0f));
+                float length = std::sqrt(x * x + y * y + z * z);
+                float cos_angle =
+                    (x * normals[i][0] + y * normals[i][1] + z * normals[i][2]) / length;
+                max_angle = std::max(max_angle, std::acos(std::clamp(cos_angle, -1.0f, 1.0f)));
+            }
+        }
+    }
+    // Three degrees.
+    CHECK(max_angle <= 0.053f);
+}
+
+} // namespace
+
+int main()
+{
+    std::mt19937 rng(42);
+    test_solid_blocks(rng);
+    test_two_color_blocks(rng);
+    test_error_bounds(rng);
+    test_bc5_normals();
+    return Arctic::Test::exit_code();
+}
@@ -0,0 +1,161 @@
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "benchmark.hpp"
+#include "check.hpp"
+
+using namespace Arctic;
+
+namespace
+{
+
+std::vector<std::string> read_lines(const std::filesystem::path &path)
+{
+    std::ifstream file(path);
+    std::vector<std::string> lines;
+    std::string line;
+    while (std::getline(file, line))
+    {
+        lines.emplace_back(line);
+    }
+    return lines;
+}
+
+std::string read_file(const std::filesystem::path &path)
+{
+    std::ifstream file(path);
+    std::stringstream stream;
+    stream << file.rdbuf();
+    return stream.str();
+}
+
+// Pass names end up quoted in the CSV header and escaped in the JSON. Passes that only show up in
+// some frames or have no GPU time yet leave their cells empty and only count towards their
+// summaries in the frames they were recorded in.
+void test_results(const std::filesystem::path &directory)
+{
+    Renderer::FramePacingStats pacing{.cpu_wait_ms = 1.0f, .gpu_wait_ms = 2.0f};
+    Renderer::MemoryStats memory{};
+    memory.local_usage = 512ull * 1024 * 1024;
+
+    BenchmarkRecorder recorder;
+    std::vector<Renderer::PassTiming> passes{
+        {.name = "shadow map", .cpu_ms = 1.5f, .gpu_ms = 2.5f},
+        {.name = "copy \"a\", b", .cpu_ms = 0.25f, .gpu_ms = std::nullopt},
+    };
+    recorder.record_frame(16.0f, 4.0f, 10.0f, pacing, memory, passes);
+    passes[1].gpu_ms = 0.5f;
+    passes.push_back({.name = "late", .cpu_ms = 0.125f, .gpu_ms = 0.75f});
+    recorder.record_frame(16.0f, 4.0f, 10.0f, pacing, memory, passes);
+    recorder.record_frame(16.0f, 4.0f, 10.0f, pacing, memory, {});
+    CHECK(recorder.frame_count() == 3);
+
+    std::filesystem::path output = directory / "results";
+    CHECK(recorder.write_results(output));
+
+    std::vector<std::string> csv = read_lines(directory / "results.csv");
+    CHECK(csv.size() == 4);
+    if (csv.size() != 4)
+    {
+        return;
+    }
+    CHECK(
+        csv[0] == "frame,frame_ms,cpu_ms,cpu_wait_ms,gpu_wait_ms,gpu_ms,local_memory_mb,"
+                  "\"shadow map cpu_ms\",\"shadow map gpu_ms\","
+                  "\"copy \"\"a\"\", b cpu_ms\",\"copy \"\"a\"\", b gpu_ms\","
+                  "\"late cpu_ms\",\"late gpu_ms\""
+    );
+    CHECK(csv[1] == "0,16,4,1,2,10,512,1.5,2.5,0.25,,,");
+    CHECK(csv[2] == "1,16,4,1,2,10,512,1.5,2.5,0.25,0.5,0.125,0.75");
+    CHECK(csv[3] == "2,16,4,1,2,10,512,,,,,,");
+
+    std::string json = read_file(directory / "results.json");
+    CHECK(json.find("\"frame_count\": 3") != std::string::npos);
+    CHECK(json.find("{\"name\": \"copy \\\"a\\\", b\"") != std::string::npos);
+    CHECK(
+        json.find("{\"name\": \"copy \\\"a\\\", b\", \"cpu_ms\": {\"count\": 2, \"mean\": 0.25, "
+                  "\"min\": 0.25") != std::string::npos
+    );
+    CHECK(
+        json.find("\"gpu_ms\": {\"count\": 1, \"mean\": 0.5, \"min\": 0.5, \"max\": 0.5") !=
+        std::string::npos
+    );
+    CHECK(
+        json.find("{\"name\": \"late\", \"cpu_ms\": {\"count\": 1, \"mean\": 0.125") !=
+        std::string::npos
+    );
+    CHECK(
+        json.find("\"pass_cpu_ms\": [1.5, 0.25], \"pass_gpu_ms\": [2.5, null]") !=
+        std::string::npos
+    );
+}
+
+// Control characters in pass names are escaped, so the JSON stays valid.
+void test_json_escape(const std::filesystem::path &directory)
+{
+    BenchmarkRecorder recorder;
+    std::vector<Renderer::PassTiming> passes{
+        {.name = "a\tb\nc\rd\x01\x1f\\", .cpu_ms = 1.0f, .gpu_ms = 1.0f},
+    };
+    recorder.record_frame(16.0f, 4.0f, 10.0f, {}, {}, passes);
+
+    std::filesystem::path output = directory / "escaped";
+    CHECK(recorder.write_results(output));
+
+    std::string json = read_file(directory / "escaped.json");
+    CHECK(json.find("{\"name\": \"a\\tb\\nc\\rd\\u0001\\u001f\\\\\", ") != std::string::npos);
+    CHECK(std::none_of(json.begin(), json.end(), [](char c) {
+        return static_cast<unsigned char>(c) < 0x20 && c != '\n';
+    }));
+}
+
+// Keyframes survive a round trip through a file and are interpolated linearly, with times
+// outside of the path clamped to its ends.
+void test_camera_path(const std::filesystem::path &directory)
+{
+    CameraPath path;
+    path.add_keyframe({.time = 0.0f, .eye = glm::vec3(0.0f), .rotation = glm::vec2(0.0f)});
+    path.add_keyframe(
+        {.time = 2.0f, .eye = glm::vec3(4.0f, 2.0f, -2.0f), .rotation = glm::vec2(10.0f, 90.0f)}
+    );
+
+    std::filesystem::path file = directory / "path.txt";
+    CHECK(path.save(file));
+    CameraPath loaded;
+    CHECK(CameraPath::load(file, loaded));
+    CHECK(loaded.size() == 2);
+
+    CameraState middle = loaded.sample(0.5f);
+    CHECK(std::abs(middle.eye.x - 1.0f) < 1e-5f);
+    CHECK(std::abs(middle.eye.z + 0.5f) < 1e-5f);
+    CHECK(std::abs(middle.rotation.y - 22.5f) < 1e-5f);
+    CHECK(loaded.sample(-1.0f).eye.x == 0.0f);
+    CHECK(loaded.sample(5.0f).eye.x == 4.0f);
+
+    std::ofstream(directory / "unordered.txt") << "# comment\n1 0 0 0 0 0\n0 0 0 0 0 0\n";
+    CHECK(!CameraPath::load(directory / "unordered.txt", loaded));
+    std::ofstream(directory / "malformed.txt") << "0 1 2\n";
+    CHECK(!CameraPath::load(directory / "malformed.txt", loaded));
+}
+
+} // namespace
+
+int main()
+{
+    std::filesystem::path directory =
+        std::filesystem::temp_directory_path() / "arctic_benchmark_test";
+    std::filesystem::create_directories(directory);
+
+    test_results(directory);
+    test_json_escape(directory);
+    test_camera_path(directory);
+
+    std::filesystem::remove_all(directory);
+    return Arctic::Test::exit_code();
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <spdlog/spdlog.h>
+
+namespace Arctic::Test
+{
+
+// Number of failed `CHECK`s so far. Test executables return a non-zero exit code if any check
+// failed, which is what CTest looks at.
+inline int &failures()
+{
+    static int count = 0;
+    return count;
+}
+
+[[nodiscard]] inline int exit_code()
+{
+    return failures() == 0 ? 0 : 1;
+}
+
+} // namespace Arctic::Test
+
+// Logs the failed condition with its location and keeps going, so one run reports every failure.
+#define CHECK(condition)                                                                           \
+    do                                                                                             \
+    {                                                                                              \
+        if (!(condition))                                                                          \
+        {                                                                                          \
+            spdlog::error("{}:{}: check failed: {}", __FILE__, __LINE__, #condition);              \
+            ++Arctic::Test::failures();                                                            \
+        }                                                                                          \
+    } while (false)
@@ -0,0 +1,24 @@
+# Runs COMMAND with the space separated ARGS and fails if its standard output differs from the
+# file GOLDEN. The actual output is written to ACTUAL, so the two can be diffed, or the golden
+# file replaced by it after an intended change.
+#
+# Usage: cmake -DCOMMAND=<exe> -DARGS=<args> -DGOLDEN=<file> -DACTUAL=<file> -P compare_output.cmake
+
+separate_arguments(ARGS)
+string(REPLACE ";" " " command_line "${COMMAND};${ARGS}")
+execute_process(
+        COMMAND ${COMMAND} ${ARGS}
+        OUTPUT_VARIABLE actual
+        RESULT_VARIABLE result
+)
+if(NOT result EQUAL 0)
+        message(FATAL_ERROR "`${command_line}` failed: ${result}")
+endif()
+
+file(READ ${GOLDEN} expected)
+string(REPLACE "\r\n" "\n" actual "${actual}")
+string(REPLACE "\r\n" "\n" expected "${expected}")
+file(WRITE ${ACTUAL} "${actual}")
+if(NOT actual STREQUAL expected)
+        message(FATAL_ERROR "output of `${command_line}` differs from ${GOLDEN}, see ${ACTUAL}")
+endif()
@@ -0,0 +1,123 @@
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+#include "check.hpp"
+#include "renderer/dds.hpp"
+
+using namespace Arctic::Renderer;
+
+namespace
+{
+
+constexpr uint32_t DDSD_CAPS = 0x1;
+constexpr uint32_t DDSD_HEIGHT = 0x2;
+constexpr uint32_t DDSD_WIDTH = 0x4;
+constexpr uint32_t DDSD_PIXELFORMAT = 0x1000;
+constexpr uint32_t DDPF_FOURCC = 0x4;
+constexpr uint32_t DDSCAPS_TEXTURE = 0x1000;
+// "DDS " and "DXT1" as little endian four character codes.
+constexpr uint32_t DDS_MAGIC = 0x20534444;
+constexpr uint32_t FOUR_CC_DXT1 = 0x31545844;
+
+void append(std::vector<uint8_t> &bytes, const void *data, size_t size)
+{
+    const auto *begin = static_cast<const uint8_t *>(data);
+    bytes.insert(bytes.end(), begin, begin + size);
+}
+
+// Writes a legacy DXT1 file with a single level of `block_count` blocks.
+void write_dds(
+    const std::filesystem::path &path, uint32_t width, uint32_t height, size_t block_count
+)
+{
+    std::array<uint32_t, 31> header{};
+    header[0] = 124;
+    header[1] = DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PIXELFORMAT;
+    header[2] = height;
+    header[3] = width;
+    // The pixel format follows the eleven reserved values after the mip count.
+    header[18] = 32;
+    header[19] = DDPF_FOURCC;
+    header[20] = FOUR_CC_DXT1;
+    header[26] = DDSCAPS_TEXTURE;
+    std::vector<uint8_t> blocks(8 * block_count, 0x55);
+
+    std::vector<uint8_t> bytes;
+    append(bytes, &DDS_MAGIC, sizeof(DDS_MAGIC));
+    append(bytes, header.data(), sizeof(header));
+    append(bytes, blocks.data(), blocks.size());
+
+    std::ofstream file(path, std::ios::binary);
+    file.write(
+        reinterpret_cast<const char *>(bytes.data()),
+        static_cast<std::streamsize>(bytes.size())
+    );
+}
+
+// A single block compressed level is referenced in place.
+void test_load(const std::filesystem::path &directory)
+{
+    std::filesystem::path path = directory / "dxt1.dds";
+    write_dds(path, 8, 4, 2);
+
+    TextureImage image;
+    CHECK(load_dds(path, MipColorSpace::Linear, image));
+    CHECK(image.format == TextureFormat::BC1Unorm);
+    CHECK(image.width == 8 && image.height == 4);
+    CHECK(image.levels.size() == 1);
+    CHECK(image.file != nullptr);
+}
+
+// The legacy codes carry no colour space, so diffuse maps are read through the sRGB variant of
+// their format. Files with the DX10 header keep the format they were written with.
+void test_color_space(const std::filesystem::path &directory)
+{
+    std::filesystem::path path = directory / "diffuse.dds";
+    write_dds(path, 4, 4, 1);
+
+    TextureImage image;
+    CHECK(load_dds(path, MipColorSpace::Srgb, image));
+    CHECK(image.format == TextureFormat::BC1UnormSrgb);
+    CHECK(load_dds(path, MipColorSpace::Linear, image));
+    CHECK(image.format == TextureFormat::BC1Unorm);
+
+    TextureImage linear;
+    allocate_texture_image(TextureFormat::BC3Unorm, 4, 4, 1, linear);
+    path = directory / "linear.dds";
+    CHECK(save_dds(path, linear));
+    CHECK(load_dds(path, MipColorSpace::Srgb, image));
+    CHECK(image.format == TextureFormat::BC3Unorm);
+}
+
+// Files without any texels are rejected up front, like the KTX2 loader does, even if they carry
+// enough data for the one texel wide levels they would otherwise be read as.
+void test_empty(const std::filesystem::path &directory)
+{
+    std::filesystem::path path = directory / "empty.dds";
+    TextureImage image;
+
+    write_dds(path, 0, 4, 4);
+    CHECK(!load_dds(path, MipColorSpace::Linear, image));
+    write_dds(path, 4, 0, 4);
+    CHECK(!load_dds(path, MipColorSpace::Linear, image));
+    write_dds(path, 0, 0, 4);
+    CHECK(!load_dds(path, MipColorSpace::Linear, image));
+}
+
+} // namespace
+
+int main()
+{
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / "arctic_dds_test";
+    std::filesystem::create_directories(directory);
+
+    test_load(directory);
+    test_color_space(directory);
+    test_empty(directory);
+
+    std::filesystem::remove_all(directory);
+    return Arctic::Test::exit_code();
+}
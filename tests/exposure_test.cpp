@@ -0,0 +1,185 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <optional>
+#include <random>
+#include <vector>
+
+#include "check.hpp"
+#include "renderer/auto_exposure.hpp"
+
+using namespace Arctic::Renderer;
+
+namespace
+{
+
+// Not a multiple of the block size, so the blocks at the edges are partial.
+constexpr uint32_t WIDTH = 641;
+constexpr uint32_t HEIGHT = 361;
+
+// A frame lit like the scene: mostly mid tones spread over a few stops, a band of dark shadow, a
+// bright sky and a few pixels of sun far above everything else.
+std::vector<float> generate_frame(float scale)
+{
+    std::vector<float> pixels(4ull * WIDTH * HEIGHT);
+    std::mt19937 rng(1234);
+    std::normal_distribution<float> stops(0.0f, 1.5f);
+    for (uint32_t y = 0; y < HEIGHT; ++y)
+    {
+        for (uint32_t x = 0; x < WIDTH; ++x)
+        {
+            float luminance;
+            if (y < HEIGHT / 4)
+            {
+                luminance = 4.0f;
+            }
+            else if (y > HEIGHT - HEIGHT / 8)
+            {
+                luminance = 0.002f;
+            }
+            else
+            {
+                luminance = 0.3f * std::exp2(stops(rng));
+            }
+            if (x < 8 && y < 8)
+            {
+                luminance = 50000.0f;
+            }
+            float *pixel = pixels.data() + 4ull * (size_t{y} * WIDTH + x);
+            pixel[0] = pixel[1] = pixel[2] = luminance * scale;
+            pixel[3] = 1.0f;
+        }
+    }
+    return pixels;
+}
+
+// Average log2 luminance of the blocks between the percentiles, measured exactly by sorting
+// instead of binning.
+float sorted_log_luminance(const std::vector<float> &pixels, const AutoExposureParams &params)
+{
+    std::vector<float> logs;
+    for (uint32_t y = 0; y < HEIGHT; y += AUTO_EXPOSURE_BLOCK_SIZE)
+    {
+        for (uint32_t x = 0; x < WIDTH; x += AUTO_EXPOSURE_BLOCK_SIZE)
+        {
+            float sum = 0.0f;
+            for (uint32_t dy = 0; dy < AUTO_EXPOSURE_BLOCK_SIZE; ++dy)
+            {
+                for (uint32_t dx = 0; dx < AUTO_EXPOSURE_BLOCK_SIZE; ++dx)
+                {
+                    size_t px = std::min(x + dx, WIDTH - 1);
+                    size_t py = std::min(y + dy, HEIGHT - 1);
+                    sum += pixels[4 * (py * WIDTH + px)];
+                }
+            }
+            float log = std::log2(sum / (AUTO_EXPOSURE_BLOCK_SIZE * AUTO_EXPOSURE_BLOCK_SIZE));
+            if (log >= params.min_log_luminance)
+            {
+                logs.emplace_back(std::min(log, params.max_log_luminance));
+            }
+        }
+    }
+    std::sort(logs.begin(), logs.end());
+    auto begin = static_cast<size_t>(static_cast<float>(logs.size()) * params.low_percentile);
+    auto end = static_cast<size_t>(static_cast<float>(logs.size()) * params.high_percentile);
+    double sum = 0.0;
+    for (size_t i = begin; i < end; ++i)
+    {
+        sum += logs[i];
+    }
+    return static_cast<float>(sum / static_cast<double>(end - begin));
+}
+
+float bin_width(const AutoExposureParams &params)
+{
+    return (params.max_log_luminance - params.min_log_luminance) /
+           static_cast<float>(AUTO_EXPOSURE_BINS - 2);
+}
+
+// Every block is counted once, and the average between the percentiles is within a bin of the
+// exact one.
+void test_histogram()
+{
+    AutoExposureParams params;
+    std::vector<float> frame = generate_frame(1.0f);
+    LuminanceHistogram histogram;
+    build_luminance_histogram(frame, WIDTH, HEIGHT, params, histogram);
+
+    uint64_t block_count = 0;
+    for (uint32_t count : histogram)
+    {
+        block_count += count;
+    }
+    uint64_t blocks_x = (WIDTH + AUTO_EXPOSURE_BLOCK_SIZE - 1) / AUTO_EXPOSURE_BLOCK_SIZE;
+    uint64_t blocks_y = (HEIGHT + AUTO_EXPOSURE_BLOCK_SIZE - 1) / AUTO_EXPOSURE_BLOCK_SIZE;
+    CHECK(block_count == blocks_x * blocks_y);
+
+    std::optional<float> measured = histogram_log_luminance(histogram, params);
+    float exact = sorted_log_luminance(frame, params);
+    CHECK(measured.has_value());
+    CHECK(measured && std::abs(*measured - exact) <= bin_width(params));
+}
+
+// A frame twice as bright measures one stop brighter.
+void test_brighter_frame()
+{
+    AutoExposureParams params;
+    LuminanceHistogram histogram;
+    build_luminance_histogram(generate_frame(1.0f), WIDTH, HEIGHT, params, histogram);
+    std::optional<float> measured = histogram_log_luminance(histogram, params);
+    build_luminance_histogram(generate_frame(2.0f), WIDTH, HEIGHT, params, histogram);
+    std::optional<float> measured_brighter = histogram_log_luminance(histogram, params);
+
+    CHECK(measured.has_value() && measured_brighter.has_value());
+    CHECK(
+        measured && measured_brighter &&
+        std::abs(*measured_brighter - *measured - 1.0f) <= 2.0f * bin_width(params)
+    );
+}
+
+// A black frame has no measurement, so the exposure stays where it is.
+void test_black_frame()
+{
+    AutoExposureParams params;
+    std::vector<float> black(4ull * WIDTH * HEIGHT, 0.0f);
+    LuminanceHistogram histogram;
+    build_luminance_histogram(black, WIDTH, HEIGHT, params, histogram);
+    CHECK(!histogram_log_luminance(histogram, params).has_value());
+}
+
+// After one time constant at 60 Hz, 1 - 1/e of the way is covered in either direction.
+void test_adaptation()
+{
+    AutoExposureParams params;
+    for (bool brightening : {true, false})
+    {
+        float speed = brightening ? params.brightening_speed : params.darkening_speed;
+        float target = brightening ? 4.0f : -4.0f;
+        float adapted = 0.0f;
+        auto frames = static_cast<uint32_t>(std::round(60.0f / speed));
+        for (uint32_t i = 0; i < frames; ++i)
+        {
+            adapted = adapt_log_luminance(adapted, target, 1.0f / 60.0f, params);
+        }
+        CHECK(std::abs(adapted - target * (1.0f - std::exp(-1.0f))) <= 0.01f);
+    }
+}
+
+// Middle grey with one stop of compensation is exposed by two.
+void test_compensation()
+{
+    float exposure = exposure_from_log_luminance(std::log2(AUTO_EXPOSURE_MIDDLE_GREY), 1.0f);
+    CHECK(std::abs(exposure - 2.0f) <= 1e-5f);
+}
+
+} // namespace
+
+int main()
+{
+    test_histogram();
+    test_brighter_frame();
+    test_black_frame();
+    test_adaptation();
+    test_compensation();
+    return Arctic::Test::exit_code();
+}
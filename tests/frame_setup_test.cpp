@@ -0,0 +1,172 @@
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <glm/ext/matrix_transform.hpp>
+#include <glm/vec2.hpp>
+
+#include "check.hpp"
+#include "job_system.hpp"
+#include "renderer/frame_setup.hpp"
+#include "renderer/procedural_mesh.hpp"
+
+using namespace Arctic;
+using namespace Arctic::Renderer;
+
+namespace
+{
+
+constexpr uint32_t TEXTURE_SIZE = 1024;
+// Large enough for the hidden box to need more than the resident tail of its texture.
+constexpr uint32_t VIEWPORT_HEIGHT = 2160;
+
+Object box_at(const glm::vec3 &position, float scale, MeshIdx mesh_idx)
+{
+    return Object{
+        .trs = glm::scale(glm::translate(glm::mat4(1.0f), position), glm::vec3(scale)),
+        .mesh_idx = mesh_idx,
+    };
+}
+
+struct Frame
+{
+    std::vector<uint8_t> software_visibility;
+    // Objects of the draws, in order.
+    std::vector<uint32_t> draw_objects;
+    size_t shadow_draw_count;
+    std::vector<uint32_t> streamed_textures;
+};
+
+// Sets up one frame of a box at 30 behind a wall at 10, each with its own material and texture,
+// seen from the origin along the x axis. The box stays clear of the diagonals of the wall, which
+// the culler leaves uncovered.
+Frame setup_wall_frame(JobSystem &jobs, bool software_occlusion)
+{
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+    generate_box(1, 1.0f, vertices, indices);
+
+    std::vector<MeshDrawInfo> meshes;
+    for (MaterialIdx material_idx = 0; material_idx < 2; ++material_idx)
+    {
+        meshes.emplace_back(MeshDrawInfo{
+            .lods = {MeshLod{
+                .first_index = 0,
+                .index_count = static_cast<uint32_t>(indices.size()),
+                .error = 0.0f,
+            }},
+            .material_idx = material_idx,
+            .bounds_min = glm::vec3(-0.5f),
+            .bounds_max = glm::vec3(0.5f),
+            .bounds_center = glm::vec3(0.0f),
+            .bounds_radius = 0.87f,
+        });
+    }
+
+    SoftwareOcclusionCuller culler(&jobs);
+    for (size_t i = 0; i < meshes.size(); ++i)
+    {
+        culler.add_mesh(vertices, indices);
+    }
+
+    TextureStreamingPolicy streaming(TextureStreamingConfig{.budget = 1ull << 30});
+    std::vector<uint64_t> level_sizes;
+    for (uint32_t size = TEXTURE_SIZE; size > 0; size /= 2)
+    {
+        level_sizes.emplace_back(4ull * size * size);
+    }
+    std::vector<StreamedTextureDesc> textures;
+    for (MaterialIdx material_idx = 0; material_idx < meshes.size(); ++material_idx)
+    {
+        textures.emplace_back(StreamedTextureDesc{
+            .material_idx = material_idx,
+            .streaming_idx = streaming.add_texture(TEXTURE_SIZE, TEXTURE_SIZE, level_sizes),
+            .size = TEXTURE_SIZE,
+            .mip_count = static_cast<uint32_t>(level_sizes.size()),
+        });
+    }
+
+    Scene scene{
+        .camera =
+            Camera{
+                .eye = glm::vec3(0.0f),
+                .rotation = glm::vec2(0.0f),
+                .aspect = 16.0f / 9.0f,
+                .fov_y = 60.0f,
+                .z_near_far = {0.1f, 1000.0f},
+            },
+        .ambient = 1.0f,
+        .sun = DirectionalLight{},
+        .point_lights = {},
+        .objects = {
+            box_at(glm::vec3(30.0f, 8.0f, 0.0f), 2.0f, 1),
+            box_at(glm::vec3(10.0f, 0.0f, 0.0f), 7.0f, 0),
+        },
+    };
+    Settings settings;
+    settings.software_occlusion = software_occlusion;
+
+    FrameSetup setup;
+    setup_frame(
+        scene,
+        settings,
+        VIEWPORT_HEIGHT,
+        meshes,
+        meshes.size(),
+        textures,
+        culler,
+        streaming,
+        setup
+    );
+
+    Frame frame{
+        .software_visibility = setup.software_visibility,
+        .draw_objects = {},
+        .shadow_draw_count = setup.shadow_draws.size(),
+        .streamed_textures = {},
+    };
+    for (const DrawItem &draw : setup.draws)
+    {
+        frame.draw_objects.emplace_back(draw.object_idx);
+    }
+    for (const StreamingRequest &request : setup.streaming_requests)
+    {
+        frame.streamed_textures.emplace_back(request.texture);
+    }
+    std::sort(frame.streamed_textures.begin(), frame.streamed_textures.end());
+    return frame;
+}
+
+// Without software occlusion both boxes are drawn and both textures get more detailed levels.
+void test_without_software_occlusion(JobSystem &jobs)
+{
+    Frame frame = setup_wall_frame(jobs, false);
+    CHECK(frame.software_visibility.empty());
+    CHECK((frame.draw_objects == std::vector<uint32_t>{0, 1}));
+    CHECK(frame.shadow_draw_count == 2);
+    CHECK((frame.streamed_textures == std::vector<uint32_t>{0, 1}));
+}
+
+// The hidden box is left out of the draws, so its texture is not streamed in, but it still casts
+// a shadow. The draw of the wall keeps the index of its object, which keys its occlusion
+// predicates.
+void test_software_occlusion(JobSystem &jobs)
+{
+    Frame frame = setup_wall_frame(jobs, true);
+    CHECK((frame.software_visibility == std::vector<uint8_t>{0, 1}));
+    CHECK((frame.draw_objects == std::vector<uint32_t>{1}));
+    CHECK(frame.shadow_draw_count == 2);
+    CHECK((frame.streamed_textures == std::vector<uint32_t>{0}));
+}
+
+} // namespace
+
+int main()
+{
+    JobSystem jobs;
+    test_without_software_occlusion(jobs);
+    test_software_occlusion(jobs);
+    return Arctic::Test::exit_code();
+}
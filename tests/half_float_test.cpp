@@ -0,0 +1,156 @@
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include <spdlog/spdlog.h>
+
+#include "check.hpp"
+#include "half_float.hpp"
+
+using namespace Arctic;
+
+namespace
+{
+
+float bits_float(uint32_t bits)
+{
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+// Exactly halfway between the finite half `half` and the next one up.
+float tie_above(uint16_t half)
+{
+    return 0.5f * (half_to_float(half) + half_to_float(static_cast<uint16_t>(half + 1)));
+}
+
+// Values with a known conversion: signed NaNs and infinities, the overflow boundary, subnormals
+// and ties that have to round to the even neighbour.
+void test_scalar()
+{
+    float infinity = std::numeric_limits<float>::infinity();
+    float nan = std::numeric_limits<float>::quiet_NaN();
+
+    CHECK(float_to_half(0.0f) == 0x0000);
+    CHECK(float_to_half(-0.0f) == 0x8000);
+    CHECK(float_to_half(1.0f) == 0x3c00);
+    CHECK(float_to_half(-2.0f) == 0xc000);
+
+    CHECK(float_to_half(nan) == 0x7e00);
+    CHECK(float_to_half(-nan) == 0xfe00);
+    CHECK(float_to_half(bits_float(0x7f800001u)) == 0x7e00);
+    CHECK(float_to_half(bits_float(0xffc12345u)) == 0xfe00);
+    CHECK(float_to_half(infinity) == 0x7c00);
+    CHECK(float_to_half(-infinity) == 0xfc00);
+
+    // 65520 is halfway between the largest half and the next power of two, so it rounds to
+    // infinity and anything below it to the largest half.
+    CHECK(float_to_half(65504.0f) == 0x7bff);
+    CHECK(float_to_half(std::nextafter(65520.0f, 0.0f)) == 0x7bff);
+    CHECK(float_to_half(65520.0f) == 0x7c00);
+    CHECK(float_to_half(-65520.0f) == 0xfc00);
+    CHECK(float_to_half(1.0e10f) == 0x7c00);
+
+    CHECK(float_to_half(std::ldexp(1.0f, -14)) == 0x0400);
+    CHECK(float_to_half(std::ldexp(1.0f, -24)) == 0x0001);
+    CHECK(float_to_half(-std::ldexp(1.0f, -24)) == 0x8001);
+    CHECK(float_to_half(std::ldexp(1023.0f, -24)) == 0x03ff);
+    CHECK(float_to_half(std::ldexp(1.0f, -26)) == 0x0000);
+    CHECK(float_to_half(-std::ldexp(1.0f, -26)) == 0x8000);
+    // Halfway between zero and the smallest subnormal, and between the first two subnormals.
+    CHECK(float_to_half(std::ldexp(1.0f, -25)) == 0x0000);
+    CHECK(float_to_half(std::ldexp(3.0f, -25)) == 0x0002);
+    CHECK(float_to_half(std::nextafter(std::ldexp(1.0f, -25), 1.0f)) == 0x0001);
+
+    // Ties in the normal range go to the neighbour with an even mantissa.
+    CHECK(float_to_half(tie_above(0x3c00)) == 0x3c00);
+    CHECK(float_to_half(tie_above(0x3c01)) == 0x3c02);
+    CHECK(float_to_half(-tie_above(0x3c01)) == 0xbc02);
+    CHECK(float_to_half(tie_above(0x03ff)) == 0x0400);
+    CHECK(float_to_half(tie_above(0x7bfe)) == 0x7bfe);
+    CHECK(float_to_half(std::nextafter(tie_above(0x3c00), 2.0f)) == 0x3c01);
+
+    // Every half that is not a NaN converts back to itself.
+    for (uint32_t half = 0; half <= 0xffff; ++half)
+    {
+        float value = half_to_float(static_cast<uint16_t>(half));
+        if (std::isnan(value))
+        {
+            CHECK((half & 0x7c00) == 0x7c00 && (half & 0x03ff) != 0);
+            continue;
+        }
+        CHECK(float_to_half(value) == half);
+    }
+}
+
+// The SIMD conversions agree with the scalar one on the edge cases, on every tie and on random
+// values over the whole range. Lengths that are not a multiple of the vector width leave a tail.
+void test_simd()
+{
+    std::vector<float> values{
+        0.0f,
+        -0.0f,
+        65504.0f,
+        65520.0f,
+        -65520.0f,
+        std::nextafter(65520.0f, 0.0f),
+        std::numeric_limits<float>::infinity(),
+        -std::numeric_limits<float>::infinity(),
+        std::numeric_limits<float>::quiet_NaN(),
+        -std::numeric_limits<float>::quiet_NaN(),
+        bits_float(0x7f800001u),
+        bits_float(0xffc12345u),
+        std::ldexp(1.0f, -25),
+        std::ldexp(3.0f, -25),
+        std::ldexp(1.0f, -14),
+        std::numeric_limits<float>::denorm_min(),
+    };
+    for (uint32_t half = 0; half < 0x7bff; ++half)
+    {
+        values.emplace_back(tie_above(static_cast<uint16_t>(half)));
+        values.emplace_back(-tie_above(static_cast<uint16_t>(half)));
+    }
+    std::mt19937 rng(1234);
+    std::uniform_int_distribution<uint32_t> bits_dist;
+    for (uint32_t i = 0; i < 100000; ++i)
+    {
+        values.emplace_back(bits_float(bits_dist(rng)));
+    }
+    values.emplace_back(1.0f);
+
+    std::vector<uint16_t> reference(values.size());
+    for (size_t i = 0; i < values.size(); ++i)
+    {
+        reference[i] = float_to_half(values[i]);
+    }
+
+    for (HalfConversion conversion :
+         {HalfConversion::Scalar, HalfConversion::Sse2, HalfConversion::F16c})
+    {
+        if (conversion > best_half_conversion())
+        {
+            spdlog::info(
+                "half float conversion {} is not supported by this cpu",
+                static_cast<int>(conversion)
+            );
+            continue;
+        }
+        std::vector<uint16_t> halves(values.size());
+        floats_to_halves(values, halves, conversion);
+        CHECK(halves == reference);
+    }
+}
+
+} // namespace
+
+int main()
+{
+    test_scalar();
+    test_simd();
+    return Arctic::Test::exit_code();
+}
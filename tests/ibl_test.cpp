@@ -0,0 +1,190 @@
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <vector>
+
+#include "check.hpp"
+#include "job_system.hpp"
+#include "renderer/ibl.hpp"
+
+using namespace Arctic;
+using namespace Arctic::Renderer;
+
+namespace
+{
+
+// Small enough to be resampled into the smallest cube the precomputation accepts.
+constexpr uint32_t WIDTH = 512;
+constexpr uint32_t HEIGHT = 256;
+
+// Offsets of the fields of the cache header that the tests damage.
+constexpr size_t HEADER_MAGIC_OFFSET = 0;
+constexpr size_t HEADER_VERSION_OFFSET = 4;
+constexpr size_t HEADER_SPECULAR_SIZE_OFFSET = 16;
+constexpr size_t HEADER_BRDF_LUT_SIZE_OFFSET = 24;
+
+// Sky with a horizon gradient, a small and very bright sun and a noisy ground.
+std::vector<float> generate_environment()
+{
+    std::vector<float> pixels(4ull * WIDTH * HEIGHT);
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> noise(0.8f, 1.2f);
+    for (uint32_t y = 0; y < HEIGHT; ++y)
+    {
+        float elevation = 0.5f - (static_cast<float>(y) + 0.5f) / static_cast<float>(HEIGHT);
+        for (uint32_t x = 0; x < WIDTH; ++x)
+        {
+            float azimuth = (static_cast<float>(x) + 0.5f) / static_cast<float>(WIDTH);
+            float *pixel = pixels.data() + 4ull * (size_t{y} * WIDTH + x);
+            float ground = 0.1f * noise(rng);
+            float t = std::sqrt(std::abs(elevation) * 2.0f);
+            pixel[0] = elevation < 0.0f ? ground : 0.8f - 0.6f * t;
+            pixel[1] = elevation < 0.0f ? 0.8f * ground : 0.9f - 0.5f * t;
+            pixel[2] = elevation < 0.0f ? 0.6f * ground : 1.0f - 0.2f * t;
+            float dx = azimuth - 0.3f;
+            float dy = elevation - 0.25f;
+            if (dx * dx + dy * dy < 0.0004f)
+            {
+                pixel[0] = pixel[1] = pixel[2] = 5000.0f;
+            }
+            pixel[3] = 1.0f;
+        }
+    }
+    return pixels;
+}
+
+IblData compute(const std::vector<float> &environment, JobSystem &jobs, bool use_simd)
+{
+    CubeMap cube;
+    equirect_to_cube(environment, WIDTH, HEIGHT, environment_cube_size(WIDTH), jobs, cube);
+    IblData data;
+    IblStats stats;
+    compute_ibl(cube, jobs, data, stats, use_simd);
+    return data;
+}
+
+bool same_data(const IblData &a, const IblData &b)
+{
+    return a.irradiance_sh == b.irradiance_sh && a.specular == b.specular &&
+           a.brdf_lut == b.brdf_lut;
+}
+
+std::vector<uint8_t> read_file(const std::filesystem::path &path)
+{
+    std::ifstream file(path, std::ios::binary);
+    return std::vector<uint8_t>(std::istreambuf_iterator<char>(file), {});
+}
+
+void write_file(const std::filesystem::path &path, const std::vector<uint8_t> &bytes)
+{
+    std::ofstream file(path, std::ios::binary);
+    file.write(
+        reinterpret_cast<const char *>(bytes.data()),
+        static_cast<std::streamsize>(bytes.size())
+    );
+}
+
+// The SSE2 paths on one and on all threads produce exactly the results of the scalar reference.
+IblData test_simd_matches_scalar(const std::vector<float> &environment)
+{
+    JobSystem single_thread(1);
+    JobSystem all_threads;
+
+    IblData reference = compute(environment, single_thread, false);
+    CHECK(reference.specular.size() > 0);
+    CHECK(
+        reference.brdf_lut.size() == 2 * size_t{IBL_BRDF_LUT_SIZE} * size_t{IBL_BRDF_LUT_SIZE}
+    );
+    CHECK(same_data(compute(environment, single_thread, true), reference));
+    CHECK(same_data(compute(environment, all_threads, true), reference));
+    return reference;
+}
+
+// The key changes with every texel and with the dimensions, even if the data stays the same.
+void test_key(const std::vector<float> &environment)
+{
+    uint64_t key = ibl_cache_key(environment, WIDTH, HEIGHT);
+    CHECK(ibl_cache_key(environment, WIDTH, HEIGHT) == key);
+    CHECK(ibl_cache_key(environment, HEIGHT, WIDTH) != key);
+    CHECK(ibl_cache_key(environment, 2 * WIDTH, HEIGHT / 2) != key);
+
+    std::vector<float> changed = environment;
+    changed[4ull * (HEIGHT / 2 * WIDTH + 7) + 1] += 0.001f;
+    CHECK(ibl_cache_key(changed, WIDTH, HEIGHT) != key);
+}
+
+// A cache comes back as it was written, and anything that does not match exactly what the
+// current version would write for the same environment is rejected, so stale lighting is never
+// served.
+void test_cache(
+    const std::filesystem::path &directory, const std::vector<float> &environment,
+    const IblData &data
+)
+{
+    uint64_t key = ibl_cache_key(environment, WIDTH, HEIGHT);
+    std::filesystem::path path = directory / "environment.ibl";
+    CHECK(save_ibl_cache(path, key, data));
+
+    IblData cached;
+    CHECK(load_ibl_cache(path, key, cached));
+    CHECK(same_data(cached, data));
+
+    IblData rejected;
+    CHECK(!load_ibl_cache(directory / "missing.ibl", key, rejected));
+    CHECK(!load_ibl_cache(path, key + 1, rejected));
+    CHECK(!load_ibl_cache(path, ibl_cache_key(environment, HEIGHT, WIDTH), rejected));
+
+    std::vector<uint8_t> bytes = read_file(path);
+    std::filesystem::path damaged_path = directory / "damaged.ibl";
+    auto rejects = [&](const std::vector<uint8_t> &damaged) {
+        write_file(damaged_path, damaged);
+        return !load_ibl_cache(damaged_path, key, rejected);
+    };
+    auto with_field = [&](size_t offset, uint32_t value) {
+        std::vector<uint8_t> damaged = bytes;
+        std::memcpy(damaged.data() + offset, &value, sizeof(value));
+        return damaged;
+    };
+
+    // Cut off in the header, in the texture data and by a single byte, and one byte too long.
+    CHECK(rejects(std::vector<uint8_t>(bytes.begin(), bytes.begin() + 12)));
+    CHECK(rejects(std::vector<uint8_t>(bytes.begin(), bytes.begin() + bytes.size() / 2)));
+    CHECK(rejects(std::vector<uint8_t>(bytes.begin(), bytes.end() - 1)));
+    std::vector<uint8_t> longer = bytes;
+    longer.emplace_back(0);
+    CHECK(rejects(longer));
+    CHECK(rejects({}));
+
+    CHECK(rejects(with_field(HEADER_MAGIC_OFFSET, 0x46464952)));
+    CHECK(rejects(with_field(HEADER_VERSION_OFFSET, 0)));
+    CHECK(rejects(with_field(HEADER_SPECULAR_SIZE_OFFSET, IBL_SPECULAR_SIZE / 2)));
+    CHECK(rejects(with_field(HEADER_BRDF_LUT_SIZE_OFFSET, IBL_BRDF_LUT_SIZE * 2)));
+
+    // The unchanged copy still loads, so the rejections above come from the damage.
+    CHECK(!rejects(bytes));
+
+    // Data in a different layout is not written in the first place.
+    IblData incomplete = data;
+    incomplete.specular.pop_back();
+    CHECK(!save_ibl_cache(directory / "incomplete.ibl", key, incomplete));
+}
+
+} // namespace
+
+int main()
+{
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / "arctic_ibl_test";
+    std::filesystem::create_directories(directory);
+
+    std::vector<float> environment = generate_environment();
+    IblData data = test_simd_matches_scalar(environment);
+    test_key(environment);
+    test_cache(directory, environment, data);
+
+    std::filesystem::remove_all(directory);
+    return Arctic::Test::exit_code();
+}
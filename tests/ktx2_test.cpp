@@ -0,0 +1,115 @@
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+#include "check.hpp"
+#include "renderer/ktx2.hpp"
+
+using namespace Arctic::Renderer;
+
+namespace
+{
+
+constexpr uint32_t VK_FORMAT_R8G8B8A8_UNORM = 37;
+constexpr uint32_t VK_FORMAT_BC1_RGB_UNORM_BLOCK = 131;
+
+void append(std::vector<uint8_t> &bytes, const void *data, size_t size)
+{
+    const auto *begin = static_cast<const uint8_t *>(data);
+    bytes.insert(bytes.end(), begin, begin + size);
+}
+
+// Writes a KTX2 file with a single stored level, which is the base level of a file with a
+// level count of zero.
+void write_ktx2(
+    const std::filesystem::path &path, uint32_t vk_format, uint32_t width, uint32_t height,
+    uint32_t level_count, const std::vector<uint8_t> &level
+)
+{
+    static constexpr uint8_t IDENTIFIER[12] = {
+        0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n',
+    };
+    const uint32_t header[9] = {vk_format, 1, width, height, 0, 0, 1, level_count, 0};
+    const uint32_t index[8] = {};
+    const uint64_t level_index[3] = {12 + 36 + 32 + 24, level.size(), level.size()};
+
+    std::vector<uint8_t> bytes;
+    append(bytes, IDENTIFIER, sizeof(IDENTIFIER));
+    append(bytes, header, sizeof(header));
+    append(bytes, index, sizeof(index));
+    append(bytes, level_index, sizeof(level_index));
+    append(bytes, level.data(), level.size());
+
+    std::ofstream file(path, std::ios::binary);
+    file.write(
+        reinterpret_cast<const char *>(bytes.data()),
+        static_cast<std::streamsize>(bytes.size())
+    );
+}
+
+// A level count of zero generates the whole chain from the base level.
+void test_generated_mips(const std::filesystem::path &directory)
+{
+    std::vector<uint8_t> base;
+    for (uint32_t texel = 0; texel < 8 * 4; ++texel)
+    {
+        base.insert(base.end(), {10, 20, 30, 40});
+    }
+    std::filesystem::path path = directory / "generated.ktx2";
+    write_ktx2(path, VK_FORMAT_R8G8B8A8_UNORM, 8, 4, 0, base);
+
+    TextureImage image;
+    CHECK(load_ktx2(path, image));
+    CHECK(image.format == TextureFormat::R8G8B8A8Unorm);
+    CHECK(image.levels.size() == 4);
+    if (image.levels.size() != 4)
+    {
+        return;
+    }
+    CHECK(image.levels[1].width == 4 && image.levels[1].height == 2);
+    CHECK(image.levels[3].width == 1 && image.levels[3].height == 1);
+    // The generated levels are owned by the image instead of referencing the file.
+    CHECK(image.file == nullptr);
+    std::span<const uint8_t> last = image.level_data(3);
+    CHECK(last.size() == 4 && last[0] == 10 && last[1] == 20 && last[2] == 30 && last[3] == 40);
+}
+
+// A file with its levels stored references them in place.
+void test_stored_level(const std::filesystem::path &directory)
+{
+    std::vector<uint8_t> base(4 * 4 * 4, 0x7f);
+    std::filesystem::path path = directory / "stored.ktx2";
+    write_ktx2(path, VK_FORMAT_R8G8B8A8_UNORM, 4, 4, 1, base);
+
+    TextureImage image;
+    CHECK(load_ktx2(path, image));
+    CHECK(image.levels.size() == 1);
+    CHECK(image.file != nullptr);
+}
+
+// Block compressed levels can not be downsampled, so asking for generated mips is an error.
+void test_generated_block_compressed_mips(const std::filesystem::path &directory)
+{
+    std::vector<uint8_t> block(8, 0);
+    std::filesystem::path path = directory / "bc1.ktx2";
+    write_ktx2(path, VK_FORMAT_BC1_RGB_UNORM_BLOCK, 4, 4, 0, block);
+
+    TextureImage image;
+    CHECK(!load_ktx2(path, image));
+}
+
+} // namespace
+
+int main()
+{
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / "arctic_ktx2_test";
+    std::filesystem::create_directories(directory);
+
+    test_generated_mips(directory);
+    test_stored_level(directory);
+    test_generated_block_compressed_mips(directory);
+
+    std::filesystem::remove_all(directory);
+    return Arctic::Test::exit_code();
+}
@@ -0,0 +1,176 @@
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <span>
+#include <vector>
+
+#include "check.hpp"
+#include "renderer/mesh_optimizer.hpp"
+#include "renderer/procedural_mesh.hpp"
+
+using namespace Arctic::Renderer;
+
+namespace
+{
+
+constexpr uint32_t INVALID_INDEX = std::numeric_limits<uint32_t>::max();
+
+// The triangles of a triangle list with each one rotated to start at its smallest index, sorted,
+// so that lists with the same triangles in a different order and rotation compare equal. Which
+// way the triangles wind is kept.
+std::vector<std::array<uint32_t, 3>> canonical_triangles(std::span<const uint32_t> indices)
+{
+    std::vector<std::array<uint32_t, 3>> triangles;
+    triangles.reserve(indices.size() / 3);
+    for (size_t i = 0; i + 2 < indices.size(); i += 3)
+    {
+        std::array<uint32_t, 3> triangle{indices[i], indices[i + 1], indices[i + 2]};
+        std::rotate(
+            triangle.begin(), std::min_element(triangle.begin(), triangle.end()), triangle.end()
+        );
+        triangles.emplace_back(triangle);
+    }
+    std::sort(triangles.begin(), triangles.end());
+    return triangles;
+}
+
+// A torus with its triangles shuffled and rotated, which is about as bad for the vertex cache as
+// an index buffer gets.
+void shuffled_torus(std::vector<Vertex> &out_vertices, std::vector<uint32_t> &out_indices)
+{
+    generate_torus(64, 32, 2.0f, 0.75f, out_vertices, out_indices);
+
+    std::mt19937 rng(1234);
+    size_t triangle_count = out_indices.size() / 3;
+    std::vector<size_t> order(triangle_count);
+    for (size_t t = 0; t < triangle_count; ++t)
+    {
+        order[t] = t;
+    }
+    std::shuffle(order.begin(), order.end(), rng);
+
+    std::vector<uint32_t> shuffled;
+    shuffled.reserve(out_indices.size());
+    for (size_t t : order)
+    {
+        size_t rotation = rng() % 3;
+        for (size_t k = 0; k < 3; ++k)
+        {
+            shuffled.emplace_back(out_indices[3 * t + (k + rotation) % 3]);
+        }
+    }
+    out_indices = std::move(shuffled);
+}
+
+// The cache order keeps the triangles and brings the ACMR well below the one of the shuffled input.
+void test_vertex_cache(std::span<const uint32_t> input, uint32_t vertex_count)
+{
+    std::vector<uint32_t> indices(input.begin(), input.end());
+    optimize_vertex_cache(indices, vertex_count);
+    CHECK(canonical_triangles(indices) == canonical_triangles(input));
+
+    VertexCacheStats before = analyze_vertex_cache(input, vertex_count, VERTEX_CACHE_SIZE);
+    VertexCacheStats after = analyze_vertex_cache(indices, vertex_count, VERTEX_CACHE_SIZE);
+    CHECK(after.acmr < before.acmr);
+    CHECK(after.atvr < before.atvr);
+    CHECK(after.acmr >= 0.5f && after.acmr <= 3.0f);
+    CHECK(after.atvr >= 1.0f);
+}
+
+// Reordering clusters keeps the triangles and costs no more than the threshold in ACMR.
+void test_overdraw(std::span<const uint32_t> input, std::span<const Vertex> vertices)
+{
+    uint32_t vertex_count = static_cast<uint32_t>(vertices.size());
+    std::vector<uint32_t> indices(input.begin(), input.end());
+    optimize_vertex_cache(indices, vertex_count);
+    VertexCacheStats cache_order = analyze_vertex_cache(indices, vertex_count, VERTEX_CACHE_SIZE);
+
+    std::vector<uint32_t> cache_indices = indices;
+    optimize_overdraw(indices, vertices, OVERDRAW_ACMR_THRESHOLD);
+    CHECK(canonical_triangles(indices) == canonical_triangles(cache_indices));
+
+    VertexCacheStats overdraw_order =
+        analyze_vertex_cache(indices, vertex_count, VERTEX_CACHE_SIZE);
+    CHECK(overdraw_order.acmr <= cache_order.acmr * OVERDRAW_ACMR_THRESHOLD);
+}
+
+// Vertices end up in the order they are first referenced, unreferenced ones are dropped, and the
+// indices point at the same vertex data as before.
+void test_vertex_fetch(std::span<const uint32_t> input, std::span<const Vertex> input_vertices)
+{
+    // Vertices that no triangle uses, in front of and behind the used ones.
+    std::vector<Vertex> vertices;
+    Vertex unused{};
+    unused.position = glm::vec3(100.0f);
+    vertices.emplace_back(unused);
+    vertices.insert(vertices.end(), input_vertices.begin(), input_vertices.end());
+    vertices.emplace_back(unused);
+    std::vector<uint32_t> original_indices(input.begin(), input.end());
+    for (uint32_t &index : original_indices)
+    {
+        ++index;
+    }
+    std::vector<Vertex> original_vertices = vertices;
+
+    std::vector<uint32_t> indices = original_indices;
+    optimize_vertex_fetch(indices, vertices);
+    CHECK(vertices.size() == input_vertices.size());
+    CHECK(indices.size() == original_indices.size());
+
+    std::vector<uint32_t> remap(original_vertices.size(), INVALID_INDEX);
+    std::vector<uint32_t> inverse(vertices.size(), INVALID_INDEX);
+    uint32_t next_vertex = 0;
+    for (size_t i = 0; i < indices.size(); ++i)
+    {
+        uint32_t from = original_indices[i];
+        uint32_t to = indices[i];
+        CHECK(to < vertices.size());
+        if (to >= vertices.size())
+        {
+            continue;
+        }
+        CHECK(std::memcmp(&vertices[to], &original_vertices[from], sizeof(Vertex)) == 0);
+
+        if (remap[from] == INVALID_INDEX)
+        {
+            // The first reference to a vertex takes the next free slot.
+            CHECK(to == next_vertex);
+            ++next_vertex;
+            CHECK(inverse[to] == INVALID_INDEX);
+            remap[from] = to;
+            inverse[to] = from;
+        }
+        CHECK(remap[from] == to);
+        CHECK(inverse[to] == from);
+    }
+    CHECK(next_vertex == vertices.size());
+    CHECK(remap.front() == INVALID_INDEX);
+    CHECK(remap.back() == INVALID_INDEX);
+}
+
+} // namespace
+
+int main()
+{
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+    shuffled_torus(vertices, indices);
+    uint32_t vertex_count = static_cast<uint32_t>(vertices.size());
+
+    test_vertex_cache(indices, vertex_count);
+    test_overdraw(indices, vertices);
+    test_vertex_fetch(indices, vertices);
+
+    // All of them together, the way meshes are optimized at load.
+    std::vector<Vertex> optimized_vertices = vertices;
+    std::vector<uint32_t> optimized_indices = indices;
+    MeshOptimizationStats stats = optimize_mesh(optimized_vertices, optimized_indices);
+    CHECK(optimized_vertices.size() == vertices.size());
+    CHECK(optimized_indices.size() == indices.size());
+    CHECK(stats.after.acmr < stats.before.acmr);
+
+    return Arctic::Test::exit_code();
+}
@@ -0,0 +1,228 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+#include <glm/geometric.hpp>
+
+#include "check.hpp"
+#include "renderer/mesh_simplifier.hpp"
+#include "renderer/procedural_mesh.hpp"
+
+using namespace Arctic::Renderer;
+
+namespace
+{
+
+// Tolerance for rounding in the distance checks, relative to the size of the meshes.
+constexpr float EPSILON = 1.0e-4f;
+
+struct Mesh
+{
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+};
+
+// Vertices that share their position with another vertex, which is what the seams between the
+// faces of the box are made of.
+std::vector<uint32_t> seam_vertices(std::span<const Vertex> vertices)
+{
+    std::vector<uint32_t> seams;
+    for (uint32_t a = 0; a < vertices.size(); ++a)
+    {
+        for (uint32_t b = 0; b < vertices.size(); ++b)
+        {
+            if (a != b && vertices[a].position == vertices[b].position)
+            {
+                seams.emplace_back(a);
+                break;
+            }
+        }
+    }
+    return seams;
+}
+
+// Distance of `p` to a triangle, from the closest of its plane within the triangle, its edges and
+// its corners. Kept independent of the simplifier so the two do not share mistakes.
+float distance_to_triangle(
+    const glm::vec3 &p, const glm::vec3 &a, const glm::vec3 &b, const glm::vec3 &c
+)
+{
+    auto distance_to_segment = [&](const glm::vec3 &s0, const glm::vec3 &s1) {
+        glm::vec3 d = s1 - s0;
+        float length_squared = glm::dot(d, d);
+        float t = length_squared > 0.0f
+                      ? std::clamp(glm::dot(p - s0, d) / length_squared, 0.0f, 1.0f)
+                      : 0.0f;
+        return glm::length(p - (s0 + d * t));
+    };
+
+    float distance =
+        std::min({distance_to_segment(a, b), distance_to_segment(b, c), distance_to_segment(c, a)});
+    glm::vec3 normal = glm::cross(b - a, c - a);
+    float normal_length = glm::length(normal);
+    if (normal_length > 0.0f)
+    {
+        normal /= normal_length;
+        float plane_distance = glm::dot(p - a, normal);
+        glm::vec3 q = p - normal * plane_distance;
+        bool inside = glm::dot(glm::cross(b - a, q - a), normal) >= 0.0f &&
+                      glm::dot(glm::cross(c - b, q - b), normal) >= 0.0f &&
+                      glm::dot(glm::cross(a - c, q - c), normal) >= 0.0f;
+        if (inside)
+        {
+            distance = std::min(distance, std::abs(plane_distance));
+        }
+    }
+    return distance;
+}
+
+// Largest distance of the vertices of `mesh` to the surface of a level, against every triangle.
+float brute_force_distance(const Mesh &mesh, std::span<const uint32_t> level)
+{
+    float max_distance = 0.0f;
+    for (const Vertex &vertex : mesh.vertices)
+    {
+        float distance = std::numeric_limits<float>::max();
+        for (size_t i = 0; i < level.size(); i += 3)
+        {
+            distance = std::min(
+                distance,
+                distance_to_triangle(
+                    vertex.position,
+                    mesh.vertices[level[i]].position,
+                    mesh.vertices[level[i + 1]].position,
+                    mesh.vertices[level[i + 2]].position
+                )
+            );
+        }
+        max_distance = std::max(max_distance, distance);
+    }
+    return max_distance;
+}
+
+// Levels get strictly smaller, their errors never decrease and bound the actual distance of the
+// original vertices to them, every index stays in range, and the locked vertices are part of
+// every level.
+void test_lod_chain(const Mesh &original, std::span<const uint32_t> locked)
+{
+    Mesh mesh = original;
+    std::vector<MeshLod> lods;
+    generate_lod_chain(mesh.vertices, mesh.indices, lods);
+
+    CHECK(lods.size() > 1);
+    CHECK(lods.front().first_index == 0);
+    CHECK(lods.front().index_count == original.indices.size());
+    CHECK(lods.front().error == 0.0f);
+    CHECK(std::equal(original.indices.begin(), original.indices.end(), mesh.indices.begin()));
+
+    for (size_t lod_idx = 0; lod_idx < lods.size(); ++lod_idx)
+    {
+        const MeshLod &lod = lods[lod_idx];
+        CHECK(lod.index_count % 3 == 0);
+        CHECK(lod.index_count > 0);
+        CHECK(static_cast<size_t>(lod.first_index) + lod.index_count <= mesh.indices.size());
+        std::span<const uint32_t> level(mesh.indices.data() + lod.first_index, lod.index_count);
+        for (uint32_t index : level)
+        {
+            CHECK(index < mesh.vertices.size());
+        }
+        for (uint32_t vertex : locked)
+        {
+            CHECK(std::find(level.begin(), level.end(), vertex) != level.end());
+        }
+
+        if (lod_idx == 0)
+        {
+            continue;
+        }
+        const MeshLod &previous = lods[lod_idx - 1];
+        CHECK(lod.first_index == previous.first_index + previous.index_count);
+        CHECK(lod.index_count < previous.index_count);
+        CHECK(lod.error >= previous.error);
+        CHECK(brute_force_distance(original, level) <= lod.error + EPSILON);
+    }
+}
+
+// A single call keeps the locked vertices where they are and only collapses others onto kept
+// vertices, with the reported error staying within the limit.
+void test_simplify(const Mesh &mesh, std::span<const uint32_t> locked, float max_error)
+{
+    std::vector<uint32_t> indices;
+    std::vector<uint32_t> remap;
+    float error = simplify_mesh(mesh.vertices, mesh.indices, 0, max_error, indices, remap);
+
+    CHECK(error <= max_error);
+    CHECK(indices.size() < mesh.indices.size());
+    CHECK(indices.size() % 3 == 0);
+    CHECK(remap.size() == mesh.vertices.size());
+    for (uint32_t vertex : locked)
+    {
+        CHECK(remap[vertex] == vertex);
+    }
+    for (uint32_t v = 0; v < remap.size(); ++v)
+    {
+        CHECK(remap[v] < mesh.vertices.size());
+        CHECK(remap[remap[v]] == remap[v]);
+    }
+    for (size_t i = 0; i < indices.size(); i += 3)
+    {
+        CHECK(indices[i] != indices[i + 1]);
+        CHECK(indices[i + 1] != indices[i + 2]);
+        CHECK(indices[i] != indices[i + 2]);
+        for (size_t k = 0; k < 3; ++k)
+        {
+            CHECK(indices[i + k] < mesh.vertices.size());
+            CHECK(remap[indices[i + k]] == indices[i + k]);
+        }
+    }
+}
+
+// The first face of a box on its own is a flat grid with an open border all around.
+Mesh open_grid(uint32_t subdivisions, std::vector<uint32_t> &out_border)
+{
+    Mesh box;
+    generate_box(subdivisions, 1.0f, box.vertices, box.indices);
+
+    Mesh grid;
+    uint32_t side = subdivisions + 1;
+    grid.vertices.assign(box.vertices.begin(), box.vertices.begin() + side * side);
+    grid.indices.assign(box.indices.begin(), box.indices.begin() + 6 * subdivisions * subdivisions);
+    for (uint32_t j = 0; j < side; ++j)
+    {
+        for (uint32_t i = 0; i < side; ++i)
+        {
+            if (i == 0 || j == 0 || i == subdivisions || j == subdivisions)
+            {
+                out_border.emplace_back(j * side + i);
+            }
+        }
+    }
+    return grid;
+}
+
+} // namespace
+
+int main()
+{
+    Mesh torus;
+    generate_torus(64, 32, 2.0f, 0.75f, torus.vertices, torus.indices);
+    test_lod_chain(torus, {});
+    test_simplify(torus, {}, 0.1f);
+
+    Mesh box;
+    generate_box(8, 1.0f, box.vertices, box.indices);
+    std::vector<uint32_t> seams = seam_vertices(box.vertices);
+    CHECK(!seams.empty());
+    test_lod_chain(box, seams);
+    test_simplify(box, seams, 0.1f);
+
+    std::vector<uint32_t> border;
+    Mesh grid = open_grid(8, border);
+    test_lod_chain(grid, border);
+    test_simplify(grid, border, 0.1f);
+
+    return Arctic::Test::exit_code();
+}
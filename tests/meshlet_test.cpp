@@ -0,0 +1,212 @@
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include <glm/ext/matrix_clip_space.hpp>
+#include <glm/ext/matrix_transform.hpp>
+#include <glm/geometric.hpp>
+#include <glm/matrix.hpp>
+#include <glm/vec4.hpp>
+
+#include "check.hpp"
+#include "renderer/mesh_optimizer.hpp"
+#include "renderer/meshlet.hpp"
+#include "renderer/procedural_mesh.hpp"
+
+using namespace Arctic::Renderer;
+
+namespace
+{
+
+// Tolerance for rounding in the checks, relative to the size of the torus.
+constexpr float EPSILON = 1.0e-4f;
+
+struct Torus
+{
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+    MeshletData data;
+    // The triangles of all meshlets in their order, as indices into `vertices`.
+    std::vector<uint32_t> rebuilt;
+};
+
+Torus build_torus()
+{
+    Torus torus;
+    generate_torus(256, 128, 2.0f, 0.75f, torus.vertices, torus.indices);
+    optimize_vertex_cache(torus.indices, static_cast<uint32_t>(torus.vertices.size()));
+    CHECK(build_meshlets(torus.vertices, torus.indices, torus.data) == 0);
+
+    for (const Meshlet &meshlet : torus.data.meshlets)
+    {
+        for (uint32_t i = 0; i < meshlet.triangle_count; ++i)
+        {
+            uint32_t triangle = torus.data.triangles[meshlet.triangle_offset + i];
+            for (uint32_t k = 0; k < 3; ++k)
+            {
+                uint32_t local_index = (triangle >> (8 * k)) & 0xff;
+                torus.rebuilt.emplace_back(
+                    torus.data.vertices[meshlet.vertex_offset + local_index]
+                );
+            }
+        }
+    }
+    return torus;
+}
+
+// Meshlets stay within the limits, reproduce the original triangles and are contained in their
+// bounding spheres.
+void test_build(const Torus &torus)
+{
+    CHECK(!torus.data.meshlets.empty());
+    CHECK(torus.data.bounds.size() == torus.data.meshlets.size());
+    CHECK(torus.rebuilt == torus.indices);
+
+    for (size_t meshlet_idx = 0; meshlet_idx < torus.data.meshlets.size(); ++meshlet_idx)
+    {
+        const Meshlet &meshlet = torus.data.meshlets[meshlet_idx];
+        const MeshletBounds &bounds = torus.data.bounds[meshlet_idx];
+        CHECK(meshlet.vertex_count <= MESHLET_MAX_VERTICES);
+        CHECK(meshlet.triangle_count <= MESHLET_MAX_TRIANGLES);
+        for (uint32_t i = 0; i < meshlet.triangle_count; ++i)
+        {
+            uint32_t triangle = torus.data.triangles[meshlet.triangle_offset + i];
+            for (uint32_t k = 0; k < 3; ++k)
+            {
+                uint32_t local_index = (triangle >> (8 * k)) & 0xff;
+                CHECK(local_index < meshlet.vertex_count);
+            }
+        }
+        for (uint32_t i = 0; i < meshlet.vertex_count; ++i)
+        {
+            uint32_t vertex = torus.data.vertices[meshlet.vertex_offset + i];
+            CHECK(
+                glm::length(torus.vertices[vertex].position - bounds.center) <=
+                bounds.radius + EPSILON
+            );
+        }
+    }
+}
+
+// Meshlets culled by a cone test must not have a single triangle facing the camera, and meshlets
+// culled by the frustum not a single vertex inside it. The views are set up the way the renderer
+// does it, in world space with the cone tests done in object space.
+void test_culling(const Torus &torus)
+{
+    static constexpr uint32_t VIEW_COUNT = 64;
+
+    glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(1.0f, -2.0f, 3.0f));
+    model = glm::rotate(model, 0.7f, glm::vec3(1.0f, 2.0f, 3.0f));
+    model = glm::scale(model, glm::vec3(1.5f));
+    CHECK(meshlet_cone_culling_allowed(model));
+    glm::mat4 object_from_world = glm::inverse(model);
+
+    std::mt19937 rng(1234);
+    std::normal_distribution<float> normal_dist(0.0f, 1.0f);
+    std::uniform_real_distribution<float> distance_dist(6.0f, 18.0f);
+    auto random_direction = [&] {
+        return glm::normalize(glm::vec3(normal_dist(rng), normal_dist(rng), normal_dist(rng)));
+    };
+    auto world_position = [&](uint32_t vertex) {
+        return glm::vec3(model * glm::vec4(torus.vertices[vertex].position, 1.0f));
+    };
+    auto world_normal = [&](const uint32_t *triangle) {
+        glm::vec3 p0 = world_position(triangle[0]);
+        return glm::cross(world_position(triangle[1]) - p0, world_position(triangle[2]) - p0);
+    };
+
+    size_t cone_culled = 0;
+    size_t directional_culled = 0;
+    size_t frustum_culled = 0;
+    for (uint32_t view = 0; view < VIEW_COUNT; ++view)
+    {
+        glm::vec3 eye = glm::vec3(model[3]) + random_direction() * distance_dist(rng);
+        glm::vec3 direction = random_direction();
+        glm::mat4 proj_view =
+            glm::perspectiveRH(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 100.0f) *
+            glm::lookAtRH(eye, eye + random_direction(), glm::vec3(0.0f, 1.0f, 0.0f));
+        glm::vec3 object_eye(object_from_world * glm::vec4(eye, 1.0f));
+        glm::vec3 object_direction(object_from_world * glm::vec4(direction, 0.0f));
+
+        for (size_t meshlet_idx = 0; meshlet_idx < torus.data.meshlets.size(); ++meshlet_idx)
+        {
+            const Meshlet &meshlet = torus.data.meshlets[meshlet_idx];
+            const MeshletBounds &bounds = torus.data.bounds[meshlet_idx];
+            const uint32_t *first_index = torus.rebuilt.data() + 3ull * meshlet.triangle_offset;
+
+            if (meshlet_cone_culled(bounds, object_eye))
+            {
+                ++cone_culled;
+                for (uint32_t i = 0; i < meshlet.triangle_count; ++i)
+                {
+                    const uint32_t *triangle = first_index + 3ull * i;
+                    glm::vec3 to_eye = eye - world_position(triangle[0]);
+                    CHECK(glm::dot(to_eye, world_normal(triangle)) <= EPSILON);
+                }
+            }
+            if (meshlet_cone_culled_directional(bounds, object_direction))
+            {
+                ++directional_culled;
+                for (uint32_t i = 0; i < meshlet.triangle_count; ++i)
+                {
+                    const uint32_t *triangle = first_index + 3ull * i;
+                    CHECK(glm::dot(-direction, world_normal(triangle)) <= EPSILON);
+                }
+            }
+
+            if (sphere_outside_frustum(proj_view * model, bounds.center, bounds.radius))
+            {
+                ++frustum_culled;
+                for (uint32_t i = 0; i < meshlet.vertex_count; ++i)
+                {
+                    uint32_t vertex = torus.data.vertices[meshlet.vertex_offset + i];
+                    glm::vec4 clip = proj_view * glm::vec4(world_position(vertex), 1.0f);
+                    CHECK(
+                        !(std::abs(clip.x) < clip.w && std::abs(clip.y) < clip.w &&
+                          clip.z > 0.0f && clip.z < clip.w)
+                    );
+                }
+            }
+        }
+    }
+
+    // The tests have to cull something to be checked at all.
+    CHECK(cone_culled > 0);
+    CHECK(directional_culled > 0);
+    CHECK(frustum_culled > 0);
+}
+
+// Only transforms that keep angles and the facing of triangles allow cone culling.
+void test_cone_culling_allowed()
+{
+    glm::mat4 identity(1.0f);
+    CHECK(meshlet_cone_culling_allowed(identity));
+    CHECK(meshlet_cone_culling_allowed(glm::scale(
+        glm::rotate(glm::translate(identity, glm::vec3(5.0f)), 1.0f, glm::vec3(0.0f, 1.0f, 0.0f)),
+        glm::vec3(0.01f)
+    )));
+
+    CHECK(!meshlet_cone_culling_allowed(glm::scale(identity, glm::vec3(1.0f, 2.0f, 1.0f))));
+    CHECK(!meshlet_cone_culling_allowed(glm::scale(
+        glm::rotate(identity, 0.5f, glm::vec3(1.0f, 0.0f, 0.0f)),
+        glm::vec3(3.0f, 3.0f, 3.1f)
+    )));
+    CHECK(!meshlet_cone_culling_allowed(glm::scale(identity, glm::vec3(-1.0f, 1.0f, 1.0f))));
+    CHECK(!meshlet_cone_culling_allowed(glm::scale(identity, glm::vec3(0.0f))));
+
+    glm::mat4 shear(1.0f);
+    shear[1][0] = 0.5f;
+    CHECK(!meshlet_cone_culling_allowed(shear));
+}
+
+} // namespace
+
+int main()
+{
+    Torus torus = build_torus();
+    test_build(torus);
+    test_culling(torus);
+    test_cone_culling_allowed();
+    return Arctic::Test::exit_code();
+}
@@ -0,0 +1,148 @@
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <random>
+#include <span>
+#include <vector>
+
+#include "check.hpp"
+#include "renderer/mip_chain.hpp"
+
+using namespace Arctic::Renderer;
+
+namespace
+{
+
+std::vector<uint8_t> random_image(uint32_t width, uint32_t height, std::mt19937 &rng)
+{
+    std::uniform_int_distribution<uint32_t> dist(0, 255);
+    std::vector<uint8_t> image(4ull * width * height);
+    for (uint8_t &value : image)
+    {
+        value = static_cast<uint8_t>(dist(rng));
+    }
+    return image;
+}
+
+// The SIMD downsampler matches the scalar reference, including the texels at the ends of odd rows
+// and columns that only the scalar kernels handle.
+void test_downsample_matches_scalar(
+    uint32_t width, uint32_t height, MipColorSpace color_space, std::mt19937 &rng
+)
+{
+    std::vector<uint8_t> src = random_image(width, height, rng);
+    size_t dst_size = 4ull * std::max(1u, width / 2) * std::max(1u, height / 2);
+    // One texel more than needed, to catch writes past the end of the level.
+    std::vector<uint8_t> scalar(dst_size + 4, 0xcd);
+    std::vector<uint8_t> simd(dst_size + 4, 0xcd);
+    downsample_rgba8_scalar(src.data(), width, height, scalar.data(), color_space);
+    downsample_rgba8(src.data(), width, height, simd.data(), color_space);
+    CHECK(simd == scalar);
+    CHECK(simd[dst_size] == 0xcd);
+}
+
+// Levels halve down to 1x1 and are packed back to back, the first one is the source and every
+// other one is the downsampled level before it.
+void test_chain(uint32_t width, uint32_t height, MipColorSpace color_space, std::mt19937 &rng)
+{
+    std::vector<uint8_t> src = random_image(width, height, rng);
+    MipChain chain;
+    generate_mip_chain(src.data(), width, height, color_space, chain);
+
+    CHECK(chain.levels.size() == mip_count(width, height));
+    CHECK(chain.levels.front().width == width);
+    CHECK(chain.levels.front().height == height);
+    CHECK(chain.levels.back().width == 1);
+    CHECK(chain.levels.back().height == 1);
+
+    std::span<const uint8_t> first = chain.level_data(0);
+    CHECK(std::equal(first.begin(), first.end(), src.begin(), src.end()));
+
+    uint64_t offset = 0;
+    for (size_t level = 0; level < chain.levels.size(); ++level)
+    {
+        const MipLevel &mip = chain.levels[level];
+        CHECK(mip.offset == offset);
+        offset += 4ull * mip.width * mip.height;
+        if (level == 0)
+        {
+            continue;
+        }
+
+        const MipLevel &previous = chain.levels[level - 1];
+        CHECK(mip.width == std::max(1u, previous.width / 2));
+        CHECK(mip.height == std::max(1u, previous.height / 2));
+        std::vector<uint8_t> expected(4ull * mip.width * mip.height);
+        downsample_rgba8_scalar(
+            chain.level_data(level - 1).data(),
+            previous.width,
+            previous.height,
+            expected.data(),
+            color_space
+        );
+        std::span<const uint8_t> actual = chain.level_data(level);
+        CHECK(std::equal(actual.begin(), actual.end(), expected.begin(), expected.end()));
+    }
+    CHECK(chain.data.size() == offset);
+}
+
+// A flat color stays the same in both color spaces, and black and white average to the middle of
+// the linear range, which in sRGB is much brighter than the middle of the stored values. Alpha is
+// always averaged as stored.
+void test_values()
+{
+    for (MipColorSpace color_space : {MipColorSpace::Linear, MipColorSpace::Srgb})
+    {
+        for (uint32_t value = 0; value < 256; ++value)
+        {
+            std::vector<uint8_t> src(4 * 4, static_cast<uint8_t>(value));
+            std::array<uint8_t, 4> dst{};
+            downsample_rgba8(src.data(), 2, 2, dst.data(), color_space);
+            CHECK(dst == (std::array<uint8_t, 4>{src[0], src[0], src[0], src[0]}));
+        }
+    }
+
+    std::array<uint8_t, 16> checker{
+        0, 0, 0, 0, 255, 255, 255, 255, 255, 255, 255, 255, 0, 0, 0, 0,
+    };
+    std::array<uint8_t, 4> linear{};
+    downsample_rgba8(checker.data(), 2, 2, linear.data(), MipColorSpace::Linear);
+    CHECK(linear == (std::array<uint8_t, 4>{128, 128, 128, 128}));
+    std::array<uint8_t, 4> srgb{};
+    downsample_rgba8(checker.data(), 2, 2, srgb.data(), MipColorSpace::Srgb);
+    CHECK(srgb == (std::array<uint8_t, 4>{188, 188, 188, 128}));
+}
+
+} // namespace
+
+int main()
+{
+    // Powers of two, odd sizes, non-powers of two and strips only one texel wide or high.
+    static constexpr std::array<std::array<uint32_t, 2>, 12> SIZES{{
+        {1, 1},
+        {2, 2},
+        {1, 7},
+        {9, 1},
+        {3, 3},
+        {5, 9},
+        {17, 6},
+        {33, 31},
+        {100, 60},
+        {255, 257},
+        {256, 256},
+        {640, 360},
+    }};
+
+    std::mt19937 rng(1234);
+    for (MipColorSpace color_space : {MipColorSpace::Linear, MipColorSpace::Srgb})
+    {
+        for (const std::array<uint32_t, 2> &size : SIZES)
+        {
+            test_downsample_matches_scalar(size[0], size[1], color_space, rng);
+            test_chain(size[0], size[1], color_space, rng);
+        }
+    }
+    test_values();
+
+    return Arctic::Test::exit_code();
+}
@@ -0,0 +1,356 @@
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "check.hpp"
+#include "renderer/command_recorder.hpp"
+#include "renderer/frame_graph.hpp"
+#include "renderer/render_graph.hpp"
+
+using namespace Arctic::Renderer;
+
+namespace
+{
+
+class OrderRecorder final : public CommandRecorder
+{
+  public:
+    std::vector<uint32_t> begun;
+    std::vector<uint32_t> ended;
+    size_t barrier_batches{0};
+
+    void begin_pass(uint32_t pass_idx) override
+    {
+        begun.emplace_back(pass_idx);
+    }
+
+    void barriers(const std::vector<Barrier> &) override
+    {
+        ++barrier_batches;
+    }
+
+    void end_pass(uint32_t pass_idx) override
+    {
+        ended.emplace_back(pass_idx);
+    }
+};
+
+bool is_transition(
+    const Barrier &barrier, ResourceHandle resource, ResourceState before, ResourceState after
+)
+{
+    return barrier.type == Barrier::Type::Transition && barrier.resource.idx == resource.idx &&
+           barrier.before == before && barrier.after == after;
+}
+
+const TransientAllocation *find_transient(const CompiledGraph &compiled, ResourceHandle resource)
+{
+    auto it = std::find_if(
+        compiled.transients.begin(),
+        compiled.transients.end(),
+        [&](const TransientAllocation &allocation) {
+            return allocation.resource.idx == resource.idx;
+        }
+    );
+    return it == compiled.transients.end() ? nullptr : &*it;
+}
+
+size_t count_barriers(const CompiledPass &pass, Barrier::Type type)
+{
+    return static_cast<size_t>(std::count_if(
+        pass.barriers.begin(),
+        pass.barriers.end(),
+        [&](const Barrier &barrier) { return barrier.type == type; }
+    ));
+}
+
+// Passes run in declaration order and only touched resources get barriers.
+void test_pass_order()
+{
+    RenderGraph graph;
+    std::vector<int> executed;
+    ResourceHandle target = graph.import_resource("target", nullptr, ResourceState::Common);
+    graph.add_pass("first", [&] { executed.emplace_back(0); })
+        .write(target, ResourceState::RenderTarget);
+    graph.add_pass("second", [&] { executed.emplace_back(1); });
+    graph.add_pass("third", [&] { executed.emplace_back(2); })
+        .read(target, ResourceState::PixelShaderResource);
+
+    CompiledGraph compiled = graph.compile();
+    CHECK(compiled.passes.size() == 3);
+    for (uint32_t i = 0; i < compiled.passes.size(); ++i)
+    {
+        CHECK(compiled.passes[i].pass_idx == i);
+    }
+    CHECK(compiled.passes[1].barriers.empty());
+
+    OrderRecorder recorder;
+    graph.execute(compiled, recorder);
+    CHECK((executed == std::vector<int>{0, 1, 2}));
+    CHECK((recorder.begun == std::vector<uint32_t>{0, 1, 2}));
+    CHECK((recorder.ended == std::vector<uint32_t>{0, 1, 2}));
+    // The pass without barriers does not submit an empty batch.
+    CHECK(recorder.barrier_batches == 2);
+}
+
+// Reads up to the next write are merged into a single transition, writes always transition and
+// the final state is restored after the last pass.
+void test_barriers()
+{
+    RenderGraph graph;
+    ResourceHandle color = graph.import_resource(
+        "color",
+        nullptr,
+        ResourceState::Common,
+        ResourceState::Present
+    );
+    graph.add_pass("draw", [] {}).write(color, ResourceState::RenderTarget);
+    graph.add_pass("sample", [] {}).read(color, ResourceState::PixelShaderResource);
+    graph.add_pass("compute", [] {}).read(color, ResourceState::NonPixelShaderResource);
+    graph.add_pass("overlay", [] {}).write(color, ResourceState::RenderTarget);
+
+    CompiledGraph compiled = graph.compile();
+    CHECK(compiled.passes[0].barriers.size() == 1);
+    CHECK(is_transition(
+        compiled.passes[0].barriers[0],
+        color,
+        ResourceState::Common,
+        ResourceState::RenderTarget
+    ));
+    ResourceState both_reads =
+        ResourceState::PixelShaderResource | ResourceState::NonPixelShaderResource;
+    CHECK(compiled.passes[1].barriers.size() == 1);
+    CHECK(is_transition(
+        compiled.passes[1].barriers[0],
+        color,
+        ResourceState::RenderTarget,
+        both_reads
+    ));
+    CHECK(compiled.passes[2].barriers.empty());
+    CHECK(compiled.passes[3].barriers.size() == 1);
+    CHECK(is_transition(
+        compiled.passes[3].barriers[0],
+        color,
+        both_reads,
+        ResourceState::RenderTarget
+    ));
+    CHECK(compiled.final_barriers.size() == 1);
+    CHECK(is_transition(
+        compiled.final_barriers[0],
+        color,
+        ResourceState::RenderTarget,
+        ResourceState::Present
+    ));
+
+    // The next frame starts from the state this one ended in, so no transition is needed from
+    // the initial state passed again.
+    graph.reset();
+    color = graph.import_resource("color", nullptr, ResourceState::Common, ResourceState::Present);
+    graph.add_pass("copy", [] {}).read(color, ResourceState::CopySource);
+    compiled = graph.compile();
+    CHECK(compiled.passes[0].barriers.size() == 1);
+    CHECK(is_transition(
+        compiled.passes[0].barriers[0],
+        color,
+        ResourceState::Present,
+        ResourceState::CopySource
+    ));
+}
+
+// Back to back unordered access writes need a UAV barrier instead of a transition.
+void test_uav_barriers()
+{
+    RenderGraph graph;
+    ResourceHandle buffer =
+        graph.import_resource("buffer", nullptr, ResourceState::UnorderedAccess);
+    graph.add_pass("first", [] {}).write(buffer, ResourceState::UnorderedAccess);
+    graph.add_pass("second", [] {}).write(buffer, ResourceState::UnorderedAccess);
+
+    CompiledGraph compiled = graph.compile();
+    CHECK(compiled.passes[0].barriers.empty());
+    CHECK(compiled.passes[1].barriers.size() == 1);
+    CHECK(count_barriers(compiled.passes[1], Barrier::Type::Uav) == 1);
+}
+
+// Write states can not be combined, a second write in another state is rejected.
+void test_conflicting_writes()
+{
+    RenderGraph graph;
+    ResourceHandle target = graph.import_resource("target", nullptr, ResourceState::Common);
+    graph.add_pass("conflict", [] {})
+        .write(target, ResourceState::RenderTarget)
+        .write(target, ResourceState::UnorderedAccess)
+        .write(target, ResourceState::RenderTarget)
+        .read(target, ResourceState::PixelShaderResource);
+
+    CompiledGraph compiled = graph.compile();
+    CHECK(compiled.passes[0].barriers.size() == 1);
+    CHECK(is_transition(
+        compiled.passes[0].barriers[0],
+        target,
+        ResourceState::Common,
+        ResourceState::RenderTarget
+    ));
+}
+
+// Transients get lifetimes from the passes using them and only share memory when those do not
+// overlap. Unused transients get no memory at all.
+void test_transients()
+{
+    static constexpr uint64_t ALIGNMENT = 256;
+
+    RenderGraph graph;
+    ResourceHandle a = graph.create_transient(
+        "a",
+        TransientDesc{.size = 1024, .alignment = ALIGNMENT, .initial_state = ResourceState::Common}
+    );
+    ResourceHandle b = graph.create_transient(
+        "b",
+        TransientDesc{.size = 1024, .alignment = ALIGNMENT, .initial_state = ResourceState::Common}
+    );
+    ResourceHandle c = graph.create_transient(
+        "c",
+        TransientDesc{.size = 500, .alignment = ALIGNMENT, .initial_state = ResourceState::Common}
+    );
+    ResourceHandle unused = graph.create_transient(
+        "unused",
+        TransientDesc{.size = 4096, .alignment = ALIGNMENT, .initial_state = ResourceState::Common}
+    );
+
+    graph.add_pass("0", [] {}).write(a, ResourceState::RenderTarget);
+    graph.add_pass("1", [] {})
+        .read(a, ResourceState::PixelShaderResource)
+        .write(c, ResourceState::RenderTarget);
+    graph.add_pass("2", [] {})
+        .read(c, ResourceState::PixelShaderResource)
+        .write(b, ResourceState::UnorderedAccess);
+    graph.add_pass("3", [] {}).read(b, ResourceState::NonPixelShaderResource);
+
+    CompiledGraph compiled = graph.compile();
+    CHECK(compiled.transients.size() == 3);
+    CHECK(find_transient(compiled, unused) == nullptr);
+
+    const TransientAllocation *alloc_a = find_transient(compiled, a);
+    const TransientAllocation *alloc_b = find_transient(compiled, b);
+    const TransientAllocation *alloc_c = find_transient(compiled, c);
+    if (!alloc_a || !alloc_b || !alloc_c)
+    {
+        CHECK(alloc_a && alloc_b && alloc_c);
+        return;
+    }
+    CHECK(alloc_a->first_pass == 0 && alloc_a->last_pass == 1);
+    CHECK(alloc_c->first_pass == 1 && alloc_c->last_pass == 2);
+    CHECK(alloc_b->first_pass == 2 && alloc_b->last_pass == 3);
+
+    // `a` and `b` never live at the same time and share memory, `c` overlaps both in time.
+    CHECK(alloc_a->offset == 0);
+    CHECK(alloc_b->offset == 0);
+    CHECK(alloc_c->offset == 1024);
+    CHECK(alloc_c->offset % ALIGNMENT == 0);
+    CHECK(alloc_a->aliased && alloc_b->aliased && !alloc_c->aliased);
+    CHECK(compiled.transient_heap_size == 1024 + 500);
+    CHECK(compiled.transient_unaliased_size == 1024 + 1024 + 512);
+
+    // Resources sharing memory are activated with an aliasing barrier ahead of their
+    // transition, the one with memory of its own is not.
+    CHECK(count_barriers(compiled.passes[0], Barrier::Type::Aliasing) == 1);
+    CHECK(compiled.passes[0].barriers.front().type == Barrier::Type::Aliasing);
+    CHECK(compiled.passes[0].barriers.front().after == ResourceState::RenderTarget);
+    CHECK(count_barriers(compiled.passes[1], Barrier::Type::Aliasing) == 0);
+    CHECK(count_barriers(compiled.passes[2], Barrier::Type::Aliasing) == 1);
+    CHECK(compiled.passes[2].barriers.front().resource.idx == b.idx);
+    CHECK(compiled.passes[2].barriers.front().after == ResourceState::UnorderedAccess);
+}
+
+
+// The depth pyramid is released after the occlusion cull pass and the deferred path only starts
+// its color target in the lighting pass, so both share memory and the heap is smaller than the
+// sum of all transients by at least the pyramid. On the forward path the color target is drawn
+// from the start, so there is nothing to share.
+void test_frame_graph_aliasing()
+{
+    static constexpr uint64_t PIXEL_COUNT = 1920 * 1080;
+    auto transient = [](uint64_t size, ResourceState initial_state) {
+        return TransientDesc{.size = size, .alignment = 65536, .initial_state = initial_state};
+    };
+
+    for (bool deferred : {false, true})
+    {
+        std::optional<GBufferDescs> gbuffer;
+        if (deferred)
+        {
+            gbuffer = GBufferDescs{
+                .base_color = transient(4 * PIXEL_COUNT, ResourceState::RenderTarget),
+                .normal = transient(4 * PIXEL_COUNT, ResourceState::RenderTarget),
+                .metalness_roughness = transient(2 * PIXEL_COUNT, ResourceState::RenderTarget),
+            };
+        }
+
+        RenderGraph graph;
+        FrameGraphHandles handles = declare_frame_graph(
+            graph,
+            FrameGraphResources{
+                .sun_shadow_map = nullptr,
+                .backbuffer = nullptr,
+                .occlusion_predicates = nullptr,
+                .exposure = nullptr,
+                .color_target = transient(8 * PIXEL_COUNT, ResourceState::RenderTarget),
+                .depth_target = transient(4 * PIXEL_COUNT, ResourceState::DepthWrite),
+                .hiz = transient(4 * PIXEL_COUNT / 3, ResourceState::UnorderedAccess),
+                .gbuffer = gbuffer,
+            },
+            FrameGraphPasses{
+                .shadow_map = [] {},
+                .forward = [] {},
+                .hiz = [] {},
+                .occlusion_cull = [] {},
+                .forward_late = [] {},
+                .deferred_lighting = [] {},
+                .skybox = [] {},
+                .auto_exposure = [] {},
+                .post_process = [] {},
+                .imgui = [] {},
+            }
+        );
+        CompiledGraph compiled = graph.compile();
+
+        const TransientAllocation *hiz = find_transient(compiled, handles.hiz);
+        const TransientAllocation *color = find_transient(compiled, handles.color_target);
+        if (!hiz || !color)
+        {
+            CHECK(hiz && color);
+            continue;
+        }
+        CHECK((hiz->last_pass < color->first_pass) == deferred);
+        CHECK(hiz->aliased == deferred);
+        CHECK(color->aliased == deferred);
+
+        if (deferred)
+        {
+            CHECK(hiz->offset < color->offset + color->size);
+            CHECK(color->offset < hiz->offset + hiz->size);
+            CHECK(compiled.transient_heap_size + hiz->size <= compiled.transient_unaliased_size);
+        }
+        else
+        {
+            CHECK(std::none_of(
+                compiled.transients.begin(),
+                compiled.transients.end(),
+                [](const TransientAllocation &allocation) { return allocation.aliased; }
+            ));
+        }
+    }
+}
+} // namespace
+
+int main()
+{
+    test_pass_order();
+    test_barriers();
+    test_uav_barriers();
+    test_conflicting_writes();
+    test_transients();
+    test_frame_graph_aliasing();
+    return Arctic::Test::exit_code();
+}
@@ -0,0 +1,249 @@
+#include <cmath>
+#include <cstdint>
+#include <deque>
+
+#include <glm/geometric.hpp>
+#include <spdlog/spdlog.h>
+
+#include "check.hpp"
+#include "simulation.hpp"
+
+using namespace Arctic;
+
+namespace
+{
+
+constexpr float EPSILON = 1e-4f;
+
+bool near(float a, float b, float epsilon = EPSILON)
+{
+    return std::abs(a - b) <= epsilon;
+}
+
+bool near(glm::vec3 a, glm::vec3 b, float epsilon = EPSILON)
+{
+    return glm::length(a - b) <= epsilon;
+}
+
+CameraState start_camera()
+{
+    return CameraState{.eye = glm::vec3(1.0f, 2.0f, 3.0f), .rotation = glm::vec2(-30.0f, 90.0f)};
+}
+
+glm::vec3 forward_of(const CameraState &state)
+{
+    Renderer::Camera camera{
+        .eye = state.eye,
+        .rotation = state.rotation,
+        .aspect = 1.0f,
+        .fov_y = 0.0f,
+        .z_near_far = {0.0f, 0.0f},
+    };
+    return camera.forward();
+}
+
+// Frames shorter than a step only accumulate time, longer ones run whole steps and keep the rest.
+void test_step_counts()
+{
+    static constexpr float T = Simulation::TIMESTEP;
+
+    Simulation simulation;
+    simulation.set_camera(start_camera());
+    InputState idle{};
+
+    CHECK(simulation.advance(0.5f * T, idle, 1.0f) == 0);
+    CHECK(near(simulation.interpolation_alpha(), 0.5f));
+
+    CHECK(simulation.advance(0.75f * T, idle, 1.0f) == 1);
+    CHECK(near(simulation.interpolation_alpha(), 0.25f));
+
+    CHECK(simulation.advance(2.0f * T, idle, 1.0f) == 2);
+    CHECK(near(simulation.interpolation_alpha(), 0.25f));
+
+    // A stall runs at most the maximum number of steps and drops the rest.
+    CHECK(simulation.advance(1.0f, idle, 1.0f) == Simulation::MAX_STEPS_PER_FRAME);
+    CHECK(near(simulation.interpolation_alpha(), 0.0f));
+}
+
+// Holding a key moves the camera along its axis at the camera speed, and the rendered camera is
+// interpolated between the last two steps.
+void test_movement_and_interpolation()
+{
+    static constexpr float T = Simulation::TIMESTEP;
+    static constexpr float SPEED = 3.0f;
+
+    Simulation simulation;
+    CameraState start = start_camera();
+    simulation.set_camera(start);
+    glm::vec3 forward = forward_of(start);
+
+    InputState forward_held{};
+    forward_held.w = true;
+    CHECK(simulation.advance(2.5f * T, forward_held, SPEED) == 2);
+    CHECK(near(simulation.interpolation_alpha(), 0.5f));
+
+    // The previous step ended at one step of movement, the current one at two.
+    glm::vec3 expected = start.eye + forward * (SPEED * T * 1.5f);
+    CHECK(near(simulation.interpolated_camera().eye, expected));
+
+    Renderer::Camera camera{
+        .eye = glm::vec3(0.0f),
+        .rotation = glm::vec2(0.0f),
+        .aspect = 1.0f,
+        .fov_y = 60.0f,
+        .z_near_far = {0.1f, 100.0f},
+    };
+    simulation.apply_to(camera);
+    CHECK(near(camera.eye, expected));
+    CHECK(camera.fov_y == 60.0f);
+
+    // Opposite keys cancel out, so the camera stops on the next step.
+    InputState opposite{};
+    opposite.w = true;
+    opposite.s = true;
+    CHECK(simulation.advance(0.6f * T, opposite, SPEED) == 1);
+    glm::vec3 stopped = start.eye + forward * (SPEED * T * 2.0f);
+    CHECK(near(simulation.interpolated_camera().eye, stopped));
+}
+
+// Mouse look applies right away instead of waiting for the next step.
+void test_rotation()
+{
+    Simulation simulation;
+    CameraState start = start_camera();
+    simulation.set_camera(start);
+    simulation.advance(0.5f * Simulation::TIMESTEP, InputState{}, 1.0f);
+
+    simulation.rotate_camera(glm::vec2(5.0f, -10.0f));
+    CameraState camera = simulation.interpolated_camera();
+    CHECK(near(camera.rotation.x, start.rotation.x + 5.0f));
+    CHECK(near(camera.rotation.y, start.rotation.y - 10.0f));
+    CHECK(near(camera.eye, start.eye));
+}
+
+// The distance covered in a second does not depend on the frame rate.
+void test_frame_rate_independence()
+{
+    InputState input{};
+    input.d = true;
+    input.space = true;
+
+    glm::vec3 eyes[2];
+    const uint32_t frame_rates[2] = {60, 144};
+    for (uint32_t i = 0; i < 2; ++i)
+    {
+        Simulation simulation;
+        simulation.set_camera(start_camera());
+        uint32_t steps = 0;
+        for (uint32_t frame = 0; frame < frame_rates[i]; ++frame)
+        {
+            steps += simulation.advance(1.0f / static_cast<float>(frame_rates[i]), input, 2.0f);
+        }
+        // One second is 120 steps, give or take one for the accumulated rounding error.
+        CHECK(steps >= 119 && steps <= 120);
+        eyes[i] = simulation.interpolated_camera().eye;
+    }
+    CHECK(near(eyes[0], eyes[1], 1e-3f));
+    CHECK(!near(eyes[0], start_camera().eye, 1.0f));
+}
+
+// Runs frames at 60 Hz until the camera shows all of a burst of events that arrived within one
+// frame: the right mouse button, a frame of motion of a 1000 Hz mouse and the key to move forward.
+// Returns the number of frames that takes, counting the first frame after the burst. At most
+// `events_per_frame` events are handled per frame.
+uint32_t frames_to_reflect_burst(uint32_t events_per_frame, uint32_t &out_first_frame_events)
+{
+    static constexpr uint32_t MOTION_EVENTS = 16;
+    static constexpr uint32_t MAX_FRAMES = 64;
+
+    Simulation simulation;
+    CameraState start = start_camera();
+    simulation.set_camera(start);
+    InputHandler input;
+
+    std::deque<InputEvent> queue;
+    queue.push_back(InputEvent{
+        .type = InputEvent::Type::MouseButton,
+        .pressed = true,
+        .button = MouseButton::Right,
+    });
+    for (uint32_t i = 0; i < MOTION_EVENTS; ++i)
+    {
+        queue.push_back(
+            InputEvent{.type = InputEvent::Type::MouseMotion, .motion = glm::vec2(2.0f, -1.0f)}
+        );
+    }
+    queue.push_back(InputEvent{.type = InputEvent::Type::Key, .pressed = true, .key = InputKey::W});
+    glm::vec2 expected_rotation =
+        start.rotation + glm::vec2(1.0f, 2.0f) * (input.mouse_sensitivity * MOTION_EVENTS);
+
+    Renderer::Camera camera{
+        .eye = start.eye,
+        .rotation = start.rotation,
+        .aspect = 1.0f,
+        .fov_y = 60.0f,
+        .z_near_far = {0.1f, 100.0f},
+    };
+    for (uint32_t frame = 0; frame < MAX_FRAMES; ++frame)
+    {
+        uint32_t polled = 0;
+        uint32_t events = input.drain(
+            [&](InputEvent &out_event) {
+                if (queue.empty() || polled == events_per_frame)
+                {
+                    return false;
+                }
+                out_event = queue.front();
+                queue.pop_front();
+                ++polled;
+                return true;
+            },
+            simulation
+        );
+        if (frame == 0)
+        {
+            out_first_frame_events = events;
+        }
+        simulation.advance(1.0f / 60.0f, input.state(), 1.0f);
+        simulation.apply_to(camera);
+
+        bool rotated = near(camera.rotation.x, expected_rotation.x) &&
+                       near(camera.rotation.y, expected_rotation.y);
+        if (rotated && !near(camera.eye, start.eye))
+        {
+            return frame + 1;
+        }
+    }
+    return MAX_FRAMES;
+}
+
+// A burst of events that outruns the frame rate lands in a single frame and the camera shows it
+// in that same frame, where handling one event per frame would take a frame per event.
+void test_event_burst()
+{
+    uint32_t drained = 0;
+    uint32_t frames = frames_to_reflect_burst(UINT32_MAX, drained);
+    uint32_t one_per_frame_events = 0;
+    uint32_t one_per_frame = frames_to_reflect_burst(1, one_per_frame_events);
+    spdlog::info(
+        "burst of {} events shown after {} frame(s), {} frames with one event per frame",
+        drained,
+        frames,
+        one_per_frame
+    );
+    CHECK(drained == 18);
+    CHECK(frames == 1);
+    CHECK(one_per_frame == drained);
+}
+
+} // namespace
+
+int main()
+{
+    test_step_counts();
+    test_movement_and_interpolation();
+    test_rotation();
+    test_frame_rate_independence();
+    test_event_burst();
+    return Arctic::Test::exit_code();
+}
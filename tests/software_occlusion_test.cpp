@@ -0,0 +1,250 @@
+#include <array>
+#include <cstdint>
+#include <random>
+#include <span>
+#include <vector>
+
+#include <glm/ext/matrix_transform.hpp>
+#include <glm/vec2.hpp>
+#include <spdlog/spdlog.h>
+
+#include "check.hpp"
+#include "job_system.hpp"
+#include "renderer/procedural_mesh.hpp"
+#include "renderer/software_occlusion.hpp"
+
+using namespace Arctic;
+using namespace Arctic::Renderer;
+
+namespace
+{
+
+MeshDrawInfo unit_box_info(std::vector<MeshLod> lods)
+{
+    return MeshDrawInfo{
+        .lods = std::move(lods),
+        .material_idx = 0,
+        .bounds_min = glm::vec3(-0.5f),
+        .bounds_max = glm::vec3(0.5f),
+        .bounds_center = glm::vec3(0.0f),
+        .bounds_radius = 0.87f,
+    };
+}
+
+Object box_at(const glm::vec3 &position, const glm::vec3 &scale, MeshIdx mesh_idx = 0)
+{
+    return Object{
+        .trs = glm::scale(glm::translate(glm::mat4(1.0f), position), scale),
+        .mesh_idx = mesh_idx,
+    };
+}
+
+// A camera at the origin looking along the x axis.
+Camera origin_camera()
+{
+    return Camera{
+        .eye = glm::vec3(0.0f),
+        .rotation = glm::vec2(0.0f),
+        .aspect = 16.0f / 9.0f,
+        .fov_y = 60.0f,
+        .z_near_far = {0.1f, 1000.0f},
+    };
+}
+
+// A wall hides what is behind it, but not what is in front of it or next to it, and objects
+// behind the camera are outside the frustum. Only pixels covered by a single triangle are
+// written, so the hidden box stays clear of the diagonals of the faces of the wall.
+void test_occlusion(JobSystem &jobs)
+{
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+    generate_box(1, 1.0f, vertices, indices);
+    std::array<MeshDrawInfo, 1> meshes{unit_box_info({MeshLod{
+        .first_index = 0,
+        .index_count = static_cast<uint32_t>(indices.size()),
+        .error = 0.0f,
+    }})};
+
+    std::array objects{
+        box_at(glm::vec3(10.0f, 0.0f, 0.0f), glm::vec3(1.0f, 6.0f, 6.0f)),
+        box_at(glm::vec3(30.0f, 2.0f, 0.0f), glm::vec3(1.0f)),
+        box_at(glm::vec3(5.0f, 0.0f, 0.0f), glm::vec3(1.0f)),
+        box_at(glm::vec3(30.0f, 0.0f, 20.0f), glm::vec3(1.0f)),
+        box_at(glm::vec3(-10.0f, 0.0f, 0.0f), glm::vec3(1.0f)),
+    };
+
+    for (bool use_avx2 : {false, true})
+    {
+        SoftwareOcclusionCuller culler(&jobs);
+        culler.set_use_avx2(use_avx2);
+        culler.add_mesh(vertices, indices);
+
+        std::vector<uint8_t> visible;
+        culler.cull(objects, meshes, origin_camera(), visible);
+        CHECK((visible == std::vector<uint8_t>{1, 0, 1, 1, 0}));
+        CHECK(culler.stats().occluded == 1);
+        CHECK(culler.stats().frustum_culled == 1);
+    }
+}
+
+// Occluders are rasterized at their original mesh, even if a coarser level of detail claims to
+// be close enough, since coarser levels may cover more of the screen.
+void test_occluders_use_original_mesh(JobSystem &jobs)
+{
+    // The second level of detail is the same box four times as large, with a claimed error of 0.
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+    generate_box(1, 1.0f, vertices, indices);
+    uint32_t original_count = static_cast<uint32_t>(indices.size());
+    generate_box(1, 4.0f, vertices, indices);
+    std::array<MeshDrawInfo, 1> meshes{unit_box_info({
+        MeshLod{.first_index = 0, .index_count = original_count, .error = 0.0f},
+        MeshLod{
+            .first_index = original_count,
+            .index_count = static_cast<uint32_t>(indices.size()) - original_count,
+            .error = 0.0f,
+        },
+    })};
+
+    // The box at 30 is only hidden behind the larger level of the box at 10.
+    std::array objects{
+        box_at(glm::vec3(10.0f, 0.0f, 0.0f), glm::vec3(1.0f)),
+        box_at(glm::vec3(30.0f, 3.0f, 0.0f), glm::vec3(1.0f)),
+    };
+
+    SoftwareOcclusionCuller culler(&jobs);
+    culler.add_mesh(vertices, indices);
+    std::vector<uint8_t> visible;
+    culler.cull(objects, meshes, origin_camera(), visible);
+    CHECK(culler.stats().occluder_count >= 1);
+    CHECK((visible == std::vector<uint8_t>{1, 1}));
+}
+
+struct Run
+{
+    std::vector<uint8_t> visibility;
+    std::vector<float> depth;
+    uint64_t occluded{0};
+};
+
+Run run_views(
+    SoftwareOcclusionCuller &culler, std::span<const Object> objects,
+    std::span<const MeshDrawInfo> meshes, std::span<const Camera> views
+)
+{
+    Run run;
+    std::vector<uint8_t> visible;
+    for (const Camera &camera : views)
+    {
+        culler.cull(objects, meshes, camera, visible);
+        run.occluded += culler.stats().occluded;
+        run.visibility.insert(run.visibility.end(), visible.begin(), visible.end());
+        for (uint32_t y = 0; y < SOFTWARE_OCCLUSION_HEIGHT; ++y)
+        {
+            for (uint32_t x = 0; x < SOFTWARE_OCCLUSION_WIDTH; ++x)
+            {
+                run.depth.push_back(culler.depth(x, y));
+            }
+        }
+    }
+    return run;
+}
+
+// AVX2 on one and on all threads gives exactly the same depth buffers and visibility as the
+// scalar reference, for street level views of a city of buildings with small props in between.
+void test_avx2_matches_scalar()
+{
+    static constexpr uint32_t GRID_SIZE = 12;
+    static constexpr float BLOCK_SIZE = 12.0f;
+    static constexpr uint32_t PROPS_PER_BLOCK = 8;
+    static constexpr uint32_t VIEW_COUNT = 16;
+
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+    generate_box(4, 1.0f, vertices, indices);
+    std::array<MeshDrawInfo, 1> meshes{unit_box_info({MeshLod{
+        .first_index = 0,
+        .index_count = static_cast<uint32_t>(indices.size()),
+        .error = 0.0f,
+    }})};
+
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> height_dist(6.0f, 30.0f);
+    std::uniform_real_distribution<float> unit_dist(0.0f, 1.0f);
+    std::vector<Object> objects;
+    float city_size = static_cast<float>(GRID_SIZE) * BLOCK_SIZE;
+    for (uint32_t z = 0; z < GRID_SIZE; ++z)
+    {
+        for (uint32_t x = 0; x < GRID_SIZE; ++x)
+        {
+            glm::vec3 corner(
+                static_cast<float>(x) * BLOCK_SIZE, 0.0f, static_cast<float>(z) * BLOCK_SIZE
+            );
+            float height = height_dist(rng);
+            objects.emplace_back(box_at(
+                corner + glm::vec3(BLOCK_SIZE, height, BLOCK_SIZE) / 2.0f,
+                glm::vec3(BLOCK_SIZE - 4.0f, height, BLOCK_SIZE - 4.0f)
+            ));
+            for (uint32_t i = 0; i < PROPS_PER_BLOCK; ++i)
+            {
+                float along = unit_dist(rng) * (BLOCK_SIZE - 2.0f) + 1.0f;
+                glm::vec3 position = unit_dist(rng) < 0.5f ? glm::vec3(along, 0.5f, 1.0f)
+                                                            : glm::vec3(1.0f, 0.5f, along);
+                objects.emplace_back(box_at(corner + position, glm::vec3(1.0f)));
+            }
+        }
+    }
+
+    std::vector<Camera> views;
+    for (uint32_t i = 0; i < VIEW_COUNT; ++i)
+    {
+        float street = static_cast<float>(rng() % GRID_SIZE) * BLOCK_SIZE;
+        float along = unit_dist(rng) * city_size;
+        bool along_x = i % 2 == 0;
+        views.emplace_back(Camera{
+            .eye = along_x ? glm::vec3(along, 1.7f, street) : glm::vec3(street, 1.7f, along),
+            .rotation = glm::vec2(0.0f, (along_x ? 0.0f : 90.0f) + unit_dist(rng) * 60.0f - 30.0f),
+            .aspect = 16.0f / 9.0f,
+            .fov_y = 60.0f,
+            .z_near_far = {0.1f, 1000.0f},
+        });
+    }
+
+    JobSystem single_thread(1);
+    JobSystem all_threads;
+    SoftwareOcclusionCuller scalar_culler(&single_thread);
+    scalar_culler.set_use_avx2(false);
+    SoftwareOcclusionCuller simd_culler(&single_thread);
+    SoftwareOcclusionCuller threaded_culler(&all_threads);
+    if (!simd_culler.uses_avx2())
+    {
+        spdlog::warn("AVX2 is not available, only the scalar path is compared with itself");
+    }
+
+    Run reference;
+    for (SoftwareOcclusionCuller *culler : {&scalar_culler, &simd_culler, &threaded_culler})
+    {
+        culler->add_mesh(vertices, indices);
+        Run run = run_views(*culler, objects, meshes, views);
+        if (culler == &scalar_culler)
+        {
+            // The views have to hide something for the comparison to mean anything.
+            CHECK(run.occluded > 0);
+            reference = std::move(run);
+            continue;
+        }
+        CHECK(run.visibility == reference.visibility);
+        CHECK(run.depth == reference.depth);
+    }
+}
+
+} // namespace
+
+int main()
+{
+    JobSystem jobs;
+    test_occlusion(jobs);
+    test_occluders_use_original_mesh(jobs);
+    test_avx2_matches_scalar();
+    return Arctic::Test::exit_code();
+}
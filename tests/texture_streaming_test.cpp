@@ -0,0 +1,243 @@
+#include <cstdint>
+#include <deque>
+#include <span>
+#include <vector>
+
+#include "check.hpp"
+#include "renderer/texture_streaming.hpp"
+
+using namespace Arctic::Renderer;
+
+namespace
+{
+
+// Frames a replaced copy stays alive for after its request is complete, like the frames in
+// flight of the renderer.
+constexpr uint64_t RELEASE_DELAY = 2;
+
+// Level sizes of an uncompressed texture with four bytes per texel.
+std::vector<uint64_t> level_sizes(uint32_t width, uint32_t height)
+{
+    std::vector<uint64_t> sizes;
+    while (true)
+    {
+        sizes.emplace_back(uint64_t{width} * height * 4);
+        if (width == 1 && height == 1)
+        {
+            return sizes;
+        }
+        width = width > 1 ? width / 2 : 1;
+        height = height > 1 ? height / 2 : 1;
+    }
+}
+
+uint64_t bytes_from(std::span<const uint64_t> sizes, uint32_t mip)
+{
+    uint64_t bytes = 0;
+    for (size_t level = mip; level < sizes.size(); ++level)
+    {
+        bytes += sizes[level];
+    }
+    return bytes;
+}
+
+// Carries out the requests of the policy the way the renderer does: requests complete in the
+// frame they are issued in and the replaced copies are released a few frames later.
+class Streamer
+{
+    struct Release
+    {
+        uint64_t frame;
+        uint32_t texture;
+    };
+
+    std::deque<Release> m_releases;
+    uint64_t m_frame{0};
+
+  public:
+    TextureStreamingPolicy policy;
+    // Set once the memory accounted for exceeds the budget after an update.
+    bool exceeded_budget{false};
+
+    explicit Streamer(const TextureStreamingConfig &config) : policy(config)
+    {
+    }
+
+    void frame(std::span<const StreamingRequest> wanted)
+    {
+        ++m_frame;
+        while (!m_releases.empty() && m_releases.front().frame <= m_frame)
+        {
+            policy.release(m_releases.front().texture);
+            m_releases.pop_front();
+        }
+
+        for (const StreamingRequest &request : wanted)
+        {
+            policy.request(request.texture, request.mip);
+        }
+        std::vector<StreamingRequest> requests;
+        policy.update(requests);
+        TextureStreamingStats stats = policy.stats();
+        if (stats.allocated_bytes > stats.budget)
+        {
+            exceeded_budget = true;
+        }
+        for (const StreamingRequest &request : requests)
+        {
+            policy.complete(request.texture);
+            m_releases.push_back(Release{
+                .frame = m_frame + RELEASE_DELAY,
+                .texture = request.texture,
+            });
+        }
+    }
+
+    void frames(uint32_t count, std::span<const StreamingRequest> wanted)
+    {
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            frame(wanted);
+        }
+    }
+};
+
+// The most detailed level of a copy of a block compressed texture has to be a multiple of the
+// block size, so the tail can not start at a level that is not.
+void test_block_compressed_tail()
+{
+    TextureStreamingPolicy policy(TextureStreamingConfig{.budget = 1ull << 30});
+    std::vector<uint64_t> sizes = level_sizes(1000, 1000);
+
+    // 1000x1000 reaches 125x125 at mip 3, but 250x250 at mip 2 is not a multiple of 4 already.
+    uint32_t uncompressed = policy.add_texture(1000, 1000, sizes);
+    uint32_t compressed = policy.add_texture(1000, 1000, sizes, 4);
+    CHECK(policy.tail_mip(uncompressed) == 3);
+    CHECK(policy.tail_mip(compressed) == 1);
+    CHECK(policy.resident_mip(compressed) == 1);
+
+    uint32_t power_of_two = policy.add_texture(1024, 1024, level_sizes(1024, 1024), 4);
+    CHECK(policy.tail_mip(power_of_two) == 3);
+
+    // Requests for levels behind the tail do not evict any of it.
+    policy.request(compressed, 5);
+    std::vector<StreamingRequest> requests;
+    policy.update(requests);
+    CHECK(requests.empty());
+    CHECK(policy.resident_mip(compressed) == 1);
+}
+
+// A load needs room for both copies of the texture, and the replaced copy keeps counting against
+// the budget until it is released.
+void test_budget_includes_copies()
+{
+    std::vector<uint64_t> sizes = level_sizes(256, 256);
+    uint64_t both_copies = bytes_from(sizes, 0) + bytes_from(sizes, 1);
+    const StreamingRequest wanted[] = {{.texture = 0, .mip = 0}};
+
+    Streamer short_budget(
+        TextureStreamingConfig{.budget = both_copies - 1, .resident_tail_size = 64}
+    );
+    CHECK(short_budget.policy.add_texture(256, 256, sizes) == 0);
+    CHECK(short_budget.policy.tail_mip(0) == 2);
+    short_budget.frames(20, wanted);
+    CHECK(short_budget.policy.resident_mip(0) == 1);
+    CHECK(!short_budget.exceeded_budget);
+
+    Streamer exact_budget(TextureStreamingConfig{.budget = both_copies, .resident_tail_size = 64});
+    CHECK(exact_budget.policy.add_texture(256, 256, sizes) == 0);
+
+    // The first load only has to fit next to the tail, the second one has to wait for the copy
+    // the first one replaced.
+    exact_budget.frame(wanted);
+    CHECK(exact_budget.policy.resident_mip(0) == 1);
+    exact_budget.frame(wanted);
+    CHECK(exact_budget.policy.resident_mip(0) == 1);
+    TextureStreamingStats stats = exact_budget.policy.stats();
+    CHECK(stats.resident_bytes == bytes_from(sizes, 1));
+    CHECK(stats.allocated_bytes == bytes_from(sizes, 1) + bytes_from(sizes, 2));
+
+    exact_budget.frames(RELEASE_DELAY, wanted);
+    CHECK(exact_budget.policy.resident_mip(0) == 0);
+    CHECK(!exact_budget.exceeded_budget);
+
+    exact_budget.frames(RELEASE_DELAY, wanted);
+    stats = exact_budget.policy.stats();
+    CHECK(stats.resident_bytes == bytes_from(sizes, 0));
+    CHECK(stats.allocated_bytes == stats.resident_bytes);
+}
+
+// Levels that are no longer wanted stay resident while the budget allows it, and are evicted
+// least recently used first once a load needs their memory.
+void test_hysteresis_and_eviction()
+{
+    std::vector<uint64_t> sizes = level_sizes(256, 256);
+    uint64_t tail = bytes_from(sizes, 2);
+    // Two textures fully loaded and one at its tail, plus the copies of the last load.
+    uint64_t budget = 2 * bytes_from(sizes, 0) + bytes_from(sizes, 1) + tail;
+    Streamer streamer(TextureStreamingConfig{.budget = budget, .resident_tail_size = 64});
+    for (uint32_t i = 0; i < 3; ++i)
+    {
+        CHECK(streamer.policy.add_texture(256, 256, sizes) == i);
+    }
+
+    const StreamingRequest first[] = {{.texture = 0, .mip = 0}};
+    const StreamingRequest second[] = {{.texture = 1, .mip = 0}};
+    const StreamingRequest third[] = {{.texture = 2, .mip = 0}};
+    streamer.frames(10, first);
+    streamer.frames(10, second);
+    CHECK(streamer.policy.resident_mip(0) == 0);
+    CHECK(streamer.policy.resident_mip(1) == 0);
+
+    // Nothing is wanted anymore, but there is no reason to evict anything either.
+    streamer.frames(10, {});
+    CHECK(streamer.policy.resident_mip(0) == 0);
+    CHECK(streamer.policy.resident_mip(1) == 0);
+
+    // The third texture needs the memory of one of the others, the one used longer ago goes.
+    streamer.frames(10, third);
+    CHECK(streamer.policy.resident_mip(0) == 2);
+    CHECK(streamer.policy.resident_mip(1) == 0);
+    CHECK(streamer.policy.resident_mip(2) == 0);
+    CHECK(!streamer.exceeded_budget);
+}
+
+// A shrinking budget evicts unused levels first, then wanted levels of the largest textures.
+void test_budget_shrink()
+{
+    std::vector<uint64_t> sizes = level_sizes(256, 256);
+    Streamer streamer(TextureStreamingConfig{.budget = 1ull << 30, .resident_tail_size = 64});
+    CHECK(streamer.policy.add_texture(256, 256, sizes) == 0);
+    CHECK(streamer.policy.add_texture(256, 256, sizes) == 1);
+
+    const StreamingRequest wanted[] = {{.texture = 1, .mip = 0}};
+    const StreamingRequest both[] = {{.texture = 0, .mip = 0}, {.texture = 1, .mip = 0}};
+    streamer.frames(10, both);
+    CHECK(streamer.policy.resident_mip(0) == 0);
+    CHECK(streamer.policy.resident_mip(1) == 0);
+
+    uint64_t budget = bytes_from(sizes, 0) + bytes_from(sizes, 2);
+    streamer.policy.set_budget(budget);
+    streamer.frames(10, wanted);
+    CHECK(streamer.policy.resident_mip(0) == 2);
+    CHECK(streamer.policy.resident_mip(1) == 0);
+    CHECK(streamer.policy.stats().allocated_bytes <= budget);
+
+    // Once nothing unused is left, wanted levels go too.
+    budget = bytes_from(sizes, 1) + bytes_from(sizes, 2);
+    streamer.policy.set_budget(budget);
+    streamer.frames(10, wanted);
+    CHECK(streamer.policy.resident_mip(1) == 1);
+    CHECK(streamer.policy.stats().allocated_bytes <= budget);
+}
+
+} // namespace
+
+int main()
+{
+    test_block_compressed_tail();
+    test_budget_includes_copies();
+    test_hysteresis_and_eviction();
+    test_budget_shrink();
+    return Arctic::Test::exit_code();
+}
@@ -0,0 +1,170 @@
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include <glm/geometric.hpp>
+
+#include "check.hpp"
+#include "renderer/vertex_format.hpp"
+
+using namespace Arctic::Renderer;
+
+namespace
+{
+
+// Extent of the random mesh, in scene units.
+constexpr float EXTENT = 20.0f;
+// Largest errors the formats may introduce. Directions are compared by the distance between the
+// unit vectors, which for small angles is the angle in radians. Octahedral normals with 16 bits
+// per component are within about two steps of 2^-15, tangents with 15 bits within about two steps
+// of 2^-14. Half float texture coordinates below 4 are within 2^-10 per component.
+constexpr float MAX_NORMAL_ERROR = 1.0e-4f;
+constexpr float MAX_TANGENT_ERROR = 2.0e-4f;
+constexpr float MAX_TEX_COORD_ERROR = 1.5f / 1024.0f;
+// Half a step of a 16 bit unorm across the extent, along all three axes.
+constexpr float MAX_UNORM16_POSITION_ERROR = 0.87f * EXTENT / 65535.0f;
+
+glm::vec3 random_direction(std::mt19937 &rng)
+{
+    std::normal_distribution<float> dist(0.0f, 1.0f);
+    return glm::normalize(glm::vec3(dist(rng), dist(rng), dist(rng)));
+}
+
+Vertex make_vertex(
+    const glm::vec3 &position, const glm::vec3 &normal, const glm::vec3 &tangent, bool flip,
+    const glm::vec2 &tex_coords
+)
+{
+    Vertex vertex{};
+    vertex.position = position;
+    vertex.normal = normal;
+    vertex.tangent = tangent;
+    vertex.bitangent = glm::cross(normal, tangent) * (flip ? -1.0f : 1.0f);
+    vertex.tex_coords = tex_coords;
+    return vertex;
+}
+
+// Random vertices, plus normals along the axes and on the edges of the octahedron where the
+// encoding folds over. The count is no multiple of the SIMD width, so there is a tail.
+std::vector<Vertex> generate_vertices()
+{
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> position_dist(-EXTENT / 2.0f, EXTENT / 2.0f);
+    std::uniform_real_distribution<float> tex_coord_dist(-4.0f, 4.0f);
+    std::bernoulli_distribution flip_dist(0.5);
+    auto random_position = [&] {
+        return glm::vec3(position_dist(rng), position_dist(rng), position_dist(rng));
+    };
+    auto random_tex_coords = [&] { return glm::vec2(tex_coord_dist(rng), tex_coord_dist(rng)); };
+
+    std::vector<Vertex> vertices;
+    std::vector<glm::vec3> special_normals{
+        glm::vec3(1.0f, 0.0f, 0.0f),
+        glm::vec3(-1.0f, 0.0f, 0.0f),
+        glm::vec3(0.0f, 1.0f, 0.0f),
+        glm::vec3(0.0f, -1.0f, 0.0f),
+        glm::vec3(0.0f, 0.0f, 1.0f),
+        glm::vec3(0.0f, 0.0f, -1.0f),
+        glm::normalize(glm::vec3(1.0f, 1.0f, 0.0f)),
+        glm::normalize(glm::vec3(-1.0f, 0.0f, -1.0f)),
+        glm::normalize(glm::vec3(0.0f, 1.0f, -1.0f)),
+    };
+    for (const glm::vec3 &normal : special_normals)
+    {
+        for (const glm::vec3 &other : special_normals)
+        {
+            glm::vec3 side = glm::cross(normal, other);
+            if (glm::length(side) < 0.5f)
+            {
+                continue;
+            }
+            for (bool flip : {false, true})
+            {
+                vertices.emplace_back(make_vertex(
+                    random_position(), normal, glm::normalize(side), flip, random_tex_coords()
+                ));
+            }
+        }
+    }
+
+    while (vertices.size() < 10007)
+    {
+        glm::vec3 normal = random_direction(rng);
+        glm::vec3 tangent = glm::normalize(glm::cross(normal, random_direction(rng)));
+        vertices.emplace_back(
+            make_vertex(random_position(), normal, tangent, flip_dist(rng), random_tex_coords())
+        );
+    }
+
+    // The corners of the bounding box, which quantize to the ends of the unorm range.
+    vertices.front().position = glm::vec3(-EXTENT / 2.0f);
+    vertices.back().position = glm::vec3(EXTENT / 2.0f);
+    return vertices;
+}
+
+// The SSE2 encoder produces exactly the bytes of the scalar reference.
+void test_simd_matches_scalar(const std::vector<Vertex> &vertices, VertexPositionFormat format)
+{
+    CompressedVertices scalar;
+    CompressedVertices simd;
+    compress_vertices_scalar(vertices, format, scalar);
+    compress_vertices(vertices, format, simd);
+
+    CHECK(scalar.position_format == format);
+    CHECK(simd.position_format == format);
+    CHECK(scalar.positions.size() == vertices.size() * vertex_position_size(format));
+    CHECK(scalar.attributes.size() == vertices.size());
+    CHECK(simd.positions == scalar.positions);
+    CHECK(simd.attributes.size() == scalar.attributes.size());
+    CHECK(
+        std::memcmp(
+            simd.attributes.data(),
+            scalar.attributes.data(),
+            scalar.attributes.size() * sizeof(PackedVertexAttributes)
+        ) == 0
+    );
+    CHECK(simd.position_transform == scalar.position_transform);
+}
+
+// Decoded vertices stay within the precision of the formats and keep the handedness of their
+// tangent frame.
+void test_precision(const std::vector<Vertex> &vertices, VertexPositionFormat format)
+{
+    CompressedVertices compressed;
+    compress_vertices(vertices, format, compressed);
+
+    float max_position_error =
+        format == VertexPositionFormat::Float ? 0.0f : MAX_UNORM16_POSITION_ERROR;
+    for (size_t i = 0; i < vertices.size(); ++i)
+    {
+        const Vertex &original = vertices[i];
+        Vertex decoded = decompress_vertex(compressed, i);
+        CHECK(glm::distance(original.position, decoded.position) <= max_position_error);
+        CHECK(glm::distance(original.normal, decoded.normal) <= MAX_NORMAL_ERROR);
+        CHECK(glm::distance(original.tangent, decoded.tangent) <= MAX_TANGENT_ERROR);
+        CHECK(std::abs(original.tex_coords.x - decoded.tex_coords.x) <= MAX_TEX_COORD_ERROR);
+        CHECK(std::abs(original.tex_coords.y - decoded.tex_coords.y) <= MAX_TEX_COORD_ERROR);
+        CHECK(glm::dot(original.bitangent, decoded.bitangent) > 0.0f);
+    }
+}
+
+} // namespace
+
+int main()
+{
+    std::vector<Vertex> vertices = generate_vertices();
+    for (VertexPositionFormat format : VERTEX_POSITION_FORMATS)
+    {
+        test_simd_matches_scalar(vertices, format);
+        test_precision(vertices, format);
+    }
+
+    // The random mesh is far too large for 16 bit positions at a tolerance of a micrometer, but
+    // not at a millimeter.
+    CHECK(choose_vertex_position_format(vertices, 1.0e-6f) == VertexPositionFormat::Float);
+    CHECK(choose_vertex_position_format(vertices, 1.0e-3f) == VertexPositionFormat::Unorm16);
+
+    return Arctic::Test::exit_code();
+}
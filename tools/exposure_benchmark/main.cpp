@@ -0,0 +1,79 @@
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <optional>
+#include <random>
+#include <vector>
+
+#include <spdlog/spdlog.h>
+
+#include "renderer/auto_exposure.hpp"
+
+using namespace Arctic::Renderer;
+
+// A 1440p frame lit like the scene: mostly mid tones spread over a few stops, a band of dark
+// shadow, a bright sky and a few pixels of sun far above everything else.
+static std::vector<float> generate_frame(uint32_t width, uint32_t height)
+{
+    std::vector<float> pixels(4ull * width * height);
+    std::mt19937 rng(1234);
+    std::normal_distribution<float> stops(0.0f, 1.5f);
+    for (uint32_t y = 0; y < height; ++y)
+    {
+        for (uint32_t x = 0; x < width; ++x)
+        {
+            float luminance;
+            if (y < height / 4)
+            {
+                luminance = 4.0f;
+            }
+            else if (y > height - height / 8)
+            {
+                luminance = 0.002f;
+            }
+            else
+            {
+                luminance = 0.3f * std::exp2(stops(rng));
+            }
+            if (x < 8 && y < 8)
+            {
+                luminance = 50000.0f;
+            }
+            float *pixel = pixels.data() + 4ull * (size_t{y} * width + x);
+            pixel[0] = pixel[1] = pixel[2] = luminance;
+            pixel[3] = 1.0f;
+        }
+    }
+    return pixels;
+}
+
+// Reports the time the reference implementation of the luminance histogram takes on the CPU for
+// a 1440p frame, along with its measurement. The correctness checks live in `exposure_test.cpp`.
+int main()
+{
+    static constexpr uint32_t WIDTH = 2560;
+    static constexpr uint32_t HEIGHT = 1440;
+    static constexpr uint32_t ITERATIONS = 5;
+
+    AutoExposureParams params;
+    std::vector<float> frame = generate_frame(WIDTH, HEIGHT);
+    LuminanceHistogram histogram;
+    using Clock = std::chrono::high_resolution_clock;
+    Clock::time_point begin = Clock::now();
+    for (uint32_t i = 0; i < ITERATIONS; ++i)
+    {
+        build_luminance_histogram(frame, WIDTH, HEIGHT, params, histogram);
+    }
+    float histogram_ms = std::chrono::duration<float, std::milli>(Clock::now() - begin).count() /
+                         static_cast<float>(ITERATIONS);
+
+    std::optional<float> measured = histogram_log_luminance(histogram, params);
+    spdlog::info(
+        "histogram of {}x{} in {:.2f} ms, measured {:.3f} log2 luminance",
+        WIDTH,
+        HEIGHT,
+        histogram_ms,
+        measured.value_or(NAN)
+    );
+    return 0;
+}
@@ -0,0 +1,112 @@
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include <spdlog/spdlog.h>
+
+#include "half_float.hpp"
+
+using namespace Arctic;
+
+static float time_convert(
+    const std::vector<float> &values, std::vector<uint16_t> &out_halves,
+    HalfConversion conversion, uint32_t iterations
+)
+{
+    using Clock = std::chrono::high_resolution_clock;
+    Clock::time_point begin = Clock::now();
+    for (uint32_t i = 0; i < iterations; ++i)
+    {
+        floats_to_halves(values, out_halves, conversion);
+    }
+    return std::chrono::duration<float, std::milli>(Clock::now() - begin).count() /
+           static_cast<float>(iterations);
+}
+
+// Converts the texels of a 4K RGBA float environment to half floats with the scalar reference,
+// SSE2 and F16C and reports the time and throughput of each. Most values are radiances spread over
+// many orders of magnitude, the rest are the edge cases: ties, subnormals, overflows, infinities
+// and NaNs. That all of them agree is checked by `half_float_test.cpp`.
+int main()
+{
+    static constexpr uint32_t WIDTH = 4096;
+    static constexpr uint32_t HEIGHT = 2048;
+    static constexpr uint32_t ITERATIONS = 5;
+
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> exponent_dist(-30.0f, 20.0f);
+    std::uniform_int_distribution<uint32_t> special_dist(0, 63);
+    std::uniform_int_distribution<uint32_t> tie_dist(0, 0x7bfe);
+    std::uniform_int_distribution<uint32_t> nan_dist(0xfc01, 0xffff);
+    std::array<float, 6> specials{
+        0.0f,
+        -0.0f,
+        65520.0f,
+        std::numeric_limits<float>::infinity(),
+        -std::numeric_limits<float>::infinity(),
+        std::numeric_limits<float>::quiet_NaN(),
+    };
+
+    std::vector<float> values(4ull * WIDTH * HEIGHT);
+    for (float &value : values)
+    {
+        uint32_t special = special_dist(rng);
+        if (special < specials.size())
+        {
+            value = specials[special];
+        }
+        else if (special < 2 * specials.size())
+        {
+            // Exactly halfway between two adjacent finite halves.
+            uint16_t half = static_cast<uint16_t>(tie_dist(rng));
+            value = 0.5f * (half_to_float(half) + half_to_float(static_cast<uint16_t>(half + 1)));
+        }
+        else if (special == 2 * specials.size())
+        {
+            // A NaN with a payload.
+            value = half_to_float(static_cast<uint16_t>(nan_dist(rng)));
+        }
+        else
+        {
+            value = std::exp2(exponent_dist(rng));
+        }
+    }
+
+    struct Variant
+    {
+        const char *name;
+        HalfConversion conversion;
+    };
+    std::array<Variant, 3> variants{
+        Variant{"scalar", HalfConversion::Scalar},
+        Variant{"sse2", HalfConversion::Sse2},
+        Variant{"f16c", HalfConversion::F16c},
+    };
+
+    std::vector<uint16_t> halves(values.size());
+    for (const Variant &variant : variants)
+    {
+        if (variant.conversion > best_half_conversion())
+        {
+            spdlog::info("{}: not supported by this cpu", variant.name);
+            continue;
+        }
+
+        float ms = time_convert(values, halves, variant.conversion, ITERATIONS);
+        float bytes = static_cast<float>(values.size() * sizeof(float));
+        spdlog::info(
+            "{}: {:.2f} ms for {}x{} rgba texels, {:.2f} GB/s",
+            variant.name,
+            ms,
+            WIDTH,
+            HEIGHT,
+            bytes / (ms * 1e6f)
+        );
+    }
+
+    return 0;
+}
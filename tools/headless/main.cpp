@@ -0,0 +1,149 @@
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <spdlog/spdlog.h>
+
+#include "renderer/null_backend.hpp"
+
+using namespace Arctic::Renderer;
+
+// Renders frames of a synthetic scene with the null backend to measure the CPU cost of a frame,
+// or dumps the recorded command stream of a single frame so it can be diffed against another run.
+int main(int argc, char **argv)
+{
+    uint32_t num_frames = 1000;
+    uint32_t grid_size = 32;
+    bool dump = false;
+    Settings settings;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string_view arg = argv[i];
+        if (arg == "--dump")
+        {
+            dump = true;
+        }
+        else if (arg == "--deferred")
+        {
+            settings.deferred_shading = true;
+        }
+        else if (arg == "--software-occlusion")
+        {
+            settings.software_occlusion = true;
+        }
+        else if ((arg == "--frames" || arg == "--grid") && i + 1 < argc)
+        {
+            std::string_view value = argv[++i];
+            uint32_t &out = arg == "--frames" ? num_frames : grid_size;
+            auto [_, ec] = std::from_chars(value.data(), value.data() + value.size(), out);
+            if (ec != std::errc())
+            {
+                spdlog::error("invalid value for {}: {}", arg, value);
+                return 1;
+            }
+        }
+        else
+        {
+            spdlog::error(
+                "usage: {} [--frames <count>] [--grid <size>] [--deferred] "
+                "[--software-occlusion] [--dump]",
+                argv[0]
+            );
+            return 1;
+        }
+    }
+
+    NullRenderer renderer(1280, 720);
+
+    static constexpr uint32_t NUM_MATERIALS = 4;
+    for (uint32_t material_idx = 0; material_idx < NUM_MATERIALS; ++material_idx)
+    {
+        (void)renderer.create_material(1024);
+    }
+
+    static constexpr uint32_t NUM_MESHES = 8;
+    for (uint32_t mesh_idx = 0; mesh_idx < NUM_MESHES; ++mesh_idx)
+    {
+        (void)renderer.create_mesh(3 * 1024 * (mesh_idx + 1), mesh_idx % NUM_MATERIALS);
+    }
+
+    Scene scene{
+        .camera =
+            Camera{
+                .eye = glm::vec3(0.0f, 10.0f, -10.0f),
+                .rotation = glm::vec2(-30.0f, 90.0f),
+                .aspect = 1280.0f / 720.0f,
+                .fov_y = 60.0f,
+                .z_near_far = {0.1f, 1000.0f},
+            },
+        .ambient = 1.0f,
+        .sun =
+            DirectionalLight{
+                .position = glm::vec3(0.0f, 50.0f, 0.0f),
+                .rotation = glm::vec2(-60.0f, 0.0f),
+                .color = glm::vec3(1.0f),
+            },
+        .point_lights = {},
+        .objects = {},
+    };
+    for (uint32_t z = 0; z < grid_size; ++z)
+    {
+        for (uint32_t x = 0; x < grid_size; ++x)
+        {
+            glm::vec3 position(static_cast<float>(x) * 2.0f, 0.0f, static_cast<float>(z) * 2.0f);
+            scene.objects.emplace_back(Object{
+                .trs = glm::translate(glm::mat4(1.0f), position),
+                .mesh_idx = (x + z) % NUM_MESHES,
+            });
+        }
+    }
+
+    if (dump)
+    {
+        renderer.render_frame(scene, settings);
+        std::fputs(renderer.recorder().to_string().c_str(), stdout);
+        return 0;
+    }
+
+    using Clock = std::chrono::high_resolution_clock;
+    std::vector<float> frame_ms;
+    frame_ms.reserve(num_frames);
+    for (uint32_t frame = 0; frame < num_frames; ++frame)
+    {
+        Clock::time_point begin = Clock::now();
+        renderer.render_frame(scene, settings);
+        frame_ms.emplace_back(
+            std::chrono::duration<float, std::milli>(Clock::now() - begin).count()
+        );
+    }
+    if (frame_ms.empty())
+    {
+        return 0;
+    }
+
+    float total_ms = 0.0f;
+    for (float ms : frame_ms)
+    {
+        total_ms += ms;
+    }
+    std::sort(frame_ms.begin(), frame_ms.end());
+    size_t p99_idx = std::min(frame_ms.size() - 1, (frame_ms.size() * 99 + 99) / 100 - 1);
+
+    spdlog::info(
+        "{} frames, {} objects, {} commands per frame: avg {:.4f} ms, p99 {:.4f} ms",
+        frame_ms.size(),
+        scene.objects.size(),
+        renderer.recorder().log().size(),
+        total_ms / static_cast<float>(frame_ms.size()),
+        frame_ms[p99_idx]
+    );
+
+    return 0;
+}
@@ -0,0 +1,112 @@
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include <spdlog/spdlog.h>
+
+#include "job_system.hpp"
+#include "renderer/ibl.hpp"
+
+using namespace Arctic;
+using namespace Arctic::Renderer;
+
+// Equirectangular sky with a horizon gradient, a small and very bright sun and a noisy ground,
+// so both the smooth and the sharp parts of the precomputation are exercised.
+static std::vector<float> generate_environment(uint32_t width, uint32_t height)
+{
+    std::vector<float> pixels(4ull * width * height);
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> noise(0.8f, 1.2f);
+    for (uint32_t y = 0; y < height; ++y)
+    {
+        float elevation = 0.5f - (static_cast<float>(y) + 0.5f) / static_cast<float>(height);
+        for (uint32_t x = 0; x < width; ++x)
+        {
+            float azimuth = (static_cast<float>(x) + 0.5f) / static_cast<float>(width);
+            float *pixel = pixels.data() + 4ull * (size_t{y} * width + x);
+            if (elevation < 0.0f)
+            {
+                float ground = 0.1f * noise(rng);
+                pixel[0] = ground;
+                pixel[1] = 0.8f * ground;
+                pixel[2] = 0.6f * ground;
+            }
+            else
+            {
+                float t = std::sqrt(elevation * 2.0f);
+                pixel[0] = 0.8f - 0.6f * t;
+                pixel[1] = 0.9f - 0.5f * t;
+                pixel[2] = 1.0f - 0.2f * t;
+            }
+            float dx = azimuth - 0.3f;
+            float dy = elevation - 0.25f;
+            if (dx * dx + dy * dy < 0.0001f)
+            {
+                pixel[0] = pixel[1] = pixel[2] = 5000.0f;
+            }
+            pixel[3] = 1.0f;
+        }
+    }
+    return pixels;
+}
+
+// Converts a synthetic 2K environment into a cubemap and precomputes its IBL data with the scalar
+// reference on one thread and with SSE2 on one and on all threads, and reports the time of every
+// stage. That all of them agree and that the disk cache round trips is checked by `ibl_test.cpp`.
+int main()
+{
+    static constexpr uint32_t WIDTH = 2048;
+    static constexpr uint32_t HEIGHT = 1024;
+
+    std::vector<float> environment = generate_environment(WIDTH, HEIGHT);
+
+    JobSystem single_thread(1);
+    JobSystem all_threads;
+
+    struct Variant
+    {
+        const char *name;
+        JobSystem *jobs;
+        bool use_simd;
+    };
+    std::array<Variant, 3> variants{
+        Variant{"scalar", &single_thread, false},
+        Variant{"simd", &single_thread, true},
+        Variant{"simd", &all_threads, true},
+    };
+
+    for (const Variant &variant : variants)
+    {
+        using Clock = std::chrono::steady_clock;
+        Clock::time_point begin = Clock::now();
+        CubeMap cube;
+        equirect_to_cube(
+            environment,
+            WIDTH,
+            HEIGHT,
+            environment_cube_size(WIDTH),
+            *variant.jobs,
+            cube
+        );
+        float cube_ms = std::chrono::duration<float, std::milli>(Clock::now() - begin).count();
+
+        IblData data;
+        IblStats stats;
+        compute_ibl(cube, *variant.jobs, data, stats, variant.use_simd);
+        spdlog::info(
+            "{} on {} threads: cube {:.1f} ms, irradiance {:.1f} ms, specular {:.1f} ms, brdf lut "
+            "{:.1f} ms",
+            variant.name,
+            variant.jobs->thread_count(),
+            cube_ms,
+            stats.irradiance_ms,
+            stats.specular_ms,
+            stats.brdf_lut_ms
+        );
+    }
+
+    return 0;
+}
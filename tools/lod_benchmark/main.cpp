@@ -0,0 +1,113 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <assimp/Importer.hpp>
+#include <assimp/postprocess.h>
+#include <assimp/scene.h>
+#include <spdlog/spdlog.h>
+
+#include "renderer/mesh_optimizer.hpp"
+#include "renderer/mesh_simplifier.hpp"
+
+using namespace Arctic::Renderer;
+
+// Generates the levels of detail of every mesh in the given scenes the same way the app does at
+// load time, and reports the simplification throughput and the triangle count of every level.
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        spdlog::error("usage: arctic_lod_benchmark <scene.gltf>...");
+        return 1;
+    }
+
+    bool ok = true;
+    for (int arg_idx = 1; arg_idx < argc; ++arg_idx)
+    {
+        Assimp::Importer importer;
+        const aiScene *scene = importer.ReadFile(
+            argv[arg_idx],
+            aiProcess_Triangulate | aiProcess_JoinIdenticalVertices | aiProcess_FlipUVs |
+                aiProcess_CalcTangentSpace
+        );
+        if (scene == nullptr)
+        {
+            spdlog::error("failed to load {}", argv[arg_idx]);
+            ok = false;
+            continue;
+        }
+
+        std::vector<std::vector<MeshLod>> mesh_lods(scene->mNumMeshes);
+        float total_ms = 0.0f;
+        for (uint32_t mesh_idx = 0; mesh_idx < scene->mNumMeshes; ++mesh_idx)
+        {
+            const aiMesh *ai_mesh = scene->mMeshes[mesh_idx];
+
+            // Only positions matter to the simplifier.
+            std::vector<Vertex> vertices(ai_mesh->mNumVertices);
+            for (uint32_t vertex_idx = 0; vertex_idx < ai_mesh->mNumVertices; ++vertex_idx)
+            {
+                const aiVector3D &position = ai_mesh->mVertices[vertex_idx];
+                vertices[vertex_idx].position = glm::vec3(position.x, position.y, position.z);
+            }
+
+            std::vector<uint32_t> indices;
+            indices.reserve(3ull * ai_mesh->mNumFaces);
+            for (uint32_t face_idx = 0; face_idx < ai_mesh->mNumFaces; ++face_idx)
+            {
+                const aiFace &face = ai_mesh->mFaces[face_idx];
+                if (face.mNumIndices == 3)
+                {
+                    indices.insert(indices.end(), face.mIndices, face.mIndices + 3);
+                }
+            }
+            (void)optimize_mesh(vertices, indices);
+
+            using Clock = std::chrono::high_resolution_clock;
+            Clock::time_point begin = Clock::now();
+            generate_lod_chain(vertices, indices, mesh_lods[mesh_idx]);
+            total_ms += std::chrono::duration<float, std::milli>(Clock::now() - begin).count();
+        }
+
+        size_t level_count = 0;
+        for (const std::vector<MeshLod> &lods : mesh_lods)
+        {
+            level_count = std::max(level_count, lods.size());
+        }
+        // Triangles of every level of detail, summed over all meshes. Meshes with fewer levels
+        // keep being drawn at their coarsest one.
+        std::vector<uint64_t> level_triangles(level_count, 0);
+        for (const std::vector<MeshLod> &lods : mesh_lods)
+        {
+            for (size_t level = 0; level < level_count; ++level)
+            {
+                level_triangles[level] += lods[std::min(level, lods.size() - 1)].index_count / 3;
+            }
+        }
+        uint64_t source_triangles = level_count > 0 ? level_triangles.front() : 0;
+
+        spdlog::info(
+            "{}: {} meshes, {} triangles simplified in {:.1f} ms ({:.2f} Mtri/s)",
+            argv[arg_idx],
+            scene->mNumMeshes,
+            source_triangles,
+            total_ms,
+            static_cast<float>(source_triangles) / 1.0e6f / total_ms * 1000.0f
+        );
+        for (size_t level = 0; level < level_triangles.size(); ++level)
+        {
+            spdlog::info(
+                "  LOD {}: {} triangles ({:.1f}% of the original)",
+                level,
+                level_triangles[level],
+                100.0 * static_cast<double>(level_triangles[level]) /
+                    static_cast<double>(source_triangles)
+            );
+        }
+    }
+
+    return ok ? 0 : 1;
+}
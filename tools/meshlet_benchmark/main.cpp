@@ -0,0 +1,99 @@
+#include <chrono>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include <glm/ext/matrix_clip_space.hpp>
+#include <glm/ext/matrix_transform.hpp>
+#include <glm/geometric.hpp>
+#include <spdlog/spdlog.h>
+
+#include "renderer/mesh_optimizer.hpp"
+#include "renderer/meshlet.hpp"
+#include "renderer/procedural_mesh.hpp"
+
+using namespace Arctic::Renderer;
+
+// Builds meshlets for a torus and reports the build throughput and how much the cone and frustum
+// tests cull from random views. The correctness checks live in `meshlet_test.cpp`.
+int main()
+{
+    static constexpr uint32_t RINGS = 512;
+    static constexpr uint32_t SIDES = 256;
+    static constexpr uint32_t ITERATIONS = 10;
+    static constexpr uint32_t VIEW_COUNT = 256;
+
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+    generate_torus(RINGS, SIDES, 2.0f, 0.75f, vertices, indices);
+    optimize_vertex_cache(indices, static_cast<uint32_t>(vertices.size()));
+
+    MeshletData data;
+    using Clock = std::chrono::high_resolution_clock;
+    Clock::time_point begin = Clock::now();
+    for (uint32_t i = 0; i < ITERATIONS; ++i)
+    {
+        data = MeshletData{};
+        (void)build_meshlets(vertices, indices, data);
+    }
+    float build_ms = std::chrono::duration<float, std::milli>(Clock::now() - begin).count() /
+                     static_cast<float>(ITERATIONS);
+
+    size_t vertex_references = 0;
+    for (const Meshlet &meshlet : data.meshlets)
+    {
+        vertex_references += meshlet.vertex_count;
+    }
+
+    std::mt19937 rng(1234);
+    std::normal_distribution<float> normal_dist(0.0f, 1.0f);
+    std::uniform_real_distribution<float> distance_dist(4.0f, 12.0f);
+    auto random_direction = [&] {
+        return glm::normalize(glm::vec3(normal_dist(rng), normal_dist(rng), normal_dist(rng)));
+    };
+
+    size_t cone_culled = 0;
+    size_t directional_culled = 0;
+    size_t frustum_culled = 0;
+    for (uint32_t view = 0; view < VIEW_COUNT; ++view)
+    {
+        glm::vec3 eye = random_direction() * distance_dist(rng);
+        glm::vec3 direction = random_direction();
+        glm::mat4 clip_from_object =
+            glm::perspectiveRH(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 100.0f) *
+            glm::lookAtRH(eye, eye + random_direction(), glm::vec3(0.0f, 1.0f, 0.0f));
+
+        for (const MeshletBounds &bounds : data.bounds)
+        {
+            cone_culled += meshlet_cone_culled(bounds, eye);
+            directional_culled += meshlet_cone_culled_directional(bounds, direction);
+            frustum_culled +=
+                sphere_outside_frustum(clip_from_object, bounds.center, bounds.radius);
+        }
+    }
+
+    float triangles_per_meshlet = static_cast<float>(indices.size() / 3) /
+                                  static_cast<float>(data.meshlets.size());
+    float tests = static_cast<float>(VIEW_COUNT) * static_cast<float>(data.meshlets.size());
+    spdlog::info(
+        "{} triangles in {} meshlets ({:.1f} triangles, {:.1f} vertices each, {:.2f} vertex "
+        "transforms per mesh vertex), built in {:.2f} ms ({:.1f} Mtri/s)",
+        indices.size() / 3,
+        data.meshlets.size(),
+        triangles_per_meshlet,
+        static_cast<float>(vertex_references) / static_cast<float>(data.meshlets.size()),
+        static_cast<float>(vertex_references) / static_cast<float>(vertices.size()),
+        build_ms,
+        static_cast<float>(indices.size() / 3) / 1.0e6f / build_ms * 1000.0f
+    );
+    spdlog::info(
+        "culled over {} random views: {:.1f}% by the cone from the eye, {:.1f}% by the cone "
+        "along a direction, {:.1f}% by the frustum",
+        VIEW_COUNT,
+        100.0f * static_cast<float>(cone_culled) / tests,
+        100.0f * static_cast<float>(directional_culled) / tests,
+        100.0f * static_cast<float>(frustum_culled) / tests
+    );
+
+    return 0;
+}
@@ -0,0 +1,86 @@
+#include <chrono>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include <spdlog/spdlog.h>
+
+#include "renderer/mip_chain.hpp"
+
+using namespace Arctic::Renderer;
+
+using DownsampleFn = void (*)(const uint8_t *, uint32_t, uint32_t, uint8_t *, MipColorSpace);
+
+static float time_downsample(
+    DownsampleFn downsample, const std::vector<uint8_t> &src, uint32_t size,
+    std::vector<uint8_t> &dst, MipColorSpace color_space, uint32_t iterations
+)
+{
+    using Clock = std::chrono::high_resolution_clock;
+    Clock::time_point begin = Clock::now();
+    for (uint32_t i = 0; i < iterations; ++i)
+    {
+        downsample(src.data(), size, size, dst.data(), color_space);
+    }
+    return std::chrono::duration<float, std::milli>(Clock::now() - begin).count() /
+           static_cast<float>(iterations);
+}
+
+// Times the SIMD downsampler against the scalar reference on a random texture, plus the time of
+// generating a full mip chain. That both agree is checked by `mip_chain_test.cpp`.
+int main()
+{
+    static constexpr uint32_t SIZE = 2048;
+    static constexpr uint32_t ITERATIONS = 20;
+
+    std::vector<uint8_t> src(4ull * SIZE * SIZE);
+    std::mt19937 rng(1234);
+    std::uniform_int_distribution<uint32_t> dist(0, 255);
+    for (uint8_t &value : src)
+    {
+        value = static_cast<uint8_t>(dist(rng));
+    }
+
+    std::vector<uint8_t> dst_scalar(src.size() / 4);
+    std::vector<uint8_t> dst_simd(src.size() / 4);
+
+    for (MipColorSpace color_space : {MipColorSpace::Linear, MipColorSpace::Srgb})
+    {
+        const char *name = color_space == MipColorSpace::Linear ? "linear" : "srgb";
+
+        float scalar_ms = time_downsample(
+            downsample_rgba8_scalar,
+            src,
+            SIZE,
+            dst_scalar,
+            color_space,
+            ITERATIONS
+        );
+        float simd_ms =
+            time_downsample(downsample_rgba8, src, SIZE, dst_simd, color_space, ITERATIONS);
+
+        MipChain chain;
+        using Clock = std::chrono::high_resolution_clock;
+        Clock::time_point begin = Clock::now();
+        generate_mip_chain(src.data(), SIZE, SIZE, color_space, chain);
+        float chain_ms = std::chrono::duration<float, std::milli>(Clock::now() - begin).count();
+
+        float megapixels = static_cast<float>(SIZE * SIZE) / 1.0e6f;
+        spdlog::info(
+            "{} {}x{}: scalar {:.3f} ms ({:.0f} MP/s), simd {:.3f} ms ({:.0f} MP/s), speedup "
+            "{:.2f}x, full chain of {} levels {:.3f} ms",
+            name,
+            SIZE,
+            SIZE,
+            scalar_ms,
+            megapixels / scalar_ms * 1000.0f,
+            simd_ms,
+            megapixels / simd_ms * 1000.0f,
+            scalar_ms / simd_ms,
+            chain.levels.size(),
+            chain_ms
+        );
+    }
+
+    return 0;
+}
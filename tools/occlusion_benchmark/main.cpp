@@ -0,0 +1,181 @@
+#include <array>
+#include <cstdint>
+#include <random>
+#include <span>
+#include <vector>
+
+#include <glm/ext/matrix_transform.hpp>
+#include <glm/vec2.hpp>
+#include <spdlog/spdlog.h>
+
+#include "job_system.hpp"
+#include "renderer/procedural_mesh.hpp"
+#include "renderer/software_occlusion.hpp"
+
+using namespace Arctic;
+using namespace Arctic::Renderer;
+
+struct Run
+{
+    float setup_ms{0.0f};
+    float raster_ms{0.0f};
+    float test_ms{0.0f};
+    uint64_t triangles{0};
+    uint64_t occluders{0};
+    uint64_t frustum_culled{0};
+    uint64_t occluded{0};
+    uint64_t tested{0};
+};
+
+static Run run_views(
+    SoftwareOcclusionCuller &culler, std::span<const Object> objects,
+    std::span<const MeshDrawInfo> meshes, std::span<const Camera> views
+)
+{
+    Run run;
+    std::vector<uint8_t> visible;
+    for (const Camera &camera : views)
+    {
+        culler.cull(objects, meshes, camera, visible);
+        const SoftwareOcclusionStats &stats = culler.stats();
+        run.setup_ms += stats.setup_ms;
+        run.raster_ms += stats.raster_ms;
+        run.test_ms += stats.test_ms;
+        run.triangles += stats.triangle_count;
+        run.occluders += stats.occluder_count;
+        run.frustum_culled += stats.frustum_culled;
+        run.occluded += stats.occluded;
+        run.tested += stats.object_count;
+    }
+    return run;
+}
+
+// Culls a city of buildings with small props in between from street level views. Reports the
+// rasterization throughput and how much gets culled, with AVX2 and the scalar reference on one
+// thread and with AVX2 on all threads. That all of them agree is checked by
+// `software_occlusion_test.cpp`.
+int main()
+{
+    static constexpr uint32_t GRID_SIZE = 32;
+    static constexpr float BLOCK_SIZE = 12.0f;
+    static constexpr uint32_t PROPS_PER_BLOCK = 16;
+    static constexpr uint32_t VIEW_COUNT = 64;
+    static constexpr uint32_t BOX_SUBDIVISIONS = 4;
+
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+    generate_box(BOX_SUBDIVISIONS, 1.0f, vertices, indices);
+    std::array<MeshDrawInfo, 1> meshes{MeshDrawInfo{
+        .lods = {MeshLod{
+            .first_index = 0,
+            .index_count = static_cast<uint32_t>(indices.size()),
+            .error = 0.0f,
+        }},
+        .material_idx = 0,
+        .bounds_min = glm::vec3(-0.5f),
+        .bounds_max = glm::vec3(0.5f),
+        .bounds_center = glm::vec3(0.0f),
+        .bounds_radius = 0.87f,
+    }};
+
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> height_dist(6.0f, 30.0f);
+    std::uniform_real_distribution<float> unit_dist(0.0f, 1.0f);
+    std::vector<Object> objects;
+    float city_size = static_cast<float>(GRID_SIZE) * BLOCK_SIZE;
+    for (uint32_t z = 0; z < GRID_SIZE; ++z)
+    {
+        for (uint32_t x = 0; x < GRID_SIZE; ++x)
+        {
+            glm::vec3 corner(
+                static_cast<float>(x) * BLOCK_SIZE, 0.0f, static_cast<float>(z) * BLOCK_SIZE
+            );
+            // A building in the middle of the block, with the streets around it left free.
+            float height = height_dist(rng);
+            glm::vec3 center = corner + glm::vec3(BLOCK_SIZE, height, BLOCK_SIZE) / 2.0f;
+            glm::mat4 building = glm::scale(
+                glm::translate(glm::mat4(1.0f), center),
+                glm::vec3(BLOCK_SIZE - 4.0f, height, BLOCK_SIZE - 4.0f)
+            );
+            objects.emplace_back(Object{.trs = building, .mesh_idx = 0});
+
+            // Props on the pavement around the building.
+            for (uint32_t i = 0; i < PROPS_PER_BLOCK; ++i)
+            {
+                float along = unit_dist(rng) * (BLOCK_SIZE - 2.0f) + 1.0f;
+                glm::vec3 position = unit_dist(rng) < 0.5f ? glm::vec3(along, 0.5f, 1.0f)
+                                                            : glm::vec3(1.0f, 0.5f, along);
+                glm::mat4 prop = glm::translate(glm::mat4(1.0f), corner + position);
+                objects.emplace_back(Object{.trs = prop, .mesh_idx = 0});
+            }
+        }
+    }
+
+    // Views along the streets, at the height of a pedestrian.
+    std::vector<Camera> views;
+    for (uint32_t i = 0; i < VIEW_COUNT; ++i)
+    {
+        float street = static_cast<float>(rng() % GRID_SIZE) * BLOCK_SIZE;
+        float along = unit_dist(rng) * city_size;
+        bool along_x = i % 2 == 0;
+        views.emplace_back(Camera{
+            .eye = along_x ? glm::vec3(along, 1.7f, street) : glm::vec3(street, 1.7f, along),
+            .rotation = glm::vec2(0.0f, (along_x ? 0.0f : 90.0f) + unit_dist(rng) * 60.0f - 30.0f),
+            .aspect = 16.0f / 9.0f,
+            .fov_y = 60.0f,
+            .z_near_far = {0.1f, 1000.0f},
+        });
+    }
+
+    JobSystem single_thread(1);
+    JobSystem all_threads;
+
+    SoftwareOcclusionCuller scalar_culler(&single_thread);
+    scalar_culler.set_use_avx2(false);
+    SoftwareOcclusionCuller simd_culler(&single_thread);
+    SoftwareOcclusionCuller threaded_culler(&all_threads);
+    for (SoftwareOcclusionCuller *culler : {&scalar_culler, &simd_culler, &threaded_culler})
+    {
+        culler->add_mesh(vertices, indices);
+    }
+
+    struct Variant
+    {
+        const char *name;
+        SoftwareOcclusionCuller *culler;
+        uint32_t threads;
+    };
+    std::array<Variant, 3> variants{
+        Variant{"scalar", &scalar_culler, 1},
+        Variant{simd_culler.uses_avx2() ? "avx2" : "scalar", &simd_culler, 1},
+        Variant{
+            threaded_culler.uses_avx2() ? "avx2" : "scalar",
+            &threaded_culler,
+            all_threads.thread_count()
+        },
+    };
+
+    for (const Variant &variant : variants)
+    {
+        Run run = run_views(*variant.culler, objects, meshes, views);
+        float views_f = static_cast<float>(VIEW_COUNT);
+        float tested = static_cast<float>(run.tested);
+        spdlog::info(
+            "{} on {} threads: setup {:.3f} ms, raster {:.3f} ms ({:.1f} Mtri/s), test {:.3f} ms "
+            "per view; {:.0f} occluders and {:.0f} triangles per view, {:.1f}% outside the "
+            "frustum, {:.1f}% occluded",
+            variant.name,
+            variant.threads,
+            run.setup_ms / views_f,
+            run.raster_ms / views_f,
+            static_cast<float>(run.triangles) / 1.0e3f / run.raster_ms,
+            run.test_ms / views_f,
+            static_cast<float>(run.occluders) / views_f,
+            static_cast<float>(run.triangles) / views_f,
+            100.0f * static_cast<float>(run.frustum_culled) / tested,
+            100.0f * static_cast<float>(run.occluded) / tested
+        );
+    }
+
+    return 0;
+}
@@ -0,0 +1,449 @@
+#include "bc_encoder.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace Arctic
+{
+
+using Renderer::TextureFormat;
+using Renderer::TextureImage;
+
+using Rgb = std::array<float, 3>;
+
+static uint16_t pack_565(const Rgb &color)
+{
+    auto quantize = [](float value, float max) {
+        return static_cast<uint16_t>(std::lround(std::clamp(value, 0.0f, 255.0f) * max / 255.0f));
+    };
+    return static_cast<uint16_t>(
+        (quantize(color[0], 31.0f) << 11) | (quantize(color[1], 63.0f) << 5) |
+        quantize(color[2], 31.0f)
+    );
+}
+
+static Rgb unpack_565(uint16_t color)
+{
+    uint32_t r = (color >> 11) & 31;
+    uint32_t g = (color >> 5) & 63;
+    uint32_t b = color & 31;
+    return Rgb{
+        static_cast<float>((r << 3) | (r >> 2)),
+        static_cast<float>((g << 2) | (g >> 4)),
+        static_cast<float>((b << 3) | (b >> 2)),
+    };
+}
+
+static std::array<Rgb, 4> color_palette(uint16_t c0, uint16_t c1, bool four_color)
+{
+    Rgb e0 = unpack_565(c0);
+    Rgb e1 = unpack_565(c1);
+    std::array<Rgb, 4> palette{e0, e1, Rgb{}, Rgb{}};
+    for (size_t c = 0; c < 3; ++c)
+    {
+        if (four_color)
+        {
+            palette[2][c] = (2.0f * e0[c] + e1[c]) / 3.0f;
+            palette[3][c] = (e0[c] + 2.0f * e1[c]) / 3.0f;
+        }
+        else
+        {
+            palette[2][c] = (e0[c] + e1[c]) / 2.0f;
+        }
+    }
+    return palette;
+}
+
+static float squared_distance(const Rgb &a, const Rgb &b)
+{
+    float dr = a[0] - b[0];
+    float dg = a[1] - b[1];
+    float db = a[2] - b[2];
+    return dr * dr + dg * dg + db * db;
+}
+
+// Picks the closest palette entry for every texel and returns the total squared error.
+static float fit_color_indices(
+    const std::array<Rgb, 16> &colors, uint16_t c0, uint16_t c1, std::array<uint8_t, 16> &indices
+)
+{
+    std::array<Rgb, 4> palette = color_palette(c0, c1, true);
+    float total_error = 0.0f;
+    for (size_t i = 0; i < 16; ++i)
+    {
+        float best_error = squared_distance(colors[i], palette[0]);
+        indices[i] = 0;
+        for (uint8_t p = 1; p < 4; ++p)
+        {
+            float error = squared_distance(colors[i], palette[p]);
+            if (error < best_error)
+            {
+                best_error = error;
+                indices[i] = p;
+            }
+        }
+        total_error += best_error;
+    }
+    return total_error;
+}
+
+// Finds the endpoints along the principal axis of the block colors, then refines them with a
+// least squares fit to the chosen indices. Always produces a four color block.
+static void encode_color_block(const RgbaBlock &block, uint8_t *out)
+{
+    std::array<Rgb, 16> colors;
+    Rgb mean{};
+    for (size_t i = 0; i < 16; ++i)
+    {
+        for (size_t c = 0; c < 3; ++c)
+        {
+            colors[i][c] = static_cast<float>(block[4 * i + c]);
+            mean[c] += colors[i][c] / 16.0f;
+        }
+    }
+
+    std::array<float, 6> cov{};
+    for (const Rgb &color : colors)
+    {
+        float r = color[0] - mean[0];
+        float g = color[1] - mean[1];
+        float b = color[2] - mean[2];
+        cov[0] += r * r;
+        cov[1] += r * g;
+        cov[2] += r * b;
+        cov[3] += g * g;
+        cov[4] += g * b;
+        cov[5] += b * b;
+    }
+
+    // Starts from the covariance row of the channel that varies the most. A fixed start vector
+    // is lost on blocks whose colors vary orthogonally to it, e.g. ones of two colors whose
+    // difference sums to zero.
+    Rgb axis{1.0f, 1.0f, 1.0f};
+    if (cov[0] >= cov[3] && cov[0] >= cov[5] && cov[0] > 0.0f)
+    {
+        axis = {cov[0], cov[1], cov[2]};
+    }
+    else if (cov[3] >= cov[5] && cov[3] > 0.0f)
+    {
+        axis = {cov[1], cov[3], cov[4]};
+    }
+    else if (cov[5] > 0.0f)
+    {
+        axis = {cov[2], cov[4], cov[5]};
+    }
+    for (uint32_t iteration = 0; iteration < 8; ++iteration)
+    {
+        Rgb next{
+            cov[0] * axis[0] + cov[1] * axis[1] + cov[2] * axis[2],
+            cov[1] * axis[0] + cov[3] * axis[1] + cov[4] * axis[2],
+            cov[2] * axis[0] + cov[4] * axis[1] + cov[5] * axis[2],
+        };
+        float length = std::sqrt(next[0] * next[0] + next[1] * next[1] + next[2] * next[2]);
+        if (length < 1e-6f)
+        {
+            break;
+        }
+        axis = {next[0] / length, next[1] / length, next[2] / length};
+    }
+
+    float t_min = 0.0f;
+    float t_max = 0.0f;
+    for (const Rgb &color : colors)
+    {
+        float t = (color[0] - mean[0]) * axis[0] + (color[1] - mean[1]) * axis[1] +
+                  (color[2] - mean[2]) * axis[2];
+        t_min = std::min(t_min, t);
+        t_max = std::max(t_max, t);
+    }
+
+    // Insetting the endpoints slightly reduces the error of the interpolated colors.
+    float inset = (t_max - t_min) / 16.0f;
+    Rgb e0, e1;
+    for (size_t c = 0; c < 3; ++c)
+    {
+        e0[c] = mean[c] + axis[c] * (t_max - inset);
+        e1[c] = mean[c] + axis[c] * (t_min + inset);
+    }
+
+    uint16_t c0 = pack_565(e0);
+    uint16_t c1 = pack_565(e1);
+    std::array<uint8_t, 16> indices;
+    float error = fit_color_indices(colors, c0, c1, indices);
+
+    static constexpr std::array<float, 4> WEIGHTS{1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f};
+    for (uint32_t iteration = 0; iteration < 2 && error > 0.0f; ++iteration)
+    {
+        float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+        Rgb ax{}, bx{};
+        for (size_t i = 0; i < 16; ++i)
+        {
+            float a = WEIGHTS[indices[i]];
+            float b = 1.0f - a;
+            aa += a * a;
+            ab += a * b;
+            bb += b * b;
+            for (size_t c = 0; c < 3; ++c)
+            {
+                ax[c] += a * colors[i][c];
+                bx[c] += b * colors[i][c];
+            }
+        }
+
+        float det = aa * bb - ab * ab;
+        if (std::abs(det) < 1e-6f)
+        {
+            break;
+        }
+
+        Rgb fit0, fit1;
+        for (size_t c = 0; c < 3; ++c)
+        {
+            fit0[c] = (bb * ax[c] - ab * bx[c]) / det;
+            fit1[c] = (aa * bx[c] - ab * ax[c]) / det;
+        }
+
+        uint16_t fit_c0 = pack_565(fit0);
+        uint16_t fit_c1 = pack_565(fit1);
+        std::array<uint8_t, 16> fit_indices;
+        float fit_error = fit_color_indices(colors, fit_c0, fit_c1, fit_indices);
+        if (fit_error >= error)
+        {
+            break;
+        }
+        c0 = fit_c0;
+        c1 = fit_c1;
+        indices = fit_indices;
+        error = fit_error;
+    }
+
+    // BC1 uses the four color mode only if the first endpoint is the larger one.
+    if (c0 < c1)
+    {
+        std::swap(c0, c1);
+        for (uint8_t &idx : indices)
+        {
+            idx ^= 1;
+        }
+    }
+    else if (c0 == c1)
+    {
+        indices.fill(0);
+    }
+
+    uint32_t packed_indices = 0;
+    for (size_t i = 0; i < 16; ++i)
+    {
+        packed_indices |= static_cast<uint32_t>(indices[i]) << (2 * i);
+    }
+    std::memcpy(out, &c0, 2);
+    std::memcpy(out + 2, &c1, 2);
+    std::memcpy(out + 4, &packed_indices, 4);
+}
+
+void encode_bc1_block(const RgbaBlock &block, uint8_t *out)
+{
+    encode_color_block(block, out);
+}
+
+void encode_bc3_block(const RgbaBlock &block, uint8_t *out)
+{
+    encode_bc4_block(block, 3, out);
+    encode_color_block(block, out + 8);
+}
+
+void encode_bc4_block(const RgbaBlock &block, uint32_t channel, uint8_t *out)
+{
+    uint8_t min_value = 255;
+    uint8_t max_value = 0;
+    for (size_t i = 0; i < 16; ++i)
+    {
+        min_value = std::min(min_value, block[4 * i + channel]);
+        max_value = std::max(max_value, block[4 * i + channel]);
+    }
+
+    // With the first endpoint larger than the second all eight palette entries interpolate
+    // between the two.
+    out[0] = max_value;
+    out[1] = min_value;
+
+    uint64_t packed_indices = 0;
+    if (max_value != min_value)
+    {
+        std::array<float, 8> palette{};
+        palette[0] = max_value;
+        palette[1] = min_value;
+        for (uint32_t p = 2; p < 8; ++p)
+        {
+            palette[p] = (static_cast<float>(8 - p) * max_value +
+                          static_cast<float>(p - 1) * min_value) /
+                         7.0f;
+        }
+
+        for (size_t i = 0; i < 16; ++i)
+        {
+            float value = block[4 * i + channel];
+            uint64_t best_idx = 0;
+            float best_error = std::abs(value - palette[0]);
+            for (uint32_t p = 1; p < 8; ++p)
+            {
+                float error = std::abs(value - palette[p]);
+                if (error < best_error)
+                {
+                    best_error = error;
+                    best_idx = p;
+                }
+            }
+            packed_indices |= best_idx << (3 * i);
+        }
+    }
+    std::memcpy(out + 2, &packed_indices, 6);
+}
+
+void encode_bc5_block(const RgbaBlock &block, uint8_t *out)
+{
+    encode_bc4_block(block, 0, out);
+    encode_bc4_block(block, 1, out + 8);
+}
+
+static void decode_color_block(const uint8_t *in, bool force_four_color, RgbaBlock &out_block)
+{
+    uint16_t c0, c1;
+    uint32_t packed_indices;
+    std::memcpy(&c0, in, 2);
+    std::memcpy(&c1, in + 2, 2);
+    std::memcpy(&packed_indices, in + 4, 4);
+
+    bool four_color = force_four_color || c0 > c1;
+    std::array<Rgb, 4> palette = color_palette(c0, c1, four_color);
+    for (size_t i = 0; i < 16; ++i)
+    {
+        uint32_t idx = (packed_indices >> (2 * i)) & 3;
+        for (size_t c = 0; c < 3; ++c)
+        {
+            out_block[4 * i + c] = static_cast<uint8_t>(std::lround(palette[idx][c]));
+        }
+    }
+}
+
+static void decode_value_block(const uint8_t *in, uint32_t channel, RgbaBlock &out_block)
+{
+    float a0 = in[0];
+    float a1 = in[1];
+    uint64_t packed_indices = 0;
+    std::memcpy(&packed_indices, in + 2, 6);
+
+    std::array<float, 8> palette{a0, a1};
+    if (a0 > a1)
+    {
+        for (uint32_t p = 2; p < 8; ++p)
+        {
+            palette[p] = (static_cast<float>(8 - p) * a0 + static_cast<float>(p - 1) * a1) / 7.0f;
+        }
+    }
+    else
+    {
+        for (uint32_t p = 2; p < 6; ++p)
+        {
+            palette[p] = (static_cast<float>(6 - p) * a0 + static_cast<float>(p - 1) * a1) / 5.0f;
+        }
+        palette[6] = 0.0f;
+        palette[7] = 255.0f;
+    }
+
+    for (size_t i = 0; i < 16; ++i)
+    {
+        uint64_t idx = (packed_indices >> (3 * i)) & 7;
+        out_block[4 * i + channel] = static_cast<uint8_t>(std::lround(palette[idx]));
+    }
+}
+
+void decode_block(TextureFormat format, const uint8_t *in, RgbaBlock &out_block)
+{
+    switch (format)
+    {
+        case TextureFormat::BC1Unorm:
+        case TextureFormat::BC1UnormSrgb:
+            decode_color_block(in, false, out_block);
+            break;
+        case TextureFormat::BC3Unorm:
+        case TextureFormat::BC3UnormSrgb:
+            decode_value_block(in, 3, out_block);
+            decode_color_block(in + 8, true, out_block);
+            break;
+        case TextureFormat::BC4Unorm:
+            decode_value_block(in, 0, out_block);
+            break;
+        case TextureFormat::BC5Unorm:
+            decode_value_block(in, 0, out_block);
+            decode_value_block(in + 8, 1, out_block);
+            break;
+        default:
+            break;
+    }
+}
+
+void compress_image(
+    const TextureImage &src, TextureFormat format, JobSystem &jobs, TextureImage &out_image
+)
+{
+    auto num_levels = static_cast<uint32_t>(src.levels.size());
+    Renderer::allocate_texture_image(format, src.width, src.height, num_levels, out_image);
+    uint32_t block_size = Renderer::format_element_size(format);
+
+    for (uint32_t level = 0; level < num_levels; ++level)
+    {
+        const Renderer::TextureLevel &src_level = src.levels[level];
+        const Renderer::TextureLevel &dst_level = out_image.levels[level];
+        const uint8_t *texels = src.level_data(level).data();
+        uint8_t *blocks = out_image.data.data() + dst_level.offset;
+        uint32_t blocks_x = (src_level.width + 3) / 4;
+        uint32_t blocks_y = (src_level.height + 3) / 4;
+
+        jobs.parallel_for(blocks_y, [&](size_t block_y) {
+            for (uint32_t block_x = 0; block_x < blocks_x; ++block_x)
+            {
+                // Blocks of levels smaller than 4x4 repeat the edge texels.
+                RgbaBlock block;
+                for (uint32_t y = 0; y < 4; ++y)
+                {
+                    uint32_t texel_y =
+                        std::min(static_cast<uint32_t>(4 * block_y + y), src_level.height - 1);
+                    for (uint32_t x = 0; x < 4; ++x)
+                    {
+                        uint32_t texel_x = std::min(4 * block_x + x, src_level.width - 1);
+                        std::memcpy(
+                            block.data() + 4 * (4 * y + x),
+                            texels + 4ull * (uint64_t{texel_y} * src_level.width + texel_x),
+                            4
+                        );
+                    }
+                }
+
+                uint8_t *out = blocks + block_y * dst_level.row_pitch + block_x * block_size;
+                switch (format)
+                {
+                    case TextureFormat::BC1Unorm:
+                    case TextureFormat::BC1UnormSrgb:
+                        encode_bc1_block(block, out);
+                        break;
+                    case TextureFormat::BC3Unorm:
+                    case TextureFormat::BC3UnormSrgb:
+                        encode_bc3_block(block, out);
+                        break;
+                    case TextureFormat::BC4Unorm:
+                        encode_bc4_block(block, 0, out);
+                        break;
+                    case TextureFormat::BC5Unorm:
+                        encode_bc5_block(block, out);
+                        break;
+                    default:
+                        break;
+                }
+            }
+        });
+    }
+}
+
+} // namespace Arctic
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#include "job_system.hpp"
+#include "renderer/texture_image.hpp"
+
+namespace Arctic
+{
+
+// A 4x4 block of RGBA8 texels in row-major order.
+using RgbaBlock = std::array<uint8_t, 64>;
+
+void encode_bc1_block(const RgbaBlock &block, uint8_t *out);
+
+void encode_bc3_block(const RgbaBlock &block, uint8_t *out);
+
+// Encodes one channel of the block. Used on its own for BC4 and as the alpha part of BC3.
+void encode_bc4_block(const RgbaBlock &block, uint32_t channel, uint8_t *out);
+
+// Encodes the red and green channels of the block.
+void encode_bc5_block(const RgbaBlock &block, uint8_t *out);
+
+// Decodes a block of any of the supported formats, channels that are not stored are left as is.
+void decode_block(Renderer::TextureFormat format, const uint8_t *in, RgbaBlock &out_block);
+
+// Compresses every level of an uncompressed RGBA8 image into `format`, spread over the threads
+// of `jobs`. The top level has to be a multiple of 4 texels wide and high.
+void compress_image(
+    const Renderer::TextureImage &src, Renderer::TextureFormat format, JobSystem &jobs,
+    Renderer::TextureImage &out_image
+);
+
+} // namespace Arctic
@@ -0,0 +1,207 @@
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <string_view>
+#include <utility>
+
+#include <spdlog/spdlog.h>
+
+#include "stb_image.h"
+
+#include "bc_encoder.hpp"
+#include "job_system.hpp"
+#include "renderer/dds.hpp"
+#include "renderer/mip_chain.hpp"
+#include "renderer/texture_image.hpp"
+
+using namespace Arctic;
+using namespace Arctic::Renderer;
+
+enum class TextureType
+{
+    Diffuse,
+    Normal,
+    MetalnessRoughness,
+};
+
+// Root mean square error of the channels the format stores in the top level, to judge the
+// compression quality.
+static float compression_error(const TextureImage &original, const TextureImage &compressed)
+{
+    const TextureLevel &level = original.levels[0];
+    const TextureLevel &compressed_level = compressed.levels[0];
+    uint32_t block_size = format_element_size(compressed.format);
+
+    size_t channels = 4;
+    if (compressed.format == TextureFormat::BC1Unorm ||
+        compressed.format == TextureFormat::BC1UnormSrgb)
+    {
+        channels = 3;
+    }
+    else if (compressed.format == TextureFormat::BC5Unorm)
+    {
+        channels = 2;
+    }
+    else if (compressed.format == TextureFormat::BC4Unorm)
+    {
+        channels = 1;
+    }
+
+    double sum = 0.0;
+    for (uint32_t block_y = 0; block_y < level.height / 4; ++block_y)
+    {
+        for (uint32_t block_x = 0; block_x < level.width / 4; ++block_x)
+        {
+            RgbaBlock block{};
+            decode_block(
+                compressed.format,
+                compressed.level_data(0).data() + block_y * compressed_level.row_pitch +
+                    block_x * block_size,
+                block
+            );
+            for (uint32_t i = 0; i < 16; ++i)
+            {
+                uint64_t x = 4 * block_x + i % 4;
+                uint64_t y = 4 * block_y + i / 4;
+                const uint8_t *texel = original.level_data(0).data() + 4 * (y * level.width + x);
+                for (size_t c = 0; c < channels; ++c)
+                {
+                    double diff = static_cast<double>(texel[c]) - block[4 * i + c];
+                    sum += diff * diff;
+                }
+            }
+        }
+    }
+
+    double count = static_cast<double>(level.width) * level.height * static_cast<double>(channels);
+    return static_cast<float>(std::sqrt(sum / count));
+}
+
+[[nodiscard]] static bool
+compress_file(const std::filesystem::path &input, TextureType type, JobSystem &jobs)
+{
+    using Clock = std::chrono::high_resolution_clock;
+    Clock::time_point begin = Clock::now();
+
+    int width, height;
+    uint8_t *pixels = stbi_load(input.string().c_str(), &width, &height, nullptr, 4);
+    if (!pixels)
+    {
+        spdlog::error("failed to load image file `{}`", input.string());
+        return false;
+    }
+    if (width % 4 != 0 || height % 4 != 0)
+    {
+        spdlog::error(
+            "`{}` is {}x{}, block compressed textures have to be a multiple of 4 in both "
+            "dimensions",
+            input.string(),
+            width,
+            height
+        );
+        stbi_image_free(pixels);
+        return false;
+    }
+
+    MipColorSpace color_space =
+        type == TextureType::Diffuse ? MipColorSpace::Srgb : MipColorSpace::Linear;
+    MipChain mip_chain;
+    generate_mip_chain(
+        pixels,
+        static_cast<uint32_t>(width),
+        static_cast<uint32_t>(height),
+        color_space,
+        mip_chain
+    );
+    stbi_image_free(pixels);
+
+    TextureImage original;
+    texture_image_from_mip_chain(std::move(mip_chain), color_space, original);
+
+    TextureFormat format = TextureFormat::BC1Unorm;
+    if (type == TextureType::Diffuse)
+    {
+        bool opaque = true;
+        for (size_t i = 3; i < original.levels[0].size; i += 4)
+        {
+            opaque &= original.data[i] == 255;
+        }
+        format = opaque ? TextureFormat::BC1UnormSrgb : TextureFormat::BC3UnormSrgb;
+    }
+    else if (type == TextureType::Normal)
+    {
+        format = TextureFormat::BC5Unorm;
+    }
+
+    TextureImage compressed;
+    compress_image(original, format, jobs, compressed);
+
+    std::filesystem::path output = input;
+    output.replace_extension(".dds");
+    if (!save_dds(output, compressed))
+    {
+        return false;
+    }
+
+    spdlog::info(
+        "{} -> {}: {}x{}, {} levels, {}, {:.1f} MiB -> {:.1f} MiB, RMSE {:.2f}, {:.0f} ms",
+        input.string(),
+        output.string(),
+        width,
+        height,
+        compressed.levels.size(),
+        texture_format_name(format),
+        static_cast<double>(original.data.size()) / (1024.0 * 1024.0),
+        static_cast<double>(compressed.data.size()) / (1024.0 * 1024.0),
+        compression_error(original, compressed),
+        std::chrono::duration<float, std::milli>(Clock::now() - begin).count()
+    );
+
+    return true;
+}
+
+// Compresses material textures into DDS files next to the source images, which the renderer
+// then loads instead of the source images. Diffuse textures become BC1, or BC3 if they have an
+// alpha channel, normal maps become BC5 and metalness/roughness maps become BC1.
+int main(int argc, char **argv)
+{
+    if (argc < 3)
+    {
+        spdlog::error(
+            "usage: {} <diffuse|normal|metalness_roughness> <image>...",
+            argc > 0 ? argv[0] : "arctic_texture_compressor"
+        );
+        return 1;
+    }
+
+    std::string_view type_name = argv[1];
+    TextureType type;
+    if (type_name == "diffuse")
+    {
+        type = TextureType::Diffuse;
+    }
+    else if (type_name == "normal")
+    {
+        type = TextureType::Normal;
+    }
+    else if (type_name == "metalness_roughness")
+    {
+        type = TextureType::MetalnessRoughness;
+    }
+    else
+    {
+        spdlog::error("unknown texture type `{}`", type_name);
+        return 1;
+    }
+
+    JobSystem jobs;
+    spdlog::info("compressing with {} threads", jobs.thread_count());
+
+    bool ok = true;
+    for (int i = 2; i < argc; ++i)
+    {
+        ok &= compress_file(argv[i], type, jobs);
+    }
+
+    return ok ? 0 : 1;
+}
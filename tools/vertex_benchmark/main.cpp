@@ -0,0 +1,100 @@
+#include <chrono>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include <glm/geometric.hpp>
+#include <spdlog/spdlog.h>
+
+#include "renderer/vertex_format.hpp"
+
+using namespace Arctic::Renderer;
+
+using CompressFn =
+    void (*)(std::span<const Vertex>, VertexPositionFormat, CompressedVertices &);
+
+static float time_compress(
+    CompressFn compress, const std::vector<Vertex> &vertices, VertexPositionFormat format,
+    CompressedVertices &out_vertices, uint32_t iterations
+)
+{
+    using Clock = std::chrono::high_resolution_clock;
+    Clock::time_point begin = Clock::now();
+    for (uint32_t i = 0; i < iterations; ++i)
+    {
+        compress(vertices, format, out_vertices);
+    }
+    return std::chrono::duration<float, std::milli>(Clock::now() - begin).count() /
+           static_cast<float>(iterations);
+}
+
+static glm::vec3 random_direction(std::mt19937 &rng)
+{
+    std::normal_distribution<float> dist(0.0f, 1.0f);
+    return glm::normalize(glm::vec3(dist(rng), dist(rng), dist(rng)));
+}
+
+// Times the SIMD vertex compressor against the scalar reference on random vertices and reports the
+// size of each compressed format. That both agree and how precise the formats are is checked by
+// `vertex_format_test.cpp`.
+int main()
+{
+    static constexpr uint32_t VERTEX_COUNT = 1 << 20;
+    static constexpr uint32_t ITERATIONS = 10;
+    // Extent of the random mesh, in scene units.
+    static constexpr float EXTENT = 20.0f;
+
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> position_dist(-EXTENT / 2.0f, EXTENT / 2.0f);
+    std::uniform_real_distribution<float> tex_coord_dist(-4.0f, 4.0f);
+    std::bernoulli_distribution flip_dist(0.5);
+
+    std::vector<Vertex> vertices(VERTEX_COUNT);
+    for (Vertex &vertex : vertices)
+    {
+        vertex.position = glm::vec3(position_dist(rng), position_dist(rng), position_dist(rng));
+        vertex.normal = random_direction(rng);
+        vertex.tangent =
+            glm::normalize(glm::cross(vertex.normal, random_direction(rng)));
+        vertex.bitangent = glm::cross(vertex.normal, vertex.tangent) *
+                           (flip_dist(rng) ? -1.0f : 1.0f);
+        vertex.tex_coords = glm::vec2(tex_coord_dist(rng), tex_coord_dist(rng));
+    }
+
+    for (VertexPositionFormat format : {VertexPositionFormat::Float, VertexPositionFormat::Unorm16})
+    {
+        const char *name = format == VertexPositionFormat::Float ? "float" : "unorm16";
+
+        CompressedVertices scalar;
+        CompressedVertices simd;
+        float scalar_ms =
+            time_compress(compress_vertices_scalar, vertices, format, scalar, ITERATIONS);
+        float simd_ms = time_compress(compress_vertices, vertices, format, simd, ITERATIONS);
+
+        auto reduction = [](size_t size) {
+            return 100.0f * (1.0f - static_cast<float>(size) / static_cast<float>(sizeof(Vertex)));
+        };
+        size_t position_size = vertex_position_size(format);
+        size_t vertex_size = position_size + sizeof(PackedVertexAttributes);
+
+        float megavertices = static_cast<float>(VERTEX_COUNT) / 1.0e6f;
+        spdlog::info(
+            "{} positions: {} bytes per vertex instead of {} ({:.0f}% less vertex bandwidth), "
+            "{} bytes in depth passes ({:.0f}% less), scalar {:.3f} ms ({:.0f} Mvert/s), simd "
+            "{:.3f} ms ({:.0f} Mvert/s), speedup {:.2f}x",
+            name,
+            vertex_size,
+            sizeof(Vertex),
+            reduction(vertex_size),
+            position_size,
+            reduction(position_size),
+            scalar_ms,
+            megavertices / scalar_ms * 1000.0f,
+            simd_ms,
+            megavertices / simd_ms * 1000.0f,
+            scalar_ms / simd_ms
+        );
+    }
+
+    return 0;
+}